@@ -0,0 +1,33 @@
+# OSFG - Open Source Frame Generation
+# Extract an embedded HLSL string from a C++ source file
+#
+# Usage: cmake -DINPUT=<file.cpp> -DSYMBOL=<name> -DOUTPUT=<file.hlsl> -P ExtractShaderSource.cmake
+#
+# Copies the body of `static const char* <SYMBOL> = R"(...)";` to OUTPUT.
+# OUTPUT is only rewritten when the shader text changed, so editing C++ code
+# in the same file does not recompile the DXIL.
+
+file(READ "${INPUT}" text)
+
+set(marker "${SYMBOL} = R\"(")
+string(FIND "${text}" "${marker}" start)
+if(start EQUAL -1)
+    message(FATAL_ERROR "${INPUT}: no raw string literal named ${SYMBOL}")
+endif()
+string(LENGTH "${marker}" marker_length)
+math(EXPR start "${start} + ${marker_length}")
+string(SUBSTRING "${text}" ${start} -1 text)
+
+string(FIND "${text}" ")\";" end)
+if(end EQUAL -1)
+    message(FATAL_ERROR "${INPUT}: unterminated raw string literal ${SYMBOL}")
+endif()
+string(SUBSTRING "${text}" 0 ${end} text)
+
+set(previous "")
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+endif()
+if(NOT previous STREQUAL text)
+    file(WRITE "${OUTPUT}" "${text}")
+endif()
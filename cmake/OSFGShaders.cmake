@@ -0,0 +1,93 @@
+# OSFG - Open Source Frame Generation
+# Build-time shader compilation
+#
+# osfg_precompile_shaders(<target>
+#     SOURCE <file.cpp> SYMBOL <name>
+#     VARIANTS <entry>:<profile>[:<NAME=VALUE>,...] ...)
+#
+# Extracts the raw string literal <name> from <file.cpp>, compiles each
+# variant to DXIL with DXC and generates <name>_dxil.h, which defines the
+# table `static const osfg::PrecompiledShader <name>Dxil[]` (see
+# src/common/precompiled_shader.h). Defines are listed in the order the
+# module passes them to D3DCompile, which is also the lookup key. The target
+# gets OSFG_PRECOMPILED_SHADERS=1; without DXC nothing is added and the
+# module keeps compiling at runtime.
+
+set(OSFG_SHADER_OUTPUT_DIR ${CMAKE_BINARY_DIR}/shaders)
+set(OSFG_SHADER_SCRIPT_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+function(osfg_precompile_shaders TARGET)
+    cmake_parse_arguments(ARG "" "SOURCE;SYMBOL" "VARIANTS" ${ARGN})
+    if(NOT OSFG_PRECOMPILE_SHADERS OR NOT OSFG_DXC_EXECUTABLE)
+        return()
+    endif()
+
+    set(out_dir ${OSFG_SHADER_OUTPUT_DIR})
+    get_filename_component(source ${ARG_SOURCE} ABSOLUTE)
+    set(hlsl ${out_dir}/${ARG_SYMBOL}.hlsl)
+
+    add_custom_command(
+        OUTPUT ${hlsl}
+        COMMAND ${CMAKE_COMMAND} -DINPUT=${source} -DSYMBOL=${ARG_SYMBOL} -DOUTPUT=${hlsl}
+                -P ${OSFG_SHADER_SCRIPT_DIR}/ExtractShaderSource.cmake
+        DEPENDS ${source} ${OSFG_SHADER_SCRIPT_DIR}/ExtractShaderSource.cmake
+        COMMENT "Extracting ${ARG_SYMBOL} from ${ARG_SOURCE}"
+        VERBATIM
+    )
+
+    set(headers)
+    set(includes "")
+    set(entries "")
+    set(index 0)
+    foreach(variant IN LISTS ARG_VARIANTS)
+        string(REPLACE ":" ";" parts "${variant}")
+        list(LENGTH parts part_count)
+        list(GET parts 0 entry)
+        list(GET parts 1 profile)
+
+        set(define_args)
+        set(key "")
+        if(part_count GREATER 2)
+            list(GET parts 2 defines)
+            string(REPLACE "," ";" define_list "${defines}")
+            foreach(define IN LISTS define_list)
+                list(APPEND define_args -D ${define})
+            endforeach()
+            string(REPLACE "," ";" key "${defines}")
+        endif()
+
+        set(array ${ARG_SYMBOL}Dxil${index})
+        set(header ${out_dir}/${array}.h)
+        add_custom_command(
+            OUTPUT ${header}
+            COMMAND ${OSFG_DXC_EXECUTABLE} -T ${profile} -E ${entry} ${define_args}
+                    -O3 -Qstrip_debug -Fh ${header} -Vn ${array} ${hlsl}
+            DEPENDS ${hlsl}
+            COMMENT "DXC ${ARG_SYMBOL} ${entry} (${profile}) ${defines}"
+            VERBATIM
+        )
+
+        list(APPEND headers ${header})
+        string(APPEND includes "#include \"${array}.h\"\n")
+        string(APPEND entries "    { \"${entry}\", \"${key}\", ${array}, sizeof(${array}) },\n")
+        math(EXPR index "${index} + 1")
+        unset(defines)
+    endforeach()
+
+    set(table ${out_dir}/${ARG_SYMBOL}_dxil.h)
+    file(CONFIGURE OUTPUT ${table} CONTENT
+"// Generated by osfg_precompile_shaders() from ${ARG_SOURCE} - do not edit
+
+#pragma once
+
+#include \"common/precompiled_shader.h\"
+
+${includes}
+static const osfg::PrecompiledShader ${ARG_SYMBOL}Dxil[] = {
+${entries}};
+" @ONLY)
+
+    target_sources(${TARGET} PRIVATE ${table} ${headers})
+    target_include_directories(${TARGET} PRIVATE ${out_dir})
+    target_compile_definitions(${TARGET} PRIVATE OSFG_PRECOMPILED_SHADERS=1)
+endfunction()
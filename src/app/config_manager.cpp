@@ -84,9 +84,11 @@ bool ConfigManager::Load(const std::wstring& path) {
     if (!ParseConfigFile(configPath)) {
         // If file doesn't exist, create with defaults
         m_settings = AppSettings{};
+        m_appliedSettings = m_settings;
         return Save(configPath);
     }
 
+    m_appliedSettings = m_settings;
     return true;
 }
 
@@ -114,6 +116,56 @@ void ConfigManager::RegisterCallback(SettingsChangedCallback callback) {
     m_callbacks.push_back(callback);
 }
 
+void ConfigManager::RegisterChangeCallback(SettingsDiffCallback callback) {
+    m_changeCallbacks.push_back(callback);
+}
+
+SettingsChange ConfigManager::DiffSettings(const AppSettings& before, const AppSettings& after) {
+    SettingsChange change = SettingsChange::None;
+
+    if (before.frameGenMode != after.frameGenMode || before.enableFrameGen != after.enableFrameGen ||
+        before.targetFramerate != after.targetFramerate) {
+        change = change | SettingsChange::FrameGen;
+    }
+    if (before.captureMethod != after.captureMethod || before.captureMonitor != after.captureMonitor ||
+        before.captureCursor != after.captureCursor) {
+        change = change | SettingsChange::Capture;
+    }
+    if (before.gpuMode != after.gpuMode || before.primaryGPU != after.primaryGPU ||
+        before.secondaryGPU != after.secondaryGPU) {
+        change = change | SettingsChange::GPU;
+    }
+    if (before.opticalFlowBlockSize != after.opticalFlowBlockSize ||
+        before.opticalFlowSearchRadius != after.opticalFlowSearchRadius ||
+        before.sceneChangeThreshold != after.sceneChangeThreshold) {
+        change = change | SettingsChange::OpticalFlow;
+    }
+    if (before.vsyncEnabled != after.vsyncEnabled || before.variableRefresh != after.variableRefresh ||
+        before.borderlessWindow != after.borderlessWindow || before.windowWidth != after.windowWidth ||
+        before.windowHeight != after.windowHeight) {
+        change = change | SettingsChange::Presentation;
+    }
+    if (before.showOverlay != after.showOverlay || before.showFPS != after.showFPS ||
+        before.showFrameTime != after.showFrameTime || before.showGPUUsage != after.showGPUUsage ||
+        before.overlayPosition != after.overlayPosition || before.overlayScale != after.overlayScale) {
+        change = change | SettingsChange::Overlay;
+    }
+    if (before.hotkeyToggleFrameGen != after.hotkeyToggleFrameGen ||
+        before.hotkeyToggleOverlay != after.hotkeyToggleOverlay ||
+        before.hotkeyCycleMode != after.hotkeyCycleMode ||
+        before.hotkeyDumpFrameRecords != after.hotkeyDumpFrameRecords ||
+        before.hotkeyRequireAlt != after.hotkeyRequireAlt) {
+        change = change | SettingsChange::Hotkeys;
+    }
+    if (before.frameBufferCount != after.frameBufferCount ||
+        before.usePeerToPeerTransfer != after.usePeerToPeerTransfer ||
+        before.enableDebugMode != after.enableDebugMode || before.logFilePath != after.logFilePath) {
+        change = change | SettingsChange::Advanced;
+    }
+
+    return change;
+}
+
 std::wstring ConfigManager::GetDefaultConfigPath() const {
     wchar_t appDataPath[MAX_PATH];
     if (SUCCEEDED(SHGetFolderPathW(nullptr, CSIDL_APPDATA, nullptr, 0, appDataPath))) {
@@ -140,8 +192,8 @@ bool ConfigManager::ValidateSettings(const AppSettings& settings) {
     }
 
     // Validate optical flow settings
-    if (settings.opticalFlowBlockSize < 4 || settings.opticalFlowBlockSize > 32) {
-        m_lastError = L"Optical flow block size must be between 4 and 32";
+    if (settings.opticalFlowBlockSize != 8 && settings.opticalFlowBlockSize != 16) {
+        m_lastError = L"Optical flow block size must be 8 or 16";
         return false;
     }
 
@@ -212,6 +264,7 @@ bool ConfigManager::ParseConfigFile(const std::wstring& path) {
         }
         else if (currentSection == "presentation") {
             if (key == "vsync") m_settings.vsyncEnabled = ParseBool(value);
+            else if (key == "variablerefresh") m_settings.variableRefresh = ParseBool(value);
             else if (key == "borderless") m_settings.borderlessWindow = ParseBool(value);
             else if (key == "width") m_settings.windowWidth = ParseUInt(value);
             else if (key == "height") m_settings.windowHeight = ParseUInt(value);
@@ -228,6 +281,7 @@ bool ConfigManager::ParseConfigFile(const std::wstring& path) {
             if (key == "toggleframegen") m_settings.hotkeyToggleFrameGen = ParseUInt(value);
             else if (key == "toggleoverlay") m_settings.hotkeyToggleOverlay = ParseUInt(value);
             else if (key == "cyclemode") m_settings.hotkeyCycleMode = ParseUInt(value);
+            else if (key == "dumpframerecords") m_settings.hotkeyDumpFrameRecords = ParseUInt(value);
             else if (key == "requirealt") m_settings.hotkeyRequireAlt = ParseBool(value);
         }
         else if (currentSection == "advanced") {
@@ -273,6 +327,7 @@ bool ConfigManager::WriteConfigFile(const std::wstring& path) {
 
     file << "[Presentation]\n";
     file << "VSync = " << (m_settings.vsyncEnabled ? "true" : "false") << "\n";
+    file << "VariableRefresh = " << (m_settings.variableRefresh ? "true" : "false") << "\n";
     file << "Borderless = " << (m_settings.borderlessWindow ? "true" : "false") << "\n";
     file << "Width = " << m_settings.windowWidth << "\n";
     file << "Height = " << m_settings.windowHeight << "\n\n";
@@ -289,6 +344,7 @@ bool ConfigManager::WriteConfigFile(const std::wstring& path) {
     file << "ToggleFrameGen = " << m_settings.hotkeyToggleFrameGen << "\n";
     file << "ToggleOverlay = " << m_settings.hotkeyToggleOverlay << "\n";
     file << "CycleMode = " << m_settings.hotkeyCycleMode << "\n";
+    file << "DumpFrameRecords = " << m_settings.hotkeyDumpFrameRecords << "\n";
     file << "RequireAlt = " << (m_settings.hotkeyRequireAlt ? "true" : "false") << "\n\n";
 
     file << "[Advanced]\n";
@@ -301,9 +357,17 @@ bool ConfigManager::WriteConfigFile(const std::wstring& path) {
 }
 
 void ConfigManager::NotifyCallbacks() {
+    const SettingsChange change = DiffSettings(m_appliedSettings, m_settings);
+    m_appliedSettings = m_settings;
+
     for (auto& callback : m_callbacks) {
         callback(m_settings);
     }
+    if (Any(change)) {
+        for (auto& callback : m_changeCallbacks) {
+            callback(m_settings, change);
+        }
+    }
 }
 
 const char* ConfigManager::FrameGenModeToString(FrameGenMode mode) {
@@ -18,6 +18,9 @@
 #include <string>
 #include <cstdint>
 #include <functional>
+#include <vector>
+
+#include "capture/capture_method.h"
 
 namespace osfg {
 
@@ -29,13 +32,6 @@ enum class FrameGenMode {
     FrameGen4X      // Quadruple framerate (60->240)
 };
 
-// Capture method preference
-enum class CaptureMethod {
-    Auto,           // Automatically select best method
-    DXGIDesktopDup, // DXGI Desktop Duplication
-    WindowsGraphicsCapture  // Windows.Graphics.Capture API
-};
-
 // GPU selection mode
 enum class GPUMode {
     SingleGPU,      // Use primary GPU for everything
@@ -67,6 +63,7 @@ struct AppSettings {
 
     // Presentation settings
     bool vsyncEnabled = true;
+    bool variableRefresh = false;  // G-Sync/FreeSync: tearing presents, CPU pacing
     bool borderlessWindow = true;
     uint32_t windowWidth = 1920;
     uint32_t windowHeight = 1080;
@@ -83,6 +80,7 @@ struct AppSettings {
     uint32_t hotkeyToggleFrameGen = VK_F10;
     uint32_t hotkeyToggleOverlay = VK_F11;
     uint32_t hotkeyCycleMode = VK_F12;
+    uint32_t hotkeyDumpFrameRecords = VK_F9;
     bool hotkeyRequireAlt = true;
 
     // Advanced settings
@@ -92,8 +90,32 @@ struct AppSettings {
     std::wstring logFilePath = L"";
 };
 
+// Groups of AppSettings that differ between two applies (bitmask), so a
+// listener re-creates only what they feed
+enum class SettingsChange : uint32_t {
+    None         = 0,
+    FrameGen     = 1 << 0,
+    Capture      = 1 << 1,
+    GPU          = 1 << 2,
+    OpticalFlow  = 1 << 3,
+    Presentation = 1 << 4,
+    Overlay      = 1 << 5,
+    Hotkeys      = 1 << 6,
+    Advanced     = 1 << 7,
+};
+
+inline SettingsChange operator|(SettingsChange a, SettingsChange b) {
+    return static_cast<SettingsChange>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+inline SettingsChange operator&(SettingsChange a, SettingsChange b) {
+    return static_cast<SettingsChange>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+inline bool Any(SettingsChange change) { return change != SettingsChange::None; }
+
 // Callback for settings changes
 using SettingsChangedCallback = std::function<void(const AppSettings&)>;
+// The same, with what changed since the last notification
+using SettingsDiffCallback = std::function<void(const AppSettings&, SettingsChange)>;
 
 // Configuration manager
 class ConfigManager {
@@ -130,6 +152,13 @@ public:
     // Register callback for settings changes
     void RegisterCallback(SettingsChangedCallback callback);
 
+    // Register callback for settings changes that is told which groups
+    // changed (not called when nothing did)
+    void RegisterChangeCallback(SettingsDiffCallback callback);
+
+    // Groups in which two settings differ
+    static SettingsChange DiffSettings(const AppSettings& before, const AppSettings& after);
+
     // Get default config file path
     std::wstring GetDefaultConfigPath() const;
 
@@ -155,9 +184,11 @@ private:
     void NotifyCallbacks();
 
     AppSettings m_settings;
+    AppSettings m_appliedSettings;      // As of the last notification (or Load())
     std::wstring m_configPath;
     std::wstring m_lastError;
     std::vector<SettingsChangedCallback> m_callbacks;
+    std::vector<SettingsDiffCallback> m_changeCallbacks;
 };
 
 } // namespace osfg
@@ -153,7 +153,8 @@ bool HotkeyHandler::ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
 }
 
 void HotkeyHandler::RegisterDefaultHotkeys(uint32_t toggleFrameGen, uint32_t toggleOverlay,
-                                            uint32_t cycleMode, bool requireAlt) {
+                                            uint32_t cycleMode, bool requireAlt,
+                                            uint32_t dumpFrameRecords) {
     ModifierKey modifiers = requireAlt ? ModifierKey::Alt : ModifierKey::None;
 
     HotkeyBinding binding;
@@ -173,6 +174,13 @@ void HotkeyHandler::RegisterDefaultHotkeys(uint32_t toggleFrameGen, uint32_t tog
     binding.virtualKey = cycleMode;
     binding.action = HotkeyAction::CycleMode;
     RegisterHotkey(binding);
+
+    // Dump frame records
+    if (dumpFrameRecords != 0) {
+        binding.virtualKey = dumpFrameRecords;
+        binding.action = HotkeyAction::DumpFrameRecords;
+        RegisterHotkey(binding);
+    }
 }
 
 const HotkeyBinding* HotkeyHandler::GetBinding(HotkeyAction action) const {
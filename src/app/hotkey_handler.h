@@ -33,6 +33,7 @@ enum class HotkeyAction {
     DecreaseMultiplier, // Decrease frame generation multiplier
     ResetStats,         // Reset performance statistics
     TakeScreenshot,     // Capture screenshot
+    DumpFrameRecords,   // Write the pipeline's per-frame records (CSV, PresentMon CSV)
     Custom              // Custom user-defined action
 };
 
@@ -114,8 +115,10 @@ public:
     bool ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam);
 
     // Register default hotkeys based on config
+    // (dumpFrameRecords 0 = not bound)
     void RegisterDefaultHotkeys(uint32_t toggleFrameGen, uint32_t toggleOverlay,
-                                 uint32_t cycleMode, bool requireAlt);
+                                 uint32_t cycleMode, bool requireAlt,
+                                 uint32_t dumpFrameRecords = 0);
 
     // Get binding for action (if registered)
     const HotkeyBinding* GetBinding(HotkeyAction action) const;
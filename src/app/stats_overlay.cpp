@@ -5,9 +5,12 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 
 #pragma comment(lib, "d2d1.lib")
 #pragma comment(lib, "dwrite.lib")
+#pragma comment(lib, "windowscodecs.lib")
 
 namespace osfg {
 
@@ -38,7 +41,7 @@ bool StatsOverlay::Initialize(ID3D11Device* device, IDXGISwapChain* swapChain,
         return false;
     }
 
-    if (!CreateD2DResources()) {
+    if (!CreateD2DResources() || !CreateRenderTarget()) {
         Shutdown();
         return false;
     }
@@ -54,6 +57,39 @@ bool StatsOverlay::Initialize(ID3D11Device* device, IDXGISwapChain* swapChain,
     return true;
 }
 
+bool StatsOverlay::InitializeBitmap(uint32_t width, uint32_t height) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    m_width = width;
+    m_height = height;
+    m_bitmapMode = true;
+
+    // WIC needs COM on this thread; a caller that already initialized it
+    // (in either apartment model) keeps its own
+    const HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    m_comInitialized = SUCCEEDED(hr);
+
+    if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+                                IID_PPV_ARGS(&m_wicFactory)))) {
+        m_lastError = "Failed to create WIC imaging factory";
+        Shutdown();
+        return false;
+    }
+
+    if (!CreateD2DResources() || !CreateTextFormats()) {
+        Shutdown();
+        return false;
+    }
+
+    // The bitmap target is created at the overlay's size by the first Rasterize()
+    CalculateLayout();
+
+    m_initialized = true;
+    return true;
+}
+
 void StatsOverlay::Shutdown() {
     m_textFormat.Reset();
     m_titleFormat.Reset();
@@ -66,6 +102,18 @@ void StatsOverlay::Shutdown() {
     m_d2dFactory.Reset();
     m_surface.Reset();
 
+    m_bitmap.Reset();
+    m_wicFactory.Reset();
+    if (m_comInitialized) {
+        CoUninitialize();
+        m_comInitialized = false;
+    }
+    m_pixels.clear();
+    m_rasterizedLines.clear();
+    m_bitmapWidth = 0;
+    m_bitmapHeight = 0;
+    m_bitmapMode = false;
+
     m_fpsHistory.clear();
     m_initialized = false;
 }
@@ -80,19 +128,73 @@ bool StatsOverlay::CreateD2DResources() {
         return false;
     }
 
+    // Create DWrite factory
+    hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED,
+        __uuidof(IDWriteFactory), reinterpret_cast<IUnknown**>(m_dwriteFactory.GetAddressOf()));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create DWrite factory";
+        return false;
+    }
+
+    return true;
+}
+
+bool StatsOverlay::CreateRenderTarget() {
     // Create render target from DXGI surface
     D2D1_RENDER_TARGET_PROPERTIES props = D2D1::RenderTargetProperties(
         D2D1_RENDER_TARGET_TYPE_DEFAULT,
         D2D1::PixelFormat(DXGI_FORMAT_UNKNOWN, D2D1_ALPHA_MODE_PREMULTIPLIED));
 
-    hr = m_d2dFactory->CreateDxgiSurfaceRenderTarget(m_surface.Get(), &props, &m_renderTarget);
+    HRESULT hr = m_d2dFactory->CreateDxgiSurfaceRenderTarget(m_surface.Get(), &props, &m_renderTarget);
     if (FAILED(hr)) {
         m_lastError = "Failed to create D2D render target";
         return false;
     }
 
-    // Create brushes
-    hr = m_renderTarget->CreateSolidColorBrush(
+    return CreateBrushes();
+}
+
+bool StatsOverlay::CreateBitmapTarget() {
+    m_accentBrush.Reset();
+    m_textBrush.Reset();
+    m_backgroundBrush.Reset();
+    m_renderTarget.Reset();
+    m_bitmap.Reset();
+
+    m_bitmapWidth = static_cast<uint32_t>(std::ceil(m_overlayRect.right - m_overlayRect.left));
+    m_bitmapHeight = static_cast<uint32_t>(std::ceil(m_overlayRect.bottom - m_overlayRect.top));
+    if (m_bitmapWidth == 0 || m_bitmapHeight == 0) {
+        m_lastError = "Empty overlay layout";
+        return false;
+    }
+
+    HRESULT hr = m_wicFactory->CreateBitmap(m_bitmapWidth, m_bitmapHeight, GUID_WICPixelFormat32bppPBGRA,
+                                            WICBitmapCacheOnLoad, &m_bitmap);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay bitmap";
+        return false;
+    }
+
+    // Software rasterizer: no GPU device, so nothing to flush or synchronize
+    D2D1_RENDER_TARGET_PROPERTIES props = D2D1::RenderTargetProperties(
+        D2D1_RENDER_TARGET_TYPE_SOFTWARE,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED));
+
+    hr = m_d2dFactory->CreateWicBitmapRenderTarget(m_bitmap.Get(), &props, &m_renderTarget);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay bitmap render target";
+        return false;
+    }
+
+    // ClearType needs an opaque target
+    m_renderTarget->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+
+    m_pixels.assign(static_cast<size_t>(m_bitmapWidth) * m_bitmapHeight * 4, 0);
+    return CreateBrushes();
+}
+
+bool StatsOverlay::CreateBrushes() {
+    HRESULT hr = m_renderTarget->CreateSolidColorBrush(
         ArgbToColorF(m_config.backgroundColor), &m_backgroundBrush);
     if (FAILED(hr)) {
         m_lastError = "Failed to create background brush";
@@ -113,14 +215,6 @@ bool StatsOverlay::CreateD2DResources() {
         return false;
     }
 
-    // Create DWrite factory
-    hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED,
-        __uuidof(IDWriteFactory), reinterpret_cast<IUnknown**>(m_dwriteFactory.GetAddressOf()));
-    if (FAILED(hr)) {
-        m_lastError = "Failed to create DWrite factory";
-        return false;
-    }
-
     return true;
 }
 
@@ -189,7 +283,7 @@ void StatsOverlay::CalculateLayout() {
     // Calculate number of lines
     int lineCount = 1; // Title
     if (m_config.showFPS) lineCount += 2;
-    if (m_config.showFrameTime) lineCount += 2;
+    if (m_config.showFrameTime) lineCount += 3;
     if (m_config.showComponentTimings) lineCount += 5;
     if (m_config.showGPUUsage) lineCount += 2;
     if (m_config.showMemory) lineCount += 1;
@@ -221,6 +315,9 @@ void StatsOverlay::CalculateLayout() {
     }
 
     m_overlayRect = D2D1::RectF(x, y, x + overlayWidth, y + overlayHeight);
+
+    // Bitmap mode: re-create the bitmap at the new size on the next Rasterize()
+    m_layoutChanged = true;
 }
 
 void StatsOverlay::UpdateMetrics(const PerformanceMetrics& metrics) {
@@ -234,14 +331,26 @@ void StatsOverlay::UpdateMetrics(const PerformanceMetrics& metrics) {
 }
 
 void StatsOverlay::Render() {
-    if (!m_initialized || !m_visible) {
+    if (!m_initialized || !m_visible || m_bitmapMode) {
         return;
     }
 
+    std::vector<OverlayLine> lines;
+    BuildLines(lines);
+    DrawOverlay(lines);
+}
+
+void StatsOverlay::DrawOverlay(const std::vector<OverlayLine>& lines) {
     m_renderTarget->BeginDraw();
 
+    // The bitmap holds just the overlay rectangle
+    if (m_bitmapMode) {
+        m_renderTarget->Clear(D2D1::ColorF(0.0f, 0.0f, 0.0f, 0.0f));
+        m_renderTarget->SetTransform(D2D1::Matrix3x2F::Translation(-m_overlayRect.left, -m_overlayRect.top));
+    }
+
     RenderBackground();
-    RenderText();
+    RenderText(lines);
 
     HRESULT hr = m_renderTarget->EndDraw();
     if (hr == D2DERR_RECREATE_TARGET) {
@@ -250,32 +359,89 @@ void StatsOverlay::Render() {
     }
 }
 
+bool StatsOverlay::Rasterize() {
+    if (!m_initialized || !m_visible || !m_bitmapMode) {
+        return false;
+    }
+
+    // Throttled so fast-changing values (FPS) redraw a few times a second
+    const auto now = std::chrono::steady_clock::now();
+    const bool rasterized = m_bitmap && !m_layoutChanged;
+    if (rasterized && now - m_lastRasterizeTime < std::chrono::milliseconds(m_config.updateIntervalMs)) {
+        return false;
+    }
+    m_lastRasterizeTime = now;
+
+    std::vector<OverlayLine> lines;
+    BuildLines(lines);
+    if (rasterized && lines == m_rasterizedLines) {
+        return false;
+    }
+
+    if (!rasterized) {
+        if (!CreateBitmapTarget()) {
+            return false;
+        }
+        m_layoutChanged = false;
+    }
+
+    DrawOverlay(lines);
+    if (!m_initialized) {
+        return false;
+    }
+
+    WICRect rect = { 0, 0, static_cast<INT>(m_bitmapWidth), static_cast<INT>(m_bitmapHeight) };
+    ComPtr<IWICBitmapLock> lock;
+    UINT stride = 0;
+    UINT size = 0;
+    BYTE* data = nullptr;
+    if (FAILED(m_bitmap->Lock(&rect, WICBitmapLockRead, &lock)) ||
+        FAILED(lock->GetStride(&stride)) || FAILED(lock->GetDataPointer(&size, &data))) {
+        m_lastError = "Failed to read overlay bitmap";
+        return false;
+    }
+
+    const uint32_t rowPitch = GetBitmapRowPitch();
+    for (uint32_t row = 0; row < m_bitmapHeight; row++) {
+        memcpy(m_pixels.data() + static_cast<size_t>(row) * rowPitch,
+               data + static_cast<size_t>(row) * stride, rowPitch);
+    }
+
+    m_rasterizedLines = std::move(lines);
+    return true;
+}
+
 void StatsOverlay::RenderBackground() {
     // Draw rounded rectangle background
     D2D1_ROUNDED_RECT roundedRect = D2D1::RoundedRect(m_overlayRect, 8.0f, 8.0f);
     m_renderTarget->FillRoundedRectangle(roundedRect, m_backgroundBrush.Get());
 }
 
-void StatsOverlay::RenderText() {
-    float x = m_overlayRect.left + m_config.padding;
-    float y = m_overlayRect.top + m_config.padding;
-    float width = m_overlayRect.right - m_overlayRect.left - m_config.padding * 2;
+void StatsOverlay::BuildLines(std::vector<OverlayLine>& lines) const {
+    lines.clear();
 
     // Title
-    std::wstring title = L"OSFG";
+    OverlayLine title;
+    title.label = L"OSFG";
     if (m_metrics.frameGenEnabled) {
-        title += L" [" + std::to_wstring(m_metrics.frameGenMultiplier) + L"X]";
+        title.label += L" [" + std::to_wstring(m_metrics.frameGenMultiplier) + L"X]";
     } else {
-        title += L" [OFF]";
+        title.label += L" [OFF]";
     }
     if (m_metrics.dualGPUMode) {
-        title += L" Dual";
+        title.label += L" Dual";
     }
-
-    D2D1_RECT_F textRect = D2D1::RectF(x, y, x + width, y + m_lineHeight);
-    m_renderTarget->DrawText(title.c_str(), static_cast<UINT32>(title.length()),
-        m_titleFormat.Get(), textRect, m_accentBrush.Get());
-    y += m_lineHeight + 4;
+    title.title = true;
+    title.accent = true;
+    lines.push_back(title);
+
+    auto addLine = [&lines](const wchar_t* label, const std::wstring& value, bool accent) {
+        OverlayLine line;
+        line.label = label;
+        line.value = value;
+        line.accent = accent;
+        lines.push_back(line);
+    };
 
     // FPS
     if (m_config.showFPS) {
@@ -288,162 +454,78 @@ void StatsOverlay::RenderText() {
             smoothedFPS /= m_fpsHistory.size();
         }
 
-        std::wstring label = L"FPS:";
-        std::wstring value = FormatFPS(smoothedFPS);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_accentBrush.Get());
-        y += m_lineHeight;
-
-        // Base FPS
-        label = L"Base:";
-        value = FormatFPS(m_metrics.baseFPS);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
+        addLine(L"FPS:", FormatFPS(smoothedFPS), true);
+        addLine(L"Base:", FormatFPS(m_metrics.baseFPS), false);
     }
 
     // Frame times
     if (m_config.showFrameTime) {
-        std::wstring label = L"Frame:";
-        std::wstring value = FormatFrameTime(m_metrics.baseFrameTimeMs);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
-
-        // Generation time
-        label = L"Gen:";
-        value = FormatFrameTime(m_metrics.genFrameTimeMs);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
+        addLine(L"Frame:", FormatFrameTime(m_metrics.baseFrameTimeMs), false);
+        addLine(L"Gen:", FormatFrameTime(m_metrics.genFrameTimeMs), false);
+
+        // Capture-to-photon latency (real / generated)
+        std::wstringstream latency;
+        latency << std::fixed << std::setprecision(1)
+                << m_metrics.totalLatencyMs << L" / " << m_metrics.genLatencyMs << L" ms";
+        addLine(L"Latency:", latency.str(), false);
     }
 
     // Component timings
     if (m_config.showComponentTimings) {
-        struct TimingEntry {
-            const wchar_t* label;
-            double value;
-        };
-
-        TimingEntry entries[] = {
-            { L"Capture:", m_metrics.captureTimeMs },
-            { L"Transfer:", m_metrics.transferTimeMs },
-            { L"OptFlow:", m_metrics.opticalFlowTimeMs },
-            { L"Interp:", m_metrics.interpolationTimeMs },
-            { L"Present:", m_metrics.presentTimeMs }
-        };
-
-        for (const auto& entry : entries) {
-            std::wstring label = entry.label;
-            std::wstring value = FormatFrameTime(entry.value);
-
-            textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-            m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-                m_textFormat.Get(), textRect, m_textBrush.Get());
-
-            textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-            m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-                m_valueFormat.Get(), textRect, m_textBrush.Get());
-            y += m_lineHeight;
-        }
+        addLine(L"Capture:", FormatFrameTime(m_metrics.captureTimeMs), false);
+        addLine(L"Transfer:", FormatFrameTime(m_metrics.transferTimeMs), false);
+        addLine(L"OptFlow:", FormatFrameTime(m_metrics.opticalFlowTimeMs), false);
+        addLine(L"Interp:", FormatFrameTime(m_metrics.interpolationTimeMs), false);
+        addLine(L"Present:", FormatFrameTime(m_metrics.presentTimeMs), false);
     }
 
     // GPU usage
     if (m_config.showGPUUsage) {
-        std::wstring label = L"GPU1:";
-        std::wstring value = FormatPercentage(m_metrics.primaryGPUUsage);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
-
+        addLine(L"GPU1:", FormatPercentage(m_metrics.primaryGPUUsage), false);
         if (m_metrics.dualGPUMode) {
-            label = L"GPU2:";
-            value = FormatPercentage(m_metrics.secondaryGPUUsage);
-
-            textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-            m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-                m_textFormat.Get(), textRect, m_textBrush.Get());
-
-            textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-            m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-                m_valueFormat.Get(), textRect, m_textBrush.Get());
-            y += m_lineHeight;
+            addLine(L"GPU2:", FormatPercentage(m_metrics.secondaryGPUUsage), false);
         }
     }
 
     // Memory
     if (m_config.showMemory) {
-        std::wstring label = L"VRAM:";
-        std::wstring value = FormatMemory(m_metrics.vramUsageMB);
-
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
-
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
+        addLine(L"VRAM:", FormatMemory(m_metrics.vramUsageMB), false);
     }
 
     // Frame counts
     if (m_config.showFrameCounts) {
-        std::wstring label = L"Gen:";
-        std::wstring value = std::to_wstring(m_metrics.generatedFrames);
+        addLine(L"Gen:", std::to_wstring(m_metrics.generatedFrames), false);
 
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
-            m_textFormat.Get(), textRect, m_textBrush.Get());
+        // Use the accent color if frames are being dropped
+        addLine(L"Drop:", std::to_wstring(m_metrics.droppedFrames), m_metrics.droppedFrames > 0);
+    }
+}
 
-        textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
-            m_valueFormat.Get(), textRect, m_textBrush.Get());
-        y += m_lineHeight;
+void StatsOverlay::RenderText(const std::vector<OverlayLine>& lines) {
+    float x = m_overlayRect.left + m_config.padding;
+    float y = m_overlayRect.top + m_config.padding;
+    float width = m_overlayRect.right - m_overlayRect.left - m_config.padding * 2;
 
-        label = L"Drop:";
-        value = std::to_wstring(m_metrics.droppedFrames);
+    for (const OverlayLine& line : lines) {
+        if (line.title) {
+            D2D1_RECT_F textRect = D2D1::RectF(x, y, x + width, y + m_lineHeight);
+            m_renderTarget->DrawText(line.label.c_str(), static_cast<UINT32>(line.label.length()),
+                m_titleFormat.Get(), textRect, m_accentBrush.Get());
+            y += m_lineHeight + 4;
+            continue;
+        }
 
-        textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
-        m_renderTarget->DrawText(label.c_str(), static_cast<UINT32>(label.length()),
+        D2D1_RECT_F textRect = D2D1::RectF(x, y, x + width * 0.5f, y + m_lineHeight);
+        m_renderTarget->DrawText(line.label.c_str(), static_cast<UINT32>(line.label.length()),
             m_textFormat.Get(), textRect, m_textBrush.Get());
 
-        // Use red color if frames are being dropped
-        ID2D1Brush* valueBrush = m_metrics.droppedFrames > 0 ?
+        ID2D1Brush* valueBrush = line.accent ?
             static_cast<ID2D1Brush*>(m_accentBrush.Get()) : m_textBrush.Get();
 
         textRect = D2D1::RectF(x + width * 0.5f, y, x + width, y + m_lineHeight);
-        m_renderTarget->DrawText(value.c_str(), static_cast<UINT32>(value.length()),
+        m_renderTarget->DrawText(line.value.c_str(), static_cast<UINT32>(line.value.length()),
             m_valueFormat.Get(), textRect, valueBrush);
+        y += m_lineHeight;
     }
 }
 
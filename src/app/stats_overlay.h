@@ -2,7 +2,10 @@
 // Statistics Overlay
 //
 // Displays real-time performance statistics on screen.
-// Uses Direct2D for efficient text rendering.
+// Uses Direct2D for efficient text rendering: onto a D3D11 swap chain, or
+// in bitmap mode into a small CPU bitmap that is re-rasterized only when
+// the displayed text changes, for a D3D12 presenter to composite
+// (OSFG::OverlayCompositor).
 // MIT License - Part of Open Source Frame Generation project
 
 #pragma once
@@ -18,11 +21,13 @@
 #include <d2d1.h>
 #include <dwrite.h>
 #include <d3d11.h>
+#include <wincodec.h>
 #include <wrl/client.h>
 #include <string>
 #include <cstdint>
 #include <chrono>
 #include <deque>
+#include <vector>
 
 namespace osfg {
 
@@ -46,7 +51,8 @@ struct PerformanceMetrics {
     // Frame times
     double baseFrameTimeMs = 0.0;   // Base frame time
     double genFrameTimeMs = 0.0;    // Frame generation time
-    double totalLatencyMs = 0.0;    // Total pipeline latency
+    double totalLatencyMs = 0.0;    // Source present to scan-out, real frames (PipelineStats::glassLatencyRealMs)
+    double genLatencyMs = 0.0;      // Source present to scan-out, generated frames
 
     // Component timings
     double captureTimeMs = 0.0;
@@ -90,6 +96,7 @@ struct OverlayConfig {
     bool showMemory = false;
     bool showFrameCounts = false;
     bool compactMode = false;
+    uint32_t updateIntervalMs = 250;        // Bitmap mode: minimum time between re-rasterizations
 };
 
 // Statistics overlay renderer
@@ -106,6 +113,10 @@ public:
     bool Initialize(ID3D11Device* device, IDXGISwapChain* swapChain,
                    uint32_t width, uint32_t height);
 
+    // Bitmap mode: rasterize (in software, no GPU device) into a bitmap the
+    // size of the overlay, placed for a width x height render target
+    bool InitializeBitmap(uint32_t width, uint32_t height);
+
     // Shutdown and release resources
     void Shutdown();
 
@@ -126,6 +137,19 @@ public:
     // Call this after your main rendering, before Present()
     void Render();
 
+    // Bitmap mode: re-rasterize if the displayed text changed and
+    // config.updateIntervalMs has passed. Returns true if GetPixels() changed.
+    bool Rasterize();
+
+    // Bitmap mode: the last rasterized overlay, premultiplied BGRA8 rows of
+    // GetBitmapRowPitch() bytes, to be drawn at (GetBitmapX(), GetBitmapY())
+    const uint8_t* GetPixels() const { return m_pixels.empty() ? nullptr : m_pixels.data(); }
+    uint32_t GetBitmapWidth() const { return m_bitmapWidth; }
+    uint32_t GetBitmapHeight() const { return m_bitmapHeight; }
+    uint32_t GetBitmapRowPitch() const { return m_bitmapWidth * 4; }
+    int32_t GetBitmapX() const { return static_cast<int32_t>(m_overlayRect.left); }
+    int32_t GetBitmapY() const { return static_cast<int32_t>(m_overlayRect.top); }
+
     // Handle resize
     void OnResize(uint32_t width, uint32_t height);
 
@@ -137,11 +161,29 @@ public:
     const std::string& GetLastError() const { return m_lastError; }
 
 private:
+    // One row of the overlay: a title, or a label with its value
+    struct OverlayLine {
+        std::wstring label;
+        std::wstring value;
+        bool title = false;
+        bool accent = false;    // Value (or title) in the accent colour
+
+        bool operator==(const OverlayLine& other) const {
+            return label == other.label && value == other.value &&
+                   title == other.title && accent == other.accent;
+        }
+    };
+
     bool CreateD2DResources();
+    bool CreateRenderTarget();
+    bool CreateBitmapTarget();
+    bool CreateBrushes();
     bool CreateTextFormats();
     void CalculateLayout();
+    void BuildLines(std::vector<OverlayLine>& lines) const;
+    void DrawOverlay(const std::vector<OverlayLine>& lines);
     void RenderBackground();
-    void RenderText();
+    void RenderText(const std::vector<OverlayLine>& lines);
 
     std::wstring FormatFPS(double fps) const;
     std::wstring FormatFrameTime(double ms) const;
@@ -164,6 +206,18 @@ private:
     // DXGI surface
     ComPtr<IDXGISurface> m_surface;
 
+    // Bitmap mode: WIC bitmap target and a packed copy of its pixels
+    ComPtr<IWICImagingFactory> m_wicFactory;
+    ComPtr<IWICBitmap> m_bitmap;
+    std::vector<uint8_t> m_pixels;
+    uint32_t m_bitmapWidth = 0;
+    uint32_t m_bitmapHeight = 0;
+    bool m_bitmapMode = false;
+    bool m_comInitialized = false;
+    std::vector<OverlayLine> m_rasterizedLines;
+    std::chrono::steady_clock::time_point m_lastRasterizeTime;
+    bool m_layoutChanged = false;
+
     // Configuration and state
     OverlayConfig m_config;
     PerformanceMetrics m_metrics;
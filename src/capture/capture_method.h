@@ -0,0 +1,21 @@
+// OSFG - Open Source Frame Generation
+// Capture Method
+//
+// Which capture backend to use. Shared by the application settings
+// (AppSettings::captureMethod) and the pipeline (DualGPUConfig::captureMethod),
+// so it lives apart from the D3D11 capture headers.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+namespace osfg {
+
+// Capture method preference
+enum class CaptureMethod {
+    Auto,                   // WGC for a window; else Desktop Duplication, WGC if it is unavailable
+    DXGIDesktopDup,         // DXGICapture: whole monitor
+    WindowsGraphicsCapture  // WGCCapture: captureWindow, or the monitor
+};
+
+} // namespace osfg
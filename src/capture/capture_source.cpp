@@ -0,0 +1,280 @@
+// OSFG - Open Source Frame Generation
+// Capture Source Implementation
+
+#include "capture_source.h"
+#include <dxgi1_6.h>
+#include <algorithm>
+#include <sstream>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+
+namespace osfg {
+
+bool CaptureSource::CreateD3D11Device(uint32_t adapterIndex, UINT extraFlags) {
+    HRESULT hr;
+
+    // Create DXGI factory
+    ComPtr<IDXGIFactory1> factory;
+    hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+    if (FAILED(hr)) {
+        SetError("Failed to create DXGI factory");
+        return false;
+    }
+
+    // Get the specified adapter
+    ComPtr<IDXGIAdapter1> adapter;
+    hr = factory->EnumAdapters1(adapterIndex, &adapter);
+    if (FAILED(hr)) {
+        SetError("Failed to get adapter " + std::to_string(adapterIndex));
+        return false;
+    }
+
+    // Create D3D11 device
+    D3D_FEATURE_LEVEL featureLevels[] = {
+        D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_11_0,
+    };
+
+    UINT createFlags = extraFlags;
+#ifdef _DEBUG
+    createFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    D3D_FEATURE_LEVEL featureLevel;
+    hr = D3D11CreateDevice(
+        adapter.Get(),
+        D3D_DRIVER_TYPE_UNKNOWN,
+        nullptr,
+        createFlags,
+        featureLevels,
+        ARRAYSIZE(featureLevels),
+        D3D11_SDK_VERSION,
+        &m_device,
+        &featureLevel,
+        &m_context
+    );
+
+    if (FAILED(hr)) {
+        SetError("Failed to create D3D11 device");
+        return false;
+    }
+
+    return true;
+}
+
+bool CaptureSource::IsHDRMonitor(HMONITOR monitor) const {
+    ComPtr<IDXGIDevice> dxgiDevice;
+    ComPtr<IDXGIAdapter> adapter;
+    if (!monitor || !m_device || FAILED(m_device.As(&dxgiDevice)) || FAILED(dxgiDevice->GetAdapter(&adapter))) {
+        return false;
+    }
+
+    ComPtr<IDXGIOutput> output;
+    for (UINT i = 0; adapter->EnumOutputs(i, &output) != DXGI_ERROR_NOT_FOUND; i++) {
+        ComPtr<IDXGIOutput6> output6;
+        DXGI_OUTPUT_DESC1 desc = {};
+        if (SUCCEEDED(output.As(&output6)) && SUCCEEDED(output6->GetDesc1(&desc)) && desc.Monitor == monitor) {
+            return desc.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+        }
+        output.Reset();
+    }
+    return false;
+}
+
+bool CaptureSource::GetChangedRects(const CapturedFrame& frame, std::vector<RECT>& rects) {
+    rects.clear();
+    if (!frame.hasImageUpdate) {
+        return true;
+    }
+    if (frame.fullFrameUpdate) {
+        return false;
+    }
+
+    // A move only changes its destination; the source area keeps its pixels
+    // unless it is also reported dirty
+    rects.reserve(frame.dirtyRects.size() + frame.moveRects.size());
+    for (const auto& move : frame.moveRects) {
+        rects.push_back(move.DestinationRect);
+    }
+    rects.insert(rects.end(), frame.dirtyRects.begin(), frame.dirtyRects.end());
+    return true;
+}
+
+bool CaptureSource::OpenSharedTargets(const HANDLE* textureHandles, uint32_t count, HANDLE fenceHandle) {
+    if (!m_device) {
+        SetError("Not initialized");
+        return false;
+    }
+
+    if (!textureHandles || count == 0 || !fenceHandle) {
+        SetError("Invalid shared target handles");
+        return false;
+    }
+
+    // Opening NT handles needs D3D11.1, GPU fences need D3D11.4 (Windows 10 1703+)
+    ComPtr<ID3D11Device1> device1;
+    ComPtr<ID3D11Device5> device5;
+    if (FAILED(m_device.As(&device1)) || FAILED(m_device.As(&device5)) ||
+        FAILED(m_context.As(&m_context4))) {
+        SetError("Shared targets require D3D11.4");
+        return false;
+    }
+
+    m_sharedTargets.clear();
+    m_sharedTargets.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        HRESULT hr = device1->OpenSharedResource1(textureHandles[i], IID_PPV_ARGS(&m_sharedTargets[i]));
+        if (FAILED(hr)) {
+            std::stringstream ss;
+            ss << "Failed to open shared target " << i << " (0x" << std::hex << hr << ")";
+            SetError(ss.str());
+            m_sharedTargets.clear();
+            return false;
+        }
+    }
+
+    HRESULT hr = device5->OpenSharedFence(fenceHandle, IID_PPV_ARGS(&m_sharedFence));
+    if (FAILED(hr)) {
+        SetError("Failed to open shared fence");
+        m_sharedTargets.clear();
+        return false;
+    }
+
+    m_sharedFenceValue = m_sharedFence->GetCompletedValue();
+    m_sharedTargetRegions.Initialize(count, m_width, m_height);
+    return true;
+}
+
+bool CaptureSource::CopyToSharedTarget(const CapturedFrame& frame, uint32_t index, uint64_t& fenceValue) {
+    if (!frame.isValid || !frame.texture) {
+        SetError("Invalid frame");
+        return false;
+    }
+
+    if (index >= m_sharedTargets.size() || !m_sharedFence) {
+        SetError("Shared target " + std::to_string(index) + " not open");
+        return false;
+    }
+
+    // GPU copy out of the captured surface; the reader waits on the fence
+    // GPU-side, so nothing here blocks the CPU. Targets that already hold an
+    // earlier frame only receive the regions changed since.
+    const bool partial = GetChangedRects(frame, m_changedRects);
+    m_sharedTargetRegions.AddFrame(partial ? m_changedRects.data() : nullptr,
+                                   static_cast<uint32_t>(m_changedRects.size()));
+
+    if (m_sharedTargetRegions.IsFull(index)) {
+        // Backends may hand out surfaces larger than the capture (WGC frame
+        // pool buffers); the image is always at the top-left
+        D3D11_BOX box = { 0, 0, 0, m_width, m_height, 1 };
+        m_context->CopySubresourceRegion(m_sharedTargets[index].Get(), 0, 0, 0, 0,
+                                         frame.texture.Get(), 0, &box);
+    } else {
+        for (const RECT& r : m_sharedTargetRegions.GetRects(index)) {
+            D3D11_BOX box = { static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0,
+                              static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1 };
+            m_context->CopySubresourceRegion(m_sharedTargets[index].Get(), 0,
+                                             box.left, box.top, 0,
+                                             frame.texture.Get(), 0, &box);
+        }
+    }
+    m_sharedTargetRegions.MarkWritten(index);
+
+    m_sharedFenceValue++;
+    HRESULT hr = m_context4->Signal(m_sharedFence.Get(), m_sharedFenceValue);
+    if (FAILED(hr)) {
+        SetError("Failed to signal shared fence");
+        return false;
+    }
+    m_context->Flush();
+
+    fenceValue = m_sharedFenceValue;
+    return true;
+}
+
+bool CaptureSource::MapFrame(const CapturedFrame& frame, D3D11_MAPPED_SUBRESOURCE& mapped) {
+    if (!frame.isValid || !frame.texture) {
+        SetError("Invalid frame");
+        return false;
+    }
+
+    if (m_readbackMapped) {
+        UnmapFrame();
+    }
+
+    // Re-created when a recovery changed the capture size
+    if (m_readbackTexture) {
+        D3D11_TEXTURE2D_DESC current;
+        m_readbackTexture->GetDesc(&current);
+        if (current.Width != m_width || current.Height != m_height || current.Format != m_format) {
+            m_readbackTexture.Reset();
+        }
+    }
+
+    if (!m_readbackTexture) {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = m_width;
+        desc.Height = m_height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = m_format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &m_readbackTexture);
+        if (FAILED(hr)) {
+            SetError("Failed to create readback texture");
+            return false;
+        }
+    }
+
+    // Same top-left box as CopyToSharedTarget()
+    D3D11_BOX box = { 0, 0, 0, m_width, m_height, 1 };
+    m_context->CopySubresourceRegion(m_readbackTexture.Get(), 0, 0, 0, 0, frame.texture.Get(), 0, &box);
+
+    HRESULT hr = m_context->Map(m_readbackTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped);
+    if (FAILED(hr)) {
+        SetError("Failed to map readback texture");
+        return false;
+    }
+    m_readbackMapped = true;
+    return true;
+}
+
+void CaptureSource::UnmapFrame() {
+    if (m_readbackMapped) {
+        m_context->Unmap(m_readbackTexture.Get(), 0);
+        m_readbackMapped = false;
+    }
+}
+
+void CaptureSource::ReleaseSharedTargets() {
+    m_sharedTargets.clear();
+    m_sharedFence.Reset();
+    m_context4.Reset();
+    m_sharedFenceValue = 0;
+    UnmapFrame();
+    m_readbackTexture.Reset();
+}
+
+void CaptureSource::RecordCaptureTime(double captureTimeMs) {
+    m_stats.framesCapture++;
+    m_stats.lastCaptureTimeMs = captureTimeMs;
+    m_stats.minCaptureTimeMs = (std::min)(m_stats.minCaptureTimeMs, captureTimeMs);
+    m_stats.maxCaptureTimeMs = (std::max)(m_stats.maxCaptureTimeMs, captureTimeMs);
+
+    // Running average
+    double alpha = 0.1;
+    m_stats.avgCaptureTimeMs = m_stats.avgCaptureTimeMs * (1.0 - alpha) + captureTimeMs * alpha;
+}
+
+void CaptureSource::ResetStats() {
+    m_stats = CaptureStats{};
+}
+
+void CaptureSource::SetError(const std::string& error) {
+    m_lastError = error;
+}
+
+} // namespace osfg
@@ -0,0 +1,211 @@
+// OSFG - Open Source Frame Generation
+// Capture Source
+//
+// Common interface of the capture backends (DXGICapture, WGCCapture). Each
+// backend acquires frames as D3D11 textures on its own device; the shared
+// target path that hands them to the transfer or the single-GPU frame ring
+// is the same for all of them and lives here.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <d3d11.h>
+#include <d3d11_4.h>
+#include <dxgi1_2.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+#include <chrono>
+#include <vector>
+
+#include "common/dirty_regions.h"
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Frame capture statistics
+struct CaptureStats {
+    uint64_t framesCapture = 0;
+    uint64_t framesMissed = 0;
+    uint64_t framesUnchanged = 0;      // Acquired with no new desktop image (cursor-only)
+    uint64_t recoveries = 0;           // Capture re-created in place after it was lost
+    double avgCaptureTimeMs = 0.0;
+    double lastCaptureTimeMs = 0.0;
+    double minCaptureTimeMs = 1000000.0;
+    double maxCaptureTimeMs = 0.0;
+};
+
+// Captured frame data
+struct CapturedFrame {
+    ComPtr<ID3D11Texture2D> texture;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    uint64_t frameNumber = 0;
+    std::chrono::high_resolution_clock::time_point captureTime;  // When the frame was acquired (after any wait)
+    bool isValid = false;
+
+    // Change metadata relative to the previous acquired frame
+    bool hasImageUpdate = true;        // false when LastPresentTime == 0 (cursor/pointer-only update)
+    int64_t presentTimeQpc = 0;        // LastPresentTime: QPC time the desktop image was presented
+    uint32_t accumulatedFrames = 1;    // Source presents folded into this frame (> 1: some were never captured)
+    bool fullFrameUpdate = true;       // Metadata unavailable: treat the whole frame as changed
+    std::vector<RECT> dirtyRects;
+    std::vector<DXGI_OUTDUPL_MOVE_RECT> moveRects;
+};
+
+// Configuration for the capture engine
+struct CaptureConfig {
+    uint32_t outputIndex = 0;          // Which monitor to capture
+    uint32_t adapterIndex = 0;         // Which GPU adapter to use
+    bool createStagingTexture = false; // Create CPU-readable staging texture
+    uint32_t timeoutMs = 16;           // Timeout for frame acquisition (0 = no wait)
+
+    // Capture R16G16B16A16_FLOAT scRGB (linear BT.709, 1.0 = 80 nits) when
+    // the monitor is in HDR mode, instead of the 8-bit image Windows
+    // tone-maps it down to. GetFormat() reports what is delivered.
+    bool hdr = false;
+
+    // Windows.Graphics.Capture only
+    HWND window = nullptr;             // Capture this window instead of monitor outputIndex
+    bool captureCursor = true;         // Draw the cursor into captured frames
+};
+
+// Capture backend interface
+class CaptureSource {
+public:
+    CaptureSource() = default;
+    virtual ~CaptureSource() = default;
+
+    // Disable copy
+    CaptureSource(const CaptureSource&) = delete;
+    CaptureSource& operator=(const CaptureSource&) = delete;
+
+    // Initialize the capture engine on its own device
+    // Returns true on success, false on failure
+    virtual bool Initialize(const CaptureConfig& config = CaptureConfig{}) = 0;
+
+    // Initialize with an external D3D11 device (for interop scenarios)
+    virtual bool Initialize(ID3D11Device* externalDevice, const CaptureConfig& config = CaptureConfig{}) = 0;
+
+    // Shutdown and release all resources
+    virtual void Shutdown() = 0;
+
+    // Capture the next frame
+    // Returns true if a new frame was captured, false if no new frame or error
+    virtual bool CaptureFrame(CapturedFrame& outFrame) = 0;
+
+    // Release the current frame (must be called before next capture)
+    virtual void ReleaseFrame() = 0;
+
+    // Open shared NT-handle textures and a shared fence created by another
+    // device (e.g. GPUTransfer ingest textures) on the capture device
+    bool OpenSharedTargets(const HANDLE* textureHandles, uint32_t count, HANDLE fenceHandle);
+
+    // Copy a captured frame into shared target `index` on the GPU and signal
+    // the shared fence. fenceValue receives the value the reader must wait on.
+    // The frame can be released as soon as this returns. Only regions that
+    // changed since target `index` was last written are copied, so every
+    // captured frame must go through here (or InvalidateSharedTargets()).
+    bool CopyToSharedTarget(const CapturedFrame& frame, uint32_t index, uint64_t& fenceValue);
+
+    // Force the next copy into each shared target to be a full copy
+    void InvalidateSharedTargets() { m_sharedTargetRegions.Invalidate(); }
+
+    // Read a captured frame back to the CPU, for readers that cannot open
+    // shared targets (no D3D11.4 or NT-handle sharing): copies it into a
+    // staging texture and maps it, stalling until the copy is done.
+    // UnmapFrame() before the next call; the frame can be released at once.
+    bool MapFrame(const CapturedFrame& frame, D3D11_MAPPED_SUBRESOURCE& mapped);
+    void UnmapFrame();
+
+    // Collect the rects that changed in `frame` (dirty rects plus move
+    // destinations). Returns false if the whole frame must be treated as changed.
+    static bool GetChangedRects(const CapturedFrame& frame, std::vector<RECT>& rects);
+
+    // Get capture statistics
+    const CaptureStats& GetStats() const { return m_stats; }
+
+    // Reset statistics
+    void ResetStats();
+
+    // Get the D3D11 device (for resource sharing)
+    ID3D11Device* GetDevice() const { return m_device.Get(); }
+
+    // Get the D3D11 device context
+    ID3D11DeviceContext* GetContext() const { return m_context.Get(); }
+
+    // Get the last error message
+    const std::string& GetLastError() const { return m_lastError; }
+
+    // Get capture dimensions
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+
+    // Format of captured frames: B8G8R8A8_UNORM, or R16G16B16A16_FLOAT with
+    // CaptureConfig::hdr on an HDR monitor. Fixed from Initialize() on
+    // (shared targets must be created in it).
+    DXGI_FORMAT GetFormat() const { return m_format; }
+
+    // Monitor being captured (the captured window's, for a window)
+    HMONITOR GetMonitor() const { return m_monitor; }
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // True while the backend has lost its capture (e.g. desktop duplication
+    // access lost on a mode change or secure desktop) and is re-creating it.
+    // CaptureFrame() keeps returning false until it is back.
+    bool IsRecovering() const { return m_recovering; }
+
+protected:
+    bool CreateD3D11Device(uint32_t adapterIndex, UINT extraFlags = 0);
+    void ReleaseSharedTargets();
+    void RecordCaptureTime(double captureTimeMs);
+    void SetError(const std::string& error);
+
+    // True if `monitor` is an output of the capture device's adapter that is
+    // in HDR mode (HDR10 colour space)
+    bool IsHDRMonitor(HMONITOR monitor) const;
+
+    // D3D11 resources
+    ComPtr<ID3D11Device> m_device;
+    ComPtr<ID3D11DeviceContext> m_context;
+
+    // State
+    bool m_initialized = false;
+    bool m_recovering = false;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    DXGI_FORMAT m_format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    HMONITOR m_monitor = nullptr;
+    uint64_t m_frameCounter = 0;
+    CaptureConfig m_config;
+    CaptureStats m_stats;
+    std::string m_lastError;
+
+private:
+    // Shared targets written by CopyToSharedTarget()
+    std::vector<ComPtr<ID3D11Texture2D>> m_sharedTargets;
+    ComPtr<ID3D11Fence> m_sharedFence;
+    ComPtr<ID3D11DeviceContext4> m_context4;
+    uint64_t m_sharedFenceValue = 0;
+    DirtyRegionTracker m_sharedTargetRegions;
+    std::vector<RECT> m_changedRects;   // Scratch for CopyToSharedTarget()
+
+    // Written and mapped by MapFrame()
+    ComPtr<ID3D11Texture2D> m_readbackTexture;
+    bool m_readbackMapped = false;
+};
+
+} // namespace osfg
@@ -72,70 +72,20 @@ void DXGICapture::Shutdown() {
         m_frameAcquired = false;
     }
 
+    ReleaseSharedTargets();
+
     m_stagingTexture.Reset();
     m_duplication.Reset();
     m_context.Reset();
     m_device.Reset();
 
     m_initialized = false;
+    m_recovering = false;
+    m_fullFramePending = false;
     m_width = 0;
     m_height = 0;
-}
-
-bool DXGICapture::CreateD3D11Device(uint32_t adapterIndex) {
-    HRESULT hr;
-
-    // Create DXGI factory
-    ComPtr<IDXGIFactory1> factory;
-    hr = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
-    if (FAILED(hr)) {
-        SetError("Failed to create DXGI factory");
-        return false;
-    }
-
-    // Get the specified adapter
-    ComPtr<IDXGIAdapter1> adapter;
-    hr = factory->EnumAdapters1(adapterIndex, &adapter);
-    if (FAILED(hr)) {
-        SetError("Failed to get adapter " + std::to_string(adapterIndex));
-        return false;
-    }
-
-    // Log adapter info
-    DXGI_ADAPTER_DESC1 adapterDesc;
-    adapter->GetDesc1(&adapterDesc);
-
-    // Create D3D11 device
-    D3D_FEATURE_LEVEL featureLevels[] = {
-        D3D_FEATURE_LEVEL_11_1,
-        D3D_FEATURE_LEVEL_11_0,
-    };
-
-    UINT createFlags = 0;
-#ifdef _DEBUG
-    createFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif
-
-    D3D_FEATURE_LEVEL featureLevel;
-    hr = D3D11CreateDevice(
-        adapter.Get(),
-        D3D_DRIVER_TYPE_UNKNOWN,
-        nullptr,
-        createFlags,
-        featureLevels,
-        ARRAYSIZE(featureLevels),
-        D3D11_SDK_VERSION,
-        &m_device,
-        &featureLevel,
-        &m_context
-    );
-
-    if (FAILED(hr)) {
-        SetError("Failed to create D3D11 device");
-        return false;
-    }
-
-    return true;
+    m_format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    m_monitor = nullptr;
 }
 
 bool DXGICapture::InitializeDesktopDuplication(uint32_t outputIndex) {
@@ -178,9 +128,34 @@ bool DXGICapture::InitializeDesktopDuplication(uint32_t outputIndex) {
     output->GetDesc(&outputDesc);
     m_width = outputDesc.DesktopCoordinates.right - outputDesc.DesktopCoordinates.left;
     m_height = outputDesc.DesktopCoordinates.bottom - outputDesc.DesktopCoordinates.top;
+    m_monitor = outputDesc.Monitor;
+
+    // HDR desktops compose in FP16 scRGB, which DuplicateOutput1 hands out
+    // as is. The format is chosen once: re-duplication after access loss
+    // keeps the one the shared targets were created in.
+    const bool chooseFormat = !m_initialized;
+    if (chooseFormat) {
+        m_format = m_config.hdr && IsHDRMonitor(outputDesc.Monitor) ? DXGI_FORMAT_R16G16B16A16_FLOAT
+                                                                     : DXGI_FORMAT_B8G8R8A8_UNORM;
+    }
 
     // Create desktop duplication
-    hr = output1->DuplicateOutput(m_device.Get(), &m_duplication);
+    if (m_format == DXGI_FORMAT_R16G16B16A16_FLOAT) {
+        ComPtr<IDXGIOutput5> output5;
+        hr = output.As(&output5);
+        if (SUCCEEDED(hr)) {
+            const DXGI_FORMAT formats[] = { DXGI_FORMAT_R16G16B16A16_FLOAT };
+            hr = output5->DuplicateOutput1(m_device.Get(), 0, 1, formats, &m_duplication);
+        }
+
+        // E.g. a process that is not per-monitor DPI aware: capture 8-bit
+        if (FAILED(hr) && chooseFormat && hr != DXGI_ERROR_NOT_CURRENTLY_AVAILABLE && hr != E_ACCESSDENIED) {
+            m_format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        }
+    }
+    if (m_format == DXGI_FORMAT_B8G8R8A8_UNORM) {
+        hr = output1->DuplicateOutput(m_device.Get(), &m_duplication);
+    }
     if (FAILED(hr)) {
         if (hr == DXGI_ERROR_NOT_CURRENTLY_AVAILABLE) {
             SetError("Desktop duplication not available - another app may be using it");
@@ -201,7 +176,7 @@ bool DXGICapture::InitializeDesktopDuplication(uint32_t outputIndex) {
         stagingDesc.Height = m_height;
         stagingDesc.MipLevels = 1;
         stagingDesc.ArraySize = 1;
-        stagingDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        stagingDesc.Format = m_format;
         stagingDesc.SampleDesc.Count = 1;
         stagingDesc.Usage = D3D11_USAGE_STAGING;
         stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
@@ -216,6 +191,26 @@ bool DXGICapture::InitializeDesktopDuplication(uint32_t outputIndex) {
     return true;
 }
 
+bool DXGICapture::RecreateDuplication() {
+    m_stagingTexture.Reset();
+    m_duplication.Reset();
+
+    // Fails while the secure desktop is up or the mode switch is still in
+    // progress; the caller retries on its next capture
+    if (!InitializeDesktopDuplication(m_config.outputIndex)) {
+        m_duplication.Reset();
+        m_stagingTexture.Reset();
+        return false;
+    }
+
+    // Damage reported by the new duplication is not relative to anything
+    // the shared targets hold
+    m_fullFramePending = true;
+    m_recovering = false;
+    m_stats.recoveries++;
+    return true;
+}
+
 bool DXGICapture::CaptureFrame(CapturedFrame& outFrame) {
     if (!m_initialized) {
         SetError("Not initialized");
@@ -228,6 +223,16 @@ bool DXGICapture::CaptureFrame(CapturedFrame& outFrame) {
         m_frameAcquired = false;
     }
 
+    if (m_recovering && !RecreateDuplication()) {
+        // Nothing to wait on until duplication is back; sleep like a timed
+        // out acquire so capture loops do not spin
+        if (m_config.timeoutMs > 0) {
+            Sleep(m_config.timeoutMs);
+        }
+        outFrame.isValid = false;
+        return false;
+    }
+
     auto startTime = std::chrono::high_resolution_clock::now();
 
     // Acquire next frame
@@ -247,9 +252,12 @@ bool DXGICapture::CaptureFrame(CapturedFrame& outFrame) {
     }
 
     if (hr == DXGI_ERROR_ACCESS_LOST) {
-        // Desktop duplication lost - need to reinitialize
-        SetError("Desktop duplication access lost - reinitialize required");
-        m_initialized = false;
+        // Mode change, fullscreen transition or secure desktop: only the
+        // duplication is invalid. Re-create it now, or on later calls.
+        SetError("Desktop duplication access lost - recreating");
+        m_recovering = true;
+        RecreateDuplication();
+        outFrame.isValid = false;
         return false;
     }
 
@@ -278,27 +286,77 @@ bool DXGICapture::CaptureFrame(CapturedFrame& outFrame) {
     double captureTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
     // Update statistics
-    m_stats.framesCapture++;
-    m_stats.lastCaptureTimeMs = captureTimeMs;
-    m_stats.minCaptureTimeMs = (std::min)(m_stats.minCaptureTimeMs, captureTimeMs);
-    m_stats.maxCaptureTimeMs = (std::max)(m_stats.maxCaptureTimeMs, captureTimeMs);
-
-    // Running average
-    double alpha = 0.1;
-    m_stats.avgCaptureTimeMs = m_stats.avgCaptureTimeMs * (1.0 - alpha) + captureTimeMs * alpha;
+    RecordCaptureTime(captureTimeMs);
+
+    ReadFrameMetadata(frameInfo, outFrame);
+    if (!outFrame.hasImageUpdate) {
+        m_stats.framesUnchanged++;
+    } else if (m_fullFramePending) {
+        outFrame.dirtyRects.clear();
+        outFrame.moveRects.clear();
+        outFrame.fullFrameUpdate = true;
+        m_fullFramePending = false;
+    }
 
     // Fill output frame
     outFrame.texture = texture;
     outFrame.width = m_width;
     outFrame.height = m_height;
-    outFrame.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    outFrame.format = m_format;
     outFrame.frameNumber = m_frameCounter++;
-    outFrame.captureTime = startTime;
+    outFrame.captureTime = endTime;
     outFrame.isValid = true;
 
     return true;
 }
 
+void DXGICapture::ReadFrameMetadata(const DXGI_OUTDUPL_FRAME_INFO& frameInfo, CapturedFrame& frame) {
+    frame.dirtyRects.clear();
+    frame.moveRects.clear();
+
+    // A zero present time means only the pointer changed; the desktop image
+    // is the same as the previous frame
+    frame.hasImageUpdate = frameInfo.LastPresentTime.QuadPart != 0;
+    frame.presentTimeQpc = frameInfo.LastPresentTime.QuadPart;
+    frame.accumulatedFrames = frameInfo.AccumulatedFrames;
+    frame.fullFrameUpdate = false;
+    if (!frame.hasImageUpdate) {
+        return;
+    }
+
+    if (frameInfo.TotalMetadataBufferSize == 0) {
+        frame.fullFrameUpdate = true;
+        return;
+    }
+
+    // Move rects first: they are applied before the dirty rects. Both fit in
+    // TotalMetadataBufferSize, so size each vector for the whole buffer.
+    UINT bufferSize = frameInfo.TotalMetadataBufferSize;
+    frame.moveRects.resize(bufferSize / sizeof(DXGI_OUTDUPL_MOVE_RECT) + 1);
+    UINT required = 0;
+    HRESULT hr = m_duplication->GetFrameMoveRects(
+        static_cast<UINT>(frame.moveRects.size() * sizeof(DXGI_OUTDUPL_MOVE_RECT)),
+        frame.moveRects.data(), &required);
+    if (FAILED(hr)) {
+        frame.moveRects.clear();
+        frame.fullFrameUpdate = true;
+        return;
+    }
+    frame.moveRects.resize(required / sizeof(DXGI_OUTDUPL_MOVE_RECT));
+
+    frame.dirtyRects.resize(bufferSize / sizeof(RECT) + 1);
+    hr = m_duplication->GetFrameDirtyRects(
+        static_cast<UINT>(frame.dirtyRects.size() * sizeof(RECT)),
+        frame.dirtyRects.data(), &required);
+    if (FAILED(hr)) {
+        frame.moveRects.clear();
+        frame.dirtyRects.clear();
+        frame.fullFrameUpdate = true;
+        return;
+    }
+    frame.dirtyRects.resize(required / sizeof(RECT));
+}
+
 void DXGICapture::ReleaseFrame() {
     if (m_frameAcquired && m_duplication) {
         m_duplication->ReleaseFrame();
@@ -306,12 +364,4 @@ void DXGICapture::ReleaseFrame() {
     }
 }
 
-void DXGICapture::ResetStats() {
-    m_stats = CaptureStats{};
-}
-
-void DXGICapture::SetError(const std::string& error) {
-    m_lastError = error;
-}
-
 } // namespace osfg
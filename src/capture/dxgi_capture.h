@@ -12,118 +12,51 @@
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
-#include <Windows.h>
-#include <d3d11.h>
-#include <dxgi1_2.h>
-#include <wrl/client.h>
+#include "capture_source.h"
 
-#include <cstdint>
-#include <string>
-#include <functional>
-#include <chrono>
+#include <dxgi1_2.h>
 
 namespace osfg {
 
-using Microsoft::WRL::ComPtr;
-
-// Frame capture statistics
-struct CaptureStats {
-    uint64_t framesCapture = 0;
-    uint64_t framesMissed = 0;
-    double avgCaptureTimeMs = 0.0;
-    double lastCaptureTimeMs = 0.0;
-    double minCaptureTimeMs = 1000000.0;
-    double maxCaptureTimeMs = 0.0;
-};
-
-// Captured frame data
-struct CapturedFrame {
-    ComPtr<ID3D11Texture2D> texture;
-    uint32_t width = 0;
-    uint32_t height = 0;
-    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
-    uint64_t frameNumber = 0;
-    std::chrono::high_resolution_clock::time_point captureTime;
-    bool isValid = false;
-};
-
-// Configuration for the capture engine
-struct CaptureConfig {
-    uint32_t outputIndex = 0;          // Which monitor to capture
-    uint32_t adapterIndex = 0;         // Which GPU adapter to use
-    bool createStagingTexture = false; // Create CPU-readable staging texture
-    uint32_t timeoutMs = 16;           // Timeout for frame acquisition (0 = no wait)
-};
-
 // DXGI Desktop Duplication capture engine
-class DXGICapture {
+class DXGICapture final : public CaptureSource {
 public:
     DXGICapture();
-    ~DXGICapture();
-
-    // Disable copy
-    DXGICapture(const DXGICapture&) = delete;
-    DXGICapture& operator=(const DXGICapture&) = delete;
+    ~DXGICapture() override;
 
     // Initialize the capture engine
     // Returns true on success, false on failure
-    bool Initialize(const CaptureConfig& config = CaptureConfig{});
+    bool Initialize(const CaptureConfig& config = CaptureConfig{}) override;
 
     // Initialize with an external D3D11 device (for interop scenarios)
-    bool Initialize(ID3D11Device* externalDevice, const CaptureConfig& config = CaptureConfig{});
+    bool Initialize(ID3D11Device* externalDevice, const CaptureConfig& config = CaptureConfig{}) override;
 
     // Shutdown and release all resources
-    void Shutdown();
+    void Shutdown() override;
 
     // Capture the next frame
-    // Returns true if a new frame was captured, false if no new frame or error
-    bool CaptureFrame(CapturedFrame& outFrame);
+    // Returns true if a new frame was captured, false if no new frame or error.
+    // On DXGI_ERROR_ACCESS_LOST (mode changes, fullscreen transitions, UAC
+    // prompts) the duplication is re-created on the same device, retried on
+    // every call until it succeeds; the device and shared targets are kept.
+    // The output size may have changed afterwards (check frame width/height).
+    bool CaptureFrame(CapturedFrame& outFrame) override;
 
     // Release the current frame (must be called before next capture)
-    void ReleaseFrame();
-
-    // Get capture statistics
-    const CaptureStats& GetStats() const { return m_stats; }
-
-    // Reset statistics
-    void ResetStats();
-
-    // Get the D3D11 device (for resource sharing)
-    ID3D11Device* GetDevice() const { return m_device.Get(); }
-
-    // Get the D3D11 device context
-    ID3D11DeviceContext* GetContext() const { return m_context.Get(); }
-
-    // Get the last error message
-    const std::string& GetLastError() const { return m_lastError; }
-
-    // Get display dimensions
-    uint32_t GetWidth() const { return m_width; }
-    uint32_t GetHeight() const { return m_height; }
-
-    // Check if initialized
-    bool IsInitialized() const { return m_initialized; }
+    void ReleaseFrame() override;
 
 private:
-    bool CreateD3D11Device(uint32_t adapterIndex);
     bool InitializeDesktopDuplication(uint32_t outputIndex);
-    void SetError(const std::string& error);
+    bool RecreateDuplication();
+    void ReadFrameMetadata(const DXGI_OUTDUPL_FRAME_INFO& frameInfo, CapturedFrame& frame);
 
     // D3D11 resources
-    ComPtr<ID3D11Device> m_device;
-    ComPtr<ID3D11DeviceContext> m_context;
     ComPtr<IDXGIOutputDuplication> m_duplication;
     ComPtr<ID3D11Texture2D> m_stagingTexture;
 
     // State
-    bool m_initialized = false;
     bool m_frameAcquired = false;
-    uint32_t m_width = 0;
-    uint32_t m_height = 0;
-    uint64_t m_frameCounter = 0;
-    CaptureConfig m_config;
-    CaptureStats m_stats;
-    std::string m_lastError;
+    bool m_fullFramePending = false;    // First image after re-duplication is a full update
 };
 
 } // namespace osfg
@@ -0,0 +1,325 @@
+// OSFG - Open Source Frame Generation
+// Frame Dump Implementation
+
+#include "frame_dump.h"
+
+#include <cstring>
+
+#pragma comment(lib, "d3d11.lib")
+
+namespace osfg {
+
+static const uint32_t BYTES_PER_PIXEL = 4;
+
+static bool IsDumpFormat(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// ============================================================================
+// FrameDumpWriter
+// ============================================================================
+
+FrameDumpWriter::~FrameDumpWriter() {
+    Close();
+}
+
+bool FrameDumpWriter::Open(const std::string& path, uint32_t width, uint32_t height, DXGI_FORMAT format) {
+    Close();
+
+    if (width == 0 || height == 0 || !IsDumpFormat(format)) {
+        m_lastError = "Frame dumps need a non-zero size and a 4-byte-per-pixel format";
+        return false;
+    }
+
+    m_file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_lastError = "Failed to create " + path;
+        return false;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+
+    m_header = FrameDumpHeader{};
+    m_header.width = width;
+    m_header.height = height;
+    m_header.format = format;
+    m_header.rowPitch = width * BYTES_PER_PIXEL;
+    m_header.qpcFrequency = frequency.QuadPart;
+
+    // Written again with the final frame count by Close()
+    if (!Write(&m_header, sizeof(m_header))) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void FrameDumpWriter::Close() {
+    if (m_file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER origin = {};
+        DWORD written = 0;
+        if (SetFilePointerEx(m_file, origin, nullptr, FILE_BEGIN)) {
+            WriteFile(m_file, &m_header, sizeof(m_header), &written, nullptr);
+        }
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_stagingTexture.Reset();
+}
+
+bool FrameDumpWriter::Write(const void* data, uint32_t size) {
+    DWORD written = 0;
+    if (!WriteFile(m_file, data, size, &written, nullptr) || written != size) {
+        m_lastError = "Failed to write frame dump";
+        return false;
+    }
+    return true;
+}
+
+bool FrameDumpWriter::WriteFrame(const void* pixels, uint32_t rowPitch,
+                                 int64_t presentQpc, uint32_t accumulatedFrames) {
+    if (!IsOpen()) {
+        m_lastError = "Frame dump not open";
+        return false;
+    }
+    if (!pixels || rowPitch < m_header.rowPitch) {
+        m_lastError = "Invalid frame data";
+        return false;
+    }
+
+    FrameDumpFrame frame;
+    frame.presentQpc = presentQpc;
+    frame.accumulatedFrames = accumulatedFrames;
+    if (!Write(&frame, sizeof(frame))) {
+        return false;
+    }
+
+    const uint8_t* source = static_cast<const uint8_t*>(pixels);
+    if (rowPitch == m_header.rowPitch) {
+        if (!Write(source, m_header.rowPitch * m_header.height)) {
+            return false;
+        }
+    } else {
+        for (uint32_t y = 0; y < m_header.height; y++) {
+            if (!Write(source + static_cast<size_t>(y) * rowPitch, m_header.rowPitch)) {
+                return false;
+            }
+        }
+    }
+
+    m_header.frameCount++;
+    return true;
+}
+
+bool FrameDumpWriter::WriteFrame(ID3D11DeviceContext* context, ID3D11Texture2D* texture,
+                                 int64_t presentQpc, uint32_t accumulatedFrames) {
+    if (!IsOpen()) {
+        m_lastError = "Frame dump not open";
+        return false;
+    }
+    if (!context || !texture) {
+        m_lastError = "Invalid frame texture";
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    texture->GetDesc(&desc);
+    if (desc.Width != m_header.width || desc.Height != m_header.height ||
+        desc.Format != static_cast<DXGI_FORMAT>(m_header.format)) {
+        m_lastError = "Frame does not match the dump size or format";
+        return false;
+    }
+
+    if (!m_stagingTexture) {
+        ComPtr<ID3D11Device> device;
+        context->GetDevice(&device);
+
+        D3D11_TEXTURE2D_DESC stagingDesc = {};
+        stagingDesc.Width = desc.Width;
+        stagingDesc.Height = desc.Height;
+        stagingDesc.MipLevels = 1;
+        stagingDesc.ArraySize = 1;
+        stagingDesc.Format = desc.Format;
+        stagingDesc.SampleDesc.Count = 1;
+        stagingDesc.Usage = D3D11_USAGE_STAGING;
+        stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+        if (FAILED(device->CreateTexture2D(&stagingDesc, nullptr, &m_stagingTexture))) {
+            m_lastError = "Failed to create frame dump staging texture";
+            return false;
+        }
+    }
+
+    context->CopyResource(m_stagingTexture.Get(), texture);
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(m_stagingTexture.Get(), 0, D3D11_MAP_READ, 0, &mapped))) {
+        m_lastError = "Failed to map frame dump staging texture";
+        return false;
+    }
+
+    const bool success = WriteFrame(mapped.pData, mapped.RowPitch, presentQpc, accumulatedFrames);
+    context->Unmap(m_stagingTexture.Get(), 0);
+    return success;
+}
+
+// ============================================================================
+// FrameDumpReader
+// ============================================================================
+
+FrameDumpReader::~FrameDumpReader() {
+    Close();
+}
+
+bool FrameDumpReader::Map(const std::string& path, uint64_t& size) {
+    Close();
+
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_lastError = "Failed to open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+        m_lastError = "Empty frame dump " + path;
+        Close();
+        return false;
+    }
+    size = static_cast<uint64_t>(fileSize.QuadPart);
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        m_lastError = "Failed to map " + path;
+        Close();
+        return false;
+    }
+
+    m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_view) {
+        m_lastError = "Failed to map a view of " + path;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool FrameDumpReader::Open(const std::string& path) {
+    uint64_t size = 0;
+    if (!Map(path, size)) {
+        return false;
+    }
+
+    if (size < sizeof(FrameDumpHeader)) {
+        m_lastError = path + " is not a frame dump";
+        Close();
+        return false;
+    }
+
+    std::memcpy(&m_header, m_view, sizeof(m_header));
+    if (m_header.magic != FrameDumpHeader::MAGIC || m_header.version != FrameDumpHeader::VERSION) {
+        m_lastError = path + " is not a version " + std::to_string(FrameDumpHeader::VERSION) + " frame dump";
+        Close();
+        return false;
+    }
+    if (m_header.width == 0 || m_header.height == 0 ||
+        m_header.rowPitch < m_header.width * BYTES_PER_PIXEL) {
+        m_lastError = path + " has an invalid frame size";
+        Close();
+        return false;
+    }
+
+    m_frameStride = sizeof(FrameDumpFrame) + static_cast<uint64_t>(m_header.rowPitch) * m_header.height;
+    m_firstFrame = m_view + sizeof(FrameDumpHeader);
+    m_hasFrameInfo = true;
+
+    // A writer that did not close cleanly leaves frameCount at 0: trust the size
+    const uint64_t framesInFile = (size - sizeof(FrameDumpHeader)) / m_frameStride;
+    if (m_header.frameCount == 0 || m_header.frameCount > framesInFile) {
+        m_header.frameCount = static_cast<uint32_t>(framesInFile);
+    }
+    if (m_header.frameCount == 0) {
+        m_lastError = path + " contains no frames";
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool FrameDumpReader::OpenRaw(const std::string& path, uint32_t width, uint32_t height, DXGI_FORMAT format) {
+    if (width == 0 || height == 0 || !IsDumpFormat(format)) {
+        m_lastError = "Raw frames need a non-zero size and a 4-byte-per-pixel format";
+        return false;
+    }
+
+    uint64_t size = 0;
+    if (!Map(path, size)) {
+        return false;
+    }
+
+    m_header = FrameDumpHeader{};
+    m_header.width = width;
+    m_header.height = height;
+    m_header.format = format;
+    m_header.rowPitch = width * BYTES_PER_PIXEL;
+
+    m_frameStride = static_cast<uint64_t>(m_header.rowPitch) * height;
+    m_firstFrame = m_view;
+    m_hasFrameInfo = false;
+    m_header.frameCount = static_cast<uint32_t>(size / m_frameStride);
+    if (m_header.frameCount == 0) {
+        m_lastError = path + " is smaller than one " + std::to_string(width) + "x" +
+                      std::to_string(height) + " frame";
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void FrameDumpReader::Close() {
+    if (m_view) {
+        UnmapViewOfFile(m_view);
+        m_view = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+    m_firstFrame = nullptr;
+    m_frameStride = 0;
+    m_hasFrameInfo = false;
+    m_header = FrameDumpHeader{};
+}
+
+const uint8_t* FrameDumpReader::GetFrame(uint32_t index) const {
+    if (!m_view || index >= m_header.frameCount) {
+        return nullptr;
+    }
+    const uint8_t* record = m_firstFrame + index * m_frameStride;
+    return m_hasFrameInfo ? record + sizeof(FrameDumpFrame) : record;
+}
+
+FrameDumpFrame FrameDumpReader::GetFrameInfo(uint32_t index) const {
+    FrameDumpFrame frame;
+    if (m_view && m_hasFrameInfo && index < m_header.frameCount) {
+        std::memcpy(&frame, m_firstFrame + index * m_frameStride, sizeof(frame));
+    }
+    return frame;
+}
+
+} // namespace osfg
@@ -0,0 +1,159 @@
+// OSFG - Open Source Frame Generation
+// Frame Dump
+//
+// Recorded frame sequences for offline replay. FrameDumpWriter appends
+// captured frames (read back through a staging texture, or from CPU memory)
+// to a container file: a fixed header, then one fixed-size record per frame
+// holding its capture metadata and tightly packed rows. FrameDumpReader
+// memory-maps a container, or a raw file of back-to-back BGRA frames, and
+// hands out frames by index without copying, so benchmarks replay the same
+// bytes every run.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Container header ("OSFD"), at offset 0
+struct FrameDumpHeader {
+    static const uint32_t MAGIC = 0x4446534F;   // "OSFD" little endian
+    static const uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = DXGI_FORMAT_B8G8R8A8_UNORM;  // DXGI_FORMAT, 4 bytes per pixel
+    uint32_t rowPitch = 0;                         // width * 4, rows are tightly packed
+    uint32_t frameCount = 0;                       // Patched when the writer closes
+    uint32_t reserved0 = 0;
+    int64_t qpcFrequency = 0;                      // Units of FrameDumpFrame::presentQpc
+    uint32_t reserved[6] = {};
+};
+
+// Per-frame record header, followed by height * rowPitch bytes of pixels
+struct FrameDumpFrame {
+    int64_t presentQpc = 0;          // Desktop present time, 0 if unknown
+    uint32_t accumulatedFrames = 1;  // Source presents folded into this frame
+    uint32_t flags = 0;              // Reserved
+};
+
+static_assert(sizeof(FrameDumpHeader) == 64, "FrameDumpHeader layout");
+static_assert(sizeof(FrameDumpFrame) == 16, "FrameDumpFrame layout");
+
+class FrameDumpWriter {
+public:
+    FrameDumpWriter() = default;
+    ~FrameDumpWriter();
+
+    // Non-copyable
+    FrameDumpWriter(const FrameDumpWriter&) = delete;
+    FrameDumpWriter& operator=(const FrameDumpWriter&) = delete;
+
+    // Create `path` for frames of one size (overwrites an existing file)
+    bool Open(const std::string& path, uint32_t width, uint32_t height,
+              DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM);
+
+    // Write the frame count and close the file
+    void Close();
+
+    // Check if a file is open
+    bool IsOpen() const { return m_file != INVALID_HANDLE_VALUE; }
+
+    // Append a frame from CPU memory (`rowPitch` bytes between rows)
+    bool WriteFrame(const void* pixels, uint32_t rowPitch,
+                    int64_t presentQpc = 0, uint32_t accumulatedFrames = 1);
+
+    // Append a frame from a D3D11 texture of the opened size and format.
+    // Copies into a staging texture and maps it, so the context is flushed
+    // and the call waits for the GPU.
+    bool WriteFrame(ID3D11DeviceContext* context, ID3D11Texture2D* texture,
+                    int64_t presentQpc = 0, uint32_t accumulatedFrames = 1);
+
+    // Frames written since Open()
+    uint32_t GetFrameCount() const { return m_header.frameCount; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool Write(const void* data, uint32_t size);
+
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    FrameDumpHeader m_header;
+    ComPtr<ID3D11Texture2D> m_stagingTexture;
+    std::string m_lastError;
+};
+
+class FrameDumpReader {
+public:
+    FrameDumpReader() = default;
+    ~FrameDumpReader();
+
+    // Non-copyable
+    FrameDumpReader(const FrameDumpReader&) = delete;
+    FrameDumpReader& operator=(const FrameDumpReader&) = delete;
+
+    // Map a container written by FrameDumpWriter
+    bool Open(const std::string& path);
+
+    // Map a raw file of back-to-back width x height frames, 4 bytes per
+    // pixel with tightly packed rows (no metadata)
+    bool OpenRaw(const std::string& path, uint32_t width, uint32_t height,
+                 DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM);
+
+    // Unmap the file
+    void Close();
+
+    // Check if a file is mapped
+    bool IsOpen() const { return m_view != nullptr; }
+
+    // Pixels of frame `index` (GetRowPitch() bytes per row), nullptr if out of range.
+    // Valid until Close().
+    const uint8_t* GetFrame(uint32_t index) const;
+
+    // Capture metadata of frame `index` (defaults for raw files)
+    FrameDumpFrame GetFrameInfo(uint32_t index) const;
+
+    uint32_t GetWidth() const { return m_header.width; }
+    uint32_t GetHeight() const { return m_header.height; }
+    uint32_t GetRowPitch() const { return m_header.rowPitch; }
+    DXGI_FORMAT GetFormat() const { return static_cast<DXGI_FORMAT>(m_header.format); }
+    uint32_t GetFrameCount() const { return m_header.frameCount; }
+    int64_t GetQpcFrequency() const { return m_header.qpcFrequency; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool Map(const std::string& path, uint64_t& size);
+
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    const uint8_t* m_view = nullptr;
+    const uint8_t* m_firstFrame = nullptr;
+    uint64_t m_frameStride = 0;
+    bool m_hasFrameInfo = false;
+    FrameDumpHeader m_header;
+    std::string m_lastError;
+};
+
+} // namespace osfg
@@ -0,0 +1,361 @@
+// OSFG - Open Source Frame Generation
+// Windows.Graphics.Capture Engine Implementation
+
+#include "wgc_capture.h"
+
+#include <Unknwn.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Metadata.h>
+#include <winrt/Windows.Graphics.Capture.h>
+#include <winrt/Windows.Graphics.DirectX.h>
+#include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
+#include <windows.graphics.capture.interop.h>
+#include <windows.graphics.directx.direct3d11.interop.h>
+
+#include <atomic>
+#include <sstream>
+
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "windowsapp.lib")
+
+namespace osfg {
+
+namespace wgc = winrt::Windows::Graphics::Capture;
+namespace wgd = winrt::Windows::Graphics::DirectX;
+
+// Frame pool buffers: one being read while the compositor writes the next
+static const int32_t FRAME_POOL_BUFFERS = 2;
+
+struct WGCCapture::Session {
+    wgd::Direct3D11::IDirect3DDevice device{ nullptr };
+    wgc::GraphicsCaptureItem item{ nullptr };
+    wgc::Direct3D11CaptureFramePool framePool{ nullptr };
+    wgc::GraphicsCaptureSession session{ nullptr };
+    wgc::Direct3D11CaptureFramePool::FrameArrived_revoker frameArrived;
+    wgc::GraphicsCaptureItem::Closed_revoker closed;
+    wgc::Direct3D11CaptureFrame currentFrame{ nullptr };   // Held until ReleaseFrame()
+    std::atomic<bool> itemClosed{ false };
+};
+
+static std::string HResultMessage(const char* what, HRESULT hr) {
+    std::stringstream ss;
+    ss << what << " (0x" << std::hex << static_cast<uint32_t>(hr) << ")";
+    return ss.str();
+}
+
+WGCCapture::WGCCapture() = default;
+
+WGCCapture::~WGCCapture() {
+    Shutdown();
+}
+
+bool WGCCapture::IsSupported() {
+    try {
+        return wgc::GraphicsCaptureSession::IsSupported();
+    } catch (const winrt::hresult_error&) {
+        return false;
+    }
+}
+
+bool WGCCapture::Initialize(const CaptureConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    m_config = config;
+
+    // BGRA support is required to wrap the device for WinRT
+    if (!CreateD3D11Device(config.adapterIndex, D3D11_CREATE_DEVICE_BGRA_SUPPORT)) {
+        return false;
+    }
+
+    if (!StartCapture()) {
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    ResetStats();
+    return true;
+}
+
+bool WGCCapture::Initialize(ID3D11Device* externalDevice, const CaptureConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!externalDevice) {
+        SetError("External device is null");
+        return false;
+    }
+
+    m_config = config;
+
+    // Use the external device
+    m_device = externalDevice;
+    externalDevice->GetImmediateContext(&m_context);
+
+    if (!StartCapture()) {
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    ResetStats();
+    return true;
+}
+
+bool WGCCapture::StartCapture() {
+    if (!IsSupported()) {
+        SetError("Windows.Graphics.Capture not supported on this system");
+        return false;
+    }
+
+    // Frames are taken on the capture thread, so the WinRT objects live in
+    // the MTA (which then stays up for the process)
+    HRESULT hr = RoInitialize(RO_INIT_MULTITHREADED);
+    if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+        SetError(HResultMessage("Failed to initialize WinRT", hr));
+        return false;
+    }
+
+    ComPtr<IDXGIDevice> dxgiDevice;
+    hr = m_device.As(&dxgiDevice);
+    if (FAILED(hr)) {
+        SetError("Failed to get DXGI device");
+        return false;
+    }
+
+    // The monitor handle comes from the capture device's own adapter
+    HMONITOR monitor = nullptr;
+    if (!m_config.window) {
+        ComPtr<IDXGIAdapter> adapter;
+        ComPtr<IDXGIOutput> output;
+        if (FAILED(dxgiDevice->GetAdapter(&adapter)) ||
+            FAILED(adapter->EnumOutputs(m_config.outputIndex, &output))) {
+            SetError("Failed to get output " + std::to_string(m_config.outputIndex));
+            return false;
+        }
+        DXGI_OUTPUT_DESC outputDesc;
+        output->GetDesc(&outputDesc);
+        monitor = outputDesc.Monitor;
+    } else if (!IsWindow(m_config.window)) {
+        SetError("Capture window is not a valid window");
+        return false;
+    }
+
+    // The frame pool delivers FP16 scRGB from an HDR monitor just as Desktop
+    // Duplication does
+    const HMONITOR captureMonitor = m_config.window ? MonitorFromWindow(m_config.window, MONITOR_DEFAULTTONEAREST)
+                                                    : monitor;
+    m_monitor = captureMonitor;
+    m_format = m_config.hdr && IsHDRMonitor(captureMonitor) ? DXGI_FORMAT_R16G16B16A16_FLOAT
+                                                            : DXGI_FORMAT_B8G8R8A8_UNORM;
+    const wgd::DirectXPixelFormat pixelFormat = m_format == DXGI_FORMAT_R16G16B16A16_FLOAT
+        ? wgd::DirectXPixelFormat::R16G16B16A16Float : wgd::DirectXPixelFormat::B8G8R8A8UIntNormalized;
+
+    m_frameEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_frameEvent) {
+        SetError("Failed to create frame event");
+        return false;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_qpcPerTick = static_cast<double>(frequency.QuadPart) / 10000000.0;
+
+    m_session = std::make_unique<Session>();
+    Session& s = *m_session;
+
+    try {
+        winrt::com_ptr<::IInspectable> inspectable;
+        winrt::check_hresult(CreateDirect3D11DeviceFromDXGIDevice(dxgiDevice.Get(), inspectable.put()));
+        s.device = inspectable.as<wgd::Direct3D11::IDirect3DDevice>();
+
+        auto interop = winrt::get_activation_factory<wgc::GraphicsCaptureItem, IGraphicsCaptureItemInterop>();
+        if (m_config.window) {
+            winrt::check_hresult(interop->CreateForWindow(m_config.window,
+                                                          winrt::guid_of<wgc::IGraphicsCaptureItem>(),
+                                                          winrt::put_abi(s.item)));
+        } else {
+            winrt::check_hresult(interop->CreateForMonitor(monitor,
+                                                           winrt::guid_of<wgc::IGraphicsCaptureItem>(),
+                                                           winrt::put_abi(s.item)));
+        }
+
+        const winrt::Windows::Graphics::SizeInt32 size = s.item.Size();
+        if (size.Width <= 0 || size.Height <= 0) {
+            SetError("Capture item has no area (minimized window?)");
+            return false;
+        }
+        m_width = static_cast<uint32_t>(size.Width);
+        m_height = static_cast<uint32_t>(size.Height);
+
+        // Free-threaded: FrameArrived fires on a system worker thread and
+        // only wakes CaptureFrame(); no dispatcher queue is needed
+        s.framePool = wgc::Direct3D11CaptureFramePool::CreateFreeThreaded(
+            s.device, pixelFormat, FRAME_POOL_BUFFERS, size);
+        HANDLE frameEvent = m_frameEvent;
+        s.frameArrived = s.framePool.FrameArrived(winrt::auto_revoke,
+            [frameEvent](const wgc::Direct3D11CaptureFramePool&, const winrt::Windows::Foundation::IInspectable&) {
+                SetEvent(frameEvent);
+            });
+
+        Session* session = m_session.get();
+        s.closed = s.item.Closed(winrt::auto_revoke,
+            [session](const wgc::GraphicsCaptureItem&, const winrt::Windows::Foundation::IInspectable&) {
+                session->itemClosed = true;
+            });
+
+        s.session = s.framePool.CreateCaptureSession(s.item);
+
+        // Cursor exclusion needs Windows 10 2004; older builds always draw it
+        if (winrt::Windows::Foundation::Metadata::ApiInformation::IsPropertyPresent(
+                L"Windows.Graphics.Capture.GraphicsCaptureSession", L"IsCursorCaptureEnabled")) {
+            s.session.IsCursorCaptureEnabled(m_config.captureCursor);
+        }
+
+        s.session.StartCapture();
+    } catch (const winrt::hresult_error& e) {
+        SetError(HResultMessage("Failed to start Windows.Graphics.Capture", e.code()));
+        return false;
+    }
+
+    return true;
+}
+
+void WGCCapture::Shutdown() {
+    ReleaseFrame();
+
+    if (m_session) {
+        try {
+            m_session->frameArrived.revoke();
+            m_session->closed.revoke();
+            if (m_session->session) {
+                m_session->session.Close();
+            }
+            if (m_session->framePool) {
+                m_session->framePool.Close();
+            }
+        } catch (const winrt::hresult_error&) {
+            // Nothing left to do with a session that failed to close
+        }
+        m_session.reset();
+    }
+
+    if (m_frameEvent) {
+        CloseHandle(m_frameEvent);
+        m_frameEvent = nullptr;
+    }
+
+    ReleaseSharedTargets();
+
+    m_context.Reset();
+    m_device.Reset();
+
+    m_initialized = false;
+    m_width = 0;
+    m_height = 0;
+    m_format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    m_monitor = nullptr;
+}
+
+bool WGCCapture::CaptureFrame(CapturedFrame& outFrame) {
+    if (!m_initialized) {
+        SetError("Not initialized");
+        return false;
+    }
+
+    // Release previous frame if still held
+    ReleaseFrame();
+
+    if (m_session->itemClosed) {
+        // Window closed - need to reinitialize with another target
+        SetError("Capture item closed - reinitialize required");
+        m_initialized = false;
+        return false;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    wgc::Direct3D11CaptureFrame frame{ nullptr };
+    ComPtr<ID3D11Texture2D> texture;
+    try {
+        frame = m_session->framePool.TryGetNextFrame();
+        if (!frame && m_config.timeoutMs > 0) {
+            WaitForSingleObject(m_frameEvent, m_config.timeoutMs);
+            frame = m_session->framePool.TryGetNextFrame();
+        }
+        if (!frame) {
+            // No new frame available
+            outFrame.isValid = false;
+            return false;
+        }
+
+        // Only the newest frame matters; hand older ones straight back
+        outFrame.accumulatedFrames = 1;
+        for (auto next = m_session->framePool.TryGetNextFrame(); next;
+             next = m_session->framePool.TryGetNextFrame()) {
+            frame.Close();
+            frame = next;
+            m_stats.framesMissed++;
+            outFrame.accumulatedFrames++;
+        }
+
+        auto access = frame.Surface().as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
+        winrt::check_hresult(access->GetInterface(IID_PPV_ARGS(&texture)));
+    } catch (const winrt::hresult_error& e) {
+        if (frame) {
+            frame.Close();
+        }
+        SetError(HResultMessage("Failed to acquire frame", e.code()));
+        m_stats.framesMissed++;
+        return false;
+    }
+
+    m_session->currentFrame = frame;
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double captureTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    // Update statistics
+    RecordCaptureTime(captureTimeMs);
+
+    // WGC delivers a frame only when the content changed, without damage
+    // rects. SystemRelativeTime is QPC time in 100 ns units.
+    outFrame.dirtyRects.clear();
+    outFrame.moveRects.clear();
+    outFrame.hasImageUpdate = true;
+    outFrame.fullFrameUpdate = true;
+    outFrame.presentTimeQpc = static_cast<int64_t>(
+        static_cast<double>(frame.SystemRelativeTime().count()) * m_qpcPerTick);
+
+    // Fill output frame
+    outFrame.texture = texture;
+    outFrame.width = m_width;
+    outFrame.height = m_height;
+    outFrame.format = m_format;
+    outFrame.frameNumber = m_frameCounter++;
+    outFrame.captureTime = endTime;
+    outFrame.isValid = true;
+
+    return true;
+}
+
+void WGCCapture::ReleaseFrame() {
+    if (m_session && m_session->currentFrame) {
+        try {
+            m_session->currentFrame.Close();
+        } catch (const winrt::hresult_error&) {
+            // The buffer goes back to the pool either way
+        }
+        m_session->currentFrame = nullptr;
+    }
+}
+
+bool WGCCapture::IsItemClosed() const {
+    return m_session && m_session->itemClosed;
+}
+
+} // namespace osfg
@@ -0,0 +1,225 @@
+// OSFG - Open Source Frame Generation
+// Command Allocator Ring
+//
+// N-deep ring of command allocator / command list pairs for one queue. Each
+// entry is tagged with the fence value that retires it, so the CPU can record
+// frame N+1 while the GPU is still executing frame N; Begin() only blocks when
+// the entry it is about to reuse is still in flight.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osfg {
+
+class CommandAllocatorRing {
+public:
+    static const uint32_t MAX_DEPTH = 8;
+
+    CommandAllocatorRing() = default;
+    ~CommandAllocatorRing() { Shutdown(); }
+
+    // Non-copyable
+    CommandAllocatorRing(const CommandAllocatorRing&) = delete;
+    CommandAllocatorRing& operator=(const CommandAllocatorRing&) = delete;
+
+    // Create `depth` allocator/list pairs of the given type on `device`.
+    // Lists are created closed.
+    bool Initialize(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, uint32_t depth) {
+        Shutdown();
+
+        if (!device || depth == 0 || depth > MAX_DEPTH) {
+            m_lastError = "Invalid command ring parameters";
+            return false;
+        }
+
+        m_entries.resize(depth);
+        for (uint32_t i = 0; i < depth; i++) {
+            HRESULT hr = device->CreateCommandAllocator(type, IID_PPV_ARGS(&m_entries[i].allocator));
+            if (FAILED(hr)) {
+                m_lastError = "Failed to create command allocator " + std::to_string(i);
+                Shutdown();
+                return false;
+            }
+
+            hr = device->CreateCommandList(0, type, m_entries[i].allocator.Get(), nullptr,
+                IID_PPV_ARGS(&m_entries[i].commandList));
+            if (FAILED(hr)) {
+                m_lastError = "Failed to create command list " + std::to_string(i);
+                Shutdown();
+                return false;
+            }
+            m_entries[i].commandList->Close();
+        }
+
+        m_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!m_event) {
+            m_lastError = "Failed to create command ring event";
+            Shutdown();
+            return false;
+        }
+
+        m_next = 0;
+        m_current = nullptr;
+        return true;
+    }
+
+    // Wait for every entry to retire and release everything
+    void Shutdown() {
+        WaitForIdle();
+        m_entries.clear();
+        if (m_event) {
+            CloseHandle(m_event);
+            m_event = nullptr;
+        }
+        m_current = nullptr;
+        m_next = 0;
+    }
+
+    bool IsInitialized() const { return !m_entries.empty(); }
+
+    // Take the next entry, wait for the GPU to retire it if necessary, and
+    // reset it for recording. Returns nullptr on failure.
+    ID3D12GraphicsCommandList* Begin() {
+        if (m_entries.empty()) {
+            m_lastError = "Command ring not initialized";
+            return nullptr;
+        }
+
+        Entry& entry = m_entries[m_next];
+        if (!WaitForEntry(entry)) {
+            return nullptr;
+        }
+
+        HRESULT hr = entry.allocator->Reset();
+        if (FAILED(hr)) {
+            m_lastError = "Failed to reset command allocator";
+            return nullptr;
+        }
+
+        hr = entry.commandList->Reset(entry.allocator.Get(), nullptr);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to reset command list";
+            return nullptr;
+        }
+
+        m_current = &entry;
+        m_next = (m_next + 1) % static_cast<uint32_t>(m_entries.size());
+        return entry.commandList.Get();
+    }
+
+    // Close and execute the list returned by the last Begin(), then signal
+    // `fence` to `fenceValue` on `queue`. The entry retires at that value.
+    bool Submit(ID3D12CommandQueue* queue, ID3D12Fence* fence, uint64_t fenceValue) {
+        if (!m_current) {
+            m_lastError = "Submit without Begin";
+            return false;
+        }
+
+        Entry& entry = *m_current;
+        m_current = nullptr;
+
+        HRESULT hr = entry.commandList->Close();
+        if (FAILED(hr)) {
+            m_lastError = "Failed to close command list";
+            return false;
+        }
+
+        ID3D12CommandList* lists[] = { entry.commandList.Get() };
+        queue->ExecuteCommandLists(1, lists);
+
+        hr = queue->Signal(fence, fenceValue);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to signal command ring fence";
+            return false;
+        }
+
+        entry.fence = fence;
+        entry.fenceValue = fenceValue;
+        return true;
+    }
+
+    // Close the list returned by the last Begin() for someone else to execute
+    // (a shared queue's scheduler). The entry retires when `fence` reaches
+    // `fenceValue`, which whoever executes the list must signal after it.
+    // Returns nullptr on failure.
+    ID3D12GraphicsCommandList* Close(ID3D12Fence* fence, uint64_t fenceValue) {
+        if (!m_current) {
+            m_lastError = "Close without Begin";
+            return nullptr;
+        }
+
+        Entry& entry = *m_current;
+        m_current = nullptr;
+
+        HRESULT hr = entry.commandList->Close();
+        if (FAILED(hr)) {
+            m_lastError = "Failed to close command list";
+            return nullptr;
+        }
+
+        entry.fence = fence;
+        entry.fenceValue = fenceValue;
+        return entry.commandList.Get();
+    }
+
+    // Command list currently being recorded (nullptr outside Begin/Submit)
+    ID3D12GraphicsCommandList* GetCurrentList() const {
+        return m_current ? m_current->commandList.Get() : nullptr;
+    }
+
+    // Block until every submitted entry has retired
+    void WaitForIdle() {
+        for (auto& entry : m_entries) {
+            WaitForEntry(entry);
+        }
+    }
+
+    uint32_t GetDepth() const { return static_cast<uint32_t>(m_entries.size()); }
+
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    struct Entry {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+        ID3D12Fence* fence = nullptr;  // Fence the last submit signalled (not owned)
+        uint64_t fenceValue = 0;       // Value at which this entry may be reset
+    };
+
+    bool WaitForEntry(Entry& entry) {
+        if (!entry.fence || entry.fence->GetCompletedValue() >= entry.fenceValue) {
+            return true;
+        }
+        HRESULT hr = entry.fence->SetEventOnCompletion(entry.fenceValue, m_event);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to wait for command allocator";
+            return false;
+        }
+        WaitForSingleObject(m_event, INFINITE);
+        return true;
+    }
+
+    std::vector<Entry> m_entries;
+    Entry* m_current = nullptr;
+    uint32_t m_next = 0;
+    HANDLE m_event = nullptr;
+    std::string m_lastError;
+};
+
+} // namespace osfg
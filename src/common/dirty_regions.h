@@ -0,0 +1,142 @@
+// OSFG - Open Source Frame Generation
+// Dirty Region Tracker
+//
+// Accumulates per-frame damage for a ring of textures that are updated
+// incrementally. Every frame's changed rects are added to every buffer; a
+// buffer that is written takes the rects it has accumulated since its own
+// last write and is then clean. Once a buffer's list grows past MAX_RECTS it
+// collapses to its bounding box, and once that covers most of the frame the
+// buffer is simply marked for a full copy.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace osfg {
+
+class DirtyRegionTracker {
+public:
+    static const uint32_t MAX_RECTS = 16;
+
+    // Every buffer starts out needing a full copy
+    void Initialize(uint32_t bufferCount, uint32_t width, uint32_t height) {
+        m_width = width;
+        m_height = height;
+        m_buffers.assign(bufferCount, Buffer());
+    }
+
+    // Force a full copy into every buffer (e.g. after a lost frame)
+    void Invalidate() {
+        for (auto& buffer : m_buffers) {
+            buffer.full = true;
+            buffer.rects.clear();
+        }
+    }
+
+    // Record one frame's damage against every buffer.
+    // rects == nullptr means the whole frame changed; rectCount == 0 with a
+    // non-null pointer means nothing changed.
+    void AddFrame(const RECT* rects, uint32_t rectCount) {
+        if (!rects) {
+            Invalidate();
+            return;
+        }
+
+        for (auto& buffer : m_buffers) {
+            if (buffer.full) continue;
+
+            for (uint32_t i = 0; i < rectCount; i++) {
+                RECT r = Clamp(rects[i]);
+                if (r.right > r.left && r.bottom > r.top) {
+                    buffer.rects.push_back(r);
+                }
+            }
+
+            if (buffer.rects.size() > MAX_RECTS) {
+                RECT bounds = buffer.rects[0];
+                for (const RECT& r : buffer.rects) {
+                    bounds.left = (std::min)(bounds.left, r.left);
+                    bounds.top = (std::min)(bounds.top, r.top);
+                    bounds.right = (std::max)(bounds.right, r.right);
+                    bounds.bottom = (std::max)(bounds.bottom, r.bottom);
+                }
+                buffer.rects.assign(1, bounds);
+            }
+
+            // Region copies stop paying off once most of the frame is dirty
+            if (Area(buffer.rects) * 2 > static_cast<uint64_t>(m_width) * m_height) {
+                buffer.full = true;
+                buffer.rects.clear();
+            }
+        }
+    }
+
+    // True if `index` needs the whole frame
+    bool IsFull(uint32_t index) const {
+        return index >= m_buffers.size() || m_buffers[index].full;
+    }
+
+    // Rects `index` must copy to become current (valid when !IsFull)
+    const std::vector<RECT>& GetRects(uint32_t index) const {
+        static const std::vector<RECT> empty;
+        return index < m_buffers.size() ? m_buffers[index].rects : empty;
+    }
+
+    // `index` now holds the latest frame
+    void MarkWritten(uint32_t index) {
+        if (index < m_buffers.size()) {
+            m_buffers[index].full = false;
+            m_buffers[index].rects.clear();
+        }
+    }
+
+    // Bytes a copy into `index` moves at `bytesPerPixel`
+    uint64_t GetCopyBytes(uint32_t index, uint32_t bytesPerPixel) const {
+        const uint64_t pixels = IsFull(index) ? static_cast<uint64_t>(m_width) * m_height
+                                              : Area(m_buffers[index].rects);
+        return pixels * bytesPerPixel;
+    }
+
+private:
+    struct Buffer {
+        std::vector<RECT> rects;
+        bool full = true;
+    };
+
+    RECT Clamp(const RECT& r) const {
+        RECT c;
+        c.left = (std::max)(r.left, 0L);
+        c.top = (std::max)(r.top, 0L);
+        c.right = (std::min)(r.right, static_cast<LONG>(m_width));
+        c.bottom = (std::min)(r.bottom, static_cast<LONG>(m_height));
+        return c;
+    }
+
+    // Sum of rect areas (overlaps counted twice; only used as a cost estimate)
+    static uint64_t Area(const std::vector<RECT>& rects) {
+        uint64_t area = 0;
+        for (const RECT& r : rects) {
+            area += static_cast<uint64_t>(r.right - r.left) * static_cast<uint64_t>(r.bottom - r.top);
+        }
+        return area;
+    }
+
+    std::vector<Buffer> m_buffers;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+};
+
+} // namespace osfg
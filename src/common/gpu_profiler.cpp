@@ -0,0 +1,313 @@
+// OSFG - Open Source Frame Generation
+// GPU Profiler Implementation
+
+#include "gpu_profiler.h"
+
+#include <algorithm>
+
+#pragma comment(lib, "d3d12.lib")
+
+namespace osfg {
+
+double GpuFrameTimes::StageMs(GpuStage stage) const {
+    double total = 0.0;
+    for (uint32_t i = 0; i < scopeCount; i++) {
+        if (scopes[i].stage == stage) {
+            total += scopes[i].ms;
+        }
+    }
+    return total;
+}
+
+double GpuFrameTimes::ScopeMs(GpuStage stage, uint32_t index) const {
+    for (uint32_t i = 0; i < scopeCount; i++) {
+        if (scopes[i].stage == stage && scopes[i].index == index) {
+            return scopes[i].ms;
+        }
+    }
+    return 0.0;
+}
+
+GpuProfiler::~GpuProfiler() {
+    Shutdown();
+}
+
+bool GpuProfiler::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t framesInFlight) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!device || !queue || framesInFlight == 0 || framesInFlight > MAX_FRAMES) {
+        m_lastError = "Invalid profiler parameters";
+        return false;
+    }
+
+    const D3D12_COMMAND_QUEUE_DESC queueDesc = queue->GetDesc();
+    D3D12_QUERY_HEAP_TYPE heapType = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    if (queueDesc.Type == D3D12_COMMAND_LIST_TYPE_COPY) {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS3 options3 = {};
+        if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS3, &options3, sizeof(options3))) ||
+            !options3.CopyQueueTimestampQueriesSupported) {
+            m_lastError = "Copy queue timestamps not supported";
+            return false;
+        }
+        heapType = D3D12_QUERY_HEAP_TYPE_COPY_QUEUE_TIMESTAMP;
+    }
+
+    if (FAILED(queue->GetTimestampFrequency(&m_gpuFrequency)) || m_gpuFrequency == 0) {
+        m_lastError = "Failed to get timestamp frequency";
+        return false;
+    }
+
+    LARGE_INTEGER qpcFrequency;
+    QueryPerformanceFrequency(&qpcFrequency);
+    m_qpcFrequency = qpcFrequency.QuadPart;
+
+    // Two queries (begin, end) per scope per frame slot
+    const uint32_t queryCount = framesInFlight * MAX_SCOPES * 2;
+
+    D3D12_QUERY_HEAP_DESC heapDesc = {};
+    heapDesc.Type = heapType;
+    heapDesc.Count = queryCount;
+    HRESULT hr = device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&m_queryHeap));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create timestamp query heap";
+        return false;
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = static_cast<UINT64>(queryCount) * sizeof(uint64_t);
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    hr = device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+        D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&m_readbackBuffer));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create timestamp readback buffer";
+        Shutdown();
+        return false;
+    }
+
+    // Readback buffers may stay mapped; slots are only read after their fence
+    void* mapped = nullptr;
+    hr = m_readbackBuffer->Map(0, nullptr, &mapped);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to map timestamp readback buffer";
+        Shutdown();
+        return false;
+    }
+    m_readbackData = static_cast<const uint64_t*>(mapped);
+
+    m_queue = queue;
+    m_frameCount = framesInFlight;
+    m_writeSlot = 0;
+    m_readSlot = 0;
+    m_recording = false;
+    m_scopeOpen = false;
+    m_frameNumber = 0;
+    m_framesSkipped = 0;
+    m_previousEndTicks = 0;
+    m_lastFrame = GpuFrameTimes{};
+    for (FrameSlot& slot : m_slots) {
+        slot = FrameSlot{};
+    }
+
+    Calibrate();
+
+    m_initialized = true;
+    return true;
+}
+
+void GpuProfiler::Shutdown() {
+    if (m_readbackBuffer && m_readbackData) {
+        D3D12_RANGE writeRange = { 0, 0 };
+        m_readbackBuffer->Unmap(0, &writeRange);
+    }
+    m_readbackData = nullptr;
+    m_readbackBuffer.Reset();
+    m_queryHeap.Reset();
+    m_queue.Reset();
+
+    for (FrameSlot& slot : m_slots) {
+        slot = FrameSlot{};
+    }
+
+    m_calibrated = false;
+    m_initialized = false;
+}
+
+void GpuProfiler::BeginFrame() {
+    if (!m_initialized) {
+        return;
+    }
+
+    m_frameNumber++;
+    m_scopeOpen = false;
+
+    // Retire what has finished first, so a slot frees up if it can
+    Collect();
+
+    FrameSlot& slot = m_slots[m_writeSlot];
+    if (slot.pending) {
+        // The GPU is more than framesInFlight frames behind: skip this frame
+        m_recording = false;
+        m_framesSkipped++;
+        return;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    slot.scopeCount = 0;
+    slot.frameNumber = m_frameNumber;
+    slot.cpuBeginQpc = now.QuadPart;
+    m_recording = true;
+}
+
+void GpuProfiler::BeginScope(ID3D12GraphicsCommandList* commandList, GpuStage stage, uint32_t index) {
+    m_scopeOpen = false;
+    if (!m_recording || !commandList) {
+        return;
+    }
+
+    FrameSlot& slot = m_slots[m_writeSlot];
+    if (slot.scopeCount >= MAX_SCOPES) {
+        return;
+    }
+
+    const uint32_t query = (m_writeSlot * MAX_SCOPES + slot.scopeCount) * 2;
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+    slot.stages[slot.scopeCount] = stage;
+    slot.indices[slot.scopeCount] = index;
+    m_scopeOpen = true;
+}
+
+void GpuProfiler::EndScope(ID3D12GraphicsCommandList* commandList) {
+    if (!m_scopeOpen || !commandList) {
+        return;
+    }
+
+    FrameSlot& slot = m_slots[m_writeSlot];
+    const uint32_t query = (m_writeSlot * MAX_SCOPES + slot.scopeCount) * 2 + 1;
+    commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+    slot.scopeCount++;
+    m_scopeOpen = false;
+}
+
+void GpuProfiler::EndFrame(ID3D12GraphicsCommandList* commandList, ID3D12Fence* fence, uint64_t fenceValue) {
+    if (!m_recording) {
+        return;
+    }
+    m_recording = false;
+    m_scopeOpen = false;
+
+    FrameSlot& slot = m_slots[m_writeSlot];
+    if (!commandList || !fence || slot.scopeCount == 0) {
+        return;
+    }
+
+    const uint32_t firstQuery = m_writeSlot * MAX_SCOPES * 2;
+    commandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+                                  firstQuery, slot.scopeCount * 2,
+                                  m_readbackBuffer.Get(), static_cast<UINT64>(firstQuery) * sizeof(uint64_t));
+
+    slot.fence = fence;
+    slot.fenceValue = fenceValue;
+    slot.pending = true;
+    m_writeSlot = (m_writeSlot + 1) % m_frameCount;
+}
+
+bool GpuProfiler::Collect() {
+    if (!m_initialized) {
+        return false;
+    }
+
+    bool collected = false;
+    while (m_slots[m_readSlot].pending &&
+           m_slots[m_readSlot].fence->GetCompletedValue() >= m_slots[m_readSlot].fenceValue) {
+        FrameSlot& slot = m_slots[m_readSlot];
+        ReadSlot(slot, m_readSlot);
+        slot.pending = false;
+        slot.fence.Reset();
+        m_readSlot = (m_readSlot + 1) % m_frameCount;
+        collected = true;
+    }
+
+    // Re-calibrate about once a second so clock drift stays bounded
+    if (collected) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        if (!m_calibrated || now.QuadPart - m_calibrationQpc > m_qpcFrequency) {
+            Calibrate();
+        }
+    }
+
+    return collected;
+}
+
+void GpuProfiler::ReadSlot(const FrameSlot& slot, uint32_t slotIndex) {
+    const uint64_t* ticks = m_readbackData + static_cast<size_t>(slotIndex) * MAX_SCOPES * 2;
+    const double msPerTick = 1000.0 / static_cast<double>(m_gpuFrequency);
+
+    GpuFrameTimes frame;
+    frame.frameNumber = slot.frameNumber;
+    frame.scopeCount = slot.scopeCount;
+
+    uint64_t firstBegin = UINT64_MAX;
+    uint64_t lastEnd = 0;
+    for (uint32_t i = 0; i < slot.scopeCount; i++) {
+        const uint64_t begin = ticks[i * 2];
+        const uint64_t end = ticks[i * 2 + 1];
+        frame.scopes[i].stage = slot.stages[i];
+        frame.scopes[i].index = slot.indices[i];
+        frame.scopes[i].ms = end > begin ? static_cast<double>(end - begin) * msPerTick : 0.0;
+        firstBegin = (std::min)(firstBegin, begin);
+        lastEnd = (std::max)(lastEnd, end);
+    }
+
+    if (lastEnd > firstBegin) {
+        frame.busyMs = static_cast<double>(lastEnd - firstBegin) * msPerTick;
+    }
+
+    if (m_calibrated) {
+        const double msPerQpc = 1000.0 / static_cast<double>(m_qpcFrequency);
+        const int64_t startQpc = GpuToQpc(firstBegin);
+        frame.startLatencyMs = (std::max)(0.0, static_cast<double>(startQpc - slot.cpuBeginQpc) * msPerQpc);
+
+        // Idle with work recorded: the queue could have started at the later of
+        // the CPU recording and the previous frame's end, and did not
+        int64_t readyQpc = slot.cpuBeginQpc;
+        if (m_previousEndTicks != 0) {
+            readyQpc = (std::max)(readyQpc, GpuToQpc(m_previousEndTicks));
+        }
+        frame.bubbleMs = (std::max)(0.0, static_cast<double>(startQpc - readyQpc) * msPerQpc);
+    }
+
+    m_previousEndTicks = lastEnd;
+    m_lastFrame = frame;
+}
+
+void GpuProfiler::Calibrate() {
+    uint64_t gpuTimestamp = 0;
+    uint64_t cpuTimestamp = 0;
+    if (m_queue && SUCCEEDED(m_queue->GetClockCalibration(&gpuTimestamp, &cpuTimestamp))) {
+        m_calibrationGpu = gpuTimestamp;
+        m_calibrationQpc = static_cast<int64_t>(cpuTimestamp);
+        m_calibrated = true;
+    }
+}
+
+int64_t GpuProfiler::GpuToQpc(uint64_t gpuTicks) const {
+    const double deltaTicks = static_cast<double>(static_cast<int64_t>(gpuTicks - m_calibrationGpu));
+    return m_calibrationQpc + static_cast<int64_t>(
+        deltaTicks * static_cast<double>(m_qpcFrequency) / static_cast<double>(m_gpuFrequency));
+}
+
+} // namespace osfg
@@ -0,0 +1,165 @@
+// OSFG - Open Source Frame Generation
+// GPU Profiler
+//
+// Timestamp scopes for one command queue across frames in flight. Each frame
+// writes into its own slot of a query heap ring and resolves into a
+// persistently mapped readback buffer; Collect() reads the slots whose fence
+// has completed and never waits, so results arrive a few frames late without
+// serializing the CPU and GPU. GetClockCalibration() maps GPU ticks onto the
+// CPU QPC timeline, which gives the delay from CPU recording to GPU start
+// and the time a queue sat idle with work submitted (a bubble).
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Pipeline stages a scope can measure
+enum class GpuStage : uint32_t {
+    TransferSource = 0,   // Primary GPU: copy into the shared texture / staging readback
+    TransferDest,         // Secondary GPU copy queue: shared texture / upload into the ring
+    OpticalFlow,          // Motion estimation
+    Interpolation,        // Compute-queue interpolation (index: dispatch chunk)
+    Present,              // Present queue: one present pass (index: pass in present order)
+    Count
+};
+
+static const uint32_t GPU_STAGE_COUNT = static_cast<uint32_t>(GpuStage::Count);
+
+// One measured scope of a frame
+struct GpuScopeTime {
+    GpuStage stage = GpuStage::Count;
+    uint32_t index = 0;
+    double ms = 0.0;
+};
+
+// Read-back timings of one frame on one queue
+struct GpuFrameTimes {
+    static const uint32_t MAX_SCOPES = 16;
+
+    GpuScopeTime scopes[MAX_SCOPES];
+    uint32_t scopeCount = 0;
+    double busyMs = 0.0;           // First scope start to last scope end
+    double startLatencyMs = 0.0;   // BeginFrame() on the CPU to the first scope on the GPU
+    double bubbleMs = 0.0;         // Queue idle before the first scope although the frame was recorded
+    uint64_t frameNumber = 0;      // BeginFrame() count when the frame was recorded
+
+    // Sum of the scopes of a stage (all indices)
+    double StageMs(GpuStage stage) const;
+
+    // One scope of a stage, or 0 if the frame has none
+    double ScopeMs(GpuStage stage, uint32_t index) const;
+};
+
+// Timestamp profiler for one command queue. All calls come from the thread
+// that records the queue's command lists.
+class GpuProfiler {
+public:
+    static const uint32_t MAX_FRAMES = 8;
+    static const uint32_t MAX_SCOPES = GpuFrameTimes::MAX_SCOPES;
+
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    // Non-copyable
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // Create the query ring for `queue`. `framesInFlight` is how many frames
+    // may be recorded before the oldest retires; frames beyond it are not
+    // measured rather than waited for. COPY queues need
+    // CopyQueueTimestampQueriesSupported.
+    bool Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t framesInFlight = 3);
+
+    // Release all resources
+    void Shutdown();
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // Start a frame (before recording its first command list on the queue)
+    void BeginFrame();
+
+    // Bracket work recorded in `commandList`. Scopes do not nest; a frame
+    // may spread its scopes over several command lists of the queue.
+    void BeginScope(ID3D12GraphicsCommandList* commandList, GpuStage stage, uint32_t index = 0);
+    void EndScope(ID3D12GraphicsCommandList* commandList);
+
+    // Resolve the frame's queries in its last command list on the queue.
+    // `fence` reaches `fenceValue` once that list has executed.
+    void EndFrame(ID3D12GraphicsCommandList* commandList, ID3D12Fence* fence, uint64_t fenceValue);
+
+    // Read back every frame whose fence has completed (never waits).
+    // Returns true if at least one frame was read.
+    bool Collect();
+
+    // Newest read-back frame
+    const GpuFrameTimes& GetLastFrame() const { return m_lastFrame; }
+
+    // Frames that could not be measured because the ring was full
+    uint64_t GetFramesSkipped() const { return m_framesSkipped; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    struct FrameSlot {
+        ComPtr<ID3D12Fence> fence;
+        uint64_t fenceValue = 0;
+        uint64_t frameNumber = 0;
+        int64_t cpuBeginQpc = 0;
+        GpuStage stages[MAX_SCOPES] = {};
+        uint32_t indices[MAX_SCOPES] = {};
+        uint32_t scopeCount = 0;
+        bool pending = false;
+    };
+
+    void ReadSlot(const FrameSlot& slot, uint32_t slotIndex);
+    void Calibrate();
+    int64_t GpuToQpc(uint64_t gpuTicks) const;
+
+    ComPtr<ID3D12CommandQueue> m_queue;
+    ComPtr<ID3D12QueryHeap> m_queryHeap;
+    ComPtr<ID3D12Resource> m_readbackBuffer;
+    const uint64_t* m_readbackData = nullptr;   // Persistently mapped
+
+    FrameSlot m_slots[MAX_FRAMES];
+    uint32_t m_frameCount = 0;
+    uint32_t m_writeSlot = 0;
+    uint32_t m_readSlot = 0;
+    bool m_recording = false;       // Between BeginFrame() and EndFrame() with a free slot
+    bool m_scopeOpen = false;
+    uint64_t m_frameNumber = 0;
+    uint64_t m_framesSkipped = 0;
+
+    // Clocks: GPU ticks, QPC, and the last calibration pair
+    uint64_t m_gpuFrequency = 0;
+    int64_t m_qpcFrequency = 0;
+    uint64_t m_calibrationGpu = 0;
+    int64_t m_calibrationQpc = 0;
+    bool m_calibrated = false;
+    uint64_t m_previousEndTicks = 0;   // Last scope end of the previous read-back frame
+
+    bool m_initialized = false;
+    GpuFrameTimes m_lastFrame;
+    std::string m_lastError;
+};
+
+} // namespace osfg
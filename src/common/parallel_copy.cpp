@@ -0,0 +1,369 @@
+// OSFG - Open Source Frame Generation
+// Parallel Copy Engine Implementation
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#include "parallel_copy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <immintrin.h>
+#include <system_error>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define OSFG_TARGET_SSE41
+#else
+#define OSFG_TARGET_SSE41 __attribute__((target("sse4.1")))
+#endif
+
+namespace osfg {
+
+namespace {
+
+// Copies below this size run on the calling thread
+const size_t MIN_PARALLEL_BYTES = 256 * 1024;
+
+// Candidate band sizes tried during calibration
+const size_t CALIBRATION_BAND_BYTES[] = { 64 * 1024, 256 * 1024, 1024 * 1024 };
+
+bool HasSSE41() {
+#ifdef _MSC_VER
+    int info[4] = {};
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+
+// 64 bytes per iteration; dst and src 16-byte aligned. Only worth it for a
+// write-combined src: on cached memory MOVNTDQA is an ordinary load.
+OSFG_TARGET_SSE41
+void StreamCopyAligned(uint8_t* dst, const uint8_t* src, size_t blocks) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    __m128i* s = reinterpret_cast<__m128i*>(const_cast<uint8_t*>(src));
+    for (size_t i = 0; i < blocks; i++, d += 4, s += 4) {
+        __m128i r0 = _mm_stream_load_si128(s + 0);
+        __m128i r1 = _mm_stream_load_si128(s + 1);
+        __m128i r2 = _mm_stream_load_si128(s + 2);
+        __m128i r3 = _mm_stream_load_si128(s + 3);
+        _mm_stream_si128(d + 0, r0);
+        _mm_stream_si128(d + 1, r1);
+        _mm_stream_si128(d + 2, r2);
+        _mm_stream_si128(d + 3, r3);
+    }
+}
+
+// 64 bytes per iteration; dst 16-byte aligned, src any alignment
+void StreamCopyUnaligned(uint8_t* dst, const uint8_t* src, size_t blocks) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    for (size_t i = 0; i < blocks; i++, d += 4, s += 4) {
+        __m128i r0 = _mm_loadu_si128(s + 0);
+        __m128i r1 = _mm_loadu_si128(s + 1);
+        __m128i r2 = _mm_loadu_si128(s + 2);
+        __m128i r3 = _mm_loadu_si128(s + 3);
+        _mm_stream_si128(d + 0, r0);
+        _mm_stream_si128(d + 1, r1);
+        _mm_stream_si128(d + 2, r2);
+        _mm_stream_si128(d + 3, r3);
+    }
+}
+
+} // namespace
+
+ParallelCopyEngine::~ParallelCopyEngine() {
+    Shutdown();
+}
+
+bool ParallelCopyEngine::Initialize(const ParallelCopyConfig& config) {
+    if (m_initialized) {
+        m_lastError = "Already initialized";
+        return false;
+    }
+
+    m_config = config;
+    m_streamingLoads = config.writeCombinedSource && HasSSE41();
+
+    uint32_t maxThreads = config.maxThreads;
+    if (maxThreads == 0) {
+        // Half the logical cores (SMT siblings share load ports), capped:
+        // the copy saturates memory bandwidth well before it runs out of cores
+        uint32_t hw = std::thread::hardware_concurrency();
+        maxThreads = (std::min)((std::max)(hw / 2, 1u), 8u);
+    }
+
+    // Candidate configurations: thread counts 1, 2, 4, ... plus maxThreads
+    m_candidates.clear();
+    m_candidateBestMs.clear();
+    for (uint32_t threads = 1; ; threads *= 2) {
+        uint32_t t = (std::min)(threads, maxThreads);
+        for (size_t bandBytes : CALIBRATION_BAND_BYTES) {
+            m_candidates.push_back({ t, bandBytes });
+        }
+        if (t == maxThreads) break;
+    }
+    m_candidateBestMs.assign(m_candidates.size(), 0.0);
+    m_calibrationIndex = 0;
+    m_calibrationRun = 0;
+
+    if (config.calibrate) {
+        m_threads = maxThreads;
+        m_bandBytes = CALIBRATION_BAND_BYTES[1];
+    } else {
+        m_threads = config.threads ? (std::min)(config.threads, maxThreads) : maxThreads;
+        m_bandBytes = (std::max)(config.bandBytes, static_cast<size_t>(4096));
+    }
+
+    m_stats = ParallelCopyStats();
+    m_stats.threads = m_threads;
+    m_stats.bandBytes = m_bandBytes;
+    m_stats.calibrated = !config.calibrate;
+    m_stats.streamingLoads = m_streamingLoads;
+
+    // The calling thread takes part in every copy, so spawn maxThreads - 1
+    m_stopping = false;
+    m_jobGeneration = 0;
+    m_activeWorkers = 0;
+    m_workersBusy = 0;
+    try {
+        for (uint32_t i = 0; i + 1 < maxThreads; i++) {
+            m_workers.emplace_back(&ParallelCopyEngine::WorkerLoop, this, i);
+        }
+    } catch (const std::system_error& e) {
+        m_lastError = std::string("Failed to create copy worker thread: ") + e.what();
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void ParallelCopyEngine::Shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workCondition.notify_all();
+
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+    m_initialized = false;
+}
+
+void ParallelCopyEngine::Recalibrate() {
+    if (!m_config.calibrate) return;
+    std::fill(m_candidateBestMs.begin(), m_candidateBestMs.end(), 0.0);
+    m_calibrationIndex = 0;
+    m_calibrationRun = 0;
+    m_stats.calibrated = false;
+}
+
+void ParallelCopyEngine::Copy(void* dst, const void* src, size_t size) {
+    // Treat the block as 4 KB rows so it bands like a pitched copy
+    const size_t rowBytes = 4096;
+    const size_t rows = size / rowBytes;
+    const size_t bodyBytes = rows * rowBytes;
+
+    if (rows > 0) {
+        CopyRows(dst, rowBytes, src, rowBytes, rowBytes, static_cast<uint32_t>(rows));
+    }
+    if (bodyBytes < size) {
+        memcpy(static_cast<uint8_t*>(dst) + bodyBytes,
+               static_cast<const uint8_t*>(src) + bodyBytes, size - bodyBytes);
+    }
+}
+
+void ParallelCopyEngine::CopyRows(void* dst, size_t dstPitch,
+                                  const void* src, size_t srcPitch,
+                                  size_t rowBytes, uint32_t rows) {
+    const size_t totalBytes = rowBytes * rows;
+    if (totalBytes == 0) return;
+
+    if (!m_initialized || totalBytes < MIN_PARALLEL_BYTES) {
+        uint8_t* d = static_cast<uint8_t*>(dst);
+        const uint8_t* s = static_cast<const uint8_t*>(src);
+        for (uint32_t y = 0; y < rows; y++) {
+            memcpy(d + y * dstPitch, s + y * srcPitch, rowBytes);
+        }
+        return;
+    }
+
+    uint32_t threads = m_threads;
+    size_t bandBytes = m_bandBytes;
+    const bool calibrating = m_config.calibrate && !m_stats.calibrated;
+    if (calibrating) {
+        threads = m_candidates[m_calibrationIndex].threads;
+        bandBytes = m_candidates[m_calibrationIndex].bandBytes;
+    }
+
+    m_job.dst = static_cast<uint8_t*>(dst);
+    m_job.src = static_cast<const uint8_t*>(src);
+    m_job.dstPitch = dstPitch;
+    m_job.srcPitch = srcPitch;
+    m_job.rowBytes = rowBytes;
+    m_job.rows = rows;
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    RunJob(threads, bandBytes);
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    double timeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    RecordCopy(timeMs, totalBytes);
+}
+
+void ParallelCopyEngine::RunJob(uint32_t threads, size_t bandBytes) {
+    Job& job = m_job;
+    job.rowsPerBand = static_cast<uint32_t>((std::max)(bandBytes / job.rowBytes, static_cast<size_t>(1)));
+    job.bandCount = (job.rows + job.rowsPerBand - 1) / job.rowsPerBand;
+    job.nextBand.store(0, std::memory_order_relaxed);
+
+    const uint32_t helpers = (std::min)(threads - 1, static_cast<uint32_t>(m_workers.size()));
+    if (helpers > 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeWorkers = helpers;
+            m_workersBusy = helpers;
+            m_jobGeneration++;
+        }
+        m_workCondition.notify_all();
+    }
+
+    RunBands(job);
+
+    if (helpers > 0) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this] { return m_workersBusy == 0; });
+    }
+}
+
+void ParallelCopyEngine::WorkerLoop(uint32_t workerIndex) {
+    uint64_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_workCondition.wait(lock, [&] { return m_stopping || m_jobGeneration != seenGeneration; });
+        if (m_stopping) break;
+
+        seenGeneration = m_jobGeneration;
+        if (workerIndex >= m_activeWorkers) continue;
+
+        lock.unlock();
+        RunBands(m_job);
+        lock.lock();
+
+        if (--m_workersBusy == 0) {
+            m_doneCondition.notify_one();
+        }
+    }
+}
+
+void ParallelCopyEngine::RunBands(Job& job) {
+    const bool contiguous = (job.dstPitch == job.rowBytes && job.srcPitch == job.rowBytes);
+
+    while (true) {
+        const uint32_t band = job.nextBand.fetch_add(1, std::memory_order_relaxed);
+        if (band >= job.bandCount) break;
+
+        const uint32_t firstRow = band * job.rowsPerBand;
+        const uint32_t rowCount = (std::min)(job.rowsPerBand, job.rows - firstRow);
+
+        if (contiguous) {
+            const size_t offset = static_cast<size_t>(firstRow) * job.rowBytes;
+            CopyBlock(job.dst + offset, job.src + offset, static_cast<size_t>(rowCount) * job.rowBytes);
+        } else {
+            for (uint32_t y = firstRow; y < firstRow + rowCount; y++) {
+                CopyBlock(job.dst + y * job.dstPitch, job.src + y * job.srcPitch, job.rowBytes);
+            }
+        }
+    }
+
+    // Make this thread's streaming stores globally visible before the
+    // caller hands the buffer to the GPU
+    _mm_sfence();
+}
+
+void ParallelCopyEngine::CopyBlock(uint8_t* dst, const uint8_t* src, size_t size) const {
+    // Align the destination so every streaming store fills whole WC lines
+    size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+    head = (std::min)(head, size);
+    if (head) {
+        memcpy(dst, src, head);
+        dst += head;
+        src += head;
+        size -= head;
+    }
+
+    const size_t blocks = size / 64;
+    if (blocks) {
+        if (m_streamingLoads && (reinterpret_cast<uintptr_t>(src) & 15) == 0) {
+            StreamCopyAligned(dst, src, blocks);
+        } else {
+            StreamCopyUnaligned(dst, src, blocks);
+        }
+        dst += blocks * 64;
+        src += blocks * 64;
+        size -= blocks * 64;
+    }
+
+    if (size) {
+        memcpy(dst, src, size);
+    }
+}
+
+void ParallelCopyEngine::RecordCopy(double timeMs, size_t bytes) {
+    m_stats.copies++;
+    m_stats.lastCopyTimeMs = timeMs;
+    if (m_stats.avgCopyTimeMs == 0.0) {
+        m_stats.avgCopyTimeMs = timeMs;
+    } else {
+        const double alpha = 0.1;
+        m_stats.avgCopyTimeMs = m_stats.avgCopyTimeMs * (1.0 - alpha) + timeMs * alpha;
+    }
+    if (timeMs > 0.0) {
+        m_stats.throughputMBps = bytes / (timeMs * 1000.0);
+    }
+
+    if (!m_config.calibrate || m_stats.calibrated) {
+        return;
+    }
+
+    // Keep the best of CALIBRATION_RUNS copies per candidate (the first one
+    // of each pays for worker wake-up and page faults)
+    double& best = m_candidateBestMs[m_calibrationIndex];
+    if (best == 0.0 || timeMs < best) {
+        best = timeMs;
+    }
+
+    if (++m_calibrationRun < CALIBRATION_RUNS) {
+        return;
+    }
+    m_calibrationRun = 0;
+
+    if (++m_calibrationIndex < m_candidates.size()) {
+        return;
+    }
+
+    uint32_t bestIndex = 0;
+    for (uint32_t i = 1; i < m_candidates.size(); i++) {
+        if (m_candidateBestMs[i] < m_candidateBestMs[bestIndex]) {
+            bestIndex = i;
+        }
+    }
+    m_threads = m_candidates[bestIndex].threads;
+    m_bandBytes = m_candidates[bestIndex].bandBytes;
+    m_calibrationIndex = 0;
+
+    m_stats.threads = m_threads;
+    m_stats.bandBytes = m_bandBytes;
+    m_stats.calibrated = true;
+}
+
+} // namespace osfg
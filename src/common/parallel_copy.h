@@ -0,0 +1,140 @@
+// OSFG - Open Source Frame Generation
+// Parallel Copy Engine
+//
+// Copies large CPU-visible GPU buffers (readback / write-combined upload heaps)
+// across a small persistent thread pool. Rows are split into bands that the
+// workers and the calling thread pull from a shared counter; each band is
+// copied with streaming (non-temporal) SSE stores so write-combined
+// destinations are filled in full lines and the cache is not polluted.
+// Streaming loads (MOVNTDQA) only bypass the cache on write-combined memory,
+// so they are used only when the source is declared write-combined; cached
+// (write-back) sources such as readback heaps and staging maps use plain loads.
+//
+// Thread count and band size are picked by runtime calibration: the first
+// copies cycle through candidate configurations on the real buffers and the
+// fastest one is kept.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace osfg {
+
+// Configuration for the copy engine
+struct ParallelCopyConfig {
+    uint32_t maxThreads = 0;            // Total threads including the caller (0 = auto)
+    bool calibrate = true;              // Pick thread count / band size from timed copies
+    uint32_t threads = 0;               // Fixed thread count when not calibrating (0 = maxThreads)
+    size_t bandBytes = 256 * 1024;      // Fixed band size when not calibrating
+    bool writeCombinedSource = false;   // Source is WC memory: use streaming loads
+};
+
+// Copy statistics
+struct ParallelCopyStats {
+    uint64_t copies = 0;
+    double lastCopyTimeMs = 0.0;
+    double avgCopyTimeMs = 0.0;
+    double throughputMBps = 0.0;
+    uint32_t threads = 1;               // Current (or calibrated) thread count
+    size_t bandBytes = 0;               // Current (or calibrated) band size
+    bool calibrated = false;
+    bool streamingLoads = false;        // SSE4.1 MOVNTDQA used (WC source only)
+};
+
+class ParallelCopyEngine {
+public:
+    ParallelCopyEngine() = default;
+    ~ParallelCopyEngine();
+
+    // Non-copyable
+    ParallelCopyEngine(const ParallelCopyEngine&) = delete;
+    ParallelCopyEngine& operator=(const ParallelCopyEngine&) = delete;
+
+    // Start the worker threads. Fails (with GetLastError set) when already
+    // initialized or when a worker thread cannot be created.
+    bool Initialize(const ParallelCopyConfig& config = ParallelCopyConfig());
+
+    // Stop and join the worker threads
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Copy `rows` rows of `rowBytes` bytes between pitched buffers.
+    // Blocks until the copy is complete. Falls back to memcpy when not
+    // initialized.
+    void CopyRows(void* dst, size_t dstPitch,
+                  const void* src, size_t srcPitch,
+                  size_t rowBytes, uint32_t rows);
+
+    // Copy a contiguous block
+    void Copy(void* dst, const void* src, size_t size);
+
+    // Restart calibration (e.g. after the buffers change size)
+    void Recalibrate();
+
+    const ParallelCopyStats& GetStats() const { return m_stats; }
+
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // One copy request shared with the workers
+    struct Job {
+        uint8_t* dst = nullptr;
+        const uint8_t* src = nullptr;
+        size_t dstPitch = 0;
+        size_t srcPitch = 0;
+        size_t rowBytes = 0;
+        uint32_t rows = 0;
+        uint32_t rowsPerBand = 1;
+        uint32_t bandCount = 0;
+        std::atomic<uint32_t> nextBand{0};
+    };
+
+    struct Candidate {
+        uint32_t threads;
+        size_t bandBytes;
+    };
+
+    void WorkerLoop(uint32_t workerIndex);
+    void RunBands(Job& job);
+    void RunJob(uint32_t threads, size_t bandBytes);
+    void CopyBlock(uint8_t* dst, const uint8_t* src, size_t size) const;
+    void RecordCopy(double timeMs, size_t bytes);
+
+    // Worker pool
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_workCondition;
+    std::condition_variable m_doneCondition;
+    uint64_t m_jobGeneration = 0;       // Bumped per dispatched job
+    uint32_t m_activeWorkers = 0;       // Workers allowed to join the current job
+    uint32_t m_workersBusy = 0;         // Workers still inside the current job
+    bool m_stopping = false;
+    Job m_job;
+
+    // Calibration
+    static const uint32_t CALIBRATION_RUNS = 3;   // Timed copies per candidate (best kept)
+    std::vector<Candidate> m_candidates;
+    std::vector<double> m_candidateBestMs;
+    uint32_t m_calibrationIndex = 0;
+    uint32_t m_calibrationRun = 0;
+    uint32_t m_threads = 1;
+    size_t m_bandBytes = 256 * 1024;
+
+    ParallelCopyConfig m_config;
+    ParallelCopyStats m_stats;
+    bool m_streamingLoads = false;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
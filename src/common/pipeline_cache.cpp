@@ -0,0 +1,318 @@
+// OSFG - Open Source Frame Generation
+// Pipeline State Cache Implementation
+
+#include "pipeline_cache.h"
+
+#include <dxgi1_6.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+namespace osfg {
+
+PipelineCache::~PipelineCache() {
+    Shutdown();
+}
+
+bool PipelineCache::Initialize(ID3D12Device* device, const PipelineCacheConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!device) {
+        m_lastError = "Device is null";
+        return false;
+    }
+
+    // Kept on failure: Create*() then go straight to the device
+    m_device = device;
+
+    D3D12_FEATURE_DATA_SHADER_CACHE shaderCache = {};
+    if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_SHADER_CACHE, &shaderCache, sizeof(shaderCache))) ||
+        !(shaderCache.SupportFlags & D3D12_SHADER_CACHE_SUPPORT_LIBRARY)) {
+        m_lastError = "Driver does not support pipeline libraries";
+        return false;
+    }
+
+    if (FAILED(m_device.As(&m_device1))) {
+        m_lastError = "ID3D12Device1 not available";
+        return false;
+    }
+
+    if (!ResolvePath(config) || !OpenLibrary()) {
+        m_library.Reset();
+        m_blob.clear();
+        m_device1.Reset();
+        return false;
+    }
+
+    m_stats.hits = 0;
+    m_stats.misses = 0;
+    m_stats.shared = 0;
+    m_initialized = true;
+    return true;
+}
+
+void PipelineCache::Shutdown() {
+    if (m_initialized) {
+        Save();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_session.clear();
+    m_library.Reset();
+    m_blob.clear();
+    m_device1.Reset();
+    m_device.Reset();
+    m_dirty = false;
+    m_stale = false;
+    m_initialized = false;
+}
+
+bool PipelineCache::ResolvePath(const PipelineCacheConfig& config) {
+    // Key the file by adapter and user-mode driver version
+    ComPtr<IDXGIFactory4> factory;
+    ComPtr<IDXGIAdapter1> adapter;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) ||
+        FAILED(factory->EnumAdapterByLuid(m_device->GetAdapterLuid(), IID_PPV_ARGS(&adapter)))) {
+        m_lastError = "Failed to find the device's adapter";
+        return false;
+    }
+
+    DXGI_ADAPTER_DESC1 desc = {};
+    adapter->GetDesc1(&desc);
+
+    LARGE_INTEGER driverVersion = {};
+    if (FAILED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion))) {
+        driverVersion.QuadPart = 0;
+    }
+
+    std::filesystem::path directory = config.directory;
+    if (directory.empty()) {
+        wchar_t localAppData[MAX_PATH] = {};
+        DWORD length = GetEnvironmentVariableW(L"LOCALAPPDATA", localAppData, MAX_PATH);
+        if (length == 0 || length >= MAX_PATH) {
+            m_lastError = "LOCALAPPDATA is not set";
+            return false;
+        }
+        directory = std::filesystem::path(localAppData) / L"OSFG" / L"PipelineCache";
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        m_lastError = "Failed to create pipeline cache directory";
+        return false;
+    }
+
+    wchar_t fileName[96];
+    swprintf_s(fileName, L"pso_%04x_%04x_%u.%u.%u.%u.bin", desc.VendorId, desc.DeviceId,
+               HIWORD(driverVersion.HighPart), LOWORD(driverVersion.HighPart),
+               HIWORD(driverVersion.LowPart), LOWORD(driverVersion.LowPart));
+    m_path = (directory / fileName).wstring();
+    return true;
+}
+
+bool PipelineCache::OpenLibrary() {
+    m_blob.clear();
+    m_stats.loadedBytes = 0;
+
+    std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+    if (file) {
+        const std::streamoff size = file.tellg();
+        if (size > 0) {
+            m_blob.resize(static_cast<size_t>(size));
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(m_blob.data()), size)) {
+                m_blob.clear();
+            }
+        }
+    }
+
+    // A corrupt file, or one from another driver build despite the name,
+    // is dropped and rebuilt
+    if (!m_blob.empty()) {
+        HRESULT hr = m_device1->CreatePipelineLibrary(m_blob.data(), m_blob.size(),
+                                                      IID_PPV_ARGS(&m_library));
+        if (SUCCEEDED(hr)) {
+            m_stats.loadedBytes = m_blob.size();
+            return true;
+        }
+        m_blob.clear();
+    }
+
+    HRESULT hr = m_device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create pipeline library";
+        return false;
+    }
+    return true;
+}
+
+std::wstring PipelineCache::LibraryName(const std::string& name, const D3D12_SHADER_BYTECODE* shaders,
+                                        uint32_t shaderCount, uint64_t salt) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    for (uint32_t i = 0; i < shaderCount; i++) {
+        mix(shaders[i].pShaderBytecode, shaders[i].BytecodeLength);
+    }
+    mix(&salt, sizeof(salt));
+
+    wchar_t suffix[24];
+    swprintf_s(suffix, L"#%016llx", static_cast<unsigned long long>(hash));
+    return std::wstring(name.begin(), name.end()) + suffix;
+}
+
+void PipelineCache::Store(const std::wstring& name, ID3D12PipelineState* pipelineState) {
+    // E_INVALIDARG: an entry of that name exists but its description did
+    // not match (e.g. a changed root signature); Save() rebuilds the file
+    HRESULT hr = m_library->StorePipeline(name.c_str(), pipelineState);
+    if (SUCCEEDED(hr)) {
+        m_dirty = true;
+    } else if (hr == E_INVALIDARG) {
+        m_stale = true;
+    }
+}
+
+void PipelineCache::Remember(const std::wstring& name, ID3D12RootSignature* rootSignature,
+                             ID3D12PipelineState* pipelineState) {
+    // Re-initialized modules recreate the same PSOs; keep the latest
+    for (SessionEntry& entry : m_session) {
+        if (entry.name == name) {
+            entry.rootSignature = rootSignature;
+            entry.pipelineState = pipelineState;
+            return;
+        }
+    }
+    m_session.push_back({ name, rootSignature, pipelineState });
+}
+
+bool PipelineCache::Reuse(const std::wstring& name, ID3D12RootSignature* rootSignature,
+                          ComPtr<ID3D12PipelineState>& pipelineState) {
+    // A PSO only runs with the root signature it was created against
+    for (const SessionEntry& entry : m_session) {
+        if (entry.name == name && entry.rootSignature.Get() == rootSignature) {
+            pipelineState = entry.pipelineState;
+            m_stats.shared++;
+            return true;
+        }
+    }
+    return false;
+}
+
+HRESULT PipelineCache::CreateComputePipelineState(const std::string& name,
+                                                  const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc,
+                                                  ComPtr<ID3D12PipelineState>& pipelineState) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized) {
+        return m_device ? m_device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState))
+                        : E_FAIL;
+    }
+
+    const std::wstring libraryName = LibraryName(name, &desc.CS, 1, 0);
+    if (Reuse(libraryName, desc.pRootSignature, pipelineState)) {
+        return S_OK;
+    }
+    if (SUCCEEDED(m_library->LoadComputePipeline(libraryName.c_str(), &desc, IID_PPV_ARGS(&pipelineState)))) {
+        m_stats.hits++;
+        Remember(libraryName, desc.pRootSignature, pipelineState.Get());
+        return S_OK;
+    }
+
+    HRESULT hr = m_device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+    if (FAILED(hr)) {
+        return hr;
+    }
+    m_stats.misses++;
+    Store(libraryName, pipelineState.Get());
+    Remember(libraryName, desc.pRootSignature, pipelineState.Get());
+    return S_OK;
+}
+
+HRESULT PipelineCache::CreateGraphicsPipelineState(const std::string& name,
+                                                   const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                                   ComPtr<ID3D12PipelineState>& pipelineState) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized) {
+        return m_device ? m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState))
+                        : E_FAIL;
+    }
+
+    // The render-target format is part of the PSO but not of the bytecode
+    const D3D12_SHADER_BYTECODE shaders[] = { desc.VS, desc.PS };
+    const uint64_t salt = (static_cast<uint64_t>(desc.NumRenderTargets) << 32) | desc.RTVFormats[0];
+    const std::wstring libraryName = LibraryName(name, shaders, 2, salt);
+    if (Reuse(libraryName, desc.pRootSignature, pipelineState)) {
+        return S_OK;
+    }
+    if (SUCCEEDED(m_library->LoadGraphicsPipeline(libraryName.c_str(), &desc, IID_PPV_ARGS(&pipelineState)))) {
+        m_stats.hits++;
+        Remember(libraryName, desc.pRootSignature, pipelineState.Get());
+        return S_OK;
+    }
+
+    HRESULT hr = m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+    if (FAILED(hr)) {
+        return hr;
+    }
+    m_stats.misses++;
+    Store(libraryName, pipelineState.Get());
+    Remember(libraryName, desc.pRootSignature, pipelineState.Get());
+    return S_OK;
+}
+
+bool PipelineCache::Save() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized || (!m_dirty && !m_stale)) {
+        return true;
+    }
+
+    // A library cannot drop entries: start over with this session's PSOs
+    if (m_stale) {
+        ComPtr<ID3D12PipelineLibrary> library;
+        if (FAILED(m_device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library)))) {
+            m_lastError = "Failed to create pipeline library";
+            return false;
+        }
+        for (const SessionEntry& entry : m_session) {
+            library->StorePipeline(entry.name.c_str(), entry.pipelineState.Get());
+        }
+        m_library = library;
+        m_stale = false;
+    }
+
+    std::vector<uint8_t> data(m_library->GetSerializedSize());
+    if (data.empty() || FAILED(m_library->Serialize(data.data(), data.size()))) {
+        m_lastError = "Failed to serialize pipeline library";
+        return false;
+    }
+
+    // Write next to the old file and swap, so a crash never leaves half a library
+    const std::wstring tempPath = m_path + L".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file || !file.write(reinterpret_cast<const char*>(data.data()), data.size())) {
+            m_lastError = "Failed to write pipeline cache";
+            return false;
+        }
+    }
+    if (!MoveFileExW(tempPath.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileW(tempPath.c_str());
+        m_lastError = "Failed to replace pipeline cache";
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+} // namespace osfg
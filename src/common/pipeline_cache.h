@@ -0,0 +1,130 @@
+// OSFG - Open Source Frame Generation
+// Pipeline State Cache
+//
+// On-disk ID3D12PipelineLibrary for the flow and interpolation pipelines.
+// One library file per adapter (vendor and device ID) and user-mode driver
+// version, so a driver update or another GPU starts a fresh file instead of
+// failing to load. Each PSO is stored under its name plus a hash of its
+// shader bytecode: a changed kernel produces a new entry rather than a
+// mismatch. Misses compile the PSO as usual and add it to the library;
+// Save() writes the library back when anything was added. Within a session
+// a PSO is created once: modules of other pipelines on the device asking
+// for the same entry against the same root signature get the same object.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Configuration for the pipeline cache
+struct PipelineCacheConfig {
+    std::wstring directory;     // Empty = %LOCALAPPDATA%\OSFG\PipelineCache
+};
+
+// Cache statistics
+struct PipelineCacheStats {
+    uint32_t hits = 0;          // PSOs loaded from the library
+    uint32_t misses = 0;        // PSOs compiled (and stored)
+    uint32_t shared = 0;        // Requests served with a PSO already created this session
+    uint64_t loadedBytes = 0;   // Size of the library file read at startup
+};
+
+class PipelineCache {
+public:
+    PipelineCache() = default;
+    ~PipelineCache();
+
+    // Non-copyable
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    // Open the library file for the device's adapter and driver, or start
+    // an empty one. Fails when the driver has no pipeline library support;
+    // the Create*() calls then go straight to the device.
+    bool Initialize(ID3D12Device* device, const PipelineCacheConfig& config = {});
+
+    // Save() and release the library
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Load the PSO stored under name, or create it and add it to the
+    // library. Safe to call from several threads.
+    HRESULT CreateComputePipelineState(const std::string& name,
+                                       const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc,
+                                       ComPtr<ID3D12PipelineState>& pipelineState);
+    HRESULT CreateGraphicsPipelineState(const std::string& name,
+                                        const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc,
+                                        ComPtr<ID3D12PipelineState>& pipelineState);
+
+    // Write the library back if PSOs were added since it was loaded
+    bool Save();
+
+    // Library file in use
+    const std::wstring& GetPath() const { return m_path; }
+
+    const PipelineCacheStats& GetStats() const { return m_stats; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool ResolvePath(const PipelineCacheConfig& config);
+    bool OpenLibrary();
+    void Store(const std::wstring& name, ID3D12PipelineState* pipelineState);
+    void Remember(const std::wstring& name, ID3D12RootSignature* rootSignature,
+                  ID3D12PipelineState* pipelineState);
+    bool Reuse(const std::wstring& name, ID3D12RootSignature* rootSignature,
+               ComPtr<ID3D12PipelineState>& pipelineState);
+
+    // Library name: PSO name plus an FNV-1a hash of everything that varies
+    // between builds of the same PSO
+    static std::wstring LibraryName(const std::string& name, const D3D12_SHADER_BYTECODE* shaders,
+                                    uint32_t shaderCount, uint64_t salt);
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12Device1> m_device1;
+
+    // Serialized library; must outlive m_library, which references it
+    std::vector<uint8_t> m_blob;
+    ComPtr<ID3D12PipelineLibrary> m_library;
+
+    // PSOs used this session, handed out again to later requests and
+    // re-stored into a fresh library when the file holds an entry whose
+    // description no longer matches
+    struct SessionEntry {
+        std::wstring name;
+        ComPtr<ID3D12RootSignature> rootSignature;
+        ComPtr<ID3D12PipelineState> pipelineState;
+    };
+    std::vector<SessionEntry> m_session;
+    bool m_dirty = false;       // Entries added since load
+    bool m_stale = false;       // Name collision with a mismatching entry
+
+    std::mutex m_mutex;
+    std::wstring m_path;
+    PipelineCacheStats m_stats;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
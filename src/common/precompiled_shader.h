@@ -0,0 +1,74 @@
+// OSFG - Open Source Frame Generation
+// Precompiled Shader Tables
+//
+// Entries of the DXIL tables generated at build time by
+// osfg_precompile_shaders() (cmake/OSFGShaders.cmake). The build extracts
+// each embedded HLSL string from its .cpp, compiles every listed variant
+// with DXC and emits one table per string. Variants are keyed by entry point
+// and the preprocessor defines they were built with, so a module finds its
+// bytecode from the same D3D_SHADER_MACRO list it would hand to D3DCompile.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <d3d12.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace osfg {
+
+// One compiled variant of an embedded shader
+struct PrecompiledShader {
+    const char* entryPoint;
+    const char* defines;            // "NAME=VALUE;NAME=VALUE" in compile order, "" for none
+    const unsigned char* bytecode;  // Signed DXIL (shader model 6.0)
+    size_t size;
+};
+
+// Key of a null-terminated macro list in PrecompiledShader::defines form
+inline std::string ShaderDefinesKey(const D3D_SHADER_MACRO* defines) {
+    std::string key;
+    for (; defines && defines->Name; defines++) {
+        if (!key.empty()) {
+            key += ';';
+        }
+        key += defines->Name;
+        key += '=';
+        key += defines->Definition ? defines->Definition : "";
+    }
+    return key;
+}
+
+// Variant in a generated table, or nullptr if it was not precompiled
+inline const PrecompiledShader* FindPrecompiledShader(const PrecompiledShader* table, size_t count,
+                                                      const char* entryPoint,
+                                                      const std::string& definesKey) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(table[i].entryPoint, entryPoint) == 0 && definesKey == table[i].defines) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+// True if the device runs the shader model 6.0 DXIL in the generated tables.
+// Older drivers keep using the runtime-compiled cs_5_0 kernels.
+inline bool SupportsShaderModel6(ID3D12Device* device) {
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_0 };
+    return device &&
+           SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel,
+                                                 sizeof(shaderModel))) &&
+           shaderModel.HighestShaderModel >= D3D_SHADER_MODEL_6_0;
+}
+
+} // namespace osfg
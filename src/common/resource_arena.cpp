@@ -0,0 +1,335 @@
+// OSFG - Open Source Frame Generation
+// Placed-Resource Heap Arena Implementation
+
+#include "resource_arena.h"
+
+#include <algorithm>
+
+#pragma comment(lib, "d3d12.lib")
+
+namespace osfg {
+
+ResourceArena::~ResourceArena() {
+    Shutdown();
+}
+
+bool ResourceArena::Initialize(ID3D12Device* device, uint64_t heapSize) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!device || heapSize == 0) {
+        m_lastError = "Invalid device or heap size";
+        return false;
+    }
+
+    m_device = device;
+    m_heapSize = (heapSize + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) &
+                 ~static_cast<uint64_t>(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+    m_mixedHeaps = SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options))) &&
+                   options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2;
+
+    m_stats = {};
+    m_initialized = true;
+    return true;
+}
+
+void ResourceArena::Shutdown() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocations.clear();
+    m_heaps.clear();
+    m_stats = {};
+    m_device.Reset();
+    m_initialized = false;
+}
+
+ResourceArena::HeapCategory ResourceArena::CategoryOf(const D3D12_RESOURCE_DESC& desc) const {
+    if (m_mixedHeaps) {
+        return HeapCategory::All;
+    }
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER) {
+        return HeapCategory::Buffers;
+    }
+    const D3D12_RESOURCE_FLAGS renderTarget =
+        D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    return (desc.Flags & renderTarget) ? HeapCategory::RenderTargets : HeapCategory::Textures;
+}
+
+bool ResourceArena::AllocateFrom(Heap& heap, uint64_t size, uint64_t alignment, uint64_t& offset) {
+    for (size_t i = 0; i < heap.freeRanges.size(); i++) {
+        Range& range = heap.freeRanges[i];
+        const uint64_t aligned = (range.offset + alignment - 1) & ~(alignment - 1);
+        if (aligned + size > range.offset + range.size) {
+            continue;
+        }
+
+        // Keep the padding in front and the tail as free ranges
+        const Range tail = { aligned + size, range.offset + range.size - (aligned + size) };
+        const uint64_t padding = aligned - range.offset;
+        if (padding > 0) {
+            range.size = padding;
+            if (tail.size > 0) {
+                heap.freeRanges.insert(heap.freeRanges.begin() + i + 1, tail);
+            }
+        } else if (tail.size > 0) {
+            range = tail;
+        } else {
+            heap.freeRanges.erase(heap.freeRanges.begin() + i);
+        }
+
+        offset = aligned;
+        heap.allocations++;
+        return true;
+    }
+    return false;
+}
+
+void ResourceArena::Free(Heap& heap, Range range) {
+    auto next = std::lower_bound(heap.freeRanges.begin(), heap.freeRanges.end(), range.offset,
+                                 [](const Range& r, uint64_t offset) { return r.offset < offset; });
+    next = heap.freeRanges.insert(next, range);
+
+    // Coalesce with the neighbours
+    if (next + 1 != heap.freeRanges.end() && next->offset + next->size == (next + 1)->offset) {
+        next->size += (next + 1)->size;
+        heap.freeRanges.erase(next + 1);
+    }
+    if (next != heap.freeRanges.begin() && (next - 1)->offset + (next - 1)->size == next->offset) {
+        (next - 1)->size += next->size;
+        heap.freeRanges.erase(next);
+    }
+    heap.allocations--;
+}
+
+bool ResourceArena::Allocate(D3D12_HEAP_TYPE heapType, HeapCategory category, uint64_t size,
+                             uint64_t alignment, Heap*& heap, uint64_t& offset) {
+    for (auto& candidate : m_heaps) {
+        if (candidate->type == heapType && candidate->category == category &&
+            AllocateFrom(*candidate, size, alignment, offset)) {
+            heap = candidate.get();
+            return true;
+        }
+    }
+
+    // Nothing free fits: a new heap. Resources over half the heap size get
+    // one of their own, sized to fit, so large frames don't strand the rest.
+    const uint64_t heapAlignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    D3D12_HEAP_DESC heapDesc = {};
+    heapDesc.SizeInBytes = size > m_heapSize / 2 ? (size + heapAlignment - 1) & ~(heapAlignment - 1) : m_heapSize;
+    heapDesc.Properties.Type = heapType;
+    heapDesc.Alignment = heapAlignment;
+    switch (category) {
+        case HeapCategory::Buffers:       heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS; break;
+        case HeapCategory::Textures:      heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES; break;
+        case HeapCategory::RenderTargets: heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES; break;
+        default:                          heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES; break;
+    }
+
+    auto created = std::make_unique<Heap>();
+    if (FAILED(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&created->heap)))) {
+        m_lastError = "Failed to create a " + std::to_string(heapDesc.SizeInBytes >> 20) + " MB resource heap";
+        return false;
+    }
+    created->type = heapType;
+    created->category = category;
+    created->size = heapDesc.SizeInBytes;
+    created->freeRanges.push_back({ 0, heapDesc.SizeInBytes });
+
+    m_stats.heapCount++;
+    m_stats.heapBytes += heapDesc.SizeInBytes;
+    m_stats.heapsCreated++;
+
+    AllocateFrom(*created, size, alignment, offset);
+    heap = created.get();
+    m_heaps.push_back(std::move(created));
+    return true;
+}
+
+HRESULT ResourceArena::CreateResource(const void* owner, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                                      D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue,
+                                      ComPtr<ID3D12Resource>& resource) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return E_FAIL;
+    }
+    if (heapType != D3D12_HEAP_TYPE_DEFAULT && desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER) {
+        m_lastError = "Upload and readback heaps hold buffers only";
+        return E_INVALIDARG;
+    }
+
+    // Small textures (not render targets) may take 4 KB alignment instead of 64 KB
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    const D3D12_RESOURCE_FLAGS renderTarget =
+        D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && !(desc.Flags & renderTarget) &&
+        desc.SampleDesc.Count <= 1 && desc.Alignment == 0) {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT) {
+            placedDesc.Alignment = 0;
+        }
+    }
+    if (placedDesc.Alignment == 0) {
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+    if (info.SizeInBytes == UINT64_MAX || info.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) {
+        m_lastError = "Resource cannot be placed in the arena";
+        return E_INVALIDARG;
+    }
+
+    Heap* heap = nullptr;
+    uint64_t offset = 0;
+    if (!Allocate(heapType, heapType == D3D12_HEAP_TYPE_DEFAULT ? CategoryOf(desc) : HeapCategory::Buffers,
+                  info.SizeInBytes, info.Alignment, heap, offset)) {
+        return E_OUTOFMEMORY;
+    }
+
+    HRESULT hr = m_device->CreatePlacedResource(heap->heap.Get(), offset, &placedDesc, initialState,
+                                                clearValue, IID_PPV_ARGS(resource.ReleaseAndGetAddressOf()));
+    if (FAILED(hr)) {
+        Free(*heap, { offset, info.SizeInBytes });
+        m_lastError = "Failed to create placed resource";
+        return hr;
+    }
+
+    m_allocations.push_back({ owner, heap, { offset, info.SizeInBytes }, NO_GROUP, 1, info.SizeInBytes });
+    m_stats.resourceCount++;
+    m_stats.usedBytes += info.SizeInBytes;
+    m_stats.peakUsedBytes = (std::max)(m_stats.peakUsedBytes, m_stats.usedBytes);
+    return S_OK;
+}
+
+bool ResourceArena::ReserveAliasGroup(const void* owner, uint32_t group, D3D12_HEAP_TYPE heapType,
+                                      const D3D12_RESOURCE_DESC* descs, uint32_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_initialized || !descs || count == 0 || group == NO_GROUP) {
+        m_lastError = "Invalid alias group";
+        return false;
+    }
+
+    const HeapCategory category = heapType == D3D12_HEAP_TYPE_DEFAULT ? CategoryOf(descs[0]) : HeapCategory::Buffers;
+    D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, count, descs);
+    for (uint32_t i = 1; i < count; i++) {
+        if (heapType == D3D12_HEAP_TYPE_DEFAULT && CategoryOf(descs[i]) != category) {
+            info.SizeInBytes = UINT64_MAX;
+        }
+    }
+    if (info.SizeInBytes == UINT64_MAX || info.Alignment > D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT) {
+        m_lastError = "Alias group resources cannot share a heap";
+        return false;
+    }
+
+    // GetResourceAllocationInfo() sums the descs; the group needs the largest
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        size = (std::max)(size, m_device->GetResourceAllocationInfo(0, 1, &descs[i]).SizeInBytes);
+    }
+
+    Heap* heap = nullptr;
+    uint64_t offset = 0;
+    if (!Allocate(heapType, category, size, info.Alignment, heap, offset)) {
+        return false;
+    }
+
+    m_allocations.push_back({ owner, heap, { offset, size }, group, 0, 0 });
+    m_stats.usedBytes += size;
+    m_stats.peakUsedBytes = (std::max)(m_stats.peakUsedBytes, m_stats.usedBytes);
+    return true;
+}
+
+HRESULT ResourceArena::CreateAliasedResource(const void* owner, uint32_t group, const D3D12_RESOURCE_DESC& desc,
+                                             D3D12_RESOURCE_STATES initialState,
+                                             const D3D12_CLEAR_VALUE* clearValue,
+                                             ComPtr<ID3D12Resource>& resource) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto allocation = std::find_if(m_allocations.begin(), m_allocations.end(), [&](const Allocation& a) {
+        return a.owner == owner && a.group == group;
+    });
+    if (allocation == m_allocations.end() || group == NO_GROUP) {
+        m_lastError = "Alias group not reserved";
+        return E_INVALIDARG;
+    }
+
+    const D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &desc);
+    if (info.SizeInBytes > allocation->range.size ||
+        (allocation->range.offset & (info.Alignment - 1)) != 0) {
+        m_lastError = "Resource does not fit its alias group";
+        return E_INVALIDARG;
+    }
+
+    HRESULT hr = m_device->CreatePlacedResource(allocation->heap->heap.Get(), allocation->range.offset, &desc,
+                                                initialState, clearValue,
+                                                IID_PPV_ARGS(resource.ReleaseAndGetAddressOf()));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create aliased resource";
+        return hr;
+    }
+
+    allocation->resources++;
+    allocation->memberBytes += info.SizeInBytes;
+    m_stats.resourceCount++;
+    return S_OK;
+}
+
+D3D12_RESOURCE_BARRIER ResourceArena::GetAliasingBarrier(ID3D12Resource* before, ID3D12Resource* after) {
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+    barrier.Aliasing.pResourceBefore = before;
+    barrier.Aliasing.pResourceAfter = after;
+    return barrier;
+}
+
+void ResourceArena::Release(const void* owner) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto first = std::stable_partition(m_allocations.begin(), m_allocations.end(),
+                                       [owner](const Allocation& a) { return a.owner != owner; });
+    for (auto it = first; it != m_allocations.end(); ++it) {
+        Free(*it->heap, it->range);
+        m_stats.usedBytes -= it->range.size;
+        m_stats.resourceCount -= it->resources;
+    }
+    m_allocations.erase(first, m_allocations.end());
+}
+
+void ResourceArena::Trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto unused = std::remove_if(m_heaps.begin(), m_heaps.end(),
+                                 [](const std::unique_ptr<Heap>& heap) { return heap->allocations == 0; });
+    for (auto it = unused; it != m_heaps.end(); ++it) {
+        m_stats.heapCount--;
+        m_stats.heapBytes -= (*it)->size;
+    }
+    m_heaps.erase(unused, m_heaps.end());
+}
+
+ResourceArenaStats ResourceArena::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ResourceArenaStats stats = m_stats;
+    stats.aliasedBytes = 0;
+    for (const Allocation& allocation : m_allocations) {
+        if (allocation.memberBytes > allocation.range.size) {
+            stats.aliasedBytes += allocation.memberBytes - allocation.range.size;
+        }
+    }
+    return stats;
+}
+
+HRESULT CreateArenaResource(ResourceArena* arena, const void* owner, ID3D12Device* device,
+                            D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                            D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue,
+                            ComPtr<ID3D12Resource>& resource) {
+    if (arena && arena->IsInitialized()) {
+        return arena->CreateResource(owner, heapType, desc, initialState, clearValue, resource);
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = heapType;
+    return device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, initialState,
+                                           clearValue, IID_PPV_ARGS(resource.ReleaseAndGetAddressOf()));
+}
+
+} // namespace osfg
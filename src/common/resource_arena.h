@@ -0,0 +1,165 @@
+// OSFG - Open Source Frame Generation
+// Placed-Resource Heap Arena
+//
+// Sub-allocates placed resources out of a few large ID3D12Heaps per device
+// instead of one committed allocation per texture. Each resource belongs to
+// an owner (the module that created it); Release(owner) returns all of its
+// ranges at once, so a module re-laying out its textures for a new size
+// just re-places them in memory the arena already holds: no heap creation,
+// no paging of fresh allocations, and the freed space is reused by the
+// next owner that needs it. Alias groups let resources whose GPU lifetimes
+// never overlap share one range.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Arena statistics
+struct ResourceArenaStats {
+    uint32_t heapCount = 0;
+    uint64_t heapBytes = 0;         // Reserved in heaps
+    uint64_t usedBytes = 0;         // Placed (an alias group counts once)
+    uint64_t peakUsedBytes = 0;
+    uint64_t aliasedBytes = 0;      // Saved by alias groups (their members' sizes beyond the group's)
+    uint32_t resourceCount = 0;     // Placed and not yet released
+    uint64_t heapsCreated = 0;      // CreateHeap calls since Initialize()
+};
+
+class ResourceArena {
+public:
+    // Heaps are created at this size; resources over half of it get a heap of their own
+    static const uint64_t DEFAULT_HEAP_SIZE = 64ull * 1024 * 1024;
+
+    ResourceArena() = default;
+    ~ResourceArena();
+
+    // Non-copyable
+    ResourceArena(const ResourceArena&) = delete;
+    ResourceArena& operator=(const ResourceArena&) = delete;
+
+    bool Initialize(ID3D12Device* device, uint64_t heapSize = DEFAULT_HEAP_SIZE);
+
+    // Release the heaps. Resources still placed keep their heap alive
+    // until they are released themselves.
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Create a placed resource for `owner` in a DEFAULT, UPLOAD or READBACK
+    // heap (UPLOAD and READBACK: buffers only). Multisampled textures and
+    // shared resources need their own committed allocation. Unlike committed
+    // resources, placed ones start with undefined contents.
+    HRESULT CreateResource(const void* owner, D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                           D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue,
+                           ComPtr<ID3D12Resource>& resource);
+
+    // Reserve one range for alias group `group` of `owner`, sized for the
+    // largest of `descs` (which must all fit the same heap kind). Resources
+    // created into the group with CreateAliasedResource() all start at it.
+    // Only one of them may hold data at a time: record GetAliasingBarrier()
+    // before the GPU switches from one to another, and fully overwrite the
+    // new one before reading it.
+    bool ReserveAliasGroup(const void* owner, uint32_t group, D3D12_HEAP_TYPE heapType,
+                           const D3D12_RESOURCE_DESC* descs, uint32_t count);
+    HRESULT CreateAliasedResource(const void* owner, uint32_t group, const D3D12_RESOURCE_DESC& desc,
+                                  D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue,
+                                  ComPtr<ID3D12Resource>& resource);
+
+    static D3D12_RESOURCE_BARRIER GetAliasingBarrier(ID3D12Resource* before, ID3D12Resource* after);
+
+    // Return every range `owner` placed, alias groups included. Its
+    // resources must already be released and no longer in use on the GPU.
+    // The heaps stay for the next layout.
+    void Release(const void* owner);
+
+    // Free heaps that hold no resource
+    void Trim();
+
+    // Any thread
+    ResourceArenaStats GetStats() const;
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // Resource heap tier 1 keeps buffers, RT/DS textures and other textures
+    // in separate heaps; tier 2 mixes them (category 0 only)
+    enum class HeapCategory : uint32_t {
+        All = 0,
+        Buffers,
+        Textures,
+        RenderTargets,
+    };
+
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Heap {
+        ComPtr<ID3D12Heap> heap;
+        D3D12_HEAP_TYPE type = D3D12_HEAP_TYPE_DEFAULT;
+        HeapCategory category = HeapCategory::All;
+        uint64_t size = 0;
+        std::vector<Range> freeRanges;      // Sorted by offset, coalesced
+        uint32_t allocations = 0;
+    };
+
+    struct Allocation {
+        const void* owner;
+        Heap* heap;
+        Range range;
+        uint32_t group;         // Alias group, or NO_GROUP
+        uint32_t resources;     // Placed in the range
+        uint64_t memberBytes;   // Alias group: sizes of the resources placed in it
+    };
+
+    static const uint32_t NO_GROUP = 0xFFFFFFFFu;
+
+    HeapCategory CategoryOf(const D3D12_RESOURCE_DESC& desc) const;
+    bool Allocate(D3D12_HEAP_TYPE heapType, HeapCategory category, uint64_t size, uint64_t alignment,
+                  Heap*& heap, uint64_t& offset);
+    static bool AllocateFrom(Heap& heap, uint64_t size, uint64_t alignment, uint64_t& offset);
+    static void Free(Heap& heap, Range range);
+
+    ComPtr<ID3D12Device> m_device;
+    uint64_t m_heapSize = DEFAULT_HEAP_SIZE;
+    bool m_mixedHeaps = false;      // Resource heap tier 2
+
+    // Guards everything below; creation is rare, so one lock is plenty
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Heap>> m_heaps;
+    std::vector<Allocation> m_allocations;
+    ResourceArenaStats m_stats;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+// Placed in `arena` when there is one, committed on `device` otherwise
+HRESULT CreateArenaResource(ResourceArena* arena, const void* owner, ID3D12Device* device,
+                            D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc,
+                            D3D12_RESOURCE_STATES initialState, const D3D12_CLEAR_VALUE* clearValue,
+                            ComPtr<ID3D12Resource>& resource);
+
+} // namespace osfg
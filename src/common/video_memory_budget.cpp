@@ -0,0 +1,84 @@
+// OSFG - Open Source Frame Generation
+// Video Memory Budget Implementation
+
+#include "video_memory_budget.h"
+
+#include <dxgi1_6.h>
+
+#pragma comment(lib, "dxgi.lib")
+
+namespace osfg {
+
+VideoMemoryBudget::~VideoMemoryBudget() {
+    Shutdown();
+}
+
+bool VideoMemoryBudget::Initialize(ID3D12Device* device) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!device) {
+        m_lastError = "Device is null";
+        return false;
+    }
+
+    ComPtr<IDXGIFactory4> factory;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) ||
+        FAILED(factory->EnumAdapterByLuid(device->GetAdapterLuid(), IID_PPV_ARGS(&m_adapter)))) {
+        m_lastError = "Failed to open the device's adapter (IDXGIAdapter3)";
+        return false;
+    }
+
+    // Not fatal: without the event the budget is only seen at regular polls
+    m_changeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_registered = m_changeEvent &&
+                   SUCCEEDED(m_adapter->RegisterVideoMemoryBudgetChangeNotificationEvent(m_changeEvent,
+                                                                                         &m_changeCookie));
+
+    m_initialized = true;
+    return true;
+}
+
+void VideoMemoryBudget::Shutdown() {
+    if (m_registered) {
+        m_adapter->UnregisterVideoMemoryBudgetChangeNotification(m_changeCookie);
+        m_registered = false;
+    }
+    if (m_changeEvent) {
+        CloseHandle(m_changeEvent);
+        m_changeEvent = nullptr;
+    }
+    m_changeCookie = 0;
+    m_adapter.Reset();
+    m_initialized = false;
+}
+
+bool VideoMemoryBudget::Query(VideoMemoryInfo& info) {
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    DXGI_QUERY_VIDEO_MEMORY_INFO local = {};
+    if (FAILED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &local))) {
+        m_lastError = "QueryVideoMemoryInfo failed";
+        return false;
+    }
+
+    // UMA adapters only have the non-local segment group
+    DXGI_QUERY_VIDEO_MEMORY_INFO nonLocal = {};
+    m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonLocal);
+
+    info.budgetBytes = local.Budget;
+    info.usageBytes = local.CurrentUsage;
+    info.reservationBytes = local.CurrentReservation;
+    info.nonLocalUsageBytes = nonLocal.CurrentUsage;
+    return true;
+}
+
+bool VideoMemoryBudget::BudgetChanged() {
+    return m_changeEvent && WaitForSingleObject(m_changeEvent, 0) == WAIT_OBJECT_0;
+}
+
+} // namespace osfg
@@ -0,0 +1,78 @@
+// OSFG - Open Source Frame Generation
+// Video Memory Budget
+//
+// Tracks the process's local video memory usage against the budget the OS
+// grants it on one adapter (IDXGIAdapter3::QueryVideoMemoryInfo). Past the
+// budget the OS starts demoting and paging our resources, which on a 2-4 GB
+// secondary card shows up as multi-frame stalls long before any allocation
+// fails. The budget moves with other processes' demand; the adapter's change
+// notification event tells when to query again between regular polls.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// One query of the local (dedicated) segment
+struct VideoMemoryInfo {
+    uint64_t budgetBytes = 0;       // What the OS currently lets this process use
+    uint64_t usageBytes = 0;        // What this process uses
+    uint64_t reservationBytes = 0;  // Reserved with SetVideoMemoryReservation()
+    uint64_t nonLocalUsageBytes = 0;    // Shared (system memory) segment usage
+};
+
+class VideoMemoryBudget {
+public:
+    VideoMemoryBudget() = default;
+    ~VideoMemoryBudget();
+
+    // Non-copyable
+    VideoMemoryBudget(const VideoMemoryBudget&) = delete;
+    VideoMemoryBudget& operator=(const VideoMemoryBudget&) = delete;
+
+    // Open the device's adapter and register for budget change
+    // notifications. Fails on adapters without IDXGIAdapter3.
+    bool Initialize(ID3D12Device* device);
+
+    // Unregister the notification
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Query the current figures
+    bool Query(VideoMemoryInfo& info);
+
+    // True (once) if the OS changed the budget since the last call
+    bool BudgetChanged();
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    ComPtr<IDXGIAdapter3> m_adapter;
+    HANDLE m_changeEvent = nullptr;
+    DWORD m_changeCookie = 0;
+    bool m_registered = false;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
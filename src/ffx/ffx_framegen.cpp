@@ -10,6 +10,32 @@
 #define FFX_API_CREATE_CONTEXT_DESC_TYPE_FRAMEGENERATIONSWAPCHAIN_WRAP_DX12 0x30001u
 #define FFX_API_DISPATCH_DESC_TYPE_FRAMEGENERATIONSWAPCHAIN_WAIT_FOR_PRESENTS_DX12 0x30007u
 
+// Frame generation and DX12 backend descriptor type IDs
+// These match ffx_framegeneration.h and ffx_api_dx12.h
+#define FFX_API_CREATE_CONTEXT_DESC_TYPE_BACKEND_DX12 0x00002u
+#define FFX_API_CREATE_CONTEXT_DESC_TYPE_FRAMEGENERATION 0x20001u
+#define FFX_API_CONFIGURE_DESC_TYPE_FRAMEGENERATION 0x20002u
+#define FFX_API_DISPATCH_DESC_TYPE_FRAMEGENERATION_PREPARE 0x20004u
+
+// FfxApiCreateContextFramegenerationFlags
+#define FFX_FRAMEGENERATION_ENABLE_ASYNC_WORKLOAD_SUPPORT (1u << 0)
+#define FFX_FRAMEGENERATION_ENABLE_DEPTH_INVERTED (1u << 3)
+#define FFX_FRAMEGENERATION_ENABLE_HIGH_DYNAMIC_RANGE (1u << 5)
+
+// FfxApiSurfaceFormat, FfxApiResourceType and FfxApiResourceState values
+// (ffx_api_types.h) for the resources OSFG hands over
+#define FFX_API_SURFACE_FORMAT_UNKNOWN 0u
+#define FFX_API_SURFACE_FORMAT_R16G16B16A16_FLOAT 4u
+#define FFX_API_SURFACE_FORMAT_R8G8B8A8_UNORM 10u
+#define FFX_API_SURFACE_FORMAT_B8G8R8A8_UNORM 14u
+#define FFX_API_SURFACE_FORMAT_R10G10B10A2_UNORM 17u
+#define FFX_API_SURFACE_FORMAT_R16G16_FLOAT 18u
+#define FFX_API_SURFACE_FORMAT_R32_FLOAT 28u
+#define FFX_API_RESOURCE_TYPE_TEXTURE2D 2u
+#define FFX_API_RESOURCE_STATE_COMMON (1u << 0)
+#define FFX_API_RESOURCE_STATE_COMPUTE_READ (1u << 2)
+#define FFX_API_RESOURCE_STATE_PIXEL_READ (1u << 3)
+
 namespace {
 
 // Swap chain creation descriptor for HWND
@@ -38,6 +64,146 @@ struct FFXWaitForPresentsDesc {
     OSFG::FFXApiHeader header;
 };
 
+// Layouts must match FfxApiDimensions2D, FfxApiFloatCoords2D, FfxApiRect2D,
+// FfxApiResourceDescription and FfxApiResource
+struct FFXDimensions2D {
+    uint32_t width;
+    uint32_t height;
+};
+
+struct FFXFloatCoords2D {
+    float x;
+    float y;
+};
+
+struct FFXRect2D {
+    int32_t left;
+    int32_t top;
+    int32_t width;
+    int32_t height;
+};
+
+struct FFXResourceDescription {
+    uint32_t type;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t mipCount;
+    uint32_t flags;
+    uint32_t usage;
+};
+
+struct FFXResource {
+    void* resource;
+    FFXResourceDescription description;
+    uint32_t state;
+};
+
+// DX12 backend descriptor, chained to the frame generation context
+// Layout must match ffxCreateBackendDX12Desc
+struct FFXBackendDX12Desc {
+    OSFG::FFXApiHeader header;
+    ID3D12Device* device;
+};
+
+// Frame generation context descriptor
+// Layout must match ffxCreateContextDescFrameGeneration
+struct FFXFrameGenerationCreateDesc {
+    OSFG::FFXApiHeader header;
+    uint32_t flags;
+    FFXDimensions2D displaySize;
+    FFXDimensions2D maxRenderSize;
+    uint32_t backBufferFormat;
+};
+
+// Called by the swap chain to generate a frame (FfxApiFrameGenerationDispatchFunc)
+using FFXFrameGenerationDispatchFunc = OSFG::ffxReturnCode_t(*)(OSFG::FFXApiHeader* params, void* userContext);
+
+// Frame generation configuration
+// Layout must match ffxConfigureDescFrameGeneration
+struct FFXFrameGenerationConfigureDesc {
+    OSFG::FFXApiHeader header;
+    void* swapChain;
+    void* presentCallback;
+    void* presentCallbackUserContext;
+    FFXFrameGenerationDispatchFunc frameGenerationCallback;
+    void* frameGenerationCallbackUserContext;
+    bool frameGenerationEnabled;
+    bool allowAsyncWorkloads;
+    FFXResource HUDLessColor;
+    uint32_t flags;
+    bool onlyPresentGenerated;
+    FFXRect2D generationRect;
+    uint64_t frameID;
+};
+
+// Prepare pass dispatch descriptor
+// Layout must match ffxDispatchDescFrameGenerationPrepare
+struct FFXFrameGenerationPrepareDesc {
+    OSFG::FFXApiHeader header;
+    uint64_t frameID;
+    uint32_t flags;
+    void* commandList;
+    FFXDimensions2D renderSize;
+    FFXFloatCoords2D jitterOffset;
+    FFXFloatCoords2D motionVectorScale;
+    float frameTimeDelta;
+    bool unusedReset;
+    float cameraNear;
+    float cameraFar;
+    float cameraFovAngleVertical;
+    float viewSpaceToMetersFactor;
+    FFXResource depth;
+    FFXResource motionVectors;
+};
+
+uint32_t ToSurfaceFormat(DXGI_FORMAT format) {
+    switch (format) {
+    case DXGI_FORMAT_R16G16B16A16_FLOAT: return FFX_API_SURFACE_FORMAT_R16G16B16A16_FLOAT;
+    case DXGI_FORMAT_R8G8B8A8_UNORM:     return FFX_API_SURFACE_FORMAT_R8G8B8A8_UNORM;
+    case DXGI_FORMAT_B8G8R8A8_UNORM:     return FFX_API_SURFACE_FORMAT_B8G8R8A8_UNORM;
+    case DXGI_FORMAT_R10G10B10A2_UNORM:  return FFX_API_SURFACE_FORMAT_R10G10B10A2_UNORM;
+    case DXGI_FORMAT_R16G16_FLOAT:       return FFX_API_SURFACE_FORMAT_R16G16_FLOAT;
+    case DXGI_FORMAT_R32_FLOAT:          return FFX_API_SURFACE_FORMAT_R32_FLOAT;
+    default:                             return FFX_API_SURFACE_FORMAT_UNKNOWN;
+    }
+}
+
+// Read-only 2D texture in `state`; FFX transitions it and restores the state
+FFXResource ToFfxResource(ID3D12Resource* resource, D3D12_RESOURCE_STATES state) {
+    FFXResource ffxResource = {};
+    if (!resource) {
+        return ffxResource;
+    }
+
+    const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+    ffxResource.resource = resource;
+    ffxResource.description.type = FFX_API_RESOURCE_TYPE_TEXTURE2D;
+    ffxResource.description.format = ToSurfaceFormat(desc.Format);
+    ffxResource.description.width = static_cast<uint32_t>(desc.Width);
+    ffxResource.description.height = desc.Height;
+    ffxResource.description.depth = desc.DepthOrArraySize;
+    ffxResource.description.mipCount = desc.MipLevels;
+
+    if (state == D3D12_RESOURCE_STATE_COMMON) {
+        ffxResource.state = FFX_API_RESOURCE_STATE_COMMON;
+    } else {
+        if (state & D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE) {
+            ffxResource.state |= FFX_API_RESOURCE_STATE_COMPUTE_READ;
+        }
+        if (state & D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE) {
+            ffxResource.state |= FFX_API_RESOURCE_STATE_PIXEL_READ;
+        }
+    }
+    return ffxResource;
+}
+
+// Default frame generation: dispatch on the frame generation context
+OSFG::ffxReturnCode_t DispatchFrameGeneration(OSFG::FFXApiHeader* params, void* userContext) {
+    return OSFG::FFXLoader::Instance().Dispatch(static_cast<OSFG::ffxContext*>(userContext), params);
+}
+
 } // anonymous namespace
 
 namespace OSFG {
@@ -75,11 +241,25 @@ bool FFXFrameGeneration::Initialize(
     m_dxgiFactory = dxgiFactory;
     m_config = config;
 
-    // Create FFX swap chain
+    // Create FFX swap chain, then the frame generation context presenting through it
     if (!CreateSwapChainContext(hwnd, config)) {
         return false;
     }
 
+    // HDR10 back buffers carry BT.2020 PQ
+    bool colorSpaceSet = true;
+    if (config.enableHDR && config.backBufferFormat == DXGI_FORMAT_R10G10B10A2_UNORM &&
+        FAILED(m_swapChain->SetColorSpace1(DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020))) {
+        m_lastError = "Failed to set the HDR10 colour space";
+        colorSpaceSet = false;
+    }
+    if (!colorSpaceSet || !CreateFrameGenerationContext()) {
+        loader.DestroyContext(&m_ffxContext, nullptr);
+        m_ffxContext = nullptr;
+        m_swapChain.Reset();
+        return false;
+    }
+
     m_ownsSwapChain = true;
     m_initialized = true;
     QueryPerformanceCounter(&m_lastPresentTime);
@@ -90,7 +270,8 @@ bool FFXFrameGeneration::Initialize(
 bool FFXFrameGeneration::InitializeWithSwapChain(
     ID3D12Device* device,
     ID3D12CommandQueue* commandQueue,
-    IDXGISwapChain4* existingSwapChain
+    IDXGISwapChain4* existingSwapChain,
+    const FFXFrameGenConfig& config
 ) {
     if (m_initialized) {
         m_lastError = "Already initialized";
@@ -104,14 +285,33 @@ bool FFXFrameGeneration::InitializeWithSwapChain(
         return false;
     }
 
+    if (!existingSwapChain) {
+        m_lastError = "Swap chain is null";
+        return false;
+    }
+
     // Store references
     m_device = device;
     m_commandQueue = commandQueue;
+    m_config = config;
+
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    existingSwapChain->GetDesc1(&swapChainDesc);
+    m_config.displayWidth = swapChainDesc.Width;
+    m_config.displayHeight = swapChainDesc.Height;
+    m_config.backBufferCount = swapChainDesc.BufferCount;
+    m_config.backBufferFormat = swapChainDesc.Format;
 
     // Wrap existing swap chain
     if (!WrapExistingSwapChain(existingSwapChain)) {
         return false;
     }
+    if (!CreateFrameGenerationContext()) {
+        loader.DestroyContext(&m_ffxContext, nullptr);
+        m_ffxContext = nullptr;
+        m_swapChain.Reset();
+        return false;
+    }
 
     m_ownsSwapChain = false;
     m_initialized = true;
@@ -203,6 +403,106 @@ bool FFXFrameGeneration::WrapExistingSwapChain(IDXGISwapChain4* swapChain) {
     return true;
 }
 
+bool FFXFrameGeneration::CreateFrameGenerationContext() {
+    FFXLoader& loader = FFXLoader::Instance();
+
+    const uint32_t renderWidth = m_config.renderWidth ? m_config.renderWidth : m_config.displayWidth;
+    const uint32_t renderHeight = m_config.renderHeight ? m_config.renderHeight : m_config.displayHeight;
+
+    FFXBackendDX12Desc backendDesc = {};
+    backendDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_BACKEND_DX12;
+    backendDesc.header.pNext = nullptr;
+    backendDesc.device = m_device.Get();
+
+    FFXFrameGenerationCreateDesc createDesc = {};
+    createDesc.header.type = FFX_API_CREATE_CONTEXT_DESC_TYPE_FRAMEGENERATION;
+    createDesc.header.pNext = &backendDesc.header;
+    createDesc.flags = FFX_FRAMEGENERATION_ENABLE_DEPTH_INVERTED;
+    if (m_config.enableAsyncCompute) {
+        createDesc.flags |= FFX_FRAMEGENERATION_ENABLE_ASYNC_WORKLOAD_SUPPORT;
+    }
+    if (m_config.enableHDR) {
+        createDesc.flags |= FFX_FRAMEGENERATION_ENABLE_HIGH_DYNAMIC_RANGE;
+    }
+    createDesc.displaySize = { m_config.displayWidth, m_config.displayHeight };
+    createDesc.maxRenderSize = { renderWidth, renderHeight };
+    createDesc.backBufferFormat = ToSurfaceFormat(m_config.backBufferFormat);
+
+    ffxReturnCode_t result = loader.CreateContext(&m_frameGenContext, &createDesc.header, nullptr);
+    if (!FFXLoader::Succeeded(result)) {
+        char errorMsg[256];
+        sprintf_s(errorMsg, "ffxCreateContext (frame generation) failed with code %u", result);
+        m_lastError = errorMsg;
+        m_frameGenContext = nullptr;
+        return false;
+    }
+
+    // Committed resources are zero-initialized: depth 0 is the far plane
+    // with inverted depth
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC depthDesc = {};
+    depthDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    depthDesc.Width = renderWidth;
+    depthDesc.Height = renderHeight;
+    depthDesc.DepthOrArraySize = 1;
+    depthDesc.MipLevels = 1;
+    depthDesc.Format = DXGI_FORMAT_R32_FLOAT;
+    depthDesc.SampleDesc.Count = 1;
+    depthDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    HRESULT hr = m_device->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &depthDesc,
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+        nullptr, IID_PPV_ARGS(&m_depth));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create frame generation depth texture";
+        loader.DestroyContext(&m_frameGenContext, nullptr);
+        m_frameGenContext = nullptr;
+        return false;
+    }
+
+    // Attach to the swap chain with generation off until the first prepared frame
+    m_frameID = 0;
+    m_generating = false;
+    if (!ConfigureFrameGeneration(false, m_swapChain.Get())) {
+        loader.DestroyContext(&m_frameGenContext, nullptr);
+        m_frameGenContext = nullptr;
+        m_depth.Reset();
+        return false;
+    }
+
+    return true;
+}
+
+bool FFXFrameGeneration::ConfigureFrameGeneration(bool generate, IDXGISwapChain4* swapChain) {
+    FFXLoader& loader = FFXLoader::Instance();
+
+    FFXFrameGenerationConfigureDesc configDesc = {};
+    configDesc.header.type = FFX_API_CONFIGURE_DESC_TYPE_FRAMEGENERATION;
+    configDesc.header.pNext = nullptr;
+    configDesc.swapChain = swapChain;
+    configDesc.presentCallback = nullptr;       // Swap chain copies the back buffer itself
+    configDesc.frameGenerationCallback = swapChain ? &DispatchFrameGeneration : nullptr;
+    configDesc.frameGenerationCallbackUserContext = &m_frameGenContext;
+    configDesc.frameGenerationEnabled = generate;
+    configDesc.allowAsyncWorkloads = m_config.enableAsyncCompute;
+    configDesc.generationRect = { 0, 0, static_cast<int32_t>(m_config.displayWidth),
+                                  static_cast<int32_t>(m_config.displayHeight) };
+    configDesc.frameID = m_frameID;
+
+    ffxReturnCode_t result = loader.Configure(&m_frameGenContext, &configDesc.header);
+    if (!FFXLoader::Succeeded(result)) {
+        char errorMsg[256];
+        sprintf_s(errorMsg, "ffxConfigure (frame generation) failed with code %u", result);
+        m_lastError = errorMsg;
+        return false;
+    }
+
+    return true;
+}
+
 void FFXFrameGeneration::Shutdown() {
     if (!m_initialized) {
         return;
@@ -211,9 +511,18 @@ void FFXFrameGeneration::Shutdown() {
     // Wait for pending presents
     WaitForPendingPresents();
 
+    // Detach frame generation from the swap chain before destroying either
+    FFXLoader& loader = FFXLoader::Instance();
+    if (m_frameGenContext) {
+        if (loader.IsLoaded()) {
+            ConfigureFrameGeneration(false, nullptr);
+            loader.DestroyContext(&m_frameGenContext, nullptr);
+        }
+        m_frameGenContext = nullptr;
+    }
+
     // Destroy FFX context
     if (m_ffxContext) {
-        FFXLoader& loader = FFXLoader::Instance();
         if (loader.IsLoaded()) {
             loader.DestroyContext(&m_ffxContext, nullptr);
         }
@@ -221,6 +530,7 @@ void FFXFrameGeneration::Shutdown() {
     }
 
     // Release swap chain
+    m_depth.Reset();
     m_swapChain.Reset();
     m_commandQueue.Reset();
     m_dxgiFactory.Reset();
@@ -228,6 +538,8 @@ void FFXFrameGeneration::Shutdown() {
 
     m_initialized = false;
     m_enabled = true;
+    m_generating = false;
+    m_frameID = 0;
 }
 
 bool FFXFrameGeneration::Configure(const FFXFrameGenConfig& config) {
@@ -236,8 +548,15 @@ bool FFXFrameGeneration::Configure(const FFXFrameGenConfig& config) {
         return false;
     }
 
-    m_config = config;
-    // TODO: Apply configuration to FFX context if needed
+    // Sizes and formats belong to the context; only the per-frame options change
+    const FFXFrameGenConfig previous = m_config;
+    m_config.enableAsyncCompute = config.enableAsyncCompute;
+    m_config.vsync = config.vsync;
+
+    if (!ConfigureFrameGeneration(m_enabled && m_generating, m_swapChain.Get())) {
+        m_config = previous;
+        return false;
+    }
 
     return true;
 }
@@ -249,7 +568,78 @@ bool FFXFrameGeneration::SetEnabled(bool enabled) {
     }
 
     m_enabled = enabled;
-    // TODO: Configure FFX context to enable/disable frame generation
+
+    // Turning generation on needs the next frame's inputs (DispatchPrepare)
+    if (!enabled && m_generating) {
+        m_generating = false;
+        return ConfigureFrameGeneration(false, m_swapChain.Get());
+    }
+
+    return true;
+}
+
+bool FFXFrameGeneration::DispatchPrepare(const FFXFrameGenInputs& inputs,
+                                         ID3D12GraphicsCommandList* commandList) {
+    if (!m_initialized || !m_frameGenContext) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (!commandList) {
+        m_lastError = "Command list is null";
+        return false;
+    }
+
+    // Configure and prepare carry the same frame ID
+    m_frameID++;
+    const bool generate = m_enabled && inputs.motionVectors;
+    if (!ConfigureFrameGeneration(generate, m_swapChain.Get())) {
+        m_generating = false;
+        return false;
+    }
+    m_generating = generate;
+
+    if (!generate) {
+        return true;
+    }
+
+    // The render size is the vector texture's; FFX scales vectors into
+    // render pixels, and OSFG's already point at the previous position
+    const D3D12_RESOURCE_DESC vectorDesc = inputs.motionVectors->GetDesc();
+    const uint32_t renderWidth = static_cast<uint32_t>(vectorDesc.Width);
+    const uint32_t renderHeight = vectorDesc.Height;
+
+    FFXFrameGenerationPrepareDesc prepareDesc = {};
+    prepareDesc.header.type = FFX_API_DISPATCH_DESC_TYPE_FRAMEGENERATION_PREPARE;
+    prepareDesc.header.pNext = nullptr;
+    prepareDesc.frameID = m_frameID;
+    prepareDesc.commandList = commandList;
+    prepareDesc.renderSize = { renderWidth, renderHeight };
+    prepareDesc.jitterOffset = { 0.0f, 0.0f };
+    prepareDesc.motionVectorScale = {
+        static_cast<float>(renderWidth) / static_cast<float>(m_config.displayWidth),
+        static_cast<float>(renderHeight) / static_cast<float>(m_config.displayHeight) };
+    prepareDesc.frameTimeDelta = inputs.frameTimeDeltaMs;
+
+    // No camera: a unit frustum, only used to linearize the constant depth
+    prepareDesc.cameraNear = 1.0f;
+    prepareDesc.cameraFar = 1000.0f;
+    prepareDesc.cameraFovAngleVertical = 1.0f;
+    prepareDesc.viewSpaceToMetersFactor = 1.0f;
+    prepareDesc.depth = ToFfxResource(m_depth.Get(),
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    prepareDesc.motionVectors = ToFfxResource(inputs.motionVectors, inputs.motionVectorState);
+
+    FFXLoader& loader = FFXLoader::Instance();
+    ffxReturnCode_t result = loader.Dispatch(&m_frameGenContext, &prepareDesc.header);
+    if (!FFXLoader::Succeeded(result)) {
+        char errorMsg[256];
+        sprintf_s(errorMsg, "ffxDispatch (frame generation prepare) failed with code %u", result);
+        m_lastError = errorMsg;
+        m_generating = false;
+        ConfigureFrameGeneration(false, m_swapChain.Get());
+        return false;
+    }
 
     return true;
 }
@@ -277,6 +667,9 @@ bool FFXFrameGeneration::Present(uint32_t syncInterval, uint32_t flags) {
     // Update statistics
     UpdateStats();
     m_stats.framesPresented++;
+    if (m_generating) {
+        m_stats.framesGenerated++;
+    }
 
     return true;
 }
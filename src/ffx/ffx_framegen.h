@@ -3,6 +3,11 @@
 //
 // Wraps the FidelityFX Frame Generation API for use with OSFG.
 // This module creates and manages the FFX swap chain and frame generation context.
+//
+// Per real frame: DispatchPrepare() records the prepare pass (motion vectors,
+// depth) on the queue given at initialization, the frame is written to the
+// swap chain's current back buffer, then Present(). The swap chain's own
+// pacer presents the generated frame ahead of it.
 
 #pragma once
 
@@ -29,6 +34,8 @@ class FFXLoader;
 struct FFXFrameGenConfig {
     uint32_t displayWidth = 1920;
     uint32_t displayHeight = 1080;
+    uint32_t renderWidth = 0;           // Largest motion vector texture (0 = display size)
+    uint32_t renderHeight = 0;
     uint32_t backBufferCount = 3;
     DXGI_FORMAT backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
     bool enableHDR = false;
@@ -36,6 +43,16 @@ struct FFXFrameGenConfig {
     bool vsync = false;
 };
 
+// Per-frame inputs of the prepare pass
+struct FFXFrameGenInputs {
+    // R16G16_FLOAT vectors in display pixels, pointing from each pixel to
+    // its position in the previous frame (OSFG's dense motion field). The
+    // texture size is the render size. nullptr: no generated frame.
+    ID3D12Resource* motionVectors = nullptr;
+    D3D12_RESOURCE_STATES motionVectorState = D3D12_RESOURCE_STATE_COMMON;
+    float frameTimeDeltaMs = 16.667f;   // Time since the previous real frame
+};
+
 // Statistics from frame generation
 struct FFXFrameGenStats {
     uint64_t framesGenerated = 0;
@@ -64,11 +81,13 @@ public:
         const FFXFrameGenConfig& config
     );
 
-    // Initialize by wrapping existing swap chain
+    // Initialize by wrapping existing swap chain (display size and format
+    // are taken from it)
     bool InitializeWithSwapChain(
         ID3D12Device* device,
         ID3D12CommandQueue* commandQueue,
-        IDXGISwapChain4* existingSwapChain
+        IDXGISwapChain4* existingSwapChain,
+        const FFXFrameGenConfig& config = FFXFrameGenConfig{}
     );
 
     // Shutdown and release resources
@@ -77,13 +96,20 @@ public:
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
-    // Configure frame generation parameters
+    // Configure frame generation parameters (async compute, vsync; sizes
+    // and formats are fixed at initialization)
     bool Configure(const FFXFrameGenConfig& config);
 
-    // Enable or disable frame generation
+    // Enable or disable frame generation. Disabling applies at once,
+    // enabling with the next DispatchPrepare().
     bool SetEnabled(bool enabled);
     bool IsEnabled() const { return m_enabled; }
 
+    // Start the next frame: configure generation for it and record the
+    // prepare pass into commandList (a DIRECT list for the initialization
+    // queue, executed before the frame's Present()). Call once per real frame.
+    bool DispatchPrepare(const FFXFrameGenInputs& inputs, ID3D12GraphicsCommandList* commandList);
+
     // Get the FFX-wrapped swap chain
     IDXGISwapChain4* GetSwapChain() const { return m_swapChain.Get(); }
 
@@ -103,6 +129,8 @@ public:
 private:
     bool CreateSwapChainContext(HWND hwnd, const FFXFrameGenConfig& config);
     bool WrapExistingSwapChain(IDXGISwapChain4* swapChain);
+    bool CreateFrameGenerationContext();
+    bool ConfigureFrameGeneration(bool generate, IDXGISwapChain4* swapChain);
     void UpdateStats();
 
     // D3D12 objects
@@ -111,13 +139,21 @@ private:
     Microsoft::WRL::ComPtr<IDXGIFactory4> m_dxgiFactory;
     Microsoft::WRL::ComPtr<IDXGISwapChain4> m_swapChain;
 
-    // FFX context (opaque handle)
+    // FFX contexts (opaque handles): the swap chain proxy, and frame
+    // generation configured to present through it
     void* m_ffxContext = nullptr;
+    void* m_frameGenContext = nullptr;
+
+    // Desktop frames have no depth: zeroed R32_FLOAT at the render size,
+    // created with inverted depth, so every pixel lies on the far plane
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_depth;
 
     // State
     bool m_initialized = false;
     bool m_enabled = true;
     bool m_ownsSwapChain = false;
+    bool m_generating = false;          // The prepared frame gets a generated frame
+    uint64_t m_frameID = 0;
     FFXFrameGenConfig m_config;
     FFXFrameGenStats m_stats;
     std::string m_lastError;
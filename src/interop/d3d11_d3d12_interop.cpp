@@ -42,6 +42,15 @@ bool D3D11D3D12Interop::Initialize(ID3D12Device* d3d12Device,
         return false;
     }
 
+    m_stagingRegions.Initialize(1, m_config.width, m_config.height);
+    m_textureRegions.Initialize(2, m_config.width, m_config.height);
+
+    // Worker pool for the staged copy path
+    if (!m_copyEngine.Initialize()) {
+        m_lastError = "Failed to start copy engine: " + m_copyEngine.GetLastError();
+        return false;
+    }
+
     m_initialized = true;
     m_currentIndex = 0;
     m_frameCount = 0;
@@ -53,10 +62,12 @@ void D3D11D3D12Interop::Shutdown()
 {
     if (!m_initialized) return;
 
-    // Flush any pending work
+    // Flush any pending work, and let the last staged copy finish with the
+    // textures and upload buffer
     if (m_d3d11Context) {
         m_d3d11Context->Flush();
     }
+    WaitForCopy();
 
     // Release wrapped resources first
     if (m_d3d11On12Device) {
@@ -74,18 +85,19 @@ void D3D11D3D12Interop::Shutdown()
         m_d3d12Textures[i].Reset();
     }
 
+    m_copyEngine.Shutdown();
+
     // Release cached staging texture
     m_cachedStagingTexture.Reset();
     m_cachedStagingDevice.Reset();
 
-    // Release copy resources
+    // Release copy resources (the ring references the fence, so it goes first)
+    m_copyCommandRing.Shutdown();
     if (m_copyFenceEvent) {
         CloseHandle(m_copyFenceEvent);
         m_copyFenceEvent = nullptr;
     }
     m_copyFence.Reset();
-    m_copyCommandList.Reset();
-    m_copyCommandAllocator.Reset();
 
     // Unmap upload buffer before releasing
     if (m_uploadBuffer && m_uploadBufferPtr) {
@@ -242,26 +254,12 @@ bool D3D11D3D12Interop::CreateSharedTextures()
         return false;
     }
 
-    // Create command resources for staged copy
-    hr = m_d3d12Device->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(&m_copyCommandAllocator));
-    if (FAILED(hr)) {
-        m_lastError = "Failed to create copy command allocator";
-        return false;
-    }
-
-    hr = m_d3d12Device->CreateCommandList(
-        0,
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_copyCommandAllocator.Get(),
-        nullptr,
-        IID_PPV_ARGS(&m_copyCommandList));
-    if (FAILED(hr)) {
-        m_lastError = "Failed to create copy command list";
+    // Create command resources for staged copy: two allocators, so the next
+    // copy can be recorded while the last one executes
+    if (!m_copyCommandRing.Initialize(m_d3d12Device.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT, 2)) {
+        m_lastError = "Failed to create copy command ring: " + m_copyCommandRing.GetLastError();
         return false;
     }
-    m_copyCommandList->Close();
 
     hr = m_d3d12Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_copyFence));
     if (FAILED(hr)) {
@@ -305,13 +303,20 @@ bool D3D11D3D12Interop::CopyFromD3D11(ID3D11Texture2D* srcTexture)
     // Flush to ensure the copy is submitted
     m_d3d11Context->Flush();
 
+    // A full copy from an unknown source: only this buffer is known current
+    m_stagingRegions.Invalidate();
+    m_textureRegions.Invalidate();
+    m_textureRegions.MarkWritten(m_currentIndex);
+
     m_frameCount++;
     return true;
 }
 
 bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
                                              ID3D11DeviceContext* srcContext,
-                                             ID3D11Texture2D* srcTexture)
+                                             ID3D11Texture2D* srcTexture,
+                                             const RECT* dirtyRects,
+                                             uint32_t dirtyRectCount)
 {
     if (!m_initialized) {
         m_lastError = "Not initialized";
@@ -341,10 +346,24 @@ bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
             return false;
         }
         m_cachedStagingDevice = srcDevice;
+        m_stagingRegions.Invalidate();
     }
 
-    // Copy source to staging
-    srcContext->CopyResource(m_cachedStagingTexture.Get(), srcTexture);
+    m_stagingRegions.AddFrame(dirtyRects, dirtyRectCount);
+    m_textureRegions.AddFrame(dirtyRects, dirtyRectCount);
+    const bool fullStaging = m_stagingRegions.IsFull(0);
+
+    // Copy source to staging (whole frame, or only what changed)
+    if (fullStaging) {
+        srcContext->CopyResource(m_cachedStagingTexture.Get(), srcTexture);
+    } else {
+        for (const RECT& r : m_stagingRegions.GetRects(0)) {
+            D3D11_BOX box = { static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0,
+                              static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1 };
+            srcContext->CopySubresourceRegion(m_cachedStagingTexture.Get(), 0, box.left, box.top, 0,
+                                              srcTexture, 0, &box);
+        }
+    }
 
     // Map staging texture
     D3D11_MAPPED_SUBRESOURCE mapped;
@@ -354,6 +373,10 @@ bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
         return false;
     }
 
+    // The single upload buffer is rewritten once the previous copy has read
+    // it. Usually long done: it ran while the caller used the last frame.
+    WaitForCopy();
+
     // Copy data with proper row pitch alignment to persistently mapped upload buffer
     UINT bytesPerPixel = 4;
     UINT srcRowPitch = mapped.RowPitch;
@@ -361,15 +384,26 @@ bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
     BYTE* srcPtr = reinterpret_cast<BYTE*>(mapped.pData);
     BYTE* dstPtr = reinterpret_cast<BYTE*>(m_uploadBufferPtr);
 
-    for (UINT y = 0; y < m_config.height; y++) {
-        memcpy(dstPtr + y * m_uploadRowPitch, srcPtr + y * srcRowPitch, m_config.width * bytesPerPixel);
+    if (fullStaging) {
+        m_copyEngine.CopyRows(dstPtr, m_uploadRowPitch, srcPtr, srcRowPitch,
+                              m_config.width * bytesPerPixel, m_config.height);
+    } else {
+        for (const RECT& r : m_stagingRegions.GetRects(0)) {
+            m_copyEngine.CopyRows(dstPtr + r.top * m_uploadRowPitch + r.left * bytesPerPixel, m_uploadRowPitch,
+                                  srcPtr + r.top * srcRowPitch + r.left * bytesPerPixel, srcRowPitch,
+                                  (r.right - r.left) * bytesPerPixel, r.bottom - r.top);
+        }
     }
 
     srcContext->Unmap(m_cachedStagingTexture.Get(), 0);
+    m_stagingRegions.MarkWritten(0);
 
     // Now copy from upload buffer to the D3D12 texture using our internal command list
-    m_copyCommandAllocator->Reset();
-    m_copyCommandList->Reset(m_copyCommandAllocator.Get(), nullptr);
+    ID3D12GraphicsCommandList* copyList = m_copyCommandRing.Begin();
+    if (!copyList) {
+        m_lastError = m_copyCommandRing.GetLastError();
+        return false;
+    }
 
     // Transition texture to copy dest state
     D3D12_RESOURCE_BARRIER barrier = {};
@@ -378,7 +412,7 @@ bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    m_copyCommandList->ResourceBarrier(1, &barrier);
+    copyList->ResourceBarrier(1, &barrier);
 
     // Set up texture copy location
     D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
@@ -396,30 +430,46 @@ bool D3D11D3D12Interop::CopyFromD3D11Staged(ID3D11Device* srcDevice,
     srcLocation.PlacedFootprint.Footprint.Depth = 1;
     srcLocation.PlacedFootprint.Footprint.RowPitch = m_uploadRowPitch;
 
-    m_copyCommandList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+    // The upload buffer now holds the whole current frame, so the texture
+    // takes whatever it has missed since it was last written
+    if (m_textureRegions.IsFull(m_currentIndex)) {
+        copyList->CopyTextureRegion(&dstLocation, 0, 0, 0, &srcLocation, nullptr);
+    } else {
+        for (const RECT& r : m_textureRegions.GetRects(m_currentIndex)) {
+            D3D12_BOX box = { static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0,
+                              static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1 };
+            copyList->CopyTextureRegion(&dstLocation, box.left, box.top, 0, &srcLocation, &box);
+        }
+    }
 
     // Transition back to shader resource state
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    m_copyCommandList->ResourceBarrier(1, &barrier);
+    copyList->ResourceBarrier(1, &barrier);
 
     // Execute the command list
-    m_copyCommandList->Close();
-    ID3D12CommandList* lists[] = { m_copyCommandList.Get() };
-    m_d3d12CommandQueue->ExecuteCommandLists(1, lists);
-
-    // Wait for completion
     m_copyFenceValue++;
-    m_d3d12CommandQueue->Signal(m_copyFence.Get(), m_copyFenceValue);
-    if (m_copyFence->GetCompletedValue() < m_copyFenceValue) {
-        m_copyFence->SetEventOnCompletion(m_copyFenceValue, m_copyFenceEvent);
-        WaitForSingleObject(m_copyFenceEvent, INFINITE);
+    if (!m_copyCommandRing.Submit(m_d3d12CommandQueue.Get(), m_copyFence.Get(), m_copyFenceValue)) {
+        m_lastError = m_copyCommandRing.GetLastError();
+        return false;
     }
 
+    // Not waited on here: work recorded on the same queue runs after it,
+    // and the next call waits before it rewrites the upload buffer
+    m_textureRegions.MarkWritten(m_currentIndex);
+
     m_frameCount++;
     return true;
 }
 
+void D3D11D3D12Interop::WaitForCopy()
+{
+    if (m_copyFence && m_copyFenceEvent && m_copyFence->GetCompletedValue() < m_copyFenceValue) {
+        m_copyFence->SetEventOnCompletion(m_copyFenceValue, m_copyFenceEvent);
+        WaitForSingleObject(m_copyFenceEvent, INFINITE);
+    }
+}
+
 void D3D11D3D12Interop::SwapBuffers()
 {
     m_currentIndex = 1 - m_currentIndex;
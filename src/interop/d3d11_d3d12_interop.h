@@ -19,6 +19,10 @@
 #include <cstdint>
 #include <string>
 
+#include "common/command_ring.h"
+#include "common/dirty_regions.h"
+#include "common/parallel_copy.h"
+
 namespace OSFG {
 
 // Configuration for interop
@@ -56,9 +60,19 @@ public:
 
     // Copy from an external D3D11 device's texture via CPU staging
     // Use this when the source texture is from a different D3D11 device
+    // dirtyRects: regions changed since the previous call (e.g. from
+    //             CaptureSource::GetChangedRects), or nullptr for the whole frame.
+    //             Only those regions are staged and uploaded.
+    // Returns once the copy is queued on the interop's command queue: read
+    // the texture from that queue, or wait for it with WaitForCopy().
     bool CopyFromD3D11Staged(ID3D11Device* srcDevice,
                               ID3D11DeviceContext* srcContext,
-                              ID3D11Texture2D* srcTexture);
+                              ID3D11Texture2D* srcTexture,
+                              const RECT* dirtyRects = nullptr,
+                              uint32_t dirtyRectCount = 0);
+
+    // Block until the last staged copy has completed on the GPU
+    void WaitForCopy();
 
     // Swap buffers (current becomes previous)
     void SwapBuffers();
@@ -98,8 +112,13 @@ private:
     Microsoft::WRL::ComPtr<ID3D12Resource> m_uploadBuffer;
     void* m_uploadBufferPtr = nullptr;  // Persistently mapped pointer
     UINT m_uploadRowPitch = 0;
-    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_copyCommandAllocator;
-    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_copyCommandList;
+    osfg::ParallelCopyEngine m_copyEngine;  // Staging -> upload row copy
+
+    // Damage still missing from the staging texture + upload buffer (1 slot)
+    // and from each shared D3D12 texture (2 slots)
+    osfg::DirtyRegionTracker m_stagingRegions;
+    osfg::DirtyRegionTracker m_textureRegions;
+    osfg::CommandAllocatorRing m_copyCommandRing;  // Next copy recorded while the last executes
     Microsoft::WRL::ComPtr<ID3D12Fence> m_copyFence;
     HANDLE m_copyFenceEvent = nullptr;
     UINT64 m_copyFenceValue = 0;
@@ -3,7 +3,10 @@
 // MIT License - Part of Open Source Frame Generation project
 
 #include "frame_interpolation.h"
+#include "common/precompiled_shader.h"
 #include <chrono>
+#include <climits>
+#include <cstring>
 
 namespace OSFG {
 
@@ -20,41 +23,75 @@ cbuffer Constants : register(b0)
     uint g_MVWidth;
     uint g_MVHeight;
     float g_InterpolationFactor;  // 0.0 = prev frame, 1.0 = current frame, 0.5 = middle
-    float g_MotionScale;          // Scale for motion vectors (1/16 for sub-pixel)
-    float2 g_Padding;
+    float g_MotionScale;          // Pixels per motion vector unit (1 for the dense field)
+    uint g_StaticTileFrames;      // Unchanged frames before a tile is copied (0 = off)
+    uint g_TilesX;                // 16x16 tiles per row
+    float4 g_PhaseFactors;        // Per-output t for CSMainMulti
+    uint g_PhaseCount;            // Number of outputs written by CSMainMulti
+    uint g_ResetTiles;            // CSStaticTiles: discard the stored history
+    uint2 g_Padding2;
 };
 
 // Input textures
 Texture2D<float4> g_PreviousFrame : register(t0);
 Texture2D<float4> g_CurrentFrame : register(t1);
-Texture2D<int2> g_MotionVectors : register(t2);
+#ifdef MOTION_FIELD
+Texture2D<float2> g_MotionVectors : register(t2);   // Dense field in pixels (R16G16_FLOAT)
+#else
+Texture2D<int2> g_MotionVectors : register(t2);     // One vector per block (R16G16_SINT)
+#endif
 
-// Output texture
+#ifndef RENDER_PASS
+// Output textures (CSMain writes u0 only)
 RWTexture2D<float4> g_InterpolatedFrame : register(u0);
+RWTexture2D<float4> g_InterpolatedFrame1 : register(u1);
+RWTexture2D<float4> g_InterpolatedFrame2 : register(u2);
+#endif
+
+// Per 16x16 tile of the output: hash of the current frame's texels, frames
+// it has stayed unchanged, and whether the kernels copy it this frame
+struct TileState
+{
+    uint hash;
+    uint age;
+    uint copy;
+    uint padding;
+};
+RWStructuredBuffer<TileState> g_TileState : register(u3);
 
 // Samplers
 SamplerState g_LinearSampler : register(s0);
 
-[numthreads(16, 16, 1)]
-void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
+#ifdef MOTION_FIELD
+// Motion at this pixel in UV units, filtered from the smoothed field
+float2 FetchMotionUV(float2 uv)
+{
+    float2 motion = g_MotionVectors.SampleLevel(g_LinearSampler, uv, 0) * g_MotionScale;
+    return motion / float2(g_Width, g_Height);
+}
+#else
+// Motion at this pixel in UV units, using nearest neighbor (faster than bilinear)
+float2 FetchMotionUV(float2 uv)
 {
-    // Check bounds
-    if (dispatchThreadId.x >= g_Width || dispatchThreadId.y >= g_Height)
-        return;
-
-    uint2 pixel = dispatchThreadId.xy;
-    float2 uv = (float2(pixel) + 0.5) / float2(g_Width, g_Height);
-
-    // Get motion vector at this location using nearest neighbor (faster than bilinear)
     // Map pixel to MV coordinates
     uint2 mvPixel = uint2(uv * float2(g_MVWidth, g_MVHeight));
     mvPixel = min(mvPixel, uint2(g_MVWidth - 1, g_MVHeight - 1));
 
     float2 motion = float2(g_MotionVectors[mvPixel]) * g_MotionScale;
-    float2 motionUV = motion / float2(g_Width, g_Height);
+    return motion / float2(g_Width, g_Height);
+}
+#endif
 
-    float t = g_InterpolationFactor;
+// Simple weighted blend of the two warped taps
+float4 BlendPhase(float4 colorPrev, float4 colorCurr, float t)
+{
+    float4 result = colorPrev * (1.0 - t) + colorCurr * t;
+    result.a = 1.0;
+    return result;
+}
 
+float4 InterpolatePhase(float2 uv, float2 motionUV, float t)
+{
     // Bi-directional warping
     float2 uvPrev = uv - motionUV * (1.0 - t);
     float2 uvCurr = uv + motionUV * t;
@@ -67,14 +104,212 @@ void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
     float4 colorPrev = g_PreviousFrame.SampleLevel(g_LinearSampler, uvPrev, 0);
     float4 colorCurr = g_CurrentFrame.SampleLevel(g_LinearSampler, uvCurr, 0);
 
-    // Simple weighted blend
-    float4 result = colorPrev * (1.0 - t) + colorCurr * t;
-    result.a = 1.0;
+    return BlendPhase(colorPrev, colorCurr, t);
+}
+
+// Tiles the kernels copy straight from the current frame. The tile is the
+// thread group, so the compute kernels branch uniformly per group.
+bool IsStaticTile(uint2 pixel)
+{
+    return g_StaticTileFrames > 0 && g_TileState[(pixel.y / 16) * g_TilesX + pixel.x / 16].copy != 0;
+}
+
+float4 CopyCurrent(uint2 pixel, float2 uv)
+{
+    uint sourceWidth, sourceHeight;
+    g_CurrentFrame.GetDimensions(sourceWidth, sourceHeight);
+    float4 color = (sourceWidth == g_Width && sourceHeight == g_Height)
+        ? g_CurrentFrame.Load(int3(pixel, 0))
+        : g_CurrentFrame.SampleLevel(g_LinearSampler, uv, 0);
+    color.a = 1.0;
+    return color;
+}
+
+#ifdef RENDER_PASS
+// One triangle covering the viewport; no vertex buffer
+float4 VSFullscreen(uint vertexId : SV_VertexID) : SV_Position
+{
+    float2 corner = float2((vertexId << 1) & 2, vertexId & 2);
+    return float4(corner * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+// One phase straight into the render target. SV_Position is the pixel
+// centre, so uv matches the compute kernels exactly.
+float4 PSMain(float4 position : SV_Position) : SV_Target
+{
+    float2 uv = position.xy / float2(g_Width, g_Height);
+    if (IsStaticTile(uint2(position.xy)))
+        return CopyCurrent(uint2(position.xy), uv);
+    return InterpolatePhase(uv, FetchMotionUV(uv), g_InterpolationFactor);
+}
+#else
+uint HashUint(uint v)
+{
+    // PCG output permutation
+    uint state = v * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
 
-    g_InterpolatedFrame[pixel] = result;
+groupshared uint gs_TileHash;
+groupshared uint gs_TileMoving;
+
+// One group per 16x16 output tile: hashes the current frame's texels under
+// the tile and counts the frames the hash has stayed the same. A tile is
+// copied once it has been unchanged for g_StaticTileFrames frames, its own
+// vector moves less than a pixel and no vector in its 3x3 tile neighbourhood
+// carries content across it, so objects crossing a flat background between
+// two captures still get interpolated. Neighbours moving away from the tile
+// do not count: a HUD tile stays copied while the scene moves next to it.
+[numthreads(16, 16, 1)]
+void CSStaticTiles(uint3 groupId : SV_GroupID, uint3 groupThreadId : SV_GroupThreadID,
+                   uint groupIndex : SV_GroupIndex)
+{
+    if (groupIndex == 0) {
+        gs_TileHash = 0;
+        gs_TileMoving = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 pixel = groupId.xy * 16 + groupThreadId.xy;
+    if (pixel.x < g_Width && pixel.y < g_Height) {
+        // Every source texel of this output pixel (one unless the outputs
+        // are smaller than the frames), salted with its position in the tile
+        uint sourceWidth, sourceHeight;
+        g_CurrentFrame.GetDimensions(sourceWidth, sourceHeight);
+        uint2 scale = uint2((sourceWidth + g_Width - 1) / g_Width, (sourceHeight + g_Height - 1) / g_Height);
+        uint hash = HashUint(groupIndex);
+        for (uint y = 0; y < scale.y; y++) {
+            for (uint x = 0; x < scale.x; x++) {
+                uint2 source = min(pixel * scale + uint2(x, y), uint2(sourceWidth - 1, sourceHeight - 1));
+                float4 color = g_CurrentFrame.Load(int3(source, 0));
+                hash = HashUint(hash ^ asuint(color.r));
+                hash = HashUint(hash ^ asuint(color.g));
+                hash = HashUint(hash ^ asuint(color.b));
+            }
+        }
+        InterlockedAdd(gs_TileHash, hash);
+    }
+
+    if (groupIndex < 9) {
+        uint tilesY = (g_Height + 15) / 16;
+        int2 tile = clamp(int2(groupId.xy) + int2(groupIndex % 3, groupIndex / 3) - 1,
+                          int2(0, 0), int2(g_TilesX - 1, tilesY - 1));
+        float2 uv = saturate((float2(tile * 16) + 8.0) / float2(g_Width, g_Height));
+        float2 motion = FetchMotionUV(uv) * float2(g_Width, g_Height);
+        // Content at a neighbour's centre came from centre - motion. It
+        // crossed this tile if that path heads this way past the tile edge
+        // half-way between the two centres.
+        float2 offset = float2((tile - int2(groupId.xy)) * 16);
+        bool moving = all(offset == 0.0) ? dot(motion, motion) > 1.0
+                                         : dot(motion, offset) > 0.5 * dot(offset, offset);
+        if (moving)
+            InterlockedOr(gs_TileMoving, 1);
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (groupIndex == 0) {
+        uint index = groupId.y * g_TilesX + groupId.x;
+        TileState state = g_TileState[index];
+        bool unchanged = g_ResetTiles == 0 && state.hash == gs_TileHash;
+        state.age = unchanged ? min(state.age + 1, 255u) : 0;
+        state.hash = gs_TileHash;
+        state.copy = (state.age >= g_StaticTileFrames && gs_TileMoving == 0) ? 1 : 0;
+        state.padding = 0;
+        g_TileState[index] = state;
+    }
 }
+
+[numthreads(16, 16, 1)]
+void CSMain(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    // Check bounds
+    if (dispatchThreadId.x >= g_Width || dispatchThreadId.y >= g_Height)
+        return;
+
+    uint2 pixel = dispatchThreadId.xy;
+    float2 uv = (float2(pixel) + 0.5) / float2(g_Width, g_Height);
+
+    if (IsStaticTile(pixel)) {
+        g_InterpolatedFrame[pixel] = CopyCurrent(pixel, uv);
+        return;
+    }
+
+    float2 motionUV = FetchMotionUV(uv);
+    g_InterpolatedFrame[pixel] = InterpolatePhase(uv, motionUV, g_InterpolationFactor);
+}
+
+// All phases of one base frame in a single pass: the motion vector is read
+// once per pixel. Where it moves less than 1/16 pixel every phase's warp
+// lands on the same texel position, so the two source taps are fetched once
+// and only the blend is per phase. Moving pixels warp each phase to its own
+// taps; those stay in a small neighbourhood and hit the texture cache.
+[numthreads(16, 16, 1)]
+void CSMainMulti(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    if (dispatchThreadId.x >= g_Width || dispatchThreadId.y >= g_Height)
+        return;
+
+    uint2 pixel = dispatchThreadId.xy;
+    float2 uv = (float2(pixel) + 0.5) / float2(g_Width, g_Height);
+
+    // Static tiles are the same in every phase
+    if (IsStaticTile(pixel)) {
+        float4 color = CopyCurrent(pixel, uv);
+        g_InterpolatedFrame[pixel] = color;
+        if (g_PhaseCount > 1)
+            g_InterpolatedFrame1[pixel] = color;
+        if (g_PhaseCount > 2)
+            g_InterpolatedFrame2[pixel] = color;
+        return;
+    }
+
+    float2 motionUV = FetchMotionUV(uv);
+    float2 motionPixels = motionUV * float2(g_Width, g_Height);
+
+    if (dot(motionPixels, motionPixels) < 1.0 / 256.0) {
+        float4 colorPrev = g_PreviousFrame.SampleLevel(g_LinearSampler, uv, 0);
+        float4 colorCurr = g_CurrentFrame.SampleLevel(g_LinearSampler, uv, 0);
+        g_InterpolatedFrame[pixel] = BlendPhase(colorPrev, colorCurr, g_PhaseFactors.x);
+        if (g_PhaseCount > 1)
+            g_InterpolatedFrame1[pixel] = BlendPhase(colorPrev, colorCurr, g_PhaseFactors.y);
+        if (g_PhaseCount > 2)
+            g_InterpolatedFrame2[pixel] = BlendPhase(colorPrev, colorCurr, g_PhaseFactors.z);
+        return;
+    }
+
+    g_InterpolatedFrame[pixel] = InterpolatePhase(uv, motionUV, g_PhaseFactors.x);
+    if (g_PhaseCount > 1)
+        g_InterpolatedFrame1[pixel] = InterpolatePhase(uv, motionUV, g_PhaseFactors.y);
+    if (g_PhaseCount > 2)
+        g_InterpolatedFrame2[pixel] = InterpolatePhase(uv, motionUV, g_PhaseFactors.z);
+}
+#endif
 )";
 
+} // namespace OSFG
+
+// DXIL for every variant above, compiled by the build (see osfg_precompile_shaders)
+#ifdef OSFG_PRECOMPILED_SHADERS
+#include "g_frameInterpolationShader_dxil.h"
+#endif
+
+namespace OSFG {
+
+// Build-time DXIL for a variant of g_frameInterpolationShader, or nullptr
+static const osfg::PrecompiledShader* FindPrecompiledShader(const char* entryPoint,
+                                                            const std::string& definesKey)
+{
+#ifdef OSFG_PRECOMPILED_SHADERS
+    return osfg::FindPrecompiledShader(g_frameInterpolationShaderDxil,
+                                       std::size(g_frameInterpolationShaderDxil), entryPoint, definesKey);
+#else
+    (void)entryPoint;
+    (void)definesKey;
+    return nullptr;
+#endif
+}
+
 FrameInterpolation::FrameInterpolation() = default;
 
 FrameInterpolation::~FrameInterpolation()
@@ -96,6 +331,7 @@ bool FrameInterpolation::Initialize(ID3D12Device* device, const FrameInterpolati
 
     m_device = device;
     m_config = config;
+    m_dxilSupported = osfg::SupportsShaderModel6(device);
 
     // Create resources in order
     if (!CreateRootSignature()) return false;
@@ -109,15 +345,93 @@ bool FrameInterpolation::Initialize(ID3D12Device* device, const FrameInterpolati
 
 void FrameInterpolation::Shutdown()
 {
+    if (m_constantBuffer && m_constantBufferMapped) {
+        m_constantBuffer->Unmap(0, nullptr);
+    }
+    m_constantBufferMapped = nullptr;
+    m_constantBufferSlot = 0;
+    m_unretiredSlots = 0;
+    for (SlotRetire& retire : m_slotRetire) {
+        retire = SlotRetire{};
+    }
+    for (bool& pending : m_timestampPending) {
+        pending = false;
+    }
+    m_timestampReadSlot = 0;
+    if (m_retireEvent) {
+        CloseHandle(m_retireEvent);
+        m_retireEvent = nullptr;
+    }
+
+    for (auto& key : m_descriptorSetKeys) {
+        key = DescriptorSetKey{};
+    }
+    m_nextDescriptorSet = 0;
+
+    m_fieldStaticTilesPipelineState.Reset();
+    m_staticTilesPipelineState.Reset();
+    m_fieldDrawPipelineState.Reset();
+    m_drawPipelineState.Reset();
+    m_fieldMultiPhasePipelineState.Reset();
+    m_fieldPipelineState.Reset();
+    m_multiPhasePipelineState.Reset();
     m_pipelineState.Reset();
     m_rootSignature.Reset();
     m_interpolatedFrame.Reset();
+    m_tileState.Reset();
+    m_tileStateValid = false;
+    if (m_config.resourceArena) {
+        m_config.resourceArena->Release(this);
+    }
     m_constantBuffer.Reset();
     m_srvUavHeap.Reset();
     m_device.Reset();
+    m_dxilSupported = false;
     m_initialized = false;
 }
 
+bool FrameInterpolation::Resize(uint32_t width, uint32_t height)
+{
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (width == m_config.width && height == m_config.height) {
+        return true;
+    }
+
+    // Re-created textures can reuse released addresses: forget every set
+    for (auto& key : m_descriptorSetKeys) {
+        key = DescriptorSetKey{};
+    }
+    m_nextDescriptorSet = 0;
+
+    m_interpolatedFrame.Reset();
+    m_tileState.Reset();
+    m_tileStateValid = false;
+    if (m_config.resourceArena) {
+        m_config.resourceArena->Release(this);
+    }
+    m_config.width = width;
+    m_config.height = height;
+
+    if (!CreateOutputTexture() || !CreateTileState()) {
+        m_initialized = false;
+        return false;
+    }
+    return true;
+}
+
+void FrameInterpolation::ResetMotionSource(float motionVectorScale)
+{
+    for (auto& key : m_descriptorSetKeys) {
+        key = DescriptorSetKey{};
+    }
+    m_nextDescriptorSet = 0;
+    m_config.motionVectorScale = motionVectorScale;
+}
+
 void FrameInterpolation::SetInterpolationFactor(float factor)
 {
     m_config.interpolationFactor = (factor < 0.0f) ? 0.0f : ((factor > 1.0f) ? 1.0f : factor);
@@ -128,8 +442,9 @@ bool FrameInterpolation::CreateRootSignature()
     // Root parameters:
     // [0] CBV - Constants
     // [1] Descriptor table - SRVs (previous frame, current frame, motion vectors)
-    // [2] Descriptor table - UAV (output)
-    // [3] Static sampler
+    // [2] Descriptor table - UAVs (MAX_PHASES outputs)
+    // [3] Root UAV - static-tile history (u3)
+    // Static sampler
 
     D3D12_DESCRIPTOR_RANGE srvRange = {};
     srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
@@ -140,12 +455,12 @@ bool FrameInterpolation::CreateRootSignature()
 
     D3D12_DESCRIPTOR_RANGE uavRange = {};
     uavRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    uavRange.NumDescriptors = 1;
+    uavRange.NumDescriptors = MAX_PHASES;
     uavRange.BaseShaderRegister = 0;
     uavRange.RegisterSpace = 0;
     uavRange.OffsetInDescriptorsFromTableStart = 0;
 
-    D3D12_ROOT_PARAMETER rootParams[3] = {};
+    D3D12_ROOT_PARAMETER rootParams[4] = {};
 
     // CBV
     rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
@@ -165,6 +480,12 @@ bool FrameInterpolation::CreateRootSignature()
     rootParams[2].DescriptorTable.pDescriptorRanges = &uavRange;
     rootParams[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
+    // Tile history (a buffer, so it needs no descriptor)
+    rootParams[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    rootParams[3].Descriptor.ShaderRegister = MAX_PHASES;
+    rootParams[3].Descriptor.RegisterSpace = 0;
+    rootParams[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
     // Static sampler
     D3D12_STATIC_SAMPLER_DESC sampler = {};
     sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
@@ -182,7 +503,7 @@ bool FrameInterpolation::CreateRootSignature()
     sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
     D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
-    rootSigDesc.NumParameters = 3;
+    rootSigDesc.NumParameters = 4;
     rootSigDesc.pParameters = rootParams;
     rootSigDesc.NumStaticSamplers = 1;
     rootSigDesc.pStaticSamplers = &sampler;
@@ -216,8 +537,47 @@ bool FrameInterpolation::CreateRootSignature()
 
 bool FrameInterpolation::CreatePipelineState()
 {
-    // Compile the compute shader at runtime
-    Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob;
+    // Single-phase kernel and the all-phases-in-one-pass kernel share the
+    // shader source and root signature; each has a block-vector and a
+    // motion-field variant
+    const D3D_SHADER_MACRO motionField[] = { { "MOTION_FIELD", "1" }, { nullptr, nullptr } };
+    if (!CreatePipelineState("CSMain", nullptr, m_pipelineState)) return false;
+    if (!CreatePipelineState("CSMainMulti", nullptr, m_multiPhasePipelineState)) return false;
+    if (!CreatePipelineState("CSMain", motionField, m_fieldPipelineState)) return false;
+    if (!CreatePipelineState("CSMainMulti", motionField, m_fieldMultiPhasePipelineState)) return false;
+
+    // Static-tile history pass (only used with config.staticTileFrames)
+    if (m_config.staticTileFrames > 0) {
+        if (!CreatePipelineState("CSStaticTiles", nullptr, m_staticTilesPipelineState)) return false;
+        if (!CreatePipelineState("CSStaticTiles", motionField, m_fieldStaticTilesPipelineState)) return false;
+    }
+
+    // Full-screen pass for drawing straight into a back buffer
+    if (m_config.renderTargetFormat != DXGI_FORMAT_UNKNOWN) {
+        const D3D_SHADER_MACRO draw[] = { { "RENDER_PASS", "1" }, { nullptr, nullptr } };
+        const D3D_SHADER_MACRO fieldDraw[] = { { "RENDER_PASS", "1" }, { "MOTION_FIELD", "1" },
+                                               { nullptr, nullptr } };
+        if (!CreateDrawPipelineState(draw, m_drawPipelineState)) return false;
+        if (!CreateDrawPipelineState(fieldDraw, m_fieldDrawPipelineState)) return false;
+    }
+    return true;
+}
+
+bool FrameInterpolation::CompileShader(const char* entryPoint, const char* target,
+                                       const D3D_SHADER_MACRO* defines, bool allowPrecompiled,
+                                       Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob,
+                                       D3D12_SHADER_BYTECODE& bytecode)
+{
+    // Prefer the DXIL the build compiled; fall back to FXC at runtime
+    if (allowPrecompiled) {
+        if (const osfg::PrecompiledShader* precompiled =
+                FindPrecompiledShader(entryPoint, osfg::ShaderDefinesKey(defines))) {
+            bytecode.pShaderBytecode = precompiled->bytecode;
+            bytecode.BytecodeLength = precompiled->size;
+            return true;
+        }
+    }
+
     Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
 
     UINT compileFlags = 0;
@@ -231,10 +591,10 @@ bool FrameInterpolation::CreatePipelineState()
         g_frameInterpolationShader,
         strlen(g_frameInterpolationShader),
         "FrameInterpolation.hlsl",
+        defines,
         nullptr,
-        nullptr,
-        "CSMain",
-        "cs_5_0",
+        entryPoint,
+        target,
         compileFlags,
         0,
         &shaderBlob,
@@ -243,23 +603,86 @@ bool FrameInterpolation::CreatePipelineState()
 
     if (FAILED(hr)) {
         if (errorBlob) {
-            m_lastError = "Shader compilation failed: " +
+            m_lastError = std::string("Shader compilation failed (") + entryPoint + "): " +
                          std::string((char*)errorBlob->GetBufferPointer());
         } else {
-            m_lastError = "Shader compilation failed";
+            m_lastError = std::string("Shader compilation failed (") + entryPoint + ")";
         }
         return false;
     }
 
-    // Create compute pipeline state
+    bytecode.pShaderBytecode = shaderBlob->GetBufferPointer();
+    bytecode.BytecodeLength = shaderBlob->GetBufferSize();
+    return true;
+}
+
+bool FrameInterpolation::HasPrecompiledShader(const char* entryPoint, const D3D_SHADER_MACRO* defines) const
+{
+    return m_dxilSupported && FindPrecompiledShader(entryPoint, osfg::ShaderDefinesKey(defines)) != nullptr;
+}
+
+bool FrameInterpolation::CreatePipelineState(const char* entryPoint,
+                                             const D3D_SHADER_MACRO* defines,
+                                             Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob;
     D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    if (!CompileShader(entryPoint, "cs_5_0", defines, HasPrecompiledShader(entryPoint, defines),
+                       shaderBlob, psoDesc.CS)) {
+        return false;
+    }
+
+    // Create compute pipeline state
     psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.CS.pShaderBytecode = shaderBlob->GetBufferPointer();
-    psoDesc.CS.BytecodeLength = shaderBlob->GetBufferSize();
 
-    hr = m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+    const std::string name = "FrameInterpolation/" + std::string(entryPoint) + "/" +
+                             osfg::ShaderDefinesKey(defines);
+    HRESULT hr = m_config.pipelineCache
+        ? m_config.pipelineCache->CreateComputePipelineState(name, psoDesc, pipelineState)
+        : m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState));
     if (FAILED(hr)) {
-        m_lastError = "Failed to create pipeline state";
+        m_lastError = std::string("Failed to create pipeline state (") + entryPoint + ")";
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameInterpolation::CreateDrawPipelineState(const D3D_SHADER_MACRO* defines,
+                                                 Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    // DXIL and DXBC stages cannot be mixed in one PSO: use the build-time
+    // pair only when both stages were precompiled
+    const bool precompiled = HasPrecompiledShader("VSFullscreen", defines) &&
+                             HasPrecompiledShader("PSMain", defines);
+
+    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> psBlob;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    if (!CompileShader("VSFullscreen", "vs_5_0", defines, precompiled, vsBlob, psoDesc.VS)) return false;
+    if (!CompileShader("PSMain", "ps_5_0", defines, precompiled, psBlob, psoDesc.PS)) return false;
+
+    // Same root signature as the compute kernels (the UAV table is unused);
+    // no input layout, blending, depth or culling
+    psoDesc.pRootSignature = m_rootSignature.Get();
+    psoDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.RasterizerState.DepthClipEnable = TRUE;
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = m_config.renderTargetFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    const std::string name = "FrameInterpolation/Draw/" + osfg::ShaderDefinesKey(defines);
+    HRESULT hr = m_config.pipelineCache
+        ? m_config.pipelineCache->CreateGraphicsPipelineState(name, psoDesc, pipelineState)
+        : m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create draw pipeline state";
         return false;
     }
 
@@ -268,10 +691,10 @@ bool FrameInterpolation::CreatePipelineState()
 
 bool FrameInterpolation::CreateDescriptorHeaps()
 {
-    // Create SRV/UAV heap: 3 SRVs + 1 UAV = 4 descriptors
+    // Create SRV/UAV heap: DESCRIPTOR_SETS x (3 SRVs + MAX_PHASES UAVs)
     D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
     heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    heapDesc.NumDescriptors = 4;
+    heapDesc.NumDescriptors = DESCRIPTORS_PER_SET * DESCRIPTOR_SETS;
     heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 
     HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_srvUavHeap));
@@ -285,12 +708,8 @@ bool FrameInterpolation::CreateDescriptorHeaps()
     return true;
 }
 
-bool FrameInterpolation::CreateResources()
+D3D12_RESOURCE_DESC FrameInterpolation::GetOutputDesc() const
 {
-    // Create output texture (interpolated frame)
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
-
     D3D12_RESOURCE_DESC texDesc = {};
     texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
     texDesc.Width = m_config.width;
@@ -300,28 +719,78 @@ bool FrameInterpolation::CreateResources()
     texDesc.Format = m_config.format;
     texDesc.SampleDesc.Count = 1;
     texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    return texDesc;
+}
 
-    HRESULT hr = m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &texDesc,
-        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-        nullptr,
-        IID_PPV_ARGS(&m_interpolatedFrame)
-    );
+bool FrameInterpolation::CreateOutputTexture()
+{
+    if (!m_config.createOutput) {
+        return true;
+    }
 
+    // Create output texture (interpolated frame). It rests in
+    // config.outputState like caller-owned targets.
+    D3D12_RESOURCE_DESC texDesc = GetOutputDesc();
+
+    HRESULT hr = osfg::CreateArenaResource(m_config.resourceArena, this, m_device.Get(),
+                                           D3D12_HEAP_TYPE_DEFAULT, texDesc, m_config.outputState,
+                                           nullptr, m_interpolatedFrame);
     if (FAILED(hr)) {
         m_lastError = "Failed to create interpolated frame texture";
         return false;
     }
 
-    // Create constant buffer
+    return true;
+}
+
+bool FrameInterpolation::CreateTileState()
+{
+    m_tilesX = (m_config.width + 15) / 16;
+    m_tilesY = (m_config.height + 15) / 16;
+    if (m_config.staticTileFrames == 0) {
+        return true;
+    }
+
+    // 16 bytes per tile (hash, age, copy flag, padding), matching TileState
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = static_cast<UINT64>(m_tilesX) * m_tilesY * 16;
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    HRESULT hr = osfg::CreateArenaResource(m_config.resourceArena, this, m_device.Get(),
+                                           D3D12_HEAP_TYPE_DEFAULT, bufferDesc,
+                                           D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, m_tileState);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create static tile buffer";
+        return false;
+    }
+
+    m_tileStateValid = false;
+    return true;
+}
+
+bool FrameInterpolation::CreateResources()
+{
+    if (!CreateOutputTexture() || !CreateTileState()) {
+        return false;
+    }
+
+    // Create constant buffer ring
+    static_assert(sizeof(ConstantBufferData) <= CONSTANT_BUFFER_SLOT_SIZE,
+                  "ConstantBufferData must fit in one constant buffer slot");
+
     D3D12_HEAP_PROPERTIES uploadHeapProps = {};
     uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
 
     D3D12_RESOURCE_DESC cbDesc = {};
     cbDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    cbDesc.Width = (sizeof(ConstantBufferData) + 255) & ~255;  // 256-byte aligned
+    cbDesc.Width = CONSTANT_BUFFER_SLOT_SIZE * CONSTANT_BUFFER_SLOTS;
     cbDesc.Height = 1;
     cbDesc.DepthOrArraySize = 1;
     cbDesc.MipLevels = 1;
@@ -329,7 +798,7 @@ bool FrameInterpolation::CreateResources()
     cbDesc.SampleDesc.Count = 1;
     cbDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 
-    hr = m_device->CreateCommittedResource(
+    HRESULT hr = m_device->CreateCommittedResource(
         &uploadHeapProps,
         D3D12_HEAP_FLAG_NONE,
         &cbDesc,
@@ -343,17 +812,33 @@ bool FrameInterpolation::CreateResources()
         return false;
     }
 
-    // Create GPU timestamp query heap (2 queries: start and end)
+    // Upload heaps can stay mapped for the lifetime of the resource
+    D3D12_RANGE readRange = { 0, 0 };
+    hr = m_constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_constantBufferMapped));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to map constant buffer";
+        return false;
+    }
+
+    m_retireEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_retireEvent) {
+        m_lastError = "Failed to create constant buffer event";
+        return false;
+    }
+
+    // Create GPU timestamp query heap: a start/end pair per constant buffer
+    // slot, so a pass's timestamps live as long as its constants and are only
+    // read once the submission holding them has retired
     D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
     queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
-    queryHeapDesc.Count = 2;
+    queryHeapDesc.Count = 2 * CONSTANT_BUFFER_SLOTS;
     hr = m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_timestampQueryHeap));
     if (FAILED(hr)) {
         m_gpuTimingEnabled = false;
     } else {
         D3D12_RESOURCE_DESC readbackDesc = {};
         readbackDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        readbackDesc.Width = 2 * sizeof(uint64_t);
+        readbackDesc.Width = 2 * CONSTANT_BUFFER_SLOTS * sizeof(uint64_t);
         readbackDesc.Height = 1;
         readbackDesc.DepthOrArraySize = 1;
         readbackDesc.MipLevels = 1;
@@ -382,141 +867,469 @@ void FrameInterpolation::SetTimestampFrequency(ID3D12CommandQueue* cmdQueue)
     }
 }
 
+uint32_t FrameInterpolation::GetDescriptorSet(ID3D12Resource* previousFrame,
+                                              ID3D12Resource* currentFrame,
+                                              ID3D12Resource* motionVectors,
+                                              ID3D12Resource* const* outputs,
+                                              uint32_t outputCount)
+{
+    DescriptorSetKey wanted;
+    wanted.prevFrame = previousFrame;
+    wanted.currFrame = currentFrame;
+    wanted.motionVectors = motionVectors;
+    for (uint32_t i = 0; i < outputCount; i++) {
+        wanted.outputs[i] = outputs[i];
+    }
+
+    // Reuse an existing set for these inputs (steady state: no descriptor writes)
+    for (uint32_t i = 0; i < DESCRIPTOR_SETS; i++) {
+        const DescriptorSetKey& key = m_descriptorSetKeys[i];
+        if (key.prevFrame == wanted.prevFrame && key.currFrame == wanted.currFrame &&
+            key.motionVectors == wanted.motionVectors &&
+            memcmp(key.outputs, wanted.outputs, sizeof(wanted.outputs)) == 0) {
+            return i;
+        }
+    }
+
+    // Miss: overwrite the oldest set
+    const uint32_t set = m_nextDescriptorSet;
+    m_nextDescriptorSet = (m_nextDescriptorSet + 1) % DESCRIPTOR_SETS;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+    cpuHandle.ptr += static_cast<SIZE_T>(set) * DESCRIPTORS_PER_SET * m_srvUavDescriptorSize;
+
+    // SRV for previous frame
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = previousFrame->GetDesc().Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_device->CreateShaderResourceView(previousFrame, &srvDesc, cpuHandle);
+
+    // SRV for current frame
+    cpuHandle.ptr += m_srvUavDescriptorSize;
+    srvDesc.Format = currentFrame->GetDesc().Format;
+    m_device->CreateShaderResourceView(currentFrame, &srvDesc, cpuHandle);
+
+    // SRV for motion vectors (R16G16_SINT blocks or R16G16_FLOAT field)
+    cpuHandle.ptr += m_srvUavDescriptorSize;
+    srvDesc.Format = motionVectors->GetDesc().Format;
+    m_device->CreateShaderResourceView(motionVectors, &srvDesc, cpuHandle);
+
+    // UAVs for outputs (unused slots get null descriptors)
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = m_config.format;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+    for (uint32_t i = 0; i < MAX_PHASES; i++) {
+        cpuHandle.ptr += m_srvUavDescriptorSize;
+        m_device->CreateUnorderedAccessView(wanted.outputs[i], nullptr, &uavDesc, cpuHandle);
+    }
+
+    m_descriptorSetKeys[set] = wanted;
+
+    return set;
+}
+
+bool FrameInterpolation::Dispatch(ID3D12Resource* previousFrame,
+                                   ID3D12Resource* currentFrame,
+                                   ID3D12Resource* motionVectors,
+                                   ID3D12GraphicsCommandList* commandList)
+{
+    if (!m_interpolatedFrame) {
+        m_lastError = "No output texture (config.createOutput is false)";
+        return false;
+    }
+    return Dispatch(previousFrame, currentFrame, motionVectors, m_interpolatedFrame.Get(), commandList);
+}
+
 bool FrameInterpolation::Dispatch(ID3D12Resource* previousFrame,
                                    ID3D12Resource* currentFrame,
                                    ID3D12Resource* motionVectors,
+                                   ID3D12Resource* outputTarget,
                                    ID3D12GraphicsCommandList* commandList)
+{
+    const float factor = m_config.interpolationFactor;
+    return DispatchPhases(previousFrame, currentFrame, motionVectors,
+                          &outputTarget, &factor, 1, commandList);
+}
+
+bool FrameInterpolation::DispatchPhases(ID3D12Resource* previousFrame,
+                                         ID3D12Resource* currentFrame,
+                                         ID3D12Resource* motionVectors,
+                                         ID3D12Resource* const* outputTargets,
+                                         const float* factors,
+                                         uint32_t phaseCount,
+                                         ID3D12GraphicsCommandList* commandList)
+{
+    return RecordPhases(previousFrame, currentFrame, motionVectors, outputTargets,
+                        factors, phaseCount, commandList, false);
+}
+
+bool FrameInterpolation::DispatchRepeat(ID3D12Resource* currentFrame,
+                                         ID3D12Resource* motionVectors,
+                                         ID3D12Resource* const* outputTargets,
+                                         uint32_t phaseCount,
+                                         ID3D12GraphicsCommandList* commandList)
+{
+    // Zero motion at t = 1 samples the current frame at each pixel centre
+    const float factors[MAX_PHASES] = { 1.0f, 1.0f, 1.0f };
+    return RecordPhases(currentFrame, currentFrame, motionVectors, outputTargets,
+                        factors, phaseCount, commandList, true);
+}
+
+bool FrameInterpolation::UpdateStaticTiles(ID3D12Resource* currentFrame,
+                                            ID3D12Resource* motionVectors,
+                                            ID3D12GraphicsCommandList* commandList)
 {
     if (!m_initialized) {
         m_lastError = "Not initialized";
         return false;
     }
 
-    if (!previousFrame || !currentFrame || !motionVectors || !commandList) {
+    if (!m_tileState) {
+        return true;
+    }
+
+    if (!currentFrame || !motionVectors || !commandList) {
         m_lastError = "Invalid parameters";
         return false;
     }
 
-    auto startTime = std::chrono::high_resolution_clock::now();
+    // The first pass after (re)creation overwrites whatever the buffer held
+    const bool motionField = motionVectors->GetDesc().Format == DXGI_FORMAT_R16G16_FLOAT;
+    const float factor = 1.0f;
+    const uint32_t cbOffset = WriteConstants(motionVectors, &factor, 1, false, !m_tileStateValid);
+
+    const uint32_t descriptorSet = GetDescriptorSet(currentFrame, currentFrame, motionVectors,
+                                                    nullptr, 0);
+
+    commandList->SetComputeRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(motionField ? m_fieldStaticTilesPipelineState.Get()
+                                              : m_staticTilesPipelineState.Get());
 
-    // Read back previous frame's GPU timestamps (if available)
-    if (m_gpuTimingEnabled && m_stats.framesInterpolated > 0) {
-        D3D12_RANGE readRange = { 0, 2 * sizeof(uint64_t) };
-        uint64_t* timestamps = nullptr;
-        if (SUCCEEDED(m_timestampReadbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&timestamps)))) {
-            uint64_t startTs = timestamps[0];
-            uint64_t endTs = timestamps[1];
-            D3D12_RANGE writeRange = { 0, 0 };
-            m_timestampReadbackBuffer->Unmap(0, &writeRange);
-
-            if (m_gpuTimestampFrequency > 0 && endTs > startTs) {
-                double gpuTimeMs = (double)(endTs - startTs) * 1000.0 / (double)m_gpuTimestampFrequency;
-                m_stats.lastGpuTimeMs = gpuTimeMs;
-
-                const double alpha = 0.1;
-                if (m_stats.framesInterpolated == 1) {
-                    m_stats.avgGpuTimeMs = gpuTimeMs;
-                } else {
-                    m_stats.avgGpuTimeMs = alpha * gpuTimeMs + (1.0 - alpha) * m_stats.avgGpuTimeMs;
-                }
+    ID3D12DescriptorHeap* heaps[] = { m_srvUavHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+
+    commandList->SetComputeRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress() + cbOffset);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_srvUavHeap->GetGPUDescriptorHandleForHeapStart();
+    gpuHandle.ptr += static_cast<UINT64>(descriptorSet) * DESCRIPTORS_PER_SET * m_srvUavDescriptorSize;
+    commandList->SetComputeRootDescriptorTable(1, gpuHandle);  // SRVs
+    commandList->SetComputeRootUnorderedAccessView(3, m_tileState->GetGPUVirtualAddress());
+
+    // One group per tile; the interpolation passes read the result
+    commandList->Dispatch(m_tilesX, m_tilesY, 1);
+
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    barrier.UAV.pResource = m_tileState.Get();
+    commandList->ResourceBarrier(1, &barrier);
+
+    m_tileStateValid = true;
+    return true;
+}
+
+bool FrameInterpolation::Draw(ID3D12Resource* previousFrame,
+                               ID3D12Resource* currentFrame,
+                               ID3D12Resource* motionVectors,
+                               D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                               float factor,
+                               ID3D12GraphicsCommandList* commandList)
+{
+    return RecordDraw(previousFrame, currentFrame, motionVectors, renderTarget,
+                      factor, commandList, false);
+}
+
+bool FrameInterpolation::DrawRepeat(ID3D12Resource* currentFrame,
+                                     ID3D12Resource* motionVectors,
+                                     D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                                     ID3D12GraphicsCommandList* commandList)
+{
+    return RecordDraw(currentFrame, currentFrame, motionVectors, renderTarget,
+                      1.0f, commandList, true);
+}
+
+void FrameInterpolation::ReadGpuTiming()
+{
+    // Fold the timestamps of retired passes, oldest first. A pass whose
+    // submission is still queued (or was never tagged by Retire()) stops the
+    // walk; WriteConstants() reads it when its slot comes round again.
+    if (!m_gpuTimingEnabled) {
+        return;
+    }
+
+    while (m_timestampReadSlot != m_constantBufferSlot) {
+        const uint32_t slot = m_timestampReadSlot;
+        if (m_timestampPending[slot]) {
+            const SlotRetire& retire = m_slotRetire[slot];
+            if (!retire.fence || retire.fence->GetCompletedValue() < retire.value) {
+                break;
             }
+            ReadTimestamps(slot);
         }
+        m_timestampReadSlot = (slot + 1) % CONSTANT_BUFFER_SLOTS;
     }
+}
 
-    // Transition interpolated frame to UAV state if it was left in shader resource state
-    if (m_stats.framesInterpolated > 0) {
-        D3D12_RESOURCE_BARRIER barrier = {};
-        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-        barrier.Transition.pResource = m_interpolatedFrame.Get();
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
-        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        commandList->ResourceBarrier(1, &barrier);
+void FrameInterpolation::ReadTimestamps(uint32_t slot)
+{
+    m_timestampPending[slot] = false;
+
+    const SIZE_T offset = slot * 2 * sizeof(uint64_t);
+    D3D12_RANGE readRange = { offset, offset + 2 * sizeof(uint64_t) };
+    uint8_t* mapped = nullptr;
+    if (SUCCEEDED(m_timestampReadbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mapped)))) {
+        const uint64_t* timestamps = reinterpret_cast<const uint64_t*>(mapped + offset);
+        uint64_t startTs = timestamps[0];
+        uint64_t endTs = timestamps[1];
+        D3D12_RANGE writeRange = { 0, 0 };
+        m_timestampReadbackBuffer->Unmap(0, &writeRange);
+
+        if (m_gpuTimestampFrequency > 0 && endTs > startTs) {
+            double gpuTimeMs = (double)(endTs - startTs) * 1000.0 / (double)m_gpuTimestampFrequency;
+            m_stats.lastGpuTimeMs = gpuTimeMs;
+
+            const double alpha = 0.1;
+            if (m_stats.avgGpuTimeMs == 0.0) {
+                m_stats.avgGpuTimeMs = gpuTimeMs;
+            } else {
+                m_stats.avgGpuTimeMs = alpha * gpuTimeMs + (1.0 - alpha) * m_stats.avgGpuTimeMs;
+            }
+        }
     }
+}
 
+uint32_t FrameInterpolation::WriteConstants(ID3D12Resource* motionVectors, const float* factors,
+                                            uint32_t phaseCount, bool repeatCurrent, bool resetTiles)
+{
     // Get motion vector dimensions from resource
     D3D12_RESOURCE_DESC mvDesc = motionVectors->GetDesc();
     uint32_t mvWidth = static_cast<uint32_t>(mvDesc.Width);
     uint32_t mvHeight = mvDesc.Height;
+    const bool motionField = mvDesc.Format == DXGI_FORMAT_R16G16_FLOAT;
 
-    // Update constant buffer
+    // Update this pass's constant buffer slot
     ConstantBufferData cbData = {};
     cbData.width = m_config.width;
     cbData.height = m_config.height;
     cbData.mvWidth = mvWidth;
     cbData.mvHeight = mvHeight;
-    cbData.interpolationFactor = m_config.interpolationFactor;
-    cbData.motionScale = 1.0f / 16.0f;
+    cbData.interpolationFactor = factors[0];
+    cbData.motionScale = repeatCurrent ? 0.0f
+                                       : (motionField ? 1.0f : m_config.motionVectorScale) * m_config.motionOutputScale;
+    for (uint32_t i = 0; i < phaseCount; i++) {
+        cbData.phaseFactors[i] = factors[i];
+    }
+    cbData.phaseCount = phaseCount;
+    // Repeats already are the current frame; until the history has been
+    // reset once the buffer holds garbage
+    cbData.staticTileFrames = (!repeatCurrent && (m_tileStateValid || resetTiles))
+                                  ? m_config.staticTileFrames : 0;
+    cbData.tilesX = m_tilesX;
+    cbData.resetTiles = resetTiles ? 1 : 0;
+
+    // The slot's last reader may still be queued: a wrap within the frames
+    // in flight waits for it rather than overwriting its constants
+    const uint32_t slot = m_constantBufferSlot;
+    SlotRetire& retire = m_slotRetire[slot];
+    if (retire.fence && retire.fence->GetCompletedValue() < retire.value &&
+        SUCCEEDED(retire.fence->SetEventOnCompletion(retire.value, m_retireEvent))) {
+        WaitForSingleObject(m_retireEvent, INFINITE);
+    }
+    retire = SlotRetire{};
 
-    void* mappedData;
-    D3D12_RANGE readRange = { 0, 0 };
-    HRESULT hr = m_constantBuffer->Map(0, &readRange, &mappedData);
-    if (SUCCEEDED(hr)) {
-        memcpy(mappedData, &cbData, sizeof(cbData));
-        m_constantBuffer->Unmap(0, nullptr);
+    // The slot's timestamps are final now; take them before the pass reuses them
+    if (m_timestampPending[slot]) {
+        ReadTimestamps(slot);
+    }
+    if (m_timestampReadSlot == slot) {
+        m_timestampReadSlot = (slot + 1) % CONSTANT_BUFFER_SLOTS;
     }
 
-    // Only recreate descriptors if textures changed (major performance optimization)
-    bool needsDescriptorUpdate = !m_descriptorsValid ||
-                                  m_cachedPrevFrame != previousFrame ||
-                                  m_cachedCurrFrame != currentFrame ||
-                                  m_cachedMotionVectors != motionVectors;
+    const uint32_t cbOffset = slot * CONSTANT_BUFFER_SLOT_SIZE;
+    m_constantBufferSlot = (slot + 1) % CONSTANT_BUFFER_SLOTS;
+    if (m_unretiredSlots < CONSTANT_BUFFER_SLOTS) {
+        m_unretiredSlots++;
+    }
+    memcpy(m_constantBufferMapped + cbOffset, &cbData, sizeof(cbData));
+    return cbOffset;
+}
 
-    if (needsDescriptorUpdate) {
-        D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+void FrameInterpolation::Retire(ID3D12Fence* fence, uint64_t fenceValue)
+{
+    // The unretired slots are the ones just before the next slot
+    for (uint32_t i = 1; i <= m_unretiredSlots; i++) {
+        SlotRetire& retire = m_slotRetire[(m_constantBufferSlot + CONSTANT_BUFFER_SLOTS - i) % CONSTANT_BUFFER_SLOTS];
+        retire.fence = fence;
+        retire.value = fenceValue;
+    }
+    m_unretiredSlots = 0;
+}
 
-        // SRV for previous frame
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = previousFrame->GetDesc().Format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.Texture2D.MipLevels = 1;
-        m_device->CreateShaderResourceView(previousFrame, &srvDesc, cpuHandle);
+bool FrameInterpolation::RecordDraw(ID3D12Resource* previousFrame,
+                                     ID3D12Resource* currentFrame,
+                                     ID3D12Resource* motionVectors,
+                                     D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                                     float factor,
+                                     ID3D12GraphicsCommandList* commandList,
+                                     bool repeatCurrent)
+{
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
 
-        // SRV for current frame
-        cpuHandle.ptr += m_srvUavDescriptorSize;
-        srvDesc.Format = currentFrame->GetDesc().Format;
-        m_device->CreateShaderResourceView(currentFrame, &srvDesc, cpuHandle);
+    if (!m_drawPipelineState) {
+        m_lastError = "Draw requires config.renderTargetFormat";
+        return false;
+    }
 
-        // SRV for motion vectors (R16G16_SINT)
-        cpuHandle.ptr += m_srvUavDescriptorSize;
-        srvDesc.Format = DXGI_FORMAT_R16G16_SINT;
-        m_device->CreateShaderResourceView(motionVectors, &srvDesc, cpuHandle);
+    if (!previousFrame || !currentFrame || !motionVectors || !commandList || renderTarget.ptr == 0) {
+        m_lastError = "Invalid parameters";
+        return false;
+    }
 
-        // UAV for output
-        cpuHandle.ptr += m_srvUavDescriptorSize;
-        D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-        uavDesc.Format = m_config.format;
-        uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-        m_device->CreateUnorderedAccessView(m_interpolatedFrame.Get(), nullptr, &uavDesc, cpuHandle);
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-        // Cache the texture pointers
-        m_cachedPrevFrame = previousFrame;
-        m_cachedCurrFrame = currentFrame;
-        m_cachedMotionVectors = motionVectors;
-        m_descriptorsValid = true;
+    ReadGpuTiming();
+
+    const bool motionField = motionVectors->GetDesc().Format == DXGI_FORMAT_R16G16_FLOAT;
+    const uint32_t cbOffset = WriteConstants(motionVectors, &factor, 1, repeatCurrent);
+
+    // Outputs go through the RTV, so the set's UAV slots stay null
+    const uint32_t descriptorSet = GetDescriptorSet(previousFrame, currentFrame, motionVectors,
+                                                    nullptr, 0);
+
+    commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(motionField ? m_fieldDrawPipelineState.Get()
+                                              : m_drawPipelineState.Get());
+
+    ID3D12DescriptorHeap* heaps[] = { m_srvUavHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+
+    commandList->SetGraphicsRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress() + cbOffset);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_srvUavHeap->GetGPUDescriptorHandleForHeapStart();
+    gpuHandle.ptr += static_cast<UINT64>(descriptorSet) * DESCRIPTORS_PER_SET * m_srvUavDescriptorSize;
+    commandList->SetGraphicsRootDescriptorTable(1, gpuHandle);  // SRVs
+    commandList->SetGraphicsRootUnorderedAccessView(3, m_tileState ? m_tileState->GetGPUVirtualAddress() : 0);
+
+    D3D12_VIEWPORT viewport = { 0.0f, 0.0f, static_cast<float>(m_config.width),
+                                static_cast<float>(m_config.height), 0.0f, 1.0f };
+    D3D12_RECT scissor = { 0, 0, static_cast<LONG>(m_config.width), static_cast<LONG>(m_config.height) };
+    commandList->RSSetViewports(1, &viewport);
+    commandList->RSSetScissorRects(1, &scissor);
+    commandList->OMSetRenderTargets(1, &renderTarget, FALSE, nullptr);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    const uint32_t timestampSlot = cbOffset / CONSTANT_BUFFER_SLOT_SIZE;
+    if (m_gpuTimingEnabled) {
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampSlot * 2);
     }
 
-    // Set pipeline state
+    commandList->DrawInstanced(3, 1, 0, 0);
+
+    if (m_gpuTimingEnabled) {
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampSlot * 2 + 1);
+        commandList->ResolveQueryData(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+                                       timestampSlot * 2, 2, m_timestampReadbackBuffer.Get(),
+                                       timestampSlot * 2 * sizeof(uint64_t));
+        m_timestampPending[timestampSlot] = true;
+    }
+
+    if (repeatCurrent) {
+        return true;
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double drawTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    const uint64_t previousCount = m_stats.framesInterpolated;
+    m_stats.lastInterpolationTimeMs = drawTimeMs;
+    m_stats.framesInterpolated++;
+    m_stats.avgInterpolationTimeMs = (m_stats.avgInterpolationTimeMs * previousCount + drawTimeMs) /
+                                     m_stats.framesInterpolated;
+
+    return true;
+}
+
+bool FrameInterpolation::RecordPhases(ID3D12Resource* previousFrame,
+                                       ID3D12Resource* currentFrame,
+                                       ID3D12Resource* motionVectors,
+                                       ID3D12Resource* const* outputTargets,
+                                       const float* factors,
+                                       uint32_t phaseCount,
+                                       ID3D12GraphicsCommandList* commandList,
+                                       bool repeatCurrent)
+{
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (!previousFrame || !currentFrame || !motionVectors || !outputTargets || !factors ||
+        !commandList || phaseCount == 0 || phaseCount > MAX_PHASES) {
+        m_lastError = "Invalid parameters";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < phaseCount; i++) {
+        if (!outputTargets[i]) {
+            m_lastError = "Invalid output target";
+            return false;
+        }
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    ReadGpuTiming();
+
+    // Transition outputs from their resting shader resource state to UAV
+    D3D12_RESOURCE_BARRIER barriers[MAX_PHASES] = {};
+    for (uint32_t i = 0; i < phaseCount; i++) {
+        barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barriers[i].Transition.pResource = outputTargets[i];
+        barriers[i].Transition.StateBefore = m_config.outputState;
+        barriers[i].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    }
+    commandList->ResourceBarrier(phaseCount, barriers);
+
+    const bool motionField = motionVectors->GetDesc().Format == DXGI_FORMAT_R16G16_FLOAT;
+    const uint32_t cbOffset = WriteConstants(motionVectors, factors, phaseCount, repeatCurrent);
+
+    const uint32_t descriptorSet = GetDescriptorSet(previousFrame, currentFrame, motionVectors,
+                                                    outputTargets, phaseCount);
+
+    // Set pipeline state (one-output kernel unless several phases share the pass)
     commandList->SetComputeRootSignature(m_rootSignature.Get());
-    commandList->SetPipelineState(m_pipelineState.Get());
+    if (motionField) {
+        commandList->SetPipelineState(phaseCount > 1 ? m_fieldMultiPhasePipelineState.Get()
+                                                     : m_fieldPipelineState.Get());
+    } else {
+        commandList->SetPipelineState(phaseCount > 1 ? m_multiPhasePipelineState.Get()
+                                                     : m_pipelineState.Get());
+    }
 
     // Set descriptor heap
     ID3D12DescriptorHeap* heaps[] = { m_srvUavHeap.Get() };
     commandList->SetDescriptorHeaps(1, heaps);
 
     // Set root parameters
-    commandList->SetComputeRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress());
+    commandList->SetComputeRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress() + cbOffset);
 
     D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_srvUavHeap->GetGPUDescriptorHandleForHeapStart();
+    gpuHandle.ptr += static_cast<UINT64>(descriptorSet) * DESCRIPTORS_PER_SET * m_srvUavDescriptorSize;
     commandList->SetComputeRootDescriptorTable(1, gpuHandle);  // SRVs
 
     gpuHandle.ptr += m_srvUavDescriptorSize * 3;
-    commandList->SetComputeRootDescriptorTable(2, gpuHandle);  // UAV
+    commandList->SetComputeRootDescriptorTable(2, gpuHandle);  // UAVs
+    commandList->SetComputeRootUnorderedAccessView(3, m_tileState ? m_tileState->GetGPUVirtualAddress() : 0);
 
-    // GPU timestamp: start
+    // GPU timestamp: start (the pair belongs to this pass's constant buffer slot)
+    const uint32_t timestampSlot = cbOffset / CONSTANT_BUFFER_SLOT_SIZE;
     if (m_gpuTimingEnabled) {
-        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampSlot * 2);
     }
 
     // Dispatch compute shader with 16x16 thread groups
@@ -526,28 +1339,35 @@ bool FrameInterpolation::Dispatch(ID3D12Resource* previousFrame,
 
     // GPU timestamp: end
     if (m_gpuTimingEnabled) {
-        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, timestampSlot * 2 + 1);
         commandList->ResolveQueryData(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
-                                       0, 2, m_timestampReadbackBuffer.Get(), 0);
+                                       timestampSlot * 2, 2, m_timestampReadbackBuffer.Get(),
+                                       timestampSlot * 2 * sizeof(uint64_t));
+        m_timestampPending[timestampSlot] = true;
     }
 
-    // Transition interpolated frame from UAV to PIXEL_SHADER_RESOURCE for presentation
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = m_interpolatedFrame.Get();
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    commandList->ResourceBarrier(1, &barrier);
+    // Transition outputs from UAV back to their resting state for presentation
+    for (uint32_t i = 0; i < phaseCount; i++) {
+        barriers[i].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        barriers[i].Transition.StateAfter = m_config.outputState;
+    }
+    commandList->ResourceBarrier(phaseCount, barriers);
+
+    // Repeats are not interpolated frames
+    if (repeatCurrent) {
+        return true;
+    }
 
     // Update statistics
     auto endTime = std::chrono::high_resolution_clock::now();
     double dispatchTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
+    // Averages are per interpolated frame, so a multi-phase pass counts once per phase
+    const uint64_t previousCount = m_stats.framesInterpolated;
     m_stats.lastInterpolationTimeMs = dispatchTimeMs;
-    m_stats.framesInterpolated++;
-    m_stats.avgInterpolationTimeMs = (m_stats.avgInterpolationTimeMs * (m_stats.framesInterpolated - 1) +
-                                       dispatchTimeMs) / m_stats.framesInterpolated;
+    m_stats.framesInterpolated += phaseCount;
+    m_stats.avgInterpolationTimeMs = (m_stats.avgInterpolationTimeMs * previousCount +
+                                       dispatchTimeMs * phaseCount) / m_stats.framesInterpolated;
 
     return true;
 }
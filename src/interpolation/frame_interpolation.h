@@ -11,6 +11,7 @@
 #define NOMINMAX
 #endif
 
+#include <Windows.h>
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include <wrl/client.h>
@@ -18,6 +19,9 @@
 #include <cstdint>
 #include <string>
 
+#include "common/pipeline_cache.h"
+#include "common/resource_arena.h"
+
 namespace OSFG {
 
 // Configuration for frame interpolation
@@ -26,6 +30,38 @@ struct FrameInterpolationConfig {
     uint32_t height = 1080;
     DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
     float interpolationFactor = 0.5f;  // 0.0 = previous frame, 1.0 = current frame
+
+    // Resting state of output targets. NON_PIXEL_SHADER_RESOURCE when the
+    // dispatches are recorded on COMPUTE command lists.
+    D3D12_RESOURCE_STATES outputState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+    // Render-target format for Draw() (e.g. the swap chain's back-buffer
+    // format). UNKNOWN skips creating the full-screen pipelines.
+    DXGI_FORMAT renderTargetFormat = DXGI_FORMAT_UNKNOWN;
+
+    // Pixels per unit of R16G16_SINT block vectors: 1/16 for SimpleOpticalFlow,
+    // see MotionEstimator::GetMotionVectorScale(). Dense fields are in pixels.
+    float motionVectorScale = 1.0f / 16.0f;
+
+    // Output pixels per pixel of the frames the vectors were estimated on.
+    // Below 1 when interpolating into targets smaller than the flow's frames
+    // (e.g. 0.5 for half-size outputs); applies to block vectors and fields.
+    float motionOutputScale = 1.0f;
+
+    // Copy 16x16 tiles that have stayed unchanged for this many frames (and
+    // have no motion around them) straight from the current frame, e.g.
+    // HUDs and overlays. 0 = off. Needs UpdateStaticTiles() once per frame.
+    uint32_t staticTileFrames = 0;
+
+    // Create the output of the target-less Dispatch(). Callers that always
+    // pass their own targets (or only Draw()) can skip the full-size texture.
+    bool createOutput = true;
+
+    // Optional on-disk PSO cache (not owned; must outlive this object)
+    osfg::PipelineCache* pipelineCache = nullptr;
+
+    // Optional heap arena for the output texture (not owned; must outlive this object)
+    osfg::ResourceArena* resourceArena = nullptr;
 };
 
 // Statistics
@@ -39,6 +75,9 @@ struct FrameInterpolationStats {
 
 class FrameInterpolation {
 public:
+    // Maximum outputs written by one DispatchPhases() pass (X4 = 3 phases)
+    static const uint32_t MAX_PHASES = 3;
+
     FrameInterpolation();
     ~FrameInterpolation();
 
@@ -55,20 +94,109 @@ public:
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
+    // Re-create the output texture for a new frame size, keeping the
+    // pipelines. No work using the old output or the old inputs may still
+    // be pending (their descriptors are dropped).
+    bool Resize(uint32_t width, uint32_t height);
+
     // Set interpolation factor (0.0 to 1.0)
     void SetInterpolationFactor(float factor);
 
+    // The flow was re-created: take its vector scale (config.motionVectorScale)
+    // and forget the descriptors of its old outputs, whose addresses can be
+    // reused. No work using the old motion vectors may still be pending.
+    void ResetMotionSource(float motionVectorScale);
+
+    // Passes recorded since the last call finish when `fence` reaches
+    // `fenceValue`: call it after submitting the list that holds them. A
+    // constant buffer slot is only rewritten once the submission reading it
+    // has retired (the CPU waits for it if the ring wraps first), and a
+    // pass's GPU timestamps are only read once it has. Callers that never
+    // call it must keep fewer than CONSTANT_BUFFER_SLOTS passes in flight.
+    void Retire(ID3D12Fence* fence, uint64_t fenceValue);
+
     // Dispatch frame interpolation
     // previousFrame: Previous frame texture
     // currentFrame: Current frame texture
-    // motionVectors: Motion vector texture from optical flow (R16G16_SINT)
+    // motionVectors: Motion vectors from optical flow: per-block R16G16_SINT
+    //               (config.motionVectorScale, nearest tap) or a dense R16G16_FLOAT field
+    //               (pixels, sampled bilinearly), e.g. GetMotionField()
     // commandList: Command list to record work
+    // Several dispatches may be recorded before the list executes; each one
+    // gets its own constant buffer slot (see Retire()).
     bool Dispatch(ID3D12Resource* previousFrame,
                   ID3D12Resource* currentFrame,
                   ID3D12Resource* motionVectors,
                   ID3D12GraphicsCommandList* commandList);
 
-    // Get interpolated frame texture
+    // Dispatch frame interpolation into a caller-owned output texture
+    // outputTarget: UAV-capable texture matching GetOutputDesc(), in
+    //               config.outputState on entry; left in that state
+    bool Dispatch(ID3D12Resource* previousFrame,
+                  ID3D12Resource* currentFrame,
+                  ID3D12Resource* motionVectors,
+                  ID3D12Resource* outputTarget,
+                  ID3D12GraphicsCommandList* commandList);
+
+    // Dispatch every phase of one base frame in a single pass
+    // outputTargets: phaseCount targets (same requirements as above)
+    // factors: interpolation factor t for each target
+    // Motion vectors are fetched once per pixel for all phases. Pixels that
+    // move less than 1/16 pixel also share their two source taps; moving
+    // pixels sample per phase, mostly from the texture cache.
+    bool DispatchPhases(ID3D12Resource* previousFrame,
+                        ID3D12Resource* currentFrame,
+                        ID3D12Resource* motionVectors,
+                        ID3D12Resource* const* outputTargets,
+                        const float* factors,
+                        uint32_t phaseCount,
+                        ID3D12GraphicsCommandList* commandList);
+
+    // Advance the static-tile history with this base frame. Record it once
+    // per base frame, outside any predication and before that frame's
+    // DispatchPhases() or Draw() passes, on the list type that records
+    // them. No-op unless config.staticTileFrames is set.
+    // currentFrame: readable by non-pixel shaders (NON_PIXEL_SHADER_RESOURCE,
+    //               or COMMON promoted implicitly)
+    bool UpdateStaticTiles(ID3D12Resource* currentFrame,
+                           ID3D12Resource* motionVectors,
+                           ID3D12GraphicsCommandList* commandList);
+
+    // Write currentFrame unchanged into each target (same requirements as
+    // DispatchPhases). Recorded under predication next to DispatchPhases()
+    // so scene cuts repeat the real frame instead of blending across the cut.
+    bool DispatchRepeat(ID3D12Resource* currentFrame,
+                        ID3D12Resource* motionVectors,
+                        ID3D12Resource* const* outputTargets,
+                        uint32_t phaseCount,
+                        ID3D12GraphicsCommandList* commandList);
+
+    // Interpolate one phase with a full-screen pixel-shader pass into a
+    // render target, e.g. the current swap-chain back buffer, instead of
+    // writing an intermediate texture that is then copied.
+    // renderTarget: RTV of a config.renderTargetFormat target, bound in
+    //               RENDER_TARGET state; sized width x height
+    // Inputs must be readable by the pixel shader (PIXEL_SHADER_RESOURCE, or
+    // COMMON textures promoted implicitly). Requires config.renderTargetFormat.
+    bool Draw(ID3D12Resource* previousFrame,
+              ID3D12Resource* currentFrame,
+              ID3D12Resource* motionVectors,
+              D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+              float factor,
+              ID3D12GraphicsCommandList* commandList);
+
+    // Write currentFrame unchanged into the render target in the same pass
+    // (the real frame's blit, and the scene-cut counterpart of Draw())
+    bool DrawRepeat(ID3D12Resource* currentFrame,
+                    ID3D12Resource* motionVectors,
+                    D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                    ID3D12GraphicsCommandList* commandList);
+
+    // Resource description for output targets (UAV-capable, config size/format)
+    D3D12_RESOURCE_DESC GetOutputDesc() const;
+
+    // Get interpolated frame texture (output of the target-less Dispatch;
+    // null when config.createOutput is false)
     ID3D12Resource* GetInterpolatedFrame() const { return m_interpolatedFrame.Get(); }
 
     // Get dimensions
@@ -87,39 +215,127 @@ public:
 private:
     bool CreateRootSignature();
     bool CreatePipelineState();
+    bool CreatePipelineState(const char* entryPoint, const D3D_SHADER_MACRO* defines,
+                             Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    bool CreateDrawPipelineState(const D3D_SHADER_MACRO* defines,
+                                 Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    // Bytecode of a variant: the build-time DXIL when allowPrecompiled and
+    // available, else compiled into shaderBlob for target
+    bool CompileShader(const char* entryPoint, const char* target, const D3D_SHADER_MACRO* defines,
+                       bool allowPrecompiled, Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob,
+                       D3D12_SHADER_BYTECODE& bytecode);
+    bool HasPrecompiledShader(const char* entryPoint, const D3D_SHADER_MACRO* defines) const;
     bool CreateResources();
+    bool CreateOutputTexture();
+    bool CreateTileState();
     bool CreateDescriptorHeaps();
+    bool RecordPhases(ID3D12Resource* previousFrame,
+                      ID3D12Resource* currentFrame,
+                      ID3D12Resource* motionVectors,
+                      ID3D12Resource* const* outputTargets,
+                      const float* factors,
+                      uint32_t phaseCount,
+                      ID3D12GraphicsCommandList* commandList,
+                      bool repeatCurrent);
+    bool RecordDraw(ID3D12Resource* previousFrame,
+                    ID3D12Resource* currentFrame,
+                    ID3D12Resource* motionVectors,
+                    D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                    float factor,
+                    ID3D12GraphicsCommandList* commandList,
+                    bool repeatCurrent);
+
+    // Fold the resolved timestamps of retired passes into the GPU time stats
+    void ReadGpuTiming();
+    void ReadTimestamps(uint32_t slot);
+
+    // Fill the next constant buffer slot, once it has retired; returns its offset
+    uint32_t WriteConstants(ID3D12Resource* motionVectors, const float* factors,
+                            uint32_t phaseCount, bool repeatCurrent, bool resetTiles = false);
 
     // D3D12 objects
     Microsoft::WRL::ComPtr<ID3D12Device> m_device;
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
-    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;            // CSMain (one output)
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_multiPhasePipelineState;  // CSMainMulti
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_fieldPipelineState;       // CSMain, MOTION_FIELD
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_fieldMultiPhasePipelineState;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_drawPipelineState;         // VSFullscreen + PSMain
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_fieldDrawPipelineState;    // Same, MOTION_FIELD
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_staticTilesPipelineState;       // CSStaticTiles
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_fieldStaticTilesPipelineState;  // Same, MOTION_FIELD
 
     // Descriptor heaps
+    // Holds DESCRIPTOR_SETS sets of (3 SRVs + MAX_PHASES UAVs). Sets are keyed by the
+    // input and output textures and only rewritten on a cache miss, so a set
+    // that an in-flight command list still references is never overwritten
+    // while the inputs cycle through the transfer ring and the outputs cycle
+    // through the caller's generated-frame ring.
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvUavHeap;
     uint32_t m_srvUavDescriptorSize = 0;
+    static const uint32_t DESCRIPTORS_PER_SET = 3 + MAX_PHASES;
+    static const uint32_t DESCRIPTOR_SETS = 32;
 
     // Resources
     Microsoft::WRL::ComPtr<ID3D12Resource> m_interpolatedFrame;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_constantBuffer;
 
+    // Static-tile history: one 16-byte entry per 16x16 output tile, always
+    // in UNORDERED_ACCESS (bound as a root UAV). Its contents are undefined
+    // until the first UpdateStaticTiles() after it is created, which resets
+    // it; the kernels ignore it until then.
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_tileState;
+    uint32_t m_tilesX = 0;
+    uint32_t m_tilesY = 0;
+    bool m_tileStateValid = false;
+
+    // Constant buffer ring (persistently mapped, one 256-byte slot per pass).
+    // Each slot is tagged by Retire() with the fence value of the submission
+    // that reads it, and WriteConstants() waits for that value before reusing it.
+    static const uint32_t CONSTANT_BUFFER_SLOTS = 64;
+    static const uint32_t CONSTANT_BUFFER_SLOT_SIZE = 256;
+    struct SlotRetire {
+        ID3D12Fence* fence = nullptr;   // Not owned; nullptr = free
+        uint64_t value = 0;
+    };
+    uint8_t* m_constantBufferMapped = nullptr;
+    uint32_t m_constantBufferSlot = 0;
+    uint32_t m_unretiredSlots = 0;      // Written since the last Retire()
+    SlotRetire m_slotRetire[CONSTANT_BUFFER_SLOTS];
+    HANDLE m_retireEvent = nullptr;
+
     // Configuration
     FrameInterpolationConfig m_config;
 
     // State
     bool m_initialized = false;
+    bool m_dxilSupported = false;      // Device runs the build-time SM 6.0 shaders
     FrameInterpolationStats m_stats;
     std::string m_lastError;
 
-    // Cached texture pointers for descriptor caching
-    ID3D12Resource* m_cachedPrevFrame = nullptr;
-    ID3D12Resource* m_cachedCurrFrame = nullptr;
-    ID3D12Resource* m_cachedMotionVectors = nullptr;
-    bool m_descriptorsValid = false;
+    // Cached texture pointers for descriptor caching (one entry per set)
+    struct DescriptorSetKey {
+        ID3D12Resource* prevFrame = nullptr;
+        ID3D12Resource* currFrame = nullptr;
+        ID3D12Resource* motionVectors = nullptr;
+        ID3D12Resource* outputs[MAX_PHASES] = {};
+    };
+    DescriptorSetKey m_descriptorSetKeys[DESCRIPTOR_SETS];
+    uint32_t m_nextDescriptorSet = 0;
+
+    // Returns the descriptor set index for these inputs, writing it on a miss
+    uint32_t GetDescriptorSet(ID3D12Resource* previousFrame,
+                              ID3D12Resource* currentFrame,
+                              ID3D12Resource* motionVectors,
+                              ID3D12Resource* const* outputs,
+                              uint32_t outputCount);
 
-    // GPU timing resources
+    // GPU timing resources: a start/end query pair and readback entry per
+    // constant buffer slot, read once the slot's Retire() fence has passed
     Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_timestampQueryHeap;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_timestampReadbackBuffer;
+    bool m_timestampPending[CONSTANT_BUFFER_SLOTS] = {};    // Resolved, not yet read
+    uint32_t m_timestampReadSlot = 0;                       // Oldest slot not yet read
     uint64_t m_gpuTimestampFrequency = 0;
     bool m_gpuTimingEnabled = false;
 
@@ -130,8 +346,13 @@ private:
         uint32_t mvWidth;
         uint32_t mvHeight;
         float interpolationFactor;
-        float motionScale;  // Scale factor for motion vectors (1/16 for our format)
-        float padding[2];   // Align to 16 bytes
+        float motionScale;  // Scale factor for motion vectors (config.motionVectorScale)
+        uint32_t staticTileFrames;  // 0 while the tile history is not valid
+        uint32_t tilesX;
+        float phaseFactors[4];  // t per output (CSMainMulti)
+        uint32_t phaseCount;
+        uint32_t resetTiles;
+        uint32_t padding2[2];
     };
 };
 
@@ -12,20 +12,21 @@
 //    provides optical flow + interpolation as a unified pipeline.
 //    This requires restructuring OSFG to use FFX for both stages.
 //
-// 2. STANDALONE OPTICAL FLOW (Not directly supported):
+// 2. STANDALONE OPTICAL FLOW:
 //    The FidelityFX signed DLLs bundle optical flow internally.
-//    Standalone optical flow requires building from source with
-//    shader blob generation, which needs their internal tooling.
+//    Standalone optical flow requires the SDK's backend and optical
+//    flow libraries built from source (CMake OSFG_FFX_OPTICALFLOW).
+//    OpticalFlow wraps them as a MotionEstimator that the native
+//    pipeline can select instead of SimpleOpticalFlow, feeding the
+//    OSFG FrameInterpolation.
 //
-// Current OSFG approach:
+// Default OSFG approach:
 // - Uses SimpleOpticalFlow (block-matching) for motion estimation
 // - Custom FrameInterpolation for frame generation
 // - No external DLL dependencies
-//
-// Future work: Integrate full FFX frame generation as an alternative
-// high-quality backend alongside the current OSFG pipeline.
 
 #include "fsr_opticalflow.h"
+#include "osfg_opticalflow.h"
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -58,10 +59,9 @@ bool FSROpticalFlow::IsAvailable() {
         s_dllChecked = true;
     }
 
-    // DLL may exist, but standalone optical flow API requires
-    // building from source with shader blob generation.
-    // Return false until full integration is implemented.
-    return false;
+    // The DLL alone is not enough: the standalone optical flow API comes
+    // from the SDK libraries linked with OSFG_FFX_OPTICALFLOW
+    return OpticalFlow::IsAvailable();
 }
 
 bool FSROpticalFlow::IsDllPresent() {
@@ -75,42 +75,79 @@ const std::wstring& FSROpticalFlow::GetDllPath() {
 }
 
 bool FSROpticalFlow::Initialize(ID3D12Device* device, const FSROpticalFlowConfig& config) {
-    if (s_dllAvailable) {
-        // Convert wide string to narrow string properly
-        int size = WideCharToMultiByte(CP_UTF8, 0, s_dllPath.c_str(), -1, nullptr, 0, nullptr, nullptr);
-        std::string narrowPath(size - 1, '\0');
-        WideCharToMultiByte(CP_UTF8, 0, s_dllPath.c_str(), -1, &narrowPath[0], size, nullptr, nullptr);
-
-        m_lastError = "FSR optical flow: FidelityFX DLL found at " + narrowPath + ". " +
-                      "Full integration pending. Use SimpleOpticalFlow for now.";
-    } else {
-        m_lastError = "FSR optical flow: FidelityFX DLL not found. "
-                      "Copy amd_fidelityfx_framegeneration_dx12.dll to application directory. "
-                      "Using SimpleOpticalFlow for motion estimation.";
+    Shutdown();
+
+    if (!IsAvailable()) {
+        if (s_dllAvailable) {
+            // Convert wide string to narrow string properly
+            int size = WideCharToMultiByte(CP_UTF8, 0, s_dllPath.c_str(), -1, nullptr, 0, nullptr, nullptr);
+            std::string narrowPath(size - 1, '\0');
+            WideCharToMultiByte(CP_UTF8, 0, s_dllPath.c_str(), -1, &narrowPath[0], size, nullptr, nullptr);
+
+            m_lastError = "FSR optical flow: FidelityFX DLL found at " + narrowPath + ", but this build " +
+                          "does not link the optical flow libraries (OSFG_FFX_OPTICALFLOW). " +
+                          "Using SimpleOpticalFlow for motion estimation.";
+        } else {
+            m_lastError = "FSR optical flow: not built with OSFG_FFX_OPTICALFLOW. "
+                          "Using SimpleOpticalFlow for motion estimation.";
+        }
+        return false;
     }
-    return false;
+
+    m_config = config;
+
+    OpticalFlowConfig ofConfig;
+    ofConfig.width = config.width;
+    ofConfig.height = config.height;
+
+    m_opticalFlow = std::make_unique<OpticalFlow>();
+    if (!m_opticalFlow->Initialize(device, nullptr, ofConfig)) {
+        m_lastError = "FSR optical flow: " + m_opticalFlow->GetLastError();
+        m_opticalFlow.reset();
+        return false;
+    }
+
+    m_ofWidth = m_opticalFlow->GetMotionVectorWidth();
+    m_ofHeight = m_opticalFlow->GetMotionVectorHeight();
+    m_stats = {};
+    m_stats.gpuMemoryUsageBytes = m_opticalFlow->GetStats().gpuMemoryUsageBytes;
+    m_initialized = true;
+    return true;
 }
 
 void FSROpticalFlow::Shutdown() {
-    m_opticalFlowVector.Reset();
-    m_opticalFlowSCD.Reset();
-    m_device.Reset();
+    m_opticalFlow.reset();
+    m_ofWidth = 0;
+    m_ofHeight = 0;
     m_initialized = false;
 }
 
 bool FSROpticalFlow::Dispatch(ID3D12Resource* currentFrame,
                                ID3D12GraphicsCommandList* commandList,
                                bool reset) {
-    m_lastError = "FSR optical flow not initialized";
-    return false;
+    if (!m_initialized) {
+        m_lastError = "FSR optical flow not initialized";
+        return false;
+    }
+
+    if (!m_opticalFlow->Dispatch(currentFrame, commandList, reset)) {
+        m_lastError = m_opticalFlow->GetLastError();
+        return false;
+    }
+
+    const OpticalFlowStats& stats = m_opticalFlow->GetStats();
+    m_stats.lastDispatchTimeMs = stats.lastDispatchTimeMs;
+    m_stats.avgDispatchTimeMs = stats.avgDispatchTimeMs;
+    m_stats.framesProcessed = stats.totalFramesProcessed;
+    return true;
 }
 
 ID3D12Resource* FSROpticalFlow::GetMotionVectorTexture() const {
-    return m_opticalFlowVector.Get();
+    return m_opticalFlow ? m_opticalFlow->GetMotionVectorTexture() : nullptr;
 }
 
 ID3D12Resource* FSROpticalFlow::GetSceneChangeTexture() const {
-    return m_opticalFlowSCD.Get();
+    return m_opticalFlow ? m_opticalFlow->GetSceneChangeTexture() : nullptr;
 }
 
 } // namespace OSFG
@@ -2,7 +2,9 @@
 // FSR 3 Optical Flow Wrapper
 //
 // Wraps AMD FidelityFX SDK optical flow for high-quality motion estimation.
-// Uses the pre-built signed binaries from the FidelityFX SDK.
+// A thin front end over OpticalFlow (osfg_opticalflow.h), which owns the
+// FidelityFX backend interface, scratch memory and output resources; this
+// class adds the DLL diagnostics.
 //
 // MIT License - Part of Open Source Frame Generation project
 
@@ -25,6 +27,8 @@
 
 namespace OSFG {
 
+class OpticalFlow;
+
 // Configuration for FSR optical flow
 struct FSROpticalFlowConfig {
     uint32_t width = 1920;
@@ -51,7 +55,7 @@ public:
     FSROpticalFlow& operator=(const FSROpticalFlow&) = delete;
 
     // Check if FSR optical flow is available and functional
-    // Returns false until full integration is implemented
+    // (built with OSFG_FFX_OPTICALFLOW, see OpticalFlow::IsAvailable())
     static bool IsAvailable();
 
     // Check if FidelityFX DLL is present (may not be usable yet)
@@ -85,32 +89,23 @@ public:
     // Used for detecting scene cuts
     ID3D12Resource* GetSceneChangeTexture() const;
 
+    // The underlying motion estimator (e.g. to hand to FrameInterpolation
+    // users of MotionEstimator), or nullptr before Initialize()
+    OpticalFlow* GetOpticalFlow() const { return m_opticalFlow.get(); }
+
     // Get optical flow dimensions (may differ from input)
     uint32_t GetOpticalFlowWidth() const { return m_ofWidth; }
     uint32_t GetOpticalFlowHeight() const { return m_ofHeight; }
 
-    // Get statistics
+    // Get statistics (updated by Dispatch())
     const FSROpticalFlowStats& GetStats() const { return m_stats; }
 
     // Get last error
     const std::string& GetLastError() const { return m_lastError; }
 
 private:
-    bool CreateBackendInterface();
-    bool CreateOpticalFlowContext();
-    bool CreateSharedResources();
-
-    // D3D12 objects
-    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
-
-    // FidelityFX backend (opaque - stored as raw memory)
-    std::vector<uint8_t> m_scratchBuffer;
-    void* m_backendInterface = nullptr;  // FfxInterface*
-    void* m_opticalFlowContext = nullptr;  // FfxOpticalflowContext*
-
-    // Shared resources (created by us, used by FFX)
-    Microsoft::WRL::ComPtr<ID3D12Resource> m_opticalFlowVector;
-    Microsoft::WRL::ComPtr<ID3D12Resource> m_opticalFlowSCD;
+    // Backend interface, scratch memory, context and outputs
+    std::unique_ptr<OpticalFlow> m_opticalFlow;
 
     // Configuration
     FSROpticalFlowConfig m_config;
@@ -0,0 +1,84 @@
+// OSFG - Open Source Frame Generation
+// Motion Estimator
+//
+// Common interface of the motion estimation backends (SimpleOpticalFlow,
+// OpticalFlow on FidelityFX). FrameInterpolation only needs the outputs
+// described here, so the native pipeline can run either backend on the
+// secondary GPU and compare cost and quality per GPU model.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <d3d12.h>
+#include <cstdint>
+#include <string>
+
+namespace OSFG {
+
+// Motion estimation backend interface
+class MotionEstimator {
+public:
+    MotionEstimator() = default;
+    virtual ~MotionEstimator() = default;
+
+    // Disable copy
+    MotionEstimator(const MotionEstimator&) = delete;
+    MotionEstimator& operator=(const MotionEstimator&) = delete;
+
+    // Short backend name for stats and logs
+    virtual const char* GetName() const = 0;
+
+    // Re-create the size-dependent resources for a new frame size without a
+    // full re-initialization. No work using the old resources may still be
+    // pending. Backends that cannot return false and need Initialize().
+    virtual bool Resize(uint32_t width, uint32_t height) { (void)width; (void)height; return false; }
+
+    // Record motion estimation from previousFrame to currentFrame. Both
+    // frames are read as NON_PIXEL_SHADER_RESOURCE (COMMON textures are
+    // promoted implicitly). Backends that keep their own frame history may
+    // only use previousFrame to detect a missing frame.
+    virtual bool Dispatch(ID3D12Resource* currentFrame,
+                          ID3D12Resource* previousFrame,
+                          ID3D12GraphicsCommandList* commandList) = 0;
+
+    // Per-block R16G16_SINT motion vectors, in units of GetMotionVectorScale()
+    // pixels. Rest in the backend's configured read state between dispatches.
+    virtual ID3D12Resource* GetMotionVectorTexture() const = 0;
+
+    // Pixels per motion vector unit (FrameInterpolationConfig::motionVectorScale)
+    virtual float GetMotionVectorScale() const = 0;
+
+    // Dense R16G16_FLOAT field in pixels, or nullptr if the backend has none
+    virtual ID3D12Resource* GetMotionField() const { return nullptr; }
+
+    // Scene cut predicate written by the last Dispatch(): a 64-bit value at
+    // SCENE_PREDICATE_OFFSET, non-zero on a cut. For SetPredication() later in
+    // the same command list; rests in PREDICATION state. nullptr if the
+    // backend does not detect scene cuts.
+    static const UINT64 SCENE_PREDICATE_OFFSET = 8;
+    virtual ID3D12Resource* GetSceneChangePredicate() const = 0;
+
+    // Motion vector dimensions (blocks)
+    virtual uint32_t GetMotionVectorWidth() const = 0;
+    virtual uint32_t GetMotionVectorHeight() const = 0;
+
+    // GPU time of the last dispatch that has been read back (0 until
+    // SetTimestampFrequency() has been called)
+    virtual double GetLastGpuTimeMs() const = 0;
+
+    // Set GPU timestamp frequency (call with command queue before first dispatch)
+    virtual void SetTimestampFrequency(ID3D12CommandQueue* cmdQueue) = 0;
+
+    // Get last error
+    virtual const std::string& GetLastError() const = 0;
+};
+
+} // namespace OSFG
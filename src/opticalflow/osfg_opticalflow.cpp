@@ -4,15 +4,19 @@
 
 #include "osfg_opticalflow.h"
 
-// FidelityFX SDK includes
+// FidelityFX SDK includes (only when the SDK libraries are linked)
+#ifdef OSFG_HAS_FFX_OPTICALFLOW
 #define FFX_CPU
 #include "../../external/FidelityFX-SDK/Kits/FidelityFX/api/include/ffx_api_types.h"
 #include "../../external/FidelityFX-SDK/Kits/FidelityFX/api/internal/ffx_internal_types.h"
 #include "../../external/FidelityFX-SDK/Kits/FidelityFX/framegeneration/fsr3/include/ffx_opticalflow.h"
 #include "../../external/FidelityFX-SDK/Kits/FidelityFX/backend/dx12/ffx_dx12.h"
+#endif
 
 #include <chrono>
 #include <cassert>
+#include <cstring>
+#include <utility>
 
 namespace OSFG {
 
@@ -22,17 +26,33 @@ static constexpr size_t FFX_OPTICAL_FLOW_CONTEXT_COUNT = 1;
 // Block size used by optical flow (hardcoded in FSR 3)
 static constexpr uint32_t OPTICAL_FLOW_BLOCK_SIZE = 8;
 
-OpticalFlow::OpticalFlow()
-    : m_output{}
-    , m_stats{}
-{
-}
+// Scene change texture: 3 R32_UINT texels, the third is the detection
+// result. Copied as one row to the start of the predicate buffer it lands
+// at byte 8 with zeroes above it - the common 64-bit predicate layout.
+static constexpr uint32_t SCD_TEXELS = 3;
+static_assert(2 * sizeof(uint32_t) == MotionEstimator::SCENE_PREDICATE_OFFSET,
+              "Scene change result must land at SCENE_PREDICATE_OFFSET");
+
+// Readback: start/end timestamps, then the SCD row at a placement-aligned offset
+static constexpr UINT64 READBACK_SCD_OFFSET = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+static constexpr UINT64 READBACK_SIZE = READBACK_SCD_OFFSET + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+
+OpticalFlow::OpticalFlow() = default;
 
 OpticalFlow::~OpticalFlow()
 {
     Shutdown();
 }
 
+bool OpticalFlow::IsAvailable()
+{
+#ifdef OSFG_HAS_FFX_OPTICALFLOW
+    return true;
+#else
+    return false;
+#endif
+}
+
 void OpticalFlow::GetMotionVectorSize(uint32_t inputWidth, uint32_t inputHeight,
                                       uint32_t& outWidth, uint32_t& outHeight)
 {
@@ -48,10 +68,15 @@ bool OpticalFlow::Initialize(ID3D12Device* device,
         Shutdown();
     }
 
-    if (!device || !commandQueue) {
+    if (!device) {
+        m_lastError = "Invalid device";
         return false;
     }
 
+#ifndef OSFG_HAS_FFX_OPTICALFLOW
+    m_lastError = "FidelityFX optical flow not built (configure with OSFG_FFX_OPTICALFLOW=ON)";
+    return false;
+#else
     m_device = device;
     m_commandQueue = commandQueue;
     m_config = config;
@@ -59,25 +84,21 @@ bool OpticalFlow::Initialize(ID3D12Device* device,
     // Reset stats
     m_stats = {};
     m_frameIndex = 0;
+    m_resetPending = true;
 
     // Get scratch memory size for DX12 backend
     m_scratchBufferSize = ffxGetScratchMemorySizeDX12(FFX_OPTICAL_FLOW_CONTEXT_COUNT);
     if (m_scratchBufferSize == 0) {
+        m_lastError = "Failed to get FidelityFX scratch memory size";
         return false;
     }
 
     // Allocate scratch buffer
     m_scratchBuffer = std::make_unique<uint8_t[]>(m_scratchBufferSize);
-    if (!m_scratchBuffer) {
-        return false;
-    }
     memset(m_scratchBuffer.get(), 0, m_scratchBufferSize);
 
     // Allocate FfxInterface
     m_ffxInterface = new FfxInterface();
-    if (!m_ffxInterface) {
-        return false;
-    }
     memset(m_ffxInterface, 0, sizeof(FfxInterface));
 
     // Get DX12 device handle for FidelityFX
@@ -93,8 +114,8 @@ bool OpticalFlow::Initialize(ID3D12Device* device,
     );
 
     if (result != FFX_OK) {
-        delete m_ffxInterface;
-        m_ffxInterface = nullptr;
+        m_lastError = "Failed to create FidelityFX DX12 backend interface";
+        Shutdown();
         return false;
     }
 
@@ -110,8 +131,11 @@ bool OpticalFlow::Initialize(ID3D12Device* device,
         return false;
     }
 
+    SetTimestampFrequency(commandQueue);
+
     m_initialized = true;
     return true;
+#endif
 }
 
 void OpticalFlow::Shutdown()
@@ -158,19 +182,20 @@ bool OpticalFlow::CreateResources()
         &heapProps,
         D3D12_HEAP_FLAG_NONE,
         &mvDesc,
-        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+        m_config.vectorReadState,
         nullptr,
         IID_PPV_ARGS(&m_motionVectorTexture)
     );
 
     if (FAILED(hr)) {
+        m_lastError = "Failed to create motion vector texture";
         return false;
     }
 
     // Create scene change detection texture (R32_UINT, 3x1)
     D3D12_RESOURCE_DESC scdDesc = {};
     scdDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    scdDesc.Width = 3;
+    scdDesc.Width = SCD_TEXELS;
     scdDesc.Height = 1;
     scdDesc.DepthOrArraySize = 1;
     scdDesc.MipLevels = 1;
@@ -188,16 +213,60 @@ bool OpticalFlow::CreateResources()
     );
 
     if (FAILED(hr)) {
-        m_motionVectorTexture.Reset();
+        m_lastError = "Failed to create scene change texture";
+        DestroyResources();
         return false;
     }
 
+    // Predicate buffer (zero-initialized: no cut). One pitch-aligned row.
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    hr = m_device->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+        D3D12_RESOURCE_STATE_PREDICATION, nullptr,
+        IID_PPV_ARGS(&m_scenePredicate));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create scene predicate buffer";
+        DestroyResources();
+        return false;
+    }
+
+    // GPU timestamps and the SCD readback are optional
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = 2;
+    if (FAILED(m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_timestampQueryHeap)))) {
+        m_timestampQueryHeap.Reset();
+    }
+
+    D3D12_HEAP_PROPERTIES readbackHeap = {};
+    readbackHeap.Type = D3D12_HEAP_TYPE_READBACK;
+    bufferDesc.Width = READBACK_SIZE;
+    if (FAILED(m_device->CreateCommittedResource(
+            &readbackHeap, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+            IID_PPV_ARGS(&m_readbackBuffer)))) {
+        m_readbackBuffer.Reset();
+    }
+
+    D3D12_RESOURCE_DESC descs[] = { mvDesc, scdDesc };
+    m_stats.gpuMemoryUsageBytes = static_cast<size_t>(
+        m_device->GetResourceAllocationInfo(0, 2, descs).SizeInBytes + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+
     // Update output structure
     m_output.motionVectors = m_motionVectorTexture.Get();
     m_output.sceneChangeData = m_sceneChangeTexture.Get();
+    m_output.scenePredicate = m_scenePredicate.Get();
     m_output.motionVectorWidth = mvWidth;
     m_output.motionVectorHeight = mvHeight;
-    m_output.sceneChangeDetected = false;
 
     return true;
 }
@@ -206,20 +275,29 @@ void OpticalFlow::DestroyResources()
 {
     m_motionVectorTexture.Reset();
     m_sceneChangeTexture.Reset();
+    m_scenePredicate.Reset();
+    m_timestampQueryHeap.Reset();
+    m_readbackBuffer.Reset();
+    m_gpuTimestampFrequency = 0;
     m_output = {};
 }
 
+void OpticalFlow::SetTimestampFrequency(ID3D12CommandQueue* cmdQueue)
+{
+    if (cmdQueue && m_timestampQueryHeap) {
+        cmdQueue->GetTimestampFrequency(&m_gpuTimestampFrequency);
+    }
+}
+
 bool OpticalFlow::CreateFfxContext()
 {
+#ifdef OSFG_HAS_FFX_OPTICALFLOW
     if (!m_ffxInterface) {
         return false;
     }
 
     // Allocate context structure (fixed size defined by FFX_OPTICALFLOW_CONTEXT_SIZE)
     m_ffxContext = new FfxOpticalflowContext();
-    if (!m_ffxContext) {
-        return false;
-    }
     memset(m_ffxContext, 0, sizeof(FfxOpticalflowContext));
 
     // Set up context description
@@ -232,21 +310,74 @@ bool OpticalFlow::CreateFfxContext()
     // Create the optical flow context
     FfxErrorCode result = ffxOpticalflowContextCreate(m_ffxContext, &contextDesc);
     if (result != FFX_OK) {
+        m_lastError = "Failed to create FidelityFX optical flow context";
         delete m_ffxContext;
         m_ffxContext = nullptr;
         return false;
     }
 
     return true;
+#else
+    return false;
+#endif
 }
 
 void OpticalFlow::DestroyFfxContext()
 {
+#ifdef OSFG_HAS_FFX_OPTICALFLOW
     if (m_ffxContext) {
         ffxOpticalflowContextDestroy(m_ffxContext);
         delete m_ffxContext;
         m_ffxContext = nullptr;
     }
+#endif
+}
+
+void OpticalFlow::ReadBack()
+{
+    // Read back an earlier dispatch's timestamps and scene change result
+    // (stats only: the list that wrote them may still be in flight)
+    if (!m_readbackBuffer || m_stats.totalFramesProcessed == 0) {
+        return;
+    }
+
+    D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(READBACK_SIZE) };
+    uint8_t* data = nullptr;
+    if (FAILED(m_readbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&data)))) {
+        return;
+    }
+
+    uint64_t timestamps[2];
+    memcpy(timestamps, data, sizeof(timestamps));
+    uint32_t sceneChange = 0;
+    memcpy(&sceneChange, data + READBACK_SCD_OFFSET + MotionEstimator::SCENE_PREDICATE_OFFSET,
+           sizeof(sceneChange));
+
+    D3D12_RANGE writeRange = { 0, 0 };
+    m_readbackBuffer->Unmap(0, &writeRange);
+
+    if (sceneChange != 0) {
+        m_stats.sceneChanges++;
+    }
+
+    if (m_gpuTimestampFrequency > 0 && timestamps[1] > timestamps[0]) {
+        double gpuTimeMs = (double)(timestamps[1] - timestamps[0]) * 1000.0 / (double)m_gpuTimestampFrequency;
+        m_stats.lastGpuTimeMs = gpuTimeMs;
+
+        const double alpha = 0.1;
+        if (m_stats.totalFramesProcessed == 1) {
+            m_stats.avgGpuTimeMs = gpuTimeMs;
+        } else {
+            m_stats.avgGpuTimeMs = alpha * gpuTimeMs + (1.0 - alpha) * m_stats.avgGpuTimeMs;
+        }
+    }
+}
+
+bool OpticalFlow::Dispatch(ID3D12Resource* currentFrame,
+                           ID3D12Resource* previousFrame,
+                           ID3D12GraphicsCommandList* commandList)
+{
+    return Dispatch(currentFrame, commandList, previousFrame == nullptr);
 }
 
 bool OpticalFlow::Dispatch(ID3D12Resource* inputTexture,
@@ -254,11 +385,15 @@ bool OpticalFlow::Dispatch(ID3D12Resource* inputTexture,
                            bool reset)
 {
     if (!m_initialized || !inputTexture || !commandList) {
+        m_lastError = "Invalid parameters or not initialized";
         return false;
     }
 
+#ifdef OSFG_HAS_FFX_OPTICALFLOW
     auto startTime = std::chrono::high_resolution_clock::now();
 
+    ReadBack();
+
     // Get input resource description
     FfxApiResourceDescription inputDesc = ffxGetResourceDescriptionDX12(
         inputTexture,
@@ -306,18 +441,84 @@ bool OpticalFlow::Dispatch(ID3D12Resource* inputTexture,
     dispatchDesc.color = ffxInput;
     dispatchDesc.opticalFlowVector = ffxMotionVectors;
     dispatchDesc.opticalFlowSCD = ffxSceneChange;
-    dispatchDesc.reset = reset || (m_frameIndex == 0);
+    dispatchDesc.reset = reset || m_resetPending || (m_frameIndex == 0);
     dispatchDesc.backbufferTransferFunction = m_config.enableHDR ?
         FFX_API_BACKBUFFER_TRANSFER_FUNCTION_PQ :
         FFX_API_BACKBUFFER_TRANSFER_FUNCTION_SRGB;
     dispatchDesc.minMaxLuminance = { 0.0f, 1.0f };
 
+    // The context writes the vectors as a UAV
+    D3D12_RESOURCE_BARRIER barriers[3] = {};
+    auto transition = [](D3D12_RESOURCE_BARRIER& barrier, ID3D12Resource* resource,
+                         D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = resource;
+        barrier.Transition.StateBefore = before;
+        barrier.Transition.StateAfter = after;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    };
+    transition(barriers[0], m_motionVectorTexture.Get(), m_config.vectorReadState,
+               D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+    commandList->ResourceBarrier(1, barriers);
+
+    if (m_timestampQueryHeap) {
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
+    }
+
     // Dispatch optical flow
     FfxErrorCode result = ffxOpticalflowContextDispatch(m_ffxContext, &dispatchDesc);
     if (result != FFX_OK) {
+        // Return the vectors to their resting state so the list stays valid
+        std::swap(barriers[0].Transition.StateBefore, barriers[0].Transition.StateAfter);
+        commandList->ResourceBarrier(1, barriers);
+        m_lastError = "FidelityFX optical flow dispatch failed";
         return false;
     }
 
+    // sceneChangeDetected becomes the same 64-bit predicate SimpleOpticalFlow
+    // writes: copy the SCD row to the start of the predicate buffer
+    transition(barriers[0], m_motionVectorTexture.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+               m_config.vectorReadState);
+    transition(barriers[1], m_sceneChangeTexture.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+               D3D12_RESOURCE_STATE_COPY_SOURCE);
+    transition(barriers[2], m_scenePredicate.Get(), D3D12_RESOURCE_STATE_PREDICATION,
+               D3D12_RESOURCE_STATE_COPY_DEST);
+    commandList->ResourceBarrier(3, barriers);
+
+    D3D12_TEXTURE_COPY_LOCATION src = {};
+    src.pResource = m_sceneChangeTexture.Get();
+    src.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    src.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION dst = {};
+    dst.pResource = m_scenePredicate.Get();
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    dst.PlacedFootprint.Offset = 0;
+    dst.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R32_UINT;
+    dst.PlacedFootprint.Footprint.Width = SCD_TEXELS;
+    dst.PlacedFootprint.Footprint.Height = 1;
+    dst.PlacedFootprint.Footprint.Depth = 1;
+    dst.PlacedFootprint.Footprint.RowPitch = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+    commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+    if (m_readbackBuffer) {
+        dst.pResource = m_readbackBuffer.Get();
+        dst.PlacedFootprint.Offset = READBACK_SCD_OFFSET;
+        commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    }
+
+    std::swap(barriers[1].Transition.StateBefore, barriers[1].Transition.StateAfter);
+    std::swap(barriers[2].Transition.StateBefore, barriers[2].Transition.StateAfter);
+    commandList->ResourceBarrier(2, barriers + 1);
+
+    if (m_timestampQueryHeap) {
+        commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
+        if (m_readbackBuffer) {
+            commandList->ResolveQueryData(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+                                          0, 2, m_readbackBuffer.Get(), 0);
+        }
+    }
+
     // Update timing statistics
     auto endTime = std::chrono::high_resolution_clock::now();
     double dispatchTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
@@ -333,8 +534,14 @@ bool OpticalFlow::Dispatch(ID3D12Resource* inputTexture,
         m_stats.avgDispatchTimeMs = alpha * dispatchTimeMs + (1.0 - alpha) * m_stats.avgDispatchTimeMs;
     }
 
+    m_resetPending = false;
     m_frameIndex++;
     return true;
+#else
+    (void)reset;
+    m_lastError = "FidelityFX optical flow not built";
+    return false;
+#endif
 }
 
 } // namespace OSFG
@@ -1,5 +1,11 @@
 // OSFG Optical Flow Module
 // Wraps AMD FidelityFX FSR 3 Optical Flow for standalone use
+//
+// The standalone optical flow context is not exported by the signed
+// FidelityFX DLLs; it needs the SDK's backend and optical flow libraries
+// built from source (CMake option OSFG_FFX_OPTICALFLOW). Without them
+// IsAvailable() is false and the pipeline keeps SimpleOpticalFlow.
+//
 // MIT License - Part of Open Source Frame Generation project
 
 #pragma once
@@ -16,6 +22,9 @@
 #include <wrl/client.h>
 #include <cstdint>
 #include <memory>
+#include <string>
+
+#include "opticalflow/motion_estimator.h"
 
 // Forward declarations for FidelityFX types
 struct FfxInterface;
@@ -29,35 +38,48 @@ struct OpticalFlowConfig {
     uint32_t height = 1080;          // Input resolution height
     bool enableHDR = false;          // HDR input support
     bool enableFP16 = true;          // Use FP16 where possible
+
+    // Resting state of the motion vectors between dispatches. Use
+    // NON_PIXEL_SHADER_RESOURCE alone when Dispatch() is recorded on COMPUTE
+    // command lists, which cannot transition pixel shader states.
+    D3D12_RESOURCE_STATES vectorReadState =
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
 };
 
 // Output from optical flow dispatch
 struct OpticalFlowOutput {
-    ID3D12Resource* motionVectors;   // R16G16_SINT motion vector texture
-    ID3D12Resource* sceneChangeData; // Scene change detection output
-    uint32_t motionVectorWidth;      // Motion vector texture width (input/8)
-    uint32_t motionVectorHeight;     // Motion vector texture height (input/8)
-    bool sceneChangeDetected;        // True if significant scene change
+    ID3D12Resource* motionVectors = nullptr;   // R16G16_SINT motion vector texture (pixels)
+    ID3D12Resource* sceneChangeData = nullptr; // 3x1 R32_UINT scene change detection output
+    ID3D12Resource* scenePredicate = nullptr;  // sceneChangeDetected as a GPU predicate
+    uint32_t motionVectorWidth = 0;            // Motion vector texture width (input/8)
+    uint32_t motionVectorHeight = 0;           // Motion vector texture height (input/8)
 };
 
 // Statistics for performance monitoring
 struct OpticalFlowStats {
-    double lastDispatchTimeMs;       // Time for last dispatch
-    double avgDispatchTimeMs;        // Rolling average dispatch time
-    uint64_t totalFramesProcessed;   // Total frames processed
-    uint64_t sceneChanges;           // Number of detected scene changes
+    double lastDispatchTimeMs = 0.0; // CPU time to record the last dispatch
+    double avgDispatchTimeMs = 0.0;  // Rolling average dispatch time
+    double lastGpuTimeMs = 0.0;      // GPU timestamp timing
+    double avgGpuTimeMs = 0.0;
+    uint64_t totalFramesProcessed = 0;   // Total frames processed
+    uint64_t sceneChanges = 0;           // Detected scene changes (read back a frame late)
+    size_t gpuMemoryUsageBytes = 0;      // Output and predicate resources
 };
 
-class OpticalFlow {
+class OpticalFlow final : public MotionEstimator {
 public:
     OpticalFlow();
-    ~OpticalFlow();
+    ~OpticalFlow() override;
 
     // Non-copyable
     OpticalFlow(const OpticalFlow&) = delete;
     OpticalFlow& operator=(const OpticalFlow&) = delete;
 
-    // Initialize optical flow with DX12 device and command queue
+    // True if this build links the FidelityFX optical flow libraries
+    static bool IsAvailable();
+
+    // Initialize optical flow with DX12 device and command queue (the queue
+    // the dispatches execute on, for GPU timing; may be null)
     // Returns true on success
     bool Initialize(ID3D12Device* device,
                    ID3D12CommandQueue* commandQueue,
@@ -69,19 +91,47 @@ public:
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
+    const char* GetName() const override { return "FidelityFX"; }
+
     // Process a frame and compute optical flow
     // inputTexture: The current frame (RGBA format recommended)
     // commandList: A command list to record compute work
+    // reset: Restart the flow history (scene cut, frames skipped)
     // Returns true on success
     bool Dispatch(ID3D12Resource* inputTexture,
                   ID3D12GraphicsCommandList* commandList,
                   bool reset = false);
 
+    // MotionEstimator dispatch. The context keeps the previous frame itself;
+    // a null previousFrame resets the history.
+    bool Dispatch(ID3D12Resource* currentFrame,
+                  ID3D12Resource* previousFrame,
+                  ID3D12GraphicsCommandList* commandList) override;
+
+    // Restart the flow history on the next dispatch
+    void Reset() { m_resetPending = true; }
+
     // Get the optical flow output after dispatch
     const OpticalFlowOutput& GetOutput() const { return m_output; }
 
+    // MotionEstimator outputs. Vectors are whole pixels and rest in
+    // config.vectorReadState; the scene change texture stays in UNORDERED_ACCESS.
+    ID3D12Resource* GetMotionVectorTexture() const override { return m_motionVectorTexture.Get(); }
+    float GetMotionVectorScale() const override { return 1.0f; }
+    ID3D12Resource* GetSceneChangeTexture() const { return m_sceneChangeTexture.Get(); }
+    ID3D12Resource* GetSceneChangePredicate() const override { return m_scenePredicate.Get(); }
+    uint32_t GetMotionVectorWidth() const override { return m_output.motionVectorWidth; }
+    uint32_t GetMotionVectorHeight() const override { return m_output.motionVectorHeight; }
+
     // Get performance statistics
     const OpticalFlowStats& GetStats() const { return m_stats; }
+    double GetLastGpuTimeMs() const override { return m_stats.lastGpuTimeMs; }
+
+    // Set GPU timestamp frequency (Initialize() already uses its queue)
+    void SetTimestampFrequency(ID3D12CommandQueue* cmdQueue) override;
+
+    // Get last error
+    const std::string& GetLastError() const override { return m_lastError; }
 
     // Get required motion vector texture size for given input resolution
     static void GetMotionVectorSize(uint32_t inputWidth, uint32_t inputHeight,
@@ -95,6 +145,7 @@ private:
     void DestroyResources();
     bool CreateFfxContext();
     void DestroyFfxContext();
+    void ReadBack();
 
     // DX12 objects
     Microsoft::WRL::ComPtr<ID3D12Device> m_device;
@@ -103,6 +154,12 @@ private:
     // Output resources (owned by this class)
     Microsoft::WRL::ComPtr<ID3D12Resource> m_motionVectorTexture;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_sceneChangeTexture;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_scenePredicate;   // SCD row copied to offset 0
+
+    // GPU timing and scene change readback: timestamps, then the SCD row
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_timestampQueryHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_readbackBuffer;
+    uint64_t m_gpuTimestampFrequency = 0;
 
     // FidelityFX interface and context
     std::unique_ptr<uint8_t[]> m_scratchBuffer;
@@ -112,9 +169,11 @@ private:
 
     // State
     bool m_initialized = false;
+    bool m_resetPending = true;
     OpticalFlowConfig m_config;
     OpticalFlowOutput m_output;
     OpticalFlowStats m_stats;
+    std::string m_lastError;
 
     // Frame tracking
     uint32_t m_frameIndex = 0;
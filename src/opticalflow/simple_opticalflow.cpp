@@ -3,11 +3,18 @@
 // MIT License - Part of Open Source Frame Generation project
 
 #include "simple_opticalflow.h"
+#include "common/precompiled_shader.h"
+#include <dxcapi.h>
+#include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <iterator>
+#include <string>
 
 // Fully Parallel Optical Flow Shader
-// All 64 threads participate in the search - much faster than single-threaded
+// One thread per block pixel; all threads participate in the search.
+// Compiled once per (BLOCK_SIZE, SEARCH_RADIUS) pair, so the window size and
+// every trip count are constants and the SAD loops unroll completely.
 static const char* g_OpticalFlowShaderSource = R"(
 // Input textures
 Texture2D<float4> g_CurrentFrame : register(t0);
@@ -16,7 +23,7 @@ Texture2D<float4> g_PreviousFrame : register(t1);
 // Output texture (motion vectors)
 RWTexture2D<int2> g_MotionVectors : register(u0);
 
-// Constants
+// Constants (block size and search radius are compiled in)
 cbuffer OpticalFlowConstants : register(b0)
 {
     uint2 g_InputSize;
@@ -27,10 +34,20 @@ cbuffer OpticalFlowConstants : register(b0)
     float g_MaxLuminance;
 };
 
-#define TILE_SIZE 8
-#define MAX_SEARCH 8
-#define SHARED_SIZE (TILE_SIZE + MAX_SEARCH * 2)
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 8
+#endif
+#ifndef SEARCH_RADIUS
+#define SEARCH_RADIUS 8
+#endif
+
+#define TILE_SIZE BLOCK_SIZE
+#define SEARCH_DIAMETER (SEARCH_RADIUS * 2 + 1)
+#define SEARCH_POSITIONS (SEARCH_DIAMETER * SEARCH_DIAMETER)
+#define SHARED_SIZE (TILE_SIZE + SEARCH_RADIUS * 2)
 #define NUM_THREADS (TILE_SIZE * TILE_SIZE)
+#define PIXELS_PER_THREAD ((SHARED_SIZE * SHARED_SIZE + NUM_THREADS - 1) / NUM_THREADS)
+#define POSITIONS_PER_THREAD ((SEARCH_POSITIONS + NUM_THREADS - 1) / NUM_THREADS)
 
 // Shared memory
 groupshared float s_CurrentLum[TILE_SIZE][TILE_SIZE];
@@ -38,10 +55,19 @@ groupshared float s_PreviousLum[SHARED_SIZE][SHARED_SIZE];
 groupshared float s_SAD[NUM_THREADS];
 groupshared int2 s_Offset[NUM_THREADS];
 
+#ifdef PQ_INPUT
+// HDR10 frames: luma of the PQ-coded BT.2020 values, which are perceptually
+// uniform like gamma-coded SDR, scaled so 203-nit reference white is 1.0
+float RGBToLuminance(float3 color)
+{
+    return dot(color, float3(0.2627, 0.6780, 0.0593)) * (1.0 / 0.58);
+}
+#else
 float RGBToLuminance(float3 color)
 {
     return dot(color, float3(0.2126, 0.7152, 0.0722));
 }
+#endif
 
 [numthreads(TILE_SIZE, TILE_SIZE, 1)]
 void CSMain(uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID)
@@ -53,11 +79,6 @@ void CSMain(uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID)
     if (groupId.x >= g_OutputSize.x || groupId.y >= g_OutputSize.y)
         return;
 
-    int searchRadius = min((int)g_SearchRadius, MAX_SEARCH);
-    int searchDiameter = searchRadius * 2 + 1;
-    int totalSearchPositions = searchDiameter * searchDiameter;
-    int sharedSize = TILE_SIZE + searchRadius * 2;
-
     // Load current block into shared memory
     {
         int2 pixelPos = blockPos + localId;
@@ -66,9 +87,438 @@ void CSMain(uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID)
     }
 
     // Load previous frame search region into shared memory
+    [unroll]
+    for (int i = 0; i < PIXELS_PER_THREAD; i++)
+    {
+        int pixelIdx = localIdx + i * NUM_THREADS;
+        if (pixelIdx < SHARED_SIZE * SHARED_SIZE)
+        {
+            int sy = pixelIdx / SHARED_SIZE;
+            int sx = pixelIdx % SHARED_SIZE;
+            int2 pixelPos = blockPos + int2(sx, sy) - int2(SEARCH_RADIUS, SEARCH_RADIUS);
+            pixelPos = clamp(pixelPos, int2(0, 0), int2(g_InputSize) - 1);
+            s_PreviousLum[sy][sx] = RGBToLuminance(g_PreviousFrame[pixelPos].rgb);
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Each thread evaluates POSITIONS_PER_THREAD search positions
+    float bestSAD = 1e10;
+    int2 bestOffset = int2(0, 0);
+
+    [unroll]
+    for (int p = 0; p < POSITIONS_PER_THREAD; p++)
+    {
+        int searchIdx = localIdx + p * NUM_THREADS;
+        if (searchIdx < SEARCH_POSITIONS)
+        {
+            int oy = (searchIdx / SEARCH_DIAMETER) - SEARCH_RADIUS;
+            int ox = (searchIdx % SEARCH_DIAMETER) - SEARCH_RADIUS;
+
+            // SAD for this offset, accumulated one row at a time
+            float sad = 0.0;
+
+            [unroll]
+            for (int y = 0; y < TILE_SIZE; y++)
+            {
+                float rowSAD = 0.0;
+
+                [unroll]
+                for (int x = 0; x < TILE_SIZE; x++)
+                {
+                    rowSAD += abs(s_CurrentLum[y][x] - s_PreviousLum[SEARCH_RADIUS + oy + y][SEARCH_RADIUS + ox + x]);
+                }
+                sad += rowSAD;
+            }
+
+            if (sad < bestSAD)
+            {
+                bestSAD = sad;
+                bestOffset = int2(ox, oy);
+            }
+        }
+    }
+
+    // Store this thread's best result
+    s_SAD[localIdx] = bestSAD;
+    s_Offset[localIdx] = bestOffset;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // Parallel reduction to find global minimum
+    for (int stride = NUM_THREADS / 2; stride > 0; stride >>= 1)
+    {
+        if (localIdx < stride)
+        {
+            if (s_SAD[localIdx + stride] < s_SAD[localIdx])
+            {
+                s_SAD[localIdx] = s_SAD[localIdx + stride];
+                s_Offset[localIdx] = s_Offset[localIdx + stride];
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // Thread 0 writes the final result
+    if (localIdx == 0)
+    {
+        g_MotionVectors[groupId.xy] = s_Offset[0] * 16;
+    }
+}
+)";
+
+// Luminance / pyramid (coarse-to-fine) optical flow shaders
+// CSLuminance converts the RGB frames into level 0 luminance once per frame;
+// CSDownsample and CSMatch then only read R16_FLOAT luminance (LUMA_INPUT).
+// Each level searches a small radius around the doubled vector of its parent
+// block one level up.
+static const char* g_PyramidFlowShaderSource = R"(
+cbuffer PyramidConstants : register(b0)
+{
+    uint2 g_SrcSize;       // Source texture size at this level
+    uint2 g_DstSize;       // Downsample: output size. Match: vector grid size
+    uint  g_SearchRadius;
+    uint  g_SeedFlags;     // Match: bit 0 = seed from the coarser level's vectors (t2),
+                           //        bit 1 = pick the centre from predictors (t3),
+                           //        bit 2 = count unmatched blocks for scene detection (u2)
+    uint  g_Mask;          // Luminance/downsample: bit 0 = current (t0 -> u0), bit 1 = previous (t1 -> u1)
+    uint  g_OutputScale;   // Match: 16 at level 0 (1/16 pixel units), 1 for inner levels.
+                           // Luminance / motion field: frame pixels per level 0 pixel
+    float g_SceneThreshold; // Scene decide: fraction of unmatched blocks that is a cut (0 = off)
+};
+
+#ifdef PQ_INPUT
+// HDR10 frames: luma of the PQ-coded BT.2020 values, which are perceptually
+// uniform like gamma-coded SDR, scaled so 203-nit reference white is 1.0
+float RGBToLuminance(float3 color)
+{
+    return dot(color, float3(0.2627, 0.6780, 0.0593)) * (1.0 / 0.58);
+}
+#else
+float RGBToLuminance(float3 color)
+{
+    return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+#endif
+
+#if defined(MOTION_FIELD)
+// Block vectors and confidence are declared below instead of frames
+#elif defined(LUMA_INPUT)
+Texture2D<float> g_CurrentLuma : register(t0);
+Texture2D<float> g_PreviousLuma : register(t1);
+float LoadCurrent(int2 p)  { return g_CurrentLuma[p]; }
+float LoadPrevious(int2 p) { return g_PreviousLuma[p]; }
+#else
+Texture2D<float4> g_CurrentFrame : register(t0);
+Texture2D<float4> g_PreviousFrame : register(t1);
+float LoadCurrent(int2 p)  { return RGBToLuminance(g_CurrentFrame[p].rgb); }
+float LoadPrevious(int2 p) { return RGBToLuminance(g_PreviousFrame[p].rgb); }
+#endif
+
+#ifdef DOWNSAMPLE
+
+RWTexture2D<float> g_CurrentOut : register(u0);
+RWTexture2D<float> g_PreviousOut : register(u1);
+
+// RGB frame -> level 0 luminance, box-filtered over g_OutputScale^2 frame
+// pixels (g_SrcSize is the frame)
+[numthreads(8, 8, 1)]
+void CSLuminance(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= g_DstSize.x || id.y >= g_DstSize.y)
+        return;
+
+    if (g_OutputScale <= 1)
+    {
+        if (g_Mask & 1)
+            g_CurrentOut[id.xy] = LoadCurrent(int2(id.xy));
+        if (g_Mask & 2)
+            g_PreviousOut[id.xy] = LoadPrevious(int2(id.xy));
+        return;
+    }
+
+    int2 origin = int2(id.xy * g_OutputScale);
+    int2 maxP = int2(g_SrcSize) - 1;
+    float current = 0.0;
+    float previous = 0.0;
+    for (uint y = 0; y < g_OutputScale; y++)
+    {
+        for (uint x = 0; x < g_OutputScale; x++)
+        {
+            int2 p = min(origin + int2(x, y), maxP);
+            if (g_Mask & 1)
+                current += LoadCurrent(p);
+            if (g_Mask & 2)
+                previous += LoadPrevious(p);
+        }
+    }
+
+    float norm = 1.0 / float(g_OutputScale * g_OutputScale);
+    if (g_Mask & 1)
+        g_CurrentOut[id.xy] = current * norm;
+    if (g_Mask & 2)
+        g_PreviousOut[id.xy] = previous * norm;
+}
+
+// 2x2 box filter into the next pyramid level
+[numthreads(8, 8, 1)]
+void CSDownsample(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= g_DstSize.x || id.y >= g_DstSize.y)
+        return;
+
+    int2 p = int2(id.xy) * 2;
+    int2 maxP = int2(g_SrcSize) - 1;
+    int2 p00 = min(p, maxP);
+    int2 p10 = min(p + int2(1, 0), maxP);
+    int2 p01 = min(p + int2(0, 1), maxP);
+    int2 p11 = min(p + int2(1, 1), maxP);
+
+    if (g_Mask & 1)
+        g_CurrentOut[id.xy] = 0.25 * (LoadCurrent(p00) + LoadCurrent(p10) + LoadCurrent(p01) + LoadCurrent(p11));
+    if (g_Mask & 2)
+        g_PreviousOut[id.xy] = 0.25 * (LoadPrevious(p00) + LoadPrevious(p10) + LoadPrevious(p01) + LoadPrevious(p11));
+}
+
+
+#elif defined(MOTION_FIELD)
+
+Texture2D<int2> g_BlockVectors : register(t0);      // 1/16 level 0 pixel, one per 8x8 block
+Texture2D<float> g_BlockConfidence : register(t1);
+RWTexture2D<float2> g_MotionField : register(u0);   // Frame pixels (g_OutputScale per level 0 pixel)
+
+// Dense field from the block vectors: a 3x3 tent over the nearest blocks,
+// weighted by match confidence so ambiguous blocks borrow from their
+// neighbours instead of tearing the warp at block edges
+[numthreads(8, 8, 1)]
+void CSMotionField(uint3 id : SV_DispatchThreadID)
+{
+    if (id.x >= g_DstSize.x || id.y >= g_DstSize.y)
+        return;
+
+    uint2 size;
+    g_BlockVectors.GetDimensions(size.x, size.y);
+
+    float2 framePos = (float2(id.xy) + 0.5) * float2(g_SrcSize) / float2(g_DstSize);
+    float2 blockPos = framePos / 8.0 - 0.5;
+    int2 centre = int2(round(blockPos));
+
+    float2 sum = float2(0.0, 0.0);
+    float weightSum = 0.0;
+
+    [unroll]
+    for (int dy = -1; dy <= 1; dy++)
+    {
+        [unroll]
+        for (int dx = -1; dx <= 1; dx++)
+        {
+            int2 block = centre + int2(dx, dy);
+            float2 d = abs(float2(block) - blockPos);
+            float w = saturate(1.0 - d.x / 1.5) * saturate(1.0 - d.y / 1.5);
+            block = clamp(block, int2(0, 0), int2(size) - 1);
+            w *= g_BlockConfidence[block] + 0.05;
+            sum += w * float2(g_BlockVectors[block]);
+            weightSum += w;
+        }
+    }
+
+    g_MotionField[id.xy] = sum / max(weightSum, 1e-6) / 16.0 * float(g_OutputScale);
+}
+
+#else
+
+Texture2D<int2> g_SeedVectors : register(t2);
+Texture2D<int2> g_TemporalVectors : register(t3);   // Previous frame's level 0 vectors (1/16 pixel)
+RWTexture2D<int2> g_MotionVectors : register(u0);
+RWTexture2D<float> g_Confidence : register(u1);      // Level 0: 1 - best / runner-up SAD
+
+// Scene detection (root UAV): [0] unmatched block count, [8] 64-bit cut
+// predicate (non-zero on a cut), [16] total cuts
+RWByteAddressBuffer g_SceneStats : register(u2);
+
+// A block whose best match still differs by more than 0.1 luminance per
+// pixel on average has no counterpart in the previous frame
+#define UNMATCHED_BLOCK_SAD (0.1 * 64)
+
+void CountSceneBlock(float bestSAD)
+{
+    if ((g_SeedFlags & 4) && bestSAD > UNMATCHED_BLOCK_SAD)
+    {
+        uint previousCount;
+        g_SceneStats.InterlockedAdd(0, 1, previousCount);
+    }
+}
+
+// Turn this dispatch's unmatched block count into the cut predicate and reset
+// the counter. g_DstSize is the level 0 block grid.
+[numthreads(1, 1, 1)]
+void CSSceneDecide()
+{
+    uint unmatched = g_SceneStats.Load(0);
+    uint blocks = g_DstSize.x * g_DstSize.y;
+    uint cut = (g_SceneThreshold > 0.0 && unmatched > (uint)(g_SceneThreshold * blocks)) ? 1 : 0;
+
+    g_SceneStats.Store(0, 0);
+    g_SceneStats.Store2(8, uint2(cut, 0));
+    g_SceneStats.Store(16, g_SceneStats.Load(16) + cut);
+}
+
+#define TILE_SIZE 8
+#define NUM_THREADS (TILE_SIZE * TILE_SIZE)
+
+// SEARCH_RADIUS builds a kernel for one radius: the window is sized to it
+// and the search loops have constant trip counts and unroll. Without it the
+// radius comes from g_SearchRadius (up to 8) and the loops stay dynamic.
+#ifdef SEARCH_RADIUS
+#define MAX_SEARCH SEARCH_RADIUS
+#define SEARCH_LOOP [unroll]
+#else
+#define MAX_SEARCH 8
+#define SEARCH_LOOP [loop]
+#endif
+#define SHARED_SIZE (TILE_SIZE + MAX_SEARCH * 2)
+
+groupshared float s_CurrentLum[TILE_SIZE][TILE_SIZE];
+groupshared float s_PreviousLum[SHARED_SIZE][SHARED_SIZE];
+#define NUM_PREDICTORS 8
+groupshared float s_PredictorSAD[NUM_PREDICTORS][TILE_SIZE];
+groupshared int2 s_Centre;
+
+// Previous frame's vector for a block, in whole pixels
+int2 TemporalVector(int2 block)
+{
+    uint2 size;
+    g_TemporalVectors.GetDimensions(size.x, size.y);
+    return (g_TemporalVectors[clamp(block, int2(0, 0), int2(size) - 1)] + 8) >> 4;
+}
+
+// Candidate centres, in tie-break order
+int2 Predictor(int index, int2 block, int2 seed)
+{
+    switch (index)
+    {
+    case 0:  return seed;
+    case 1:  return TemporalVector(block);
+    case 2:  return TemporalVector(block + int2(-1, 0));
+    case 3:  return TemporalVector(block + int2(1, 0));
+    case 4:  return TemporalVector(block + int2(0, -1));
+    case 5:  return TemporalVector(block + int2(0, 1));
+    case 6:  return (seed + TemporalVector(block)) / 2;
+    default: return int2(0, 0);
+    }
+}
+
+#ifdef WAVE_REDUCE
+// SM 6.0: (SAD bits | search index) keys reduced with WaveActiveMin, then
+// one InterlockedMin per wave. SADs are non-negative, so their float bits
+// order like the values; the low 12 mantissa bits make room for the index.
+groupshared uint s_BestKey;
+groupshared uint s_SecondKey;
+
+float KeySAD(uint key)
+{
+    return key == 0xFFFFFFFF ? 1e10 : asfloat(key & 0xFFFFF000);
+}
+#else
+groupshared float s_SAD[NUM_THREADS];
+groupshared float s_SecondSAD[NUM_THREADS];
+groupshared int2 s_Offset[NUM_THREADS];
+#endif
+
+// How much better the winner is than the runner-up (0 = ambiguous)
+float MatchConfidence(float best, float second)
+{
+    return saturate((second - best) / max(second, 1e-4));
+}
+
+[numthreads(TILE_SIZE, TILE_SIZE, 1)]
+void CSMatch(uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID)
+{
+    int2 blockPos = int2(groupId.xy) * TILE_SIZE;
+    int2 localId = int2(threadId.xy);
+    int localIdx = localId.y * TILE_SIZE + localId.x;
+
+    if (groupId.x >= g_DstSize.x || groupId.y >= g_DstSize.y)
+        return;
+
+    // Search centre: the parent block's vector, doubled to this level's scale
+    int2 seed = int2(0, 0);
+    if (g_SeedFlags & 1)
+    {
+        uint2 seedSize;
+        g_SeedVectors.GetDimensions(seedSize.x, seedSize.y);
+        seed = g_SeedVectors[min(groupId.xy / 2, seedSize - 1)] * 2;
+    }
+
+#ifdef SEARCH_RADIUS
+    const int searchRadius = SEARCH_RADIUS;
+#else
+    int searchRadius = min((int)g_SearchRadius, MAX_SEARCH);
+#endif
+    int searchDiameter = searchRadius * 2 + 1;
+    int totalSearchPositions = searchDiameter * searchDiameter;
+    int sharedSize = TILE_SIZE + searchRadius * 2;
+    int2 maxP = int2(g_SrcSize) - 1;
+
+    // Current block
+    s_CurrentLum[localId.y][localId.x] = LoadCurrent(clamp(blockPos + localId, int2(0, 0), maxP));
+#ifdef WAVE_REDUCE
+    if (localIdx == 0)
+    {
+        s_BestKey = 0xFFFFFFFF;
+        s_SecondKey = 0xFFFFFFFF;
+    }
+#endif
+
+    // Predictive search: one row of one candidate per thread, then the
+    // cheapest candidate becomes the window centre
+    if (g_SeedFlags & 2)
+    {
+        GroupMemoryBarrierWithGroupSync();
+
+        int candidate = localIdx / TILE_SIZE;
+        int row = localIdx % TILE_SIZE;
+        int2 origin = blockPos + Predictor(candidate, int2(groupId.xy), seed);
+        float rowSAD = 0.0;
+
+        [unroll]
+        for (int x = 0; x < TILE_SIZE; x++)
+        {
+            rowSAD += abs(s_CurrentLum[row][x] - LoadPrevious(clamp(origin + int2(x, row), int2(0, 0), maxP)));
+        }
+        s_PredictorSAD[candidate][row] = rowSAD;
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if (localIdx == 0)
+        {
+            float bestPredictorSAD = 1e10;
+            int bestPredictor = 0;
+            for (int c = 0; c < NUM_PREDICTORS; c++)
+            {
+                float sad = 0.0;
+                for (int y = 0; y < TILE_SIZE; y++)
+                    sad += s_PredictorSAD[c][y];
+                if (sad < bestPredictorSAD)
+                {
+                    bestPredictorSAD = sad;
+                    bestPredictor = c;
+                }
+            }
+            s_Centre = Predictor(bestPredictor, int2(groupId.xy), seed);
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+        seed = s_Centre;
+    }
+
+    // Previous frame search window around the seed
     int totalPrevPixels = sharedSize * sharedSize;
     int pixelsPerThread = (totalPrevPixels + NUM_THREADS - 1) / NUM_THREADS;
+    int2 windowOrigin = blockPos + seed - int2(searchRadius, searchRadius);
 
+    SEARCH_LOOP
     for (int i = 0; i < pixelsPerThread; i++)
     {
         int pixelIdx = localIdx + i * NUM_THREADS;
@@ -76,83 +526,155 @@ void CSMain(uint3 groupId : SV_GroupID, uint3 threadId : SV_GroupThreadID)
         {
             int sy = pixelIdx / sharedSize;
             int sx = pixelIdx % sharedSize;
-            int2 pixelPos = blockPos + int2(sx, sy) - int2(searchRadius, searchRadius);
-            pixelPos = clamp(pixelPos, int2(0, 0), int2(g_InputSize) - 1);
-            s_PreviousLum[sy][sx] = RGBToLuminance(g_PreviousFrame[pixelPos].rgb);
+            s_PreviousLum[sy][sx] = LoadPrevious(clamp(windowOrigin + int2(sx, sy), int2(0, 0), maxP));
         }
     }
 
     GroupMemoryBarrierWithGroupSync();
 
-    // Each thread evaluates multiple search positions
+#ifdef WAVE_REDUCE
+    uint bestKey = 0xFFFFFFFF;
+    uint secondKey = 0xFFFFFFFF;
+#else
     float bestSAD = 1e10;
+    float secondSAD = 1e10;
     int2 bestOffset = int2(0, 0);
+#endif
 
     int positionsPerThread = (totalSearchPositions + NUM_THREADS - 1) / NUM_THREADS;
 
+    SEARCH_LOOP
     for (int p = 0; p < positionsPerThread; p++)
     {
         int searchIdx = localIdx + p * NUM_THREADS;
-        if (searchIdx >= totalSearchPositions)
-            break;
-
-        int oy = (searchIdx / searchDiameter) - searchRadius;
-        int ox = (searchIdx % searchDiameter) - searchRadius;
-        int2 offset = int2(ox, oy);
+        if (searchIdx < totalSearchPositions)
+        {
+            int oy = (searchIdx / searchDiameter) - searchRadius;
+            int ox = (searchIdx % searchDiameter) - searchRadius;
 
-        // Compute SAD for this offset
-        float sad = 0.0;
-        int baseOffset = searchRadius;
+            float sad = 0.0;
 
-        [unroll]
-        for (int y = 0; y < TILE_SIZE; y++)
-        {
             [unroll]
-            for (int x = 0; x < TILE_SIZE; x++)
+            for (int y = 0; y < TILE_SIZE; y++)
             {
-                float currLum = s_CurrentLum[y][x];
-                float prevLum = s_PreviousLum[baseOffset + oy + y][baseOffset + ox + x];
-                sad += abs(currLum - prevLum);
+                [unroll]
+                for (int x = 0; x < TILE_SIZE; x++)
+                {
+                    sad += abs(s_CurrentLum[y][x] - s_PreviousLum[searchRadius + oy + y][searchRadius + ox + x]);
+                }
             }
-        }
 
-        if (sad < bestSAD)
-        {
-            bestSAD = sad;
-            bestOffset = offset;
+#ifdef WAVE_REDUCE
+            uint key = (asuint(sad) & 0xFFFFF000) | (uint)searchIdx;
+            secondKey = min(secondKey, max(bestKey, key));
+            bestKey = min(bestKey, key);
+#else
+            if (sad < bestSAD)
+            {
+                secondSAD = bestSAD;
+                bestSAD = sad;
+                bestOffset = int2(ox, oy);
+            }
+            else
+            {
+                secondSAD = min(secondSAD, sad);
+            }
+#endif
         }
     }
 
-    // Store this thread's best result
+#ifdef WAVE_REDUCE
+    // Keys are unique, so the wave runner-up is the minimum over every
+    // lane's best except the winner's, which contributes its own second
+    uint waveBest = WaveActiveMin(bestKey);
+    uint waveSecond = WaveActiveMin(bestKey == waveBest ? secondKey : bestKey);
+    uint previousKey;
+    if (WaveIsFirstLane())
+        InterlockedMin(s_BestKey, waveBest, previousKey);
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (WaveIsFirstLane())
+        InterlockedMin(s_SecondKey, waveBest == s_BestKey ? waveSecond : waveBest, previousKey);
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (localIdx == 0)
+    {
+        int bestIdx = (int)(s_BestKey & 0xFFF);
+        int2 bestOffset = int2(bestIdx % searchDiameter, bestIdx / searchDiameter) - searchRadius;
+        g_MotionVectors[groupId.xy] = (seed + bestOffset) * (int)g_OutputScale;
+        g_Confidence[groupId.xy] = MatchConfidence(KeySAD(s_BestKey), KeySAD(s_SecondKey));
+        CountSceneBlock(KeySAD(s_BestKey));
+    }
+#else
     s_SAD[localIdx] = bestSAD;
+    s_SecondSAD[localIdx] = secondSAD;
     s_Offset[localIdx] = bestOffset;
 
     GroupMemoryBarrierWithGroupSync();
 
-    // Parallel reduction to find global minimum
     for (int stride = NUM_THREADS / 2; stride > 0; stride >>= 1)
     {
         if (localIdx < stride)
         {
-            if (s_SAD[localIdx + stride] < s_SAD[localIdx])
+            float otherBest = s_SAD[localIdx + stride];
+            float otherSecond = s_SecondSAD[localIdx + stride];
+            if (otherBest < s_SAD[localIdx])
             {
-                s_SAD[localIdx] = s_SAD[localIdx + stride];
+                s_SecondSAD[localIdx] = min(s_SAD[localIdx], otherSecond);
+                s_SAD[localIdx] = otherBest;
                 s_Offset[localIdx] = s_Offset[localIdx + stride];
             }
+            else
+            {
+                s_SecondSAD[localIdx] = min(s_SecondSAD[localIdx], otherBest);
+            }
         }
         GroupMemoryBarrierWithGroupSync();
     }
 
-    // Thread 0 writes the final result
     if (localIdx == 0)
     {
-        g_MotionVectors[groupId.xy] = s_Offset[0] * 16;
+        g_MotionVectors[groupId.xy] = (seed + s_Offset[0]) * (int)g_OutputScale;
+        g_Confidence[groupId.xy] = MatchConfidence(s_SAD[0], s_SecondSAD[0]);
+        CountSceneBlock(s_SAD[0]);
     }
+#endif
 }
+
+#endif
 )";
 
+// DXIL for both sources, compiled by the build (see osfg_precompile_shaders)
+#ifdef OSFG_PRECOMPILED_SHADERS
+#include "g_OpticalFlowShaderSource_dxil.h"
+#include "g_PyramidFlowShaderSource_dxil.h"
+#endif
+
 namespace OSFG {
 
+// Build-time DXIL for a variant of one of the sources above, or nullptr
+static const osfg::PrecompiledShader* FindPrecompiledShader(const char* source, const char* entryPoint,
+                                                            const std::string& definesKey)
+{
+#ifdef OSFG_PRECOMPILED_SHADERS
+    if (source == g_OpticalFlowShaderSource) {
+        return osfg::FindPrecompiledShader(g_OpticalFlowShaderSourceDxil,
+                                           std::size(g_OpticalFlowShaderSourceDxil), entryPoint, definesKey);
+    }
+    if (source == g_PyramidFlowShaderSource) {
+        return osfg::FindPrecompiledShader(g_PyramidFlowShaderSourceDxil,
+                                           std::size(g_PyramidFlowShaderSourceDxil), entryPoint, definesKey);
+    }
+#else
+    (void)source;
+    (void)entryPoint;
+    (void)definesKey;
+#endif
+    return nullptr;
+}
+
 SimpleOpticalFlow::SimpleOpticalFlow()
 {
 }
@@ -173,12 +695,26 @@ bool SimpleOpticalFlow::Initialize(ID3D12Device* device, const SimpleOpticalFlow
         return false;
     }
 
+    // CSMain is built for 16x16 blocks only; 8x8 always takes the luminance passes
+    if (config.blockSize != 8 && config.blockSize != 16) {
+        m_lastError = "Block size must be 8 or 16";
+        return false;
+    }
+    if (config.downscale != 1 && config.downscale != 2 && config.downscale != 4) {
+        m_lastError = "Downscale must be 1, 2 or 4";
+        return false;
+    }
+
     m_device = device;
     m_config = config;
+    m_dxilSupported = osfg::SupportsShaderModel6(device);
 
-    // Calculate motion vector texture dimensions
-    m_mvWidth = (config.width + config.blockSize - 1) / config.blockSize;
-    m_mvHeight = (config.height + config.blockSize - 1) / config.blockSize;
+    // The luminance passes match 8x8 tiles at every level; 16x16 blocks use
+    // the RGB CSMain search
+    m_luminanceFlow = config.blockSize == 8;
+    m_downscale = m_luminanceFlow ? config.downscale : 1;
+    m_searchRadius = SpecializedRadius(config.searchRadius, CSMAIN_RADII, std::size(CSMAIN_RADII));
+    ComputeLayout();
 
     // Create descriptor heaps first
     if (!CreateDescriptorHeaps()) {
@@ -200,19 +736,139 @@ bool SimpleOpticalFlow::Initialize(ID3D12Device* device, const SimpleOpticalFlow
         return false;
     }
 
+    // Luminance passes (after CreateResources: the level 0 tables use the MV texture)
+    if (m_luminanceFlow) {
+        if (!CreatePyramidRootSignature() || !CreatePyramidPipelineStates() || !CreatePyramidResources()) {
+            return false;
+        }
+    }
+
     m_initialized = true;
     m_stats = {};
     return true;
 }
 
+bool SimpleOpticalFlow::Resize(uint32_t width, uint32_t height)
+{
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (width == m_config.width && height == m_config.height) {
+        return true;
+    }
+
+    ReleaseSizeResources();
+
+    const uint32_t coarseSearchRadius = m_coarseSearchRadius;
+    const uint32_t refineSearchRadius = m_refineSearchRadius;
+    m_config.width = width;
+    m_config.height = height;
+    ComputeLayout();
+
+    // The pyramid depth follows the size, and with it the coarse radius
+    bool created = true;
+    if (m_luminanceFlow &&
+        (m_coarseSearchRadius != coarseSearchRadius || m_refineSearchRadius != refineSearchRadius ||
+         (m_pyramidLevels > 1 && !m_downsampleLumaPipeline))) {
+        created = CreatePyramidPipelineStates();
+    }
+    created = created && CreateMotionVectorTexture() && WriteConstants() &&
+              (!m_luminanceFlow || CreatePyramidResources());
+    if (!created) {
+        m_initialized = false;
+        return false;
+    }
+    return true;
+}
+
+void SimpleOpticalFlow::ComputeLayout()
+{
+    // Level 0 is the frame reduced by the downscale; the vector grid tiles it
+    m_levelWidth[0] = (m_config.width + m_downscale - 1) / m_downscale;
+    m_levelHeight[0] = (m_config.height + m_downscale - 1) / m_downscale;
+    m_mvWidth = (m_levelWidth[0] + m_config.blockSize - 1) / m_config.blockSize;
+    m_mvHeight = (m_levelHeight[0] + m_config.blockSize - 1) / m_config.blockSize;
+
+    // Pyramid levels stop once the coarsest would be smaller than two tiles
+    m_pyramidLevels = m_luminanceFlow ? m_config.pyramidLevels : 1;
+    m_pyramidLevels = (std::max)(1u, (std::min)(m_pyramidLevels, static_cast<uint32_t>(MAX_PYRAMID_LEVELS)));
+    m_levelMvWidth[0] = m_mvWidth;
+    m_levelMvHeight[0] = m_mvHeight;
+    for (uint32_t level = 1; level < m_pyramidLevels; level++) {
+        m_levelWidth[level] = (m_levelWidth[level - 1] + 1) / 2;
+        m_levelHeight[level] = (m_levelHeight[level - 1] + 1) / 2;
+        if (m_levelWidth[level] < 16 || m_levelHeight[level] < 16) {
+            m_pyramidLevels = level;
+            break;
+        }
+        m_levelMvWidth[level] = (m_levelWidth[level] + 7) / 8;
+        m_levelMvHeight[level] = (m_levelHeight[level] + 7) / 8;
+    }
+
+    // The coarsest level covers the full search radius at its own scale
+    const uint32_t coarseScale = m_downscale << (m_pyramidLevels - 1);
+    m_coarseSearchRadius = (m_config.searchRadius + coarseScale - 1) / coarseScale;
+    if (m_pyramidLevels > 1) {
+        m_coarseSearchRadius = (std::max)(m_coarseSearchRadius, m_config.pyramidRefineRadius);
+    }
+    m_coarseSearchRadius = SpecializedRadius(m_coarseSearchRadius, MATCH_RADII, std::size(MATCH_RADII));
+    m_refineSearchRadius = SpecializedRadius(m_config.pyramidRefineRadius, MATCH_RADII, std::size(MATCH_RADII));
+}
+
+void SimpleOpticalFlow::ReleaseSizeResources()
+{
+    // Re-created textures can reuse released addresses: forget every set
+    for (auto& key : m_srvSetKeys) {
+        key = SrvSetKey{};
+    }
+    m_nextSrvSet = 0;
+
+    for (uint32_t level = 0; level < MAX_PYRAMID_LEVELS; level++) {
+        m_pyramidLuma[0][level].Reset();
+        m_pyramidLuma[1][level].Reset();
+        m_levelMotionVectors[level].Reset();
+    }
+    m_pyramidSource[0] = m_pyramidSource[1] = nullptr;
+    m_lastPyramidSet = 0;
+    m_temporalVectors.Reset();
+    m_temporalValid = false;
+    m_motionField.Reset();
+    m_confidenceTexture.Reset();
+    m_motionFieldWidth = m_motionFieldHeight = 0;
+    m_motionVectorTexture.Reset();
+    if (m_config.resourceArena) {
+        m_config.resourceArena->Release(this);
+    }
+}
+
 void SimpleOpticalFlow::Shutdown()
 {
+    ReleaseSizeResources();
+
+    m_motionFieldPipeline.Reset();
+    m_sceneDecidePipeline.Reset();
+    m_sceneStatsBuffer.Reset();
+    m_luminanceFlow = false;
+    m_downscale = 1;
+    m_waveMatch = false;
+    m_dxilSupported = false;
+    m_matchLumaPipeline.Reset();
+    m_refineLumaPipeline.Reset();
+    m_downsampleLumaPipeline.Reset();
+    m_luminancePipeline.Reset();
+    m_pyramidRootSignature.Reset();
+
     m_pipelineState.Reset();
     m_rootSignature.Reset();
-    m_motionVectorTexture.Reset();
     m_constantBuffer.Reset();
     m_srvUavHeap.Reset();
     m_device.Reset();
+    if (m_dxcModule) {
+        FreeLibrary(m_dxcModule);
+        m_dxcModule = nullptr;
+    }
     m_initialized = false;
 }
 
@@ -220,7 +876,7 @@ bool SimpleOpticalFlow::CreateDescriptorHeaps()
 {
     // Create SRV/UAV heap for shader resources
     D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-    heapDesc.NumDescriptors = 4; // 2 SRVs + 1 UAV + spare
+    heapDesc.NumDescriptors = DESCRIPTOR_COUNT; // 1 UAV + SRV_SETS x 3 SRVs + pyramid tables
     heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
     heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 
@@ -234,49 +890,233 @@ bool SimpleOpticalFlow::CreateDescriptorHeaps()
     return true;
 }
 
-bool SimpleOpticalFlow::CreateRootSignature()
+bool SimpleOpticalFlow::CreateRootSignature()
+{
+    // Root parameters:
+    // [0] CBV - Constant buffer
+    // [1] Descriptor table - SRVs (current and previous frame)
+    // [2] Descriptor table - UAV (motion vectors)
+
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 2;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.RegisterSpace = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+
+    D3D12_DESCRIPTOR_RANGE uavRange = {};
+    uavRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    uavRange.NumDescriptors = 1;
+    uavRange.BaseShaderRegister = 0;
+    uavRange.RegisterSpace = 0;
+    uavRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
+
+    D3D12_ROOT_PARAMETER rootParams[3] = {};
+
+    // CBV
+    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+    rootParams[0].Descriptor.ShaderRegister = 0;
+    rootParams[0].Descriptor.RegisterSpace = 0;
+    rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    // SRV table
+    rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    // UAV table
+    rootParams[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[2].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[2].DescriptorTable.pDescriptorRanges = &uavRange;
+    rootParams[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
+    rootSigDesc.NumParameters = 3;
+    rootSigDesc.pParameters = rootParams;
+    rootSigDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    Microsoft::WRL::ComPtr<ID3DBlob> signature;
+    Microsoft::WRL::ComPtr<ID3DBlob> error;
+
+    HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            m_lastError = std::string("Root signature serialization failed: ") +
+                         static_cast<const char*>(error->GetBufferPointer());
+        } else {
+            m_lastError = "Root signature serialization failed";
+        }
+        return false;
+    }
+
+    hr = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(),
+                                        IID_PPV_ARGS(&m_rootSignature));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create root signature";
+        return false;
+    }
+
+    return true;
+}
+
+bool SimpleOpticalFlow::CreatePipelineState()
+{
+    if (m_luminanceFlow) {
+        return true;
+    }
+
+    const std::string radius = std::to_string(m_searchRadius);
+    const char* pqInput = m_config.hdr10 ? "PQ_INPUT" : nullptr;   // nullptr ends the list early
+    const D3D_SHADER_MACRO defines[] = {
+        { "BLOCK_SIZE", "16" }, { "SEARCH_RADIUS", radius.c_str() }, { pqInput, "1" }, { nullptr, nullptr }
+    };
+    return CompileComputeShader(g_OpticalFlowShaderSource, "CSMain", defines,
+                                m_rootSignature.Get(), m_pipelineState);
+}
+
+uint32_t SimpleOpticalFlow::SpecializedRadius(uint32_t radius, const uint32_t* radii, size_t count)
+{
+    // Smallest compiled radius that covers the request, else the largest
+    for (size_t i = 0; i < count; i++) {
+        if (radii[i] >= radius) {
+            return radii[i];
+        }
+    }
+    return radii[count - 1];
+}
+
+bool SimpleOpticalFlow::CompileComputeShader(const char* source, const char* entryPoint,
+                                             const D3D_SHADER_MACRO* defines,
+                                             ID3D12RootSignature* rootSignature,
+                                             Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    const std::string definesKey = osfg::ShaderDefinesKey(defines);
+    const std::string name = std::string(entryPoint) + "/" + definesKey;
+
+    // Prefer the DXIL the build compiled; fall back to FXC at runtime
+    const osfg::PrecompiledShader* precompiled =
+        m_dxilSupported ? FindPrecompiledShader(source, entryPoint, definesKey) : nullptr;
+    if (precompiled) {
+        D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+        psoDesc.pRootSignature = rootSignature;
+        psoDesc.CS.pShaderBytecode = precompiled->bytecode;
+        psoDesc.CS.BytecodeLength = precompiled->size;
+
+        if (FAILED(CreateComputePipeline(name, psoDesc, pipelineState))) {
+            m_lastError = std::string("Failed to create pipeline state (") + entryPoint + ")";
+            return false;
+        }
+        return true;
+    }
+
+    Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+
+    UINT compileFlags = 0;
+#if defined(_DEBUG)
+    compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+    HRESULT hr = D3DCompile(
+        source,
+        strlen(source),
+        "OpticalFlow.hlsl",
+        defines,
+        nullptr,
+        entryPoint,
+        "cs_5_0",
+        compileFlags,
+        0,
+        &shaderBlob,
+        &errorBlob
+    );
+
+    if (FAILED(hr)) {
+        if (errorBlob) {
+            m_lastError = std::string("Shader compilation failed (") + entryPoint + "): " +
+                         static_cast<const char*>(errorBlob->GetBufferPointer());
+        } else {
+            m_lastError = std::string("Shader compilation failed (") + entryPoint + ")";
+        }
+        return false;
+    }
+
+    // Create compute pipeline state
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = rootSignature;
+    psoDesc.CS.pShaderBytecode = shaderBlob->GetBufferPointer();
+    psoDesc.CS.BytecodeLength = shaderBlob->GetBufferSize();
+
+    hr = CreateComputePipeline(name, psoDesc, pipelineState);
+    if (FAILED(hr)) {
+        m_lastError = std::string("Failed to create pipeline state (") + entryPoint + ")";
+        return false;
+    }
+
+    return true;
+}
+
+HRESULT SimpleOpticalFlow::CreateComputePipeline(const std::string& name,
+                                                 const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc,
+                                                 Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    if (m_config.pipelineCache) {
+        return m_config.pipelineCache->CreateComputePipelineState("SimpleOpticalFlow/" + name, desc,
+                                                                  pipelineState);
+    }
+    return m_device->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState));
+}
+
+bool SimpleOpticalFlow::CreatePyramidRootSignature()
 {
     // Root parameters:
-    // [0] CBV - Constant buffer
-    // [1] Descriptor table - SRVs (current and previous frame)
-    // [2] Descriptor table - UAV (motion vectors)
+    // [0] Root constants - PyramidConstants
+    // [1] Descriptor table - SRVs (current, previous, seed vectors, temporal vectors)
+    // [2] Descriptor table - UAVs (two outputs)
+    // [3] Root UAV - scene detection buffer
 
     D3D12_DESCRIPTOR_RANGE srvRange = {};
     srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
-    srvRange.NumDescriptors = 2;
+    srvRange.NumDescriptors = LUMA_TABLE_SRVS;
     srvRange.BaseShaderRegister = 0;
     srvRange.RegisterSpace = 0;
     srvRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
 
     D3D12_DESCRIPTOR_RANGE uavRange = {};
     uavRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
-    uavRange.NumDescriptors = 1;
+    uavRange.NumDescriptors = 2;
     uavRange.BaseShaderRegister = 0;
     uavRange.RegisterSpace = 0;
     uavRange.OffsetInDescriptorsFromTableStart = D3D12_DESCRIPTOR_RANGE_OFFSET_APPEND;
 
-    D3D12_ROOT_PARAMETER rootParams[3] = {};
+    D3D12_ROOT_PARAMETER rootParams[4] = {};
 
-    // CBV
-    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-    rootParams[0].Descriptor.ShaderRegister = 0;
-    rootParams[0].Descriptor.RegisterSpace = 0;
+    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParams[0].Constants.ShaderRegister = 0;
+    rootParams[0].Constants.RegisterSpace = 0;
+    rootParams[0].Constants.Num32BitValues = sizeof(PyramidConstants) / sizeof(uint32_t);
     rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
-    // SRV table
     rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
     rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
     rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
     rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
-    // UAV table
     rootParams[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
     rootParams[2].DescriptorTable.NumDescriptorRanges = 1;
     rootParams[2].DescriptorTable.pDescriptorRanges = &uavRange;
     rootParams[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
 
+    rootParams[3].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    rootParams[3].Descriptor.ShaderRegister = 2;
+    rootParams[3].Descriptor.RegisterSpace = 0;
+    rootParams[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
     D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
-    rootSigDesc.NumParameters = 3;
+    rootSigDesc.NumParameters = 4;
     rootSigDesc.pParameters = rootParams;
     rootSigDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
 
@@ -286,81 +1126,401 @@ bool SimpleOpticalFlow::CreateRootSignature()
     HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
     if (FAILED(hr)) {
         if (error) {
-            m_lastError = std::string("Root signature serialization failed: ") +
+            m_lastError = std::string("Pyramid root signature serialization failed: ") +
                          static_cast<const char*>(error->GetBufferPointer());
         } else {
-            m_lastError = "Root signature serialization failed";
+            m_lastError = "Pyramid root signature serialization failed";
         }
         return false;
     }
 
     hr = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(),
-                                        IID_PPV_ARGS(&m_rootSignature));
+                                        IID_PPV_ARGS(&m_pyramidRootSignature));
     if (FAILED(hr)) {
-        m_lastError = "Failed to create root signature";
+        m_lastError = "Failed to create pyramid root signature";
         return false;
     }
 
     return true;
 }
 
-bool SimpleOpticalFlow::CreatePipelineState()
+bool SimpleOpticalFlow::CreatePyramidPipelineStates()
 {
-    // Compile shader at runtime
-    Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob;
-    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+    const char* pqInput = m_config.hdr10 ? "PQ_INPUT" : nullptr;   // nullptr ends the list early
+    const D3D_SHADER_MACRO luminanceRGB[] = { { "DOWNSAMPLE", "1" }, { pqInput, "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO downsampleLuma[] = { { "DOWNSAMPLE", "1" }, { "LUMA_INPUT", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO matchLuma[] = { { "LUMA_INPUT", "1" }, { nullptr, nullptr } };
+
+    ID3D12RootSignature* rootSignature = m_pyramidRootSignature.Get();
+    if (!CompileComputeShader(g_PyramidFlowShaderSource, "CSLuminance", luminanceRGB,
+                              rootSignature, m_luminancePipeline)) {
+        return false;
+    }
 
-    UINT compileFlags = 0;
+    // One match kernel for the coarsest level and one for the refining
+    // levels, each compiled for its radius. Prefer the wave-reduction
+    // kernels; any failure keeps the cs_5_0 ones for both.
+    const bool separateRefine = m_refineSearchRadius != m_coarseSearchRadius;
+    m_waveMatch = m_config.allowWaveIntrinsics && SupportsWaveIntrinsics() &&
+                  CreateMatchPipeline(m_coarseSearchRadius, true, m_matchLumaPipeline) &&
+                  (!separateRefine || CreateMatchPipeline(m_refineSearchRadius, true, m_refineLumaPipeline));
+    if (!m_waveMatch &&
+        (!CreateMatchPipeline(m_coarseSearchRadius, false, m_matchLumaPipeline) ||
+         (separateRefine && !CreateMatchPipeline(m_refineSearchRadius, false, m_refineLumaPipeline)))) {
+        return false;
+    }
+    if (!separateRefine) {
+        m_refineLumaPipeline = m_matchLumaPipeline;
+    }
+
+    if (!CompileComputeShader(g_PyramidFlowShaderSource, "CSSceneDecide", matchLuma,
+                              rootSignature, m_sceneDecidePipeline)) {
+        return false;
+    }
+
+    if (m_config.motionField) {
+        const D3D_SHADER_MACRO motionField[] = { { "MOTION_FIELD", "1" }, { nullptr, nullptr } };
+        if (!CompileComputeShader(g_PyramidFlowShaderSource, "CSMotionField", motionField,
+                                  rootSignature, m_motionFieldPipeline)) {
+            return false;
+        }
+    }
+
+    return m_pyramidLevels == 1 ||
+           CompileComputeShader(g_PyramidFlowShaderSource, "CSDownsample", downsampleLuma,
+                                rootSignature, m_downsampleLumaPipeline);
+}
+
+bool SimpleOpticalFlow::CreateMatchPipeline(uint32_t searchRadius, bool waveReduce,
+                                            Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    const std::string radius = std::to_string(searchRadius);
+    if (waveReduce) {
+        const std::wstring radiusDefine = L"SEARCH_RADIUS=" + std::wstring(radius.begin(), radius.end());
+        const wchar_t* defines[] = { L"LUMA_INPUT=1", L"WAVE_REDUCE=1", radiusDefine.c_str() };
+        return CompileComputeShaderDXIL(g_PyramidFlowShaderSource, "CSMatch", defines, 3,
+                                        m_pyramidRootSignature.Get(), pipelineState);
+    }
+
+    const D3D_SHADER_MACRO defines[] = {
+        { "LUMA_INPUT", "1" }, { "SEARCH_RADIUS", radius.c_str() }, { nullptr, nullptr }
+    };
+    return CompileComputeShader(g_PyramidFlowShaderSource, "CSMatch", defines,
+                                m_pyramidRootSignature.Get(), pipelineState);
+}
+
+bool SimpleOpticalFlow::SupportsWaveIntrinsics() const
+{
+    D3D12_FEATURE_DATA_SHADER_MODEL shaderModel = { D3D_SHADER_MODEL_6_0 };
+    if (FAILED(m_device->CheckFeatureSupport(D3D12_FEATURE_SHADER_MODEL, &shaderModel, sizeof(shaderModel))) ||
+        shaderModel.HighestShaderModel < D3D_SHADER_MODEL_6_0) {
+        return false;
+    }
+
+    D3D12_FEATURE_DATA_D3D12_OPTIONS1 options1 = {};
+    if (FAILED(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS1, &options1, sizeof(options1)))) {
+        return false;
+    }
+
+    return options1.WaveOps && options1.WaveLaneCountMin >= 4;
+}
+
+bool SimpleOpticalFlow::CompileComputeShaderDXIL(const char* source, const char* entryPoint,
+                                                 const wchar_t* const* defines, uint32_t defineCount,
+                                                 ID3D12RootSignature* rootSignature,
+                                                 Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState)
+{
+    std::string definesKey;
+    for (uint32_t i = 0; i < defineCount; i++) {
+        if (i > 0) {
+            definesKey += ';';
+        }
+        for (const wchar_t* c = defines[i]; *c; c++) {
+            definesKey += static_cast<char>(*c);
+        }
+    }
+    const std::string name = std::string(entryPoint) + "/" + definesKey;
+
+    // Build-time DXIL needs no compiler at all
+    if (const osfg::PrecompiledShader* precompiled = FindPrecompiledShader(source, entryPoint, definesKey)) {
+        D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+        psoDesc.pRootSignature = rootSignature;
+        psoDesc.CS.pShaderBytecode = precompiled->bytecode;
+        psoDesc.CS.BytecodeLength = precompiled->size;
+        return SUCCEEDED(CreateComputePipeline(name, psoDesc, pipelineState));
+    }
+
+    // DXC is optional at runtime: it ships with the Windows SDK / Agility SDK
+    // rather than with the OS, so load it on demand
+    if (!m_dxcModule) {
+        m_dxcModule = LoadLibraryW(L"dxcompiler.dll");
+        if (!m_dxcModule) {
+            return false;
+        }
+    }
+
+    auto createInstance = reinterpret_cast<DxcCreateInstanceProc>(
+        GetProcAddress(m_dxcModule, "DxcCreateInstance"));
+    if (!createInstance) {
+        return false;
+    }
+
+    Microsoft::WRL::ComPtr<IDxcCompiler3> compiler;
+    if (FAILED(createInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler)))) {
+        return false;
+    }
+
+    std::wstring entry(entryPoint, entryPoint + strlen(entryPoint));
+    std::vector<const wchar_t*> args = { L"-E", entry.c_str(), L"-T", L"cs_6_0" };
 #if defined(_DEBUG)
-    compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+    args.push_back(L"-Zi");
+    args.push_back(L"-Od");
 #else
-    compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+    args.push_back(L"-O3");
 #endif
+    for (uint32_t i = 0; i < defineCount; i++) {
+        args.push_back(L"-D");
+        args.push_back(defines[i]);
+    }
 
-    HRESULT hr = D3DCompile(
-        g_OpticalFlowShaderSource,
-        strlen(g_OpticalFlowShaderSource),
-        "OpticalFlow.hlsl",
-        nullptr,
-        nullptr,
-        "CSMain",
-        "cs_5_0",
-        compileFlags,
-        0,
-        &shaderBlob,
-        &errorBlob
-    );
+    DxcBuffer sourceBuffer = {};
+    sourceBuffer.Ptr = source;
+    sourceBuffer.Size = strlen(source);
+    sourceBuffer.Encoding = DXC_CP_UTF8;
 
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            m_lastError = std::string("Shader compilation failed: ") +
-                         static_cast<const char*>(errorBlob->GetBufferPointer());
-        } else {
-            m_lastError = "Shader compilation failed";
-        }
+    Microsoft::WRL::ComPtr<IDxcResult> result;
+    HRESULT status = E_FAIL;
+    if (FAILED(compiler->Compile(&sourceBuffer, args.data(), static_cast<UINT32>(args.size()),
+                                 nullptr, IID_PPV_ARGS(&result))) ||
+        FAILED(result->GetStatus(&status)) || FAILED(status)) {
         return false;
     }
 
-    // Create compute pipeline state
+    Microsoft::WRL::ComPtr<IDxcBlob> shaderBlob;
+    if (FAILED(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&shaderBlob), nullptr)) || !shaderBlob) {
+        return false;
+    }
+
+    // Unsigned DXIL (no dxil.dll next to dxcompiler.dll) is rejected here
     D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
-    psoDesc.pRootSignature = m_rootSignature.Get();
+    psoDesc.pRootSignature = rootSignature;
     psoDesc.CS.pShaderBytecode = shaderBlob->GetBufferPointer();
     psoDesc.CS.BytecodeLength = shaderBlob->GetBufferSize();
 
-    hr = m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+    return SUCCEEDED(CreateComputePipeline(name, psoDesc, pipelineState));
+}
+
+bool SimpleOpticalFlow::CreatePyramidResources()
+{
+    osfg::ResourceArena* arena = m_config.resourceArena;
+
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.SampleDesc.Count = 1;
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    // Inner level vectors only live within a dispatch, and level L's are
+    // dead once level L-1 has been matched from them: in the arena the odd
+    // and the even levels each share one range
+    D3D12_RESOURCE_DESC vectorDescs[2][MAX_PYRAMID_LEVELS] = {};
+    uint32_t vectorDescCount[2] = {};
+    for (uint32_t level = 1; level < m_pyramidLevels; level++) {
+        D3D12_RESOURCE_DESC& vectorDesc = vectorDescs[level & 1][vectorDescCount[level & 1]++];
+        vectorDesc = desc;
+        vectorDesc.Width = m_levelMvWidth[level];
+        vectorDesc.Height = m_levelMvHeight[level];
+        vectorDesc.Format = DXGI_FORMAT_R16G16_SINT;
+    }
+    bool aliasGroup[2] = {};
+    for (uint32_t group = 0; group < 2; group++) {
+        aliasGroup[group] = arena && arena->IsInitialized() && vectorDescCount[group] > 1 &&
+                            arena->ReserveAliasGroup(this, group, D3D12_HEAP_TYPE_DEFAULT,
+                                                     vectorDescs[group], vectorDescCount[group]);
+    }
+
+    for (uint32_t level = 0; level < m_pyramidLevels; level++) {
+        desc.Width = m_levelWidth[level];
+        desc.Height = m_levelHeight[level];
+        desc.Format = DXGI_FORMAT_R16_FLOAT;
+        for (uint32_t set = 0; set < 2; set++) {
+            HRESULT hr = osfg::CreateArenaResource(arena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, desc,
+                                                   D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr,
+                                                   m_pyramidLuma[set][level]);
+            if (FAILED(hr)) {
+                m_lastError = "Failed to create luminance level " + std::to_string(level);
+                return false;
+            }
+        }
+
+        m_levelVectorsAliased[level] = false;
+        if (level == 0) {
+            continue;  // Level 0 vectors are m_motionVectorTexture
+        }
+
+        desc.Width = m_levelMvWidth[level];
+        desc.Height = m_levelMvHeight[level];
+        desc.Format = DXGI_FORMAT_R16G16_SINT;
+        m_levelVectorsAliased[level] = aliasGroup[level & 1];
+        HRESULT hr = m_levelVectorsAliased[level]
+            ? arena->CreateAliasedResource(this, level & 1, desc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                                           nullptr, m_levelMotionVectors[level])
+            : osfg::CreateArenaResource(arena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, desc,
+                                        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr,
+                                        m_levelMotionVectors[level]);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create level " + std::to_string(level) + " motion vectors";
+            return false;
+        }
+    }
+
+    if (m_config.temporalPredictors) {
+        desc.Width = m_mvWidth;
+        desc.Height = m_mvHeight;
+        desc.Format = DXGI_FORMAT_R16G16_SINT;
+        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+        HRESULT hr = osfg::CreateArenaResource(arena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, desc,
+                                               D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr,
+                                               m_temporalVectors);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create temporal predictor texture";
+            return false;
+        }
+    }
+
+    // Confidence starts in UAV state like the vectors it is written with
+    desc.Width = m_mvWidth;
+    desc.Height = m_mvHeight;
+    desc.Format = DXGI_FORMAT_R8_UNORM;
+    desc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    HRESULT hr = osfg::CreateArenaResource(arena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, desc,
+                                           D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, m_confidenceTexture);
     if (FAILED(hr)) {
-        m_lastError = "Failed to create pipeline state";
+        m_lastError = "Failed to create confidence texture";
         return false;
     }
 
+    // Scene detection buffer (zero-initialized: no unmatched blocks, no cut).
+    // Committed for the zeroing, and kept across Resize().
+    if (!m_sceneStatsBuffer) {
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+        D3D12_RESOURCE_DESC bufferDesc = {};
+        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        bufferDesc.Width = 256;
+        bufferDesc.Height = 1;
+        bufferDesc.DepthOrArraySize = 1;
+        bufferDesc.MipLevels = 1;
+        bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+        bufferDesc.SampleDesc.Count = 1;
+        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+        bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+        hr = m_device->CreateCommittedResource(
+            &heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+            IID_PPV_ARGS(&m_sceneStatsBuffer));
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create scene detection buffer";
+            return false;
+        }
+    }
+
+    if (m_config.motionField) {
+        m_motionFieldWidth = (m_levelWidth[0] + 1) / 2;
+        m_motionFieldHeight = (m_levelHeight[0] + 1) / 2;
+        desc.Width = m_motionFieldWidth;
+        desc.Height = m_motionFieldHeight;
+        desc.Format = DXGI_FORMAT_R16G16_FLOAT;
+        hr = osfg::CreateArenaResource(arena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT, desc,
+                                       m_config.vectorReadState, nullptr, m_motionField);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create motion field";
+            return false;
+        }
+    }
+
+    // Static descriptor tables
+    D3D12_SHADER_RESOURCE_VIEW_DESC lumaSrv = {};
+    lumaSrv.Format = DXGI_FORMAT_R16_FLOAT;
+    lumaSrv.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    lumaSrv.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    lumaSrv.Texture2D.MipLevels = 1;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC vectorSrv = lumaSrv;
+    vectorSrv.Format = DXGI_FORMAT_R16G16_SINT;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC lumaUav = {};
+    lumaUav.Format = DXGI_FORMAT_R16_FLOAT;
+    lumaUav.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC vectorUav = lumaUav;
+    vectorUav.Format = DXGI_FORMAT_R16G16_SINT;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC confidenceSrv = lumaSrv;
+    confidenceSrv.Format = DXGI_FORMAT_R8_UNORM;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC confidenceUav = lumaUav;
+    confidenceUav.Format = DXGI_FORMAT_R8_UNORM;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC fieldUav = lumaUav;
+    fieldUav.Format = DXGI_FORMAT_R16G16_FLOAT;
+
+    for (uint32_t level = 0; level < m_pyramidLevels; level++) {
+        ID3D12Resource* vectors = level == 0 ? m_motionVectorTexture.Get() : m_levelMotionVectors[level].Get();
+        ID3D12Resource* confidence = level == 0 ? m_confidenceTexture.Get() : nullptr;
+        m_device->CreateUnorderedAccessView(vectors, nullptr, &vectorUav, CpuDescriptor(MatchUavIndex(level)));
+        m_device->CreateUnorderedAccessView(confidence, nullptr, &confidenceUav, CpuDescriptor(MatchUavIndex(level) + 1));
+    }
+
+    m_device->CreateShaderResourceView(m_motionVectorTexture.Get(), &vectorSrv, CpuDescriptor(FIELD_TABLE_INDEX + 0));
+    m_device->CreateShaderResourceView(m_confidenceTexture.Get(), &confidenceSrv, CpuDescriptor(FIELD_TABLE_INDEX + 1));
+    m_device->CreateShaderResourceView(nullptr, &vectorSrv, CpuDescriptor(FIELD_TABLE_INDEX + 2));
+    m_device->CreateShaderResourceView(nullptr, &vectorSrv, CpuDescriptor(FIELD_TABLE_INDEX + 3));
+    m_device->CreateUnorderedAccessView(m_motionField.Get(), nullptr, &fieldUav,
+                                        CpuDescriptor(FIELD_TABLE_INDEX + LUMA_TABLE_SRVS));
+    m_device->CreateUnorderedAccessView(nullptr, nullptr, &fieldUav,
+                                        CpuDescriptor(FIELD_TABLE_INDEX + LUMA_TABLE_SRVS + 1));
+
+    for (uint32_t set = 0; set < 2; set++) {
+        for (uint32_t level = 0; level < m_pyramidLevels; level++) {
+            const uint32_t table = LumaTableIndex(set, level);
+            ID3D12Resource* current = m_pyramidLuma[set][level].Get();
+            ID3D12Resource* previous = m_pyramidLuma[1 - set][level].Get();
+            ID3D12Resource* seed = level + 1 < m_pyramidLevels ? m_levelMotionVectors[level + 1].Get() : nullptr;
+            ID3D12Resource* temporal = level == 0 ? m_temporalVectors.Get() : nullptr;
+
+            m_device->CreateShaderResourceView(current, &lumaSrv, CpuDescriptor(table + 0));
+            m_device->CreateShaderResourceView(previous, &lumaSrv, CpuDescriptor(table + 1));
+            m_device->CreateShaderResourceView(seed, &vectorSrv, CpuDescriptor(table + 2));
+            m_device->CreateShaderResourceView(temporal, &vectorSrv, CpuDescriptor(table + 3));
+            m_device->CreateUnorderedAccessView(current, nullptr, &lumaUav, CpuDescriptor(table + LUMA_TABLE_SRVS));
+            m_device->CreateUnorderedAccessView(previous, nullptr, &lumaUav, CpuDescriptor(table + LUMA_TABLE_SRVS + 1));
+        }
+    }
+
+    m_pyramidSource[0] = m_pyramidSource[1] = nullptr;
+    m_lastPyramidSet = 0;
     return true;
 }
 
-bool SimpleOpticalFlow::CreateResources()
+D3D12_CPU_DESCRIPTOR_HANDLE SimpleOpticalFlow::CpuDescriptor(uint32_t index) const
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+    handle.ptr += static_cast<SIZE_T>(index) * m_srvUavDescriptorSize;
+    return handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE SimpleOpticalFlow::GpuDescriptor(uint32_t index) const
 {
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    D3D12_GPU_DESCRIPTOR_HANDLE handle = m_srvUavHeap->GetGPUDescriptorHandleForHeapStart();
+    handle.ptr += static_cast<UINT64>(index) * m_srvUavDescriptorSize;
+    return handle;
+}
 
+bool SimpleOpticalFlow::CreateMotionVectorTexture()
+{
     // Create motion vector texture (R16G16_SINT)
     D3D12_RESOURCE_DESC mvDesc = {};
     mvDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
@@ -372,20 +1532,56 @@ bool SimpleOpticalFlow::CreateResources()
     mvDesc.SampleDesc.Count = 1;
     mvDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
 
-    HRESULT hr = m_device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &mvDesc,
-        D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
-        nullptr,
-        IID_PPV_ARGS(&m_motionVectorTexture)
-    );
-
+    HRESULT hr = osfg::CreateArenaResource(m_config.resourceArena, this, m_device.Get(), D3D12_HEAP_TYPE_DEFAULT,
+                                           mvDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr,
+                                           m_motionVectorTexture);
     if (FAILED(hr)) {
         m_lastError = "Failed to create motion vector texture";
         return false;
     }
 
+    // Create UAV for motion vectors (slot 0, ahead of the SRV sets)
+    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R16G16_SINT;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+    uavDesc.Texture2D.MipSlice = 0;
+
+    m_device->CreateUnorderedAccessView(m_motionVectorTexture.Get(), nullptr, &uavDesc, uavHandle);
+
+    // Vectors, confidence and temporal predictors hold nothing yet
+    m_vectorsWritten = false;
+    return true;
+}
+
+bool SimpleOpticalFlow::WriteConstants()
+{
+    ConstantBufferData* cbData = nullptr;
+    D3D12_RANGE readRange = { 0, 0 };
+    if (FAILED(m_constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&cbData)))) {
+        m_lastError = "Failed to map constant buffer";
+        return false;
+    }
+
+    cbData->inputWidth = m_config.width;
+    cbData->inputHeight = m_config.height;
+    cbData->outputWidth = m_mvWidth;
+    cbData->outputHeight = m_mvHeight;
+    cbData->blockSize = m_config.blockSize;
+    cbData->searchRadius = m_searchRadius;
+    cbData->minLuminance = 0.0f;
+    cbData->maxLuminance = 1.0f;
+    m_constantBuffer->Unmap(0, nullptr);
+    return true;
+}
+
+bool SimpleOpticalFlow::CreateResources()
+{
+    if (!CreateMotionVectorTexture()) {
+        return false;
+    }
+
     // Create constant buffer (upload heap for CPU writes)
     D3D12_HEAP_PROPERTIES uploadHeapProps = {};
     uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
@@ -400,7 +1596,7 @@ bool SimpleOpticalFlow::CreateResources()
     cbDesc.SampleDesc.Count = 1;
     cbDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 
-    hr = m_device->CreateCommittedResource(
+    HRESULT hr = m_device->CreateCommittedResource(
         &uploadHeapProps,
         D3D12_HEAP_FLAG_NONE,
         &cbDesc,
@@ -414,32 +1610,8 @@ bool SimpleOpticalFlow::CreateResources()
         return false;
     }
 
-    // Initialize constant buffer
-    ConstantBufferData* cbData = nullptr;
-    D3D12_RANGE readRange = { 0, 0 };
-    hr = m_constantBuffer->Map(0, &readRange, reinterpret_cast<void**>(&cbData));
-    if (SUCCEEDED(hr)) {
-        cbData->inputWidth = m_config.width;
-        cbData->inputHeight = m_config.height;
-        cbData->outputWidth = m_mvWidth;
-        cbData->outputHeight = m_mvHeight;
-        cbData->blockSize = m_config.blockSize;
-        cbData->searchRadius = m_config.searchRadius;
-        cbData->minLuminance = 0.0f;
-        cbData->maxLuminance = 1.0f;
-        m_constantBuffer->Unmap(0, nullptr);
-    }
-
-    // Create UAV for motion vectors
-    D3D12_CPU_DESCRIPTOR_HANDLE uavHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
-    uavHandle.ptr += 2 * m_srvUavDescriptorSize; // After 2 SRVs
-
-    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-    uavDesc.Format = DXGI_FORMAT_R16G16_SINT;
-    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
-    uavDesc.Texture2D.MipSlice = 0;
-
-    m_device->CreateUnorderedAccessView(m_motionVectorTexture.Get(), nullptr, &uavDesc, uavHandle);
+    // Initialize constant buffer (non-fatal, as before: CSMain only)
+    WriteConstants();
 
     // Create GPU timestamp query heap (2 queries: start and end)
     D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
@@ -482,6 +1654,48 @@ void SimpleOpticalFlow::SetTimestampFrequency(ID3D12CommandQueue* cmdQueue)
     }
 }
 
+uint32_t SimpleOpticalFlow::GetSrvSet(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame)
+{
+    for (uint32_t i = 0; i < SRV_SETS; i++) {
+        if (m_srvSetKeys[i].currentFrame == currentFrame &&
+            m_srvSetKeys[i].previousFrame == previousFrame) {
+            return i;
+        }
+    }
+
+    // Miss: overwrite the oldest set
+    const uint32_t set = m_nextSrvSet;
+    m_nextSrvSet = (m_nextSrvSet + 1) % SRV_SETS;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
+    srvHandle.ptr += static_cast<SIZE_T>(1 + SRV_SET_SIZE * set) * m_srvUavDescriptorSize;
+
+    // Current frame SRV - use the actual texture format
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = currentFrame->GetDesc().Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+
+    m_device->CreateShaderResourceView(currentFrame, &srvDesc, srvHandle);
+
+    // Previous frame SRV - use its actual format
+    srvHandle.ptr += m_srvUavDescriptorSize;
+    srvDesc.Format = previousFrame->GetDesc().Format;
+    m_device->CreateShaderResourceView(previousFrame, &srvDesc, srvHandle);
+
+    // Unused seed / temporal slots of the luminance pass table
+    for (uint32_t i = 2; i < SRV_SET_SIZE; i++) {
+        srvHandle.ptr += m_srvUavDescriptorSize;
+        m_device->CreateShaderResourceView(nullptr, &srvDesc, srvHandle);
+    }
+
+    m_srvSetKeys[set].currentFrame = currentFrame;
+    m_srvSetKeys[set].previousFrame = previousFrame;
+
+    return set;
+}
+
 bool SimpleOpticalFlow::Dispatch(ID3D12Resource* currentFrame,
                                   ID3D12Resource* previousFrame,
                                   ID3D12GraphicsCommandList* commandList)
@@ -517,68 +1731,94 @@ bool SimpleOpticalFlow::Dispatch(ID3D12Resource* currentFrame,
         }
     }
 
-    // Transition motion vector texture back to UAV state if it was left in shader resource state
-    if (m_stats.framesProcessed > 0) {
+    // Keep the last vectors as this dispatch's temporal predictors
+    m_temporalValid = m_temporalVectors && m_vectorsWritten;
+    if (m_temporalValid) {
+        D3D12_RESOURCE_BARRIER barriers[2] = {};
+        barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barriers[0].Transition.pResource = m_motionVectorTexture.Get();
+        barriers[0].Transition.StateBefore = m_config.vectorReadState;
+        barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+        barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barriers[1] = barriers[0];
+        barriers[1].Transition.pResource = m_temporalVectors.Get();
+        barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+        commandList->ResourceBarrier(2, barriers);
+
+        commandList->CopyResource(m_temporalVectors.Get(), m_motionVectorTexture.Get());
+
+        barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
+        barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+        barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+        commandList->ResourceBarrier(2, barriers);
+    } else if (m_vectorsWritten) {
+        // Transition motion vector texture back to UAV state if it was left in shader resource state
         D3D12_RESOURCE_BARRIER barrier = {};
         barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
         barrier.Transition.pResource = m_motionVectorTexture.Get();
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+        barrier.Transition.StateBefore = m_config.vectorReadState;
         barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
         barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
         commandList->ResourceBarrier(1, &barrier);
     }
 
-    // Only recreate SRVs if textures changed (descriptor caching)
-    bool needsDescriptorUpdate = !m_descriptorsValid ||
-                                  m_cachedCurrentFrame != currentFrame ||
-                                  m_cachedPreviousFrame != previousFrame;
-
-    if (needsDescriptorUpdate) {
-        D3D12_CPU_DESCRIPTOR_HANDLE srvHandle = m_srvUavHeap->GetCPUDescriptorHandleForHeapStart();
-
-        // Current frame SRV - use the actual texture format
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = currentFrame->GetDesc().Format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.Texture2D.MipLevels = 1;
-
-        m_device->CreateShaderResourceView(currentFrame, &srvDesc, srvHandle);
-
-        // Previous frame SRV - use its actual format
-        srvHandle.ptr += m_srvUavDescriptorSize;
-        srvDesc.Format = previousFrame->GetDesc().Format;
-        m_device->CreateShaderResourceView(previousFrame, &srvDesc, srvHandle);
-
-        m_cachedCurrentFrame = currentFrame;
-        m_cachedPreviousFrame = previousFrame;
-        m_descriptorsValid = true;
+    // Confidence is written alongside the level 0 vectors
+    if (m_confidenceTexture && m_vectorsWritten) {
+        D3D12_RESOURCE_BARRIER barrier = {};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = m_confidenceTexture.Get();
+        barrier.Transition.StateBefore = m_config.vectorReadState;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        commandList->ResourceBarrier(1, &barrier);
     }
 
-    // Set pipeline state and root signature
-    commandList->SetComputeRootSignature(m_rootSignature.Get());
-    commandList->SetPipelineState(m_pipelineState.Get());
+    // Only recreate SRVs if textures changed (descriptor caching)
+    const uint32_t srvSet = GetSrvSet(currentFrame, previousFrame);
+
+    const D3D12_GPU_DESCRIPTOR_HANDLE srvHandle = GpuDescriptor(1 + SRV_SET_SIZE * srvSet);
 
     // Set descriptor heap
     ID3D12DescriptorHeap* heaps[] = { m_srvUavHeap.Get() };
     commandList->SetDescriptorHeaps(1, heaps);
 
-    // Set root parameters
-    commandList->SetComputeRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress());
-
-    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_srvUavHeap->GetGPUDescriptorHandleForHeapStart();
-    commandList->SetComputeRootDescriptorTable(1, gpuHandle); // SRVs
-
-    gpuHandle.ptr += 2 * m_srvUavDescriptorSize;
-    commandList->SetComputeRootDescriptorTable(2, gpuHandle); // UAV
-
     // GPU timestamp: start
     if (m_gpuTimingEnabled) {
         commandList->EndQuery(m_timestampQueryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
     }
 
-    // Dispatch - one thread group per block (each group is 8x8 threads working together)
-    commandList->Dispatch(m_mvWidth, m_mvHeight, 1);
+    if (m_luminanceFlow) {
+        RecordLuminanceFlow(srvHandle, currentFrame, previousFrame, commandList);
+    } else {
+        // Set pipeline state and root signature
+        commandList->SetComputeRootSignature(m_rootSignature.Get());
+        commandList->SetPipelineState(m_pipelineState.Get());
+
+        // Set root parameters
+        commandList->SetComputeRootConstantBufferView(0, m_constantBuffer->GetGPUVirtualAddress());
+        commandList->SetComputeRootDescriptorTable(1, srvHandle);         // SRVs
+        commandList->SetComputeRootDescriptorTable(2, GpuDescriptor(0));  // UAV
+
+        // Dispatch - one thread group per block (one thread per block pixel)
+        commandList->Dispatch(m_mvWidth, m_mvHeight, 1);
+    }
+
+    // Transition motion vectors (and confidence) from UAV to their read state
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+    barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[0].Transition.pResource = m_motionVectorTexture.Get();
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barriers[0].Transition.StateAfter = m_config.vectorReadState;
+    barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barriers[1] = barriers[0];
+    barriers[1].Transition.pResource = m_confidenceTexture.Get();
+    commandList->ResourceBarrier(m_confidenceTexture ? 2 : 1, barriers);
+
+    if (m_motionField) {
+        RecordMotionField(commandList);
+    }
 
     // GPU timestamp: end
     if (m_gpuTimingEnabled) {
@@ -587,21 +1827,13 @@ bool SimpleOpticalFlow::Dispatch(ID3D12Resource* currentFrame,
                                        0, 2, m_timestampReadbackBuffer.Get(), 0);
     }
 
-    // Transition motion vector texture from UAV to PIXEL_SHADER_RESOURCE
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = m_motionVectorTexture.Get();
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    commandList->ResourceBarrier(1, &barrier);
-
     // Update stats
     auto endTime = std::chrono::high_resolution_clock::now();
     double dispatchTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
     m_stats.lastDispatchTimeMs = dispatchTimeMs;
     m_stats.framesProcessed++;
+    m_vectorsWritten = true;
 
     const double alpha = 0.1;
     if (m_stats.framesProcessed == 1) {
@@ -613,4 +1845,174 @@ bool SimpleOpticalFlow::Dispatch(ID3D12Resource* currentFrame,
     return true;
 }
 
+ID3D12Resource* SimpleOpticalFlow::GetLuminanceTexture(ID3D12Resource* frame) const
+{
+    for (uint32_t set = 0; set < 2; set++) {
+        if (frame && m_pyramidSource[set] == frame) {
+            return m_pyramidLuma[set][0].Get();
+        }
+    }
+    return nullptr;
+}
+
+void SimpleOpticalFlow::InvalidateLuminance()
+{
+    m_pyramidSource[0] = m_pyramidSource[1] = nullptr;
+}
+
+void SimpleOpticalFlow::RecordLuminanceFlow(D3D12_GPU_DESCRIPTOR_HANDLE frameSrvTable,
+                                            ID3D12Resource* currentFrame,
+                                            ID3D12Resource* previousFrame,
+                                            ID3D12GraphicsCommandList* commandList)
+{
+    // Each frame is converted once, when it arrives as the current frame; its
+    // luminance (and pyramid) is the next dispatch's previous frame. Only an
+    // out-of-order previous frame is converted again.
+    const uint32_t prevSet = m_lastPyramidSet;
+    const uint32_t currSet = 1 - prevSet;
+    const bool convertPrevious = m_pyramidSource[prevSet] != previousFrame;
+    if (!convertPrevious) {
+        m_stats.luminanceReuses++;
+    }
+
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+    auto transition = [&](uint32_t count, ID3D12Resource* a, ID3D12Resource* b,
+                          D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+        ID3D12Resource* resources[2] = { a, b };
+        for (uint32_t i = 0; i < count; i++) {
+            barriers[i].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[i].Transition.pResource = resources[i];
+            barriers[i].Transition.StateBefore = before;
+            barriers[i].Transition.StateAfter = after;
+            barriers[i].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        }
+        commandList->ResourceBarrier(count, barriers);
+    };
+    const D3D12_RESOURCE_STATES SRV_STATE = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    const D3D12_RESOURCE_STATES UAV_STATE = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+
+    // The scene buffer rests in PREDICATION state for the caller
+    if (m_stats.framesProcessed > 0) {
+        transition(1, m_sceneStatsBuffer.Get(), nullptr, D3D12_RESOURCE_STATE_PREDICATION, UAV_STATE);
+    }
+
+    commandList->SetComputeRootSignature(m_pyramidRootSignature.Get());
+    commandList->SetComputeRootUnorderedAccessView(3, m_sceneStatsBuffer->GetGPUVirtualAddress());
+
+    PyramidConstants constants = {};
+
+    // Level 0 luminance from the RGB frames, then 2x2 reductions per level
+    for (uint32_t level = 0; level < m_pyramidLevels; level++) {
+        const uint32_t targets = convertPrevious ? 2 : 1;
+        ID3D12Resource* current = m_pyramidLuma[currSet][level].Get();
+        ID3D12Resource* previous = m_pyramidLuma[prevSet][level].Get();
+        transition(targets, current, previous, SRV_STATE, UAV_STATE);
+
+        constants = {};
+        constants.srcWidth = level == 0 ? m_config.width : m_levelWidth[level - 1];
+        constants.srcHeight = level == 0 ? m_config.height : m_levelHeight[level - 1];
+        constants.dstWidth = m_levelWidth[level];
+        constants.dstHeight = m_levelHeight[level];
+        constants.mask = convertPrevious ? 3 : 1;
+        constants.outputScale = level == 0 ? m_downscale : 1;
+
+        commandList->SetPipelineState(level == 0 ? m_luminancePipeline.Get() : m_downsampleLumaPipeline.Get());
+        commandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        commandList->SetComputeRootDescriptorTable(1, level == 0 ? frameSrvTable
+                                                                 : GpuDescriptor(LumaTableIndex(currSet, level - 1)));
+        commandList->SetComputeRootDescriptorTable(2, GpuDescriptor(LumaTableIndex(currSet, level) + LUMA_TABLE_SRVS));
+        commandList->Dispatch((m_levelWidth[level] + 7) / 8, (m_levelHeight[level] + 7) / 8, 1);
+
+        transition(targets, current, previous, UAV_STATE, SRV_STATE);
+    }
+
+    // Match coarse to fine; each level seeds the next with its doubled vectors.
+    // Level 0 writes m_motionVectorTexture (already in UAV state) in 1/16 pixel units.
+    // The coarsest level runs the full-radius kernel unless it has predictors.
+    for (uint32_t level = m_pyramidLevels; level-- > 0;) {
+        const bool coarsest = level == m_pyramidLevels - 1;
+        const bool predictors = level == 0 && m_temporalValid;
+        const bool fullSearch = coarsest && !predictors;
+        ID3D12Resource* vectors = m_levelMotionVectors[level].Get();
+        if (level > 0) {
+            // An aliased level takes over its range from the level two
+            // coarser (this dispatch) or finer (the last one)
+            if (m_levelVectorsAliased[level]) {
+                const D3D12_RESOURCE_BARRIER aliasing = osfg::ResourceArena::GetAliasingBarrier(nullptr, vectors);
+                commandList->ResourceBarrier(1, &aliasing);
+            }
+            transition(1, vectors, nullptr, SRV_STATE, UAV_STATE);
+        }
+
+        constants = {};
+        constants.srcWidth = m_levelWidth[level];
+        constants.srcHeight = m_levelHeight[level];
+        constants.dstWidth = m_levelMvWidth[level];
+        constants.dstHeight = m_levelMvHeight[level];
+        constants.searchRadius = fullSearch ? m_coarseSearchRadius : m_refineSearchRadius;
+        constants.seedFlags = (coarsest ? 0 : 1) | (predictors ? 2 : 0) | (level == 0 ? 4 : 0);
+        constants.outputScale = level == 0 ? 16 : 1;
+
+        commandList->SetPipelineState(fullSearch ? m_matchLumaPipeline.Get() : m_refineLumaPipeline.Get());
+        commandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+        commandList->SetComputeRootDescriptorTable(1, GpuDescriptor(LumaTableIndex(currSet, level)));
+        commandList->SetComputeRootDescriptorTable(2, GpuDescriptor(MatchUavIndex(level)));
+        commandList->Dispatch(m_levelMvWidth[level], m_levelMvHeight[level], 1);
+
+        if (level > 0) {
+            transition(1, vectors, nullptr, UAV_STATE, SRV_STATE);
+        }
+    }
+
+    // Scene decision from the level 0 unmatched block count
+    D3D12_RESOURCE_BARRIER uavBarrier = {};
+    uavBarrier.Type = D3D12_RESOURCE_BARRIER_TYPE_UAV;
+    uavBarrier.UAV.pResource = m_sceneStatsBuffer.Get();
+    commandList->ResourceBarrier(1, &uavBarrier);
+
+    constants = {};
+    constants.dstWidth = m_mvWidth;
+    constants.dstHeight = m_mvHeight;
+    constants.sceneThreshold = m_config.sceneChangeThreshold;
+    commandList->SetPipelineState(m_sceneDecidePipeline.Get());
+    commandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+    commandList->Dispatch(1, 1, 1);
+
+    transition(1, m_sceneStatsBuffer.Get(), nullptr, UAV_STATE, D3D12_RESOURCE_STATE_PREDICATION);
+
+    m_pyramidSource[currSet] = currentFrame;
+    m_pyramidSource[prevSet] = previousFrame;
+    m_lastPyramidSet = currSet;
+}
+
+void SimpleOpticalFlow::RecordMotionField(ID3D12GraphicsCommandList* commandList)
+{
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = m_motionField.Get();
+    barrier.Transition.StateBefore = m_config.vectorReadState;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    commandList->ResourceBarrier(1, &barrier);
+
+    PyramidConstants constants = {};
+    constants.srcWidth = m_levelWidth[0];
+    constants.srcHeight = m_levelHeight[0];
+    constants.dstWidth = m_motionFieldWidth;
+    constants.dstHeight = m_motionFieldHeight;
+    constants.outputScale = m_downscale;
+
+    commandList->SetComputeRootSignature(m_pyramidRootSignature.Get());
+    commandList->SetComputeRootUnorderedAccessView(3, m_sceneStatsBuffer->GetGPUVirtualAddress());
+    commandList->SetPipelineState(m_motionFieldPipeline.Get());
+    commandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+    commandList->SetComputeRootDescriptorTable(1, GpuDescriptor(FIELD_TABLE_INDEX));
+    commandList->SetComputeRootDescriptorTable(2, GpuDescriptor(FIELD_TABLE_INDEX + LUMA_TABLE_SRVS));
+    commandList->Dispatch((m_motionFieldWidth + 7) / 8, (m_motionFieldHeight + 7) / 8, 1);
+
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barrier.Transition.StateAfter = m_config.vectorReadState;
+    commandList->ResourceBarrier(1, &barrier);
+}
+
 } // namespace OSFG
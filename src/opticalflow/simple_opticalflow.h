@@ -19,14 +19,68 @@
 #include <vector>
 #include <string>
 
+#include "common/pipeline_cache.h"
+#include "common/resource_arena.h"
+#include "opticalflow/motion_estimator.h"
+
 namespace OSFG {
 
 // Configuration for simple optical flow
 struct SimpleOpticalFlowConfig {
     uint32_t width = 1920;
     uint32_t height = 1080;
-    uint32_t blockSize = 8;      // Block size for matching
-    uint32_t searchRadius = 16;  // Search radius in pixels
+    uint32_t blockSize = 8;      // Block size for matching: 8 or 16
+    uint32_t searchRadius = 16;  // Search radius in pixels (rounded up to a compiled radius)
+
+    // Match on luminance downscaled by this factor (1, 2 or 4), box-filtered
+    // in the luminance pre-pass. Blocks then cover downscale * 8 frame
+    // pixels and the radius shrinks with them; vectors, confidence and the
+    // field stay in frame pixels. 8x8 blocks only (16x16 ignores it).
+    uint32_t downscale = 1;
+
+    // Coarse-to-fine pyramid search. With pyramidLevels > 1 the frames are
+    // downsampled into R16_FLOAT luminance levels; the coarsest level covers
+    // searchRadius with a small search, and every finer level refines the
+    // doubled parent vector within pyramidRefineRadius. 1 = exhaustive
+    // single-level search.
+    uint32_t pyramidLevels = 1;         // 1..MAX_PYRAMID_LEVELS
+    uint32_t pyramidRefineRadius = 2;   // Search radius at each finer level
+
+    // Use the SM 6.0 wave-reduction match kernel when the device reports wave
+    // operations and the build precompiled it or dxcompiler.dll can be
+    // loaded (falls back to the regular match kernel)
+    bool allowWaveIntrinsics = true;
+
+    // Predictive (EPZS-style) search: the full-resolution match first picks
+    // the best of a few candidate vectors (parent level, previous frame's
+    // vector at this block and its four neighbours, zero) and then only
+    // searches pyramidRefineRadius around it
+    bool temporalPredictors = false;
+
+    // Also output a half-resolution R16G16_FLOAT vector field (pixels),
+    // smoothed across blocks by match confidence, for bilinear sampling
+    bool motionField = false;
+
+    // Scene cut when more than this fraction of blocks finds no match in the
+    // previous frame (0 = off). Result is a GPU predicate, see GetSceneChangePredicate()
+    float sceneChangeThreshold = 0.5f;
+
+    // Frames are HDR10 (BT.2020 PQ, R10G10B10A2_UNORM): luminance is the
+    // PQ-coded luma scaled to SDR reference white instead of BT.709 luma
+    bool hdr10 = false;
+
+    // Resting state of the vectors, confidence and field between dispatches.
+    // Use NON_PIXEL_SHADER_RESOURCE alone when Dispatch() is recorded on
+    // COMPUTE command lists, which cannot transition pixel shader states.
+    D3D12_RESOURCE_STATES vectorReadState =
+        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+
+    // Optional on-disk PSO cache (not owned; must outlive this object)
+    osfg::PipelineCache* pipelineCache = nullptr;
+
+    // Optional heap arena for the per-resolution textures (not owned; must
+    // outlive this object). Inner pyramid vectors alias in it.
+    osfg::ResourceArena* resourceArena = nullptr;
 };
 
 // Statistics
@@ -36,12 +90,15 @@ struct SimpleOpticalFlowStats {
     double lastGpuTimeMs = 0.0;         // GPU timestamp timing
     double avgGpuTimeMs = 0.0;
     uint64_t framesProcessed = 0;
+    uint64_t luminanceReuses = 0;       // Dispatches that reused the previous frame's luminance
 };
 
-class SimpleOpticalFlow {
+class SimpleOpticalFlow final : public MotionEstimator {
 public:
+    static const uint32_t MAX_PYRAMID_LEVELS = 4;
+
     SimpleOpticalFlow();
-    ~SimpleOpticalFlow();
+    ~SimpleOpticalFlow() override;
 
     // Non-copyable
     SimpleOpticalFlow(const SimpleOpticalFlow&) = delete;
@@ -56,35 +113,106 @@ public:
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
+    const char* GetName() const override { return "Simple"; }
+
+    // Re-lay out the textures for a new frame size, keeping the pipelines
+    // (only the match kernels are rebuilt if the pyramid depth changes the
+    // coarse radius). Temporal predictors restart.
+    bool Resize(uint32_t width, uint32_t height) override;
+
     // Dispatch optical flow computation
     // currentFrame: Current frame texture (SRV)
     // previousFrame: Previous frame texture (SRV)
     // commandList: Command list to record work
     bool Dispatch(ID3D12Resource* currentFrame,
                   ID3D12Resource* previousFrame,
-                  ID3D12GraphicsCommandList* commandList);
+                  ID3D12GraphicsCommandList* commandList) override;
 
     // Get motion vector texture
-    ID3D12Resource* GetMotionVectorTexture() const { return m_motionVectorTexture.Get(); }
+    ID3D12Resource* GetMotionVectorTexture() const override { return m_motionVectorTexture.Get(); }
+
+    // Block vectors are in 1/16 pixel of the matched luminance
+    float GetMotionVectorScale() const override { return static_cast<float>(m_downscale) / 16.0f; }
+
+    // Per-block match confidence (R8_UNORM, 0 = best and runner-up SAD equal),
+    // or nullptr when blockSize != 8
+    ID3D12Resource* GetConfidenceTexture() const { return m_confidenceTexture.Get(); }
+
+    // Half-resolution (of the matched luminance) smoothed vector field
+    // (R16G16_FLOAT, frame pixels), or
+    // nullptr unless config.motionField. Vectors, confidence and field rest
+    // in config.vectorReadState between dispatches.
+    ID3D12Resource* GetMotionField() const override { return m_motionField.Get(); }
+
+    // Scene cut predicate (see MotionEstimator). nullptr when blockSize != 8.
+    ID3D12Resource* GetSceneChangePredicate() const override { return m_sceneStatsBuffer.Get(); }
 
     // Get motion vector dimensions
-    uint32_t GetMotionVectorWidth() const { return m_mvWidth; }
-    uint32_t GetMotionVectorHeight() const { return m_mvHeight; }
+    uint32_t GetMotionVectorWidth() const override { return m_mvWidth; }
+    uint32_t GetMotionVectorHeight() const override { return m_mvHeight; }
+
+    // Pyramid levels in use (1 = single-level search)
+    uint32_t GetPyramidLevels() const { return m_pyramidLevels; }
+
+    // Frame pixels per matched luminance pixel (config.downscale, 1 for 16x16 blocks)
+    uint32_t GetDownscale() const { return m_downscale; }
+
+    // Level 0 luminance (frame size / GetDownscale(), R16_FLOAT,
+    // NON_PIXEL_SHADER_RESOURCE state) of a frame passed to the last Dispatch(), or nullptr if not cached.
+    // Valid until the next Dispatch() is recorded.
+    ID3D12Resource* GetLuminanceTexture(ID3D12Resource* frame) const;
+
+    // Drop cached luminance (call when frame textures are rewritten out of order)
+    void InvalidateLuminance();
+
+    // True if the match passes use the SM 6.0 wave-reduction kernel
+    bool IsWaveMatchEnabled() const { return m_waveMatch; }
 
     // Get statistics
     const SimpleOpticalFlowStats& GetStats() const { return m_stats; }
+    double GetLastGpuTimeMs() const override { return m_stats.lastGpuTimeMs; }
 
     // Set GPU timestamp frequency (call with command queue before first dispatch)
-    void SetTimestampFrequency(ID3D12CommandQueue* cmdQueue);
+    void SetTimestampFrequency(ID3D12CommandQueue* cmdQueue) override;
 
     // Get last error
-    const std::string& GetLastError() const { return m_lastError; }
+    const std::string& GetLastError() const override { return m_lastError; }
 
 private:
     bool CreateRootSignature();
     bool CreatePipelineState();
     bool CreateResources();
+    bool CreateMotionVectorTexture();
+    bool WriteConstants();
     bool CreateDescriptorHeaps();
+    void ComputeLayout();
+    void ReleaseSizeResources();
+
+    // Luminance / pyramid passes
+    bool CreatePyramidRootSignature();
+    bool CreatePyramidPipelineStates();
+    bool CreatePyramidResources();
+    bool CreateMatchPipeline(uint32_t searchRadius, bool waveReduce,
+                             Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    static uint32_t SpecializedRadius(uint32_t radius, const uint32_t* radii, size_t count);
+    bool CompileComputeShader(const char* source, const char* entryPoint,
+                              const D3D_SHADER_MACRO* defines,
+                              ID3D12RootSignature* rootSignature,
+                              Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    bool SupportsWaveIntrinsics() const;
+    bool CompileComputeShaderDXIL(const char* source, const char* entryPoint,
+                                  const wchar_t* const* defines, uint32_t defineCount,
+                                  ID3D12RootSignature* rootSignature,
+                                  Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    HRESULT CreateComputePipeline(const std::string& name, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc,
+                                  Microsoft::WRL::ComPtr<ID3D12PipelineState>& pipelineState);
+    void RecordLuminanceFlow(D3D12_GPU_DESCRIPTOR_HANDLE frameSrvTable,
+                             ID3D12Resource* currentFrame,
+                             ID3D12Resource* previousFrame,
+                             ID3D12GraphicsCommandList* commandList);
+    void RecordMotionField(ID3D12GraphicsCommandList* commandList);
+    D3D12_CPU_DESCRIPTOR_HANDLE CpuDescriptor(uint32_t index) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GpuDescriptor(uint32_t index) const;
 
     // D3D12 objects
     Microsoft::WRL::ComPtr<ID3D12Device> m_device;
@@ -92,8 +220,87 @@ private:
     Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
 
     // Descriptor heaps
+    // Slot 0 is the motion vector UAV, followed by SRV_SETS sets of
+    // (current, previous, null, null) frame SRVs. Sets are keyed by
+    // texture and only rewritten on a miss, so in-flight command lists keep
+    // valid descriptors. The static luminance tables follow (PYRAMID_BASE).
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvUavHeap;
     uint32_t m_srvUavDescriptorSize = 0;
+    static const uint32_t SRV_SETS = 8;
+    static const uint32_t SRV_SET_SIZE = 4;
+    static const uint32_t PYRAMID_BASE = 1 + SRV_SET_SIZE * SRV_SETS;
+    // Per level: match output UAV pair (vectors, null)
+    static uint32_t MatchUavIndex(uint32_t level) { return PYRAMID_BASE + 2 * level; }
+    // Per (current pyramid set, level): SRVs (current, previous, seed,
+    // temporal vectors) then UAV pair (current, previous)
+    static const uint32_t LUMA_TABLE_SRVS = 4;
+    static const uint32_t LUMA_TABLE_SIZE = LUMA_TABLE_SRVS + 2;
+    static uint32_t LumaTableIndex(uint32_t currentSet, uint32_t level) {
+        return PYRAMID_BASE + 2 * MAX_PYRAMID_LEVELS + (currentSet * MAX_PYRAMID_LEVELS + level) * LUMA_TABLE_SIZE;
+    }
+    // Motion field pass: SRVs (vectors, confidence, null, null) then UAV pair (field, null)
+    static const uint32_t FIELD_TABLE_INDEX = PYRAMID_BASE + 2 * MAX_PYRAMID_LEVELS +
+                                              2 * MAX_PYRAMID_LEVELS * LUMA_TABLE_SIZE;
+    static const uint32_t DESCRIPTOR_COUNT = FIELD_TABLE_INDEX + LUMA_TABLE_SIZE;
+
+    // Luminance resources: two luminance pyramids, level 0 at full resolution
+    // (the current frame's is kept and reused as next frame's previous) plus
+    // vectors for each inner level. All rest in NON_PIXEL_SHADER_RESOURCE
+    // between passes. Used whenever blockSize == 8.
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> m_pyramidRootSignature;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_luminancePipeline;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_downsampleLumaPipeline;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_matchLumaPipeline;   // Coarsest level, m_coarseSearchRadius
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_refineLumaPipeline;  // Finer levels, m_refineSearchRadius
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_motionFieldPipeline;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_sceneDecidePipeline;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_sceneStatsBuffer;    // Unmatched count, predicate, cut total
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_confidenceTexture;   // Level 0, one per block
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_motionField;
+    uint32_t m_motionFieldWidth = 0;
+    uint32_t m_motionFieldHeight = 0;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_pyramidLuma[2][MAX_PYRAMID_LEVELS];  // [set][level]
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_levelMotionVectors[MAX_PYRAMID_LEVELS];  // level >= 1
+    bool m_levelVectorsAliased[MAX_PYRAMID_LEVELS] = {};  // Shares its arena range with level +-2
+    uint32_t m_levelWidth[MAX_PYRAMID_LEVELS] = {};
+    uint32_t m_levelHeight[MAX_PYRAMID_LEVELS] = {};
+    uint32_t m_levelMvWidth[MAX_PYRAMID_LEVELS] = {};
+    uint32_t m_levelMvHeight[MAX_PYRAMID_LEVELS] = {};
+    bool m_luminanceFlow = false;             // Luminance passes instead of CSMain
+    bool m_waveMatch = false;                 // The match pipelines are the SM 6.0 variants
+    HMODULE m_dxcModule = nullptr;            // dxcompiler.dll (loaded on demand)
+    bool m_dxilSupported = false;             // Device runs the build-time SM 6.0 kernels
+    uint32_t m_pyramidLevels = 1;
+    uint32_t m_coarseSearchRadius = 0;
+    uint32_t m_refineSearchRadius = 0;
+    uint32_t m_searchRadius = 0;              // CSMain radius
+    uint32_t m_downscale = 1;                 // Frame pixels per level 0 pixel
+
+    // Radii the kernels are compiled for (must match the CMake variants);
+    // configured radii round up to the next one
+    static constexpr uint32_t CSMAIN_RADII[] = { 4, 8, 12, 16 };
+    static constexpr uint32_t MATCH_RADII[] = { 2, 4, 8 };
+    ID3D12Resource* m_pyramidSource[2] = {};  // Frame each pyramid set was built from
+    uint32_t m_lastPyramidSet = 0;            // Set built for the last current frame
+
+    // Previous dispatch's level 0 vectors (temporal predictors), copied from
+    // m_motionVectorTexture at the start of each dispatch
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_temporalVectors;
+    bool m_temporalValid = false;             // m_temporalVectors holds real vectors this dispatch
+    bool m_vectorsWritten = false;            // A dispatch has run since the vectors were (re)created
+
+    // Root constants for the pyramid passes (must match shader)
+    struct PyramidConstants {
+        uint32_t srcWidth;
+        uint32_t srcHeight;
+        uint32_t dstWidth;
+        uint32_t dstHeight;
+        uint32_t searchRadius;
+        uint32_t seedFlags;     // Bit 0: parent level seed, bit 1: temporal predictors
+        uint32_t mask;
+        uint32_t outputScale;
+        float sceneThreshold;
+    };
 
     // Resources
     Microsoft::WRL::ComPtr<ID3D12Resource> m_motionVectorTexture;
@@ -109,10 +316,16 @@ private:
     SimpleOpticalFlowStats m_stats;
     std::string m_lastError;
 
-    // Cached texture pointers for descriptor caching
-    ID3D12Resource* m_cachedCurrentFrame = nullptr;
-    ID3D12Resource* m_cachedPreviousFrame = nullptr;
-    bool m_descriptorsValid = false;
+    // Cached texture pointers for descriptor caching (one entry per SRV set)
+    struct SrvSetKey {
+        ID3D12Resource* currentFrame = nullptr;
+        ID3D12Resource* previousFrame = nullptr;
+    };
+    SrvSetKey m_srvSetKeys[SRV_SETS];
+    uint32_t m_nextSrvSet = 0;
+
+    // Returns the SRV set index for these inputs, writing it on a miss
+    uint32_t GetSrvSet(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame);
 
     // GPU timing resources
     Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_timestampQueryHeap;
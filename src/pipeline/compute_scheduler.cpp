@@ -0,0 +1,239 @@
+// OSFG - Open Source Frame Generation
+// Compute Scheduler Implementation
+
+#include "compute_scheduler.h"
+
+#include <algorithm>
+
+#pragma comment(lib, "d3d12.lib")
+
+namespace osfg {
+
+ComputeScheduler::~ComputeScheduler() {
+    Shutdown();
+}
+
+bool ComputeScheduler::Initialize(ID3D12Device* device, const ComputeSchedulerConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!device) {
+        m_lastError = "Device is null";
+        return false;
+    }
+
+    m_device = device;
+    m_config = config;
+    m_config.maxQueuedSubmissions = (std::max)(config.maxQueuedSubmissions, 1u);
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue)))) {
+        m_lastError = "Failed to create compute queue";
+        Shutdown();
+        return false;
+    }
+
+    if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_queueFence)))) {
+        m_lastError = "Failed to create scheduler fence";
+        Shutdown();
+        return false;
+    }
+
+    m_wakeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_wakeEvent) {
+        m_lastError = "Failed to create scheduler event";
+        Shutdown();
+        return false;
+    }
+
+    m_queueFenceValue = 0;
+    m_registeredQueueValue = 0;
+    m_nextSequence = 0;
+    m_stopping = false;
+    m_stats = ComputeSchedulerStats();
+    m_thread = std::thread(&ComputeScheduler::ThreadProc, this);
+
+    m_initialized = true;
+    return true;
+}
+
+void ComputeScheduler::Shutdown() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        SetEvent(m_wakeEvent);
+        m_thread.join();
+    }
+
+    // Its own event: m_wakeEvent may still have completions registered
+    if (m_queueFence && m_queueFence->GetCompletedValue() < m_queueFenceValue) {
+        HANDLE drained = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (drained) {
+            m_queueFence->SetEventOnCompletion(m_queueFenceValue, drained);
+            WaitForSingleObject(drained, 5000);
+            CloseHandle(drained);
+        }
+    }
+
+    if (m_wakeEvent) {
+        CloseHandle(m_wakeEvent);
+        m_wakeEvent = nullptr;
+    }
+
+    m_pending.clear();
+    m_executing.clear();
+    m_queueFence.Reset();
+    m_queue.Reset();
+    m_device.Reset();
+    m_queueFenceValue = 0;
+    m_initialized = false;
+}
+
+bool ComputeScheduler::Submit(const ComputeSubmission& submission) {
+    if (!submission.commandList || !submission.signalFence) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_initialized || m_stopping) {
+            m_lastError = "Scheduler not running";
+            return false;
+        }
+
+        Pending pending;
+        pending.submission = submission;
+        pending.sequence = m_nextSequence++;
+        m_pending.push_back(pending);
+        m_stats.maxPending = (std::max)(m_stats.maxPending, static_cast<uint32_t>(m_pending.size()));
+    }
+
+    SetEvent(m_wakeEvent);
+    return true;
+}
+
+ComputeSchedulerStats ComputeScheduler::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+uint32_t ComputeScheduler::FirstUnmetWait(const ComputeSubmission& submission) {
+    for (uint32_t i = 0; i < MAX_WAITS; i++) {
+        const ComputeSubmission::Wait& wait = submission.waits[i];
+        if (wait.fence && wait.fence->GetCompletedValue() < wait.value) {
+            return i;
+        }
+    }
+    return MAX_WAITS;
+}
+
+void ComputeScheduler::Execute(const Pending& pending, bool gpuWaits) {
+    const ComputeSubmission& submission = pending.submission;
+    if (gpuWaits) {
+        for (const ComputeSubmission::Wait& wait : submission.waits) {
+            if (wait.fence) {
+                m_queue->Wait(wait.fence.Get(), wait.value);
+            }
+        }
+    }
+
+    ID3D12CommandList* lists[] = { submission.commandList.Get() };
+    m_queue->ExecuteCommandLists(1, lists);
+    m_queue->Signal(submission.signalFence.Get(), submission.signalValue);
+    m_queue->Signal(m_queueFence.Get(), ++m_queueFenceValue);
+    m_executing.emplace_back(m_queueFenceValue, submission);
+}
+
+void ComputeScheduler::ReleaseCompleted() {
+    const uint64_t completed = m_queueFence->GetCompletedValue();
+    while (!m_executing.empty() && m_executing.front().first <= completed) {
+        m_executing.pop_front();
+    }
+}
+
+void ComputeScheduler::ThreadProc() {
+    auto earlier = [](const Pending& a, const Pending& b) {
+        if (a.submission.deadline != b.submission.deadline) {
+            return a.submission.deadline < b.submission.deadline;
+        }
+        return a.sequence < b.sequence;
+    };
+
+    std::vector<Pending> remaining;
+    for (;;) {
+        ReleaseCompleted();
+
+        Pending next;
+        bool haveNext = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_stopping) {
+                remaining.swap(m_pending);
+                break;
+            }
+
+            const uint64_t completed = m_queueFence->GetCompletedValue();
+            const bool queueFull = m_queueFenceValue - completed >= m_config.maxQueuedSubmissions;
+
+            // Earliest deadline among the ready submissions. The others get
+            // the wake event set on the fence they are waiting for.
+            size_t best = m_pending.size();
+            uint64_t oldest = UINT64_MAX;
+            for (size_t i = 0; i < m_pending.size(); i++) {
+                Pending& pending = m_pending[i];
+                oldest = (std::min)(oldest, pending.sequence);
+
+                const uint32_t unmet = FirstUnmetWait(pending.submission);
+                if (unmet < MAX_WAITS) {
+                    if (pending.registeredWait != unmet) {
+                        const ComputeSubmission::Wait& wait = pending.submission.waits[unmet];
+                        wait.fence->SetEventOnCompletion(wait.value, m_wakeEvent);
+                        pending.registeredWait = unmet;
+                    }
+                    continue;
+                }
+                if (best == m_pending.size() || earlier(pending, m_pending[best])) {
+                    best = i;
+                }
+            }
+
+            if (best < m_pending.size() && !queueFull) {
+                next = m_pending[best];
+                m_pending.erase(m_pending.begin() + best);
+                haveNext = true;
+
+                m_stats.submissions++;
+                if (next.sequence > oldest) {
+                    m_stats.reordered++;
+                }
+                if (std::chrono::high_resolution_clock::now() > next.submission.deadline) {
+                    m_stats.late++;
+                }
+            } else if (queueFull && m_registeredQueueValue != completed + 1) {
+                m_queueFence->SetEventOnCompletion(completed + 1, m_wakeEvent);
+                m_registeredQueueValue = completed + 1;
+            }
+        }
+
+        if (haveNext) {
+            Execute(next, false);
+            continue;
+        }
+        WaitForSingleObject(m_wakeEvent, WAKE_TIMEOUT_MS);
+    }
+
+    // Nothing may be dropped: a pipeline's allocator retires only once its
+    // list has run. What is still held goes out in deadline order, with its
+    // waits on the GPU queue instead.
+    std::sort(remaining.begin(), remaining.end(), earlier);
+    for (const Pending& pending : remaining) {
+        Execute(pending, true);
+    }
+}
+
+} // namespace osfg
@@ -0,0 +1,151 @@
+// OSFG - Open Source Frame Generation
+// Compute Scheduler
+//
+// One COMPUTE queue on the secondary GPU shared by several pipelines (one
+// per captured output). Each pipeline hands over its closed flow and
+// interpolation command list for a base frame together with the fences it
+// depends on and a deadline. A submission becomes ready once its fences
+// have completed, so the shared queue never stalls on one output's transfer
+// or present while another output's frame could run. Ready submissions go
+// to the GPU earliest deadline first, and only a couple are queued on the
+// GPU at a time, so a frame that falls due sooner can still overtake work
+// that was handed over earlier.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Configuration for the compute scheduler
+struct ComputeSchedulerConfig {
+    // Submissions executing or waiting on the GPU queue at once. 1 decides
+    // at every completion but leaves the queue idle while the CPU submits
+    // the next; 2 keeps it fed.
+    uint32_t maxQueuedSubmissions = 2;
+};
+
+// One base frame's compute work. The scheduler keeps its own references to
+// the list and fences until the GPU has run it, so a pipeline that shuts
+// down while its work is still held cannot pull them out from under it.
+struct ComputeSubmission {
+    static const uint32_t MAX_WAITS = 2;
+
+    ComPtr<ID3D12CommandList> commandList;      // Closed; not executed before the waits complete
+    struct Wait {
+        ComPtr<ID3D12Fence> fence;              // nullptr = unused
+        uint64_t value = 0;
+    } waits[MAX_WAITS];
+    ComPtr<ID3D12Fence> signalFence;            // Signalled to signalValue after the list
+    uint64_t signalValue = 0;
+    std::chrono::high_resolution_clock::time_point deadline;   // When the output needs the result
+};
+
+// Scheduler statistics
+struct ComputeSchedulerStats {
+    uint64_t submissions = 0;       // Executed on the queue
+    uint64_t reordered = 0;         // Executed ahead of a submission handed over earlier
+    uint64_t late = 0;              // Executed after their deadline had passed
+    uint32_t maxPending = 0;        // Most submissions held at once
+};
+
+class ComputeScheduler {
+public:
+    ComputeScheduler() = default;
+    ~ComputeScheduler();
+
+    // Non-copyable
+    ComputeScheduler(const ComputeScheduler&) = delete;
+    ComputeScheduler& operator=(const ComputeScheduler&) = delete;
+
+    // Create the shared COMPUTE queue on `device` and start the scheduling thread
+    bool Initialize(ID3D12Device* device, const ComputeSchedulerConfig& config = {});
+
+    // Execute everything still held (fence waits then go to the GPU queue),
+    // wait for the queue to drain and stop the thread
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // The shared queue: for timestamp frequencies and one-off work. Per-frame
+    // work goes through Submit(), or it bypasses the deadline order.
+    ID3D12CommandQueue* GetQueue() const { return m_queue.Get(); }
+
+    // Hand over a frame's work (any thread). The command list, and the
+    // allocator it was recorded from, stay in use until signalFence reaches
+    // signalValue; the list and fences are referenced until then.
+    bool Submit(const ComputeSubmission& submission);
+
+    // Any thread
+    ComputeSchedulerStats GetStats() const;
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // Limit on one sleep of the thread; completions normally wake it first
+    static const DWORD WAKE_TIMEOUT_MS = 2;
+
+    static const uint32_t MAX_WAITS = ComputeSubmission::MAX_WAITS;
+
+    struct Pending {
+        ComputeSubmission submission;
+        uint64_t sequence = 0;      // Hand-over order
+        uint32_t registeredWait = MAX_WAITS;    // Wait m_wakeEvent is set on (MAX_WAITS = none)
+    };
+
+    void ThreadProc();
+    // Drop the references of executed submissions the queue has finished
+    void ReleaseCompleted();
+    // First wait of `submission` that has not completed (MAX_WAITS = ready)
+    static uint32_t FirstUnmetWait(const ComputeSubmission& submission);
+    void Execute(const Pending& pending, bool gpuWaits);
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12CommandQueue> m_queue;
+
+    // Counts executions on the queue, so the thread knows how many are in flight
+    ComPtr<ID3D12Fence> m_queueFence;
+    uint64_t m_queueFenceValue = 0;         // Scheduling thread only
+    uint64_t m_registeredQueueValue = 0;    // Value m_wakeEvent was last set on
+    // Executed submissions by the m_queueFence value that retires them
+    // (scheduling thread, then Shutdown())
+    std::deque<std::pair<uint64_t, ComputeSubmission>> m_executing;
+
+    ComputeSchedulerConfig m_config;
+    std::thread m_thread;
+    HANDLE m_wakeEvent = nullptr;           // Submit(), queue completions and fence waits
+
+    // Guards everything below
+    mutable std::mutex m_mutex;
+    std::vector<Pending> m_pending;
+    uint64_t m_nextSequence = 0;
+    bool m_stopping = false;
+    ComputeSchedulerStats m_stats;
+
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
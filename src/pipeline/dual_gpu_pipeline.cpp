@@ -3,18 +3,29 @@
 
 #include "dual_gpu_pipeline.h"
 #include "capture/dxgi_capture.h"
+#include "capture/wgc_capture.h"
 #include "transfer/gpu_transfer.h"
+#include "transfer/local_frame_ring.h"
+#include "shared_gpu_context.h"
 #include "opticalflow/simple_opticalflow.h"
+#include "opticalflow/osfg_opticalflow.h"
 #include "interpolation/frame_interpolation.h"
 #include "presentation/simple_presenter.h"
+#include "presentation/frame_upscaler.h"
+#include "presentation/overlay_compositor.h"
 #include "ffx/ffx_loader.h"
 #include "ffx/ffx_framegen.h"
 
+#include <avrt.h>
+
 #include <algorithm>
+#include <deque>
 #include <sstream>
+#include <utility>
 
 #pragma comment(lib, "d3d12.lib")
 #pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "avrt.lib")
 
 namespace osfg {
 
@@ -24,18 +35,62 @@ DualGPUPipeline::~DualGPUPipeline() {
     Shutdown();
 }
 
-bool DualGPUPipeline::Initialize(const DualGPUConfig& config) {
+bool DualGPUPipeline::Initialize(const DualGPUConfig& config, SharedGPUContext* sharedContext) {
     if (m_initialized) {
         Shutdown();
     }
 
     m_config = config;
+    m_requestedConfig = config;
     m_frameGenEnabled = config.enableFrameGen;
+    m_vsync = config.vsync;
+    m_multiplier = config.multiplier;
+    m_singleGPU = config.singleGPU || config.primaryGPU == config.secondaryGPU;
+
+    if (sharedContext) {
+        if (!sharedContext->IsInitialized() || m_singleGPU ||
+            sharedContext->GetPrimaryGPU() != config.primaryGPU ||
+            sharedContext->GetSecondaryGPU() != config.secondaryGPU) {
+            SetError("Shared GPU context does not match the configured GPUs");
+            return false;
+        }
+        // The serial loop would hold every output's compute work behind its
+        // own capture wait
+        if (!config.pipelinedMode) {
+            SetError("A shared GPU context requires pipelinedMode");
+            return false;
+        }
+        m_sharedContext = sharedContext;
+        m_computeScheduler = sharedContext->GetComputeScheduler();
+    }
+
+    // Pipelined mode keeps up to three transfer buffers alive at once
+    // (previous, current and the one being written)
+    if (m_config.pipelinedMode && m_config.transferBufferCount < 3) {
+        m_config.transferBufferCount = 3;
+    }
 
-    // Calculate target frame time based on multiplier
-    // Assume 60fps base, multiply by frame gen factor
-    double baseFrameTimeMs = 16.667;  // 60 fps
-    m_targetFrameTimeMs = baseFrameTimeMs / static_cast<int>(config.multiplier);
+    // What memory and quality steps reduce from
+    m_configuredSettings.transferBufferCount = m_config.transferBufferCount;
+    m_configuredSettings.opticalFlowBlockSize = m_config.opticalFlowBlockSize;
+    m_configuredSettings.opticalFlowSearchRadius = m_config.opticalFlowSearchRadius;
+    m_configuredSettings.opticalFlowMotionField = m_config.opticalFlowMotionField;
+    m_configuredSettings.multiplier = m_config.multiplier;
+
+    LARGE_INTEGER qpcFrequency;
+    QueryPerformanceFrequency(&qpcFrequency);
+    m_qpcToMs = 1000.0 / static_cast<double>(qpcFrequency.QuadPart);
+
+    // Not fatal: the pipeline simply runs without frame records
+    if (config.frameRecordCapacity > 0) {
+        FrameRecorderConfig recorderConfig;
+        recorderConfig.capacity = config.frameRecordCapacity;
+        recorderConfig.traceLogging = config.frameRecordTraceLogging;
+        if (!m_frameRecorder.Initialize(recorderConfig)) {
+            ReportError("Frame recorder disabled: " + m_frameRecorder.GetLastError());
+        }
+    }
+    m_serialFrameNumber = 0;
 
     // Select backend
     if (config.backend == FrameGenBackend::Auto) {
@@ -53,13 +108,19 @@ bool DualGPUPipeline::Initialize(const DualGPUConfig& config) {
         m_activeBackend = FrameGenBackend::Native;
     }
 
+    // Reduced-size interpolation writes generated frames for the present
+    // pass to upscale, so it cannot draw straight into the back buffer
+    m_interpolationDownscale =
+        (m_activeBackend == FrameGenBackend::Native && config.interpolationDownscale >= 2) ? 2 : 1;
+    m_directOutput = config.interpolateToBackBuffer && m_interpolationDownscale == 1;
+
     // Initialize pipeline stages
     if (!InitializeCapture()) {
         Shutdown();
         return false;
     }
 
-    if (!InitializeTransfer()) {
+    if (!(m_singleGPU ? InitializeLocalFrames() : InitializeTransfer())) {
         Shutdown();
         return false;
     }
@@ -69,19 +130,45 @@ bool DualGPUPipeline::Initialize(const DualGPUConfig& config) {
         return false;
     }
 
-    if (!InitializePresentation()) {
+    // Flow and interpolation PSOs are most of the startup time: build them on
+    // a worker while this thread creates the window and swap chain (the
+    // window belongs to this thread). The FidelityFX swap chain is created
+    // from the flow field, so that backend goes in order.
+    bool frameGenReady = false;
+    bool presentationReady = false;
+    if (m_activeBackend == FrameGenBackend::FidelityFX) {
+        frameGenReady = InitializeFrameGeneration();
+        presentationReady = frameGenReady && InitializePresentation();
+    } else {
+        std::thread frameGenThread([this, &frameGenReady] { frameGenReady = InitializeFrameGeneration(); });
+        presentationReady = InitializePresentation();
+        frameGenThread.join();
+    }
+
+    if (!frameGenReady || !presentationReady || !InitializeUpscaler()) {
         Shutdown();
         return false;
     }
 
     m_initialized = true;
+
+    // No stage runs yet: apply the reset here so GetStats() starts clean
     ResetStats();
+    PublishCaptureStats();
+    PublishComputeStats();
+    PublishPresentStats();
+    PublishAdaptationStats();
 
     return true;
 }
 
 void DualGPUPipeline::Shutdown() {
     Stop();
+    CancelFlowRebuild();
+
+    if (m_initialized && !m_config.frameRecordPath.empty()) {
+        WriteFrameRecords(m_config.frameRecordPath);
+    }
 
     // Wait for GPU work to complete
     if (m_computeFence && m_computeFenceEvent) {
@@ -90,54 +177,135 @@ void DualGPUPipeline::Shutdown() {
             WaitForSingleObject(m_computeFenceEvent, 5000);
         }
     }
+    if (m_presentFence && m_presentFenceEvent) {
+        if (m_presentFence->GetCompletedValue() < m_presentFenceValue) {
+            m_presentFence->SetEventOnCompletion(m_presentFenceValue, m_presentFenceEvent);
+            WaitForSingleObject(m_presentFenceEvent, 5000);
+        }
+    }
 
     // Release in reverse order
     // FFX backend
     m_ffxFrameGen.reset();
 
     // Native backend
+    m_pacer.Shutdown();
+    m_overlay.reset();
+    m_upscaler.reset();
     m_presenter.reset();
     m_interpolation.reset();
     m_opticalFlow.reset();
+    m_pipelineCache.Shutdown();
 
-    for (auto& frame : m_generatedFrames) {
-        frame.Reset();
+    for (auto& set : m_generatedFrames) {
+        for (auto& frame : set) {
+            frame.Reset();
+        }
     }
+    for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+        m_presentMotion[set].Reset();
+        m_presentPredicates[set].Reset();
+    }
+    ReleaseArenaResources();
+    for (uint64_t& value : m_generatedRetireValues) {
+        value = 0;
+    }
+    m_generatedSet = 0;
+    m_resizePending = false;
+    m_frameFence = nullptr;
+    m_frameFenceValue = 0;
+    m_bufferRetireValues.clear();
 
     if (m_computeFenceEvent) {
         CloseHandle(m_computeFenceEvent);
         m_computeFenceEvent = nullptr;
     }
+    if (m_presentFenceEvent) {
+        CloseHandle(m_presentFenceEvent);
+        m_presentFenceEvent = nullptr;
+    }
 
+    // Rings reference the fences, so they go first
+    m_presentRing.Shutdown();
+    m_computeRing.Shutdown();
+    m_computeCommandList = nullptr;
+    m_presentProfiler.Shutdown();
+    m_computeProfiler.Shutdown();
+    m_frameRecorder.Shutdown();
+    m_memoryBudget.Shutdown();
+    m_memorySteps.clear();
+    m_qualitySteps.clear();
+
+    m_presentFence.Reset();
     m_computeFence.Reset();
-    m_computeCommandList.Reset();
-    m_computeAllocator.Reset();
     m_computeQueue.Reset();
+    m_presentQueue.Reset();
     m_computeDevice.Reset();
 
+    m_computeArena = nullptr;
+    m_localArena.Shutdown();
     m_transfer.reset();
+    m_localFrames.reset();
     m_capture.reset();
+    m_computeScheduler = nullptr;
+    m_sharedContext = nullptr;
 
     m_initialized = false;
 }
 
 bool DualGPUPipeline::InitializeCapture() {
-    m_capture = std::make_unique<DXGICapture>();
-
     CaptureConfig captureConfig;
     captureConfig.adapterIndex = m_config.primaryGPU;
     captureConfig.outputIndex = m_config.captureMonitor;
     captureConfig.timeoutMs = m_config.captureTimeoutMs;
+    captureConfig.window = m_config.captureWindow;
+    captureConfig.captureCursor = m_config.captureCursor;
+    captureConfig.hdr = m_config.hdr && !m_singleGPU;   // The single-GPU ring holds frames as captured
+
+    const bool autoSelect = m_config.captureMethod == CaptureMethod::Auto;
+    m_captureMethod = m_config.captureMethod;
+    if (autoSelect) {
+        m_captureMethod = m_config.captureWindow && WGCCapture::IsSupported()
+            ? CaptureMethod::WindowsGraphicsCapture : CaptureMethod::DXGIDesktopDup;
+    }
+
+    if (m_captureMethod == CaptureMethod::WindowsGraphicsCapture) {
+        m_capture = std::make_unique<WGCCapture>();
+    } else {
+        m_capture = std::make_unique<DXGICapture>();
+    }
 
     if (!m_capture->Initialize(captureConfig)) {
-        SetError("Failed to initialize capture: " + m_capture->GetLastError());
-        return false;
+        std::string error = m_capture->GetLastError();
+
+        // Desktop Duplication can be unavailable (another duplicating app,
+        // some secure desktops) where WGC still works
+        bool recovered = false;
+        if (autoSelect && m_captureMethod == CaptureMethod::DXGIDesktopDup && WGCCapture::IsSupported()) {
+            m_capture = std::make_unique<WGCCapture>();
+            m_captureMethod = CaptureMethod::WindowsGraphicsCapture;
+            recovered = m_capture->Initialize(captureConfig);
+            if (!recovered) {
+                error += "; Windows.Graphics.Capture: " + m_capture->GetLastError();
+            }
+        }
+        if (!recovered) {
+            SetError("Failed to initialize capture: " + error);
+            return false;
+        }
     }
 
     // Update config with actual capture dimensions
     m_config.width = m_capture->GetWidth();
     m_config.height = m_capture->GetHeight();
 
+    // FP16 captures cross as HDR10 and everything after the transfer
+    // (flow, interpolation, generated frames, back buffers) works on that
+    m_hdr = m_capture->GetFormat() == DXGI_FORMAT_R16G16B16A16_FLOAT;
+    m_backBufferFormat = m_hdr ? OSFG::SimplePresenter::HDR10_BACK_BUFFER_FORMAT
+                               : OSFG::SimplePresenter::BACK_BUFFER_FORMAT;
+    m_stats.hdr = m_hdr;
+
     return true;
 }
 
@@ -149,472 +317,2289 @@ bool DualGPUPipeline::InitializeTransfer() {
     transferConfig.destAdapterIndex = m_config.secondaryGPU;
     transferConfig.width = m_config.width;
     transferConfig.height = m_config.height;
+    transferConfig.format = m_capture->GetFormat();
     transferConfig.bufferCount = m_config.transferBufferCount;
     transferConfig.preferPeerToPeer = m_config.preferPeerToPeer;
+    transferConfig.createIngestTextures = true;
+    transferConfig.gpuProfiling = m_config.gpuProfiling;
+    transferConfig.encoding = m_hdr ? TransferEncoding::HDR10 : m_config.transferEncoding;
+    if (m_sharedContext) {
+        transferConfig.sourceDevice = m_sharedContext->GetPrimaryDevice();
+        transferConfig.destDevice = m_sharedContext->GetSecondaryDevice();
+        transferConfig.sourceArena = m_sharedContext->GetPrimaryArena();
+        transferConfig.destArena = m_sharedContext->GetSecondaryArena();
+    }
 
     if (!m_transfer->Initialize(transferConfig)) {
         SetError("Failed to initialize transfer: " + m_transfer->GetLastError());
         return false;
     }
 
+    if (!ShareFrameRing()) {
+        return false;
+    }
+
     // Get the destination device for compute operations
     m_computeDevice = m_transfer->GetDestDevice();
-    m_computeQueue = m_transfer->GetDestCommandQueue();
+    m_computeArena = m_transfer->GetDestArena();
+    m_presentQueue = m_transfer->GetDestCommandQueue();
+    m_frameFence = m_transfer->GetDestFence();
 
     return true;
 }
 
-bool DualGPUPipeline::InitializeCompute() {
-    HRESULT hr;
+bool DualGPUPipeline::InitializeLocalFrames() {
+    m_localFrames = std::make_unique<LocalFrameRing>();
 
-    // Create command allocator
-    hr = m_computeDevice->CreateCommandAllocator(
-        D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(&m_computeAllocator));
-    if (FAILED(hr)) {
-        SetError("Failed to create compute command allocator");
-        return false;
-    }
+    LocalFrameRingConfig ringConfig;
+    ringConfig.adapterIndex = m_config.primaryGPU;
+    ringConfig.width = m_config.width;
+    ringConfig.height = m_config.height;
+    ringConfig.bufferCount = m_config.transferBufferCount;
 
-    // Create command list
-    hr = m_computeDevice->CreateCommandList(
-        0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_computeAllocator.Get(), nullptr,
-        IID_PPV_ARGS(&m_computeCommandList));
-    if (FAILED(hr)) {
-        SetError("Failed to create compute command list");
+    if (!m_localFrames->Initialize(ringConfig)) {
+        SetError("Failed to initialize frame ring: " + m_localFrames->GetLastError());
         return false;
     }
-    m_computeCommandList->Close();
 
-    // Create fence
-    hr = m_computeDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_computeFence));
-    if (FAILED(hr)) {
-        SetError("Failed to create compute fence");
+    if (!ShareFrameRing()) {
         return false;
     }
 
-    m_computeFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!m_computeFenceEvent) {
-        SetError("Failed to create compute fence event");
-        return false;
-    }
+    m_computeDevice = m_localFrames->GetDevice();
+    m_presentQueue = m_localFrames->GetCommandQueue();
 
-    // Initialize optical flow
-    m_opticalFlow = std::make_unique<OSFG::SimpleOpticalFlow>();
+    // The ring's textures are shared with the capture device and stay
+    // committed; the arena holds the compute side's. Not fatal: resources
+    // are then committed one by one.
+    m_localArena.Initialize(m_computeDevice.Get());
+    m_computeArena = &m_localArena;
+    m_frameFence = m_localFrames->GetFence();
 
-    OSFG::SimpleOpticalFlowConfig ofConfig;
-    ofConfig.width = m_config.width;
-    ofConfig.height = m_config.height;
-    ofConfig.blockSize = m_config.opticalFlowBlockSize;
-    ofConfig.searchRadius = m_config.opticalFlowSearchRadius;
+    return true;
+}
 
-    if (!m_opticalFlow->Initialize(m_computeDevice.Get(), ofConfig)) {
-        SetError("Failed to initialize optical flow: " + m_opticalFlow->GetLastError());
-        return false;
+bool DualGPUPipeline::ShareFrameRing() {
+    // Let the capture device write captured frames straight into the ring's
+    // shared textures: the transfer's ingest textures on the primary GPU, or
+    // (single GPU) the textures frame generation and presentation read in place
+    const uint32_t count = GetFrameBufferCount();
+    std::vector<HANDLE> handles(count);
+    for (uint32_t i = 0; i < count; i++) {
+        handles[i] = m_singleGPU ? m_localFrames->GetTextureHandle(i) : m_transfer->GetIngestTextureHandle(i);
+    }
+    HANDLE fenceHandle = m_singleGPU ? m_localFrames->GetFenceHandle() : m_transfer->GetIngestFenceHandle();
+    m_stagedIngest = false;
+    if (!m_capture->OpenSharedTargets(handles.data(), count, fenceHandle)) {
+        if (m_singleGPU) {
+            SetError("Failed to share frame ring with capture: " + m_capture->GetLastError());
+            return false;
+        }
+        // No D3D11.4 or NT-handle sharing: stage through CPU memory
+        m_stagedIngest = true;
+        ReportError("Shared capture targets unavailable, staging frames through the CPU: " +
+                    m_capture->GetLastError());
     }
 
-    // Initialize interpolation
-    m_interpolation = std::make_unique<OSFG::FrameInterpolation>();
+    // Present fence value after which each ring buffer is no longer read
+    m_bufferRetireValues.assign(count, 0);
 
-    OSFG::FrameInterpolationConfig interpConfig;
-    interpConfig.width = m_config.width;
-    interpConfig.height = m_config.height;
+    return true;
+}
 
-    if (!m_interpolation->Initialize(m_computeDevice.Get(), interpConfig)) {
-        SetError("Failed to initialize interpolation: " + m_interpolation->GetLastError());
-        return false;
-    }
+uint32_t DualGPUPipeline::GetFrameBufferCount() const {
+    return m_singleGPU ? m_localFrames->GetBufferCount() : m_transfer->GetBufferCount();
+}
+
+uint32_t DualGPUPipeline::GetFrameBufferIndex() const {
+    return m_singleGPU ? m_localFrames->GetCurrentBufferIndex() : m_transfer->GetCurrentBufferIndex();
+}
 
-    // Create frame buffers for generated frames
-    m_generatedFrameCount = static_cast<uint32_t>(m_config.multiplier) - 1;
+ID3D12Resource* DualGPUPipeline::GetFrameTexture(uint32_t bufferIndex) const {
+    return m_singleGPU ? m_localFrames->GetTexture(bufferIndex) : m_transfer->GetDestinationTexture(bufferIndex);
+}
+
+void DualGPUPipeline::AdvanceFrameBuffer() {
+    if (m_singleGPU) {
+        m_localFrames->AdvanceBuffer();
+    } else {
+        m_transfer->AdvanceBuffer();
+    }
+}
 
-    D3D12_HEAP_PROPERTIES heapProps = {};
-    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+PipelineCache* DualGPUPipeline::GetPipelineCache() {
+    if (m_sharedContext) {
+        return m_sharedContext->GetPipelineCache();
+    }
+    return m_pipelineCache.IsInitialized() ? &m_pipelineCache : nullptr;
+}
 
-    D3D12_RESOURCE_DESC texDesc = {};
-    texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    texDesc.Width = m_config.width;
-    texDesc.Height = m_config.height;
-    texDesc.DepthOrArraySize = 1;
-    texDesc.MipLevels = 1;
-    texDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-    texDesc.SampleDesc.Count = 1;
-    texDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+bool DualGPUPipeline::InitializeCompute() {
+    HRESULT hr;
 
-    for (uint32_t i = 0; i < m_generatedFrameCount; i++) {
-        hr = m_computeDevice->CreateCommittedResource(
-            &heapProps, D3D12_HEAP_FLAG_NONE,
-            &texDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-            nullptr, IID_PPV_ARGS(&m_generatedFrames[i]));
+    // Dedicated compute queue: flow and interpolation of frame N overlap the
+    // present copies and flips of frame N-1 and the copy-queue transfer of
+    // frame N+1. Fences order the three queues. With a shared context the
+    // queue is the scheduler's, shared by every output.
+    if (m_computeScheduler) {
+        m_computeQueue = m_computeScheduler->GetQueue();
+    } else {
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+        queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
 
+        hr = m_computeDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_computeQueue));
         if (FAILED(hr)) {
-            SetError("Failed to create generated frame buffer " + std::to_string(i));
+            SetError("Failed to create compute queue");
             return false;
         }
     }
 
-    return true;
-}
-
-bool DualGPUPipeline::InitializePresentation() {
-    m_presenter = std::make_unique<OSFG::SimplePresenter>();
+    // Create command allocator ring (one entry per base frame in flight)
+    if (!m_computeRing.Initialize(m_computeDevice.Get(), D3D12_COMMAND_LIST_TYPE_COMPUTE,
+                                  COMPUTE_FRAMES_IN_FLIGHT)) {
+        SetError("Failed to create compute command ring: " + m_computeRing.GetLastError());
+        return false;
+    }
 
-    OSFG::PresenterConfig presConfig;
-    presConfig.width = m_config.width;
-    presConfig.height = m_config.height;
-    presConfig.vsync = m_config.vsync;
-    presConfig.windowed = m_config.borderlessWindow;
-    presConfig.windowTitle = m_config.windowTitle;
-    presConfig.bufferCount = 2;
+    // One timestamp slot per frame in flight plus the one being recorded.
+    // Not fatal: the GPU times just stay 0.
+    if (m_config.gpuProfiling) {
+        m_computeProfiler.Initialize(m_computeDevice.Get(), m_computeQueue.Get(),
+                                     COMPUTE_FRAMES_IN_FLIGHT + 1);
+    }
 
-    if (!m_presenter->Initialize(m_computeDevice.Get(), m_computeQueue.Get(), presConfig)) {
-        SetError("Failed to initialize presenter: " + m_presenter->GetLastError());
+    // Create fence
+    hr = m_computeDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_computeFence));
+    if (FAILED(hr)) {
+        SetError("Failed to create compute fence");
         return false;
     }
 
-    return true;
-}
-
-bool DualGPUPipeline::Start() {
-    if (!m_initialized) {
-        SetError("Pipeline not initialized");
+    m_computeFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_computeFenceEvent) {
+        SetError("Failed to create compute fence event");
         return false;
     }
 
-    if (m_running) {
-        return true;  // Already running
+    // On-disk PSO cache for both modules. Not fatal: without it every start
+    // simply creates the PSOs from bytecode again. A shared context has one
+    // for every output.
+    if (m_config.pipelineCache && !m_sharedContext) {
+        m_pipelineCache.Initialize(m_computeDevice.Get());
     }
 
-    m_running = true;
-    m_lastPresentTime = std::chrono::high_resolution_clock::now();
+    // Not fatal: without it the vram stats stay 0 and nothing adapts
+    if (!m_memoryBudget.Initialize(m_computeDevice.Get())) {
+        ReportError("Video memory budget unavailable: " + m_memoryBudget.GetLastError());
+    }
+    m_memorySteps.clear();
+    m_memoryStepMeasured = true;
+    m_overBudget = false;
+    m_underBudget = false;
+
+    // Quality steps start from the configured settings
+    m_qualityController.Reset(m_config.qualityController);
+    m_qualitySteps.clear();
+    m_qualitySampledFrames = 0;
+    m_adaptationStats = AdaptationStats();
 
     return true;
 }
 
-void DualGPUPipeline::Stop() {
-    m_running = false;
+// Flow downscale for the current size and block size: the configured factor,
+// or with 0 the largest that keeps at least 1080 lines. 16x16 blocks run at
+// full size.
+static uint32_t ResolveFlowDownscale(const DualGPUConfig& config) {
+    if (config.opticalFlowBlockSize != 8) {
+        return 1;
+    }
+    if (config.opticalFlowDownscale == 0) {
+        uint32_t downscale = 1;
+        while (downscale < 4 && config.height / (downscale * 2) >= 1080) {
+            downscale *= 2;
+        }
+        return downscale;
+    }
+    return config.opticalFlowDownscale >= 4 ? 4 : (config.opticalFlowDownscale >= 2 ? 2 : 1);
 }
 
-bool DualGPUPipeline::ProcessFrame() {
-    if (!m_initialized || !m_running) {
-        return false;
+bool DualGPUPipeline::InitializeFrameGeneration() {
+    PipelineCache* pipelineCache = GetPipelineCache();
+
+    // Initialize optical flow: FidelityFX when selected and built in,
+    // otherwise (or if it fails) SimpleOpticalFlow. FidelityFX frame
+    // generation takes per-pixel float vectors: Simple's dense field.
+    m_motionEstimator = m_config.motionEstimator;
+    if (m_activeBackend == FrameGenBackend::FidelityFX) {
+        m_motionEstimator = MotionEstimatorBackend::Simple;
+    } else if (m_motionEstimator == MotionEstimatorBackend::Auto) {
+        m_motionEstimator = OSFG::OpticalFlow::IsAvailable() ? MotionEstimatorBackend::FidelityFX
+                                                             : MotionEstimatorBackend::Simple;
     }
 
-    m_frameStartTime = std::chrono::high_resolution_clock::now();
+    m_opticalFlow.reset();
+    m_flowDownscale = 1;
+    if (m_motionEstimator == MotionEstimatorBackend::FidelityFX) {
+        auto ffxFlow = std::make_unique<OSFG::OpticalFlow>();
+
+        OSFG::OpticalFlowConfig ffxConfig;
+        ffxConfig.width = m_config.width;
+        ffxConfig.height = m_config.height;
+        ffxConfig.vectorReadState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;  // Compute lists only
+        ffxConfig.enableHDR = m_hdr;
+
+        if (ffxFlow->Initialize(m_computeDevice.Get(), m_computeQueue.Get(), ffxConfig)) {
+            m_opticalFlow = std::move(ffxFlow);
+        } else {
+            ReportError("FidelityFX optical flow unavailable, using SimpleOpticalFlow: " +
+                        ffxFlow->GetLastError());
+            m_motionEstimator = MotionEstimatorBackend::Simple;
+        }
+    }
 
-    // Stage 1: Capture frame from primary GPU
-    if (!CaptureFrame()) {
-        return false;
+    if (!m_opticalFlow) {
+        if (!InitializeSimpleOpticalFlow(pipelineCache)) {
+            return false;
+        }
     }
+    m_opticalFlow->SetTimestampFrequency(m_computeQueue.Get());
 
-    // Stage 2: Transfer to secondary GPU
-    if (!TransferFrame()) {
-        return false;
+    m_stats.motionEstimator = m_motionEstimator;
+    m_stats.opticalFlowDownscale = m_flowDownscale;
+    m_stats.interpolationDownscale = m_interpolationDownscale;
+
+    // Initialize interpolation
+    m_interpolation = std::make_unique<OSFG::FrameInterpolation>();
+
+    OSFG::FrameInterpolationConfig interpConfig;
+    interpConfig.width = (m_config.width + m_interpolationDownscale - 1) / m_interpolationDownscale;
+    interpConfig.height = (m_config.height + m_interpolationDownscale - 1) / m_interpolationDownscale;
+    interpConfig.outputState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    interpConfig.motionVectorScale = m_opticalFlow->GetMotionVectorScale();
+    interpConfig.motionOutputScale = 1.0f / static_cast<float>(m_interpolationDownscale);
+    interpConfig.staticTileFrames = m_config.staticTileFrames;
+    if (m_hdr) {
+        interpConfig.format = m_backBufferFormat;   // Generated frames are copied into HDR10 back buffers
+    }
+    if (m_directOutput) {
+        interpConfig.renderTargetFormat = m_backBufferFormat;
     }
+    interpConfig.createOutput = false;   // Always given the generated frames or a back buffer
+    interpConfig.pipelineCache = pipelineCache;
+    interpConfig.resourceArena = m_computeArena;
 
-    // Stage 3: Compute optical flow
-    if (!ComputeOpticalFlow()) {
+    if (!m_interpolation->Initialize(m_computeDevice.Get(), interpConfig)) {
+        SetError("Failed to initialize interpolation: " + m_interpolation->GetLastError());
         return false;
     }
 
-    // Stage 4: Generate interpolated frames
-    if (m_frameGenEnabled) {
-        if (!GenerateFrames()) {
-            return false;
-        }
+    // Write new PSOs now rather than at shutdown, which a crash would skip
+    if (pipelineCache) {
+        pipelineCache->Save();
     }
 
-    // Stage 5: Present frames with proper pacing
-    if (!PresentFrames()) {
+    // Create frame buffers for generated frames (none when the present
+    // pass draws them into the back buffer)
+    if (!m_directOutput && !EnsureGeneratedFrames(static_cast<uint32_t>(m_config.multiplier) - 1)) {
         return false;
     }
 
-    // Update statistics
-    UpdateStats();
-
-    // Advance transfer buffer
-    m_transfer->AdvanceBuffer();
-
     return true;
 }
 
-void DualGPUPipeline::Run() {
-    if (!Start()) {
-        return;
+bool DualGPUPipeline::ResizeFrameGeneration() {
+    // The flow downscale is fixed at creation and follows the height: a
+    // size that calls for another one takes the full re-initialization, as
+    // do backends that cannot re-lay out in place (FidelityFX optical flow)
+    if (m_motionEstimator == MotionEstimatorBackend::Simple &&
+        ResolveFlowDownscale(m_config) != m_flowDownscale) {
+        return false;
     }
 
-    while (m_running && IsWindowOpen()) {
-        // Process window messages
-        if (!m_presenter->ProcessMessages()) {
-            break;
-        }
-
-        // Process one frame
-        ProcessFrame();
+    const uint32_t interpWidth = (m_config.width + m_interpolationDownscale - 1) / m_interpolationDownscale;
+    const uint32_t interpHeight = (m_config.height + m_interpolationDownscale - 1) / m_interpolationDownscale;
+    if (!m_opticalFlow || !m_interpolation ||
+        !m_opticalFlow->Resize(m_config.width, m_config.height) ||
+        !m_interpolation->Resize(interpWidth, interpHeight)) {
+        return false;
     }
 
-    Stop();
+    return m_directOutput || EnsureGeneratedFrames(static_cast<uint32_t>(m_config.multiplier) - 1);
 }
 
-bool DualGPUPipeline::CaptureFrame() {
-    auto startTime = std::chrono::high_resolution_clock::now();
+void DualGPUPipeline::ReleaseArenaResources() {
+    // Generated frames are placed as this, each present motion copy on its own
+    if (!m_computeArena) {
+        return;
+    }
+    m_computeArena->Release(this);
+    for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+        m_computeArena->Release(&m_presentMotion[set]);
+    }
+}
 
-    CapturedFrame frame;
-    if (!m_capture->CaptureFrame(frame)) {
-        // No new frame available - not an error
+bool DualGPUPipeline::InitializeSimpleOpticalFlow(PipelineCache* pipelineCache) {
+    std::unique_ptr<OSFG::SimpleOpticalFlow> simpleFlow;
+    std::string error;
+    if (!CreateSimpleOpticalFlow(m_config, pipelineCache, simpleFlow, error)) {
+        SetError(error);
         return false;
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double captureTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    m_flowDownscale = simpleFlow->GetDownscale();
+    m_opticalFlow = std::move(simpleFlow);
+    return true;
+}
 
-    {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        m_stats.captureTimeMs = captureTimeMs;
-        m_stats.baseFamesCaptured++;
-    }
+bool DualGPUPipeline::CreateSimpleOpticalFlow(const DualGPUConfig& config, PipelineCache* pipelineCache,
+                                              std::unique_ptr<OSFG::SimpleOpticalFlow>& flow,
+                                              std::string& error) const {
+    auto simpleFlow = std::make_unique<OSFG::SimpleOpticalFlow>();
 
-    // Transfer the captured frame immediately
-    // The D3D11 texture needs to be copied to D3D12 via staging
-    if (!m_transfer->TransferFrame(nullptr)) {
-        // Note: TransferFrame with nullptr uses internal staging
-        // We need to modify this to accept the D3D11 texture
-        // For now, this is a placeholder
+    OSFG::SimpleOpticalFlowConfig ofConfig;
+    ofConfig.width = config.width;
+    ofConfig.height = config.height;
+    ofConfig.blockSize = config.opticalFlowBlockSize;
+    ofConfig.searchRadius = config.opticalFlowSearchRadius;
+    ofConfig.downscale = ResolveFlowDownscale(config);
+    ofConfig.pyramidLevels = config.opticalFlowPyramidLevels;
+    ofConfig.temporalPredictors = config.opticalFlowTemporalPredictors;
+    ofConfig.motionField = config.opticalFlowMotionField || m_activeBackend == FrameGenBackend::FidelityFX;
+    ofConfig.sceneChangeThreshold = config.sceneChangeThreshold;
+    ofConfig.hdr10 = m_hdr;
+    ofConfig.vectorReadState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;  // Compute lists only
+    ofConfig.pipelineCache = pipelineCache;
+    ofConfig.resourceArena = m_computeArena;
+
+    if (!simpleFlow->Initialize(m_computeDevice.Get(), ofConfig)) {
+        error = "Failed to initialize optical flow: " + simpleFlow->GetLastError();
+        return false;
     }
 
-    m_capture->ReleaseFrame();
-
+    flow = std::move(simpleFlow);
     return true;
 }
 
-bool DualGPUPipeline::TransferFrame() {
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    // Wait for transfer to complete
-    m_transfer->WaitForTransfer();
+bool DualGPUPipeline::EnsureGeneratedFrames(uint32_t count) {
+    // One interpolation target per generated phase. All phases of a base
+    // frame are recorded into one command list and each writes its own
+    // texture, so X3/X4 present distinct frames without copies.
+    const uint32_t needed = (std::min)(count, static_cast<uint32_t>(MAX_GENERATED_FRAMES));
+    std::lock_guard<std::mutex> lock(m_generatedFramesMutex);
+
+    D3D12_RESOURCE_DESC texDesc = m_interpolation->GetOutputDesc();
+
+    // NON_PIXEL_SHADER_RESOURCE is valid on both the compute queue that
+    // writes them and the present queue that copies them
+    for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+        for (uint32_t i = 0; i < needed; i++) {
+            if (m_generatedFrames[set][i]) {
+                continue;
+            }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double transferTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+            HRESULT hr = CreateArenaResource(m_computeArena, this, m_computeDevice.Get(), D3D12_HEAP_TYPE_DEFAULT,
+                                             texDesc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                                             nullptr, m_generatedFrames[set][i]);
 
-    {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        m_stats.transferTimeMs = transferTimeMs;
-        m_stats.transferThroughputMBps = m_transfer->GetStats().throughputMBps;
-        m_stats.usingPeerToPeer = (m_transfer->GetTransferMethod() == TransferMethod::CrossAdapterHeap);
+            if (FAILED(hr)) {
+                SetError("Failed to create generated frame buffer " + std::to_string(i));
+                return false;
+            }
+            if (m_upscaler) {
+                m_upscaler->SetSource(set * MAX_GENERATED_FRAMES + i, m_generatedFrames[set][i].Get());
+            }
+        }
     }
 
     return true;
 }
 
-bool DualGPUPipeline::ComputeOpticalFlow() {
-    auto startTime = std::chrono::high_resolution_clock::now();
+// Sharpen strength of the present-pass upscale (interpolationDownscale > 1)
+static const float UPSCALE_SHARPNESS = 0.5f;
 
-    // Reset command list
-    HRESULT hr = m_computeAllocator->Reset();
-    if (FAILED(hr)) return false;
+bool DualGPUPipeline::InitializePresentation() {
+    // FidelityFX: its swap chain presents to our window. If it cannot be
+    // created (reported through SetError) the native path takes over; the
+    // flow field works for both.
+    if (m_activeBackend == FrameGenBackend::FidelityFX && !InitializeFidelityFXPresentation()) {
+        m_activeBackend = FrameGenBackend::Native;
+    }
 
-    hr = m_computeCommandList->Reset(m_computeAllocator.Get(), nullptr);
-    if (FAILED(hr)) return false;
+    if (!m_presenter) {
+        m_presenter = std::make_unique<OSFG::SimplePresenter>();
+    }
 
-    // Get current and previous frames from transfer
-    ID3D12Resource* currentFrame = m_transfer->GetDestinationTexture();
-    ID3D12Resource* previousFrame = m_transfer->GetPreviousTexture();
+    OSFG::PresenterConfig presConfig;
+    presConfig.width = m_config.width;
+    presConfig.height = m_config.height;
+    presConfig.vsync = m_config.vsync;
+    presConfig.variableRefresh = m_config.variableRefresh;
+    presConfig.windowed = m_config.borderlessWindow;
+    presConfig.windowTitle = m_config.windowTitle;
+    presConfig.monitor = m_capture->GetMonitor();
+    presConfig.bufferCount = m_config.swapChainBufferCount;
+    presConfig.maxFrameLatency = m_config.maxFrameLatency;
+    presConfig.hdr10 = m_hdr;
 
-    if (!currentFrame || !previousFrame) {
-        // Need at least 2 frames for optical flow
-        m_computeCommandList->Close();
-        return true;  // Not an error, just need more frames
+    if (!m_presenter->IsInitialized() &&
+        !m_presenter->Initialize(m_computeDevice.Get(), m_presentQueue.Get(), presConfig)) {
+        SetError("Failed to initialize presenter: " + m_presenter->GetLastError());
+        return false;
     }
 
-    // Compute optical flow
-    if (!m_opticalFlow->Dispatch(currentFrame, previousFrame, m_computeCommandList.Get())) {
-        SetError("Optical flow computation failed");
+    // Phases are placed from the measured capture cadence; with vsync they
+    // snap to the refresh period of the window's output. Under VRR the
+    // display follows our present times, so they are used unrounded.
+    FramePacerConfig pacerConfig;
+    pacerConfig.refreshRateHz = m_presenter->GetRefreshRateHz();
+    pacerConfig.snapToRefresh = m_config.vsync && !m_config.variableRefresh;
+    if (!m_pacer.Initialize(pacerConfig)) {
+        SetError("Failed to initialize frame pacer: " + m_pacer.GetLastError());
         return false;
     }
 
-    // Close and execute command list
-    hr = m_computeCommandList->Close();
-    if (FAILED(hr)) return false;
-
-    ID3D12CommandList* cmdLists[] = { m_computeCommandList.Get() };
-    m_computeQueue->ExecuteCommandLists(1, cmdLists);
+    // Present copies get their own allocator ring and fence so they can be
+    // recorded on the present thread while compute records the next frame.
+    // One allocator per queued present lets copies go out without CPU waits.
+    if (!m_presentRing.Initialize(m_computeDevice.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT,
+                                  PRESENT_ALLOCATOR_COUNT)) {
+        SetError("Failed to create present command ring: " + m_presentRing.GetLastError());
+        return false;
+    }
 
-    // Signal fence
-    m_computeFenceValue++;
-    m_computeQueue->Signal(m_computeFence.Get(), m_computeFenceValue);
+    if (m_config.gpuProfiling) {
+        m_presentProfiler.Initialize(m_computeDevice.Get(), m_presentQueue.Get(), PRESENT_ALLOCATOR_COUNT);
+    }
 
-    // Wait for completion
-    if (m_computeFence->GetCompletedValue() < m_computeFenceValue) {
-        m_computeFence->SetEventOnCompletion(m_computeFenceValue, m_computeFenceEvent);
-        WaitForSingleObject(m_computeFenceEvent, INFINITE);
+    HRESULT hr = m_computeDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_presentFence));
+    if (FAILED(hr)) {
+        SetError("Failed to create present fence");
+        return false;
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double ofTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    m_presentFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_presentFenceEvent) {
+        SetError("Failed to create present fence event");
+        return false;
+    }
 
-    {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        m_stats.opticalFlowTimeMs = ofTimeMs;
+    // Reports through SetError but is not fatal: frames are presented without it
+    if (m_config.enableOverlay && !m_ffxFrameGen) {
+        m_overlay = std::make_unique<OSFG::OverlayCompositor>();
+        PipelineCache* pipelineCache = GetPipelineCache();
+        if (!m_overlay->Initialize(m_computeDevice.Get(), m_backBufferFormat,
+                                   m_presentFence.Get(), pipelineCache)) {
+            SetError("Failed to initialize overlay compositor: " + m_overlay->GetLastError());
+            m_overlay.reset();
+        }
     }
 
     return true;
 }
 
-bool DualGPUPipeline::GenerateFrames() {
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    ID3D12Resource* currentFrame = m_transfer->GetDestinationTexture();
-    ID3D12Resource* previousFrame = m_transfer->GetPreviousTexture();
-    ID3D12Resource* motionVectors = m_opticalFlow->GetMotionVectorTexture();
-
-    if (!currentFrame || !previousFrame || !motionVectors) {
-        return true;  // Not enough data yet
-    }
-
-    // Generate intermediate frames based on multiplier
-    int numGenFrames = static_cast<int>(m_config.multiplier) - 1;
-
-    for (int i = 0; i < numGenFrames; i++) {
-        // Calculate interpolation factor
-        float t = static_cast<float>(i + 1) / static_cast<float>(m_config.multiplier);
-
-        // Reset command list
-        m_computeAllocator->Reset();
-        m_computeCommandList->Reset(m_computeAllocator.Get(), nullptr);
-
-        // Set interpolation factor and generate frame
-        m_interpolation->SetInterpolationFactor(t);
-        if (!m_interpolation->Dispatch(previousFrame, currentFrame, motionVectors,
-                                        m_computeCommandList.Get())) {
-            SetError("Frame interpolation failed");
+bool DualGPUPipeline::InitializeUpscaler() {
+    // Reduced-size generated frames cannot be copied into the back buffer,
+    // so without the upscaler there is nothing to present them with
+    if (m_interpolationDownscale > 1 && !m_ffxFrameGen) {
+        m_upscaler = std::make_unique<OSFG::FrameUpscaler>();
+        PipelineCache* pipelineCache = GetPipelineCache();
+        if (!m_upscaler->Initialize(m_computeDevice.Get(), m_backBufferFormat,
+                                    UPSCALE_SHARPNESS, pipelineCache)) {
+            SetError("Failed to initialize frame upscaler: " + m_upscaler->GetLastError());
+            m_upscaler.reset();
             return false;
         }
 
-        // Copy to our frame buffer
-        // (In a real implementation, we'd manage this more efficiently)
+        // Frames created before the upscaler existed; source index is
+        // set * MAX_GENERATED_FRAMES + phase, one per generated frame
+        static_assert(OSFG::FrameUpscaler::MAX_SOURCES == GENERATED_FRAME_SETS * MAX_GENERATED_FRAMES,
+                      "FrameUpscaler needs one source per generated frame");
+        for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+            for (uint32_t i = 0; i < MAX_GENERATED_FRAMES; i++) {
+                m_upscaler->SetSource(set * MAX_GENERATED_FRAMES + i, m_generatedFrames[set][i].Get());
+            }
+        }
+    }
 
-        m_computeCommandList->Close();
+    return true;
+}
 
-        ID3D12CommandList* cmdLists[] = { m_computeCommandList.Get() };
-        m_computeQueue->ExecuteCommandLists(1, cmdLists);
+bool DualGPUPipeline::InitializeFidelityFXPresentation() {
+    // Window only: a second swap chain cannot target the same window
+    m_presenter = std::make_unique<OSFG::SimplePresenter>();
 
-        m_computeFenceValue++;
-        m_computeQueue->Signal(m_computeFence.Get(), m_computeFenceValue);
-    }
+    OSFG::PresenterConfig presConfig;
+    presConfig.width = m_config.width;
+    presConfig.height = m_config.height;
+    presConfig.windowed = m_config.borderlessWindow;
+    presConfig.windowTitle = m_config.windowTitle;
+    presConfig.monitor = m_capture->GetMonitor();
+    presConfig.createSwapChain = false;
 
-    // Wait for all generation to complete
-    if (m_computeFence->GetCompletedValue() < m_computeFenceValue) {
-        m_computeFence->SetEventOnCompletion(m_computeFenceValue, m_computeFenceEvent);
-        WaitForSingleObject(m_computeFenceEvent, INFINITE);
+    if (!m_presenter->Initialize(m_computeDevice.Get(), m_presentQueue.Get(), presConfig)) {
+        SetError("Failed to initialize presenter window: " + m_presenter->GetLastError());
+        m_presenter.reset();
+        return false;
     }
 
-    auto endTime = std::chrono::high_resolution_clock::now();
-    double interpTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
-
-    {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        m_stats.interpolationTimeMs = interpTimeMs;
-        m_stats.framesGenerated += numGenFrames;
+    if (!CreateFidelityFXFrameGen()) {
+        m_presenter.reset();
+        return false;
     }
 
     return true;
 }
 
-bool DualGPUPipeline::PresentFrames() {
-    auto startTime = std::chrono::high_resolution_clock::now();
+bool DualGPUPipeline::CreateFidelityFXFrameGen() {
+    ComPtr<IDXGIFactory4> factory;
+    if (FAILED(CreateDXGIFactory2(0, IID_PPV_ARGS(&factory)))) {
+        SetError("Failed to create DXGI factory for FidelityFX frame generation");
+        return false;
+    }
 
-    ID3D12Resource* currentFrame = m_transfer->GetDestinationTexture();
-    if (!currentFrame) {
-        return true;
+    // Prepare inputs are at the flow field's resolution
+    ID3D12Resource* motionField = m_opticalFlow->GetMotionField();
+    m_ffxFrameGen = std::make_unique<OSFG::FFXFrameGeneration>();
+
+    OSFG::FFXFrameGenConfig ffxConfig;
+    ffxConfig.displayWidth = m_config.width;
+    ffxConfig.displayHeight = m_config.height;
+    ffxConfig.renderWidth = motionField ? static_cast<uint32_t>(motionField->GetDesc().Width) : 0;
+    ffxConfig.renderHeight = motionField ? motionField->GetDesc().Height : 0;
+    ffxConfig.backBufferCount = (std::max)(m_config.swapChainBufferCount, 2u);
+    ffxConfig.backBufferFormat = m_backBufferFormat;
+    ffxConfig.enableHDR = m_hdr;
+    ffxConfig.vsync = m_vsync;
+
+    if (!m_ffxFrameGen->Initialize(m_computeDevice.Get(), m_presentQueue.Get(), factory.Get(),
+                                   m_presenter->GetHWND(), ffxConfig)) {
+        SetError("Failed to initialize FidelityFX frame generation: " + m_ffxFrameGen->GetLastError());
+        m_ffxFrameGen.reset();
+        return false;
     }
 
-    int totalFrames = m_frameGenEnabled ? static_cast<int>(m_config.multiplier) : 1;
-    uint32_t syncInterval = m_config.vsync ? 1 : 0;
+    return true;
+}
 
-    // Helper lambda to present and flip a single frame
-    auto presentSingleFrame = [&](ID3D12Resource* frame) -> bool {
-        // Reset command list
-        m_computeAllocator->Reset();
-        m_computeCommandList->Reset(m_computeAllocator.Get(), nullptr);
+bool DualGPUPipeline::ApplyCaptureResize() {
+    return ApplyLayoutChange(true, false);
+}
 
-        // Record copy to back buffer
-        m_presenter->Present(frame, m_computeCommandList.Get());
+bool DualGPUPipeline::PauseStages() {
+    // In pipelined mode the stage threads are stopped before their resources
+    // go away (after a capture resize, the capture thread already stopped
+    // producing)
+    const bool restartStages = m_config.pipelinedMode && m_running;
+    if (restartStages) {
+        m_running = false;
+        StopStageThreads();
+    }
 
-        // Close and execute
-        m_computeCommandList->Close();
-        ID3D12CommandList* cmdLists[] = { m_computeCommandList.Get() };
-        m_computeQueue->ExecuteCommandLists(1, cmdLists);
+    // Nothing queued on the GPU may still read the old ring, flow outputs
+    // or back buffers
+    WaitForFence(m_computeFence.Get(), m_computeFenceEvent, m_computeFenceValue);
+    WaitForFence(m_presentFence.Get(), m_presentFenceEvent, m_presentFenceValue);
+    return restartStages;
+}
 
-        // Wait for execution to complete
-        m_computeFenceValue++;
-        m_computeQueue->Signal(m_computeFence.Get(), m_computeFenceValue);
-        if (m_computeFence->GetCompletedValue() < m_computeFenceValue) {
-            m_computeFence->SetEventOnCompletion(m_computeFenceValue, m_computeFenceEvent);
-            WaitForSingleObject(m_computeFenceEvent, INFINITE);
+bool DualGPUPipeline::ResumeStages(bool restartStages) {
+    if (restartStages) {
+        m_running = true;
+        if (!StartStageThreads()) {
+            m_running = false;
+            StopStageThreads();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DualGPUPipeline::ApplyLayoutChange(bool captureResize, bool reinitializeFlow) {
+    // A flow still building has the old layout: the new one brings its own
+    if (CancelFlowRebuild()) {
+        reinitializeFlow = true;
+    }
+
+    const bool restartStages = PauseStages();
+
+    if (captureResize) {
+        m_config.width = m_resizeWidth;
+        m_config.height = m_resizeHeight;
+        m_resizePending = false;
+    }
+
+    // Devices, queues, fences, PSOs (through the pipeline cache) and the
+    // window stay; only size-dependent resources are re-created
+    const uint32_t bufferCount = m_config.transferBufferCount;
+    const bool ringChanged = captureResize || GetFrameBufferCount() != bufferCount;
+    const bool ringResized =
+        m_singleGPU ? m_localFrames->Resize(m_config.width, m_config.height, bufferCount)
+                    : m_transfer->Resize(m_config.width, m_config.height, bufferCount);
+    if (!ringResized) {
+        SetError("Failed to resize frame ring: " +
+                 (m_singleGPU ? m_localFrames->GetLastError() : m_transfer->GetLastError()));
+        return false;
+    }
+    if (ringChanged && !ShareFrameRing()) {
+        return false;
+    }
+
+    for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+        for (uint32_t i = 0; i < MAX_GENERATED_FRAMES; i++) {
+            m_generatedFrames[set][i].Reset();
+            if (m_upscaler) {
+                m_upscaler->SetSource(set * MAX_GENERATED_FRAMES + i, nullptr);
+            }
+        }
+        m_presentMotion[set].Reset();
+        m_presentPredicates[set].Reset();
+        m_generatedRetireValues[set] = 0;
+    }
+    ReleaseArenaResources();
+    m_generatedSet = 0;
+
+    if (reinitializeFlow || !ResizeFrameGeneration()) {
+        if (!InitializeFrameGeneration()) {
+            return false;
+        }
+    }
+
+    // Heaps the new layout left empty (it re-placed everything it could)
+    if (m_computeArena) {
+        m_computeArena->Trim();
+    }
+
+    if (captureResize) {
+        if (!m_presenter->Resize(m_config.width, m_config.height)) {
+            SetError("Failed to resize presenter: " + m_presenter->GetLastError());
+            return false;
+        }
+
+        // The FidelityFX context is sized at creation: re-create it and its
+        // swap chain for the new display size
+        if (m_ffxFrameGen) {
+            m_ffxFrameGen.reset();
+            if (!CreateFidelityFXFrameGen()) {
+                return false;
+            }
+        }
+
+        // Every stage is stopped, so this thread owns the capture stage's stats
+        m_captureStats.captureResizes++;
+        PublishCaptureStats();
+    }
+
+    return ResumeStages(restartStages);
+}
+
+void DualGPUPipeline::RequestFlowRebuild() {
+    // FidelityFX optical flow has none of the settings a rebuild would change
+    if (m_motionEstimator != MotionEstimatorBackend::Simple) {
+        return;
+    }
+
+    // One build at a time: a running one is redone with what it missed
+    if (m_flowBuildThread.joinable()) {
+        m_flowBuildStale = true;
+        return;
+    }
+
+    m_flowBuildStale = false;
+    m_flowBuildDone = false;
+    m_pendingFlow.reset();
+    m_pendingFlowError.clear();
+
+    // The device, arena and pipeline cache are free-threaded; the worker
+    // touches nothing else of the pipeline
+    const DualGPUConfig config = m_config;
+    PipelineCache* pipelineCache = GetPipelineCache();
+    m_flowBuildThread = std::thread([this, config, pipelineCache] {
+        CreateSimpleOpticalFlow(config, pipelineCache, m_pendingFlow, m_pendingFlowError);
+        m_flowBuildDone = true;
+    });
+}
+
+bool DualGPUPipeline::ApplyPendingFlow() {
+    m_flowBuildThread.join();
+    m_flowBuildDone = false;
+    std::unique_ptr<OSFG::SimpleOpticalFlow> flow = std::move(m_pendingFlow);
+
+    if (m_flowBuildStale) {
+        flow.reset();
+        RequestFlowRebuild();
+        return true;
+    }
+
+    // Not fatal: frame generation carries on with the flow it has
+    if (!flow) {
+        SetError("Flow rebuild failed, keeping the current flow: " + m_pendingFlowError);
+        return true;
+    }
+
+    // The FidelityFX context is sized for the field it was created with
+    ID3D12Resource* oldField = m_opticalFlow->GetMotionField();
+    ID3D12Resource* newField = flow->GetMotionField();
+    const bool fieldResized = m_ffxFrameGen && oldField && newField &&
+        (oldField->GetDesc().Width != newField->GetDesc().Width ||
+         oldField->GetDesc().Height != newField->GetDesc().Height);
+
+    // Only the swap stops the stages; the old flow's ranges go back to the
+    // arena with it
+    const bool restartStages = PauseStages();
+
+    m_flowDownscale = flow->GetDownscale();
+    m_opticalFlow = std::move(flow);
+    m_opticalFlow->SetTimestampFrequency(m_computeQueue.Get());
+    if (m_interpolation) {
+        m_interpolation->ResetMotionSource(m_opticalFlow->GetMotionVectorScale());
+    }
+
+    // Present-pass snapshots of the old vectors (the new ones can differ in size)
+    for (uint32_t set = 0; set < GENERATED_FRAME_SETS; set++) {
+        m_presentMotion[set].Reset();
+        if (m_computeArena) {
+            m_computeArena->Release(&m_presentMotion[set]);
+        }
+    }
+    if (m_computeArena) {
+        m_computeArena->Trim();
+    }
+
+    // Every stage is paused, so this thread owns the present stage's stats
+    m_stats.opticalFlowDownscale = m_flowDownscale;
+
+    if (fieldResized) {
+        m_ffxFrameGen.reset();
+        if (!CreateFidelityFXFrameGen()) {
+            return false;
+        }
+    }
+
+    m_adaptationStats.flowRebuilds++;
+    PublishAdaptationStats();
+
+    return ResumeStages(restartStages);
+}
+
+bool DualGPUPipeline::CancelFlowRebuild() {
+    if (!m_flowBuildThread.joinable()) {
+        return false;
+    }
+    m_flowBuildThread.join();
+    m_flowBuildDone = false;
+    m_flowBuildStale = false;
+    m_pendingFlow.reset();
+    return true;
+}
+
+// Video memory budget: how often it is queried without a change notification,
+// how long usage must stay over (or clearly under) the limit before a step is
+// taken (or undone), and the minimum time between two changes
+static const std::chrono::milliseconds MEMORY_QUERY_INTERVAL(500);
+static const std::chrono::milliseconds MEMORY_OVER_BUDGET_HOLD(1000);
+static const std::chrono::milliseconds MEMORY_UNDER_BUDGET_HOLD(10000);
+static const std::chrono::milliseconds MEMORY_STEP_INTERVAL(2000);
+
+// Smallest flow search radius a quality step goes down to
+static const uint32_t MIN_QUALITY_SEARCH_RADIUS = 4;
+
+bool DualGPUPipeline::FrameGenSettings::operator==(const FrameGenSettings& other) const {
+    return transferBufferCount == other.transferBufferCount &&
+           opticalFlowBlockSize == other.opticalFlowBlockSize &&
+           opticalFlowSearchRadius == other.opticalFlowSearchRadius &&
+           opticalFlowMotionField == other.opticalFlowMotionField &&
+           multiplier == other.multiplier;
+}
+
+DualGPUPipeline::FrameGenSettings DualGPUPipeline::GetReducedSettings(const Reduction* extra) const {
+    FrameGenSettings settings = m_configuredSettings;
+    const bool simpleFlow = m_motionEstimator == MotionEstimatorBackend::Simple;
+    const bool ffxFrameGen = m_activeBackend == FrameGenBackend::FidelityFX;
+
+    auto apply = [&](Reduction reduction) {
+        switch (reduction) {
+            case Reduction::TransferBuffers:
+                settings.transferBufferCount = (std::min)(settings.transferBufferCount,
+                                                          m_config.pipelinedMode ? 3u : 2u);
+                break;
+            case Reduction::SearchRadius:
+                if (simpleFlow) {
+                    settings.opticalFlowSearchRadius = (std::max)(settings.opticalFlowSearchRadius / 2,
+                                                                  MIN_QUALITY_SEARCH_RADIUS);
+                }
+                break;
+            case Reduction::FlowBlockSize:
+                // FidelityFX frame generation needs the dense field
+                if (simpleFlow) {
+                    settings.opticalFlowBlockSize = 16;
+                    settings.opticalFlowMotionField = settings.opticalFlowMotionField && ffxFrameGen;
+                }
+                break;
+            case Reduction::Multiplier:
+                // FidelityFX frame generation is always X2
+                if (!ffxFrameGen && settings.multiplier != FrameMultiplier::X2) {
+                    settings.multiplier = static_cast<FrameMultiplier>(static_cast<int>(settings.multiplier) - 1);
+                }
+                break;
+        }
+    };
+
+    for (const MemoryStepRecord& record : m_memorySteps) {
+        apply(record.step);
+    }
+    for (Reduction step : m_qualitySteps) {
+        apply(step);
+    }
+    if (extra) {
+        apply(*extra);
+    }
+    return settings;
+}
+
+bool DualGPUPipeline::ApplyReducedSettings(bool relayout, bool rebuildFlow) {
+    const FrameGenSettings settings = GetReducedSettings();
+    const bool flowChanged = rebuildFlow ||
+                             settings.opticalFlowBlockSize != m_config.opticalFlowBlockSize ||
+                             settings.opticalFlowSearchRadius != m_config.opticalFlowSearchRadius ||
+                             settings.opticalFlowMotionField != m_config.opticalFlowMotionField;
+    const bool ringChanged = settings.transferBufferCount != m_config.transferBufferCount;
+    const bool multiplierChanged = settings.multiplier != m_config.multiplier;
+    if (!flowChanged && !ringChanged && !multiplierChanged && !relayout) {
+        return true;
+    }
+
+    m_config.transferBufferCount = settings.transferBufferCount;
+    m_config.opticalFlowBlockSize = settings.opticalFlowBlockSize;
+    m_config.opticalFlowSearchRadius = settings.opticalFlowSearchRadius;
+    m_config.opticalFlowMotionField = settings.opticalFlowMotionField;
+
+    // The ring is shared by every stage: it only changes with all of them stopped
+    if (relayout || ringChanged) {
+        m_config.multiplier = settings.multiplier;
+        m_multiplier = settings.multiplier;
+        return ApplyLayoutChange(false, flowChanged);
+    }
+
+    // Otherwise nothing stops: the next frame takes the multiplier, and the
+    // new flow is swapped in once it is built
+    if (multiplierChanged) {
+        ApplyMultiplier(settings.multiplier);
+    }
+    if (flowChanged) {
+        RequestFlowRebuild();
+    }
+    return true;
+}
+
+void DualGPUPipeline::ApplyMultiplier(FrameMultiplier multiplier) {
+    // The compute stage would create missing generated frames itself, in the
+    // middle of a frame. Not fatal here (reported): it tries again then.
+    if (!m_directOutput && !m_ffxFrameGen) {
+        EnsureGeneratedFrames(static_cast<uint32_t>(multiplier) - 1);
+    }
+
+    // The stages only read the atomic, once per frame
+    m_config.multiplier = multiplier;
+    m_multiplier = multiplier;
+}
+
+bool DualGPUPipeline::UpdateMemoryBudget() {
+    const auto now = std::chrono::steady_clock::now();
+    if (!m_memoryBudget.BudgetChanged() && now - m_memoryQueryTime < MEMORY_QUERY_INTERVAL) {
+        return true;
+    }
+    m_memoryQueryTime = now;
+
+    VideoMemoryInfo info;
+    if (!m_memoryBudget.Query(info)) {
+        return true;
+    }
+
+    // What the last step gave back, once its resources are gone
+    if (!m_memoryStepMeasured && !m_memorySteps.empty()) {
+        MemoryStepRecord& last = m_memorySteps.back();
+        last.freedBytes = last.usageBefore > info.usageBytes ? last.usageBefore - info.usageBytes : 0;
+        m_memoryStepMeasured = true;
+    }
+
+    m_adaptationStats.vramBudgetBytes = info.budgetBytes;
+    m_adaptationStats.vramUsageBytes = info.usageBytes;
+
+    bool ok = true;
+    if (m_config.adaptToMemoryBudget && info.budgetBytes > 0) {
+        const uint64_t limit = static_cast<uint64_t>(
+            static_cast<double>(info.budgetBytes) * m_config.memoryBudgetFraction);
+
+        // Undo only when what the last step freed fits again with a margin,
+        // so the pipeline does not oscillate at the limit
+        const uint64_t margin = info.budgetBytes / 20;
+        const uint64_t undoUsage = m_memorySteps.empty() ? UINT64_MAX :
+            info.usageBytes + m_memorySteps.back().freedBytes + margin;
+
+        const bool over = info.usageBytes > limit;
+        const bool under = undoUsage < limit;
+        if (over && !m_overBudget) {
+            m_overBudgetSince = now;
+        }
+        if (under && !m_underBudget) {
+            m_underBudgetSince = now;
+        }
+        m_overBudget = over;
+        m_underBudget = under;
+
+        const bool canChange = m_memoryStepMeasured && now - m_memoryStepTime >= MEMORY_STEP_INTERVAL;
+        if (canChange && over && now - m_overBudgetSince >= MEMORY_OVER_BUDGET_HOLD) {
+            ok = TakeMemoryStep(info.usageBytes);
+        } else if (canChange && under && now - m_underBudgetSince >= MEMORY_UNDER_BUDGET_HOLD) {
+            ok = UndoMemoryStep();
+        }
+    }
+
+    PublishAdaptationStats();
+    return ok;
+}
+
+bool DualGPUPipeline::TakeMemoryStep(uint64_t usageBytes) {
+    // Most bytes for the least quality first. The first step not yet taken
+    // that still changes something (the quality controller may already have
+    // given the same setting up).
+    static const Reduction MEMORY_STEPS[] = {
+        Reduction::TransferBuffers,
+        Reduction::FlowBlockSize,
+        Reduction::Multiplier,
+    };
+    const FrameGenSettings current = GetReducedSettings();
+    const Reduction* next = nullptr;
+    for (const Reduction& step : MEMORY_STEPS) {
+        const bool taken = std::any_of(m_memorySteps.begin(), m_memorySteps.end(),
+            [&](const MemoryStepRecord& record) { return record.step == step; });
+        if (!taken && !(GetReducedSettings(&step) == current)) {
+            next = &step;
+            break;
+        }
+    }
+    if (!next) {
+        return true;   // Nothing left to give up
+    }
+
+    MemoryStepRecord record = {};
+    record.step = *next;
+    record.usageBefore = usageBytes;
+    m_memorySteps.push_back(record);
+    m_memoryStepMeasured = false;
+    m_memoryStepTime = std::chrono::steady_clock::now();
+    m_overBudget = false;
+    m_underBudget = false;
+    m_adaptationStats.vramDegradeLevel = static_cast<uint32_t>(m_memorySteps.size());
+    m_adaptationStats.vramDegradations++;
+
+    // Re-laid out so the memory is freed before anything is re-created
+    return ApplyReducedSettings(true);
+}
+
+bool DualGPUPipeline::UndoMemoryStep() {
+    m_memorySteps.pop_back();
+    m_memoryStepMeasured = true;
+    m_memoryStepTime = std::chrono::steady_clock::now();
+    m_overBudget = false;
+    m_underBudget = false;
+    m_adaptationStats.vramDegradeLevel = static_cast<uint32_t>(m_memorySteps.size());
+
+    return ApplyReducedSettings();
+}
+
+bool DualGPUPipeline::UpdateQuality() {
+    // One sample per base frame whose timestamps came back
+    const ComputeStageStats compute = m_computeStatsSnapshot.Load();
+    if (compute.gpuTimedFrames == m_qualitySampledFrames) {
+        return true;
+    }
+    m_qualitySampledFrames = compute.gpuTimedFrames;
+
+    // Everything the secondary GPU does for a base frame; the present passes
+    // run on it too (in single-GPU mode the game's own load shows up as
+    // longer passes)
+    const PipelineStats present = m_statsSnapshot.Load();
+    const double gpuMs = compute.opticalFlowTimeMs + compute.interpolationTimeMs + present.gpuPresentMs;
+
+    // Most GPU time for the least quality first
+    static const Reduction QUALITY_STEPS[] = {
+        Reduction::SearchRadius,
+        Reduction::FlowBlockSize,
+        Reduction::Multiplier,
+    };
+    const FrameGenSettings current = GetReducedSettings();
+    const Reduction* next = nullptr;
+    for (const Reduction& step : QUALITY_STEPS) {
+        // Only the multiplier can be given up more than once (X4 -> X3 -> X2)
+        const bool taken = step != Reduction::Multiplier &&
+            std::find(m_qualitySteps.begin(), m_qualitySteps.end(), step) != m_qualitySteps.end();
+        if (!taken && !(GetReducedSettings(&step) == current)) {
+            next = &step;
+            break;
+        }
+    }
+
+    // Without adaptiveQuality the load is still reported
+    const bool adapt = m_config.adaptiveQuality;
+    const QualityDecision decision = m_qualityController.Update(gpuMs, m_pacer.GetBaseIntervalMs(),
+                                                                adapt && next, adapt && !m_qualitySteps.empty());
+    m_adaptationStats.gpuLoad = m_qualityController.GetLoad();
+
+    bool ok = true;
+    if (decision != QualityDecision::Hold) {
+        if (decision == QualityDecision::StepDown) {
+            m_qualitySteps.push_back(*next);
+        } else {
+            m_qualitySteps.pop_back();
+        }
+        m_adaptationStats.qualityLevel = static_cast<uint32_t>(m_qualitySteps.size());
+        m_adaptationStats.qualityChanges++;
+        ok = ApplyReducedSettings();
+    }
+
+    PublishAdaptationStats();
+    return ok;
+}
+
+bool DualGPUPipeline::Start() {
+    if (!m_initialized) {
+        SetError("Pipeline not initialized");
+        return false;
+    }
+
+    if (m_running) {
+        return true;  // Already running
+    }
+
+    m_running = true;
+    m_lastPresentTime = std::chrono::high_resolution_clock::now();
+    m_lastFrameCompleteTime = m_lastPresentTime;
+
+    if (m_config.pipelinedMode && !StartStageThreads()) {
+        m_running = false;
+        StopStageThreads();
+        return false;
+    }
+
+    return true;
+}
+
+void DualGPUPipeline::Stop() {
+    m_running = false;
+    StopStageThreads();
+}
+
+bool DualGPUPipeline::ProcessFrame() {
+    if (!m_initialized || !m_running) {
+        return false;
+    }
+
+    // The capture came back at a new size: re-create what depends on it
+    // before any stage touches the old resources
+    if (m_resizePending) {
+        return ApplyCaptureResize();
+    }
+
+    // A flow rebuilt in the background is ready to take over
+    if (m_flowBuildDone && !ApplyPendingFlow()) {
+        return false;
+    }
+
+    // Memory-saving and quality steps are applied here too, between frames
+    if (m_memoryBudget.IsInitialized() && !UpdateMemoryBudget()) {
+        return false;
+    }
+    if (m_computeProfiler.IsInitialized() && !UpdateQuality()) {
+        return false;
+    }
+
+    // Stage threads own the frame loop in pipelined mode
+    if (m_config.pipelinedMode) {
+        return true;
+    }
+
+    // The transfer buffer we are about to overwrite may still be read by
+    // queued present copies of an older frame
+    const uint32_t bufferIndex = GetFrameBufferIndex();
+    const uint32_t bufferCount = GetFrameBufferCount();
+    const uint32_t previousIndex = (bufferIndex + bufferCount - 1) % bufferCount;
+    WaitForFence(m_presentFence.Get(), m_presentFenceEvent, m_bufferRetireValues[bufferIndex]);
+
+    // Stage 1: Capture frame from primary GPU (blocks up to captureTimeoutMs)
+    if (!CaptureFrame()) {
+        PublishCaptureStats();
+        return false;
+    }
+
+    // Pacing and frame timing start when the frame arrived, not when the
+    // wait for it began
+    m_frameStartTime = m_frameArrivalTime;
+
+    // Stage 2: Transfer to secondary GPU
+    const bool transferred = TransferFrame();
+    PublishCaptureStats();
+    if (!transferred) {
+        return false;
+    }
+
+    // Until a frame has gone through the previous slot, flow runs against
+    // the current frame itself
+    ID3D12Resource* currentFrame = GetFrameTexture(bufferIndex);
+    ID3D12Resource* previousFrame = m_bufferRetireValues[previousIndex] > 0 ?
+        GetFrameTexture(previousIndex) : currentFrame;
+
+    // Stages 3 + 4: Optical flow and all interpolated phases in one submission
+    if (!BeginComputeFrame()) {
+        return false;
+    }
+
+    if (!ComputeOpticalFlow(currentFrame, previousFrame)) {
+        return false;
+    }
+
+    uint32_t generatedCount = 0;
+    if (m_frameGenEnabled) {
+        if (!GenerateFrames(currentFrame, previousFrame, generatedCount)) {
+            return false;
+        }
+    }
+
+    uint64_t computeFenceValue = 0;
+    const bool submitted = SubmitComputeFrame(m_frameFenceValue, m_frameArrivalTime, computeFenceValue);
+    PublishComputeStats();
+    if (!submitted) {
+        return false;
+    }
+
+    // Stage 5: Present frames with proper pacing
+    if (!PresentFrames(currentFrame, previousFrame, generatedCount, m_generatedSet,
+                       computeFenceValue, m_frameFenceValue, m_frameCapture.desktopPresentQpc)) {
+        return false;
+    }
+
+    // This frame's buffer (and the previous one it read) retire with its last present copy
+    m_bufferRetireValues[bufferIndex] = m_presentFenceValue;
+    m_bufferRetireValues[previousIndex] = m_presentFenceValue;
+
+    // Update statistics
+    UpdateStats(m_frameStartTime);
+    RecordFrame(m_serialFrameNumber++, m_frameCapture, generatedCount);
+
+    // Advance transfer buffer
+    AdvanceFrameBuffer();
+
+    return true;
+}
+
+void DualGPUPipeline::Run() {
+    if (!Start()) {
+        return;
+    }
+
+    while (m_running && IsWindowOpen()) {
+        // Process window messages
+        if (!m_presenter->ProcessMessages()) {
+            break;
+        }
+
+        if (m_config.pipelinedMode) {
+            // Stage threads do the work; just keep the window responsive
+            // (and apply capture size changes)
+            MsgWaitForMultipleObjects(0, nullptr, FALSE, 1, QS_ALLINPUT);
+        }
+
+        // Process one frame
+        ProcessFrame();
+    }
+
+    Stop();
+}
+
+bool DualGPUPipeline::StartStageThreads() {
+    m_transferReadyEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_computeReadyEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_captureSlotFreeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    m_computeSlotFreeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_transferReadyEvent || !m_computeReadyEvent ||
+        !m_captureSlotFreeEvent || !m_computeSlotFreeEvent) {
+        SetError("Failed to create pipeline stage events");
+        return false;
+    }
+
+    m_transferQueue.Clear();
+    m_presentSlotQueue.Clear();
+    m_retiredFrames = 0;
+    m_presentSubmittedFrames = 0;
+
+    m_captureThread = std::thread(&DualGPUPipeline::CaptureThreadProc, this);
+    m_computeThread = std::thread(&DualGPUPipeline::ComputeThreadProc, this);
+    m_presentThread = std::thread(&DualGPUPipeline::PresentThreadProc, this);
+
+    return true;
+}
+
+void DualGPUPipeline::StopStageThreads() {
+    // Stage threads poll m_running between short waits, so they exit promptly
+    if (m_captureThread.joinable()) m_captureThread.join();
+    if (m_computeThread.joinable()) m_computeThread.join();
+    if (m_presentThread.joinable()) m_presentThread.join();
+
+    for (HANDLE* event : { &m_transferReadyEvent, &m_computeReadyEvent,
+                           &m_captureSlotFreeEvent, &m_computeSlotFreeEvent }) {
+        if (*event) {
+            CloseHandle(*event);
+            *event = nullptr;
+        }
+    }
+
+    m_transferQueue.Clear();
+    m_presentSlotQueue.Clear();
+}
+
+// Upper bound on how long a stage thread sleeps before re-checking m_running
+static const DWORD STAGE_WAIT_MS = 2;
+
+void DualGPUPipeline::CaptureThreadProc() {
+    const uint32_t bufferCount = GetFrameBufferCount();
+    uint64_t frameNumber = 0;
+    uint32_t previousBuffer = 0;
+
+    // The thread sleeps in AcquireNextFrame almost all the time; MMCSS makes
+    // sure it is scheduled promptly when a desktop frame lands
+    HANDLE mmcss = nullptr;
+    if (m_config.captureThreadTask) {
+        DWORD taskIndex = 0;
+        mmcss = AvSetMmThreadCharacteristicsW(m_config.captureThreadTask, &taskIndex);
+        if (mmcss) {
+            AvSetMmThreadPriority(mmcss, AVRT_PRIORITY_HIGH);
+        }
+    }
+    m_captureStats.captureThreadMmcss = mmcss != nullptr;
+
+    while (m_running && !m_resizePending) {
+        // The transfer ring slot we are about to overwrite must not still be
+        // read downstream. Frames [retired - 1, frameNumber) are in flight
+        // (the last retired frame is still "previous" for the next one).
+        if (frameNumber + 2 > m_retiredFrames.load(std::memory_order_acquire) + bufferCount) {
+            WaitForSingleObject(m_captureSlotFreeEvent, STAGE_WAIT_MS);
+            continue;
+        }
+
+        FrameSlot slot;
+        slot.bufferIndex = GetFrameBufferIndex();
+
+        if (!CaptureFrame()) {
+            // Timed out waiting for a desktop frame (or pointer-only update)
+            PublishCaptureStats();
+            continue;
+        }
+
+        slot.frameNumber = frameNumber;
+        slot.previousBufferIndex = previousBuffer;
+        slot.hasPrevious = frameNumber > 0;
+        slot.frameFenceValue = m_frameFenceValue;
+        slot.captureTime = m_frameArrivalTime;
+        slot.capture = m_frameCapture;
+
+        TransferFrame();
+        PublishCaptureStats();
+        AdvanceFrameBuffer();
+
+        // Cannot overflow: the retire check above bounds frames in flight
+        // below the queue depth for any sane buffer count
+        while (m_running && !m_transferQueue.TryPush(slot)) {
+            WaitForSingleObject(m_captureSlotFreeEvent, STAGE_WAIT_MS);
+        }
+        SetEvent(m_transferReadyEvent);
+
+        previousBuffer = slot.bufferIndex;
+        frameNumber++;
+    }
+
+    if (mmcss) {
+        AvRevertMmThreadCharacteristics(mmcss);
+    }
+}
+
+void DualGPUPipeline::ComputeThreadProc() {
+    FrameSlot slot;
+
+    while (m_running) {
+        if (!m_transferQueue.TryPop(slot)) {
+            WaitForSingleObject(m_transferReadyEvent, STAGE_WAIT_MS);
+            continue;
+        }
+        SetEvent(m_captureSlotFreeEvent);
+
+        ID3D12Resource* currentFrame = GetFrameTexture(slot.bufferIndex);
+        ID3D12Resource* previousFrame = slot.hasPrevious ?
+            GetFrameTexture(slot.previousBufferIndex) : nullptr;
+
+        // The interpolation outputs alternate between two sets: wait until
+        // the present stage has queued its copies of the frame two back
+        // (the last user of this frame's set), so its retire value is known.
+        // The compute queue then waits for it on the GPU.
+        while (m_running && m_presentSubmittedFrames.load(std::memory_order_acquire) + 1 < slot.frameNumber) {
+            WaitForSingleObject(m_computeSlotFreeEvent, STAGE_WAIT_MS);
+        }
+        if (!m_running) break;
+
+        slot.generatedCount = 0;
+        slot.computeFenceValue = 0;
+
+        if (previousFrame && BeginComputeFrame()) {
+            slot.generatedSet = m_generatedSet;
+            bool recorded = ComputeOpticalFlow(currentFrame, previousFrame);
+            if (recorded && m_frameGenEnabled) {
+                recorded = GenerateFrames(currentFrame, previousFrame, slot.generatedCount);
+            }
+            if (!SubmitComputeFrame(slot.frameFenceValue, slot.captureTime, slot.computeFenceValue) || !recorded) {
+                slot.generatedCount = 0;
+            }
+            PublishComputeStats();
+        }
+
+        while (m_running && !m_presentSlotQueue.TryPush(slot)) {
+            WaitForSingleObject(m_computeSlotFreeEvent, STAGE_WAIT_MS);
+        }
+        SetEvent(m_computeReadyEvent);
+    }
+}
+
+void DualGPUPipeline::PresentThreadProc() {
+    FrameSlot slot;
+
+    // Frames whose copies are queued but not yet retired on the GPU:
+    // (frame number, present fence value of its last copy)
+    std::deque<std::pair<uint64_t, uint64_t>> pendingRetire;
+
+    auto retireCompleted = [&]() {
+        const uint64_t completed = m_presentFence->GetCompletedValue();
+        bool retired = false;
+        while (!pendingRetire.empty() && pendingRetire.front().second <= completed) {
+            m_retiredFrames.store(pendingRetire.front().first + 1, std::memory_order_release);
+            pendingRetire.pop_front();
+            retired = true;
+        }
+        if (retired) {
+            SetEvent(m_captureSlotFreeEvent);
+        }
+    };
+
+    while (m_running) {
+        retireCompleted();
+
+        if (!m_presentSlotQueue.TryPop(slot)) {
+            WaitForSingleObject(m_computeReadyEvent, STAGE_WAIT_MS);
+            continue;
+        }
+
+        m_frameStartTime = std::chrono::high_resolution_clock::now();
+
+        ID3D12Resource* currentFrame = GetFrameTexture(slot.bufferIndex);
+        ID3D12Resource* previousFrame = slot.hasPrevious ?
+            GetFrameTexture(slot.previousBufferIndex) : nullptr;
+        PresentFrames(currentFrame, previousFrame, slot.generatedCount, slot.generatedSet,
+                      slot.computeFenceValue, slot.frameFenceValue, slot.capture.desktopPresentQpc);
+
+        // Every copy reading this frame is now queued behind its compute work
+        m_presentSubmittedFrames.store(slot.frameNumber + 1, std::memory_order_release);
+        SetEvent(m_computeSlotFreeEvent);
+
+        pendingRetire.emplace_back(slot.frameNumber, m_presentFenceValue);
+
+        UpdateStats(slot.captureTime);
+        RecordFrame(slot.frameNumber, slot.capture, slot.generatedCount);
+    }
+}
+
+bool DualGPUPipeline::CaptureFrame() {
+    CapturedFrame frame;
+    const bool captured = m_capture->CaptureFrame(frame);
+    m_captureStats.captureRecovering = m_capture->IsRecovering();
+    m_captureStats.captureRecoveries = m_capture->GetStats().recoveries;
+    if (!captured) {
+        // No new frame available (or capture is being re-created) - not an error
+        return false;
+    }
+
+    LARGE_INTEGER acquiredQpc;
+    QueryPerformanceCounter(&acquiredQpc);
+
+    // Duplication re-created at another resolution: the ring, flow,
+    // interpolation and swap chain are re-sized on the thread that owns the
+    // frame loop (ProcessFrame()). This frame cannot be copied into the old
+    // ring and is dropped.
+    if (frame.width != m_config.width || frame.height != m_config.height) {
+        m_capture->ReleaseFrame();
+        m_resizeWidth = frame.width;
+        m_resizeHeight = frame.height;
+        m_resizePending = true;
+        return false;
+    }
+
+    // Pointer-only update: the desktop image is unchanged, so there is
+    // nothing to transfer or interpolate
+    if (!frame.hasImageUpdate) {
+        m_capture->ReleaseFrame();
+        m_captureStats.unchangedFramesSkipped++;
+        return false;
+    }
+
+    // The desktop's own present stamp drives pacing; the acquisition time
+    // starts this frame's timeline
+    m_pacer.OnFramePresented(frame.presentTimeQpc);
+    m_frameArrivalTime = frame.captureTime;
+    const double captureLatencyMs = frame.presentTimeQpc > 0 && acquiredQpc.QuadPart > frame.presentTimeQpc
+        ? static_cast<double>(acquiredQpc.QuadPart - frame.presentTimeQpc) * m_qpcToMs : 0.0;
+
+    m_captureStats.captureLatencyMs = captureLatencyMs;
+    m_captureStats.baseFamesCaptured++;
+
+    m_frameCapture.desktopPresentQpc = frame.presentTimeQpc;
+    m_frameCapture.acquiredQpc = acquiredQpc.QuadPart;
+    m_frameCapture.missedFrames = frame.accumulatedFrames > 1 ? frame.accumulatedFrames - 1 : 0;
+    m_frameCapture.captureLatencyMs = static_cast<float>(captureLatencyMs);
+
+    const bool partial = CaptureSource::GetChangedRects(frame, m_changedRects);
+    const RECT* changedRects = partial ? m_changedRects.data() : nullptr;
+    const uint32_t changedRectCount = static_cast<uint32_t>(m_changedRects.size());
+
+    // No shared targets: read the frame back and upload it into the current
+    // transfer buffer's ingest texture from the CPU
+    if (m_stagedIngest) {
+        D3D11_MAPPED_SUBRESOURCE mapped = {};
+        const bool mappedFrame = m_capture->MapFrame(frame, mapped);
+        m_capture->ReleaseFrame();
+        if (!mappedFrame) {
+            m_transfer->InvalidateRegions();
+            ReportError("Capture readback failed: " + m_capture->GetLastError());
+            return false;
+        }
+
+        const bool transferred = m_transfer->TransferUploadedFrame(mapped.pData, mapped.RowPitch,
+                                                                   changedRects, changedRectCount);
+        m_capture->UnmapFrame();
+        if (!transferred) {
+            ReportError("Transfer failed: " + m_transfer->GetLastError());
+            return false;
+        }
+
+        m_captureStats.captureTimeMs = std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - m_frameArrivalTime).count();
+        m_frameCapture.captureMs = static_cast<float>(m_captureStats.captureTimeMs);
+        m_frameFenceValue = m_transfer->GetDestFenceValue();
+        return true;
+    }
+
+    // Copy the duplication surface once on the primary GPU into the current
+    // transfer buffer's shared texture, then hand it to the transfer. Both
+    // sides are ordered by the shared ingest fence. The CPU only waits if
+    // the transfer has not finished reading that texture one ring lap ago.
+    // Both only copy the regions the desktop reports as changed.
+    if (m_transfer) {
+        m_transfer->WaitForIngestSlot(GetFrameBufferIndex());
+    }
+    uint64_t ingestFenceValue = 0;
+    const bool copied = m_capture->CopyToSharedTarget(frame, GetFrameBufferIndex(), ingestFenceValue);
+    m_capture->ReleaseFrame();
+
+    if (!copied) {
+        // This frame's damage never reached the transfer buffers
+        m_capture->InvalidateSharedTargets();
+        if (m_transfer) {
+            m_transfer->InvalidateRegions();
+        }
+        ReportError("Capture copy failed: " + m_capture->GetLastError());
+        return false;
+    }
+
+    m_captureStats.captureTimeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - m_frameArrivalTime).count();
+    m_frameCapture.captureMs = static_cast<float>(m_captureStats.captureTimeMs);
+
+    // Single GPU: the captured texture is read in place, so frame generation
+    // only has to be ordered after the capture device's copy
+    if (m_singleGPU) {
+        m_frameFenceValue = ingestFenceValue;
+        return true;
+    }
+
+    if (!m_transfer->TransferIngestedFrame(ingestFenceValue, changedRects, changedRectCount)) {
+        ReportError("Transfer failed: " + m_transfer->GetLastError());
+        return false;
+    }
+    m_frameFenceValue = m_transfer->GetDestFenceValue();
+
+    return true;
+}
+
+bool DualGPUPipeline::TransferFrame() {
+    // The copy was submitted in CaptureFrame(); this only collects its timing
+    if (m_singleGPU) {
+        m_captureStats.singleGPU = true;
+        return true;
+    }
+
+    const TransferStats& transferStats = m_transfer->GetStats();
+    m_captureStats.transferTimeMs = transferStats.lastTransferTimeMs;
+    m_captureStats.transferThroughputMBps = transferStats.throughputMBps;
+    m_captureStats.gpuTransferSourceMs = transferStats.gpuSourceTimeMs;
+    m_captureStats.gpuTransferDestMs = transferStats.gpuDestTimeMs;
+    m_captureStats.copyQueueBubbleMs = transferStats.destQueueBubbleMs;
+    m_captureStats.usingPeerToPeer = (m_transfer->GetTransferMethod() == TransferMethod::CrossAdapterHeap);
+    m_captureStats.transferEncoded = m_transfer->GetEncoding() != TransferEncoding::BGRA8;
+    m_captureStats.stagedIngest = m_stagedIngest;
+
+    return true;
+}
+
+void DualGPUPipeline::WaitForFence(ID3D12Fence* fence, HANDLE fenceEvent, uint64_t value) {
+    if (fence && value > 0 && fence->GetCompletedValue() < value) {
+        fence->SetEventOnCompletion(value, fenceEvent);
+        WaitForSingleObject(fenceEvent, INFINITE);
+    }
+}
+
+bool DualGPUPipeline::BeginComputeFrame() {
+    // The ring only blocks when the allocator it hands out still belongs to
+    // a submission COMPUTE_FRAMES_IN_FLIGHT frames back. This is the only CPU
+    // wait on the compute timeline.
+    m_computeCommandList = m_computeRing.Begin();
+    if (!m_computeCommandList) {
+        SetError("Failed to begin compute frame: " + m_computeRing.GetLastError());
+        return false;
+    }
+    m_generatedSet = (m_generatedSet + 1) % GENERATED_FRAME_SETS;
+    m_computeProfiler.BeginFrame();
+    return true;
+}
+
+bool DualGPUPipeline::SubmitComputeFrame(uint64_t frameFenceValue,
+                                         std::chrono::high_resolution_clock::time_point arrivalTime,
+                                         uint64_t& fenceValue) {
+    // Signal the compute timeline; consumers wait on this value GPU-side
+    m_computeFenceValue++;
+    m_computeProfiler.EndFrame(m_computeCommandList, m_computeFence.Get(), m_computeFenceValue);
+    m_computeCommandList = nullptr;
+
+    if (m_computeScheduler) {
+        // Shared queue: the scheduler resolves the same two waits on the CPU
+        // and runs the list when it falls due among every output's frames -
+        // one base interval after this frame arrived
+        ID3D12GraphicsCommandList* commandList = m_computeRing.Close(m_computeFence.Get(), m_computeFenceValue);
+        if (!commandList) {
+            SetError("Failed to submit compute frame: " + m_computeRing.GetLastError());
+            return false;
+        }
+
+        ComputeSubmission submission;
+        submission.commandList = commandList;
+        submission.waits[0].fence = m_frameFence;
+        submission.waits[0].value = frameFenceValue;
+        submission.waits[1].fence = m_presentFence.Get();
+        submission.waits[1].value = m_generatedRetireValues[m_generatedSet];
+        submission.signalFence = m_computeFence.Get();
+        submission.signalValue = m_computeFenceValue;
+        submission.deadline = arrivalTime + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<double, std::milli>(m_pacer.GetBaseIntervalMs()));
+        if (!m_computeScheduler->Submit(submission)) {
+            // Nothing will run the list: retire its allocator from the CPU
+            m_computeFence->Signal(m_computeFenceValue);
+            SetError("Failed to schedule compute frame: " + m_computeScheduler->GetLastError());
+            return false;
+        }
+    } else {
+        // GPU-side ordering only: after the frame reached this device, and
+        // after the present queue finished copying the generated set we
+        // overwrite
+        if (frameFenceValue > 0) {
+            m_computeQueue->Wait(m_frameFence, frameFenceValue);
+        }
+        if (m_generatedRetireValues[m_generatedSet] > 0) {
+            m_computeQueue->Wait(m_presentFence.Get(), m_generatedRetireValues[m_generatedSet]);
         }
 
-        // Flip the swap chain
-        m_presenter->Flip(syncInterval, 0);
+        if (!m_computeRing.Submit(m_computeQueue.Get(), m_computeFence.Get(), m_computeFenceValue)) {
+            SetError("Failed to submit compute frame: " + m_computeRing.GetLastError());
+            return false;
+        }
+    }
+
+    fenceValue = m_computeFenceValue;
+
+    // Interpolation dispatches (generated-frame path) read their constants
+    // until this value; the back-buffer path retires them on the present queue
+    if (!m_directOutput && m_interpolation) {
+        m_interpolation->Retire(m_computeFence.Get(), m_computeFenceValue);
+    }
+
+    // Timestamps of frames that have already retired; these replace the
+    // modules' own single-slot timers, which are only exact when serialized
+    if (m_computeProfiler.Collect()) {
+        const GpuFrameTimes& times = m_computeProfiler.GetLastFrame();
+        m_computeStats.opticalFlowTimeMs = times.StageMs(GpuStage::OpticalFlow);
+        m_computeStats.interpolationTimeMs = times.StageMs(GpuStage::Interpolation);
+        m_computeStats.computeQueueBubbleMs = times.bubbleMs;
+        m_computeStats.computeStartLatencyMs = times.startLatencyMs;
+        m_computeStats.gpuTimedFrames++;
+    }
+
+    return true;
+}
+
+bool DualGPUPipeline::ComputeOpticalFlow(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame) {
+    if (!currentFrame || !previousFrame) {
+        // Need at least 2 frames for optical flow
+        return true;  // Not an error, nothing recorded
+    }
+
+    // Record optical flow
+    m_computeProfiler.BeginScope(m_computeCommandList, GpuStage::OpticalFlow);
+    const bool dispatched = m_opticalFlow->Dispatch(currentFrame, previousFrame, m_computeCommandList);
+    m_computeProfiler.EndScope(m_computeCommandList);
+    if (!dispatched) {
+        SetError("Optical flow computation failed");
+        return false;
+    }
+
+    // Work is no longer waited on per stage, so report GPU timestamps
+    if (!m_computeProfiler.IsInitialized()) {
+        m_computeStats.opticalFlowTimeMs = m_opticalFlow->GetLastGpuTimeMs();
+    }
+
+    return true;
+}
+
+bool DualGPUPipeline::GenerateFrames(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame,
+                                     uint32_t& generatedCount) {
+    generatedCount = 0;
+
+    // Prefer the smoothed field (bilinear) over the raw block vectors
+    ID3D12Resource* motionVectors = m_opticalFlow->GetMotionField();
+    if (!motionVectors) {
+        motionVectors = m_opticalFlow->GetMotionVectorTexture();
+    }
+
+    if (!currentFrame || !previousFrame || !motionVectors) {
+        return true;  // Not enough data yet
+    }
+
+    // FidelityFX generates one frame per real frame from a snapshot of the
+    // field, handed to its prepare pass on the present queue
+    if (m_ffxFrameGen) {
+        if (motionVectors != m_opticalFlow->GetMotionField()) {
+            return true;  // Block vectors only: nothing the prepare pass can read
+        }
+        if (!RecordPresentInputs(motionVectors)) {
+            return false;
+        }
+
+        generatedCount = 1;
+        m_computeStats.framesGenerated++;
+        return true;
+    }
+
+    // Generate intermediate frames based on multiplier (loaded once so a
+    // concurrent SetFrameMultiplier() cannot change it mid-frame)
+    const FrameMultiplier multiplier = m_multiplier.load();
+    const uint32_t numGenFrames = (std::min)(static_cast<uint32_t>(multiplier) - 1,
+                                               static_cast<uint32_t>(MAX_GENERATED_FRAMES));
+
+    // Back-buffer output: the present pass interpolates every phase (and
+    // handles scene cuts) from a snapshot of this frame's flow outputs
+    if (m_directOutput) {
+        if (!RecordPresentInputs(motionVectors)) {
+            return false;
+        }
+
+        generatedCount = numGenFrames;
+
+        if (!m_computeProfiler.IsInitialized()) {
+            m_computeStats.interpolationTimeMs = m_interpolation->GetStats().lastGpuTimeMs;
+        }
+        m_computeStats.framesGenerated += numGenFrames;
+        return true;
+    }
+
+    if (!EnsureGeneratedFrames(numGenFrames)) {
+        return false;
+    }
+
+    // Every phase t = (i+1)/multiplier goes out in one multi-output pass
+    // (chunked only if there are more phases than the kernel has outputs)
+    ID3D12Resource* targets[MAX_GENERATED_FRAMES] = {};
+    float factors[MAX_GENERATED_FRAMES] = {};
+    for (uint32_t i = 0; i < numGenFrames; i++) {
+        targets[i] = m_generatedFrames[m_generatedSet][i].Get();
+        factors[i] = static_cast<float>(i + 1) / static_cast<float>(multiplier);
+    }
+
+    // The static-tile history sees every base frame, scene cuts included
+    if (!m_interpolation->UpdateStaticTiles(currentFrame, motionVectors, m_computeCommandList)) {
+        SetError("Static tile update failed: " + m_interpolation->GetLastError());
+        return false;
+    }
+
+    // On a scene cut the optical flow predicate is set: interpolation is
+    // skipped on the GPU and the real frame is repeated instead. Predicated
+    // commands are skipped when the op holds, so the phases go under
+    // NOT_EQUAL_ZERO (skipped on a cut) and the repeat under EQUAL_ZERO.
+    ID3D12Resource* scenePredicate = m_opticalFlow->GetSceneChangePredicate();
+    if (scenePredicate) {
+        m_computeCommandList->SetPredication(scenePredicate,
+                                             OSFG::MotionEstimator::SCENE_PREDICATE_OFFSET,
+                                             D3D12_PREDICATION_OP_NOT_EQUAL_ZERO);
+    }
+
+    // One timestamp scope per dispatch chunk (the index is its first phase)
+    for (uint32_t first = 0; first < numGenFrames; first += OSFG::FrameInterpolation::MAX_PHASES) {
+        const uint32_t count = (std::min)(numGenFrames - first,
+                                          static_cast<uint32_t>(OSFG::FrameInterpolation::MAX_PHASES));
+        m_computeProfiler.BeginScope(m_computeCommandList, GpuStage::Interpolation, first);
+        const bool dispatched = m_interpolation->DispatchPhases(previousFrame, currentFrame, motionVectors,
+                                                                targets + first, factors + first, count,
+                                                                m_computeCommandList);
+        m_computeProfiler.EndScope(m_computeCommandList);
+        if (!dispatched) {
+            SetError("Frame interpolation failed: " + m_interpolation->GetLastError());
+            return false;
+        }
+    }
+
+    if (scenePredicate) {
+        m_computeCommandList->SetPredication(scenePredicate,
+                                             OSFG::MotionEstimator::SCENE_PREDICATE_OFFSET,
+                                             D3D12_PREDICATION_OP_EQUAL_ZERO);
+        for (uint32_t first = 0; first < numGenFrames; first += OSFG::FrameInterpolation::MAX_PHASES) {
+            const uint32_t count = (std::min)(numGenFrames - first,
+                                              static_cast<uint32_t>(OSFG::FrameInterpolation::MAX_PHASES));
+            m_computeProfiler.BeginScope(m_computeCommandList, GpuStage::Interpolation, first);
+            const bool dispatched = m_interpolation->DispatchRepeat(currentFrame, motionVectors,
+                                                                    targets + first, count,
+                                                                    m_computeCommandList);
+            m_computeProfiler.EndScope(m_computeCommandList);
+            if (!dispatched) {
+                SetError("Frame repeat failed: " + m_interpolation->GetLastError());
+                return false;
+            }
+        }
+        m_computeCommandList->SetPredication(nullptr, 0, D3D12_PREDICATION_OP_EQUAL_ZERO);
+    }
+
+    generatedCount = numGenFrames;
+
+    if (!m_computeProfiler.IsInitialized()) {
+        m_computeStats.interpolationTimeMs = m_interpolation->GetStats().lastGpuTimeMs;
+    }
+    m_computeStats.framesGenerated += numGenFrames;
+
+    return true;
+}
+
+bool DualGPUPipeline::RecordPresentInputs(ID3D12Resource* motionVectors) {
+    const uint32_t set = m_generatedSet;
+    ID3D12Resource* scenePredicate = m_opticalFlow->GetSceneChangePredicate();
+
+    // Copies are a fraction of a frame: the field is half resolution and the
+    // block vectors one texel per block. Each copy is its own arena owner so
+    // it can be replaced alone.
+    if (!m_presentMotion[set] || m_presentMotion[set]->GetDesc().Format != motionVectors->GetDesc().Format) {
+        D3D12_RESOURCE_DESC texDesc = motionVectors->GetDesc();
+        texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+        m_presentMotion[set].Reset();
+        if (m_computeArena) {
+            m_computeArena->Release(&m_presentMotion[set]);
+        }
+        HRESULT hr = CreateArenaResource(m_computeArena, &m_presentMotion[set], m_computeDevice.Get(),
+                                         D3D12_HEAP_TYPE_DEFAULT, texDesc, D3D12_RESOURCE_STATE_COMMON,
+                                         nullptr, m_presentMotion[set]);
+        if (FAILED(hr)) {
+            SetError("Failed to create present motion buffer " + std::to_string(set));
+            return false;
+        }
+    }
+
+    if (scenePredicate && !m_presentPredicates[set]) {
+        D3D12_RESOURCE_DESC bufferDesc = {};
+        bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        bufferDesc.Width = sizeof(uint64_t);
+        bufferDesc.Height = 1;
+        bufferDesc.DepthOrArraySize = 1;
+        bufferDesc.MipLevels = 1;
+        bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+        bufferDesc.SampleDesc.Count = 1;
+        bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        HRESULT hr = CreateArenaResource(m_computeArena, this, m_computeDevice.Get(), D3D12_HEAP_TYPE_DEFAULT,
+                                         bufferDesc, D3D12_RESOURCE_STATE_COMMON, nullptr,
+                                         m_presentPredicates[set]);
+        if (FAILED(hr)) {
+            SetError("Failed to create present predicate buffer " + std::to_string(set));
+            return false;
+        }
+    }
+
+    // Motion vectors rest in ofConfig.vectorReadState, the predicate in PREDICATION
+    D3D12_RESOURCE_BARRIER barriers[4] = {};
+    auto transition = [](D3D12_RESOURCE_BARRIER& barrier, ID3D12Resource* resource,
+                         D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = resource;
+        barrier.Transition.StateBefore = before;
+        barrier.Transition.StateAfter = after;
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    };
+
+    UINT barrierCount = 2;
+    transition(barriers[0], motionVectors, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+               D3D12_RESOURCE_STATE_COPY_SOURCE);
+    transition(barriers[1], m_presentMotion[set].Get(), D3D12_RESOURCE_STATE_COMMON,
+               D3D12_RESOURCE_STATE_COPY_DEST);
+    if (scenePredicate) {
+        transition(barriers[2], scenePredicate, D3D12_RESOURCE_STATE_PREDICATION,
+                   D3D12_RESOURCE_STATE_COPY_SOURCE);
+        transition(barriers[3], m_presentPredicates[set].Get(), D3D12_RESOURCE_STATE_COMMON,
+                   D3D12_RESOURCE_STATE_COPY_DEST);
+        barrierCount = 4;
+    }
+    m_computeCommandList->ResourceBarrier(barrierCount, barriers);
+
+    m_computeCommandList->CopyResource(m_presentMotion[set].Get(), motionVectors);
+    if (scenePredicate) {
+        m_computeCommandList->CopyBufferRegion(m_presentPredicates[set].Get(), 0, scenePredicate,
+                                               OSFG::MotionEstimator::SCENE_PREDICATE_OFFSET,
+                                               sizeof(uint64_t));
+    }
+
+    for (UINT i = 0; i < barrierCount; i++) {
+        std::swap(barriers[i].Transition.StateBefore, barriers[i].Transition.StateAfter);
+    }
+    m_computeCommandList->ResourceBarrier(barrierCount, barriers);
+
+    return true;
+}
 
-        {
-            std::lock_guard<std::mutex> lock(m_statsMutex);
-            m_stats.framesPresented++;
+bool DualGPUPipeline::PresentFrames(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame,
+                                    uint32_t generatedCount, uint32_t generatedSet,
+                                    uint64_t computeFenceValue, uint64_t frameFenceValue,
+                                    int64_t sourcePresentQpc) {
+    if (m_ffxFrameGen) {
+        return PresentFidelityFX(currentFrame, generatedCount, generatedSet,
+                                 computeFenceValue, frameFenceValue);
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    if (!currentFrame) {
+        return true;
+    }
+
+    int totalFrames = static_cast<int>(generatedCount) + 1;
+    uint32_t syncInterval = m_vsync ? 1 : 0;
+    m_presentCallCount = 0;
+
+    // The copies read this frame's compute results: order them after the
+    // compute submission on the GPU timeline instead of waiting on the CPU
+    if (computeFenceValue > 0) {
+        m_presentQueue->Wait(m_computeFence.Get(), computeFenceValue);
+    }
+    // The real frame may not have gone through compute (first frame)
+    if (frameFenceValue > 0) {
+        m_presentQueue->Wait(m_frameFence, frameFenceValue);
+    }
+
+    // Helper lambda to present and flip a single frame; record() writes the
+    // back buffer (a copy, or a draw straight into it). The base frame's
+    // timestamps are resolved in the list of its last pass.
+    uint32_t pass = 0;
+    auto presentSingleFrame = [&](bool lastPass, auto&& record) -> bool {
+        // Reuse the oldest allocator once its last copy has retired. The
+        // swap chain already throttles us, so this rarely blocks.
+        // Waitable swap chain: block here, before recording, rather than in Flip()
+        m_presenter->WaitForFrameLatency();
+
+        ID3D12GraphicsCommandList* cmdList = m_presentRing.Begin();
+        if (!cmdList) {
+            ReportError("Failed to begin present copy: " + m_presentRing.GetLastError());
+            return false;
+        }
+
+        // Begun after the pacing and latency waits, so they do not count as bubbles
+        if (pass == 0) {
+            m_presentProfiler.BeginFrame();
+        }
+        m_presentProfiler.BeginScope(cmdList, GpuStage::Present, pass++);
+        if (m_overlay) {
+            m_overlay->RecordUpload(cmdList, m_presentFenceValue + 1);
         }
+        record(cmdList);
+        m_presentProfiler.EndScope(cmdList);
+
+        // Execute and tag the allocator with the value that retires it
+        m_presentFenceValue++;
+        if (lastPass) {
+            m_presentProfiler.EndFrame(cmdList, m_presentFence.Get(), m_presentFenceValue);
+        }
+        if (!m_presentRing.Submit(m_presentQueue.Get(), m_presentFence.Get(), m_presentFenceValue)) {
+            ReportError("Failed to submit present copy: " + m_presentRing.GetLastError());
+            return false;
+        }
+        // Back-buffer draws read interpolation constants until this value
+        if (m_directOutput && m_interpolation) {
+            m_interpolation->Retire(m_presentFence.Get(), m_presentFenceValue);
+        }
+
+        // Flip the swap chain. Generated frames count from the newer real
+        // frame's present: they cannot be shown before it exists.
+        if (m_config.glassLatency) {
+            m_presenter->SetPresentSource(sourcePresentQpc, !lastPass);
+        }
+        LARGE_INTEGER flipStart;
+        LARGE_INTEGER flipEnd;
+        QueryPerformanceCounter(&flipStart);
+        m_presenter->Flip(syncInterval, 0);
+        QueryPerformanceCounter(&flipEnd);
+        RecordPresentCall(flipStart.QuadPart, flipEnd.QuadPart);
+
+        m_stats.framesPresented++;
 
         return true;
     };
 
-    if (m_frameGenEnabled && m_generatedFrameCount > 0) {
-        // Present interleaved: gen0, gen1, ..., real
-        for (uint32_t i = 0; i < m_generatedFrameCount; i++) {
-            // Frame pacing
-            WaitForFramePacing(i, totalFrames);
+    // Back-buffer output: each phase is one full-screen pass reading both
+    // frames and the set's motion copy. Ring frames and the copies rest in
+    // COMMON and are promoted to PIXEL_SHADER_RESOURCE implicitly.
+    ID3D12Resource* motionVectors = m_presentMotion[generatedSet].Get();
+    ID3D12Resource* scenePredicate = m_opticalFlow->GetSceneChangePredicate() ?
+        m_presentPredicates[generatedSet].Get() : nullptr;
+    const bool drawFrames = m_directOutput && generatedCount > 0 && previousFrame && motionVectors;
+
+    auto drawPhase = [&](ID3D12GraphicsCommandList* cmdList, float factor) {
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_presenter->BeginRenderTarget(cmdList);
+
+        if (factor >= 1.0f) {
+            m_interpolation->DrawRepeat(currentFrame, motionVectors, rtv, cmdList);
+        } else if (!scenePredicate) {
+            m_interpolation->Draw(previousFrame, currentFrame, motionVectors, rtv, factor, cmdList);
+        } else {
+            // Same predicate pair as the compute path: the draw is skipped on
+            // a cut (NOT_EQUAL_ZERO), the repeat otherwise (EQUAL_ZERO)
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = scenePredicate;
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PREDICATION;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            cmdList->ResourceBarrier(1, &barrier);
+
+            cmdList->SetPredication(scenePredicate, 0, D3D12_PREDICATION_OP_NOT_EQUAL_ZERO);
+            m_interpolation->Draw(previousFrame, currentFrame, motionVectors, rtv, factor, cmdList);
+            cmdList->SetPredication(scenePredicate, 0, D3D12_PREDICATION_OP_EQUAL_ZERO);
+            m_interpolation->DrawRepeat(currentFrame, motionVectors, rtv, cmdList);
+            cmdList->SetPredication(nullptr, 0, D3D12_PREDICATION_OP_EQUAL_ZERO);
+
+            std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+            cmdList->ResourceBarrier(1, &barrier);
+        }
+
+        if (m_overlay) {
+            m_overlay->Record(cmdList, rtv, m_config.width, m_config.height);
+        }
+        m_presenter->EndRenderTarget(cmdList);
+    };
+
+    // Reduced-size generated frames: upscaled into the back buffer, overlay on top
+    auto upscaleFrame = [&](ID3D12GraphicsCommandList* cmdList, uint32_t slot) {
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_presenter->BeginRenderTarget(cmdList);
+        m_upscaler->Record(cmdList, slot, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                           rtv, m_config.width, m_config.height);
+        if (m_overlay) {
+            m_overlay->Record(cmdList, rtv, m_config.width, m_config.height);
+        }
+        m_presenter->EndRenderTarget(cmdList);
+    };
+
+    // Copied frames: the overlay is blended onto the back buffer after the copy
+    auto copyFrame = [&](ID3D12GraphicsCommandList* cmdList, ID3D12Resource* frame,
+                         D3D12_RESOURCE_STATES frameState) {
+        m_presenter->Present(frame, cmdList, frameState);
+        if (m_overlay && m_overlay->HasImage()) {
+            D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_presenter->BeginRenderTarget(cmdList);
+            m_overlay->Record(cmdList, rtv, m_config.width, m_config.height);
+            m_presenter->EndRenderTarget(cmdList);
+        }
+    };
 
-            // Present generated frame
-            ID3D12Resource* genFrame = m_interpolation->GetInterpolatedFrame();
-            if (genFrame) {
-                presentSingleFrame(genFrame);
+    // Present interleaved: gen0, gen1, ..., real
+    bool staticTilesFailed = false;
+    for (uint32_t i = 0; i < generatedCount; i++) {
+        // Frame pacing
+        WaitForFramePacing(static_cast<int>(i), totalFrames);
+
+        if (drawFrames) {
+            const float factor = static_cast<float>(i + 1) / static_cast<float>(totalFrames);
+            presentSingleFrame(false, [&](ID3D12GraphicsCommandList* cmdList) {
+                // The static-tile history advances once per base frame, on
+                // the queue that reads it, ahead of the first phase
+                if (i == 0 && !m_interpolation->UpdateStaticTiles(currentFrame, motionVectors, cmdList)) {
+                    staticTilesFailed = true;
+                }
+                drawPhase(cmdList, factor);
+            });
+            if (staticTilesFailed && i == 0) {
+                SetError("Static tile update failed: " + m_interpolation->GetLastError());
             }
+            continue;
+        }
+
+        // Present generated frame
+        ID3D12Resource* genFrame = m_directOutput ? nullptr : m_generatedFrames[generatedSet][i].Get();
+        if (genFrame) {
+            presentSingleFrame(false, [&](ID3D12GraphicsCommandList* cmdList) {
+                if (m_upscaler) {
+                    upscaleFrame(cmdList, generatedSet * MAX_GENERATED_FRAMES + i);
+                } else {
+                    copyFrame(cmdList, genFrame, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+                }
+            });
         }
     }
 
-    // Present the real frame last
+    // Present the real frame last: blitted by the same full-screen pass when
+    // drawing, otherwise copied. Ring frames rest in COMMON (copy-queue
+    // transfer or shared capture texture).
     WaitForFramePacing(totalFrames - 1, totalFrames);
-    presentSingleFrame(currentFrame);
+    if (drawFrames) {
+        presentSingleFrame(true, [&](ID3D12GraphicsCommandList* cmdList) { drawPhase(cmdList, 1.0f); });
+    } else {
+        presentSingleFrame(true, [&](ID3D12GraphicsCommandList* cmdList) {
+            copyFrame(cmdList, currentFrame, D3D12_RESOURCE_STATE_COMMON);
+        });
+    }
+
+    // The set is free once its last reader retires (the real frame's pass
+    // also reads the motion copy)
+    if (generatedCount > 0) {
+        m_generatedRetireValues[generatedSet] = m_presentFenceValue;
+    }
 
     auto endTime = std::chrono::high_resolution_clock::now();
     double presentTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
 
-    {
-        std::lock_guard<std::mutex> lock(m_statsMutex);
-        m_stats.presentTimeMs = presentTimeMs;
+    m_stats.presentTimeMs = presentTimeMs;
+    RecordPresentGpuTimes();
+    m_stats.baseIntervalMs = m_pacer.GetBaseIntervalMs();
+    m_stats.refreshRateHz = m_pacer.GetRefreshRateHz();
+    const OSFG::PresenterStats& presenterStats = m_presenter->GetStats();
+    m_stats.displayLatencyMs = presenterStats.avgDisplayLatencyMs;
+    m_stats.glassLatencyRealMs = presenterStats.avgGlassLatencyRealMs;
+    m_stats.glassLatencyGeneratedMs = presenterStats.avgGlassLatencyGeneratedMs;
+    m_stats.glassLatencySamples = presenterStats.glassLatencySamples;
+    m_stats.variableRefresh = m_presenter->IsTearingEnabled();
+
+    m_lastPresentTime = endTime;
+
+    // Fails only after the frame's passes are queued and its set is tagged
+    return !staticTilesFailed;
+}
+
+bool DualGPUPipeline::PresentFidelityFX(ID3D12Resource* currentFrame, uint32_t generatedCount,
+                                        uint32_t generatedSet, uint64_t computeFenceValue,
+                                        uint64_t frameFenceValue) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    if (!currentFrame) {
+        return true;
+    }
+
+    // Same GPU-side ordering as the native present path
+    if (computeFenceValue > 0) {
+        m_presentQueue->Wait(m_computeFence.Get(), computeFenceValue);
+    }
+    if (frameFenceValue > 0) {
+        m_presentQueue->Wait(m_frameFence, frameFenceValue);
+    }
+
+    IDXGISwapChain4* swapChain = m_ffxFrameGen->GetSwapChain();
+    ComPtr<ID3D12Resource> backBuffer;
+    if (FAILED(swapChain->GetBuffer(swapChain->GetCurrentBackBufferIndex(), IID_PPV_ARGS(&backBuffer)))) {
+        ReportError("Failed to get FidelityFX back buffer");
+        return false;
+    }
+
+    ID3D12GraphicsCommandList* cmdList = m_presentRing.Begin();
+    if (!cmdList) {
+        ReportError("Failed to begin present copy: " + m_presentRing.GetLastError());
+        return false;
+    }
+
+    // One pass: the prepare dispatch and the copy into the back buffer
+    m_presentProfiler.BeginFrame();
+    m_presentProfiler.BeginScope(cmdList, GpuStage::Present);
+
+    // The prepare pass consumes this frame's field snapshot (COMMON) before
+    // the list retires; without one (first frame, frame generation off) the
+    // swap chain presents the real frame alone
+    OSFG::FFXFrameGenInputs inputs;
+    inputs.motionVectors = generatedCount > 0 ? m_presentMotion[generatedSet].Get() : nullptr;
+    inputs.motionVectorState = D3D12_RESOURCE_STATE_COMMON;
+    inputs.frameTimeDeltaMs = static_cast<float>(m_pacer.GetBaseIntervalMs());
+    if (!m_ffxFrameGen->DispatchPrepare(inputs, cmdList)) {
+        ReportError("FidelityFX prepare failed: " + m_ffxFrameGen->GetLastError());
+    }
+
+    // The real frame goes into the swap chain's back buffer; FFX
+    // interpolates between consecutive back buffers
+    D3D12_RESOURCE_BARRIER barriers[2] = {};
+    barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[0].Transition.pResource = currentFrame;
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+    barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barriers[1].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barriers[1].Transition.pResource = backBuffer.Get();
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    barriers[1].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    barriers[1].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    cmdList->ResourceBarrier(2, barriers);
+
+    cmdList->CopyResource(backBuffer.Get(), currentFrame);
+
+    for (D3D12_RESOURCE_BARRIER& barrier : barriers) {
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+    }
+    cmdList->ResourceBarrier(2, barriers);
+    m_presentProfiler.EndScope(cmdList);
+
+    m_presentFenceValue++;
+    m_presentProfiler.EndFrame(cmdList, m_presentFence.Get(), m_presentFenceValue);
+    if (!m_presentRing.Submit(m_presentQueue.Get(), m_presentFence.Get(), m_presentFenceValue)) {
+        ReportError("Failed to submit present copy: " + m_presentRing.GetLastError());
+        return false;
+    }
+
+    // No CPU pacing: the swap chain's pacer spaces the generated frame and
+    // this one over the frame interval
+    const bool generating = inputs.motionVectors != nullptr;
+    LARGE_INTEGER presentStart;
+    LARGE_INTEGER presentEnd;
+    QueryPerformanceCounter(&presentStart);
+    m_presentCallCount = 0;
+    if (!m_ffxFrameGen->Present(m_vsync ? 1 : 0, 0)) {
+        ReportError("FidelityFX present failed: " + m_ffxFrameGen->GetLastError());
+        return false;
+    }
+    QueryPerformanceCounter(&presentEnd);
+    RecordPresentCall(presentStart.QuadPart, presentEnd.QuadPart);
+
+    if (generatedCount > 0) {
+        m_generatedRetireValues[generatedSet] = m_presentFenceValue;
     }
 
+    auto endTime = std::chrono::high_resolution_clock::now();
+    double presentTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+    m_stats.framesPresented += generating ? 2 : 1;
+    m_stats.presentTimeMs = presentTimeMs;
+    RecordPresentGpuTimes();
+    m_stats.baseIntervalMs = m_pacer.GetBaseIntervalMs();
+
     m_lastPresentTime = endTime;
 
     return true;
 }
 
-void DualGPUPipeline::WaitForFramePacing(int frameIndex, int totalFrames) {
-    if (!m_config.vsync) {
-        return;  // No pacing needed without vsync
+void DualGPUPipeline::RecordPresentGpuTimes() {
+    if (!m_presentProfiler.Collect()) {
+        return;
+    }
+
+    const GpuFrameTimes& times = m_presentProfiler.GetLastFrame();
+    m_stats.gpuPresentMs = times.StageMs(GpuStage::Present);
+    for (uint32_t i = 0; i < _countof(m_stats.gpuPresentPassMs); i++) {
+        m_stats.gpuPresentPassMs[i] = times.ScopeMs(GpuStage::Present, i);
     }
+    m_stats.presentQueueBubbleMs = times.bubbleMs;
+}
 
-    // Calculate target time for this frame within the base frame period
-    double baseFrameTimeMs = 16.667;  // Assume 60fps base
-    double targetOffsetMs = (baseFrameTimeMs / totalFrames) * frameIndex;
+void DualGPUPipeline::RecordPresentCall(int64_t startQpc, int64_t endQpc) {
+    if (m_presentCallCount < FrameRecord::MAX_PRESENTS) {
+        m_presentCallQpc[m_presentCallCount] = startQpc;
+        m_presentCallMs[m_presentCallCount] = static_cast<float>(static_cast<double>(endQpc - startQpc) * m_qpcToMs);
+        m_presentCallCount++;
+    }
+}
 
-    auto targetTime = m_frameStartTime + std::chrono::microseconds(
-        static_cast<int64_t>(targetOffsetMs * 1000));
+void DualGPUPipeline::RecordFrame(uint64_t frameNumber, const FrameCaptureInfo& capture, uint32_t generatedCount) {
+    if (!m_frameRecorder.IsInitialized() || m_presentCallCount == 0) {
+        return;
+    }
 
-    auto now = std::chrono::high_resolution_clock::now();
-    if (now < targetTime) {
-        auto waitTime = std::chrono::duration_cast<std::chrono::microseconds>(targetTime - now);
-        if (waitTime.count() > 0 && waitTime.count() < 20000) {  // Max 20ms wait
-            std::this_thread::sleep_for(waitTime);
-        }
+    FrameRecord record;
+    record.frameNumber = frameNumber;
+    record.desktopPresentQpc = capture.desktopPresentQpc;
+    record.acquiredQpc = capture.acquiredQpc;
+    record.presentCount = m_presentCallCount;
+    for (uint32_t i = 0; i < m_presentCallCount; i++) {
+        record.presentQpc[i] = m_presentCallQpc[i];
+        record.presentApiMs[i] = m_presentCallMs[i];
+    }
+    record.syncInterval = m_vsync ? 1 : 0;
+    record.missedFrames = capture.missedFrames;
+
+    if (capture.missedFrames > 0) {
+        record.flags |= FRAME_RECORD_DROPPED;
+    }
+    if (m_frameGenEnabled && generatedCount == 0) {
+        record.flags |= FRAME_RECORD_DUPLICATED;
+    }
+    if (m_presenter && m_presenter->IsTearingEnabled()) {
+        record.flags |= FRAME_RECORD_TEARING;
+    }
+
+    // From the source's own present when the capture reports it
+    const int64_t originQpc = capture.desktopPresentQpc > 0 ? capture.desktopPresentQpc : capture.acquiredQpc;
+    record.latencyMs = static_cast<float>(
+        static_cast<double>(m_presentCallQpc[m_presentCallCount - 1] - originQpc) * m_qpcToMs);
+    record.captureLatencyMs = capture.captureLatencyMs;
+    record.captureMs = capture.captureMs;
+
+    // The other stages' latest published times (they run ahead of this frame)
+    const CaptureStageStats captureStats = m_captureStatsSnapshot.Load();
+    const ComputeStageStats computeStats = m_computeStatsSnapshot.Load();
+    record.transferMs = static_cast<float>(captureStats.transferTimeMs);
+    record.opticalFlowMs = static_cast<float>(computeStats.opticalFlowTimeMs);
+    record.interpolationMs = static_cast<float>(computeStats.interpolationTimeMs);
+    record.presentMs = static_cast<float>(m_stats.presentTimeMs);
+    record.gpuTransferMs = static_cast<float>(captureStats.gpuTransferSourceMs + captureStats.gpuTransferDestMs);
+    record.gpuPresentMs = static_cast<float>(m_stats.gpuPresentMs);
+
+    m_frameRecorder.Record(record);
+}
+
+bool DualGPUPipeline::WriteFrameRecords(const std::string& path) {
+    std::string presentMonPath = path;
+    if (presentMonPath.size() >= 4 && presentMonPath.compare(presentMonPath.size() - 4, 4, ".csv") == 0) {
+        presentMonPath.resize(presentMonPath.size() - 4);
     }
+    presentMonPath += "_presentmon.csv";
+
+    if (!m_frameRecorder.WriteCsv(path) ||
+        !m_frameRecorder.WritePresentMonCsv(presentMonPath, "OSFG")) {
+        ReportError("Failed to write frame records: " + m_frameRecorder.GetLastError());
+        return false;
+    }
+    return true;
+}
+
+void DualGPUPipeline::WaitForFramePacing(int frameIndex, int totalFrames) {
+    // Paced with and without vsync: generated frames should be evenly spaced
+    // between real ones either way
+    m_pacer.WaitUntil(m_pacer.GetPhaseTarget(m_frameStartTime, frameIndex, totalFrames));
 }
 
 void DualGPUPipeline::SetFrameGenEnabled(bool enabled) {
@@ -622,55 +2607,296 @@ void DualGPUPipeline::SetFrameGenEnabled(bool enabled) {
 }
 
 void DualGPUPipeline::SetFrameMultiplier(FrameMultiplier multiplier) {
-    m_config.multiplier = multiplier;
-    m_generatedFrameCount = static_cast<uint32_t>(multiplier) - 1;
-    m_targetFrameTimeMs = 16.667 / static_cast<int>(multiplier);
+    // Memory and quality steps in effect still apply to the new setting
+    m_requestedConfig.multiplier = multiplier;
+    m_configuredSettings.multiplier = multiplier;
+    ApplyMultiplier(GetReducedSettings().multiplier);
+}
+
+// Settings only Initialize() applies: devices, capture, transfer, window and
+// swap chain, backend selection and what is sized or opened once at start
+static bool RequiresReinitialize(const DualGPUConfig& a, const DualGPUConfig& b) {
+    const bool sameTitle = a.windowTitle == b.windowTitle ||
+        (a.windowTitle && b.windowTitle && wcscmp(a.windowTitle, b.windowTitle) == 0);
+    const bool sameTask = a.captureThreadTask == b.captureThreadTask ||
+        (a.captureThreadTask && b.captureThreadTask && wcscmp(a.captureThreadTask, b.captureThreadTask) == 0);
+
+    return a.primaryGPU != b.primaryGPU || a.secondaryGPU != b.secondaryGPU || a.singleGPU != b.singleGPU ||
+           a.backend != b.backend ||
+           a.captureMethod != b.captureMethod || a.captureMonitor != b.captureMonitor ||
+           a.captureTimeoutMs != b.captureTimeoutMs || !sameTask ||
+           a.captureWindow != b.captureWindow || a.captureCursor != b.captureCursor || a.hdr != b.hdr ||
+           a.variableRefresh != b.variableRefresh || a.swapChainBufferCount != b.swapChainBufferCount ||
+           a.borderlessWindow != b.borderlessWindow || !sameTitle || a.maxFrameLatency != b.maxFrameLatency ||
+           a.interpolateToBackBuffer != b.interpolateToBackBuffer ||
+           a.interpolationDownscale != b.interpolationDownscale ||
+           a.preferPeerToPeer != b.preferPeerToPeer || a.transferEncoding != b.transferEncoding ||
+           a.motionEstimator != b.motionEstimator || a.pipelineCache != b.pipelineCache ||
+           a.gpuProfiling != b.gpuProfiling || a.frameRecordCapacity != b.frameRecordCapacity ||
+           a.frameRecordTraceLogging != b.frameRecordTraceLogging || a.glassLatency != b.glassLatency ||
+           a.pipelinedMode != b.pipelinedMode || a.enableOverlay != b.enableOverlay;
+}
+
+static bool SameQualityConfig(const QualityControllerConfig& a, const QualityControllerConfig& b) {
+    return a.stepDownLoad == b.stepDownLoad && a.stepUpLoad == b.stepUpLoad &&
+           a.stepDownFrames == b.stepDownFrames && a.stepUpFrames == b.stepUpFrames &&
+           a.maxStepUpFrames == b.maxStepUpFrames && a.settleFrames == b.settleFrames &&
+           a.smoothing == b.smoothing;
+}
+
+bool DualGPUPipeline::Reconfigure(const DualGPUConfig& config) {
+    if (!m_initialized) {
+        SetError("Pipeline not initialized");
+        return false;
+    }
+    // Refused before anything is torn down, as Initialize() would
+    if (m_sharedContext && !config.pipelinedMode) {
+        SetError("A shared GPU context requires pipelinedMode");
+        return false;
+    }
+
+    // Vsync off tears only on a swap chain created for it, and the
+    // FidelityFX swap chain takes vsync at creation
+    const bool vsyncChanged = config.vsync != m_requestedConfig.vsync;
+    const bool vsyncNeedsSwapChain = vsyncChanged &&
+        (m_ffxFrameGen || (!config.vsync && !config.variableRefresh && !m_presenter->IsTearingEnabled()));
+
+    if (vsyncNeedsSwapChain || RequiresReinitialize(m_requestedConfig, config)) {
+        const bool wasRunning = m_running;
+        if (!Initialize(config, m_sharedContext)) {
+            return false;
+        }
+        return !wasRunning || Start();
+    }
+
+    m_requestedConfig = config;
+
+    // Applied from the next frame on
+    m_frameGenEnabled = config.enableFrameGen;
+    m_config.enableFrameGen = config.enableFrameGen;
+    if (vsyncChanged) {
+        m_config.vsync = config.vsync;
+        m_vsync = config.vsync;
+        m_presenter->SetVsync(config.vsync);
+        m_pacer.SetSnapToRefresh(config.vsync && !config.variableRefresh);
+    }
+    m_config.enableDebugOutput = config.enableDebugOutput;
+    m_config.frameRecordPath = config.frameRecordPath;
+
+    // Adaptation: turned off, the steps it took are undone with the rest below
+    m_config.adaptToMemoryBudget = config.adaptToMemoryBudget;
+    m_config.memoryBudgetFraction = config.memoryBudgetFraction;
+    if (!config.adaptToMemoryBudget && !m_memorySteps.empty()) {
+        m_memorySteps.clear();
+        m_memoryStepMeasured = true;
+        m_adaptationStats.vramDegradeLevel = 0;
+    }
+    m_config.adaptiveQuality = config.adaptiveQuality;
+    if (!SameQualityConfig(config.qualityController, m_config.qualityController)) {
+        m_config.qualityController = config.qualityController;
+        m_qualityController.Reset(config.qualityController);
+    }
+    if (!config.adaptiveQuality && !m_qualitySteps.empty()) {
+        m_qualitySteps.clear();
+        m_adaptationStats.qualityLevel = 0;
+    }
+    PublishAdaptationStats();
+
+    // What the steps still in effect reduce from
+    m_configuredSettings.transferBufferCount = m_config.pipelinedMode ?
+        (std::max)(config.transferBufferCount, 3u) : config.transferBufferCount;
+    m_configuredSettings.opticalFlowBlockSize = config.opticalFlowBlockSize;
+    m_configuredSettings.opticalFlowSearchRadius = config.opticalFlowSearchRadius;
+    m_configuredSettings.opticalFlowMotionField = config.opticalFlowMotionField;
+    m_configuredSettings.multiplier = config.multiplier;
+
+    // Flow settings no step reduces
+    const bool flowChanged = config.opticalFlowPyramidLevels != m_config.opticalFlowPyramidLevels ||
+                             config.opticalFlowTemporalPredictors != m_config.opticalFlowTemporalPredictors ||
+                             config.sceneChangeThreshold != m_config.sceneChangeThreshold ||
+                             config.opticalFlowDownscale != m_config.opticalFlowDownscale;
+    m_config.opticalFlowPyramidLevels = config.opticalFlowPyramidLevels;
+    m_config.opticalFlowTemporalPredictors = config.opticalFlowTemporalPredictors;
+    m_config.sceneChangeThreshold = config.sceneChangeThreshold;
+    m_config.opticalFlowDownscale = config.opticalFlowDownscale;
+
+    // Interpolation is created together with the flow, in a re-layout
+    const bool interpolationChanged = config.staticTileFrames != m_config.staticTileFrames;
+    m_config.staticTileFrames = config.staticTileFrames;
+
+    return ApplyReducedSettings(interpolationChanged, flowChanged || interpolationChanged);
+}
+
+PipelineStats DualGPUPipeline::GetStats() const {
+    PipelineStats stats = m_statsSnapshot.Load();
+
+    const CaptureStageStats capture = m_captureStatsSnapshot.Load();
+    stats.baseFamesCaptured = capture.baseFamesCaptured;
+    stats.unchangedFramesSkipped = capture.unchangedFramesSkipped;
+    stats.captureTimeMs = capture.captureTimeMs;
+    stats.captureLatencyMs = capture.captureLatencyMs;
+    stats.transferTimeMs = capture.transferTimeMs;
+    stats.gpuTransferSourceMs = capture.gpuTransferSourceMs;
+    stats.gpuTransferDestMs = capture.gpuTransferDestMs;
+    stats.copyQueueBubbleMs = capture.copyQueueBubbleMs;
+    stats.transferThroughputMBps = capture.transferThroughputMBps;
+    stats.usingPeerToPeer = capture.usingPeerToPeer;
+    stats.transferEncoded = capture.transferEncoded;
+    stats.stagedIngest = capture.stagedIngest;
+    stats.singleGPU = capture.singleGPU;
+    stats.captureThreadMmcss = capture.captureThreadMmcss;
+    stats.captureRecovering = capture.captureRecovering;
+    stats.captureRecoveries = capture.captureRecoveries;
+    stats.captureResizes = capture.captureResizes;
+
+    const ComputeStageStats compute = m_computeStatsSnapshot.Load();
+    stats.framesGenerated = compute.framesGenerated;
+    stats.opticalFlowTimeMs = compute.opticalFlowTimeMs;
+    stats.interpolationTimeMs = compute.interpolationTimeMs;
+    stats.computeQueueBubbleMs = compute.computeQueueBubbleMs;
+    stats.computeStartLatencyMs = compute.computeStartLatencyMs;
+
+    const AdaptationStats adaptation = m_adaptationStatsSnapshot.Load();
+    stats.vramBudgetBytes = adaptation.vramBudgetBytes;
+    stats.vramUsageBytes = adaptation.vramUsageBytes;
+    stats.vramDegradeLevel = adaptation.vramDegradeLevel;
+    stats.vramDegradations = adaptation.vramDegradations;
+    stats.gpuLoad = adaptation.gpuLoad;
+    stats.qualityLevel = adaptation.qualityLevel;
+    stats.qualityChanges = adaptation.qualityChanges;
+    stats.flowRebuilds = adaptation.flowRebuilds;
+
+    if (m_computeArena) {
+        const ResourceArenaStats arena = m_computeArena->GetStats();
+        stats.resourceHeapBytes = arena.heapBytes;
+        stats.resourceUsedBytes = arena.usedBytes;
+        stats.resourceAliasedBytes = arena.aliasedBytes;
+    }
+
+    return stats;
 }
 
 void DualGPUPipeline::ResetStats() {
-    std::lock_guard<std::mutex> lock(m_statsMutex);
-    m_stats = PipelineStats{};
-    m_stats.activeBackend = m_activeBackend;
+    // Only counted here: a stage clears its own working copy when it next
+    // publishes, so resetting never writes under a running stage
+    m_statsResets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void DualGPUPipeline::PublishCaptureStats() {
+    const uint64_t resets = m_statsResets.load(std::memory_order_relaxed);
+    if (resets != m_captureStatsResets) {
+        m_captureStatsResets = resets;
+        const bool captureThreadMmcss = m_captureStats.captureThreadMmcss;
+        m_captureStats = CaptureStageStats{};
+        m_captureStats.captureThreadMmcss = captureThreadMmcss;
+    }
+    m_captureStatsSnapshot.Publish(m_captureStats);
+}
+
+void DualGPUPipeline::PublishComputeStats() {
+    const uint64_t resets = m_statsResets.load(std::memory_order_relaxed);
+    if (resets != m_computeStatsResets) {
+        m_computeStatsResets = resets;
+        m_computeStats = ComputeStageStats{};
+    }
+    m_computeStatsSnapshot.Publish(m_computeStats);
+}
+
+void DualGPUPipeline::PublishPresentStats() {
+    const uint64_t resets = m_statsResets.load(std::memory_order_relaxed);
+    if (resets != m_presentStatsResets) {
+        m_presentStatsResets = resets;
+        m_stats = PipelineStats{};
+        m_stats.activeBackend = m_activeBackend;
+        m_stats.captureMethod = m_captureMethod;
+        m_stats.motionEstimator = m_motionEstimator;
+        m_stats.opticalFlowDownscale = m_flowDownscale;
+        m_stats.interpolationDownscale = m_interpolationDownscale;
+        m_stats.hdr = m_hdr;
+    }
+    m_statsSnapshot.Publish(m_stats);
 }
 
-void DualGPUPipeline::UpdateStats() {
-    std::lock_guard<std::mutex> lock(m_statsMutex);
+void DualGPUPipeline::PublishAdaptationStats() {
+    const uint64_t resets = m_statsResets.load(std::memory_order_relaxed);
+    if (resets != m_adaptationStatsResets) {
+        m_adaptationStatsResets = resets;
+        m_adaptationStats.vramDegradations = 0;
+        m_adaptationStats.qualityChanges = 0;
+        m_adaptationStats.flowRebuilds = 0;
+    }
+    m_adaptationStatsSnapshot.Publish(m_adaptationStats);
+}
 
+void DualGPUPipeline::UpdateStats(std::chrono::high_resolution_clock::time_point frameStartTime) {
     // Calculate total pipeline time
     auto now = std::chrono::high_resolution_clock::now();
     m_stats.totalPipelineTimeMs = std::chrono::duration<double, std::milli>(
-        now - m_frameStartTime).count();
+        now - frameStartTime).count();
+
+    // The frame interval is the time between completed frames: stages
+    // overlap in pipelined mode, and the serial loop also spends time
+    // waiting for the next capture outside a frame's own latency
+    double frameIntervalMs = std::chrono::duration<double, std::milli>(
+        now - m_lastFrameCompleteTime).count();
+    m_lastFrameCompleteTime = now;
 
     // Calculate FPS
-    if (m_stats.totalPipelineTimeMs > 0) {
-        m_stats.baseFPS = 1000.0 / m_stats.totalPipelineTimeMs;
-        m_stats.outputFPS = m_stats.baseFPS * static_cast<int>(m_config.multiplier);
+    if (frameIntervalMs > 0) {
+        // FidelityFX always generates one frame per real frame
+        const int multiplier = m_ffxFrameGen ? 2 : static_cast<int>(m_multiplier.load());
+        m_stats.baseFPS = 1000.0 / frameIntervalMs;
+        m_stats.outputFPS = m_stats.baseFPS * multiplier;
     }
+
+    PublishPresentStats();
 }
 
-HWND DualGPUPipeline::GetWindowHandle() const {
-    if (m_activeBackend == FrameGenBackend::FidelityFX && m_ffxFrameGen) {
-        // FFX manages its own swap chain, window handle comes from config
-        return nullptr;  // FFX doesn't expose window handle directly
+bool DualGPUPipeline::SetOverlayImage(const void* pixels, uint32_t width, uint32_t height,
+                                      uint32_t rowPitch, int32_t x, int32_t y) {
+    if (!m_overlay) {
+        return false;
+    }
+    return m_overlay->SetImage(pixels, width, height, rowPitch, x, y);
+}
+
+void DualGPUPipeline::SetOverlayVisible(bool visible) {
+    if (m_overlay) {
+        m_overlay->SetVisible(visible);
     }
+}
+
+HWND DualGPUPipeline::GetWindowHandle() const {
+    // The FidelityFX swap chain presents to the presenter's window too
     return m_presenter ? m_presenter->GetHWND() : nullptr;
 }
 
 bool DualGPUPipeline::IsWindowOpen() const {
-    if (m_activeBackend == FrameGenBackend::FidelityFX && m_ffxFrameGen) {
-        return m_ffxFrameGen->IsInitialized();
-    }
     return m_presenter ? m_presenter->IsWindowOpen() : false;
 }
 
+std::string DualGPUPipeline::GetLastError() const {
+    std::lock_guard<std::mutex> lock(m_errorMutex);
+    return m_lastError;
+}
+
 void DualGPUPipeline::SetError(const std::string& error) {
-    m_lastError = error;
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_lastError = error;
+    }
     ReportError(error);
 }
 
 void DualGPUPipeline::ReportError(const std::string& error) {
-    if (m_errorCallback) {
-        m_errorCallback(error);
+    // Called outside the lock: the callback may report or query in turn
+    ErrorCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        callback = m_errorCallback;
+    }
+    if (callback) {
+        callback(error);
     }
 
     if (m_config.enableDebugOutput) {
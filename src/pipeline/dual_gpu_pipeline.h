@@ -4,6 +4,8 @@
 // Orchestrates the complete frame generation pipeline across two GPUs:
 // GPU 0 (Primary): Frame capture
 // GPU 1 (Secondary): Optical flow, interpolation, presentation
+// In single-GPU mode every stage runs on the primary GPU and frames are read
+// in place from the capture's shared textures (no GPUTransfer).
 //
 // MIT License - Part of Open Source Frame Generation project
 
@@ -26,21 +28,40 @@
 #include <memory>
 #include <atomic>
 #include <thread>
-#include <mutex>
 #include <chrono>
 #include <functional>
+#include <mutex>
+#include <vector>
+
+#include "frame_queue.h"
+#include "frame_pacer.h"
+#include "capture/capture_method.h"
+#include "frame_recorder.h"
+#include "quality_controller.h"
+#include "stats_snapshot.h"
+#include "common/command_ring.h"
+#include "common/gpu_profiler.h"
+#include "common/pipeline_cache.h"
+#include "common/resource_arena.h"
+#include "common/video_memory_budget.h"
+#include "transfer/transfer_codec.h"
 
 // Forward declarations
 namespace osfg {
-    class DXGICapture;
+    class CaptureSource;
     struct CapturedFrame;
+    class SharedGPUContext;
+    class ComputeScheduler;
 }
 
 namespace OSFG {
     class D3D11D3D12Interop;
+    class MotionEstimator;
     class SimpleOpticalFlow;
     class FrameInterpolation;
     class SimplePresenter;
+    class OverlayCompositor;
+    class FrameUpscaler;
     class FFXFrameGeneration;
 }
 
@@ -58,10 +79,17 @@ enum class FrameMultiplier {
 // Frame generation backend
 enum class FrameGenBackend {
     Native,     // SimpleOpticalFlow + OSFG Interpolation (default, no dependencies)
-    FidelityFX, // AMD FidelityFX Frame Generation (higher quality, requires FFX DLLs)
+    FidelityFX, // AMD FidelityFX Frame Generation swap chain (requires FFX DLLs, always X2)
     Auto        // Automatically select best available backend
 };
 
+// Motion estimation of the native backend (interpolation is OSFG's either way)
+enum class MotionEstimatorBackend {
+    Simple,     // SimpleOpticalFlow block matching (default)
+    FidelityFX, // FSR 3 optical flow (build with OSFG_FFX_OPTICALFLOW)
+    Auto        // FidelityFX if built in, else Simple
+};
+
 // Pipeline statistics
 struct PipelineStats {
     // Frame counts
@@ -69,25 +97,85 @@ struct PipelineStats {
     uint64_t framesGenerated = 0;
     uint64_t framesPresented = 0;
     uint64_t framesDropped = 0;
+    uint64_t unchangedFramesSkipped = 0;  // Cursor-only captures: no transfer, flow or interpolation
 
     // Timing (milliseconds)
-    double captureTimeMs = 0.0;
-    double transferTimeMs = 0.0;
-    double opticalFlowTimeMs = 0.0;
-    double interpolationTimeMs = 0.0;
-    double presentTimeMs = 0.0;
+    double captureTimeMs = 0.0;       // Acquired frame to shared-target copy (excludes the wait)
+    double captureLatencyMs = 0.0;    // Desktop present (LastPresentTime) to acquisition
+    double transferTimeMs = 0.0;      // CPU submission of the transfer (includes staging waits)
+    double opticalFlowTimeMs = 0.0;   // GPU time
+    double interpolationTimeMs = 0.0; // GPU time of the compute-queue interpolation
+    double presentTimeMs = 0.0;       // CPU time of a base frame's presents (includes pacing waits)
     double totalPipelineTimeMs = 0.0;
 
+    // GPU timestamps per base frame (DualGPUConfig::gpuProfiling), read back
+    // a few frames late without CPU waits. A bubble is time a queue sat idle
+    // after its work was recorded: cross-queue and cross-GPU fence waits.
+    double gpuTransferSourceMs = 0.0;     // Primary GPU copy (shared texture / staging readback)
+    double gpuTransferDestMs = 0.0;       // Secondary GPU copy queue
+    double gpuPresentMs = 0.0;            // All present passes of a base frame
+    double gpuPresentPassMs[5] = {};      // Each present pass in order: generated phases, then the real frame
+    double copyQueueBubbleMs = 0.0;
+    double computeQueueBubbleMs = 0.0;
+    double presentQueueBubbleMs = 0.0;
+    double computeStartLatencyMs = 0.0;   // Compute frame recorded on the CPU to its first GPU work
+
     // Frame rates
     double baseFPS = 0.0;
     double outputFPS = 0.0;
 
+    // Pacing
+    double baseIntervalMs = 0.0;      // Measured capture cadence (LastPresentTime)
+    double refreshRateHz = 0.0;       // Output refresh rate (0 = unknown)
+    double displayLatencyMs = 0.0;    // Present() to scan-out (swap chain frame statistics)
+    bool variableRefresh = false;     // Tearing presents active (VRR mode or vsync off)
+
+    // Glass-to-glass latency (DualGPUConfig::glassLatency): source present
+    // (LastPresentTime) to the scan-out of the flip that showed it
+    double glassLatencyRealMs = 0.0;
+    double glassLatencyGeneratedMs = 0.0;  // Generated frames, from the newer real frame's present
+    uint64_t glassLatencySamples = 0;
+
     // Transfer stats
     double transferThroughputMBps = 0.0;
     bool usingPeerToPeer = false;
+    bool transferEncoded = false;     // Frames cross packed as YCbCr 4:2:0
+    bool stagedIngest = false;        // Captured frames reach the transfer through CPU memory (no shared targets)
+    bool singleGPU = false;           // No inter-GPU transfer (LocalFrameRing)
+
+    // Threads
+    bool captureThreadMmcss = false;  // Capture thread registered with MMCSS (pipelined mode)
+
+    // Capture recovery
+    bool captureRecovering = false;   // Capture lost (mode change, secure desktop), re-creating
+    uint64_t captureRecoveries = 0;   // Captures re-created in place
+    uint64_t captureResizes = 0;      // Size-dependent resources re-created for a new capture size
+
+    // Heap arena of the compute device (per-resolution textures)
+    uint64_t resourceHeapBytes = 0;       // Heap memory reserved
+    uint64_t resourceUsedBytes = 0;       // Placed resources (an alias group counts once)
+    uint64_t resourceAliasedBytes = 0;    // Saved by aliasing
+
+    // Video memory of the compute device against the OS budget
+    uint64_t vramBudgetBytes = 0;         // What the OS currently lets the process use
+    uint64_t vramUsageBytes = 0;          // What the process uses
+    uint32_t vramDegradeLevel = 0;        // Memory-saving steps in effect
+    uint64_t vramDegradations = 0;        // Steps taken since Initialize()
+
+    // Adaptive quality (DualGPUConfig::adaptiveQuality)
+    double gpuLoad = 0.0;                 // Smoothed secondary GPU time per base frame / base interval
+                                          // (reported whenever gpuProfiling is on)
+    uint32_t qualityLevel = 0;            // Quality steps in effect
+    uint64_t qualityChanges = 0;          // Steps down and up since Initialize()
+    uint64_t flowRebuilds = 0;            // Flows re-created in the background and swapped in
 
     // Backend info
     FrameGenBackend activeBackend = FrameGenBackend::Native;
+    CaptureMethod captureMethod = CaptureMethod::DXGIDesktopDup;
+    MotionEstimatorBackend motionEstimator = MotionEstimatorBackend::Simple;
+    uint32_t opticalFlowDownscale = 1;    // Frame pixels per matched luminance pixel
+    uint32_t interpolationDownscale = 1;  // Output pixels per generated frame pixel
+    bool hdr = false;                     // Frames run as HDR10 end to end (see DualGPUConfig::hdr)
 };
 
 // Pipeline configuration
@@ -95,6 +183,7 @@ struct DualGPUConfig {
     // GPU selection
     uint32_t primaryGPU = 0;        // Capture GPU (usually the gaming GPU)
     uint32_t secondaryGPU = 1;      // Frame generation GPU
+    bool singleGPU = false;         // Everything on primaryGPU (also implied by primaryGPU == secondaryGPU)
 
     // Resolution
     uint32_t width = 1920;
@@ -106,23 +195,115 @@ struct DualGPUConfig {
     FrameGenBackend backend = FrameGenBackend::Auto;  // Auto-select best backend
 
     // Capture settings
+    CaptureMethod captureMethod = CaptureMethod::Auto;
     uint32_t captureMonitor = 0;
-    uint32_t captureTimeoutMs = 0;  // 0 = non-blocking
+    // How long capture blocks waiting for a new desktop frame. Waiting in
+    // AcquireNextFrame instead of polling keeps the capture from spinning a
+    // core; the timeout bounds how long Stop() takes. 0 = poll.
+    uint32_t captureTimeoutMs = 16;
+    // MMCSS task the pipelined capture thread joins ("Capture", "Games", ...;
+    // nullptr = normal priority)
+    const wchar_t* captureThreadTask = L"Capture";
+    HWND captureWindow = nullptr;   // WGC: capture only this window (size fixed at Initialize)
+    bool captureCursor = true;      // WGC: draw the cursor into captured frames
+    // Capture an HDR monitor in FP16 and carry it as HDR10: BT.2020 PQ in
+    // R10G10B10A2 (4 bytes per pixel, like 8-bit frames) across the bus,
+    // through flow and interpolation, and out of an HDR10 swap chain. Only
+    // when the capture delivers FP16 (monitor in HDR mode); dual-GPU only,
+    // and it takes precedence over transferEncoding. See PipelineStats::hdr.
+    bool hdr = false;
 
     // Presentation
     bool vsync = true;
+    bool variableRefresh = false;   // VRR (G-Sync/FreeSync): tearing presents at interval 0, CPU-paced
+    uint32_t swapChainBufferCount = 2;
     bool borderlessWindow = true;
+    // Interpolate each phase in the present pass, straight into the back
+    // buffer (the real frame is blitted by the same pass), instead of
+    // writing generated frames on the compute queue and copying them
+    bool interpolateToBackBuffer = true;
+    // Interpolate the generated frames at 1/N of the output size (1 or 2)
+    // and upscale them into the back buffer in the present pass with an
+    // edge-aware filter. 2 takes the generated-frame path (overrides
+    // interpolateToBackBuffer); ignored by the FidelityFX backend.
+    uint32_t interpolationDownscale = 1;
+    // Copy 16x16 tiles that have stayed unchanged for this many base frames
+    // (HUDs, static UI) straight from the real frame instead of warping
+    // them (0 = off; ignored by the FidelityFX backend)
+    uint32_t staticTileFrames = 8;
+    uint32_t maxFrameLatency = 1;   // Queued presents before the present stage waits (waitable swap chain)
     const wchar_t* windowTitle = L"OSFG Dual-GPU Frame Generation";
 
     // Transfer settings
     bool preferPeerToPeer = true;
+    // YCbCr420 packs each frame on the primary GPU and unpacks it on the
+    // secondary (1.5 instead of 4 bytes per pixel over PCIe, slightly softer
+    // chroma, no dirty-region copies)
+    TransferEncoding transferEncoding = TransferEncoding::BGRA8;
     uint32_t transferBufferCount = 3;
 
     // Optical flow
+    // FidelityFX falls back to Simple when it is not built in or fails to
+    // initialize; the block size, search and field settings are Simple only
+    MotionEstimatorBackend motionEstimator = MotionEstimatorBackend::Simple;
     uint32_t opticalFlowBlockSize = 8;
     uint32_t opticalFlowSearchRadius = 12;
+    uint32_t opticalFlowPyramidLevels = 3;   // Coarse-to-fine levels (1 = single-level search)
+    bool opticalFlowTemporalPredictors = true;  // Seed the search from the previous frame's vectors
+    bool opticalFlowMotionField = true;         // Interpolate from the smoothed half-res field
+    float sceneChangeThreshold = 0.5f;          // Unmatched-block fraction that repeats frames (0 = off)
+    // Match 8x8 blocks on luminance reduced by 1, 2 or 4 in the luminance
+    // pre-pass. 0 = the largest factor that keeps at least 1080 lines (2 at
+    // 4K, 1 up to 1440p): 1080p-equivalent flow is enough to interpolate from.
+    uint32_t opticalFlowDownscale = 0;
+
+    // Keep compiled flow/interpolation PSOs in an on-disk pipeline library
+    // (%LOCALAPPDATA%\OSFG\PipelineCache, one file per adapter and driver)
+    bool pipelineCache = true;
+
+    // Timestamp every stage on every queue (PipelineStats gpu* and bubble
+    // fields). Copy queues without timestamp support report 0.
+    bool gpuProfiling = true;
+
+    // Per-frame records (FrameRecorder) for percentiles and CSV, PresentMon
+    // CSV and ETW export. frameRecordPath is written on Shutdown() if set.
+    uint32_t frameRecordCapacity = 4096;    // Base frames kept (0 = off)
+    bool frameRecordTraceLogging = true;    // Emit each record as an ETW event (provider "OSFG")
+    std::string frameRecordPath;            // <path> and <path without .csv>_presentmon.csv
+
+    // Tag each flip with its frame's capture LastPresentTime and match it to
+    // the swap chain's scan-out time (PipelineStats glassLatency fields).
+    // Back-buffer presents only; the FidelityFX swap chain reports 0.
+    bool glassLatency = true;
+
+    // Track the compute GPU's video memory budget (PipelineStats vram
+    // fields). With adaptToMemoryBudget, usage above memoryBudgetFraction of
+    // it steps down - transfer ring to its minimum, then 16x16 flow blocks
+    // without the dense field, then a lower multiplier - before the OS
+    // starts paging, and steps back up once the freed memory fits again.
+    bool adaptToMemoryBudget = true;
+    float memoryBudgetFraction = 0.95f;
+
+    // Closed-loop quality from the GPU timestamps (needs gpuProfiling). When
+    // the secondary GPU's time per base frame - flow, interpolation and the
+    // present passes - keeps overflowing the base interval (the multiplier's
+    // output frames share it), the search radius halves, then the flow
+    // switches to 16x16 blocks, then the multiplier drops; sustained
+    // headroom brings them back in reverse order. See QualityControllerConfig
+    // for the thresholds and hysteresis.
+    bool adaptiveQuality = true;
+    QualityControllerConfig qualityController;
+
+    // Threading
+    // When enabled, capture/transfer, compute and present run on dedicated
+    // threads connected by lock-free frame queues, so the base rate is bound
+    // by the slowest stage instead of the sum of all stages.
+    // Requires transferBufferCount >= 3.
+    bool pipelinedMode = false;
 
     // Advanced
+    // Blend the image handed to SetOverlayImage() into every back-buffer
+    // present (not composited on the FidelityFX swap chain)
     bool enableOverlay = true;
     bool enableDebugOutput = false;
 };
@@ -141,8 +322,26 @@ public:
     DualGPUPipeline(const DualGPUPipeline&) = delete;
     DualGPUPipeline& operator=(const DualGPUPipeline&) = delete;
 
-    // Initialize the pipeline
-    bool Initialize(const DualGPUConfig& config);
+    // Initialize the pipeline. Frame generation (flow, interpolation and
+    // their PSOs) is built on a worker thread while the window and swap
+    // chain are created on this one.
+    // sharedContext (dual-GPU only, same adapters): run on its devices,
+    // arenas and PSO cache, and hand compute work to its scheduler instead
+    // of owning a compute queue - one pipeline per captured output. It must
+    // outlive the pipeline.
+    bool Initialize(const DualGPUConfig& config, SharedGPUContext* sharedContext = nullptr);
+
+    // Adopt a new configuration, re-creating only what it changes (call
+    // from the ProcessFrame() thread, running or not):
+    // - multiplier, enableFrameGen, vsync and the adaptation settings apply
+    //   from the next frame, without stopping any stage
+    // - flow settings build a new flow in the background; the stages pause
+    //   only to swap it in
+    // - transferBufferCount and staticTileFrames re-lay out frame
+    //   generation (stages stopped, devices, window and PSOs kept)
+    // - anything else (GPUs, capture, transfer, window, swap chain, backend)
+    //   re-initializes the pipeline and restarts it if it was running
+    bool Reconfigure(const DualGPUConfig& config);
 
     // Shutdown and release all resources
     void Shutdown();
@@ -160,6 +359,9 @@ public:
     bool IsInitialized() const { return m_initialized; }
 
     // Process one frame (call this in a loop, or let the pipeline run autonomously)
+    // In pipelined mode the stage threads do the work; this only applies
+    // capture size changes and reports whether the pipeline is still running.
+    // Keep calling it from the thread that called Initialize().
     bool ProcessFrame();
 
     // Run the pipeline autonomously (blocks until Stop() is called)
@@ -169,26 +371,52 @@ public:
     void SetFrameGenEnabled(bool enabled);
     bool IsFrameGenEnabled() const { return m_frameGenEnabled; }
 
-    // Change frame multiplier at runtime
+    // Change frame multiplier at runtime. Generated frames for it are
+    // created before it takes effect, so no frame waits on an allocation.
     void SetFrameMultiplier(FrameMultiplier multiplier);
-    FrameMultiplier GetFrameMultiplier() const { return m_config.multiplier; }
+    FrameMultiplier GetFrameMultiplier() const { return m_multiplier.load(); }
 
     // Get active backend
     FrameGenBackend GetActiveBackend() const { return m_activeBackend; }
 
+    // Capture method in use (Auto resolved)
+    CaptureMethod GetCaptureMethod() const { return m_captureMethod; }
+
+    // Motion estimator in use (Auto and fallbacks resolved)
+    MotionEstimatorBackend GetMotionEstimator() const { return m_motionEstimator; }
+
     // Check if FidelityFX is available
     static bool IsFidelityFXAvailable();
 
-    // Get statistics
-    const PipelineStats& GetStats() const { return m_stats; }
+    // Latest statistics published by the stages (any thread, never blocks them)
+    PipelineStats GetStats() const;
+
+    // Clear the statistics; each stage applies it at its next publish
     void ResetStats();
 
-    // Get last error
-    const std::string& GetLastError() const { return m_lastError; }
+    // Per-frame records of the last frameRecordCapacity base frames (any thread)
+    const FrameRecorder& GetFrameRecorder() const { return m_frameRecorder; }
+
+    // Write the records as CSV to `path` and in PresentMon's layout next to it
+    bool WriteFrameRecords(const std::string& path);
+
+    // Get last error (a copy: any stage thread may set it meanwhile)
+    std::string GetLastError() const;
 
     // Set callbacks
     void SetFrameCallback(FrameCallback callback) { m_frameCallback = callback; }
-    void SetErrorCallback(ErrorCallback callback) { m_errorCallback = callback; }
+    void SetErrorCallback(ErrorCallback callback) {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_errorCallback = callback;
+    }
+
+    // Overlay image (premultiplied BGRA8, e.g. StatsOverlay's bitmap mode)
+    // drawn at (x, y) of every presented frame from the next present on.
+    // Any thread between Initialize() and Shutdown(); copied, never blocks
+    // the present stage. False if the overlay is off (see enableOverlay).
+    bool SetOverlayImage(const void* pixels, uint32_t width, uint32_t height, uint32_t rowPitch,
+                         int32_t x, int32_t y);
+    void SetOverlayVisible(bool visible);
 
     // Get window handle (for input handling)
     HWND GetWindowHandle() const;
@@ -200,73 +428,430 @@ private:
     // Initialization helpers
     bool InitializeCapture();
     bool InitializeTransfer();
+    bool InitializeLocalFrames();
     bool InitializeCompute();
+    bool InitializeFrameGeneration();   // Flow, interpolation, generated frames (size-dependent)
+    bool ResizeFrameGeneration();       // The same re-laid out in place (false: needs InitializeFrameGeneration)
+    bool InitializeSimpleOpticalFlow(PipelineCache* pipelineCache);
+    // SimpleOpticalFlow for config, touching no pipeline state (any thread)
+    bool CreateSimpleOpticalFlow(const DualGPUConfig& config, PipelineCache* pipelineCache,
+                                 std::unique_ptr<OSFG::SimpleOpticalFlow>& flow, std::string& error) const;
     bool InitializePresentation();
+    bool InitializeUpscaler();          // After frame generation: binds the generated frames
+    bool InitializeFidelityFXPresentation();    // Presenter window + FFX swap chain
+    bool CreateFidelityFXFrameGen();            // FFX swap chain and context (size-dependent)
+    bool ShareFrameRing();              // Open the ring's shared textures on the capture device
+    PipelineCache* GetPipelineCache();  // The shared context's or m_pipelineCache (nullptr = none)
+
+    // Capture size changed (duplication re-created at a new resolution):
+    // stop the stages, re-create size-dependent resources, restart
+    bool ApplyCaptureResize();
+
+    // Stop the stages, re-create what the current size, ring size and
+    // generated frame count need (the flow modules too if reinitializeFlow)
+    // and restart. captureResize: also adopt the pending capture size.
+    bool ApplyLayoutChange(bool captureResize, bool reinitializeFlow);
+
+    // Stop the stage threads (pipelined mode) and wait until the GPU is done
+    // with every queued frame; ResumeStages() restarts what PauseStages()
+    // stopped. Between the two this thread owns every stage's state.
+    bool PauseStages();
+    bool ResumeStages(bool restartStages);
+
+    // Background flow rebuild (Simple flow only): build a flow for the
+    // current m_config on a worker; ProcessFrame() swaps it in once ready
+    void RequestFlowRebuild();
+    bool ApplyPendingFlow();
+    bool CancelFlowRebuild();           // True if a build was pending
+
+    // Make multiplier current: generated frames first, then the setting
+    void ApplyMultiplier(FrameMultiplier multiplier);
+
+    // Settings the memory budget and the quality controller give up, on top
+    // of the configured ones (ProcessFrame() thread)
+    enum class Reduction : uint32_t {
+        TransferBuffers,    // Frame ring down to its minimum
+        SearchRadius,       // Flow search radius halved (down to 4)
+        FlowBlockSize,      // 16x16 flow blocks, no dense field
+        Multiplier,         // One multiplier lower (fewer generated frames)
+    };
+    struct FrameGenSettings {
+        uint32_t transferBufferCount = 3;
+        uint32_t opticalFlowBlockSize = 8;
+        uint32_t opticalFlowSearchRadius = 12;
+        bool opticalFlowMotionField = true;
+        FrameMultiplier multiplier = FrameMultiplier::X2;
+        bool operator==(const FrameGenSettings& other) const;
+    };
+
+    // The configured settings with every reduction in effect, plus extra
+    // (if not null)
+    FrameGenSettings GetReducedSettings(const Reduction* extra = nullptr) const;
+
+    // Adopt GetReducedSettings() into m_config, re-creating what changed:
+    // a new ring through ApplyLayoutChange(), a new multiplier or flow
+    // without stopping the stages. relayout: through ApplyLayoutChange() in
+    // any case (only that frees memory before re-allocating);
+    // rebuildFlow: flow settings outside FrameGenSettings changed too.
+    bool ApplyReducedSettings(bool relayout = false, bool rebuildFlow = false);
+
+    // Video memory budget: query it now and then and take or undo the
+    // memory-saving steps
+    bool UpdateMemoryBudget();
+    bool TakeMemoryStep(uint64_t usageBytes);
+    bool UndoMemoryStep();
+
+    // Quality controller: feed it the latest GPU timestamps and take or undo
+    // a quality step
+    bool UpdateQuality();
 
     // Pipeline stages
     bool CaptureFrame();
     bool TransferFrame();
-    bool ComputeOpticalFlow();
-    bool GenerateFrames();
-    bool PresentFrames();
-
-    // Frame pacing
+    // Compute work for one base frame (flow + every interpolated phase) is
+    // recorded between BeginComputeFrame() and SubmitComputeFrame() and goes
+    // out as a single submission
+    bool BeginComputeFrame();
+    bool ComputeOpticalFlow(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame);
+    bool GenerateFrames(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame,
+                        uint32_t& generatedCount);
+    // arrivalTime: when the base frame was captured; with a shared scheduler
+    // the work is due one base interval later
+    bool SubmitComputeFrame(uint64_t frameFenceValue, std::chrono::high_resolution_clock::time_point arrivalTime,
+                            uint64_t& fenceValue);
+    bool PresentFrames(ID3D12Resource* currentFrame, ID3D12Resource* previousFrame,
+                       uint32_t generatedCount, uint32_t generatedSet,
+                       uint64_t computeFenceValue, uint64_t frameFenceValue,
+                       int64_t sourcePresentQpc);
+    // FidelityFX: prepare pass + real frame into the FFX back buffer, one
+    // present; the swap chain's pacer inserts the generated frame
+    bool PresentFidelityFX(ID3D12Resource* currentFrame, uint32_t generatedCount,
+                           uint32_t generatedSet, uint64_t computeFenceValue,
+                           uint64_t frameFenceValue);
+    bool EnsureGeneratedFrames(uint32_t count);
+    void ReleaseArenaResources();       // Ranges of the generated frames and present inputs
+    // Back-buffer output: snapshot this frame's motion vectors and scene-cut
+    // predicate into the generated set for the present-queue draws
+    bool RecordPresentInputs(ID3D12Resource* motionVectors);
+
+    // Frame ring access, backed by GPUTransfer or (single-GPU) LocalFrameRing
+    uint32_t GetFrameBufferCount() const;
+    uint32_t GetFrameBufferIndex() const;
+    ID3D12Resource* GetFrameTexture(uint32_t bufferIndex) const;
+    void AdvanceFrameBuffer();
+
+    // Block until fence reaches value (no-op if already there)
+    void WaitForFence(ID3D12Fence* fence, HANDLE fenceEvent, uint64_t value);
+
+    // Pipelined mode stage threads
+    bool StartStageThreads();
+    void StopStageThreads();
+    void CaptureThreadProc();
+    void ComputeThreadProc();
+    void PresentThreadProc();
+
+    // Frame pacing: phase frameIndex of totalFrames, spread over the
+    // measured base interval from m_frameStartTime
     void WaitForFramePacing(int frameIndex, int totalFrames);
 
+    // Copy read-back present queue timestamps into m_stats (present stage thread)
+    void RecordPresentGpuTimes();
+
+    // Per-frame capture facts for the frame recorder, set by CaptureFrame()
+    struct FrameCaptureInfo {
+        int64_t desktopPresentQpc = 0;
+        int64_t acquiredQpc = 0;
+        uint32_t missedFrames = 0;      // Source presents folded into this frame
+        float captureMs = 0.0f;
+        float captureLatencyMs = 0.0f;
+    };
+
+    // Note one Present() call of the base frame being presented
+    void RecordPresentCall(int64_t startQpc, int64_t endQpc);
+
+    // Append the record of a presented base frame (present stage thread)
+    void RecordFrame(uint64_t frameNumber, const FrameCaptureInfo& capture, uint32_t generatedCount);
+
     // Error handling
     void SetError(const std::string& error);
     void ReportError(const std::string& error);
 
-    // Update statistics
-    void UpdateStats();
+    // Update the present stage's statistics and publish them
+    void UpdateStats(std::chrono::high_resolution_clock::time_point frameStartTime);
 
-    // Configuration
+    // Publish a stage's working statistics (its own thread, once per frame),
+    // first applying a pending ResetStats()
+    void PublishCaptureStats();
+    void PublishComputeStats();
+    void PublishPresentStats();
+    void PublishAdaptationStats();
+
+    // Configuration: m_config is what the pipeline runs with (resolved,
+    // reduced), m_requestedConfig what Initialize() or Reconfigure() was given
     DualGPUConfig m_config;
+    DualGPUConfig m_requestedConfig;
 
     // Pipeline components
-    std::unique_ptr<DXGICapture> m_capture;
+    std::unique_ptr<CaptureSource> m_capture;
+    CaptureMethod m_captureMethod = CaptureMethod::DXGIDesktopDup;
     std::unique_ptr<class GPUTransfer> m_transfer;
-
-    // Secondary GPU resources (for compute)
+    std::unique_ptr<class LocalFrameRing> m_localFrames;   // Single-GPU mode instead of m_transfer
+    bool m_singleGPU = false;
+    // The capture device could not open the transfer's shared ingest
+    // textures: frames are read back and uploaded instead
+    bool m_stagedIngest = false;
+
+    // Signalled when a ring frame is ready on the GPU (transfer copy, or the
+    // capture device's copy in single-GPU mode); m_frameFenceValue is the
+    // latest captured frame's value. Ring frames rest in COMMON in both modes.
+    ID3D12Fence* m_frameFence = nullptr;
+    uint64_t m_frameFenceValue = 0;
+    std::vector<RECT> m_changedRects;  // Scratch: dirty + move rects of the frame being captured
+
+    // Set by CaptureFrame() when frames arrive at a new size; applied by
+    // ProcessFrame() on the thread that owns the frame loop
+    std::atomic<bool> m_resizePending{false};
+    uint32_t m_resizeWidth = 0;
+    uint32_t m_resizeHeight = 0;
+
+    // Secondary GPU resources (for compute; the primary GPU in single-GPU mode)
     ComPtr<ID3D12Device> m_computeDevice;
-    ComPtr<ID3D12CommandQueue> m_computeQueue;
-    ComPtr<ID3D12CommandAllocator> m_computeAllocator;
-    ComPtr<ID3D12GraphicsCommandList> m_computeCommandList;
+    ComPtr<ID3D12CommandQueue> m_computeQueue;   // COMPUTE: optical flow and interpolation
+    // Shared across outputs (Initialize()); compute frames then go through
+    // the scheduler, and m_computeQueue is its queue
+    SharedGPUContext* m_sharedContext = nullptr;
+    ComputeScheduler* m_computeScheduler = nullptr;
+    ComPtr<ID3D12CommandQueue> m_presentQueue;   // DIRECT: present copies and flips
+
+    // Placed per-resolution resources of the compute device: the transfer's
+    // destination arena, or m_localArena in single-GPU mode. Flow,
+    // interpolation and the generated frames share it, so a resize re-places
+    // everything in the heaps it already holds.
+    ResourceArena m_localArena;
+    ResourceArena* m_computeArena = nullptr;
+
+    // Video memory budget of the compute device and the memory-saving steps
+    // in effect, last taken at the back (ProcessFrame() thread)
+    struct MemoryStepRecord {
+        Reduction step;
+        uint64_t usageBefore;       // Usage when the step was taken
+        uint64_t freedBytes;        // Measured at the next query
+    };
+    VideoMemoryBudget m_memoryBudget;
+    std::vector<MemoryStepRecord> m_memorySteps;
+    bool m_memoryStepMeasured = true;
+    std::chrono::steady_clock::time_point m_memoryQueryTime;
+    std::chrono::steady_clock::time_point m_memoryStepTime;
+    std::chrono::steady_clock::time_point m_overBudgetSince;
+    std::chrono::steady_clock::time_point m_underBudgetSince;
+    bool m_overBudget = false;
+    bool m_underBudget = false;
+
+    // Background flow rebuild: m_pendingFlow (or m_pendingFlowError) is
+    // written by the worker before m_flowBuildDone is set. Stale: the
+    // settings changed again while it was building.
+    std::thread m_flowBuildThread;
+    std::atomic<bool> m_flowBuildDone{false};
+    std::unique_ptr<OSFG::SimpleOpticalFlow> m_pendingFlow;
+    std::string m_pendingFlowError;
+    bool m_flowBuildStale = false;
+
+    // Settings as configured (SetFrameMultiplier() updates the multiplier),
+    // and the quality steps in effect, last taken at the back
+    FrameGenSettings m_configuredSettings;
+    QualityController m_qualityController;
+    std::vector<Reduction> m_qualitySteps;
+    uint64_t m_qualitySampledFrames = 0;    // ComputeStageStats::gpuTimedFrames last fed
+
+    // Compute command recording: one allocator per base frame in flight, so
+    // frame N+1 can be recorded while the GPU still executes frame N
+    static const uint32_t COMPUTE_FRAMES_IN_FLIGHT = 2;
+    CommandAllocatorRing m_computeRing;
+    ID3D12GraphicsCommandList* m_computeCommandList = nullptr;  // Open list between Begin/SubmitComputeFrame
+    GpuProfiler m_computeProfiler;      // Compute thread only
 
     // Compute components (on secondary GPU)
     // Native backend
-    std::unique_ptr<OSFG::SimpleOpticalFlow> m_opticalFlow;
+    PipelineCache m_pipelineCache;       // Outlives the modules whose PSOs it holds
+    std::unique_ptr<OSFG::MotionEstimator> m_opticalFlow;
     std::unique_ptr<OSFG::FrameInterpolation> m_interpolation;
     std::unique_ptr<OSFG::SimplePresenter> m_presenter;
-
-    // FidelityFX backend (alternative to Native)
+    std::unique_ptr<OSFG::OverlayCompositor> m_overlay;   // Present thread records, any thread sets
+    // interpolationDownscale > 1: draws the generated frames (slot
+    // set * MAX_GENERATED_FRAMES + phase) into the back buffer
+    std::unique_ptr<OSFG::FrameUpscaler> m_upscaler;
+
+    // FidelityFX backend (alternative to Native): owns the swap chain on
+    // m_presenter's window (created window-only) and reads the flow field
+    // snapshots in m_presentMotion; m_interpolation is unused
     std::unique_ptr<OSFG::FFXFrameGeneration> m_ffxFrameGen;
 
+    // Present command recording (separate from compute so the present
+    // thread never shares an allocator with the compute thread)
+    static const uint32_t PRESENT_ALLOCATOR_COUNT = 3;
+    CommandAllocatorRing m_presentRing;
+    GpuProfiler m_presentProfiler;      // Present thread only
+
     // Synchronization
+    // Compute timeline: signalled once per base frame submission
     ComPtr<ID3D12Fence> m_computeFence;
     HANDLE m_computeFenceEvent = nullptr;
     uint64_t m_computeFenceValue = 0;
 
-    // Frame buffers on secondary GPU
+    // Present timeline: signalled after every back-buffer copy
+    ComPtr<ID3D12Fence> m_presentFence;
+    HANDLE m_presentFenceEvent = nullptr;
+    uint64_t m_presentFenceValue = 0;
+
+    // Present fence value after which each transfer buffer is free (serial mode)
+    std::vector<uint64_t> m_bufferRetireValues;
+
+    // Pipelined mode
+    // A slot describes one base frame moving through the stage threads.
+    struct FrameSlot {
+        uint64_t frameNumber = 0;
+        uint32_t bufferIndex = 0;           // GPUTransfer ring slot of this frame
+        uint32_t previousBufferIndex = 0;   // Ring slot of the frame before it
+        bool hasPrevious = false;
+        uint32_t generatedCount = 0;        // Generated frames ready to present
+        uint32_t generatedSet = 0;          // m_generatedFrames set holding them
+        uint64_t computeFenceValue = 0;     // Compute timeline value producing them
+        uint64_t frameFenceValue = 0;       // m_frameFence value when the frame is ready
+        std::chrono::high_resolution_clock::time_point captureTime;
+        FrameCaptureInfo capture;
+    };
+
+    static const size_t STAGE_QUEUE_DEPTH = 4;
+    SPSCFrameQueue<FrameSlot, STAGE_QUEUE_DEPTH> m_transferQueue;  // capture -> compute
+    SPSCFrameQueue<FrameSlot, STAGE_QUEUE_DEPTH> m_presentSlotQueue;  // compute -> present
+
+    std::thread m_captureThread;
+    std::thread m_computeThread;
+    std::thread m_presentThread;
+
+    // Wake-up events for the consumer side of each queue, and for the two
+    // stages that wait on the present stage to retire frames
+    HANDLE m_transferReadyEvent = nullptr;
+    HANDLE m_computeReadyEvent = nullptr;
+    HANDLE m_captureSlotFreeEvent = nullptr;
+    HANDLE m_computeSlotFreeEvent = nullptr;
+
+    // Number of base frames fully presented (and whose GPU work retired)
+    std::atomic<uint64_t> m_retiredFrames{0};
+
+    // Number of base frames whose present copies have all been submitted
+    std::atomic<uint64_t> m_presentSubmittedFrames{0};
+
+    // Generated frames on secondary GPU: interpolation target for each phase
+    // t = (i+1)/multiplier of a compute frame, presented in order. Compute
+    // frames alternate between two sets, so interpolation of frame N runs
+    // while the present queue still copies frame N-1's set.
     static const uint32_t MAX_GENERATED_FRAMES = 4;
-    ComPtr<ID3D12Resource> m_generatedFrames[MAX_GENERATED_FRAMES];
-    uint32_t m_generatedFrameCount = 0;
+    static const uint32_t GENERATED_FRAME_SETS = 2;
+    ComPtr<ID3D12Resource> m_generatedFrames[GENERATED_FRAME_SETS][MAX_GENERATED_FRAMES];
+    uint64_t m_generatedRetireValues[GENERATED_FRAME_SETS] = {};  // Present fence value after a set's last copy
+    uint32_t m_generatedSet = 0;        // Set written by the compute frame being recorded
+    std::mutex m_generatedFramesMutex;  // EnsureGeneratedFrames() from the compute and ProcessFrame() threads
+
+    // Back-buffer output (config.interpolateToBackBuffer): no generated
+    // frames; instead each set holds a copy of its frame's motion vectors and
+    // scene-cut predicate, which the next compute frame would overwrite while
+    // the present queue still draws from them. Both rest in COMMON.
+    bool m_directOutput = false;
+    uint32_t m_interpolationDownscale = 1;  // Resolved config.interpolationDownscale
+    uint32_t m_flowDownscale = 1;           // Resolved config.opticalFlowDownscale the flow was created with
+    bool m_hdr = false;                     // Resolved config.hdr: frames are HDR10 from the transfer on
+    DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_B8G8R8A8_UNORM;  // Presenter's, known before it exists
+    ComPtr<ID3D12Resource> m_presentMotion[GENERATED_FRAME_SETS];
+    ComPtr<ID3D12Resource> m_presentPredicates[GENERATED_FRAME_SETS];
 
     // State
     bool m_initialized = false;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_frameGenEnabled{true};
+    std::atomic<bool> m_vsync{true};        // config.vsync, changeable by Reconfigure()
+    std::atomic<FrameMultiplier> m_multiplier{FrameMultiplier::X2};  // Read once per frame by the stages
     FrameGenBackend m_activeBackend = FrameGenBackend::Native;
+    MotionEstimatorBackend m_motionEstimator = MotionEstimatorBackend::Simple;
     std::string m_lastError;
-
-    // Statistics
-    PipelineStats m_stats;
-    std::mutex m_statsMutex;
+    mutable std::mutex m_errorMutex;        // m_lastError and m_errorCallback, set from several threads
+
+    // Statistics. Each stage writes only its own working copy, without
+    // locks, and publishes it once per frame; GetStats() merges the latest
+    // snapshots. m_stats holds the present stage's fields (and the backend
+    // info, set before any stage runs).
+    struct CaptureStageStats {
+        uint64_t baseFamesCaptured = 0;
+        uint64_t unchangedFramesSkipped = 0;
+        double captureTimeMs = 0.0;
+        double captureLatencyMs = 0.0;
+        double transferTimeMs = 0.0;
+        double gpuTransferSourceMs = 0.0;
+        double gpuTransferDestMs = 0.0;
+        double copyQueueBubbleMs = 0.0;
+        double transferThroughputMBps = 0.0;
+        bool usingPeerToPeer = false;
+        bool transferEncoded = false;
+        bool stagedIngest = false;
+        bool singleGPU = false;
+        bool captureThreadMmcss = false;
+        bool captureRecovering = false;
+        uint64_t captureRecoveries = 0;
+        uint64_t captureResizes = 0;
+    };
+
+    struct AdaptationStats {
+        uint64_t vramBudgetBytes = 0;
+        uint64_t vramUsageBytes = 0;
+        uint32_t vramDegradeLevel = 0;
+        uint64_t vramDegradations = 0;
+        double gpuLoad = 0.0;
+        uint32_t qualityLevel = 0;
+        uint64_t qualityChanges = 0;
+        uint64_t flowRebuilds = 0;
+    };
+
+    struct ComputeStageStats {
+        uint64_t framesGenerated = 0;
+        double opticalFlowTimeMs = 0.0;
+        double interpolationTimeMs = 0.0;
+        double computeQueueBubbleMs = 0.0;
+        double computeStartLatencyMs = 0.0;
+        uint64_t gpuTimedFrames = 0;     // Frames whose timestamps were read back
+    };
+
+    PipelineStats m_stats;               // Present stage thread
+    CaptureStageStats m_captureStats;    // Capture stage thread
+    ComputeStageStats m_computeStats;    // Compute stage thread
+    AdaptationStats m_adaptationStats;   // ProcessFrame() thread
+    StatsSnapshot<PipelineStats> m_statsSnapshot;
+    StatsSnapshot<CaptureStageStats> m_captureStatsSnapshot;
+    StatsSnapshot<ComputeStageStats> m_computeStatsSnapshot;
+    StatsSnapshot<AdaptationStats> m_adaptationStatsSnapshot;
+
+    // ResetStats() calls so far, and the count each stage has applied
+    std::atomic<uint64_t> m_statsResets{0};
+    uint64_t m_captureStatsResets = 0;
+    uint64_t m_computeStatsResets = 0;
+    uint64_t m_presentStatsResets = 0;
+    uint64_t m_adaptationStatsResets = 0;
+
+    // Frame records; the present calls of the base frame being presented
+    // (present stage thread)
+    FrameRecorder m_frameRecorder;
+    int64_t m_presentCallQpc[FrameRecord::MAX_PRESENTS] = {};
+    float m_presentCallMs[FrameRecord::MAX_PRESENTS] = {};
+    uint32_t m_presentCallCount = 0;
+    uint64_t m_serialFrameNumber = 0;    // Frame numbers when not pipelined
 
     // Timing
     std::chrono::high_resolution_clock::time_point m_frameStartTime;
+    std::chrono::high_resolution_clock::time_point m_frameArrivalTime;  // Last CaptureFrame() acquisition
+    double m_qpcToMs = 0.0;
+    FrameCaptureInfo m_frameCapture;     // Last CaptureFrame() (capture stage thread)
     std::chrono::high_resolution_clock::time_point m_lastPresentTime;
-    double m_targetFrameTimeMs = 8.333;  // 120 fps default
+    std::chrono::high_resolution_clock::time_point m_lastFrameCompleteTime;
+    FramePacer m_pacer;                  // Fed by capture, waited on by present
 
     // Callbacks
     FrameCallback m_frameCallback;
@@ -0,0 +1,129 @@
+// OSFG - Open Source Frame Generation
+// Frame Pacer Implementation
+
+#include "frame_pacer.h"
+
+#include <cmath>
+
+// Windows 10 1803+; older systems fall back to a regular waitable timer
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace osfg {
+
+// Spin for the remainder once the timer has slept us this close to the target
+static const double SPIN_MS_HIGH_RESOLUTION = 0.25;
+static const double SPIN_MS_DEFAULT = 1.5;
+
+FramePacer::~FramePacer() {
+    Shutdown();
+}
+
+bool FramePacer::Initialize(const FramePacerConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    m_config = config;
+    m_snapToRefresh.store(config.snapToRefresh, std::memory_order_relaxed);
+
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                     TIMER_ALL_ACCESS);
+    m_highResolutionTimer = m_timer != nullptr;
+    if (!m_timer) {
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+    if (!m_timer) {
+        m_lastError = "Failed to create waitable timer";
+        return false;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_ticksToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+
+    m_lastPresentQpc = 0;
+    m_measured = false;
+    m_baseIntervalMs.store(m_config.defaultIntervalMs, std::memory_order_relaxed);
+
+    m_initialized = true;
+    return true;
+}
+
+void FramePacer::Shutdown() {
+    if (m_timer) {
+        CloseHandle(m_timer);
+        m_timer = nullptr;
+    }
+    m_highResolutionTimer = false;
+    m_initialized = false;
+}
+
+void FramePacer::OnFramePresented(int64_t presentQpc) {
+    if (presentQpc == 0) {
+        return;
+    }
+
+    const int64_t lastQpc = m_lastPresentQpc;
+    m_lastPresentQpc = presentQpc;
+    if (lastQpc == 0 || presentQpc <= lastQpc) {
+        return;
+    }
+
+    const double intervalMs = static_cast<double>(presentQpc - lastQpc) * m_ticksToMs;
+    const double currentMs = m_baseIntervalMs.load(std::memory_order_relaxed);
+    if (intervalMs > MAX_INTERVAL_MS || (m_measured && intervalMs > currentMs * GAP_FACTOR)) {
+        return;
+    }
+
+    // First real sample replaces the default outright
+    const double alpha = 0.1;
+    const double updatedMs = m_measured ? currentMs * (1.0 - alpha) + intervalMs * alpha : intervalMs;
+    m_measured = true;
+    m_baseIntervalMs.store(updatedMs, std::memory_order_relaxed);
+}
+
+FramePacer::Clock::time_point FramePacer::GetPhaseTarget(Clock::time_point baseStart,
+                                                         int frameIndex, int totalFrames) const {
+    if (totalFrames <= 0 || frameIndex <= 0) {
+        return baseStart;
+    }
+
+    double offsetMs = GetBaseIntervalMs() * frameIndex / totalFrames;
+
+    // Round to whole refresh periods, unless the output rate is above the
+    // refresh rate and rounding would stack phases on the same vblank
+    if (m_snapToRefresh.load(std::memory_order_relaxed) && m_config.refreshRateHz > 0.0) {
+        const double periodMs = 1000.0 / m_config.refreshRateHz;
+        if (GetBaseIntervalMs() / totalFrames >= periodMs) {
+            offsetMs = std::round(offsetMs / periodMs) * periodMs;
+        }
+    }
+
+    return baseStart + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(offsetMs));
+}
+
+void FramePacer::WaitUntil(Clock::time_point target) {
+    double remainingMs = std::chrono::duration<double, std::milli>(target - Clock::now()).count();
+    if (remainingMs <= 0.0 || remainingMs > MAX_INTERVAL_MS) {
+        return;
+    }
+
+    // Sleep on the timer for the bulk of the wait (relative due time, 100 ns units)
+    const double spinMs = m_highResolutionTimer ? SPIN_MS_HIGH_RESOLUTION : SPIN_MS_DEFAULT;
+    if (m_timer && remainingMs > spinMs) {
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -static_cast<LONGLONG>((remainingMs - spinMs) * 10000.0);
+        if (SetWaitableTimerEx(m_timer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+            WaitForSingleObject(m_timer, INFINITE);
+        }
+    }
+
+    while (Clock::now() < target) {
+        YieldProcessor();
+    }
+}
+
+} // namespace osfg
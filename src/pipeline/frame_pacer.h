@@ -0,0 +1,108 @@
+// OSFG - Open Source Frame Generation
+// Frame Pacer
+//
+// Spreads the presents of one base frame evenly over the measured capture
+// cadence. The base interval is taken from the desktop's own present
+// timestamps (DXGI_OUTDUPL_FRAME_INFO::LastPresentTime), so 48 fps content
+// or a 165 Hz panel is paced from what actually happens instead of an
+// assumed 60 Hz. With vsync, phase targets are rounded to whole refresh
+// periods so each present lands on its own vblank. Waits sleep on a
+// high-resolution waitable timer and spin only for the last fraction of a
+// millisecond.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+
+// Configuration for the frame pacer
+struct FramePacerConfig {
+    double refreshRateHz = 0.0;         // Output refresh rate (0 = unknown)
+    bool snapToRefresh = true;          // Round phase targets to refresh periods (vsync)
+    double defaultIntervalMs = 16.667;  // Base interval until the cadence is measured
+};
+
+class FramePacer {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+    FramePacer() = default;
+    ~FramePacer();
+
+    // Non-copyable
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Create the waitable timer (high resolution where the OS supports it)
+    bool Initialize(const FramePacerConfig& config);
+
+    // Release the timer
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Record a captured frame's LastPresentTime (QPC ticks). Call from one
+    // thread only; pointer-only updates (0) are ignored. Gaps much longer
+    // than the current estimate (idle desktop, dropped frames) are skipped.
+    void OnFramePresented(int64_t presentQpc);
+
+    // Measured interval between real frames (config default until known).
+    // Safe to call from any thread.
+    double GetBaseIntervalMs() const { return m_baseIntervalMs.load(std::memory_order_relaxed); }
+
+    double GetRefreshRateHz() const { return m_config.refreshRateHz; }
+
+    // Turn rounding to refresh periods on or off (vsync toggled at run
+    // time). Safe to call from any thread.
+    void SetSnapToRefresh(bool snap) { m_snapToRefresh.store(snap, std::memory_order_relaxed); }
+    bool IsHighResolutionTimer() const { return m_highResolutionTimer; }
+
+    // Present time of phase frameIndex of totalFrames for the base frame
+    // whose first present is due at baseStart
+    Clock::time_point GetPhaseTarget(Clock::time_point baseStart, int frameIndex, int totalFrames) const;
+
+    // Block until target (returns at once if it has passed)
+    void WaitUntil(Clock::time_point target);
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // Samples more than this many times the estimate are gaps, not cadence
+    static constexpr double GAP_FACTOR = 2.5;
+    // Below ~10 fps there is nothing worth pacing
+    static constexpr double MAX_INTERVAL_MS = 100.0;
+
+    HANDLE m_timer = nullptr;
+    bool m_highResolutionTimer = false;
+
+    FramePacerConfig m_config;
+    double m_ticksToMs = 0.0;
+
+    // Capture-thread state
+    int64_t m_lastPresentQpc = 0;
+    bool m_measured = false;
+
+    std::atomic<double> m_baseIntervalMs{16.667};
+    std::atomic<bool> m_snapToRefresh{true};
+
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
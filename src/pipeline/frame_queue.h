@@ -0,0 +1,75 @@
+// OSFG - Open Source Frame Generation
+// Lock-Free Frame Queue
+//
+// Bounded single-producer/single-consumer ring used to hand frame slots
+// between pipeline stage threads. One thread may push and one (other)
+// thread may pop; neither side ever takes a lock.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace osfg {
+
+template <typename T, size_t Capacity>
+class SPSCFrameQueue {
+    static_assert(Capacity >= 2, "SPSCFrameQueue needs at least two slots");
+    static_assert((Capacity & (Capacity - 1)) == 0, "SPSCFrameQueue capacity must be a power of two");
+
+public:
+    SPSCFrameQueue() = default;
+
+    // Non-copyable
+    SPSCFrameQueue(const SPSCFrameQueue&) = delete;
+    SPSCFrameQueue& operator=(const SPSCFrameQueue&) = delete;
+
+    // Producer side. Returns false if the queue is full.
+    bool TryPush(const T& item) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool TryPop(T& item) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = m_slots[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued items (exact when called from either end)
+    size_t Size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const { return Size() == 0; }
+
+    // Drop all queued items. Only safe while neither end is active.
+    void Clear() {
+        m_head.store(m_tail.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    // Producer and consumer indices live on separate cache lines so the two
+    // threads don't false-share.
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::array<T, Capacity> m_slots{};
+};
+
+} // namespace osfg
@@ -0,0 +1,299 @@
+// OSFG - Open Source Frame Generation
+// Frame Recorder Implementation
+
+#include "frame_recorder.h"
+
+#include <TraceLoggingProvider.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+
+#pragma comment(lib, "advapi32.lib")
+
+// Provider "OSFG"; the GUID is the EventSource name hash, so `wpr -start`
+// profiles and tracelog can also enable it as *OSFG
+TRACELOGGING_DEFINE_PROVIDER(g_osfgTraceProvider, "OSFG",
+    (0x305aa981, 0xf169, 0x5428, 0x99, 0xf0, 0xcb, 0x99, 0x07, 0x93, 0x15, 0x2a));
+
+namespace osfg {
+
+// The provider handle is process-wide; recorders share one registration
+static std::mutex s_providerMutex;
+static uint32_t s_providerUsers = 0;
+
+static void AcquireTraceProvider() {
+    std::lock_guard<std::mutex> lock(s_providerMutex);
+    if (s_providerUsers++ == 0) {
+        TraceLoggingRegister(g_osfgTraceProvider);
+    }
+}
+
+static void ReleaseTraceProvider() {
+    std::lock_guard<std::mutex> lock(s_providerMutex);
+    if (s_providerUsers > 0 && --s_providerUsers == 0) {
+        TraceLoggingUnregister(g_osfgTraceProvider);
+    }
+}
+
+static FramePercentiles ComputePercentiles(std::vector<double>& values) {
+    FramePercentiles result;
+    if (values.empty()) {
+        return result;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto rank = [&](double p) {
+        const size_t index = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[(std::min)(index > 0 ? index - 1 : 0, values.size() - 1)];
+    };
+    result.p50 = rank(0.50);
+    result.p90 = rank(0.90);
+    result.p99 = rank(0.99);
+    result.p999 = rank(0.999);
+    result.max = values.back();
+    return result;
+}
+
+FrameRecorder::~FrameRecorder() {
+    Shutdown();
+}
+
+bool FrameRecorder::Initialize(const FrameRecorderConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (config.capacity == 0) {
+        m_lastError = "Frame recorder capacity must be non-zero";
+        return false;
+    }
+
+    m_entries.reset(new Entry[config.capacity]);
+    m_capacity = config.capacity;
+    m_written.store(0, std::memory_order_relaxed);
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_qpcToMs = 1000.0 / static_cast<double>(frequency.QuadPart);
+
+    m_traceLogging = config.traceLogging;
+    if (m_traceLogging) {
+        AcquireTraceProvider();
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void FrameRecorder::Shutdown() {
+    if (m_traceLogging) {
+        ReleaseTraceProvider();
+        m_traceLogging = false;
+    }
+
+    m_entries.reset();
+    m_capacity = 0;
+    m_written.store(0, std::memory_order_relaxed);
+    m_initialized = false;
+}
+
+void FrameRecorder::Record(const FrameRecord& record) {
+    if (!m_initialized) {
+        return;
+    }
+
+    // Seqlock write: readers discard an entry whose sequence changed under them
+    const uint64_t n = m_written.load(std::memory_order_relaxed);
+    Entry& entry = m_entries[n % m_capacity];
+    entry.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.record = record;
+    entry.sequence.store(2 * (n + 1), std::memory_order_release);
+    m_written.store(n + 1, std::memory_order_release);
+
+    if (m_traceLogging) {
+        TraceLoggingWrite(g_osfgTraceProvider, "Frame",
+            TraceLoggingUInt64(record.frameNumber, "FrameNumber"),
+            TraceLoggingInt64(record.desktopPresentQpc, "DesktopPresentQpc"),
+            TraceLoggingInt64(record.acquiredQpc, "AcquiredQpc"),
+            TraceLoggingInt64(record.presentCount > 0 ? record.presentQpc[record.presentCount - 1] : 0,
+                              "LastPresentQpc"),
+            TraceLoggingUInt32(record.presentCount, "Presents"),
+            TraceLoggingUInt32(record.missedFrames, "MissedFrames"),
+            TraceLoggingUInt32(record.flags, "Flags"),
+            TraceLoggingFloat32(record.latencyMs, "LatencyMs"),
+            TraceLoggingFloat32(record.captureMs, "CaptureMs"),
+            TraceLoggingFloat32(record.transferMs, "TransferMs"),
+            TraceLoggingFloat32(record.opticalFlowMs, "OpticalFlowMs"),
+            TraceLoggingFloat32(record.interpolationMs, "InterpolationMs"),
+            TraceLoggingFloat32(record.presentMs, "PresentMs"));
+    }
+}
+
+void FrameRecorder::Snapshot(std::vector<FrameRecord>& records) const {
+    records.clear();
+    if (!m_initialized) {
+        return;
+    }
+
+    const uint64_t written = m_written.load(std::memory_order_acquire);
+    const uint64_t first = written > m_capacity ? written - m_capacity : 0;
+    records.reserve(static_cast<size_t>(written - first));
+
+    for (uint64_t n = first; n < written; n++) {
+        const Entry& entry = m_entries[n % m_capacity];
+        const uint64_t before = entry.sequence.load(std::memory_order_acquire);
+        if (before != 2 * (n + 1)) {
+            continue;  // Already overwritten by a newer record
+        }
+        FrameRecord copy = entry.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.sequence.load(std::memory_order_relaxed) == before) {
+            records.push_back(copy);
+        }
+    }
+}
+
+FrameRecordSummary FrameRecorder::GetSummary() const {
+    std::vector<FrameRecord> records;
+    Snapshot(records);
+
+    FrameRecordSummary summary;
+    summary.frames = records.size();
+
+    std::vector<double> latency;
+    std::vector<double> frameTime;
+    std::vector<double> presentTime;
+    latency.reserve(records.size());
+
+    int64_t previousFrameQpc = 0;
+    int64_t previousPresentQpc = 0;
+    for (const FrameRecord& record : records) {
+        summary.droppedFrames += record.missedFrames;
+        if (record.flags & FRAME_RECORD_DUPLICATED) {
+            summary.duplicatedFrames++;
+        }
+        latency.push_back(record.latencyMs);
+
+        for (uint32_t i = 0; i < record.presentCount; i++) {
+            if (previousPresentQpc != 0) {
+                presentTime.push_back(static_cast<double>(record.presentQpc[i] - previousPresentQpc) * m_qpcToMs);
+            }
+            previousPresentQpc = record.presentQpc[i];
+        }
+        if (record.presentCount > 0) {
+            const int64_t lastQpc = record.presentQpc[record.presentCount - 1];
+            if (previousFrameQpc != 0) {
+                frameTime.push_back(static_cast<double>(lastQpc - previousFrameQpc) * m_qpcToMs);
+            }
+            previousFrameQpc = lastQpc;
+        }
+    }
+
+    summary.latencyMs = ComputePercentiles(latency);
+    summary.frameTimeMs = ComputePercentiles(frameTime);
+    summary.presentTimeMs = ComputePercentiles(presentTime);
+    return summary;
+}
+
+bool FrameRecorder::WriteCsv(const std::string& path) const {
+    std::vector<FrameRecord> records;
+    Snapshot(records);
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        m_lastError = "Failed to create " + path;
+        return false;
+    }
+
+    file << "FrameNumber,TimeInSeconds,LatencyMs,CaptureLatencyMs,FrameTimeMs,Presents,MissedFrames,"
+            "Dropped,Duplicated,CaptureMs,TransferMs,OpticalFlowMs,InterpolationMs,PresentMs,"
+            "GpuTransferMs,GpuPresentMs\n";
+
+    const int64_t originQpc = records.empty() ? 0 : records.front().acquiredQpc;
+    int64_t previousFrameQpc = 0;
+    for (const FrameRecord& record : records) {
+        const int64_t lastQpc = record.presentCount > 0 ? record.presentQpc[record.presentCount - 1] : 0;
+        const double frameTimeMs = previousFrameQpc != 0 && lastQpc != 0
+            ? static_cast<double>(lastQpc - previousFrameQpc) * m_qpcToMs : 0.0;
+        if (lastQpc != 0) {
+            previousFrameQpc = lastQpc;
+        }
+
+        file << record.frameNumber << ','
+             << static_cast<double>(record.acquiredQpc - originQpc) * m_qpcToMs / 1000.0 << ','
+             << record.latencyMs << ','
+             << record.captureLatencyMs << ','
+             << frameTimeMs << ','
+             << record.presentCount << ','
+             << record.missedFrames << ','
+             << ((record.flags & FRAME_RECORD_DROPPED) ? 1 : 0) << ','
+             << ((record.flags & FRAME_RECORD_DUPLICATED) ? 1 : 0) << ','
+             << record.captureMs << ','
+             << record.transferMs << ','
+             << record.opticalFlowMs << ','
+             << record.interpolationMs << ','
+             << record.presentMs << ','
+             << record.gpuTransferMs << ','
+             << record.gpuPresentMs << '\n';
+    }
+
+    if (!file.good()) {
+        m_lastError = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool FrameRecorder::WritePresentMonCsv(const std::string& path, const std::string& application) const {
+    std::vector<FrameRecord> records;
+    Snapshot(records);
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        m_lastError = "Failed to create " + path;
+        return false;
+    }
+
+    // PresentMon 1.x columns. Display-side columns are not known from inside
+    // the process and are written as 0.
+    file << "Application,ProcessID,SwapChainAddress,Runtime,SyncInterval,PresentFlags,AllowsTearing,"
+            "PresentMode,Dropped,TimeInSeconds,msInPresentAPI,msBetweenPresents,msBetweenDisplayChange,"
+            "msUntilRenderComplete,msUntilDisplayed\n";
+
+    const DWORD processId = GetCurrentProcessId();
+    int64_t originQpc = 0;
+    int64_t previousQpc = 0;
+    for (const FrameRecord& record : records) {
+        const bool tearing = (record.flags & FRAME_RECORD_TEARING) != 0;
+        for (uint32_t i = 0; i < record.presentCount; i++) {
+            const int64_t qpc = record.presentQpc[i];
+            if (originQpc == 0) {
+                originQpc = qpc;
+            }
+            const double betweenMs = previousQpc != 0 ? static_cast<double>(qpc - previousQpc) * m_qpcToMs : 0.0;
+            previousQpc = qpc;
+
+            file << application << ','
+                 << processId << ','
+                 << "0x0000000000000000,DXGI,"
+                 << record.syncInterval << ','
+                 << (tearing ? 512 : 0) << ','      // DXGI_PRESENT_ALLOW_TEARING
+                 << (tearing ? 1 : 0) << ','
+                 << "Unknown,0,"
+                 << static_cast<double>(qpc - originQpc) * m_qpcToMs / 1000.0 << ','
+                 << record.presentApiMs[i] << ','
+                 << betweenMs << ",0,0,0\n";
+        }
+    }
+
+    if (!file.good()) {
+        m_lastError = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace osfg
@@ -0,0 +1,148 @@
+// OSFG - Open Source Frame Generation
+// Frame Recorder
+//
+// Keeps one record per base frame (capture-to-present latency, stage times,
+// dropped and duplicated frames) in a fixed ring that the pipeline writes
+// without locks. Any thread can take a consistent copy of the ring to write
+// it out as CSV, in PresentMon's CSV layout for existing frame time tools,
+// or reduce it to percentiles. Each record is also emitted as a
+// TraceLogging event (provider "OSFG") for WPA and GPUView.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace osfg {
+
+// FrameRecord::flags
+enum FrameRecordFlags : uint32_t {
+    FRAME_RECORD_DROPPED = 1 << 0,      // The desktop presented frames that were never captured
+    FRAME_RECORD_DUPLICATED = 1 << 1,   // Frame generation on, but no generated frames went out
+    FRAME_RECORD_TEARING = 1 << 2       // Presented with tearing allowed (VRR or vsync off)
+};
+
+// One base frame, from the desktop present to its last Present() call
+struct FrameRecord {
+    static const uint32_t MAX_PRESENTS = 5;
+
+    uint64_t frameNumber = 0;
+    int64_t desktopPresentQpc = 0;           // Source present (LastPresentTime), 0 if unknown
+    int64_t acquiredQpc = 0;                 // Capture acquisition
+    int64_t presentQpc[MAX_PRESENTS] = {};   // Each Present() call, in order (generated, then real)
+    float presentApiMs[MAX_PRESENTS] = {};   // Time spent inside each Present() call
+    uint32_t presentCount = 0;
+    uint32_t syncInterval = 0;
+    uint32_t missedFrames = 0;               // Desktop frames folded into this one
+    uint32_t flags = 0;                      // FrameRecordFlags
+
+    // Milliseconds. Capture times are this frame's; the others are the
+    // pipeline's latest values when the frame was recorded (GPU times lag
+    // by the frames in flight).
+    float latencyMs = 0.0f;                  // Desktop present (or acquisition) to the last Present()
+    float captureLatencyMs = 0.0f;
+    float captureMs = 0.0f;
+    float transferMs = 0.0f;
+    float opticalFlowMs = 0.0f;
+    float interpolationMs = 0.0f;
+    float presentMs = 0.0f;
+    float gpuTransferMs = 0.0f;              // Both GPUs' transfer copies
+    float gpuPresentMs = 0.0f;
+};
+
+// Nearest-rank percentiles of one quantity
+struct FramePercentiles {
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+// Distribution of the records currently in the ring
+struct FrameRecordSummary {
+    uint64_t frames = 0;
+    uint64_t droppedFrames = 0;       // Sum of missedFrames
+    uint64_t duplicatedFrames = 0;    // Records flagged FRAME_RECORD_DUPLICATED
+    FramePercentiles latencyMs;       // FrameRecord::latencyMs
+    FramePercentiles frameTimeMs;     // Between consecutive base frames' last presents
+    FramePercentiles presentTimeMs;   // Between consecutive presents (output frame times)
+};
+
+// Configuration for the frame recorder
+struct FrameRecorderConfig {
+    uint32_t capacity = 4096;     // Records kept (oldest overwritten)
+    bool traceLogging = true;     // Emit each record as an ETW event
+};
+
+class FrameRecorder {
+public:
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    // Non-copyable
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Allocate the ring (and register the ETW provider)
+    bool Initialize(const FrameRecorderConfig& config = FrameRecorderConfig{});
+
+    // Release the ring
+    void Shutdown();
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // Append a record. One writer thread only; never blocks or allocates.
+    void Record(const FrameRecord& record);
+
+    // Copy the records currently in the ring, oldest first (any thread).
+    // Records overwritten during the copy are left out.
+    void Snapshot(std::vector<FrameRecord>& records) const;
+
+    // Percentiles over the records currently in the ring
+    FrameRecordSummary GetSummary() const;
+
+    // Write the ring as CSV: one row per base frame
+    bool WriteCsv(const std::string& path) const;
+
+    // Write the ring in PresentMon's CSV layout: one row per Present() call
+    bool WritePresentMonCsv(const std::string& path, const std::string& application) const;
+
+    // Records written since Initialize()
+    uint64_t GetRecordCount() const { return m_written.load(std::memory_order_acquire); }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // Per-entry sequence: odd while being written, 2 * (n + 1) once record n is complete
+    struct Entry {
+        std::atomic<uint64_t> sequence{ 0 };
+        FrameRecord record;
+    };
+
+    std::unique_ptr<Entry[]> m_entries;
+    uint32_t m_capacity = 0;
+    std::atomic<uint64_t> m_written{ 0 };
+    double m_qpcToMs = 0.0;
+    bool m_traceLogging = false;
+    bool m_initialized = false;
+    mutable std::string m_lastError;
+};
+
+} // namespace osfg
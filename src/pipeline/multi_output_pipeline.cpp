@@ -0,0 +1,152 @@
+// OSFG - Open Source Frame Generation
+// Multi-Output Pipeline Implementation
+
+#include "multi_output_pipeline.h"
+
+namespace osfg {
+
+MultiOutputPipeline::~MultiOutputPipeline() {
+    Shutdown();
+}
+
+bool MultiOutputPipeline::Initialize(const MultiOutputConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (config.monitors.empty()) {
+        m_lastError = "No outputs configured";
+        return false;
+    }
+    if (config.output.singleGPU || config.output.primaryGPU == config.output.secondaryGPU) {
+        m_lastError = "Multi-output mode needs two GPUs";
+        return false;
+    }
+
+    SharedGPUContextConfig contextConfig;
+    contextConfig.primaryGPU = config.output.primaryGPU;
+    contextConfig.secondaryGPU = config.output.secondaryGPU;
+    contextConfig.pipelineCache = config.output.pipelineCache;
+    contextConfig.scheduler = config.scheduler;
+    if (!m_context.Initialize(contextConfig)) {
+        m_lastError = "Failed to initialize shared GPU context: " + m_context.GetLastError();
+        return false;
+    }
+
+    DualGPUConfig outputConfig = config.output;
+    outputConfig.pipelinedMode = true;
+
+    for (size_t i = 0; i < config.monitors.size(); i++) {
+        outputConfig.captureMonitor = config.monitors[i];
+
+        auto output = std::make_unique<DualGPUPipeline>();
+        if (!output->Initialize(outputConfig, &m_context)) {
+            m_lastError = "Failed to initialize output " + std::to_string(i) +
+                          " (monitor " + std::to_string(config.monitors[i]) + "): " + output->GetLastError();
+            Shutdown();
+            return false;
+        }
+        m_outputs.push_back(std::move(output));
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void MultiOutputPipeline::Shutdown() {
+    // Every output drains its work before the shared queue and devices go
+    for (auto& output : m_outputs) {
+        output->Shutdown();
+    }
+    m_outputs.clear();
+    m_context.Shutdown();
+    m_initialized = false;
+}
+
+bool MultiOutputPipeline::Start() {
+    if (!m_initialized) {
+        m_lastError = "Pipeline not initialized";
+        return false;
+    }
+
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        if (!m_outputs[i]->Start()) {
+            m_lastError = "Failed to start output " + std::to_string(i) + ": " + m_outputs[i]->GetLastError();
+            Stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MultiOutputPipeline::Stop() {
+    for (auto& output : m_outputs) {
+        output->Stop();
+    }
+}
+
+bool MultiOutputPipeline::IsRunning() const {
+    if (m_outputs.empty()) {
+        return false;
+    }
+    for (const auto& output : m_outputs) {
+        if (!output->IsRunning()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MultiOutputPipeline::ProcessFrame() {
+    bool running = !m_outputs.empty();
+    for (auto& output : m_outputs) {
+        if (!output->ProcessFrame()) {
+            running = false;
+        }
+    }
+    return running;
+}
+
+void MultiOutputPipeline::Run() {
+    if (!Start()) {
+        return;
+    }
+
+    // The windows all belong to this thread, so one pump serves them all
+    bool quit = false;
+    while (!quit) {
+        MSG msg = {};
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                quit = true;
+                break;
+            }
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        for (auto& output : m_outputs) {
+            if (!output->IsWindowOpen()) {
+                quit = true;
+            }
+        }
+        if (quit || !ProcessFrame()) {
+            break;
+        }
+
+        // Stage threads do the work; just keep the windows responsive
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, 1, QS_ALLINPUT);
+    }
+
+    Stop();
+}
+
+PipelineStats MultiOutputPipeline::GetStats(uint32_t index) const {
+    return index < m_outputs.size() ? m_outputs[index]->GetStats() : PipelineStats();
+}
+
+ComputeSchedulerStats MultiOutputPipeline::GetSchedulerStats() const {
+    return m_context.GetComputeScheduler()->GetStats();
+}
+
+} // namespace osfg
@@ -0,0 +1,81 @@
+// OSFG - Open Source Frame Generation
+// Multi-Output Pipeline
+//
+// One dual-GPU pipeline per captured monitor (triple-screen rigs), all on a
+// single SharedGPUContext: one device per GPU, shared heap arenas and PSOs,
+// and one compute scheduler interleaving every output's flow and
+// interpolation on the secondary GPU earliest deadline first. Each output
+// keeps its own capture, transfer, present queue and window, centred on the
+// monitor it captures.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dual_gpu_pipeline.h"
+#include "shared_gpu_context.h"
+
+namespace osfg {
+
+// Configuration for a multi-output pipeline
+struct MultiOutputConfig {
+    // Settings every output runs with. captureMonitor is replaced by each
+    // entry of `monitors`; pipelinedMode is forced on (a serial output would
+    // hold the others for its capture wait) and the GPUs must differ.
+    DualGPUConfig output;
+    std::vector<uint32_t> monitors = { 0 };     // One output per DXGI output index
+    ComputeSchedulerConfig scheduler;
+};
+
+class MultiOutputPipeline {
+public:
+    MultiOutputPipeline() = default;
+    ~MultiOutputPipeline();
+
+    // Disable copy
+    MultiOutputPipeline(const MultiOutputPipeline&) = delete;
+    MultiOutputPipeline& operator=(const MultiOutputPipeline&) = delete;
+
+    bool Initialize(const MultiOutputConfig& config);
+    void Shutdown();
+
+    // Start or stop every output
+    bool Start();
+    void Stop();
+
+    // True while every output is running
+    bool IsRunning() const;
+
+    // ProcessFrame() of every output (from the thread that called
+    // Initialize()); false once any of them has stopped
+    bool ProcessFrame();
+
+    // Start, then pump the windows' messages and process frames until a
+    // window closes, WM_QUIT arrives or an output stops
+    void Run();
+
+    uint32_t GetOutputCount() const { return static_cast<uint32_t>(m_outputs.size()); }
+    DualGPUPipeline* GetOutput(uint32_t index) { return index < m_outputs.size() ? m_outputs[index].get() : nullptr; }
+
+    // Any thread
+    PipelineStats GetStats(uint32_t index) const;
+    ComputeSchedulerStats GetSchedulerStats() const;
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    // Declared first: the outputs shut down before the context they run on
+    SharedGPUContext m_context;
+    std::vector<std::unique_ptr<DualGPUPipeline>> m_outputs;
+
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
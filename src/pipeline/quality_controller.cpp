@@ -0,0 +1,69 @@
+// OSFG - Open Source Frame Generation
+// Quality Controller Implementation
+
+#include "quality_controller.h"
+
+#include <algorithm>
+
+namespace osfg {
+
+void QualityController::Reset(const QualityControllerConfig& config) {
+    m_config = config;
+    m_load = 0.0;
+    m_hasLoad = false;
+    m_overFrames = 0;
+    m_underFrames = 0;
+    m_settleFrames = 0;
+    m_stepUpFrames = config.stepUpFrames;
+    m_framesSinceStepUp = 0;
+    m_steppedUp = false;
+}
+
+QualityDecision QualityController::Update(double gpuMs, double budgetMs, bool canStepDown, bool canStepUp) {
+    if (gpuMs <= 0.0 || budgetMs <= 0.0) {
+        return QualityDecision::Hold;
+    }
+
+    m_framesSinceStepUp++;
+
+    // Samples right after a change still time frames of the old setting
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        return QualityDecision::Hold;
+    }
+
+    const double load = gpuMs / budgetMs;
+    m_load = m_hasLoad ? m_load + (load - m_load) * m_config.smoothing : load;
+    m_hasLoad = true;
+
+    m_overFrames = m_load > m_config.stepDownLoad ? m_overFrames + 1 : 0;
+    m_underFrames = m_load < m_config.stepUpLoad ? m_underFrames + 1 : 0;
+
+    QualityDecision decision = QualityDecision::Hold;
+    if (canStepDown && m_overFrames >= m_config.stepDownFrames) {
+        // A step up that did not hold: wait longer before the next one
+        if (m_steppedUp && m_framesSinceStepUp < m_stepUpFrames) {
+            m_stepUpFrames = (std::min)(m_stepUpFrames * 2, m_config.maxStepUpFrames);
+        }
+        m_steppedUp = false;
+        decision = QualityDecision::StepDown;
+    } else if (canStepUp && m_underFrames >= m_stepUpFrames) {
+        m_steppedUp = true;
+        m_framesSinceStepUp = 0;
+        decision = QualityDecision::StepUp;
+    } else if (m_steppedUp && m_framesSinceStepUp >= m_stepUpFrames) {
+        // The last step up held: back-off decays again
+        m_steppedUp = false;
+        m_stepUpFrames = (std::max)(m_stepUpFrames / 2, m_config.stepUpFrames);
+    }
+
+    if (decision != QualityDecision::Hold) {
+        m_overFrames = 0;
+        m_underFrames = 0;
+        m_settleFrames = m_config.settleFrames;
+        m_hasLoad = false;  // The new setting starts its own average
+    }
+    return decision;
+}
+
+} // namespace osfg
@@ -0,0 +1,66 @@
+// OSFG - Open Source Frame Generation
+// Quality Controller
+//
+// Closed-loop frame generation quality. Fed the secondary GPU's time per
+// base frame (flow, interpolation and present passes from the GPU
+// timestamps) and the base interval it has to fit in, it decides when to
+// give up quality and when there is headroom to take it back. Stepping
+// down reacts within a fraction of a second; stepping up waits for
+// sustained headroom, and waits twice as long after every step up that had
+// to be taken back, so a setting just over the edge does not oscillate.
+//
+// The controller only decides; the caller owns the ladder of settings.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#include <cstdint>
+
+namespace osfg {
+
+// Configuration for the quality controller
+struct QualityControllerConfig {
+    double stepDownLoad = 0.9;      // Smoothed GPU time / budget above which quality drops
+    double stepUpLoad = 0.6;        // ... below which it may come back
+    uint32_t stepDownFrames = 15;   // Consecutive frames over before stepping down
+    uint32_t stepUpFrames = 300;    // Consecutive frames under before stepping up
+    uint32_t maxStepUpFrames = 4800;    // Back-off cap for stepUpFrames
+    uint32_t settleFrames = 10;     // Frames ignored after a change (timestamps lag the change)
+    double smoothing = 0.1;         // EMA weight of a new sample
+};
+
+enum class QualityDecision {
+    Hold,
+    StepDown,
+    StepUp,
+};
+
+class QualityController {
+public:
+    QualityController() = default;
+
+    // Start over (no history, no back-off)
+    void Reset(const QualityControllerConfig& config);
+
+    // One base frame's GPU time against its budget. canStepDown/canStepUp:
+    // whether a lower / higher setting exists. A returned step is assumed
+    // to be taken.
+    QualityDecision Update(double gpuMs, double budgetMs, bool canStepDown, bool canStepUp);
+
+    // Smoothed GPU time / budget (0 until the first sample)
+    double GetLoad() const { return m_load; }
+
+private:
+    QualityControllerConfig m_config;
+    double m_load = 0.0;
+    bool m_hasLoad = false;
+    uint32_t m_overFrames = 0;
+    uint32_t m_underFrames = 0;
+    uint32_t m_settleFrames = 0;
+    uint32_t m_stepUpFrames = 0;        // Current step-up hold (backs off)
+    uint64_t m_framesSinceStepUp = 0;
+    bool m_steppedUp = false;
+};
+
+} // namespace osfg
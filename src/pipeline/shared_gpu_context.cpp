@@ -0,0 +1,92 @@
+// OSFG - Open Source Frame Generation
+// Shared GPU Context Implementation
+
+#include "shared_gpu_context.h"
+
+#include <dxgi1_6.h>
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+namespace osfg {
+
+SharedGPUContext::~SharedGPUContext() {
+    Shutdown();
+}
+
+bool SharedGPUContext::Initialize(const SharedGPUContextConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    m_config = config;
+
+    if (config.primaryGPU == config.secondaryGPU) {
+        m_lastError = "Shared context needs two different GPUs";
+        return false;
+    }
+
+    if (!CreateDevice(config.primaryGPU, m_primaryDevice) ||
+        !CreateDevice(config.secondaryGPU, m_secondaryDevice)) {
+        Shutdown();
+        return false;
+    }
+
+    if (!m_primaryArena.Initialize(m_primaryDevice.Get()) ||
+        !m_secondaryArena.Initialize(m_secondaryDevice.Get())) {
+        m_lastError = "Failed to initialize resource arenas";
+        Shutdown();
+        return false;
+    }
+
+    // Not fatal: without it every output creates its PSOs from bytecode
+    if (config.pipelineCache) {
+        m_pipelineCache.Initialize(m_secondaryDevice.Get());
+    }
+
+    if (!m_scheduler.Initialize(m_secondaryDevice.Get(), config.scheduler)) {
+        m_lastError = "Failed to initialize compute scheduler: " + m_scheduler.GetLastError();
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void SharedGPUContext::Shutdown() {
+    // The scheduler drains its queue before anything it ran on is released
+    m_scheduler.Shutdown();
+    m_pipelineCache.Shutdown();
+    m_secondaryArena.Shutdown();
+    m_primaryArena.Shutdown();
+    m_secondaryDevice.Reset();
+    m_primaryDevice.Reset();
+    m_initialized = false;
+}
+
+bool SharedGPUContext::CreateDevice(uint32_t adapterIndex, ComPtr<ID3D12Device>& device) {
+    ComPtr<IDXGIFactory6> factory;
+    HRESULT hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&factory));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create DXGI factory";
+        return false;
+    }
+
+    ComPtr<IDXGIAdapter1> adapter;
+    hr = factory->EnumAdapters1(adapterIndex, &adapter);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to get adapter " + std::to_string(adapterIndex);
+        return false;
+    }
+
+    hr = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create D3D12 device on adapter " + std::to_string(adapterIndex);
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace osfg
@@ -0,0 +1,93 @@
+// OSFG - Open Source Frame Generation
+// Shared GPU Context
+//
+// What several dual-GPU pipelines - one per captured output - can share: one
+// D3D12 device per GPU, a heap arena on each, the secondary GPU's PSO cache
+// and a compute scheduler that interleaves their flow and interpolation work
+// on one COMPUTE queue by deadline. Per output stay the capture, the
+// transfer's queues and fences, the present queue and the swap chain; those
+// wait on the output's own fences, and sharing them would hold every output
+// behind the slowest one.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+
+#include "compute_scheduler.h"
+#include "common/pipeline_cache.h"
+#include "common/resource_arena.h"
+
+namespace osfg {
+
+// Configuration for the shared context
+struct SharedGPUContextConfig {
+    uint32_t primaryGPU = 0;        // Capture GPU (adapter index)
+    uint32_t secondaryGPU = 1;      // Frame generation and presentation GPU
+    bool pipelineCache = true;      // On-disk PSO library on the secondary GPU
+    ComputeSchedulerConfig scheduler;
+};
+
+class SharedGPUContext {
+public:
+    SharedGPUContext() = default;
+    ~SharedGPUContext();
+
+    // Non-copyable
+    SharedGPUContext(const SharedGPUContext&) = delete;
+    SharedGPUContext& operator=(const SharedGPUContext&) = delete;
+
+    bool Initialize(const SharedGPUContextConfig& config);
+
+    // After every pipeline using the context has shut down
+    void Shutdown();
+
+    bool IsInitialized() const { return m_initialized; }
+
+    uint32_t GetPrimaryGPU() const { return m_config.primaryGPU; }
+    uint32_t GetSecondaryGPU() const { return m_config.secondaryGPU; }
+
+    ID3D12Device* GetPrimaryDevice() const { return m_primaryDevice.Get(); }
+    ID3D12Device* GetSecondaryDevice() const { return m_secondaryDevice.Get(); }
+    ResourceArena* GetPrimaryArena() { return &m_primaryArena; }
+    ResourceArena* GetSecondaryArena() { return &m_secondaryArena; }
+
+    // nullptr when disabled or unavailable
+    PipelineCache* GetPipelineCache() { return m_pipelineCache.IsInitialized() ? &m_pipelineCache : nullptr; }
+
+    ComputeScheduler* GetComputeScheduler() { return &m_scheduler; }
+    const ComputeScheduler* GetComputeScheduler() const { return &m_scheduler; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool CreateDevice(uint32_t adapterIndex, ComPtr<ID3D12Device>& device);
+
+    SharedGPUContextConfig m_config;
+
+    ComPtr<ID3D12Device> m_primaryDevice;
+    ComPtr<ID3D12Device> m_secondaryDevice;
+    ResourceArena m_primaryArena;
+    ResourceArena m_secondaryArena;
+    PipelineCache m_pipelineCache;
+    ComputeScheduler m_scheduler;
+
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
@@ -0,0 +1,68 @@
+// OSFG - Open Source Frame Generation
+// Lock-Free Stats Snapshot
+//
+// Seqlock holding the latest published copy of a plain statistics struct.
+// One thread at a time publishes; any number of threads read. Publishing
+// never waits for readers, and a reader that overlaps a publish simply
+// copies again, so a descheduled UI thread can never stall a pipeline stage.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+namespace osfg {
+
+template <typename T>
+class StatsSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "StatsSnapshot needs a trivially copyable type");
+
+public:
+    StatsSnapshot() = default;
+
+    // Non-copyable
+    StatsSnapshot(const StatsSnapshot&) = delete;
+    StatsSnapshot& operator=(const StatsSnapshot&) = delete;
+
+    // Writer side (one thread at a time). Never blocks.
+    void Publish(const T& value) {
+        // Odd while the copy is being written
+        const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_value = value;
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Reader side (any thread). Retries while a publish is in progress.
+    T Load() const {
+        for (;;) {
+            const uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                T copy = m_value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    return copy;
+                }
+            }
+            // The writer was preempted mid-publish (a copy takes well under
+            // a microsecond otherwise)
+            std::this_thread::yield();
+        }
+    }
+
+    // Publishes so far
+    uint64_t GetPublishCount() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    // The sequence sits on its own cache line so readers polling it don't
+    // false-share with whatever precedes the snapshot
+    alignas(64) std::atomic<uint64_t> m_sequence{0};
+    T m_value{};
+};
+
+} // namespace osfg
@@ -0,0 +1,389 @@
+// OSFG Frame Upscaler Implementation
+// Edge-aware upscale of reduced-resolution generated frames into the back buffer
+// MIT License - Part of Open Source Frame Generation project
+
+#include "frame_upscaler.h"
+#include "common/pipeline_cache.h"
+#include "common/precompiled_shader.h"
+#include <d3dcompiler.h>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace OSFG {
+
+static const char* g_frameUpscalerShader = R"(
+// Upscale: bilinear centre tap, contrast-adaptive sharpen, neighbourhood clamp
+
+cbuffer Constants : register(b0)
+{
+    float2 g_TargetSize;    // Render target size (pixels)
+    float2 g_TexelSize;     // 1 / source size
+    float g_Sharpness;      // 0..1
+    float3 g_Padding;
+};
+
+Texture2D<float4> g_Source : register(t0);
+SamplerState g_LinearSampler : register(s0);
+
+// One triangle covering the viewport; no vertex buffer
+float4 VSFullscreen(uint vertexId : SV_VertexID) : SV_Position
+{
+    float2 corner = float2((vertexId << 1) & 2, vertexId & 2);
+    return float4(corner * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+float4 PSUpscale(float4 position : SV_Position) : SV_Target
+{
+    float2 uv = position.xy / g_TargetSize;
+
+    float3 c = g_Source.SampleLevel(g_LinearSampler, uv, 0).rgb;
+    float3 n = g_Source.SampleLevel(g_LinearSampler, uv - float2(0.0, g_TexelSize.y), 0).rgb;
+    float3 s = g_Source.SampleLevel(g_LinearSampler, uv + float2(0.0, g_TexelSize.y), 0).rgb;
+    float3 w = g_Source.SampleLevel(g_LinearSampler, uv - float2(g_TexelSize.x, 0.0), 0).rgb;
+    float3 e = g_Source.SampleLevel(g_LinearSampler, uv + float2(g_TexelSize.x, 0.0), 0).rgb;
+
+    float3 lo = min(c, min(min(n, s), min(w, e)));
+    float3 hi = max(c, max(max(n, s), max(w, e)));
+
+    // Full strength in soft detail, none across hard edges (which the
+    // bilinear tap already renders crisply at 2x)
+    float contrast = dot(hi - lo, float3(0.2126, 0.7152, 0.0722));
+    float amount = g_Sharpness * saturate(1.0 - contrast * 2.0);
+
+    float3 sharpened = c + (c - 0.25 * (n + s + w + e)) * amount;
+    return float4(clamp(sharpened, lo, hi), 1.0);
+}
+)";
+
+} // namespace OSFG
+
+// DXIL for the shaders above, compiled by the build (see osfg_precompile_shaders)
+#ifdef OSFG_PRECOMPILED_SHADERS
+#include "g_frameUpscalerShader_dxil.h"
+#endif
+
+namespace OSFG {
+
+// Root constants of the upscale pass (b0)
+struct UpscaleConstants {
+    float targetWidth;
+    float targetHeight;
+    float texelWidth;
+    float texelHeight;
+    float sharpness;
+    float padding[3];
+};
+
+static const uint32_t UPSCALE_CONSTANT_COUNT = sizeof(UpscaleConstants) / sizeof(uint32_t);
+
+// Build-time DXIL for an entry point of g_frameUpscalerShader, or nullptr
+static const osfg::PrecompiledShader* FindPrecompiledShader(const char* entryPoint)
+{
+#ifdef OSFG_PRECOMPILED_SHADERS
+    return osfg::FindPrecompiledShader(g_frameUpscalerShaderDxil,
+                                       std::size(g_frameUpscalerShaderDxil), entryPoint, "");
+#else
+    (void)entryPoint;
+    return nullptr;
+#endif
+}
+
+FrameUpscaler::FrameUpscaler() = default;
+
+FrameUpscaler::~FrameUpscaler()
+{
+    Shutdown();
+}
+
+bool FrameUpscaler::Initialize(ID3D12Device* device, DXGI_FORMAT renderTargetFormat, float sharpness,
+                               osfg::PipelineCache* pipelineCache)
+{
+    if (m_initialized) {
+        m_lastError = "Already initialized";
+        return false;
+    }
+
+    if (!device || renderTargetFormat == DXGI_FORMAT_UNKNOWN) {
+        m_lastError = "Invalid D3D12 device or render target format";
+        return false;
+    }
+
+    m_device = device;
+    m_renderTargetFormat = renderTargetFormat;
+    m_sharpness = sharpness < 0.0f ? 0.0f : (sharpness > 1.0f ? 1.0f : sharpness);
+    m_pipelineCache = pipelineCache;
+    m_dxilSupported = osfg::SupportsShaderModel6(device);
+
+    if (!CreateRootSignature() || !CreatePipelineState() || !CreateDescriptorHeap()) {
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void FrameUpscaler::Shutdown()
+{
+    for (auto& source : m_sources) {
+        source = nullptr;
+    }
+
+    m_srvHeap.Reset();
+    m_pipelineState.Reset();
+    m_rootSignature.Reset();
+    m_device.Reset();
+    m_pipelineCache = nullptr;
+    m_initialized = false;
+}
+
+bool FrameUpscaler::CreateRootSignature()
+{
+    // Root parameters:
+    // [0] Root constants - UpscaleConstants
+    // [1] Descriptor table - SRV (source frame)
+    // Static sampler s0: bilinear, clamped
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.RegisterSpace = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+    D3D12_ROOT_PARAMETER rootParams[2] = {};
+
+    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParams[0].Constants.ShaderRegister = 0;
+    rootParams[0].Constants.RegisterSpace = 0;
+    rootParams[0].Constants.Num32BitValues = UPSCALE_CONSTANT_COUNT;
+    rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_STATIC_SAMPLER_DESC sampler = {};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.RegisterSpace = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
+    rootSigDesc.NumParameters = 2;
+    rootSigDesc.pParameters = rootParams;
+    rootSigDesc.NumStaticSamplers = 1;
+    rootSigDesc.pStaticSamplers = &sampler;
+    rootSigDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    Microsoft::WRL::ComPtr<ID3DBlob> signature;
+    Microsoft::WRL::ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                             &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            m_lastError = "Upscaler root signature serialization failed: " +
+                         std::string((char*)error->GetBufferPointer());
+        } else {
+            m_lastError = "Upscaler root signature serialization failed";
+        }
+        return false;
+    }
+
+    hr = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(),
+                                       IID_PPV_ARGS(&m_rootSignature));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create upscaler root signature";
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameUpscaler::CompileShader(const char* entryPoint, const char* target, bool allowPrecompiled,
+                                  Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob,
+                                  D3D12_SHADER_BYTECODE& bytecode)
+{
+    // Prefer the DXIL the build compiled; fall back to FXC at runtime
+    if (allowPrecompiled) {
+        if (const osfg::PrecompiledShader* precompiled = FindPrecompiledShader(entryPoint)) {
+            bytecode.pShaderBytecode = precompiled->bytecode;
+            bytecode.BytecodeLength = precompiled->size;
+            return true;
+        }
+    }
+
+    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+
+    UINT compileFlags = 0;
+#if defined(_DEBUG)
+    compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+    HRESULT hr = D3DCompile(g_frameUpscalerShader, strlen(g_frameUpscalerShader),
+                            "FrameUpscaler.hlsl", nullptr, nullptr, entryPoint, target,
+                            compileFlags, 0, &shaderBlob, &errorBlob);
+    if (FAILED(hr)) {
+        if (errorBlob) {
+            m_lastError = std::string("Upscaler shader compilation failed (") + entryPoint + "): " +
+                         std::string((char*)errorBlob->GetBufferPointer());
+        } else {
+            m_lastError = std::string("Upscaler shader compilation failed (") + entryPoint + ")";
+        }
+        return false;
+    }
+
+    bytecode.pShaderBytecode = shaderBlob->GetBufferPointer();
+    bytecode.BytecodeLength = shaderBlob->GetBufferSize();
+    return true;
+}
+
+bool FrameUpscaler::CreatePipelineState()
+{
+    // DXIL and DXBC stages cannot be mixed in one PSO
+    const bool precompiled = m_dxilSupported && FindPrecompiledShader("VSFullscreen") &&
+                             FindPrecompiledShader("PSUpscale");
+
+    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> psBlob;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    if (!CompileShader("VSFullscreen", "vs_5_0", precompiled, vsBlob, psoDesc.VS)) return false;
+    if (!CompileShader("PSUpscale", "ps_5_0", precompiled, psBlob, psoDesc.PS)) return false;
+
+    // Opaque: every back-buffer pixel is written
+    psoDesc.BlendState.RenderTarget[0].RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    psoDesc.BlendState.RenderTarget[0].LogicOp = D3D12_LOGIC_OP_NOOP;
+
+    psoDesc.pRootSignature = m_rootSignature.Get();
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.RasterizerState.DepthClipEnable = TRUE;
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = m_renderTargetFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    HRESULT hr = m_pipelineCache
+        ? m_pipelineCache->CreateGraphicsPipelineState("FrameUpscaler/Upscale", psoDesc, m_pipelineState)
+        : m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create upscaler pipeline state";
+        return false;
+    }
+
+    return true;
+}
+
+bool FrameUpscaler::CreateDescriptorHeap()
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = MAX_SOURCES;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_srvHeap));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create upscaler descriptor heap";
+        return false;
+    }
+
+    m_srvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    return true;
+}
+
+bool FrameUpscaler::SetSource(uint32_t slot, ID3D12Resource* source)
+{
+    if (!m_initialized || slot >= MAX_SOURCES) {
+        m_lastError = "Invalid upscaler source slot";
+        return false;
+    }
+
+    if (source) {
+        const D3D12_RESOURCE_DESC desc = source->GetDesc();
+
+        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+        srvDesc.Format = desc.Format;
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srvDesc.Texture2D.MipLevels = 1;
+
+        D3D12_CPU_DESCRIPTOR_HANDLE handle = m_srvHeap->GetCPUDescriptorHandleForHeapStart();
+        handle.ptr += static_cast<SIZE_T>(slot) * m_srvDescriptorSize;
+        m_device->CreateShaderResourceView(source, &srvDesc, handle);
+    }
+
+    m_sources[slot] = source;
+    return true;
+}
+
+void FrameUpscaler::Record(ID3D12GraphicsCommandList* commandList, uint32_t slot,
+                           D3D12_RESOURCE_STATES sourceState, D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                           uint32_t targetWidth, uint32_t targetHeight)
+{
+    if (!m_initialized || !commandList || slot >= MAX_SOURCES || renderTarget.ptr == 0 ||
+        targetWidth == 0 || targetHeight == 0) {
+        return;
+    }
+
+    ID3D12Resource* source = m_sources[slot];
+    if (!source) {
+        return;
+    }
+
+    const D3D12_RESOURCE_DESC desc = source->GetDesc();
+
+    UpscaleConstants constants = {};
+    constants.targetWidth = static_cast<float>(targetWidth);
+    constants.targetHeight = static_cast<float>(targetHeight);
+    constants.texelWidth = 1.0f / static_cast<float>(desc.Width);
+    constants.texelHeight = 1.0f / static_cast<float>(desc.Height);
+    constants.sharpness = m_sharpness;
+
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = source;
+    barrier.Transition.StateBefore = sourceState;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    const bool transition = sourceState != D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    if (transition) {
+        commandList->ResourceBarrier(1, &barrier);
+    }
+
+    commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(m_pipelineState.Get());
+
+    ID3D12DescriptorHeap* heaps[] = { m_srvHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetGraphicsRoot32BitConstants(0, UPSCALE_CONSTANT_COUNT, &constants, 0);
+    D3D12_GPU_DESCRIPTOR_HANDLE table = m_srvHeap->GetGPUDescriptorHandleForHeapStart();
+    table.ptr += static_cast<UINT64>(slot) * m_srvDescriptorSize;
+    commandList->SetGraphicsRootDescriptorTable(1, table);
+
+    D3D12_VIEWPORT viewport = { 0.0f, 0.0f, static_cast<float>(targetWidth),
+                                static_cast<float>(targetHeight), 0.0f, 1.0f };
+    D3D12_RECT scissor = { 0, 0, static_cast<LONG>(targetWidth), static_cast<LONG>(targetHeight) };
+    commandList->RSSetViewports(1, &viewport);
+    commandList->RSSetScissorRects(1, &scissor);
+    commandList->OMSetRenderTargets(1, &renderTarget, FALSE, nullptr);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    commandList->DrawInstanced(3, 1, 0, 0);
+
+    if (transition) {
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        commandList->ResourceBarrier(1, &barrier);
+    }
+}
+
+} // namespace OSFG
@@ -0,0 +1,93 @@
+// OSFG Frame Upscaler
+// Draws a generated frame that was interpolated below output resolution
+// into the back buffer, inside the present pass
+// MIT License - Part of Open Source Frame Generation project
+//
+// One full-screen pass per frame: a bilinear tap plus its four neighbours
+// one source texel away, a contrast-adaptive sharpen against their average
+// and a clamp to their range. The clamp keeps edges from ringing and the
+// sharpen fades out where contrast is already high, so it costs about as
+// much as the copy it replaces.
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+    class PipelineCache;
+}
+
+namespace OSFG {
+
+class FrameUpscaler {
+public:
+    // Source textures SetSource() can hold at once
+    static const uint32_t MAX_SOURCES = 8;
+
+    FrameUpscaler();
+    ~FrameUpscaler();
+
+    // Non-copyable
+    FrameUpscaler(const FrameUpscaler&) = delete;
+    FrameUpscaler& operator=(const FrameUpscaler&) = delete;
+
+    // device: the presenting device; renderTargetFormat: back buffer format.
+    // sharpness: 0 = plain bilinear, 1 = strongest sharpen.
+    bool Initialize(ID3D12Device* device, DXGI_FORMAT renderTargetFormat, float sharpness = 0.5f,
+                    osfg::PipelineCache* pipelineCache = nullptr);
+
+    // Shutdown (the GPU must be done with the present lists)
+    void Shutdown();
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // Bind a source texture (or nullptr) to `slot`. Any thread, but no list
+    // still executing on the GPU may be reading the slot.
+    bool SetSource(uint32_t slot, ID3D12Resource* source);
+
+    // Upscale the texture in `slot` into `renderTarget` (RENDER_TARGET
+    // state, of targetWidth x targetHeight). The source is moved from
+    // `sourceState` to PIXEL_SHADER_RESOURCE for the pass and back.
+    void Record(ID3D12GraphicsCommandList* commandList, uint32_t slot, D3D12_RESOURCE_STATES sourceState,
+                D3D12_CPU_DESCRIPTOR_HANDLE renderTarget, uint32_t targetWidth, uint32_t targetHeight);
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool CreateRootSignature();
+    bool CreatePipelineState();
+    bool CreateDescriptorHeap();
+    bool CompileShader(const char* entryPoint, const char* target, bool allowPrecompiled,
+                       Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob, D3D12_SHADER_BYTECODE& bytecode);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvHeap;
+    uint32_t m_srvDescriptorSize = 0;
+    std::atomic<ID3D12Resource*> m_sources[MAX_SOURCES] = {};   // Not owned; bound by SetSource()
+
+    DXGI_FORMAT m_renderTargetFormat = DXGI_FORMAT_UNKNOWN;
+    float m_sharpness = 0.5f;
+    osfg::PipelineCache* m_pipelineCache = nullptr;
+    bool m_dxilSupported = false;
+
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace OSFG
@@ -0,0 +1,530 @@
+// OSFG Overlay Compositor Implementation
+// Uploads the overlay image when it changes and blends it into the back buffer
+// MIT License - Part of Open Source Frame Generation project
+
+#include "overlay_compositor.h"
+#include "common/pipeline_cache.h"
+#include "common/precompiled_shader.h"
+#include <d3dcompiler.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace OSFG {
+
+static const char* g_overlayCompositorShader = R"(
+// Overlay blend: one quad over the image rectangle, premultiplied alpha
+
+cbuffer Constants : register(b0)
+{
+    float2 g_Origin;        // Top-left of the image in the render target (pixels)
+    float2 g_Size;          // Image size (pixels)
+    float2 g_TargetSize;    // Render target size (pixels)
+    float2 g_Padding;
+};
+
+Texture2D<float4> g_Overlay : register(t0);
+
+// Triangle strip over the image rectangle; no vertex buffer
+float4 VSQuad(uint vertexId : SV_VertexID) : SV_Position
+{
+    float2 corner = float2(vertexId & 1, vertexId >> 1);
+    float2 pixel = g_Origin + corner * g_Size;
+    return float4(pixel / g_TargetSize * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+#ifdef HDR10_OUTPUT
+// HDR10 back buffer: the sRGB image goes to BT.2020 PQ with its white at
+// the 203-nit reference white
+static const float3x3 BT709_TO_BT2020 = {
+    0.627404, 0.329283, 0.043313,
+    0.069097, 0.919541, 0.011362,
+    0.016391, 0.088013, 0.895595
+};
+
+float3 SrgbToPQ(float3 srgb)
+{
+    float3 lin = srgb <= 0.04045 ? srgb / 12.92 : pow((srgb + 0.055) / 1.055, 2.4);
+    float3 y = pow(saturate(mul(BT709_TO_BT2020, lin) * (203.0 / 10000.0)), 0.1593017578125);
+    return pow((0.8359375 + 18.8515625 * y) / (1.0 + 18.6875 * y), 78.84375);
+}
+#endif
+
+// Texel-exact: the image is drawn 1:1, so there is nothing to filter
+float4 PSOverlay(float4 position : SV_Position) : SV_Target
+{
+    float4 color = g_Overlay.Load(int3(int2(position.xy - g_Origin), 0));
+#ifdef HDR10_OUTPUT
+    // Converted unpremultiplied; the blend itself then runs on PQ values
+    if (color.a > 0.0)
+        color.rgb = SrgbToPQ(color.rgb / color.a) * color.a;
+#endif
+    return color;
+}
+)";
+
+} // namespace OSFG
+
+// DXIL for the shaders above, compiled by the build (see osfg_precompile_shaders)
+#ifdef OSFG_PRECOMPILED_SHADERS
+#include "g_overlayCompositorShader_dxil.h"
+#endif
+
+namespace OSFG {
+
+// Root constants of the blend pass (b0)
+struct OverlayConstants {
+    float originX;
+    float originY;
+    float width;
+    float height;
+    float targetWidth;
+    float targetHeight;
+    float padding[2];
+};
+
+static const uint32_t OVERLAY_CONSTANT_COUNT = sizeof(OverlayConstants) / sizeof(uint32_t);
+static const uint32_t BYTES_PER_PIXEL = 4;
+
+// Build-time DXIL for a variant of g_overlayCompositorShader, or nullptr
+static const osfg::PrecompiledShader* FindPrecompiledShader(const char* entryPoint, const D3D_SHADER_MACRO* defines)
+{
+#ifdef OSFG_PRECOMPILED_SHADERS
+    return osfg::FindPrecompiledShader(g_overlayCompositorShaderDxil,
+                                       std::size(g_overlayCompositorShaderDxil), entryPoint,
+                                       osfg::ShaderDefinesKey(defines));
+#else
+    (void)entryPoint;
+    (void)defines;
+    return nullptr;
+#endif
+}
+
+OverlayCompositor::OverlayCompositor() = default;
+
+OverlayCompositor::~OverlayCompositor()
+{
+    Shutdown();
+}
+
+bool OverlayCompositor::Initialize(ID3D12Device* device, DXGI_FORMAT renderTargetFormat,
+                                   ID3D12Fence* fence, osfg::PipelineCache* pipelineCache)
+{
+    if (m_initialized) {
+        m_lastError = "Already initialized";
+        return false;
+    }
+
+    if (!device || !fence || renderTargetFormat == DXGI_FORMAT_UNKNOWN) {
+        m_lastError = "Invalid D3D12 device, fence or render target format";
+        return false;
+    }
+
+    m_device = device;
+    m_fence = fence;
+    m_renderTargetFormat = renderTargetFormat;
+    m_pipelineCache = pipelineCache;
+    m_dxilSupported = osfg::SupportsShaderModel6(device);
+
+    if (!CreateRootSignature() || !CreatePipelineState() || !CreateResources()) {
+        Shutdown();
+        return false;
+    }
+
+    m_initialized = true;
+    return true;
+}
+
+void OverlayCompositor::Shutdown()
+{
+    if (m_uploadBuffer && m_uploadMapped) {
+        m_uploadBuffer->Unmap(0, nullptr);
+    }
+    m_uploadMapped = nullptr;
+    m_uploadRetireValue = 0;
+    m_textureWritten = false;
+
+    m_uploadBuffer.Reset();
+    m_texture.Reset();
+    m_srvHeap.Reset();
+    m_pipelineState.Reset();
+    m_rootSignature.Reset();
+    m_fence.Reset();
+    m_device.Reset();
+    m_pipelineCache = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        m_pendingPixels.clear();
+        m_pendingWidth = 0;
+        m_pendingHeight = 0;
+        m_pendingDirty = false;
+    }
+    m_uploadedWidth = 0;
+    m_uploadedHeight = 0;
+    m_initialized = false;
+}
+
+bool OverlayCompositor::CreateRootSignature()
+{
+    // Root parameters:
+    // [0] Root constants - OverlayConstants
+    // [1] Descriptor table - SRV (overlay image)
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.RegisterSpace = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+    D3D12_ROOT_PARAMETER rootParams[2] = {};
+
+    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParams[0].Constants.ShaderRegister = 0;
+    rootParams[0].Constants.RegisterSpace = 0;
+    rootParams[0].Constants.Num32BitValues = OVERLAY_CONSTANT_COUNT;
+    rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
+    rootSigDesc.NumParameters = 2;
+    rootSigDesc.pParameters = rootParams;
+    rootSigDesc.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+    Microsoft::WRL::ComPtr<ID3DBlob> signature;
+    Microsoft::WRL::ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1,
+                                             &signature, &error);
+    if (FAILED(hr)) {
+        if (error) {
+            m_lastError = "Overlay root signature serialization failed: " +
+                         std::string((char*)error->GetBufferPointer());
+        } else {
+            m_lastError = "Overlay root signature serialization failed";
+        }
+        return false;
+    }
+
+    hr = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(),
+                                       IID_PPV_ARGS(&m_rootSignature));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay root signature";
+        return false;
+    }
+
+    return true;
+}
+
+bool OverlayCompositor::CompileShader(const char* entryPoint, const char* target,
+                                      const D3D_SHADER_MACRO* defines, bool allowPrecompiled,
+                                      Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob,
+                                      D3D12_SHADER_BYTECODE& bytecode)
+{
+    // Prefer the DXIL the build compiled; fall back to FXC at runtime
+    if (allowPrecompiled) {
+        if (const osfg::PrecompiledShader* precompiled = FindPrecompiledShader(entryPoint, defines)) {
+            bytecode.pShaderBytecode = precompiled->bytecode;
+            bytecode.BytecodeLength = precompiled->size;
+            return true;
+        }
+    }
+
+    Microsoft::WRL::ComPtr<ID3DBlob> errorBlob;
+
+    UINT compileFlags = 0;
+#if defined(_DEBUG)
+    compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+    HRESULT hr = D3DCompile(g_overlayCompositorShader, strlen(g_overlayCompositorShader),
+                            "OverlayCompositor.hlsl", defines, nullptr, entryPoint, target,
+                            compileFlags, 0, &shaderBlob, &errorBlob);
+    if (FAILED(hr)) {
+        if (errorBlob) {
+            m_lastError = std::string("Overlay shader compilation failed (") + entryPoint + "): " +
+                         std::string((char*)errorBlob->GetBufferPointer());
+        } else {
+            m_lastError = std::string("Overlay shader compilation failed (") + entryPoint + ")";
+        }
+        return false;
+    }
+
+    bytecode.pShaderBytecode = shaderBlob->GetBufferPointer();
+    bytecode.BytecodeLength = shaderBlob->GetBufferSize();
+    return true;
+}
+
+bool OverlayCompositor::CreatePipelineState()
+{
+    // R10G10B10A2 back buffers are HDR10 swap chains (SimplePresenter)
+    const D3D_SHADER_MACRO hdr10Defines[] = { { "HDR10_OUTPUT", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO* psDefines =
+        m_renderTargetFormat == DXGI_FORMAT_R10G10B10A2_UNORM ? hdr10Defines : nullptr;
+
+    // DXIL and DXBC stages cannot be mixed in one PSO
+    const bool precompiled = m_dxilSupported && FindPrecompiledShader("VSQuad", nullptr) &&
+                             FindPrecompiledShader("PSOverlay", psDefines);
+
+    Microsoft::WRL::ComPtr<ID3DBlob> vsBlob;
+    Microsoft::WRL::ComPtr<ID3DBlob> psBlob;
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
+    if (!CompileShader("VSQuad", "vs_5_0", nullptr, precompiled, vsBlob, psoDesc.VS)) return false;
+    if (!CompileShader("PSOverlay", "ps_5_0", psDefines, precompiled, psBlob, psoDesc.PS)) return false;
+
+    // Premultiplied alpha over the frame already in the back buffer
+    D3D12_RENDER_TARGET_BLEND_DESC& blend = psoDesc.BlendState.RenderTarget[0];
+    blend.BlendEnable = TRUE;
+    blend.SrcBlend = D3D12_BLEND_ONE;
+    blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+    blend.BlendOp = D3D12_BLEND_OP_ADD;
+    blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+    blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+    blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    blend.LogicOp = D3D12_LOGIC_OP_NOOP;
+    blend.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+
+    psoDesc.pRootSignature = m_rootSignature.Get();
+    psoDesc.SampleMask = UINT_MAX;
+    psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_SOLID;
+    psoDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+    psoDesc.RasterizerState.DepthClipEnable = TRUE;
+    psoDesc.DepthStencilState.DepthEnable = FALSE;
+    psoDesc.DepthStencilState.StencilEnable = FALSE;
+    psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    psoDesc.NumRenderTargets = 1;
+    psoDesc.RTVFormats[0] = m_renderTargetFormat;
+    psoDesc.SampleDesc.Count = 1;
+
+    HRESULT hr = m_pipelineCache
+        ? m_pipelineCache->CreateGraphicsPipelineState("OverlayCompositor/Blend", psoDesc, m_pipelineState)
+        : m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay pipeline state";
+        return false;
+    }
+
+    return true;
+}
+
+bool OverlayCompositor::CreateResources()
+{
+    // Image texture: written only by uploads, created ready for the first one
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC texDesc = {};
+    texDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    texDesc.Width = MAX_WIDTH;
+    texDesc.Height = MAX_HEIGHT;
+    texDesc.DepthOrArraySize = 1;
+    texDesc.MipLevels = 1;
+    texDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    texDesc.SampleDesc.Count = 1;
+
+    HRESULT hr = m_device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &texDesc,
+                                                   D3D12_RESOURCE_STATE_COPY_DEST, nullptr,
+                                                   IID_PPV_ARGS(&m_texture));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay texture";
+        return false;
+    }
+
+    // Upload buffer holding one full-size image in a placed footprint
+    m_uploadRowPitch = (MAX_WIDTH * BYTES_PER_PIXEL + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
+                       ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+
+    D3D12_HEAP_PROPERTIES uploadHeapProps = {};
+    uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = static_cast<UINT64>(m_uploadRowPitch) * MAX_HEIGHT;
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    hr = m_device->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+                                           D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+                                           IID_PPV_ARGS(&m_uploadBuffer));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay upload buffer";
+        return false;
+    }
+
+    D3D12_RANGE readRange = { 0, 0 };
+    hr = m_uploadBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_uploadMapped));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to map overlay upload buffer";
+        return false;
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = 1;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_srvHeap));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create overlay descriptor heap";
+        return false;
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = texDesc.Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_device->CreateShaderResourceView(m_texture.Get(), &srvDesc,
+                                       m_srvHeap->GetCPUDescriptorHandleForHeapStart());
+
+    return true;
+}
+
+bool OverlayCompositor::SetImage(const void* pixels, uint32_t width, uint32_t height, uint32_t rowPitch,
+                                 int32_t x, int32_t y)
+{
+    if (!pixels || width == 0 || height == 0 || rowPitch < width * BYTES_PER_PIXEL) {
+        m_lastError = "Invalid overlay image";
+        return false;
+    }
+    if (width > MAX_WIDTH || height > MAX_HEIGHT) {
+        m_lastError = "Overlay image larger than " + std::to_string(MAX_WIDTH) + "x" +
+                      std::to_string(MAX_HEIGHT);
+        return false;
+    }
+
+    const uint32_t packedPitch = width * BYTES_PER_PIXEL;
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    m_pendingPixels.resize(static_cast<size_t>(packedPitch) * height);
+    const uint8_t* source = static_cast<const uint8_t*>(pixels);
+    for (uint32_t row = 0; row < height; row++) {
+        memcpy(m_pendingPixels.data() + static_cast<size_t>(row) * packedPitch,
+               source + static_cast<size_t>(row) * rowPitch, packedPitch);
+    }
+    m_pendingWidth = width;
+    m_pendingHeight = height;
+    m_pendingX = x;
+    m_pendingY = y;
+    m_pendingDirty = true;
+    return true;
+}
+
+void OverlayCompositor::RecordUpload(ID3D12GraphicsCommandList* commandList, uint64_t retireValue)
+{
+    // Rewrite the upload buffer only once the list that last copied from it
+    // has retired; otherwise the image waits for a later pass
+    if (!m_initialized || !commandList || m_fence->GetCompletedValue() < m_uploadRetireValue) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_pendingMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !m_pendingDirty) {
+        return;
+    }
+
+    const uint32_t packedPitch = m_pendingWidth * BYTES_PER_PIXEL;
+    for (uint32_t row = 0; row < m_pendingHeight; row++) {
+        memcpy(m_uploadMapped + static_cast<size_t>(row) * m_uploadRowPitch,
+               m_pendingPixels.data() + static_cast<size_t>(row) * packedPitch, packedPitch);
+    }
+    m_uploadedWidth = m_pendingWidth;
+    m_uploadedHeight = m_pendingHeight;
+    m_x = m_pendingX;
+    m_y = m_pendingY;
+    m_pendingDirty = false;
+    lock.unlock();
+
+    // Earlier passes on this queue still reading the texture are ordered before the copy
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = m_texture.Get();
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    if (m_textureWritten) {
+        commandList->ResourceBarrier(1, &barrier);
+    }
+
+    D3D12_TEXTURE_COPY_LOCATION destLoc = {};
+    destLoc.pResource = m_texture.Get();
+    destLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    destLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = m_uploadBuffer.Get();
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLoc.PlacedFootprint.Offset = 0;
+    srcLoc.PlacedFootprint.Footprint.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    srcLoc.PlacedFootprint.Footprint.Width = m_uploadedWidth;
+    srcLoc.PlacedFootprint.Footprint.Height = m_uploadedHeight;
+    srcLoc.PlacedFootprint.Footprint.Depth = 1;
+    srcLoc.PlacedFootprint.Footprint.RowPitch = m_uploadRowPitch;
+
+    commandList->CopyTextureRegion(&destLoc, 0, 0, 0, &srcLoc, nullptr);
+
+    std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+    commandList->ResourceBarrier(1, &barrier);
+
+    m_textureWritten = true;
+    m_uploadRetireValue = retireValue;
+}
+
+void OverlayCompositor::Record(ID3D12GraphicsCommandList* commandList, D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                               uint32_t targetWidth, uint32_t targetHeight)
+{
+    if (!m_initialized || !commandList || renderTarget.ptr == 0 || targetWidth == 0 || targetHeight == 0) {
+        return;
+    }
+
+    if (!HasImage()) {
+        return;
+    }
+
+    // Clipped to the target: an image hanging over an edge is cut, not squeezed
+    const LONG imageRight = static_cast<LONG>(m_x) + static_cast<LONG>(m_uploadedWidth);
+    const LONG imageBottom = static_cast<LONG>(m_y) + static_cast<LONG>(m_uploadedHeight);
+    const LONG left = (std::max)(0L, static_cast<LONG>(m_x));
+    const LONG top = (std::max)(0L, static_cast<LONG>(m_y));
+    const LONG right = (std::min)(static_cast<LONG>(targetWidth), imageRight);
+    const LONG bottom = (std::min)(static_cast<LONG>(targetHeight), imageBottom);
+    if (right <= left || bottom <= top) {
+        return;
+    }
+
+    OverlayConstants constants = {};
+    constants.originX = static_cast<float>(m_x);
+    constants.originY = static_cast<float>(m_y);
+    constants.width = static_cast<float>(m_uploadedWidth);
+    constants.height = static_cast<float>(m_uploadedHeight);
+    constants.targetWidth = static_cast<float>(targetWidth);
+    constants.targetHeight = static_cast<float>(targetHeight);
+
+    commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(m_pipelineState.Get());
+
+    ID3D12DescriptorHeap* heaps[] = { m_srvHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetGraphicsRoot32BitConstants(0, OVERLAY_CONSTANT_COUNT, &constants, 0);
+    commandList->SetGraphicsRootDescriptorTable(1, m_srvHeap->GetGPUDescriptorHandleForHeapStart());
+
+    D3D12_VIEWPORT viewport = { 0.0f, 0.0f, static_cast<float>(targetWidth),
+                                static_cast<float>(targetHeight), 0.0f, 1.0f };
+    D3D12_RECT scissor = { left, top, right, bottom };
+    commandList->RSSetViewports(1, &viewport);
+    commandList->RSSetScissorRects(1, &scissor);
+    commandList->OMSetRenderTargets(1, &renderTarget, FALSE, nullptr);
+    commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    commandList->DrawInstanced(4, 1, 0, 0);
+}
+
+} // namespace OSFG
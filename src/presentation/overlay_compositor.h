@@ -0,0 +1,134 @@
+// OSFG Overlay Compositor
+// Blends a small pre-rasterized image (the statistics overlay) into the back
+// buffer inside the present pass, on the presenter's own D3D12 queue
+// MIT License - Part of Open Source Frame Generation project
+//
+// The image is rasterized on the CPU by its owner (StatsOverlay's bitmap
+// mode) only when its text changes, and handed over with SetImage() from
+// any thread. The present thread uploads a new image at its next pass and
+// otherwise only records one alpha-blended quad per presented frame: no
+// D3D11/D2D device, no 11-on-12 wrapping and no extra submissions.
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace osfg {
+    class PipelineCache;
+}
+
+namespace OSFG {
+
+class OverlayCompositor {
+public:
+    // Largest image SetImage() accepts (texture and upload buffer are sized for it)
+    static const uint32_t MAX_WIDTH = 1024;
+    static const uint32_t MAX_HEIGHT = 1024;
+
+    OverlayCompositor();
+    ~OverlayCompositor();
+
+    // Non-copyable
+    OverlayCompositor(const OverlayCompositor&) = delete;
+    OverlayCompositor& operator=(const OverlayCompositor&) = delete;
+
+    // device: the presenting device; renderTargetFormat: back buffer format
+    // (R10G10B10A2_UNORM: HDR10, the image is converted to PQ).
+    // fence: the fence the present lists signal, used to tell when the
+    // upload buffer may be rewritten.
+    bool Initialize(ID3D12Device* device, DXGI_FORMAT renderTargetFormat, ID3D12Fence* fence,
+                    osfg::PipelineCache* pipelineCache = nullptr);
+
+    // Shutdown (the GPU must be done with the present lists)
+    void Shutdown();
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // Replace the image: premultiplied BGRA8, drawn with its top-left corner
+    // at (x, y) of the back buffer. Any thread; copied, so `pixels` may be
+    // reused at once. Never blocks the present thread.
+    bool SetImage(const void* pixels, uint32_t width, uint32_t height, uint32_t rowPitch,
+                  int32_t x, int32_t y);
+
+    // Show or hide the image (any thread)
+    void SetVisible(bool visible) { m_visible = visible; }
+    bool IsVisible() const { return m_visible; }
+
+    // Record the copy of a pending image into a present list (present
+    // thread), if the previous upload has retired. retireValue: the fence
+    // value this list signals. Records nothing when no image is pending.
+    void RecordUpload(ID3D12GraphicsCommandList* commandList, uint64_t retireValue);
+
+    // Blend the current image into `renderTarget` (RENDER_TARGET state, of
+    // targetWidth x targetHeight) in the same list, after RecordUpload().
+    // Records nothing while hidden or before the first upload.
+    void Record(ID3D12GraphicsCommandList* commandList, D3D12_CPU_DESCRIPTOR_HANDLE renderTarget,
+                uint32_t targetWidth, uint32_t targetHeight);
+
+    // True if Record() would draw (visible and an image has been uploaded)
+    bool HasImage() const { return m_visible && m_uploadedWidth > 0; }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool CreateRootSignature();
+    bool CreatePipelineState();
+    bool CreateResources();
+    bool CompileShader(const char* entryPoint, const char* target, const D3D_SHADER_MACRO* defines,
+                       bool allowPrecompiled, Microsoft::WRL::ComPtr<ID3DBlob>& shaderBlob,
+                       D3D12_SHADER_BYTECODE& bytecode);
+
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> m_pipelineState;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_srvHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_texture;       // Rests in PIXEL_SHADER_RESOURCE
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_uploadBuffer;  // Persistently mapped
+    uint8_t* m_uploadMapped = nullptr;
+    uint32_t m_uploadRowPitch = 0;
+    uint64_t m_uploadRetireValue = 0;                       // Last list reading m_uploadBuffer
+    bool m_textureWritten = false;
+
+    DXGI_FORMAT m_renderTargetFormat = DXGI_FORMAT_UNKNOWN;
+    osfg::PipelineCache* m_pipelineCache = nullptr;
+    bool m_dxilSupported = false;
+
+    // Image handed over by SetImage(), tightly packed. The present thread
+    // only try-locks, so a writer holding it just delays the upload a frame.
+    std::mutex m_pendingMutex;
+    std::vector<uint8_t> m_pendingPixels;
+    uint32_t m_pendingWidth = 0;
+    uint32_t m_pendingHeight = 0;
+    int32_t m_pendingX = 0;
+    int32_t m_pendingY = 0;
+    bool m_pendingDirty = false;
+
+    // Image in m_texture (present thread)
+    uint32_t m_uploadedWidth = 0;
+    uint32_t m_uploadedHeight = 0;
+    int32_t m_x = 0;
+    int32_t m_y = 0;
+
+    std::atomic<bool> m_visible{true};
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace OSFG
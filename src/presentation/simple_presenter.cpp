@@ -3,6 +3,7 @@
 // MIT License - Part of Open Source Frame Generation project
 
 #include "simple_presenter.h"
+#include <algorithm>
 #include <chrono>
 
 namespace OSFG {
@@ -38,12 +39,23 @@ bool SimplePresenter::Initialize(ID3D12Device* device,
     m_device = device;
     m_commandQueue = commandQueue;
     m_config = config;
+    m_vsync.store(config.vsync, std::memory_order_relaxed);
+    m_config.bufferCount = (std::max)(2u, (std::min)(m_config.bufferCount,
+                                                     static_cast<uint32_t>(MAX_BACK_BUFFERS)));
 
     // Create components in order
     if (!CreatePresenterWindow()) return false;
+
+    // Window only: Present/Flip/BeginRenderTarget are unavailable
+    if (!m_config.createSwapChain) {
+        m_initialized = true;
+        return true;
+    }
+
     if (!CreateSwapChain()) return false;
     if (!CreateRenderTargets()) return false;
     if (!CreateSyncObjects()) return false;
+    QueryRefreshRate();
 
     m_initialized = true;
     m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
@@ -63,6 +75,16 @@ void SimplePresenter::Shutdown()
         CloseHandle(m_fenceEvent);
         m_fenceEvent = nullptr;
     }
+    if (m_frameLatencyWaitable) {
+        CloseHandle(m_frameLatencyWaitable);
+        m_frameLatencyWaitable = nullptr;
+    }
+    m_refreshRateHz = 0.0;
+    m_tearingEnabled = false;
+    m_lastStatsPresentCount = 0;
+    for (auto& pending : m_pendingPresents) {
+        pending = PendingPresent{};
+    }
 
     // Release resources
     for (int i = 0; i < MAX_BACK_BUFFERS; i++) {
@@ -80,7 +102,7 @@ void SimplePresenter::Shutdown()
         m_hwnd = nullptr;
     }
 
-    // Unregister window class
+    // Unregister window class (fails while another presenter's window uses it)
     if (m_hinstance) {
         UnregisterClassW(WINDOW_CLASS_NAME, m_hinstance);
         m_hinstance = nullptr;
@@ -89,6 +111,57 @@ void SimplePresenter::Shutdown()
     m_initialized = false;
 }
 
+bool SimplePresenter::Resize(uint32_t width, uint32_t height)
+{
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (width == m_config.width && height == m_config.height) {
+        return true;
+    }
+
+    if (!m_swapChain) {
+        m_config.width = width;
+        m_config.height = height;
+        return true;
+    }
+
+    // ResizeBuffers needs the queue idle and every back buffer released
+    WaitForGPU();
+    for (int i = 0; i < MAX_BACK_BUFFERS; i++) {
+        m_backBuffers[i].Reset();
+    }
+    m_rtvHeap.Reset();
+
+    DXGI_SWAP_CHAIN_DESC1 desc = {};
+    m_swapChain->GetDesc1(&desc);
+    HRESULT hr = m_swapChain->ResizeBuffers(m_config.bufferCount, width, height,
+                                            GetBackBufferFormat(), desc.Flags);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to resize swap chain buffers";
+        return false;
+    }
+
+    m_config.width = width;
+    m_config.height = height;
+    if (!CreateRenderTargets()) {
+        return false;
+    }
+
+    // The back buffer index restarts; every buffer is free (WaitForGPU
+    // reached the value below the current one)
+    const UINT64 nextFenceValue = m_fenceValues[m_frameIndex];
+    m_frameIndex = m_swapChain->GetCurrentBackBufferIndex();
+    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
+        m_fenceValues[i] = nextFenceValue - 1;
+    }
+    m_fenceValues[m_frameIndex] = nextFenceValue;
+
+    return true;
+}
+
 bool SimplePresenter::IsWindowOpen() const
 {
     return m_hwnd != nullptr && !m_windowClosed && IsWindow(m_hwnd);
@@ -109,9 +182,10 @@ bool SimplePresenter::ProcessMessages()
 }
 
 bool SimplePresenter::Present(ID3D12Resource* sourceTexture,
-                               ID3D12GraphicsCommandList* commandList)
+                               ID3D12GraphicsCommandList* commandList,
+                               D3D12_RESOURCE_STATES sourceState)
 {
-    if (!m_initialized || !sourceTexture || !commandList) {
+    if (!m_initialized || !m_swapChain || !sourceTexture || !commandList) {
         m_lastError = "Invalid parameters or not initialized";
         return false;
     }
@@ -125,7 +199,7 @@ bool SimplePresenter::Present(ID3D12Resource* sourceTexture,
     // Source texture: PIXEL_SHADER_RESOURCE/COMMON -> COPY_SOURCE
     barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
     barriers[0].Transition.pResource = sourceTexture;
-    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barriers[0].Transition.StateBefore = sourceState;
     barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
     barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
 
@@ -160,9 +234,9 @@ bool SimplePresenter::Present(ID3D12Resource* sourceTexture,
     commandList->CopyTextureRegion(&destLoc, 0, 0, 0, &srcLoc, &srcBox);
 
     // Transition both textures back
-    // Source texture: COPY_SOURCE -> PIXEL_SHADER_RESOURCE
+    // Source texture: COPY_SOURCE -> its original state
     barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_SOURCE;
-    barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barriers[0].Transition.StateAfter = sourceState;
 
     // Back buffer: COPY_DEST -> PRESENT
     barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
@@ -173,11 +247,63 @@ bool SimplePresenter::Present(ID3D12Resource* sourceTexture,
     return true;
 }
 
+D3D12_CPU_DESCRIPTOR_HANDLE SimplePresenter::BeginRenderTarget(ID3D12GraphicsCommandList* commandList)
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = {};
+    if (!m_initialized || !m_swapChain || !commandList) {
+        m_lastError = "Invalid parameters or not initialized";
+        return rtvHandle;
+    }
+
+    // Back buffer: PRESENT -> RENDER_TARGET
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = m_backBuffers[m_frameIndex].Get();
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    commandList->ResourceBarrier(1, &barrier);
+
+    rtvHandle = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+    rtvHandle.ptr += static_cast<SIZE_T>(m_frameIndex) * m_rtvDescriptorSize;
+    return rtvHandle;
+}
+
+void SimplePresenter::EndRenderTarget(ID3D12GraphicsCommandList* commandList)
+{
+    if (!m_initialized || !m_swapChain || !commandList) {
+        return;
+    }
+
+    // Back buffer: RENDER_TARGET -> PRESENT
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = m_backBuffers[m_frameIndex].Get();
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    commandList->ResourceBarrier(1, &barrier);
+}
+
+bool SimplePresenter::WaitForFrameLatency(DWORD timeoutMs)
+{
+    if (!m_frameLatencyWaitable) {
+        return true;
+    }
+    return WaitForSingleObjectEx(m_frameLatencyWaitable, timeoutMs, TRUE) == WAIT_OBJECT_0;
+}
+
 ID3D12Resource* SimplePresenter::GetCurrentBackBuffer()
 {
     return m_backBuffers[m_frameIndex].Get();
 }
 
+void SimplePresenter::SetPresentSource(int64_t sourceQpc, bool generated)
+{
+    m_nextSourceQpc = sourceQpc;
+    m_nextGenerated = generated;
+}
+
 bool SimplePresenter::Flip(uint32_t syncInterval, uint32_t flags)
 {
     if (!m_initialized || !m_swapChain) {
@@ -185,13 +311,18 @@ bool SimplePresenter::Flip(uint32_t syncInterval, uint32_t flags)
         return false;
     }
 
-    // Present the frame
+    // VRR presents at once and the display follows the caller's pacing;
+    // vsync always waits one vblank; otherwise the caller picks the interval
+    const UINT interval = m_config.variableRefresh ? 0 : (m_vsync.load(std::memory_order_relaxed) ? 1 : syncInterval);
     UINT presentFlags = flags;
-    if (!m_config.vsync && syncInterval == 0) {
+    if (interval == 0 && m_tearingEnabled) {
         presentFlags |= DXGI_PRESENT_ALLOW_TEARING;
     }
 
-    HRESULT hr = m_swapChain->Present(m_config.vsync ? 1 : syncInterval, presentFlags);
+    LARGE_INTEGER submitTime;
+    QueryPerformanceCounter(&submitTime);
+
+    HRESULT hr = m_swapChain->Present(interval, presentFlags);
     if (FAILED(hr)) {
         if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET) {
             m_lastError = "Device lost during present";
@@ -201,6 +332,15 @@ bool SimplePresenter::Flip(uint32_t syncInterval, uint32_t flags)
         return false;
     }
 
+    UINT presentCount = 0;
+    if (SUCCEEDED(m_swapChain->GetLastPresentCount(&presentCount))) {
+        m_pendingPresents[presentCount % LATENCY_HISTORY] =
+            { presentCount, submitTime.QuadPart, m_nextSourceQpc, m_nextGenerated };
+    }
+    m_nextSourceQpc = 0;
+    m_nextGenerated = false;
+    UpdateDisplayLatency();
+
     // Update statistics
     LARGE_INTEGER currentTime;
     QueryPerformanceCounter(&currentTime);
@@ -250,7 +390,8 @@ bool SimplePresenter::CreatePresenterWindow()
     wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
     wc.lpszClassName = WINDOW_CLASS_NAME;
 
-    if (!RegisterClassExW(&wc)) {
+    // Several presenters (one per output) share the class
+    if (!RegisterClassExW(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS) {
         m_lastError = "Failed to register window class";
         return false;
     }
@@ -263,11 +404,14 @@ bool SimplePresenter::CreatePresenterWindow()
     int windowWidth = rect.right - rect.left;
     int windowHeight = rect.bottom - rect.top;
 
-    // Center on screen
-    int screenWidth = GetSystemMetrics(SM_CXSCREEN);
-    int screenHeight = GetSystemMetrics(SM_CYSCREEN);
-    int x = (screenWidth - windowWidth) / 2;
-    int y = (screenHeight - windowHeight) / 2;
+    // Center on the monitor
+    RECT screen = { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
+    MONITORINFO monitorInfo = { sizeof(MONITORINFO) };
+    if (m_config.monitor && GetMonitorInfoW(m_config.monitor, &monitorInfo)) {
+        screen = monitorInfo.rcMonitor;
+    }
+    int x = screen.left + (screen.right - screen.left - windowWidth) / 2;
+    int y = screen.top + (screen.bottom - screen.top - windowHeight) / 2;
 
     // Create window
     m_hwnd = CreateWindowExW(
@@ -308,7 +452,7 @@ bool SimplePresenter::CreateSwapChain()
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
     swapChainDesc.Width = m_config.width;
     swapChainDesc.Height = m_config.height;
-    swapChainDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    swapChainDesc.Format = GetBackBufferFormat();
     swapChainDesc.Stereo = FALSE;
     swapChainDesc.SampleDesc.Count = 1;
     swapChainDesc.SampleDesc.Quality = 0;
@@ -317,7 +461,23 @@ bool SimplePresenter::CreateSwapChain()
     swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
     swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
     swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
-    swapChainDesc.Flags = 0;
+    swapChainDesc.Flags = m_config.maxFrameLatency > 0 ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+
+    // Tearing presents (VRR, or vsync off) need the flag at creation;
+    // DXGI_PRESENT_ALLOW_TEARING is invalid on a swap chain without it
+    m_tearingEnabled = false;
+    if (m_config.variableRefresh || !m_config.vsync) {
+        Microsoft::WRL::ComPtr<IDXGIFactory5> factory5;
+        BOOL allowTearing = FALSE;
+        if (SUCCEEDED(factory.As(&factory5)) &&
+            SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING,
+                                                    &allowTearing, sizeof(allowTearing)))) {
+            m_tearingEnabled = allowTearing == TRUE;
+        }
+    }
+    if (m_tearingEnabled) {
+        swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
 
     Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain1;
     hr = factory->CreateSwapChainForHwnd(
@@ -344,6 +504,30 @@ bool SimplePresenter::CreateSwapChain()
         return false;
     }
 
+    // HDR10: tell DWM the buffers hold BT.2020 PQ. Only outputs in HDR mode
+    // support presenting it.
+    if (m_config.hdr10) {
+        const DXGI_COLOR_SPACE_TYPE colorSpace = DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+        UINT support = 0;
+        if (FAILED(m_swapChain->CheckColorSpaceSupport(colorSpace, &support)) ||
+            !(support & DXGI_SWAP_CHAIN_COLOR_SPACE_SUPPORT_FLAG_PRESENT) ||
+            FAILED(m_swapChain->SetColorSpace1(colorSpace))) {
+            m_lastError = "HDR10 colour space not supported by this output";
+            return false;
+        }
+    }
+
+    // Frame latency waitable: the caller blocks before recording a frame
+    // instead of inside Present(), so pacing decisions use fresh timing
+    if (m_config.maxFrameLatency > 0) {
+        hr = m_swapChain->SetMaximumFrameLatency(m_config.maxFrameLatency);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to set maximum frame latency";
+            return false;
+        }
+        m_frameLatencyWaitable = m_swapChain->GetFrameLatencyWaitableObject();
+    }
+
     return true;
 }
 
@@ -402,6 +586,92 @@ bool SimplePresenter::CreateSyncObjects()
     return true;
 }
 
+void SimplePresenter::QueryRefreshRate()
+{
+    // Current display mode of the output containing the window
+    m_refreshRateHz = 0.0;
+
+    Microsoft::WRL::ComPtr<IDXGIOutput> output;
+    if (FAILED(m_swapChain->GetContainingOutput(&output))) {
+        return;
+    }
+
+    DXGI_OUTPUT_DESC outputDesc = {};
+    if (FAILED(output->GetDesc(&outputDesc))) {
+        return;
+    }
+
+    DEVMODEW devMode = {};
+    devMode.dmSize = sizeof(devMode);
+    if (!EnumDisplaySettingsW(outputDesc.DeviceName, ENUM_CURRENT_SETTINGS, &devMode) ||
+        devMode.dmDisplayFrequency <= 1) {
+        return;
+    }
+    m_refreshRateHz = static_cast<double>(devMode.dmDisplayFrequency);
+
+    // dmDisplayFrequency is rounded (59 for 59.94 Hz); the matching DXGI
+    // mode carries the exact rational rate
+    DXGI_MODE_DESC wanted = {};
+    wanted.Width = devMode.dmPelsWidth;
+    wanted.Height = devMode.dmPelsHeight;
+    wanted.RefreshRate.Numerator = devMode.dmDisplayFrequency;
+    wanted.RefreshRate.Denominator = 1;
+    wanted.Format = GetBackBufferFormat();
+
+    DXGI_MODE_DESC closest = {};
+    if (SUCCEEDED(output->FindClosestMatchingMode(&wanted, &closest, nullptr)) &&
+        closest.RefreshRate.Denominator > 0) {
+        const double exactHz = static_cast<double>(closest.RefreshRate.Numerator) /
+                               closest.RefreshRate.Denominator;
+        if (exactHz > m_refreshRateHz - 1.0 && exactHz < m_refreshRateHz + 1.0) {
+            m_refreshRateHz = exactHz;
+        }
+    }
+}
+
+void SimplePresenter::UpdateDisplayLatency()
+{
+    // Fails while statistics are disjoint (mode changes, composition
+    // changes); the next successful call picks up again
+    DXGI_FRAME_STATISTICS frameStats = {};
+    if (FAILED(m_swapChain->GetFrameStatistics(&frameStats)) ||
+        frameStats.PresentCount == m_lastStatsPresentCount) {
+        return;
+    }
+    m_lastStatsPresentCount = frameStats.PresentCount;
+
+    const PendingPresent& pending = m_pendingPresents[frameStats.PresentCount % LATENCY_HISTORY];
+    if (pending.presentCount != frameStats.PresentCount || frameStats.SyncQPCTime.QuadPart <= pending.qpc) {
+        return;
+    }
+
+    const double latencyMs = 1000.0 * (frameStats.SyncQPCTime.QuadPart - pending.qpc) / m_frequency.QuadPart;
+    m_stats.lastDisplayLatencyMs = latencyMs;
+
+    const double alpha = 0.1;
+    if (m_stats.avgDisplayLatencyMs == 0.0) {
+        m_stats.avgDisplayLatencyMs = latencyMs;
+    } else {
+        m_stats.avgDisplayLatencyMs = m_stats.avgDisplayLatencyMs * (1.0 - alpha) + latencyMs * alpha;
+    }
+
+    // Glass to glass: the source's present of the content to its scan-out
+    if (pending.sourceQpc <= 0 || frameStats.SyncQPCTime.QuadPart <= pending.sourceQpc) {
+        return;
+    }
+
+    const double glassMs = 1000.0 * (frameStats.SyncQPCTime.QuadPart - pending.sourceQpc) / m_frequency.QuadPart;
+    m_stats.lastGlassLatencyMs = glassMs;
+    m_stats.glassLatencySamples++;
+
+    double& average = pending.generated ? m_stats.avgGlassLatencyGeneratedMs : m_stats.avgGlassLatencyRealMs;
+    if (average == 0.0) {
+        average = glassMs;
+    } else {
+        average = average * (1.0 - alpha) + glassMs * alpha;
+    }
+}
+
 void SimplePresenter::WaitForGPU()
 {
     if (!m_fence || !m_commandQueue) return;
@@ -15,6 +15,7 @@
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include <wrl/client.h>
+#include <atomic>
 #include <cstdint>
 #include <string>
 
@@ -24,10 +25,15 @@ namespace OSFG {
 struct PresenterConfig {
     uint32_t width = 1920;
     uint32_t height = 1080;
-    uint32_t bufferCount = 2;
+    uint32_t bufferCount = 2;           // Swap chain buffers (2..MAX_BACK_BUFFERS)
     bool vsync = true;
+    bool variableRefresh = false;       // VRR: tearing allowed, sync interval 0, paced by the caller
     bool windowed = true;
     const wchar_t* windowTitle = L"OSFG Frame Generation";
+    uint32_t maxFrameLatency = 1;       // Queued presents before WaitForFrameLatency() blocks (0 = no waitable)
+    bool createSwapChain = true;        // false: window only, another swap chain (FFX) presents to it
+    bool hdr10 = false;                 // HDR10_BACK_BUFFER_FORMAT in the BT.2020 PQ colour space
+    HMONITOR monitor = nullptr;         // Centre the window on this monitor (nullptr = primary)
 };
 
 // Statistics
@@ -36,10 +42,26 @@ struct PresenterStats {
     double lastPresentTimeMs = 0.0;
     double avgPresentTimeMs = 0.0;
     double fps = 0.0;
+    double lastDisplayLatencyMs = 0.0;  // Present() call to scan-out (GetFrameStatistics)
+    double avgDisplayLatencyMs = 0.0;
+
+    // Glass-to-glass: source present (SetPresentSource()) to scan-out,
+    // split by whether the flip showed a real or a generated frame
+    double lastGlassLatencyMs = 0.0;
+    double avgGlassLatencyRealMs = 0.0;
+    double avgGlassLatencyGeneratedMs = 0.0;
+    uint64_t glassLatencySamples = 0;   // Flips matched to a scan-out time
 };
 
 class SimplePresenter {
 public:
+    static const uint32_t MAX_BACK_BUFFERS = 4;
+
+    // Swap-chain formats (render targets drawn by BeginRenderTarget() callers
+    // must be created for the one in use, see GetBackBufferFormat())
+    static const DXGI_FORMAT BACK_BUFFER_FORMAT = DXGI_FORMAT_B8G8R8A8_UNORM;
+    static const DXGI_FORMAT HDR10_BACK_BUFFER_FORMAT = DXGI_FORMAT_R10G10B10A2_UNORM;
+
     SimplePresenter();
     ~SimplePresenter();
 
@@ -55,6 +77,11 @@ public:
     // Shutdown
     void Shutdown();
 
+    // Resize the swap chain buffers to a new source size. Waits for the
+    // queue to go idle; no back buffer may be referenced by pending work.
+    // The window keeps its size (the swap chain scales to it).
+    bool Resize(uint32_t width, uint32_t height);
+
     // Check if initialized
     bool IsInitialized() const { return m_initialized; }
 
@@ -65,15 +92,50 @@ public:
     bool ProcessMessages();
 
     // Present a frame
-    // sourceTexture: The texture to display (must be in PIXEL_SHADER_RESOURCE or COPY_SOURCE state)
+    // sourceTexture: The texture to display, in sourceState; returned to that state
     // commandList: Command list to record copy commands (will be closed and executed)
     bool Present(ID3D12Resource* sourceTexture,
-                 ID3D12GraphicsCommandList* commandList);
+                 ID3D12GraphicsCommandList* commandList,
+                 D3D12_RESOURCE_STATES sourceState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    // Draw straight into the current back buffer instead of copying into it
+    // BeginRenderTarget: PRESENT -> RENDER_TARGET, returns the back buffer's RTV
+    // EndRenderTarget: RENDER_TARGET -> PRESENT (record before the list executes)
+    D3D12_CPU_DESCRIPTOR_HANDLE BeginRenderTarget(ID3D12GraphicsCommandList* commandList);
+    void EndRenderTarget(ID3D12GraphicsCommandList* commandList);
 
     // Execute swap chain present and advance to next frame
     // Call this after executing the command list from Present()
     bool Flip(uint32_t syncInterval = 1, uint32_t flags = 0);
 
+    // Tag the next Flip() with the QPC time its content was presented by the
+    // source (capture LastPresentTime; 0 leaves it untagged) and whether it
+    // is a generated frame. Matched against the scan-out time for
+    // PresenterStats glass latency.
+    void SetPresentSource(int64_t sourceQpc, bool generated);
+
+    // Block until the swap chain can take another frame without exceeding
+    // config.maxFrameLatency queued presents (frame latency waitable object).
+    // Returns true at once when the swap chain has no waitable object.
+    bool WaitForFrameLatency(DWORD timeoutMs = 1000);
+
+    // Refresh rate of the output the window is on (0 if unknown, or the
+    // presenter has no swap chain), read at initialization
+    double GetRefreshRateHz() const { return m_refreshRateHz; }
+
+    // True when the swap chain was created for tearing presents (VRR or
+    // vsync off, and DXGI_FEATURE_PRESENT_ALLOW_TEARING supported)
+    bool IsTearingEnabled() const { return m_tearingEnabled; }
+
+    // Switch vsync from the next Flip() on (any thread). Presents without
+    // vsync only tear on a swap chain created for it (IsTearingEnabled()).
+    void SetVsync(bool vsync) { m_vsync.store(vsync, std::memory_order_relaxed); }
+
+    // Format of the back buffers (config.hdr10 selects HDR10_BACK_BUFFER_FORMAT)
+    DXGI_FORMAT GetBackBufferFormat() const {
+        return m_config.hdr10 ? HDR10_BACK_BUFFER_FORMAT : BACK_BUFFER_FORMAT;
+    }
+
     // Get current back buffer for rendering
     ID3D12Resource* GetCurrentBackBuffer();
     uint32_t GetCurrentBackBufferIndex() const { return m_frameIndex; }
@@ -96,6 +158,8 @@ private:
     bool CreateSwapChain();
     bool CreateRenderTargets();
     bool CreateSyncObjects();
+    void QueryRefreshRate();
+    void UpdateDisplayLatency();
     void WaitForGPU();
 
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
@@ -107,7 +171,6 @@ private:
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
 
     // Back buffers
-    static const uint32_t MAX_BACK_BUFFERS = 3;
     Microsoft::WRL::ComPtr<ID3D12Resource> m_backBuffers[MAX_BACK_BUFFERS];
     uint32_t m_rtvDescriptorSize = 0;
 
@@ -115,6 +178,25 @@ private:
     Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
     UINT64 m_fenceValues[MAX_BACK_BUFFERS] = {};
     HANDLE m_fenceEvent = nullptr;
+    HANDLE m_frameLatencyWaitable = nullptr;
+    double m_refreshRateHz = 0.0;
+    bool m_tearingEnabled = false;
+    std::atomic<bool> m_vsync{true};    // config.vsync, or SetVsync()
+
+    // Present-to-display latency: QPC time of recent Present() calls (and
+    // their source present) keyed by present count, matched against
+    // GetFrameStatistics() after each flip
+    struct PendingPresent {
+        UINT presentCount = 0;
+        LONGLONG qpc = 0;
+        LONGLONG sourceQpc = 0;
+        bool generated = false;
+    };
+    static const uint32_t LATENCY_HISTORY = 16;
+    PendingPresent m_pendingPresents[LATENCY_HISTORY];
+    UINT m_lastStatsPresentCount = 0;
+    LONGLONG m_nextSourceQpc = 0;       // SetPresentSource() for the next Flip()
+    bool m_nextGenerated = false;
 
     // Window
     HWND m_hwnd = nullptr;
@@ -92,6 +92,18 @@ bool GPUTransfer::Initialize(const TransferConfig& config) {
         return false;
     }
 
+    // Non-fatal: without an arena resources are committed one by one
+    m_sourceArena = config.sourceArena;
+    m_destArena = config.destArena;
+    if (!m_sourceArena) {
+        m_ownSourceArena.Initialize(m_sourceDevice.Get());
+        m_sourceArena = &m_ownSourceArena;
+    }
+    if (!m_destArena) {
+        m_ownDestArena.Initialize(m_destDevice.Get());
+        m_destArena = &m_ownDestArena;
+    }
+
     // Determine transfer method
     bool crossAdapterSupported = IsPeerToPeerAvailable(config.sourceAdapterIndex, config.destAdapterIndex);
 
@@ -127,6 +139,14 @@ bool GPUTransfer::Initialize(const TransferConfig& config) {
         return false;
     }
 
+    // Create shared textures for an external (capture) device to write into
+    if (config.createIngestTextures && !CreateIngestResources()) {
+        Shutdown();
+        return false;
+    }
+
+    m_dirtyRegions.Initialize(m_config.bufferCount, m_config.width, m_config.height);
+
     m_initialized = true;
     ResetStats();
     return true;
@@ -151,39 +171,219 @@ void GPUTransfer::Shutdown() {
         CloseHandle(m_sharedFenceHandle);
         m_sharedFenceHandle = nullptr;
     }
+    if (m_ingestFenceHandle) {
+        CloseHandle(m_ingestFenceHandle);
+        m_ingestFenceHandle = nullptr;
+    }
+
+    // Command rings reference the fences, so drain them first
+    m_sourceCommandRing.Shutdown();
+    m_destCommandRing.Shutdown();
+    m_decodeCommandRing.Shutdown();
+    m_sourceProfiler.Shutdown();
+    m_destProfiler.Shutdown();
 
     // Release resources
-    m_crossAdapterTextures.clear();
-    m_destTextures.clear();
-    m_crossAdapterHeap.Reset();
-    m_sourceReadbackBuffer.Reset();
-    m_destUploadBuffer.Reset();
+    ReleaseFrameResources();
+    m_ingestFence.Reset();
+    m_copyEngine.Shutdown();
+    m_encoder.Shutdown();
+    m_decoder.Shutdown();
 
+    m_destSharedFence.Reset();
     m_sharedFence.Reset();
     m_sourceFence.Reset();
     m_destFence.Reset();
 
-    m_sourceCommandList.Reset();
-    m_sourceCommandAllocator.Reset();
+    m_ownSourceArena.Shutdown();
+    m_ownDestArena.Shutdown();
+    m_sourceArena = nullptr;
+    m_destArena = nullptr;
+
     m_sourceCommandQueue.Reset();
     m_sourceDevice.Reset();
 
-    m_destCommandList.Reset();
-    m_destCommandAllocator.Reset();
+    m_destComputeQueue.Reset();
+    m_destCopyQueue.Reset();
     m_destCommandQueue.Reset();
     m_destDevice.Reset();
 
-    m_stagingMemory = nullptr;
-    m_stagingSize = 0;
     m_initialized = false;
     m_transferMethod = TransferMethod::Unknown;
+    m_encoding = TransferEncoding::BGRA8;
+}
+
+void GPUTransfer::ReleaseFrameResources() {
+    for (HANDLE handle : m_ingestTextureHandles) {
+        if (handle) {
+            CloseHandle(handle);
+        }
+    }
+    m_ingestTextureHandles.clear();
+    m_ingestTextures.clear();
+    m_ingestRetireValues.clear();
+    if (m_ingestUploadData) {
+        m_ingestUploadBuffer->Unmap(0, nullptr);
+        m_ingestUploadData = nullptr;
+    }
+    m_ingestUploadBuffer.Reset();
+
+    m_crossAdapterTextures.clear();
+    m_destSharedTextures.clear();
+    m_destTextures.clear();
+    m_crossAdapterHeap.Reset();
+    m_packedBuffer.Reset();
+    m_packedSize = 0;
+    for (auto& slot : m_stagingSlots) {
+        if (slot.readbackData) {
+            D3D12_RANGE noWrite = { 0, 0 };
+            slot.readbackBuffer->Unmap(0, &noWrite);
+        }
+        if (slot.uploadData) {
+            slot.uploadBuffer->Unmap(0, nullptr);
+        }
+    }
+    m_stagingSlots.clear();
+    m_stagingSize = 0;
+    m_stagingRowPitch = 0;
+
+    if (m_sourceArena) {
+        m_sourceArena->Release(this);
+    }
+    if (m_destArena) {
+        m_destArena->Release(this);
+    }
+}
+
+bool GPUTransfer::Resize(uint32_t width, uint32_t height, uint32_t bufferCount) {
+    if (!m_initialized) {
+        SetError("Not initialized");
+        return false;
+    }
+
+    if (bufferCount == 0) {
+        bufferCount = m_config.bufferCount;
+    }
+    if (width == m_config.width && height == m_config.height && bufferCount == m_config.bufferCount) {
+        return true;
+    }
+
+    // Destination copies are ordered after the source side, so this also
+    // covers the source queue
+    WaitForTransfer();
+
+    ReleaseFrameResources();
+    m_config.width = width;
+    m_config.height = height;
+    m_config.bufferCount = bufferCount;
+
+    const bool created = m_transferMethod == TransferMethod::CrossAdapterHeap ?
+        CreateCrossAdapterResources() : CreateStagingResources();
+    if (!created || (m_config.createIngestTextures && !CreateIngestTextures())) {
+        m_initialized = false;
+        return false;
+    }
+
+    // Heaps the new layout did not reuse. The destination arena is shared
+    // with the modules placing their own resources in it; they trim it.
+    m_sourceArena->Trim();
+
+    m_dirtyRegions.Initialize(m_config.bufferCount, m_config.width, m_config.height);
+    m_currentBuffer = 0;
+    m_previousBuffer = 0;
+    return true;
 }
 
 bool GPUTransfer::CreateDevices() {
     HRESULT hr;
 
+    if (m_config.sourceDevice || m_config.destDevice) {
+        if (!m_config.sourceDevice || !m_config.destDevice) {
+            SetError("Shared devices must be given for both GPUs");
+            return false;
+        }
+        m_sourceDevice = m_config.sourceDevice;
+        m_destDevice = m_config.destDevice;
+    } else if (!CreateDevicePair()) {
+        return false;
+    }
+
+    // Create source command queue
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+    hr = m_sourceDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_sourceCommandQueue));
+    if (FAILED(hr)) {
+        SetError("Failed to create source command queue");
+        return false;
+    }
+
+    // Create destination command queue
+    hr = m_destDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_destCommandQueue));
+    if (FAILED(hr)) {
+        SetError("Failed to create destination command queue");
+        return false;
+    }
+
+    // Incoming frames land through a dedicated copy queue, so they overlap
+    // frame generation and presentation on the destination GPU
+    D3D12_COMMAND_QUEUE_DESC copyQueueDesc = {};
+    copyQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    copyQueueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+    hr = m_destDevice->CreateCommandQueue(&copyQueueDesc, IID_PPV_ARGS(&m_destCopyQueue));
+    if (FAILED(hr)) {
+        SetError("Failed to create destination copy queue");
+        return false;
+    }
+
+    // Create command allocator rings: one allocator per transfer buffer, so
+    // recording frame N+1 never has to wait for frame N's copy to retire
+    // (the source ring also covers the staging path's per-band submissions)
+    const uint32_t ringDepth = (std::min)((std::max)(m_config.bufferCount, 1u),
+                                          CommandAllocatorRing::MAX_DEPTH);
+    const uint32_t sourceRingDepth = (std::min)((std::max)(ringDepth, static_cast<uint32_t>(STAGING_BANDS)),
+                                                CommandAllocatorRing::MAX_DEPTH);
+
+    if (!m_sourceCommandRing.Initialize(m_sourceDevice.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT, sourceRingDepth)) {
+        SetError("Failed to create source command ring: " + m_sourceCommandRing.GetLastError());
+        return false;
+    }
+
+    if (!m_destCommandRing.Initialize(m_destDevice.Get(), D3D12_COMMAND_LIST_TYPE_COPY, ringDepth)) {
+        SetError("Failed to create destination command ring: " + m_destCommandRing.GetLastError());
+        return false;
+    }
+
+    // Packed transfer: both codecs and the unpack queue must come up,
+    // otherwise frames cross as captured (except HDR10, see TransferConfig)
+    m_encoding = TransferEncoding::BGRA8;
+    if (m_config.encoding != TransferEncoding::BGRA8 && !CreateCodec(sourceRingDepth, ringDepth)) {
+        m_encoder.Shutdown();
+        m_decoder.Shutdown();
+        m_decodeCommandRing.Shutdown();
+        m_destComputeQueue.Reset();
+        if (m_config.encoding == TransferEncoding::HDR10) {
+            SetError("HDR10 transfer codec unavailable on these GPUs");
+            return false;
+        }
+    }
+
+    // Optional: without copy queue timestamps the GPU times just stay 0
+    if (m_config.gpuProfiling) {
+        ID3D12CommandQueue* landingQueue = m_encoding != TransferEncoding::BGRA8 ?
+            m_destComputeQueue.Get() : m_destCopyQueue.Get();
+        m_sourceProfiler.Initialize(m_sourceDevice.Get(), m_sourceCommandQueue.Get(), ringDepth);
+        m_destProfiler.Initialize(m_destDevice.Get(), landingQueue, ringDepth);
+    }
+
+    return true;
+}
+
+bool GPUTransfer::CreateDevicePair() {
     ComPtr<IDXGIFactory6> factory;
-    hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&factory));
+    HRESULT hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&factory));
     if (FAILED(hr)) {
         SetError("Failed to create DXGI factory");
         return false;
@@ -203,17 +403,6 @@ bool GPUTransfer::CreateDevices() {
         return false;
     }
 
-    // Create source command queue
-    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-
-    hr = m_sourceDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_sourceCommandQueue));
-    if (FAILED(hr)) {
-        SetError("Failed to create source command queue");
-        return false;
-    }
-
     // Create destination GPU device
     ComPtr<IDXGIAdapter1> destAdapter;
     hr = factory->EnumAdapters1(m_config.destAdapterIndex, &destAdapter);
@@ -228,50 +417,72 @@ bool GPUTransfer::CreateDevices() {
         return false;
     }
 
-    // Create destination command queue
-    hr = m_destDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_destCommandQueue));
-    if (FAILED(hr)) {
-        SetError("Failed to create destination command queue");
+    return true;
+}
+
+bool GPUTransfer::CreateCodec(uint32_t sourceSets, uint32_t destSets) {
+    const TransferEncoding encoding = m_config.encoding;
+    if (!TransferCodec::IsSupported(m_sourceDevice.Get(), encoding, TransferCodecMode::Encode, m_config.format) ||
+        !TransferCodec::IsSupported(m_destDevice.Get(), encoding, TransferCodecMode::Decode, m_config.format)) {
         return false;
     }
 
-    // Create command allocators and lists
-    hr = m_sourceDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(&m_sourceCommandAllocator));
-    if (FAILED(hr)) {
-        SetError("Failed to create source command allocator");
+    if (!m_encoder.Initialize(m_sourceDevice.Get(), encoding, TransferCodecMode::Encode, m_config.format,
+                              m_config.width, m_config.height, sourceSets) ||
+        !m_decoder.Initialize(m_destDevice.Get(), encoding, TransferCodecMode::Decode, m_config.format,
+                              m_config.width, m_config.height, destSets)) {
         return false;
     }
 
-    hr = m_sourceDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_sourceCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_sourceCommandList));
-    if (FAILED(hr)) {
-        SetError("Failed to create source command list");
+    // Unpacking writes the ring textures as UAVs, which the copy queue cannot
+    D3D12_COMMAND_QUEUE_DESC computeQueueDesc = {};
+    computeQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    computeQueueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    if (FAILED(m_destDevice->CreateCommandQueue(&computeQueueDesc, IID_PPV_ARGS(&m_destComputeQueue)))) {
         return false;
     }
-    m_sourceCommandList->Close();
 
-    hr = m_destDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(&m_destCommandAllocator));
-    if (FAILED(hr)) {
-        SetError("Failed to create destination command allocator");
+    if (!m_decodeCommandRing.Initialize(m_destDevice.Get(), D3D12_COMMAND_LIST_TYPE_COMPUTE, destSets)) {
         return false;
     }
 
-    hr = m_destDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
-        m_destCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_destCommandList));
+    m_encoding = m_config.encoding;
+    return true;
+}
+
+bool GPUTransfer::CreatePackedBuffer() {
+    m_packedSize = TransferCodec::GetPackedSize(m_encoding, m_config.width, m_config.height);
+    m_encoder.Resize(m_config.width, m_config.height);
+    m_decoder.Resize(m_config.width, m_config.height);
+
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = m_packedSize;
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    bufferDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+
+    // Buffers promote from COMMON and decay back after each submission
+    HRESULT hr = CreateArenaResource(m_sourceArena, this, m_sourceDevice.Get(), D3D12_HEAP_TYPE_DEFAULT,
+                                     bufferDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, m_packedBuffer);
     if (FAILED(hr)) {
-        SetError("Failed to create destination command list");
+        SetError("Failed to create packed frame buffer");
         return false;
     }
-    m_destCommandList->Close();
-
     return true;
 }
 
 bool GPUTransfer::CreateCrossAdapterResources() {
     HRESULT hr;
 
+    const bool encoded = m_encoding != TransferEncoding::BGRA8;
+    if (encoded && !CreatePackedBuffer()) {
+        return false;
+    }
+
     // Calculate texture size
     UINT64 textureSize = 0;
     D3D12_RESOURCE_DESC textureDesc = {};
@@ -285,6 +496,14 @@ bool GPUTransfer::CreateCrossAdapterResources() {
     textureDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR; // Required for cross-adapter
     textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_CROSS_ADAPTER;
 
+    // Packed frames cross as a plain buffer of the packed size
+    if (encoded) {
+        textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        textureDesc.Width = m_packedSize;
+        textureDesc.Height = 1;
+        textureDesc.Format = DXGI_FORMAT_UNKNOWN;
+    }
+
     D3D12_RESOURCE_ALLOCATION_INFO allocInfo = m_sourceDevice->GetResourceAllocationInfo(0, 1, &textureDesc);
     textureSize = allocInfo.SizeInBytes;
 
@@ -309,7 +528,7 @@ bool GPUTransfer::CreateCrossAdapterResources() {
             m_crossAdapterHeap.Get(),
             i * textureSize,
             &textureDesc,
-            D3D12_RESOURCE_STATE_COPY_DEST,
+            D3D12_RESOURCE_STATE_COMMON,  // Transfer transitions COMMON -> COPY_DEST -> COMMON
             nullptr,
             IID_PPV_ARGS(&m_crossAdapterTextures[i]));
 
@@ -335,8 +554,10 @@ bool GPUTransfer::CreateCrossAdapterResources() {
         return false;
     }
 
-    // Create destination textures using the shared heap
-    m_destTextures.resize(m_config.bufferCount);
+    // View the shared heap on the destination GPU. It is row-major and
+    // lives across the bus, so each frame is copied once into a local texture
+    // instead of being sampled from there by every pass.
+    m_destSharedTextures.resize(m_config.bufferCount);
     textureDesc.Flags = D3D12_RESOURCE_FLAG_NONE; // Destination doesn't need cross-adapter flag
 
     for (uint32_t i = 0; i < m_config.bufferCount; i++) {
@@ -344,9 +565,41 @@ bool GPUTransfer::CreateCrossAdapterResources() {
             destHeap.Get(),
             i * textureSize,
             &textureDesc,
-            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_COMMON,
             nullptr,
-            IID_PPV_ARGS(&m_destTextures[i]));
+            IID_PPV_ARGS(&m_destSharedTextures[i]));
+
+        if (FAILED(hr)) {
+            SetError("Failed to create shared destination texture " + std::to_string(i));
+            return false;
+        }
+    }
+
+    return CreateDestinationTextures();
+}
+
+bool GPUTransfer::CreateDestinationTextures() {
+    m_destTextures.resize(m_config.bufferCount);
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Width = m_config.width;
+    textureDesc.Height = m_config.height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = 1;
+    textureDesc.Format = GetDestinationFormat();
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    if (m_encoding != TransferEncoding::BGRA8) {
+        textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;   // Unpack target
+    }
+
+    // Written on the copy queue, so they rest in COMMON: copies and reads
+    // promote them implicitly and they decay back after each submission
+    // (the unpack queue transitions them explicitly)
+    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
+        HRESULT hr = CreateArenaResource(m_destArena, this, m_destDevice.Get(), D3D12_HEAP_TYPE_DEFAULT,
+                                         textureDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, m_destTextures[i]);
 
         if (FAILED(hr)) {
             SetError("Failed to create destination texture " + std::to_string(i));
@@ -360,14 +613,18 @@ bool GPUTransfer::CreateCrossAdapterResources() {
 bool GPUTransfer::CreateStagingResources() {
     HRESULT hr;
 
-    // Calculate buffer size (aligned row pitch)
-    UINT rowPitch = (m_config.width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
-                    ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
-    m_stagingSize = rowPitch * m_config.height;
-
-    // Create readback buffer on source GPU
-    D3D12_HEAP_PROPERTIES readbackHeapProps = {};
-    readbackHeapProps.Type = D3D12_HEAP_TYPE_READBACK;
+    // Calculate buffer size (aligned row pitch, or the packed frame)
+    if (m_encoding != TransferEncoding::BGRA8) {
+        if (!CreatePackedBuffer()) {
+            return false;
+        }
+        m_stagingRowPitch = 0;
+        m_stagingSize = static_cast<size_t>(m_packedSize);
+    } else {
+        m_stagingRowPitch = (m_config.width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
+                            ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+        m_stagingSize = static_cast<size_t>(m_stagingRowPitch) * m_config.height;
+    }
 
     D3D12_RESOURCE_DESC bufferDesc = {};
     bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
@@ -378,57 +635,48 @@ bool GPUTransfer::CreateStagingResources() {
     bufferDesc.SampleDesc.Count = 1;
     bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
 
-    hr = m_sourceDevice->CreateCommittedResource(
-        &readbackHeapProps, D3D12_HEAP_FLAG_NONE,
-        &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST,
-        nullptr, IID_PPV_ARGS(&m_sourceReadbackBuffer));
-    if (FAILED(hr)) {
-        SetError("Failed to create source readback buffer");
-        return false;
-    }
-
-    // Create upload buffer on destination GPU
-    D3D12_HEAP_PROPERTIES uploadHeapProps = {};
-    uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
-
-    hr = m_destDevice->CreateCommittedResource(
-        &uploadHeapProps, D3D12_HEAP_FLAG_NONE,
-        &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr, IID_PPV_ARGS(&m_destUploadBuffer));
-    if (FAILED(hr)) {
-        SetError("Failed to create destination upload buffer");
+    if (!m_copyEngine.IsInitialized() && !m_copyEngine.Initialize()) {
+        SetError("Failed to start copy engine: " + m_copyEngine.GetLastError());
         return false;
     }
 
-    // Create destination textures
-    m_destTextures.resize(m_config.bufferCount);
+    m_stagingSlots.resize(m_config.bufferCount);
+    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
+        StagingSlot& slot = m_stagingSlots[i];
 
-    D3D12_HEAP_PROPERTIES defaultHeapProps = {};
-    defaultHeapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+        // Readback buffer on source GPU
+        hr = CreateArenaResource(m_sourceArena, this, m_sourceDevice.Get(), D3D12_HEAP_TYPE_READBACK,
+                                 bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, slot.readbackBuffer);
+        if (FAILED(hr)) {
+            SetError("Failed to create source readback buffer " + std::to_string(i));
+            return false;
+        }
 
-    D3D12_RESOURCE_DESC textureDesc = {};
-    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-    textureDesc.Width = m_config.width;
-    textureDesc.Height = m_config.height;
-    textureDesc.DepthOrArraySize = 1;
-    textureDesc.MipLevels = 1;
-    textureDesc.Format = m_config.format;
-    textureDesc.SampleDesc.Count = 1;
-    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        // Upload buffer on destination GPU
+        hr = CreateArenaResource(m_destArena, this, m_destDevice.Get(), D3D12_HEAP_TYPE_UPLOAD,
+                                 bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, slot.uploadBuffer);
+        if (FAILED(hr)) {
+            SetError("Failed to create destination upload buffer " + std::to_string(i));
+            return false;
+        }
 
-    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
-        hr = m_destDevice->CreateCommittedResource(
-            &defaultHeapProps, D3D12_HEAP_FLAG_NONE,
-            &textureDesc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-            nullptr, IID_PPV_ARGS(&m_destTextures[i]));
+        // Both stay mapped for the lifetime of the slot; fences order access
+        D3D12_RANGE readRange = { 0, m_stagingSize };
+        hr = slot.readbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&slot.readbackData));
+        if (FAILED(hr)) {
+            SetError("Failed to map readback buffer " + std::to_string(i));
+            return false;
+        }
 
+        D3D12_RANGE noRead = { 0, 0 };
+        hr = slot.uploadBuffer->Map(0, &noRead, reinterpret_cast<void**>(&slot.uploadData));
         if (FAILED(hr)) {
-            SetError("Failed to create destination texture " + std::to_string(i));
+            SetError("Failed to map upload buffer " + std::to_string(i));
             return false;
         }
     }
 
-    return true;
+    return CreateDestinationTextures();
 }
 
 bool GPUTransfer::CreateSyncObjects() {
@@ -474,12 +722,145 @@ bool GPUTransfer::CreateSyncObjects() {
             SetError("Failed to create shared fence handle");
             return false;
         }
+
+        // The destination queue can only wait on the fence through its own device
+        hr = m_destDevice->OpenSharedHandle(m_sharedFenceHandle, IID_PPV_ARGS(&m_destSharedFence));
+        if (FAILED(hr)) {
+            SetError("Failed to open shared fence on destination GPU");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool GPUTransfer::CreateIngestResources() {
+    if (!CreateIngestTextures()) {
+        return false;
+    }
+
+    // Without a shared handle the writer cannot signal it; frames then come
+    // in through TransferUploadedFrame(), which does not wait on it
+    HRESULT hr = m_sourceDevice->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_ingestFence));
+    if (FAILED(hr)) {
+        SetError("Failed to create ingest fence");
+        return false;
+    }
+
+    hr = m_sourceDevice->CreateSharedHandle(m_ingestFence.Get(), nullptr, GENERIC_ALL, nullptr, &m_ingestFenceHandle);
+    if (FAILED(hr)) {
+        m_ingestFenceHandle = nullptr;
     }
 
     return true;
 }
 
-bool GPUTransfer::TransferFrame(ID3D12Resource* sourceTexture) {
+bool GPUTransfer::CreateIngestTextures() {
+    // Shared, so another device can write them; where NT handles are not
+    // supported they are created unshared and filled by TransferUploadedFrame()
+    if (CreateIngestTextureSet(true)) {
+        return true;
+    }
+    for (HANDLE handle : m_ingestTextureHandles) {
+        if (handle) {
+            CloseHandle(handle);
+        }
+    }
+    m_ingestTextureHandles.clear();
+    m_ingestTextures.clear();
+    return CreateIngestTextureSet(false);
+}
+
+bool GPUTransfer::CreateIngestTextureSet(bool shared) {
+    HRESULT hr;
+
+    // One texture per ring buffer, so the writer addresses the same slot
+    // the transfer reads
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Width = m_config.width;
+    textureDesc.Height = m_config.height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = 1;
+    textureDesc.Format = m_config.format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    m_ingestTextures.resize(m_config.bufferCount);
+    m_ingestTextureHandles.assign(m_config.bufferCount, nullptr);
+    m_ingestRetireValues.assign(m_config.bufferCount, 0);
+
+    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
+        hr = m_sourceDevice->CreateCommittedResource(
+            &heapProps, shared ? D3D12_HEAP_FLAG_SHARED : D3D12_HEAP_FLAG_NONE,
+            &textureDesc, D3D12_RESOURCE_STATE_COMMON,
+            nullptr, IID_PPV_ARGS(&m_ingestTextures[i]));
+        if (FAILED(hr)) {
+            SetError("Failed to create ingest texture " + std::to_string(i));
+            return false;
+        }
+
+        if (shared) {
+            hr = m_sourceDevice->CreateSharedHandle(m_ingestTextures[i].Get(), nullptr, GENERIC_ALL,
+                                                    nullptr, &m_ingestTextureHandles[i]);
+            if (FAILED(hr)) {
+                m_ingestTextureHandles[i] = nullptr;
+                SetError("Failed to create ingest texture handle " + std::to_string(i));
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool GPUTransfer::CreateIngestUploadBuffer() {
+    const D3D12_RESOURCE_DESC textureDesc = m_ingestTextures[0]->GetDesc();
+    UINT64 totalBytes = 0;
+    m_sourceDevice->GetCopyableFootprints(&textureDesc, 0, 1, 0, &m_ingestUploadFootprint,
+                                          nullptr, &m_ingestUploadRowBytes, &totalBytes);
+
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+    D3D12_RESOURCE_DESC bufferDesc = {};
+    bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    bufferDesc.Width = totalBytes;
+    bufferDesc.Height = 1;
+    bufferDesc.DepthOrArraySize = 1;
+    bufferDesc.MipLevels = 1;
+    bufferDesc.SampleDesc.Count = 1;
+    bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    HRESULT hr = m_sourceDevice->CreateCommittedResource(
+        &heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr, IID_PPV_ARGS(&m_ingestUploadBuffer));
+    if (FAILED(hr)) {
+        SetError("Failed to create ingest upload buffer");
+        return false;
+    }
+
+    D3D12_RANGE noRead = { 0, 0 };
+    hr = m_ingestUploadBuffer->Map(0, &noRead, reinterpret_cast<void**>(&m_ingestUploadData));
+    if (FAILED(hr)) {
+        m_ingestUploadBuffer.Reset();
+        SetError("Failed to map ingest upload buffer");
+        return false;
+    }
+    m_ingestUploadFenceValue = 0;
+    return true;
+}
+
+bool GPUTransfer::TransferFrame(ID3D12Resource* sourceTexture,
+                                const RECT* dirtyRects, uint32_t dirtyRectCount) {
+    return TransferFrameFrom(sourceTexture, D3D12_RESOURCE_STATE_COPY_SOURCE, dirtyRects, dirtyRectCount);
+}
+
+bool GPUTransfer::TransferFrameFrom(ID3D12Resource* sourceTexture, D3D12_RESOURCE_STATES sourceState,
+                                    const RECT* dirtyRects, uint32_t dirtyRectCount) {
     if (!m_initialized) {
         SetError("Not initialized");
         return false;
@@ -491,21 +872,52 @@ bool GPUTransfer::TransferFrame(ID3D12Resource* sourceTexture) {
     }
 
     m_transferStart = std::chrono::high_resolution_clock::now();
-
-    bool success = false;
-    if (m_transferMethod == TransferMethod::CrossAdapterHeap) {
-        success = TransferViaCrossAdapter(sourceTexture);
+    m_sourceProfiler.BeginFrame();
+    m_destProfiler.BeginFrame();
+
+    // Work out what this buffer is missing: the whole frame, or the regions
+    // changed since it was last written. Packed frames always go whole.
+    m_dirtyRegions.AddFrame(dirtyRects, dirtyRectCount);
+    const bool encoded = m_encoding != TransferEncoding::BGRA8;
+    const bool fullCopy = encoded || m_dirtyRegions.IsFull(m_currentBuffer);
+    const uint64_t copyBytes = encoded ? m_packedSize : m_dirtyRegions.GetCopyBytes(m_currentBuffer, 4);
+
+    m_copyBoxes.clear();
+    if (fullCopy) {
+        m_copyBoxes.push_back({ 0, 0, 0, m_config.width, m_config.height, 1 });
     } else {
-        success = TransferViaStaging(sourceTexture);
+        for (const RECT& r : m_dirtyRegions.GetRects(m_currentBuffer)) {
+            m_copyBoxes.push_back({ static_cast<UINT>(r.left), static_cast<UINT>(r.top), 0,
+                                    static_cast<UINT>(r.right), static_cast<UINT>(r.bottom), 1 });
+        }
     }
 
-    if (success) {
+    bool success = true;
+    if (!m_copyBoxes.empty()) {
+        if (encoded) {
+            success = TransferEncoded(sourceTexture, sourceState);
+        } else if (m_transferMethod == TransferMethod::CrossAdapterHeap) {
+            success = TransferViaCrossAdapter(sourceTexture);
+        } else {
+            success = TransferViaStaging(sourceTexture);
+        }
+    }
+
+    if (!success) {
+        // The buffer may hold a partial copy now
+        m_dirtyRegions.Invalidate();
+    } else {
+        m_dirtyRegions.MarkWritten(m_currentBuffer);
+
         auto endTime = std::chrono::high_resolution_clock::now();
         double transferTimeMs = std::chrono::duration<double, std::milli>(endTime - m_transferStart).count();
 
         // Update statistics
         m_stats.framesTransferred++;
-        m_stats.bytesTranferred += m_config.width * m_config.height * 4;
+        m_stats.bytesTranferred += copyBytes;
+        if (!fullCopy) {
+            m_stats.partialTransfers++;
+        }
         m_stats.lastTransferTimeMs = transferTimeMs;
         m_stats.minTransferTimeMs = (std::min)(m_stats.minTransferTimeMs, transferTimeMs);
         m_stats.maxTransferTimeMs = (std::max)(m_stats.maxTransferTimeMs, transferTimeMs);
@@ -513,22 +925,148 @@ bool GPUTransfer::TransferFrame(ID3D12Resource* sourceTexture) {
         // Running average
         double alpha = 0.1;
         m_stats.avgTransferTimeMs = m_stats.avgTransferTimeMs * (1.0 - alpha) + transferTimeMs * alpha;
-        m_stats.throughputMBps = (m_config.width * m_config.height * 4) / (transferTimeMs * 1000.0);
+        if (transferTimeMs > 0.0) {
+            m_stats.throughputMBps = copyBytes / (transferTimeMs * 1000.0);
+        }
         m_stats.currentMethod = m_transferMethod;
+        m_stats.currentEncoding = m_encoding;
+
+        if (m_sourceProfiler.Collect()) {
+            m_stats.gpuSourceTimeMs = m_sourceProfiler.GetLastFrame().busyMs;
+        }
+        if (m_destProfiler.Collect()) {
+            m_stats.gpuDestTimeMs = m_destProfiler.GetLastFrame().busyMs;
+            m_stats.destQueueBubbleMs = m_destProfiler.GetLastFrame().bubbleMs;
+        }
     }
 
     return success;
 }
 
-bool GPUTransfer::TransferViaCrossAdapter(ID3D12Resource* sourceTexture) {
-    HRESULT hr;
+bool GPUTransfer::TransferIngestedFrame(uint64_t ingestFenceValue,
+                                        const RECT* dirtyRects, uint32_t dirtyRectCount) {
+    if (!m_initialized) {
+        SetError("Not initialized");
+        return false;
+    }
+
+    if (m_ingestTextures.empty()) {
+        SetError("Ingest textures not enabled");
+        return false;
+    }
 
-    // Reset command allocator and list
-    hr = m_sourceCommandAllocator->Reset();
-    if (FAILED(hr)) return false;
+    // Order the copy after the writer's copy on the GPU timeline. Ingest
+    // textures rest in COMMON and are promoted to COPY_SOURCE implicitly.
+    HRESULT hr = m_sourceCommandQueue->Wait(m_ingestFence.Get(), ingestFenceValue);
+    if (FAILED(hr)) {
+        SetError("Failed to wait on ingest fence");
+        return false;
+    }
+
+    return TransferIngestTexture(dirtyRects, dirtyRectCount);
+}
+
+bool GPUTransfer::TransferUploadedFrame(const void* pixels, uint32_t rowPitch,
+                                        const RECT* dirtyRects, uint32_t dirtyRectCount) {
+    if (!m_initialized) {
+        SetError("Not initialized");
+        return false;
+    }
+
+    if (m_ingestTextures.empty() || !pixels) {
+        SetError(m_ingestTextures.empty() ? "Ingest textures not enabled" : "Pixels are null");
+        return false;
+    }
+
+    if (!m_ingestUploadBuffer && !CreateIngestUploadBuffer()) {
+        return false;
+    }
+
+    // The single upload buffer is rewritten once the last upload has read it
+    if (m_sourceFence->GetCompletedValue() < m_ingestUploadFenceValue) {
+        m_sourceFence->SetEventOnCompletion(m_ingestUploadFenceValue, m_sourceFenceEvent);
+        WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+    }
+
+    // Whole frame: the ingest texture then holds all of it, and the regions
+    // the transfer copies on from it can be any subset
+    m_copyEngine.CopyRows(m_ingestUploadData, m_ingestUploadFootprint.Footprint.RowPitch,
+                          static_cast<const uint8_t*>(pixels), rowPitch,
+                          static_cast<size_t>(m_ingestUploadRowBytes), m_config.height);
+
+    ID3D12GraphicsCommandList* sourceList = m_sourceCommandRing.Begin();
+    if (!sourceList) {
+        SetError(m_sourceCommandRing.GetLastError());
+        return false;
+    }
+
+    // Promoted from COMMON to COPY_DEST implicitly; decays back on submit.
+    // The same queue reads it next, so no fence is needed in between.
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = m_ingestTextures[m_currentBuffer].Get();
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = m_ingestUploadBuffer.Get();
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLoc.PlacedFootprint = m_ingestUploadFootprint;
+    sourceList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+
+    m_sourceFenceValue++;
+    if (!m_sourceCommandRing.Submit(m_sourceCommandQueue.Get(), m_sourceFence.Get(), m_sourceFenceValue)) {
+        SetError(m_sourceCommandRing.GetLastError());
+        return false;
+    }
+    m_ingestUploadFenceValue = m_sourceFenceValue;
+
+    return TransferIngestTexture(dirtyRects, dirtyRectCount);
+}
+
+bool GPUTransfer::TransferIngestTexture(const RECT* dirtyRects, uint32_t dirtyRectCount) {
+    const uint32_t slot = m_currentBuffer;
+    if (!TransferFrameFrom(m_ingestTextures[slot].Get(), D3D12_RESOURCE_STATE_COMMON,
+                           dirtyRects, dirtyRectCount)) {
+        return false;
+    }
+
+    // The source queue is done with the texture at this value
+    m_sourceFenceValue++;
+    if (FAILED(m_sourceCommandQueue->Signal(m_sourceFence.Get(), m_sourceFenceValue))) {
+        SetError("Failed to signal ingest retirement");
+        return false;
+    }
+    m_ingestRetireValues[slot] = m_sourceFenceValue;
+    return true;
+}
+
+void GPUTransfer::WaitForIngestSlot(uint32_t bufferIndex) {
+    if (bufferIndex >= m_ingestRetireValues.size()) {
+        return;
+    }
+    const uint64_t value = m_ingestRetireValues[bufferIndex];
+    if (value > 0 && m_sourceFence->GetCompletedValue() < value) {
+        m_sourceFence->SetEventOnCompletion(value, m_sourceFenceEvent);
+        WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+    }
+}
+
+HANDLE GPUTransfer::GetIngestTextureHandle(uint32_t bufferIndex) const {
+    if (bufferIndex >= m_ingestTextureHandles.size()) {
+        return nullptr;
+    }
+    return m_ingestTextureHandles[bufferIndex];
+}
+
+bool GPUTransfer::TransferViaCrossAdapter(ID3D12Resource* sourceTexture) {
+    // Take the next allocator (blocks only if it is still in flight)
+    ID3D12GraphicsCommandList* sourceList = m_sourceCommandRing.Begin();
+    if (!sourceList) {
+        SetError(m_sourceCommandRing.GetLastError());
+        return false;
+    }
 
-    hr = m_sourceCommandList->Reset(m_sourceCommandAllocator.Get(), nullptr);
-    if (FAILED(hr)) return false;
+    m_sourceProfiler.BeginScope(sourceList, GpuStage::TransferSource);
 
     // Transition cross-adapter texture to COPY_DEST
     D3D12_RESOURCE_BARRIER barrier = {};
@@ -537,140 +1075,365 @@ bool GPUTransfer::TransferViaCrossAdapter(ID3D12Resource* sourceTexture) {
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
     barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    m_sourceCommandList->ResourceBarrier(1, &barrier);
+    sourceList->ResourceBarrier(1, &barrier);
 
-    // Copy source texture to cross-adapter texture
-    m_sourceCommandList->CopyResource(m_crossAdapterTextures[m_currentBuffer].Get(), sourceTexture);
+    // Copy source texture to cross-adapter texture (whole frame or changed regions)
+    if (m_dirtyRegions.IsFull(m_currentBuffer)) {
+        sourceList->CopyResource(m_crossAdapterTextures[m_currentBuffer].Get(), sourceTexture);
+    } else {
+        D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+        srcLoc.pResource = sourceTexture;
+        srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        srcLoc.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+        dstLoc.pResource = m_crossAdapterTextures[m_currentBuffer].Get();
+        dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dstLoc.SubresourceIndex = 0;
+
+        for (const D3D12_BOX& box : m_copyBoxes) {
+            sourceList->CopyTextureRegion(&dstLoc, box.left, box.top, 0, &srcLoc, &box);
+        }
+    }
 
     // Transition back to COMMON for cross-adapter access
     barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
     barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COMMON;
-    m_sourceCommandList->ResourceBarrier(1, &barrier);
+    sourceList->ResourceBarrier(1, &barrier);
+    m_sourceProfiler.EndScope(sourceList);
+
+    // Execute on source GPU and signal shared fence
+    m_sourceFenceValue++;
+    m_sourceProfiler.EndFrame(sourceList, m_sharedFence.Get(), m_sourceFenceValue);
+    if (!m_sourceCommandRing.Submit(m_sourceCommandQueue.Get(), m_sharedFence.Get(), m_sourceFenceValue)) {
+        SetError(m_sourceCommandRing.GetLastError());
+        return false;
+    }
 
-    hr = m_sourceCommandList->Close();
-    if (FAILED(hr)) return false;
+    // === Destination GPU: copy the same boxes into the local texture ===
+    m_destCopyQueue->Wait(m_destSharedFence.Get(), m_sourceFenceValue);
 
-    // Execute on source GPU
-    ID3D12CommandList* cmdLists[] = { m_sourceCommandList.Get() };
-    m_sourceCommandQueue->ExecuteCommandLists(1, cmdLists);
+    ID3D12GraphicsCommandList* destList = m_destCommandRing.Begin();
+    if (!destList) {
+        SetError(m_destCommandRing.GetLastError());
+        return false;
+    }
 
-    // Signal shared fence
-    m_sourceFenceValue++;
-    m_sourceCommandQueue->Signal(m_sharedFence.Get(), m_sourceFenceValue);
+    D3D12_TEXTURE_COPY_LOCATION sharedLoc = {};
+    sharedLoc.pResource = m_destSharedTextures[m_currentBuffer].Get();
+    sharedLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    sharedLoc.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION localLoc = {};
+    localLoc.pResource = m_destTextures[m_currentBuffer].Get();
+    localLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    localLoc.SubresourceIndex = 0;
+
+    m_destProfiler.BeginScope(destList, GpuStage::TransferDest);
+    for (const D3D12_BOX& box : m_copyBoxes) {
+        destList->CopyTextureRegion(&localLoc, box.left, box.top, 0, &sharedLoc, &box);
+    }
+    m_destProfiler.EndScope(destList);
 
-    // Wait on destination GPU for the shared fence
-    m_destCommandQueue->Wait(m_sharedFence.Get(), m_sourceFenceValue);
+    m_destFenceValue++;
+    m_destProfiler.EndFrame(destList, m_destFence.Get(), m_destFenceValue);
+    if (!m_destCommandRing.Submit(m_destCopyQueue.Get(), m_destFence.Get(), m_destFenceValue)) {
+        SetError(m_destCommandRing.GetLastError());
+        return false;
+    }
 
     return true;
 }
 
 bool GPUTransfer::TransferViaStaging(ID3D12Resource* sourceTexture) {
-    HRESULT hr;
+    StagingSlot& slot = m_stagingSlots[m_currentBuffer];
 
-    // === Source GPU: Copy texture to readback buffer ===
-    hr = m_sourceCommandAllocator->Reset();
-    if (FAILED(hr)) return false;
+    // The upload buffer may still be read by this slot's previous upload
+    // (one ring lap ago, so normally long retired)
+    if (m_destFence->GetCompletedValue() < slot.uploadFenceValue) {
+        m_destFence->SetEventOnCompletion(slot.uploadFenceValue, m_destFenceEvent);
+        WaitForSingleObject(m_destFenceEvent, INFINITE);
+    }
 
-    hr = m_sourceCommandList->Reset(m_sourceCommandAllocator.Get(), nullptr);
-    if (FAILED(hr)) return false;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    footprint.Footprint.Format = m_config.format;
+    footprint.Footprint.Width = m_config.width;
+    footprint.Footprint.Height = m_config.height;
+    footprint.Footprint.Depth = 1;
+    footprint.Footprint.RowPitch = m_stagingRowPitch;
+
+    D3D12_TEXTURE_COPY_LOCATION sourceLoc = {};
+    sourceLoc.pResource = sourceTexture;
+    sourceLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    sourceLoc.SubresourceIndex = 0;
+
+    if (m_dirtyRegions.IsFull(m_currentBuffer)) {
+        // Band height is even so every band's footprint offset stays
+        // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT (512) aligned for any 256-byte pitch
+        uint32_t bandRows = (m_config.height + STAGING_BANDS - 1) / STAGING_BANDS;
+        bandRows = (bandRows + 1) & ~1u;
+
+        // === Source GPU: queue every band's readback, each with its own fence value ===
+        uint64_t bandFenceValues[STAGING_BANDS] = {};
+        uint32_t bandCount = 0;
+        for (uint32_t top = 0; top < m_config.height; top += bandRows, bandCount++) {
+            const uint32_t rows = (std::min)(bandRows, m_config.height - top);
+
+            ID3D12GraphicsCommandList* sourceList = m_sourceCommandRing.Begin();
+            if (!sourceList) {
+                SetError(m_sourceCommandRing.GetLastError());
+                return false;
+            }
 
-    // Copy texture to readback buffer
-    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
-    srcLoc.pResource = sourceTexture;
-    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-    srcLoc.SubresourceIndex = 0;
+            D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+            dstLoc.pResource = slot.readbackBuffer.Get();
+            dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+            dstLoc.PlacedFootprint = footprint;
+            dstLoc.PlacedFootprint.Offset = static_cast<UINT64>(top) * m_stagingRowPitch;
+            dstLoc.PlacedFootprint.Footprint.Height = rows;
+
+            D3D12_BOX box = { 0, top, 0, m_config.width, top + rows, 1 };
+            m_sourceProfiler.BeginScope(sourceList, GpuStage::TransferSource, bandCount);
+            sourceList->CopyTextureRegion(&dstLoc, 0, 0, 0, &sourceLoc, &box);
+            m_sourceProfiler.EndScope(sourceList);
+
+            m_sourceFenceValue++;
+            if (top + rows >= m_config.height) {
+                m_sourceProfiler.EndFrame(sourceList, m_sourceFence.Get(), m_sourceFenceValue);
+            }
+            if (!m_sourceCommandRing.Submit(m_sourceCommandQueue.Get(), m_sourceFence.Get(), m_sourceFenceValue)) {
+                SetError(m_sourceCommandRing.GetLastError());
+                return false;
+            }
+            bandFenceValues[bandCount] = m_sourceFenceValue;
+        }
 
-    UINT rowPitch = (m_config.width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) &
-                    ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1);
+        // === CPU: copy each band as soon as it lands, while later bands read back ===
+        for (uint32_t band = 0; band < bandCount; band++) {
+            if (m_sourceFence->GetCompletedValue() < bandFenceValues[band]) {
+                m_sourceFence->SetEventOnCompletion(bandFenceValues[band], m_sourceFenceEvent);
+                WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+            }
 
-    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
-    dstLoc.pResource = m_sourceReadbackBuffer.Get();
-    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-    dstLoc.PlacedFootprint.Offset = 0;
-    dstLoc.PlacedFootprint.Footprint.Format = m_config.format;
-    dstLoc.PlacedFootprint.Footprint.Width = m_config.width;
-    dstLoc.PlacedFootprint.Footprint.Height = m_config.height;
-    dstLoc.PlacedFootprint.Footprint.Depth = 1;
-    dstLoc.PlacedFootprint.Footprint.RowPitch = rowPitch;
+            const uint32_t top = band * bandRows;
+            const uint32_t rows = (std::min)(bandRows, m_config.height - top);
+            const size_t offset = static_cast<size_t>(top) * m_stagingRowPitch;
+            m_copyEngine.Copy(slot.uploadData + offset, slot.readbackData + offset,
+                              static_cast<size_t>(rows) * m_stagingRowPitch);
+        }
+    } else {
+        // === Source GPU: read back only the changed regions, in place ===
+        ID3D12GraphicsCommandList* sourceList = m_sourceCommandRing.Begin();
+        if (!sourceList) {
+            SetError(m_sourceCommandRing.GetLastError());
+            return false;
+        }
+
+        D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+        dstLoc.pResource = slot.readbackBuffer.Get();
+        dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dstLoc.PlacedFootprint = footprint;
 
-    m_sourceCommandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        m_sourceProfiler.BeginScope(sourceList, GpuStage::TransferSource);
+        for (const D3D12_BOX& box : m_copyBoxes) {
+            sourceList->CopyTextureRegion(&dstLoc, box.left, box.top, 0, &sourceLoc, &box);
+        }
+        m_sourceProfiler.EndScope(sourceList);
 
-    hr = m_sourceCommandList->Close();
-    if (FAILED(hr)) return false;
+        m_sourceFenceValue++;
+        m_sourceProfiler.EndFrame(sourceList, m_sourceFence.Get(), m_sourceFenceValue);
+        if (!m_sourceCommandRing.Submit(m_sourceCommandQueue.Get(), m_sourceFence.Get(), m_sourceFenceValue)) {
+            SetError(m_sourceCommandRing.GetLastError());
+            return false;
+        }
 
-    ID3D12CommandList* cmdLists[] = { m_sourceCommandList.Get() };
-    m_sourceCommandQueue->ExecuteCommandLists(1, cmdLists);
+        if (m_sourceFence->GetCompletedValue() < m_sourceFenceValue) {
+            m_sourceFence->SetEventOnCompletion(m_sourceFenceValue, m_sourceFenceEvent);
+            WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+        }
 
-    // Wait for copy to complete
-    m_sourceFenceValue++;
-    m_sourceCommandQueue->Signal(m_sourceFence.Get(), m_sourceFenceValue);
-    if (m_sourceFence->GetCompletedValue() < m_sourceFenceValue) {
-        m_sourceFence->SetEventOnCompletion(m_sourceFenceValue, m_sourceFenceEvent);
-        WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+        // === CPU: copy the same regions into the upload buffer ===
+        for (const D3D12_BOX& box : m_copyBoxes) {
+            const size_t offset = static_cast<size_t>(box.top) * m_stagingRowPitch + box.left * 4;
+            m_copyEngine.CopyRows(slot.uploadData + offset, m_stagingRowPitch,
+                                  slot.readbackData + offset, m_stagingRowPitch,
+                                  static_cast<size_t>(box.right - box.left) * 4, box.bottom - box.top);
+        }
     }
 
-    // === CPU: Copy from readback to upload buffer ===
-    void* srcData = nullptr;
-    D3D12_RANGE readRange = { 0, m_stagingSize };
-    hr = m_sourceReadbackBuffer->Map(0, &readRange, &srcData);
-    if (FAILED(hr)) return false;
+    // === Destination GPU: Copy upload buffer to texture ===
+    // Not waited on here: consumers wait on GetDestFenceValue() on the GPU,
+    // and the readback of the next frame overlaps it. The destination
+    // texture is promoted from COMMON to COPY_DEST implicitly.
+    ID3D12GraphicsCommandList* destList = m_destCommandRing.Begin();
+    if (!destList) {
+        SetError(m_destCommandRing.GetLastError());
+        return false;
+    }
 
-    void* dstData = nullptr;
-    D3D12_RANGE writeRange = { 0, 0 };
-    hr = m_destUploadBuffer->Map(0, &writeRange, &dstData);
-    if (FAILED(hr)) {
-        m_sourceReadbackBuffer->Unmap(0, nullptr);
+    // Copy from upload buffer to texture (one box per copied region)
+    D3D12_TEXTURE_COPY_LOCATION srcLoc = {};
+    srcLoc.pResource = slot.uploadBuffer.Get();
+    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLoc.PlacedFootprint = footprint;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLoc = {};
+    dstLoc.pResource = m_destTextures[m_currentBuffer].Get();
+    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLoc.SubresourceIndex = 0;
+
+    m_destProfiler.BeginScope(destList, GpuStage::TransferDest);
+    for (const D3D12_BOX& box : m_copyBoxes) {
+        destList->CopyTextureRegion(&dstLoc, box.left, box.top, 0, &srcLoc, &box);
+    }
+    m_destProfiler.EndScope(destList);
+
+    // Execute and signal fence; the value also retires this slot's upload buffer
+    m_destFenceValue++;
+    m_destProfiler.EndFrame(destList, m_destFence.Get(), m_destFenceValue);
+    if (!m_destCommandRing.Submit(m_destCopyQueue.Get(), m_destFence.Get(), m_destFenceValue)) {
+        SetError(m_destCommandRing.GetLastError());
         return false;
     }
+    slot.uploadFenceValue = m_destFenceValue;
 
-    memcpy(dstData, srcData, m_stagingSize);
+    return true;
+}
 
-    D3D12_RANGE unmapRange = { 0, m_stagingSize };
-    m_destUploadBuffer->Unmap(0, &unmapRange);
-    m_sourceReadbackBuffer->Unmap(0, nullptr);
+bool GPUTransfer::TransferEncoded(ID3D12Resource* sourceTexture, D3D12_RESOURCE_STATES sourceState) {
+    const bool crossAdapter = m_transferMethod == TransferMethod::CrossAdapterHeap;
+    StagingSlot* slot = crossAdapter ? nullptr : &m_stagingSlots[m_currentBuffer];
 
-    // === Destination GPU: Copy upload buffer to texture ===
-    hr = m_destCommandAllocator->Reset();
-    if (FAILED(hr)) return false;
+    // The upload buffer may still be read by this slot's previous unpack
+    if (slot && m_destFence->GetCompletedValue() < slot->uploadFenceValue) {
+        m_destFence->SetEventOnCompletion(slot->uploadFenceValue, m_destFenceEvent);
+        WaitForSingleObject(m_destFenceEvent, INFINITE);
+    }
 
-    hr = m_destCommandList->Reset(m_destCommandAllocator.Get(), nullptr);
-    if (FAILED(hr)) return false;
+    // === Source GPU: pack, then copy the packed frame out in bands ===
+    // Cross-adapter: one band straight into the shared buffer. Staging:
+    // STAGING_BANDS readbacks, each with its own fence value, so the CPU
+    // copy of band k overlaps the readback of band k+1.
+    ID3D12Resource* target = crossAdapter ? m_crossAdapterTextures[m_currentBuffer].Get()
+                                          : slot->readbackBuffer.Get();
+    ID3D12Fence* sourceFence = crossAdapter ? m_sharedFence.Get() : m_sourceFence.Get();
+    const uint32_t bands = crossAdapter ? 1 : STAGING_BANDS;
+    const uint64_t bandBytes = ((m_packedSize + bands - 1) / bands + 255) & ~255ull;
+
+    uint64_t bandFenceValues[STAGING_BANDS] = {};
+    uint32_t bandCount = 0;
+    for (uint64_t offset = 0; offset < m_packedSize; offset += bandBytes, bandCount++) {
+        const uint64_t bytes = (std::min)(bandBytes, m_packedSize - offset);
+
+        ID3D12GraphicsCommandList* sourceList = m_sourceCommandRing.Begin();
+        if (!sourceList) {
+            SetError(m_sourceCommandRing.GetLastError());
+            return false;
+        }
 
-    // Transition destination texture to COPY_DEST
-    D3D12_RESOURCE_BARRIER barrier = {};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = m_destTextures[m_currentBuffer].Get();
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_DEST;
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    m_destCommandList->ResourceBarrier(1, &barrier);
+        m_sourceProfiler.BeginScope(sourceList, GpuStage::TransferSource, bandCount);
+        if (offset == 0) {
+            // Ingest textures rest in COMMON and are promoted for the read
+            D3D12_RESOURCE_BARRIER barrier = {};
+            barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barrier.Transition.pResource = sourceTexture;
+            barrier.Transition.StateBefore = sourceState;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+            barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            const bool transition = sourceState != D3D12_RESOURCE_STATE_COMMON;
+            if (transition) {
+                sourceList->ResourceBarrier(1, &barrier);
+            }
 
-    // Copy from upload buffer to texture
-    srcLoc.pResource = m_destUploadBuffer.Get();
-    srcLoc.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
-    srcLoc.PlacedFootprint = dstLoc.PlacedFootprint;
+            if (!m_encoder.Encode(sourceList, sourceTexture, m_packedBuffer.Get())) {
+                SetError("Failed to record frame pack: " + m_encoder.GetLastError());
+                return false;
+            }
 
-    dstLoc.pResource = m_destTextures[m_currentBuffer].Get();
-    dstLoc.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
-    dstLoc.SubresourceIndex = 0;
+            // Packed buffer: promoted to UAV by the pack, explicit to the copy
+            D3D12_RESOURCE_BARRIER barriers[2] = {};
+            barriers[0].Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+            barriers[0].Transition.pResource = m_packedBuffer.Get();
+            barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+            barriers[0].Transition.StateAfter = D3D12_RESOURCE_STATE_COPY_SOURCE;
+            barriers[0].Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            barriers[1] = barrier;
+            std::swap(barriers[1].Transition.StateBefore, barriers[1].Transition.StateAfter);
+            sourceList->ResourceBarrier(transition ? 2 : 1, barriers);
+        }
+        sourceList->CopyBufferRegion(target, offset, m_packedBuffer.Get(), offset, bytes);
+        m_sourceProfiler.EndScope(sourceList);
 
-    m_destCommandList->CopyTextureRegion(&dstLoc, 0, 0, 0, &srcLoc, nullptr);
+        m_sourceFenceValue++;
+        if (offset + bytes >= m_packedSize) {
+            m_sourceProfiler.EndFrame(sourceList, sourceFence, m_sourceFenceValue);
+        }
+        if (!m_sourceCommandRing.Submit(m_sourceCommandQueue.Get(), sourceFence, m_sourceFenceValue)) {
+            SetError(m_sourceCommandRing.GetLastError());
+            return false;
+        }
+        bandFenceValues[bandCount] = m_sourceFenceValue;
+    }
 
-    // Transition back to PIXEL_SHADER_RESOURCE
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-    m_destCommandList->ResourceBarrier(1, &barrier);
+    if (crossAdapter) {
+        // === Destination GPU: unpack straight from the shared buffer ===
+        // Read once per frame, so there is no local copy first
+        m_destComputeQueue->Wait(m_destSharedFence.Get(), m_sourceFenceValue);
+        return SubmitDecode(m_destSharedTextures[m_currentBuffer].Get());
+    }
+
+    // === CPU: copy each band as soon as it lands ===
+    for (uint32_t band = 0; band < bandCount; band++) {
+        if (m_sourceFence->GetCompletedValue() < bandFenceValues[band]) {
+            m_sourceFence->SetEventOnCompletion(bandFenceValues[band], m_sourceFenceEvent);
+            WaitForSingleObject(m_sourceFenceEvent, INFINITE);
+        }
 
-    hr = m_destCommandList->Close();
-    if (FAILED(hr)) return false;
+        const size_t offset = static_cast<size_t>(band * bandBytes);
+        const size_t bytes = static_cast<size_t>((std::min)(bandBytes, m_packedSize - offset));
+        m_copyEngine.Copy(slot->uploadData + offset, slot->readbackData + offset, bytes);
+    }
 
-    cmdLists[0] = m_destCommandList.Get();
-    m_destCommandQueue->ExecuteCommandLists(1, cmdLists);
+    // === Destination GPU: unpack from the upload buffer ===
+    if (!SubmitDecode(slot->uploadBuffer.Get())) {
+        return false;
+    }
+    slot->uploadFenceValue = m_destFenceValue;
+    return true;
+}
 
-    // Signal fence
-    m_destFenceValue++;
-    m_destCommandQueue->Signal(m_destFence.Get(), m_destFenceValue);
+bool GPUTransfer::SubmitDecode(ID3D12Resource* packedFrame) {
+    ID3D12GraphicsCommandList* destList = m_decodeCommandRing.Begin();
+    if (!destList) {
+        SetError(m_decodeCommandRing.GetLastError());
+        return false;
+    }
+
+    // The ring texture rests in COMMON between frames, like the copy path;
+    // the packed buffer is promoted to a shader resource
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = m_destTextures[m_currentBuffer].Get();
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COMMON;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+
+    m_destProfiler.BeginScope(destList, GpuStage::TransferDest);
+    destList->ResourceBarrier(1, &barrier);
+    if (!m_decoder.Decode(destList, packedFrame, m_destTextures[m_currentBuffer].Get())) {
+        SetError("Failed to record frame unpack: " + m_decoder.GetLastError());
+        return false;
+    }
+    std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+    destList->ResourceBarrier(1, &barrier);
+    m_destProfiler.EndScope(destList);
 
+    m_destFenceValue++;
+    m_destProfiler.EndFrame(destList, m_destFence.Get(), m_destFenceValue);
+    if (!m_decodeCommandRing.Submit(m_destComputeQueue.Get(), m_destFence.Get(), m_destFenceValue)) {
+        SetError(m_decodeCommandRing.GetLastError());
+        return false;
+    }
     return true;
 }
 
@@ -688,6 +1451,13 @@ ID3D12Resource* GPUTransfer::GetPreviousTexture() const {
     return m_destTextures[m_previousBuffer].Get();
 }
 
+ID3D12Resource* GPUTransfer::GetDestinationTexture(uint32_t bufferIndex) const {
+    if (!m_initialized || bufferIndex >= m_destTextures.size()) {
+        return nullptr;
+    }
+    return m_destTextures[bufferIndex].Get();
+}
+
 void GPUTransfer::AdvanceBuffer() {
     m_previousBuffer = m_currentBuffer;
     m_currentBuffer = (m_currentBuffer + 1) % m_config.bufferCount;
@@ -700,9 +1470,17 @@ void GPUTransfer::WaitForTransfer() {
     }
 }
 
+uint64_t GPUTransfer::GetFrameTransferBytes() const {
+    if (m_encoding != TransferEncoding::BGRA8) {
+        return m_packedSize;
+    }
+    return static_cast<uint64_t>(m_config.width) * m_config.height * 4;
+}
+
 void GPUTransfer::ResetStats() {
     m_stats = TransferStats{};
     m_stats.currentMethod = m_transferMethod;
+    m_stats.currentEncoding = m_encoding;
 }
 
 void GPUTransfer::SetError(const std::string& error) {
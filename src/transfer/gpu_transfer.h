@@ -3,6 +3,8 @@
 //
 // This module handles frame transfer between GPUs for dual-GPU frame generation.
 // Supports both peer-to-peer transfers (when available) and staged CPU transfers.
+// Frames cross either as captured or packed (TransferCodec): YCbCr 4:2:0, or
+// 10-bit PQ for HDR captures.
 // MIT License - Part of Open Source Frame Generation project
 
 #pragma once
@@ -25,6 +27,13 @@
 #include <memory>
 #include <chrono>
 
+#include "common/command_ring.h"
+#include "common/dirty_regions.h"
+#include "common/gpu_profiler.h"
+#include "common/parallel_copy.h"
+#include "common/resource_arena.h"
+#include "transfer/transfer_codec.h"
+
 namespace osfg {
 
 using Microsoft::WRL::ComPtr;
@@ -52,12 +61,20 @@ enum class TransferMethod {
 struct TransferStats {
     uint64_t framesTransferred = 0;
     uint64_t bytesTranferred = 0;
+    uint64_t partialTransfers = 0;       // Frames copied as dirty regions only
     double avgTransferTimeMs = 0.0;
     double lastTransferTimeMs = 0.0;
     double minTransferTimeMs = 1000000.0;
     double maxTransferTimeMs = 0.0;
     double throughputMBps = 0.0;
+
+    // GPU timestamps (TransferConfig::gpuProfiling), read back a few frames
+    // late. The times above are CPU submission time, including waits.
+    double gpuSourceTimeMs = 0.0;        // Primary GPU: copy into the shared texture / readback
+    double gpuDestTimeMs = 0.0;          // Secondary GPU copy queue
+    double destQueueBubbleMs = 0.0;      // Copy queue idle on the cross-GPU fence after recording
     TransferMethod currentMethod = TransferMethod::Unknown;
+    TransferEncoding currentEncoding = TransferEncoding::BGRA8;
 };
 
 // Configuration for GPU transfer
@@ -70,6 +87,27 @@ struct TransferConfig {
     uint32_t bufferCount = 3;            // Triple buffer for latency hiding
     bool preferPeerToPeer = true;        // Try P2P first
     bool allowCPUFallback = true;        // Fall back to CPU staging if needed
+    bool createIngestTextures = false;   // Shared per-buffer textures another device writes into
+    bool gpuProfiling = true;            // Timestamp both copies (needs copy queue timestamps)
+
+    // YCbCr420: pack on the source GPU and unpack in a compute pass on the
+    // destination GPU (1.5 instead of 4 bytes per pixel over the bus, whole
+    // frames only). Falls back to BGRA8 for formats or devices the codec
+    // does not support; GetEncoding() reports what is in use.
+    // HDR10: R16G16B16A16_FLOAT frames cross as 4-byte PQ words and land in
+    // R10G10B10A2_UNORM textures. There is no fallback: crossing as FP16
+    // would double the bytes, so Initialize() fails instead.
+    TransferEncoding encoding = TransferEncoding::BGRA8;
+
+    // Devices of sourceAdapterIndex and destAdapterIndex to run on instead
+    // of creating a pair (both or neither), so several transfers - one per
+    // captured output - share them. Queues, fences and rings stay per
+    // transfer. Arenas of those devices to place the per-resolution
+    // resources in instead of the transfer's own (nullptr = own).
+    ID3D12Device* sourceDevice = nullptr;
+    ID3D12Device* destDevice = nullptr;
+    ResourceArena* sourceArena = nullptr;
+    ResourceArena* destArena = nullptr;
 };
 
 // Inter-GPU transfer engine
@@ -94,18 +132,74 @@ public:
     // Shutdown and release resources
     void Shutdown();
 
+    // Re-create the size-dependent resources (ring textures, cross-adapter
+    // heap or staging buffers, ingest textures) for a new frame size. Devices,
+    // queues, fences and the transfer method are kept. Waits for queued
+    // transfers; the caller must not have GPU work reading the old textures in
+    // flight. Ingest texture handles change, the ingest fence handle does not.
+    // bufferCount: new ring size (0 = keep).
+    bool Resize(uint32_t width, uint32_t height, uint32_t bufferCount = 0);
+
     // Transfer a frame from source GPU to destination GPU
     // sourceTexture: Texture on source GPU (must be in COPY_SOURCE state)
+    // dirtyRects: regions that changed since the previous frame, or nullptr
+    //             if the whole frame changed. Each buffer receives only the
+    //             regions changed since it was last written, so every frame
+    //             must be passed through here (or InvalidateRegions() called).
     // Returns true on success
-    bool TransferFrame(ID3D12Resource* sourceTexture);
+    bool TransferFrame(ID3D12Resource* sourceTexture,
+                       const RECT* dirtyRects = nullptr, uint32_t dirtyRectCount = 0);
+
+    // Transfer the frame another device wrote into GetIngestTextureHandle(
+    // GetCurrentBufferIndex()). The source queue waits on the ingest fence
+    // for ingestFenceValue before copying, so there is no CPU wait.
+    // Requires TransferConfig::createIngestTextures.
+    bool TransferIngestedFrame(uint64_t ingestFenceValue,
+                               const RECT* dirtyRects = nullptr, uint32_t dirtyRectCount = 0);
+
+    // Transfer a frame from CPU memory (e.g. a mapped staging texture of
+    // another device, at the source format and size): the whole frame is
+    // uploaded into the current ingest texture on the source queue, then
+    // transferred like TransferIngestedFrame(). For writers that cannot open
+    // the shared handles. Requires TransferConfig::createIngestTextures.
+    bool TransferUploadedFrame(const void* pixels, uint32_t rowPitch,
+                               const RECT* dirtyRects = nullptr, uint32_t dirtyRectCount = 0);
+
+    // Block until the transfer has finished reading ingest texture
+    // `bufferIndex`. Another device must call this before writing it.
+    void WaitForIngestSlot(uint32_t bufferIndex);
+
+    // Force the next transfer into each buffer to be a full copy
+    void InvalidateRegions() { m_dirtyRegions.Invalidate(); }
+
+    // Shared NT handles for the ingest textures (source GPU, COMMON state)
+    // and the shared fence the writing device signals. Owned by GPUTransfer.
+    // nullptr where the device cannot share them; use TransferUploadedFrame().
+    HANDLE GetIngestTextureHandle(uint32_t bufferIndex) const;
+    HANDLE GetIngestFenceHandle() const { return m_ingestFenceHandle; }
 
     // Get the transferred texture on the destination GPU
-    // Returns the most recently transferred frame (in PIXEL_SHADER_RESOURCE state)
+    // Returns the most recently transferred frame. Destination textures are
+    // written on a COPY queue and rest in COMMON; reads promote them.
     ID3D12Resource* GetDestinationTexture() const;
 
     // Get the previous frame texture (for optical flow)
     ID3D12Resource* GetPreviousTexture() const;
 
+    // Get a specific destination buffer by ring index
+    // (for pipelined consumers that track buffer ownership themselves)
+    ID3D12Resource* GetDestinationTexture(uint32_t bufferIndex) const;
+
+    // Ring slot the next TransferFrame() writes into
+    uint32_t GetCurrentBufferIndex() const { return m_currentBuffer; }
+
+    // Number of destination buffers in the ring
+    uint32_t GetBufferCount() const { return m_config.bufferCount; }
+
+    // Format of the destination textures (R10G10B10A2_UNORM with HDR10,
+    // otherwise TransferConfig::format)
+    DXGI_FORMAT GetDestinationFormat() const { return TransferCodec::GetDecodedFormat(m_encoding, m_config.format); }
+
     // Advance to next buffer (call after processing current frame)
     void AdvanceBuffer();
 
@@ -118,9 +212,21 @@ public:
     // Get destination GPU D3D12 device
     ID3D12Device* GetDestDevice() const { return m_destDevice.Get(); }
 
-    // Get destination command queue (for frame generation work)
+    // Heap arena of the destination device (TransferConfig::destArena, or
+    // the transfer's own). Holds the transfer's per-resolution resources;
+    // other modules on the device may place theirs in it too (released
+    // before this object shuts down).
+    ResourceArena* GetDestArena() { return m_destArena; }
+
+    // Get destination command queue (DIRECT, for presentation and other work)
     ID3D12CommandQueue* GetDestCommandQueue() const { return m_destCommandQueue.Get(); }
 
+    // Destination fence and the value signalled by the latest transfer's
+    // copy on the destination copy queue. Queues reading
+    // GetDestinationTexture() must Wait() for it.
+    ID3D12Fence* GetDestFence() const { return m_destFence.Get(); }
+    uint64_t GetDestFenceValue() const { return m_destFenceValue; }
+
     // Get transfer statistics
     const TransferStats& GetStats() const { return m_stats; }
 
@@ -136,11 +242,26 @@ public:
     // Get current transfer method
     TransferMethod GetTransferMethod() const { return m_transferMethod; }
 
+    // Get the encoding frames cross the bus in
+    TransferEncoding GetEncoding() const { return m_encoding; }
+
+    // Bytes moved between the GPUs for one full frame
+    uint64_t GetFrameTransferBytes() const;
+
 private:
     bool CreateDevices();
+    bool CreateDevicePair();            // Both devices, unless TransferConfig gives them
     bool CreateCrossAdapterResources();
     bool CreateStagingResources();
     bool CreateSyncObjects();
+    bool CreateIngestResources();
+    bool CreateIngestTextures();
+    bool CreateIngestTextureSet(bool shared);
+    bool CreateIngestUploadBuffer();
+    bool CreateDestinationTextures();
+    bool CreateCodec(uint32_t sourceSets, uint32_t destSets);
+    bool CreatePackedBuffer();
+    void ReleaseFrameResources();
     void SetError(const std::string& error);
 
     // Cross-adapter transfer implementation
@@ -149,28 +270,75 @@ private:
     // Staged CPU transfer implementation (fallback)
     bool TransferViaStaging(ID3D12Resource* sourceTexture);
 
+    // Packed transfer (either method): pack and copy out on the source GPU,
+    // unpack on the destination compute queue
+    bool TransferEncoded(ID3D12Resource* sourceTexture, D3D12_RESOURCE_STATES sourceState);
+    bool SubmitDecode(ID3D12Resource* packedFrame);
+
+    bool TransferFrameFrom(ID3D12Resource* sourceTexture, D3D12_RESOURCE_STATES sourceState,
+                           const RECT* dirtyRects, uint32_t dirtyRectCount);
+    // Transfer the current ingest texture and record when it retires
+    bool TransferIngestTexture(const RECT* dirtyRects, uint32_t dirtyRectCount);
+
     // Source GPU resources
     ComPtr<ID3D12Device> m_sourceDevice;
     ComPtr<ID3D12CommandQueue> m_sourceCommandQueue;
-    ComPtr<ID3D12CommandAllocator> m_sourceCommandAllocator;
-    ComPtr<ID3D12GraphicsCommandList> m_sourceCommandList;
+    CommandAllocatorRing m_sourceCommandRing;  // One allocator per ring buffer
 
     // Destination GPU resources
     ComPtr<ID3D12Device> m_destDevice;
     ComPtr<ID3D12CommandQueue> m_destCommandQueue;
-    ComPtr<ID3D12CommandAllocator> m_destCommandAllocator;
-    ComPtr<ID3D12GraphicsCommandList> m_destCommandList;
-
-    // Cross-adapter shared resources (heap-based sharing)
+    ComPtr<ID3D12CommandQueue> m_destCopyQueue;   // Incoming frame copies
+    CommandAllocatorRing m_destCommandRing;       // COPY lists for m_destCopyQueue
+
+    // GPU timestamps of the source queue and the queue frames land on
+    // (destination copy queue, or the unpack queue when encoding)
+    GpuProfiler m_sourceProfiler;
+    GpuProfiler m_destProfiler;
+
+    // Packed transfer: codec per device, the source GPU's pack target and
+    // the destination compute queue that unpacks into m_destTextures
+    TransferEncoding m_encoding = TransferEncoding::BGRA8;
+    TransferCodec m_encoder;
+    TransferCodec m_decoder;
+    ComPtr<ID3D12Resource> m_packedBuffer;        // Source GPU, rests in COMMON
+    uint64_t m_packedSize = 0;
+    ComPtr<ID3D12CommandQueue> m_destComputeQueue;
+    CommandAllocatorRing m_decodeCommandRing;
+
+    // Cross-adapter shared resources (heap-based sharing); packed buffers
+    // instead of textures when encoding
     ComPtr<ID3D12Heap> m_crossAdapterHeap;
     std::vector<ComPtr<ID3D12Resource>> m_crossAdapterTextures;  // On source GPU
-    std::vector<ComPtr<ID3D12Resource>> m_destTextures;          // On dest GPU
+    std::vector<ComPtr<ID3D12Resource>> m_destSharedTextures;    // Same heap, opened on dest GPU
+    std::vector<ComPtr<ID3D12Resource>> m_destTextures;          // Local copies on dest GPU
 
     // CPU staging resources (fallback path)
-    ComPtr<ID3D12Resource> m_sourceReadbackBuffer;
-    ComPtr<ID3D12Resource> m_destUploadBuffer;
-    void* m_stagingMemory = nullptr;
+    // One persistently mapped readback/upload pair per ring buffer. The
+    // readback is split into STAGING_BANDS row bands so the CPU copy of band
+    // k overlaps the GPU readback of band k+1, and the destination upload of
+    // frame N runs on the GPU while frame N+1 is read back.
+    struct StagingSlot {
+        ComPtr<ID3D12Resource> readbackBuffer;  // Source GPU, READBACK heap
+        ComPtr<ID3D12Resource> uploadBuffer;    // Destination GPU, UPLOAD heap
+        uint8_t* readbackData = nullptr;
+        uint8_t* uploadData = nullptr;
+        uint64_t uploadFenceValue = 0;          // m_destFence value after which uploadBuffer is free
+    };
+    static const uint32_t STAGING_BANDS = 4;
+    std::vector<StagingSlot> m_stagingSlots;
     size_t m_stagingSize = 0;
+    uint32_t m_stagingRowPitch = 0;
+    ParallelCopyEngine m_copyEngine;           // Banded non-temporal CPU copy
+
+    // Per-resolution resources that are not shared across adapters (packed
+    // buffer, staging buffers, destination textures) are placed in these,
+    // so Resize() re-places them in memory the arenas already hold. They
+    // point at the configured arenas or the transfer's own.
+    ResourceArena m_ownSourceArena;
+    ResourceArena m_ownDestArena;
+    ResourceArena* m_sourceArena = nullptr;
+    ResourceArena* m_destArena = nullptr;
 
     // Synchronization
     ComPtr<ID3D12Fence> m_sourceFence;
@@ -180,10 +348,30 @@ private:
     uint64_t m_sourceFenceValue = 0;
     uint64_t m_destFenceValue = 0;
 
-    // Shared fence for cross-adapter sync
+    // Shared fence for cross-adapter sync (signalled on source, waited on dest)
     ComPtr<ID3D12Fence> m_sharedFence;
+    ComPtr<ID3D12Fence> m_destSharedFence;  // Same fence opened on the destination device
     HANDLE m_sharedFenceHandle = nullptr;
 
+    // Ingest textures: written by the capture device, read by the transfer
+    std::vector<ComPtr<ID3D12Resource>> m_ingestTextures;
+    std::vector<HANDLE> m_ingestTextureHandles;
+    std::vector<uint64_t> m_ingestRetireValues;    // m_sourceFence value after which each is free
+    ComPtr<ID3D12Fence> m_ingestFence;
+    HANDLE m_ingestFenceHandle = nullptr;
+
+    // TransferUploadedFrame(): one persistently mapped frame on the source GPU
+    ComPtr<ID3D12Resource> m_ingestUploadBuffer;
+    uint8_t* m_ingestUploadData = nullptr;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT m_ingestUploadFootprint = {};
+    UINT64 m_ingestUploadRowBytes = 0;
+    uint64_t m_ingestUploadFenceValue = 0;         // m_sourceFence value after which it is free
+
+    // Dirty-region tracking per ring buffer; m_copyBoxes holds the boxes the
+    // current transfer copies (one full-frame box for a full copy)
+    DirtyRegionTracker m_dirtyRegions;
+    std::vector<D3D12_BOX> m_copyBoxes;
+
     // State
     TransferConfig m_config;
     TransferMethod m_transferMethod = TransferMethod::Unknown;
@@ -0,0 +1,200 @@
+// OSFG - Open Source Frame Generation
+// Local Frame Ring Implementation
+
+#include "local_frame_ring.h"
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+namespace osfg {
+
+LocalFrameRing::~LocalFrameRing() {
+    Shutdown();
+}
+
+bool LocalFrameRing::Initialize(const LocalFrameRingConfig& config) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    m_config = config;
+    if (m_config.bufferCount == 0) {
+        m_config.bufferCount = 1;
+    }
+
+    if (!CreateDevice() || !CreateSharedResources()) {
+        Shutdown();
+        return false;
+    }
+
+    m_currentBuffer = 0;
+    m_initialized = true;
+    return true;
+}
+
+void LocalFrameRing::Shutdown() {
+    ReleaseTextures();
+    if (m_fenceHandle) {
+        CloseHandle(m_fenceHandle);
+        m_fenceHandle = nullptr;
+    }
+
+    m_fence.Reset();
+    m_commandQueue.Reset();
+    m_device.Reset();
+
+    m_currentBuffer = 0;
+    m_initialized = false;
+}
+
+bool LocalFrameRing::Resize(uint32_t width, uint32_t height, uint32_t bufferCount) {
+    if (!m_initialized) {
+        m_lastError = "Not initialized";
+        return false;
+    }
+
+    if (bufferCount == 0) {
+        bufferCount = m_config.bufferCount;
+    }
+    if (width == m_config.width && height == m_config.height && bufferCount == m_config.bufferCount) {
+        return true;
+    }
+
+    ReleaseTextures();
+    m_config.width = width;
+    m_config.height = height;
+    m_config.bufferCount = bufferCount;
+    if (!CreateTextures()) {
+        m_initialized = false;
+        return false;
+    }
+
+    m_currentBuffer = 0;
+    return true;
+}
+
+void LocalFrameRing::ReleaseTextures() {
+    for (HANDLE handle : m_textureHandles) {
+        if (handle) {
+            CloseHandle(handle);
+        }
+    }
+    m_textureHandles.clear();
+    m_textures.clear();
+}
+
+bool LocalFrameRing::CreateDevice() {
+    ComPtr<IDXGIFactory6> factory;
+    HRESULT hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&factory));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create DXGI factory";
+        return false;
+    }
+
+    ComPtr<IDXGIAdapter1> adapter;
+    hr = factory->EnumAdapters1(m_config.adapterIndex, &adapter);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to get adapter";
+        return false;
+    }
+
+    hr = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create D3D12 device";
+        return false;
+    }
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+    hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create command queue";
+        return false;
+    }
+
+    return true;
+}
+
+bool LocalFrameRing::CreateSharedResources() {
+    if (!CreateTextures()) {
+        return false;
+    }
+
+    HRESULT hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_SHARED, IID_PPV_ARGS(&m_fence));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create frame fence";
+        return false;
+    }
+
+    hr = m_device->CreateSharedHandle(m_fence.Get(), nullptr, GENERIC_ALL, nullptr, &m_fenceHandle);
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create frame fence handle";
+        return false;
+    }
+
+    return true;
+}
+
+bool LocalFrameRing::CreateTextures() {
+    HRESULT hr;
+
+    // Same layout as GPUTransfer's ingest textures, but these are read in
+    // place instead of being copied to another adapter
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC textureDesc = {};
+    textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    textureDesc.Width = m_config.width;
+    textureDesc.Height = m_config.height;
+    textureDesc.DepthOrArraySize = 1;
+    textureDesc.MipLevels = 1;
+    textureDesc.Format = m_config.format;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    m_textures.resize(m_config.bufferCount);
+    m_textureHandles.assign(m_config.bufferCount, nullptr);
+
+    for (uint32_t i = 0; i < m_config.bufferCount; i++) {
+        hr = m_device->CreateCommittedResource(
+            &heapProps, D3D12_HEAP_FLAG_SHARED,
+            &textureDesc, RESTING_STATE,
+            nullptr, IID_PPV_ARGS(&m_textures[i]));
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create frame texture " + std::to_string(i);
+            return false;
+        }
+
+        hr = m_device->CreateSharedHandle(m_textures[i].Get(), nullptr, GENERIC_ALL,
+                                          nullptr, &m_textureHandles[i]);
+        if (FAILED(hr)) {
+            m_lastError = "Failed to create frame texture handle " + std::to_string(i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+HANDLE LocalFrameRing::GetTextureHandle(uint32_t bufferIndex) const {
+    if (bufferIndex >= m_textureHandles.size()) {
+        return nullptr;
+    }
+    return m_textureHandles[bufferIndex];
+}
+
+ID3D12Resource* LocalFrameRing::GetTexture(uint32_t bufferIndex) const {
+    if (!m_initialized || bufferIndex >= m_textures.size()) {
+        return nullptr;
+    }
+    return m_textures[bufferIndex].Get();
+}
+
+void LocalFrameRing::AdvanceBuffer() {
+    m_currentBuffer = (m_currentBuffer + 1) % m_config.bufferCount;
+}
+
+} // namespace osfg
@@ -0,0 +1,116 @@
+// OSFG - Open Source Frame Generation
+// Local Frame Ring (Single-GPU mode)
+//
+// Ring of shared textures on one D3D12 device that the capture device writes
+// into directly. Frame generation and presentation read the same textures on
+// the same adapter, so there is no cross-adapter heap, staging buffer or
+// per-frame copy: GPUTransfer is not involved at all.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Configuration for the local frame ring
+struct LocalFrameRingConfig {
+    uint32_t adapterIndex = 0;           // Capture and frame generation GPU
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    uint32_t bufferCount = 3;
+};
+
+class LocalFrameRing {
+public:
+    LocalFrameRing() = default;
+    ~LocalFrameRing();
+
+    // Non-copyable
+    LocalFrameRing(const LocalFrameRing&) = delete;
+    LocalFrameRing& operator=(const LocalFrameRing&) = delete;
+
+    // Create the device, its direct queue, the shared textures and fence
+    bool Initialize(const LocalFrameRingConfig& config);
+
+    // Shutdown and release resources
+    void Shutdown();
+
+    // Re-create the ring textures for a new frame size, keeping the device,
+    // queue and fence. No GPU work may still read the old textures. Texture
+    // handles change, the fence handle does not. bufferCount: new ring size
+    // (0 = keep).
+    bool Resize(uint32_t width, uint32_t height, uint32_t bufferCount = 0);
+
+    bool IsInitialized() const { return m_initialized; }
+
+    // Shared NT handles for the ring textures and the fence the writing
+    // device signals (see CaptureSource::OpenSharedTargets). Owned by the ring.
+    HANDLE GetTextureHandle(uint32_t bufferIndex) const;
+    HANDLE GetFenceHandle() const { return m_fenceHandle; }
+
+    // Fence the writer signals after each frame. Queues reading a ring
+    // texture Wait() for the value the writer reported for it.
+    ID3D12Fence* GetFence() const { return m_fence.Get(); }
+
+    // Ring texture by index. Textures rest in COMMON so the capture device
+    // can write them; reads promote them implicitly and explicit barriers
+    // must start from COMMON.
+    ID3D12Resource* GetTexture(uint32_t bufferIndex) const;
+    static const D3D12_RESOURCE_STATES RESTING_STATE = D3D12_RESOURCE_STATE_COMMON;
+
+    // Ring slot the writer fills next
+    uint32_t GetCurrentBufferIndex() const { return m_currentBuffer; }
+
+    // Number of textures in the ring
+    uint32_t GetBufferCount() const { return m_config.bufferCount; }
+
+    // Advance to next buffer (call after processing current frame)
+    void AdvanceBuffer();
+
+    // Device and its direct queue (presentation)
+    ID3D12Device* GetDevice() const { return m_device.Get(); }
+    ID3D12CommandQueue* GetCommandQueue() const { return m_commandQueue.Get(); }
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool CreateDevice();
+    bool CreateSharedResources();
+    bool CreateTextures();
+    void ReleaseTextures();
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12CommandQueue> m_commandQueue;
+
+    std::vector<ComPtr<ID3D12Resource>> m_textures;
+    std::vector<HANDLE> m_textureHandles;
+    ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceHandle = nullptr;
+
+    LocalFrameRingConfig m_config;
+    uint32_t m_currentBuffer = 0;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
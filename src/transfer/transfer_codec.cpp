@@ -0,0 +1,505 @@
+// OSFG - Open Source Frame Generation
+// Transfer Codec Implementation
+
+#include "transfer_codec.h"
+#include "common/precompiled_shader.h"
+
+#include <d3dcompiler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+
+namespace osfg {
+
+// One thread per 4x2 pixel block: two 32-bit luma words (one per row) and
+// one chroma word (two CbCr pairs), so every store is a whole aligned word.
+// HDR10 stores one 10:10:10:2 word per pixel of the block.
+static const char* g_TransferCodecShaderSource = R"(
+cbuffer Constants : register(b0)
+{
+    uint g_Width;
+    uint g_Height;
+    uint g_Pitch;          // Bytes per row (YCbCr420: of either plane, width rounded up to 4)
+    uint g_ChromaOffset;   // Byte offset of the CbCr plane (YCbCr420)
+};
+
+#ifdef ENCODE
+Texture2D<float4> g_Frame : register(t0);
+RWByteAddressBuffer g_Packed : register(u0);
+#else
+ByteAddressBuffer g_Packed : register(t0);
+RWTexture2D<float4> g_Frame : register(u0);
+#endif
+
+// BT.709, full range
+float3 RgbToYCbCr(float3 rgb)
+{
+    float y = dot(rgb, float3(0.2126, 0.7152, 0.0722));
+    return float3(y, (rgb.b - y) / 1.8556 + 0.5, (rgb.r - y) / 1.5748 + 0.5);
+}
+
+float3 YCbCrToRgb(float y, float2 cbcr)
+{
+    float cb = cbcr.x - 0.5;
+    float cr = cbcr.y - 0.5;
+    float r = y + 1.5748 * cr;
+    float b = y + 1.8556 * cb;
+    float g = (y - 0.2126 * r - 0.0722 * b) / 0.7152;
+    return saturate(float3(r, g, b));
+}
+
+uint PackUnorm4(float4 v)
+{
+    uint4 bytes = uint4(round(saturate(v) * 255.0));
+    return bytes.x | (bytes.y << 8) | (bytes.z << 16) | (bytes.w << 24);
+}
+
+float4 UnpackUnorm4(uint v)
+{
+    return float4(v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, v >> 24) / 255.0;
+}
+
+#ifdef HDR10
+// scRGB is linear BT.709 with 1.0 = 80 nits; HDR10 is BT.2020 primaries
+// through the SMPTE ST 2084 (PQ) curve, 1.0 = 10000 nits
+static const float3x3 BT709_TO_BT2020 = {
+    0.627404, 0.329283, 0.043313,
+    0.069097, 0.919541, 0.011362,
+    0.016391, 0.088013, 0.895595
+};
+
+float3 ScRgbToPQ(float3 scRgb)
+{
+    float3 nits = max(mul(BT709_TO_BT2020, scRgb), 0.0) * 80.0;
+    float3 y = pow(saturate(nits / 10000.0), 0.1593017578125);
+    return pow((0.8359375 + 18.8515625 * y) / (1.0 + 18.6875 * y), 78.84375);
+}
+
+uint PackUnorm1010102(float4 v)
+{
+    uint4 q = uint4(round(saturate(v) * float4(1023.0, 1023.0, 1023.0, 3.0)));
+    return q.x | (q.y << 10) | (q.z << 20) | (q.w << 30);
+}
+
+float4 UnpackUnorm1010102(uint v)
+{
+    return float4(v & 0x3FF, (v >> 10) & 0x3FF, (v >> 20) & 0x3FF, v >> 30) /
+           float4(1023.0, 1023.0, 1023.0, 3.0);
+}
+#endif
+
+#ifdef ENCODE
+[numthreads(8, 8, 1)]
+void CSEncode(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    uint2 origin = dispatchThreadId.xy * uint2(4, 2);
+    if (origin.x >= g_Width || origin.y >= g_Height)
+        return;
+
+#ifdef HDR10
+    [unroll]
+    for (uint row = 0; row < 2; row++) {
+        [unroll]
+        for (uint col = 0; col < 4; col++) {
+            uint2 pixel = origin + uint2(col, row);
+            if (pixel.x < g_Width && pixel.y < g_Height)
+                g_Packed.Store(pixel.y * g_Pitch + pixel.x * 4,
+                               PackUnorm1010102(float4(ScRgbToPQ(g_Frame[pixel].rgb), 1.0)));
+        }
+    }
+#else
+    // Edge blocks repeat the last column/row into the padding
+    uint2 last = uint2(g_Width - 1, g_Height - 1);
+    float4 luma[2];
+    float4 chroma = 0.0;
+
+    [unroll]
+    for (uint row = 0; row < 2; row++) {
+        [unroll]
+        for (uint col = 0; col < 4; col++) {
+            float3 ycc = RgbToYCbCr(g_Frame[min(origin + uint2(col, row), last)].rgb);
+            luma[row][col] = ycc.x;
+            if (col < 2)
+                chroma.xy += ycc.yz * 0.25;
+            else
+                chroma.zw += ycc.yz * 0.25;
+        }
+    }
+
+    g_Packed.Store(origin.y * g_Pitch + origin.x, PackUnorm4(luma[0]));
+    g_Packed.Store((origin.y + 1) * g_Pitch + origin.x, PackUnorm4(luma[1]));
+    g_Packed.Store(g_ChromaOffset + (origin.y / 2) * g_Pitch + origin.x, PackUnorm4(chroma));
+#endif
+}
+#else
+[numthreads(8, 8, 1)]
+void CSDecode(uint3 dispatchThreadId : SV_DispatchThreadID)
+{
+    uint2 origin = dispatchThreadId.xy * uint2(4, 2);
+    if (origin.x >= g_Width || origin.y >= g_Height)
+        return;
+
+#ifdef HDR10
+    [unroll]
+    for (uint row = 0; row < 2; row++) {
+        [unroll]
+        for (uint col = 0; col < 4; col++) {
+            uint2 pixel = origin + uint2(col, row);
+            if (pixel.x < g_Width && pixel.y < g_Height)
+                g_Frame[pixel] = UnpackUnorm1010102(g_Packed.Load(pixel.y * g_Pitch + pixel.x * 4));
+        }
+    }
+#else
+    float4 chroma = UnpackUnorm4(g_Packed.Load(g_ChromaOffset + (origin.y / 2) * g_Pitch + origin.x));
+
+    [unroll]
+    for (uint row = 0; row < 2; row++) {
+        float4 luma = UnpackUnorm4(g_Packed.Load((origin.y + row) * g_Pitch + origin.x));
+
+        [unroll]
+        for (uint col = 0; col < 4; col++) {
+            uint2 pixel = origin + uint2(col, row);
+            if (pixel.x < g_Width && pixel.y < g_Height)
+                g_Frame[pixel] = float4(YCbCrToRgb(luma[col], col < 2 ? chroma.xy : chroma.zw), 1.0);
+        }
+    }
+#endif
+}
+#endif
+)";
+
+} // namespace osfg
+
+// DXIL for both kernels, compiled by the build (see osfg_precompile_shaders)
+#ifdef OSFG_PRECOMPILED_SHADERS
+#include "g_TransferCodecShaderSource_dxil.h"
+#endif
+
+namespace osfg {
+
+struct TransferCodecConstants {
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t chromaOffset;
+};
+
+static const uint32_t BLOCK_WIDTH = 4;
+static const uint32_t BLOCK_HEIGHT = 2;
+static const uint32_t GROUP_SIZE = 8;
+
+static bool IsCodecFormat(TransferEncoding encoding, DXGI_FORMAT format) {
+    if (encoding == TransferEncoding::HDR10) {
+        return format == DXGI_FORMAT_R16G16B16A16_FLOAT;
+    }
+    switch (format) {
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return encoding == TransferEncoding::YCbCr420;
+    default:
+        return false;
+    }
+}
+
+TransferCodec::~TransferCodec() {
+    Shutdown();
+}
+
+uint32_t TransferCodec::GetPackedPitch(TransferEncoding encoding, uint32_t width) {
+    if (encoding == TransferEncoding::HDR10) {
+        return width * 4;
+    }
+    return (width + BLOCK_WIDTH - 1) & ~(BLOCK_WIDTH - 1);
+}
+
+uint64_t TransferCodec::GetChromaOffset(uint32_t width, uint32_t height) {
+    const uint64_t rows = (height + BLOCK_HEIGHT - 1) & ~(BLOCK_HEIGHT - 1);
+    return rows * GetPackedPitch(TransferEncoding::YCbCr420, width);
+}
+
+uint64_t TransferCodec::GetPackedSize(TransferEncoding encoding, uint32_t width, uint32_t height) {
+    if (encoding == TransferEncoding::HDR10) {
+        return static_cast<uint64_t>(GetPackedPitch(encoding, width)) * height;
+    }
+    // Luma, then half as many chroma rows of the same pitch
+    return GetChromaOffset(width, height) * 3 / 2;
+}
+
+DXGI_FORMAT TransferCodec::GetDecodedFormat(TransferEncoding encoding, DXGI_FORMAT format) {
+    return encoding == TransferEncoding::HDR10 ? DXGI_FORMAT_R10G10B10A2_UNORM : format;
+}
+
+bool TransferCodec::IsSupported(ID3D12Device* device, TransferEncoding encoding, TransferCodecMode mode,
+                                DXGI_FORMAT format) {
+    if (!device || !IsCodecFormat(encoding, format)) {
+        return false;
+    }
+    if (mode == TransferCodecMode::Encode) {
+        return true;
+    }
+
+    D3D12_FEATURE_DATA_FORMAT_SUPPORT support = { GetDecodedFormat(encoding, format) };
+    return SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_FORMAT_SUPPORT, &support, sizeof(support))) &&
+           (support.Support2 & D3D12_FORMAT_SUPPORT2_UAV_TYPED_STORE) != 0;
+}
+
+bool TransferCodec::Initialize(ID3D12Device* device, TransferEncoding encoding, TransferCodecMode mode,
+                               DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t descriptorSets) {
+    if (m_initialized) {
+        Shutdown();
+    }
+
+    if (!IsSupported(device, encoding, mode, format)) {
+        m_lastError = "Transfer codec not supported for this format";
+        return false;
+    }
+
+    m_device = device;
+    m_encoding = encoding;
+    m_mode = mode;
+    m_format = format;
+    m_width = width;
+    m_height = height;
+    m_descriptorSets = (std::max)(1u, (std::min)(descriptorSets, MAX_DESCRIPTOR_SETS));
+    m_nextSet = 0;
+
+    if (!CreateRootSignature() || !CreatePipelineState()) {
+        Shutdown();
+        return false;
+    }
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    heapDesc.NumDescriptors = m_descriptorSets * 2;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    HRESULT hr = m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_descriptorHeap));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create codec descriptor heap";
+        Shutdown();
+        return false;
+    }
+    m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    m_initialized = true;
+    return true;
+}
+
+void TransferCodec::Shutdown() {
+    m_descriptorHeap.Reset();
+    m_pipelineState.Reset();
+    m_rootSignature.Reset();
+    m_device.Reset();
+    m_descriptorSets = 0;
+    m_nextSet = 0;
+    m_initialized = false;
+}
+
+void TransferCodec::Resize(uint32_t width, uint32_t height) {
+    m_width = width;
+    m_height = height;
+}
+
+bool TransferCodec::CreateRootSignature() {
+    // [0] Constants, [1] SRV table (frame or packed buffer), [2] UAV table
+    D3D12_DESCRIPTOR_RANGE srvRange = {};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+
+    D3D12_DESCRIPTOR_RANGE uavRange = {};
+    uavRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_UAV;
+    uavRange.NumDescriptors = 1;
+
+    D3D12_ROOT_PARAMETER rootParams[3] = {};
+    rootParams[0].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    rootParams[0].Constants.ShaderRegister = 0;
+    rootParams[0].Constants.Num32BitValues = sizeof(TransferCodecConstants) / sizeof(uint32_t);
+    rootParams[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    rootParams[1].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[1].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[1].DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParams[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    rootParams[2].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParams[2].DescriptorTable.NumDescriptorRanges = 1;
+    rootParams[2].DescriptorTable.pDescriptorRanges = &uavRange;
+    rootParams[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+    D3D12_ROOT_SIGNATURE_DESC rootSigDesc = {};
+    rootSigDesc.NumParameters = 3;
+    rootSigDesc.pParameters = rootParams;
+
+    ComPtr<ID3DBlob> signature;
+    ComPtr<ID3DBlob> error;
+    HRESULT hr = D3D12SerializeRootSignature(&rootSigDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error);
+    if (FAILED(hr)) {
+        m_lastError = error ? "Root signature serialization failed: " +
+                              std::string(static_cast<const char*>(error->GetBufferPointer()))
+                            : "Root signature serialization failed";
+        return false;
+    }
+
+    hr = m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(),
+                                       IID_PPV_ARGS(&m_rootSignature));
+    if (FAILED(hr)) {
+        m_lastError = "Failed to create codec root signature";
+        return false;
+    }
+    return true;
+}
+
+bool TransferCodec::CreatePipelineState() {
+    const bool encode = m_mode == TransferCodecMode::Encode;
+    const char* entryPoint = encode ? "CSEncode" : "CSDecode";
+    const bool hdr10 = m_encoding == TransferEncoding::HDR10;
+    const D3D_SHADER_MACRO encodeDefines[] = { { "ENCODE", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO decodeHdrDefines[] = { { "HDR10", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO encodeHdrDefines[] = { { "ENCODE", "1" }, { "HDR10", "1" }, { nullptr, nullptr } };
+    const D3D_SHADER_MACRO* defines = encode ? (hdr10 ? encodeHdrDefines : encodeDefines)
+                                             : (hdr10 ? decodeHdrDefines : nullptr);
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = m_rootSignature.Get();
+
+    // Prefer the DXIL the build compiled; fall back to FXC at runtime
+    ComPtr<ID3DBlob> shaderBlob;
+#ifdef OSFG_PRECOMPILED_SHADERS
+    if (SupportsShaderModel6(m_device.Get())) {
+        if (const PrecompiledShader* precompiled = FindPrecompiledShader(
+                g_TransferCodecShaderSourceDxil, std::size(g_TransferCodecShaderSourceDxil),
+                entryPoint, ShaderDefinesKey(defines))) {
+            psoDesc.CS.pShaderBytecode = precompiled->bytecode;
+            psoDesc.CS.BytecodeLength = precompiled->size;
+        }
+    }
+#endif
+
+    if (!psoDesc.CS.pShaderBytecode) {
+        UINT compileFlags = 0;
+#if defined(_DEBUG)
+        compileFlags |= D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+        compileFlags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+        ComPtr<ID3DBlob> errorBlob;
+        HRESULT hr = D3DCompile(g_TransferCodecShaderSource, strlen(g_TransferCodecShaderSource),
+                                "TransferCodec.hlsl", defines, nullptr, entryPoint, "cs_5_0",
+                                compileFlags, 0, &shaderBlob, &errorBlob);
+        if (FAILED(hr)) {
+            m_lastError = std::string("Shader compilation failed (") + entryPoint + ")";
+            if (errorBlob) {
+                m_lastError += ": " + std::string(static_cast<const char*>(errorBlob->GetBufferPointer()));
+            }
+            return false;
+        }
+        psoDesc.CS.pShaderBytecode = shaderBlob->GetBufferPointer();
+        psoDesc.CS.BytecodeLength = shaderBlob->GetBufferSize();
+    }
+
+    HRESULT hr = m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState));
+    if (FAILED(hr)) {
+        m_lastError = std::string("Failed to create pipeline state (") + entryPoint + ")";
+        return false;
+    }
+    return true;
+}
+
+bool TransferCodec::Encode(ID3D12GraphicsCommandList* commandList, ID3D12Resource* frame,
+                           ID3D12Resource* packedBuffer) {
+    if (!m_initialized || m_mode != TransferCodecMode::Encode) {
+        m_lastError = "Codec not initialized for encoding";
+        return false;
+    }
+    if (!commandList || !frame || !packedBuffer) {
+        m_lastError = "Invalid encode parameters";
+        return false;
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = m_format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MipLevels = 1;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.NumElements = static_cast<UINT>(GetPackedSize(m_encoding, m_width, m_height) / sizeof(uint32_t));
+    uavDesc.Buffer.Flags = D3D12_BUFFER_UAV_FLAG_RAW;
+
+    Dispatch(commandList, srvDesc, frame, uavDesc, packedBuffer);
+    return true;
+}
+
+bool TransferCodec::Decode(ID3D12GraphicsCommandList* commandList, ID3D12Resource* packedBuffer,
+                           ID3D12Resource* frame) {
+    if (!m_initialized || m_mode != TransferCodecMode::Decode) {
+        m_lastError = "Codec not initialized for decoding";
+        return false;
+    }
+    if (!commandList || !frame || !packedBuffer) {
+        m_lastError = "Invalid decode parameters";
+        return false;
+    }
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.NumElements = static_cast<UINT>(GetPackedSize(m_encoding, m_width, m_height) / sizeof(uint32_t));
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_RAW;
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.Format = GetDecodedFormat(m_encoding, m_format);
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+
+    Dispatch(commandList, srvDesc, packedBuffer, uavDesc, frame);
+    return true;
+}
+
+void TransferCodec::Dispatch(ID3D12GraphicsCommandList* commandList, const D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc,
+                             ID3D12Resource* srvResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC& uavDesc,
+                             ID3D12Resource* uavResource) {
+    // The set written now was last used descriptorSets calls ago, which
+    // the caller's allocator ring has retired
+    const uint32_t set = m_nextSet;
+    m_nextSet = (m_nextSet + 1) % m_descriptorSets;
+
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_descriptorHeap->GetCPUDescriptorHandleForHeapStart();
+    cpuHandle.ptr += static_cast<SIZE_T>(set) * 2 * m_descriptorSize;
+    m_device->CreateShaderResourceView(srvResource, &srvDesc, cpuHandle);
+    cpuHandle.ptr += m_descriptorSize;
+    m_device->CreateUnorderedAccessView(uavResource, nullptr, &uavDesc, cpuHandle);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_descriptorHeap->GetGPUDescriptorHandleForHeapStart();
+    gpuHandle.ptr += static_cast<UINT64>(set) * 2 * m_descriptorSize;
+    D3D12_GPU_DESCRIPTOR_HANDLE uavHandle = gpuHandle;
+    uavHandle.ptr += m_descriptorSize;
+
+    const bool hdr10 = m_encoding == TransferEncoding::HDR10;
+    const TransferCodecConstants constants = {
+        m_width, m_height, GetPackedPitch(m_encoding, m_width),
+        hdr10 ? 0u : static_cast<uint32_t>(GetChromaOffset(m_width, m_height))
+    };
+
+    ID3D12DescriptorHeap* heaps[] = { m_descriptorHeap.Get() };
+    commandList->SetDescriptorHeaps(1, heaps);
+    commandList->SetComputeRootSignature(m_rootSignature.Get());
+    commandList->SetPipelineState(m_pipelineState.Get());
+    commandList->SetComputeRoot32BitConstants(0, sizeof(constants) / sizeof(uint32_t), &constants, 0);
+    commandList->SetComputeRootDescriptorTable(1, gpuHandle);
+    commandList->SetComputeRootDescriptorTable(2, uavHandle);
+
+    const uint32_t groupPixelsX = BLOCK_WIDTH * GROUP_SIZE;
+    const uint32_t groupPixelsY = BLOCK_HEIGHT * GROUP_SIZE;
+    commandList->Dispatch((m_width + groupPixelsX - 1) / groupPixelsX,
+                          (m_height + groupPixelsY - 1) / groupPixelsY, 1);
+}
+
+} // namespace osfg
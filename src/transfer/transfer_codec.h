@@ -0,0 +1,136 @@
+// OSFG - Open Source Frame Generation
+// Transfer Codec
+//
+// Compute kernels that pack an 8-bit RGB frame into YCbCr 4:2:0 planes (an
+// NV12-style layout in a raw buffer: a full-resolution luma plane followed by
+// an interleaved half-resolution CbCr plane) and unpack it again. The packed
+// frame is 1.5 bytes per pixel instead of 4, so GPUTransfer moves 37.5% of
+// the bytes over PCIe. The conversion is BT.709 full range; chroma is
+// averaged over 2x2 blocks and replicated on unpack, so colour edges soften
+// slightly compared with a BGRA8 transfer.
+//
+// HDR frames (R16G16B16A16_FLOAT scRGB from an HDR capture) are packed into
+// BT.2020 PQ 10:10:10:2 words instead: 4 bytes per pixel rather than 8,
+// unpacked into R10G10B10A2_UNORM textures, the HDR10 swap chain's format.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include <cstdint>
+#include <string>
+
+namespace osfg {
+
+using Microsoft::WRL::ComPtr;
+
+// Encoding of frames on the way between the GPUs
+enum class TransferEncoding {
+    BGRA8,        // Frames as captured (full copy or dirty regions)
+    YCbCr420,     // Packed 8-bit 4:2:0 planes, whole frames only
+    HDR10         // FP16 scRGB packed to PQ R10G10B10A2, whole frames only
+};
+
+// Direction a codec instance runs in (one per device)
+enum class TransferCodecMode {
+    Encode,       // Frame texture -> packed buffer (source GPU)
+    Decode        // Packed buffer -> frame texture UAV (destination GPU)
+};
+
+class TransferCodec {
+public:
+    static const uint32_t MAX_DESCRIPTOR_SETS = 16;
+
+    TransferCodec() = default;
+    ~TransferCodec();
+
+    // Non-copyable
+    TransferCodec(const TransferCodec&) = delete;
+    TransferCodec& operator=(const TransferCodec&) = delete;
+
+    // Bytes of a packed frame (YCbCr420: luma plane, then the chroma plane)
+    static uint64_t GetPackedSize(TransferEncoding encoding, uint32_t width, uint32_t height);
+
+    // Row pitch in bytes (of both planes for YCbCr420) and the byte offset
+    // of the YCbCr420 chroma plane
+    static uint32_t GetPackedPitch(TransferEncoding encoding, uint32_t width);
+    static uint64_t GetChromaOffset(uint32_t width, uint32_t height);
+
+    // Format frames are unpacked into: R10G10B10A2_UNORM for HDR10,
+    // otherwise the captured format
+    static DXGI_FORMAT GetDecodedFormat(TransferEncoding encoding, DXGI_FORMAT format);
+
+    // True if `device` can run the kernel for `mode` on captured frames of
+    // `format` (8-bit RGB for YCbCr420, R16G16B16A16_FLOAT for HDR10;
+    // decoding also needs typed UAV stores of the decoded format)
+    static bool IsSupported(ID3D12Device* device, TransferEncoding encoding, TransferCodecMode mode,
+                            DXGI_FORMAT format);
+
+    // Build the kernel for one direction. `format` is the captured format
+    // on both sides. `descriptorSets` is how many Encode()/Decode() calls
+    // may be in flight on the GPU at once.
+    bool Initialize(ID3D12Device* device, TransferEncoding encoding, TransferCodecMode mode,
+                    DXGI_FORMAT format, uint32_t width, uint32_t height, uint32_t descriptorSets);
+
+    // Release all resources
+    void Shutdown();
+
+    // Check if initialized
+    bool IsInitialized() const { return m_initialized; }
+
+    // Change the frame size (no resources depend on it)
+    void Resize(uint32_t width, uint32_t height);
+
+    // Record the pack of `frame` (readable as a shader resource, in
+    // frameState) into `packedBuffer` (UNORDERED_ACCESS, GetPackedSize() bytes)
+    bool Encode(ID3D12GraphicsCommandList* commandList, ID3D12Resource* frame,
+                ID3D12Resource* packedBuffer);
+
+    // Record the unpack of `packedBuffer` (readable as a shader resource)
+    // into `frame` (GetDecodedFormat(), UNORDERED_ACCESS, created with
+    // ALLOW_UNORDERED_ACCESS)
+    bool Decode(ID3D12GraphicsCommandList* commandList, ID3D12Resource* packedBuffer,
+                ID3D12Resource* frame);
+
+    // Get last error
+    const std::string& GetLastError() const { return m_lastError; }
+
+private:
+    bool CreateRootSignature();
+    bool CreatePipelineState();
+    void Dispatch(ID3D12GraphicsCommandList* commandList, const D3D12_SHADER_RESOURCE_VIEW_DESC& srvDesc,
+                  ID3D12Resource* srvResource, const D3D12_UNORDERED_ACCESS_VIEW_DESC& uavDesc,
+                  ID3D12Resource* uavResource);
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12RootSignature> m_rootSignature;
+    ComPtr<ID3D12PipelineState> m_pipelineState;
+
+    // Shader-visible SRV + UAV pairs, used round robin
+    ComPtr<ID3D12DescriptorHeap> m_descriptorHeap;
+    uint32_t m_descriptorSize = 0;
+    uint32_t m_descriptorSets = 0;
+    uint32_t m_nextSet = 0;
+
+    TransferEncoding m_encoding = TransferEncoding::YCbCr420;
+    TransferCodecMode m_mode = TransferCodecMode::Encode;
+    DXGI_FORMAT m_format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    bool m_initialized = false;
+    std::string m_lastError;
+};
+
+} // namespace osfg
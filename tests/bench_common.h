@@ -0,0 +1,261 @@
+// OSFG - Open Source Frame Generation
+// Benchmark Helpers
+//
+// Shared by the offline benchmarks (bench_osfg, bench_opticalflow): a
+// queue that runs one command list at a time, texture upload, nearest-rank
+// percentiles and JSON string escaping.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#pragma once
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <Windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Microsoft::WRL::ComPtr;
+
+// Nearest-rank percentiles of one measured quantity
+struct Percentiles {
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+inline Percentiles ComputePercentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) {
+        return result;
+    }
+
+    std::sort(values.begin(), values.end());
+    auto rank = [&](double p) {
+        const size_t index = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[(std::min)(index > 0 ? index - 1 : 0, values.size() - 1)];
+    };
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    result.mean = sum / values.size();
+    result.p50 = rank(0.50);
+    result.p90 = rank(0.90);
+    result.p99 = rank(0.99);
+    result.max = values.back();
+    return result;
+}
+
+inline std::string Narrow(const std::wstring& text) {
+    if (text.empty()) {
+        return std::string();
+    }
+    const int size = WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                                         nullptr, 0, nullptr, nullptr);
+    std::string result(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, text.c_str(), static_cast<int>(text.size()),
+                        &result[0], size, nullptr, nullptr);
+    return result;
+}
+
+inline std::string JsonString(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            result += ' ';
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+// One queue with one command list, executed and waited for at a time
+struct GpuContext {
+    ComPtr<ID3D12Device> device;
+    ComPtr<ID3D12CommandQueue> queue;
+    ComPtr<ID3D12CommandAllocator> allocator;
+    ComPtr<ID3D12GraphicsCommandList> commandList;
+    ComPtr<ID3D12Fence> fence;
+    HANDLE fenceEvent = nullptr;
+    uint64_t fenceValue = 0;
+
+    ~GpuContext() {
+        if (fenceEvent) {
+            CloseHandle(fenceEvent);
+        }
+    }
+
+    bool Create(ID3D12Device* target, D3D12_COMMAND_LIST_TYPE type) {
+        device = target;
+
+        D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+        queueDesc.Type = type;
+        if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&queue))) ||
+            FAILED(device->CreateCommandAllocator(type, IID_PPV_ARGS(&allocator))) ||
+            FAILED(device->CreateCommandList(0, type, allocator.Get(), nullptr, IID_PPV_ARGS(&commandList))) ||
+            FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)))) {
+            return false;
+        }
+        commandList->Close();
+        fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        return fenceEvent != nullptr;
+    }
+
+    ID3D12GraphicsCommandList* Begin() {
+        allocator->Reset();
+        commandList->Reset(allocator.Get(), nullptr);
+        return commandList.Get();
+    }
+
+    // Execute the list and wait for it
+    void Finish() {
+        commandList->Close();
+        ID3D12CommandList* lists[] = { commandList.Get() };
+        queue->ExecuteCommandLists(1, lists);
+        queue->Signal(fence.Get(), ++fenceValue);
+        if (fence->GetCompletedValue() < fenceValue) {
+            fence->SetEventOnCompletion(fenceValue, fenceEvent);
+            WaitForSingleObject(fenceEvent, INFINITE);
+        }
+    }
+};
+
+inline void Transition(ID3D12GraphicsCommandList* commandList, ID3D12Resource* resource,
+                       D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after) {
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = resource;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = before;
+    barrier.Transition.StateAfter = after;
+    commandList->ResourceBarrier(1, &barrier);
+}
+
+inline bool CreateTexture(ID3D12Device* device, uint32_t width, uint32_t height, DXGI_FORMAT format,
+                          D3D12_RESOURCE_STATES state, ComPtr<ID3D12Resource>& texture) {
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    D3D12_RESOURCE_DESC desc = {};
+    desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    desc.Width = width;
+    desc.Height = height;
+    desc.DepthOrArraySize = 1;
+    desc.MipLevels = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+    return SUCCEEDED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc, state,
+                                                     nullptr, IID_PPV_ARGS(&texture)));
+}
+
+// Persistently mapped upload buffer holding one frame in the texture's copy footprint
+struct FrameUpload {
+    ComPtr<ID3D12Resource> buffer;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    uint8_t* data = nullptr;
+
+    bool Create(ID3D12Device* device, ID3D12Resource* texture) {
+        const D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
+        UINT64 totalBytes = 0;
+        device->GetCopyableFootprints(&textureDesc, 0, 1, 0, &footprint, nullptr, nullptr, &totalBytes);
+
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        desc.Width = totalBytes;
+        desc.Height = 1;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer)))) {
+            return false;
+        }
+        D3D12_RANGE readRange = { 0, 0 };
+        return SUCCEEDED(buffer->Map(0, &readRange, reinterpret_cast<void**>(&data)));
+    }
+
+    void Record(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture) const {
+        D3D12_TEXTURE_COPY_LOCATION dest = {};
+        dest.pResource = texture;
+        dest.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        dest.SubresourceIndex = 0;
+
+        D3D12_TEXTURE_COPY_LOCATION source = {};
+        source.pResource = buffer.Get();
+        source.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        source.PlacedFootprint = footprint;
+
+        commandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+    }
+};
+
+inline bool CreateDevice(uint32_t adapterIndex, ComPtr<ID3D12Device>& device,
+                         std::string& description, std::string& driverVersion) {
+    ComPtr<IDXGIFactory1> factory;
+    ComPtr<IDXGIAdapter1> adapter;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory))) ||
+        FAILED(factory->EnumAdapters1(adapterIndex, &adapter))) {
+        std::cerr << "Adapter " << adapterIndex << " not found" << std::endl;
+        return false;
+    }
+
+    DXGI_ADAPTER_DESC1 desc;
+    adapter->GetDesc1(&desc);
+    description = Narrow(desc.Description);
+
+    LARGE_INTEGER umdVersion = {};
+    if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion))) {
+        std::ostringstream version;
+        version << HIWORD(umdVersion.HighPart) << '.' << LOWORD(umdVersion.HighPart) << '.'
+                << HIWORD(umdVersion.LowPart) << '.' << LOWORD(umdVersion.LowPart);
+        driverVersion = version.str();
+    }
+
+    HRESULT hr = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_12_0, IID_PPV_ARGS(&device));
+    if (FAILED(hr)) {
+        std::cerr << "Failed to create D3D12 device: 0x" << std::hex << hr << std::dec << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Comma-separated command line values
+inline std::vector<std::string> SplitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
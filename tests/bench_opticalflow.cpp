@@ -0,0 +1,853 @@
+// OSFG - Open Source Frame Generation
+// Optical Flow Quality Benchmark
+//
+// Renders synthetic sequences with a known motion field (pans at several
+// speeds, sub-pixel and diagonal translation, rotation, a foreground object
+// occluding a moving background) and runs every motion estimation backend
+// over them: SimpleOpticalFlow in its single-level, 16-pixel block, pyramid,
+// predictive and motion-field configurations, and the FidelityFX optical
+// flow when the build links it. For each backend it reports the endpoint
+// error (EPE) of the block vectors against ground truth next to the GPU time
+// per frame, so faster flow modes can be accepted or rejected on numbers.
+//
+// Vectors follow the MotionEstimator convention: the block at p in the
+// current frame matches p + v in the previous frame. Blocks whose pixels
+// straddle an occlusion boundary, are uncovered this frame, or come from
+// outside the frame are scored separately (boundary) or not at all.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include "common/gpu_profiler.h"
+#include "opticalflow/simple_opticalflow.h"
+#include "opticalflow/osfg_opticalflow.h"
+
+#include "bench_common.h"
+
+static const double PI = 3.14159265358979323846;
+
+// Synthetic scene: a textured background that pans and/or rotates about the
+// frame centre, optionally with a textured square moving on top of it
+struct Scene {
+    const char* name;
+    double backgroundVx;        // Pixels per frame
+    double backgroundVy;
+    double rotationDeg;         // Degrees per frame, about the frame centre
+    bool foreground;
+    double foregroundVx;
+    double foregroundVy;
+};
+
+static const Scene g_scenes[] = {
+    { "static",        0.0,  0.0, 0.0, false,  0.0,  0.0 },
+    { "pan-2",         2.0,  0.0, 0.0, false,  0.0,  0.0 },
+    { "pan-8",         8.0,  0.0, 0.0, false,  0.0,  0.0 },
+    { "pan-16",       16.0,  0.0, 0.0, false,  0.0,  0.0 },
+    { "pan-32",       32.0,  0.0, 0.0, false,  0.0,  0.0 },
+    { "subpixel",      2.5,  1.25, 0.0, false, 0.0,  0.0 },
+    { "diagonal-12", -12.0,  9.0, 0.0, false,  0.0,  0.0 },
+    { "rotate-0.5",    0.0,  0.0, 0.5, false,  0.0,  0.0 },
+    { "rotate-2",      0.0,  0.0, 2.0, false,  0.0,  0.0 },
+    { "occlusion-8",   2.0,  0.0, 0.0, true,   8.0,  4.0 },
+    { "occlusion-24", -4.0,  0.0, 0.0, true,  24.0, -6.0 },
+};
+
+// Motion estimation backend under test
+struct Backend {
+    const char* name;
+    bool fidelityFX;
+    uint32_t blockSize;
+    uint32_t pyramidLevels;
+    bool temporalPredictors;
+    bool motionField;
+};
+
+static const Backend g_backends[] = {
+    { "simple",      false, 8,  1, false, false },
+    { "simple-b16",  false, 16, 1, false, false },
+    { "pyramid",     false, 8,  3, false, false },
+    { "predictive",  false, 8,  3, true,  false },
+    { "field",       false, 8,  3, false, true  },
+    { "fidelityfx",  true,  8,  1, false, false },
+};
+
+struct Options {
+    std::vector<const Scene*> scenes;
+    std::vector<const Backend*> backends;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t frames = 12;               // Frames per sequence (the first two are not scored)
+    uint32_t searchRadius = 16;
+    uint32_t adapterIndex = 0;
+    double maxEpe = 0.0;                // > 0: fail when a scene within the search radius exceeds it
+    std::string jsonPath;
+};
+
+struct Result {
+    const Scene* scene = nullptr;
+    const Backend* backend = nullptr;
+    double epe = 0.0;                   // Interior blocks
+    double outlierPercent = 0.0;        // Interior blocks with EPE > 2 px
+    double boundaryEpe = 0.0;           // Blocks on an occlusion boundary
+    double fieldEpe = -1.0;             // Dense field, interior pixels (-1: no field)
+    uint64_t interiorBlocks = 0;
+    uint64_t boundaryBlocks = 0;
+    bool withinRadius = false;          // Every vector within the search radius
+    Percentiles gpuMs;
+};
+
+// ============================================================================
+// Scene model and ground truth
+// ============================================================================
+
+static uint32_t Hash(int32_t x, int32_t y, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return h ^ (h >> 16);
+}
+
+// Bilinear value noise, continuous so sub-pixel motion is sampled exactly
+static double ValueNoise(double x, double y, uint32_t seed) {
+    const double fx = std::floor(x);
+    const double fy = std::floor(y);
+    const int32_t ix = static_cast<int32_t>(fx);
+    const int32_t iy = static_cast<int32_t>(fy);
+    double tx = x - fx;
+    double ty = y - fy;
+    tx = tx * tx * (3.0 - 2.0 * tx);
+    ty = ty * ty * (3.0 - 2.0 * ty);
+
+    auto corner = [&](int32_t cx, int32_t cy) { return (Hash(cx, cy, seed) & 0xFFFF) / 65535.0; };
+    const double top = corner(ix, iy) + (corner(ix + 1, iy) - corner(ix, iy)) * tx;
+    const double bottom = corner(ix, iy + 1) + (corner(ix + 1, iy + 1) - corner(ix, iy + 1)) * tx;
+    return top + (bottom - top) * ty;
+}
+
+// Texture with detail at several scales, 0..255
+static double Texture(double u, double v, uint32_t seed) {
+    const double value = 0.5 * ValueNoise(u / 32.0, v / 32.0, seed) +
+                         0.3 * ValueNoise(u / 8.0, v / 8.0, seed + 1) +
+                         0.2 * ValueNoise(u / 2.0, v / 2.0, seed + 2);
+    return value * 255.0;
+}
+
+class SceneModel {
+public:
+    SceneModel(const Scene& scene, uint32_t width, uint32_t height)
+        : m_scene(scene), m_width(width), m_height(height),
+          m_centerX(width * 0.5), m_centerY(height * 0.5),
+          m_foregroundSize(height / 3.0),
+          m_foregroundX(width * 0.2), m_foregroundY(height * 0.3) {}
+
+    // Background position at frame t of texture point (u, v)
+    void BackgroundPosition(double t, double u, double v, double& x, double& y) const {
+        const double angle = t * m_scene.rotationDeg * PI / 180.0;
+        const double c = std::cos(angle);
+        const double s = std::sin(angle);
+        const double dx = u - m_centerX;
+        const double dy = v - m_centerY;
+        x = m_centerX + c * dx - s * dy + t * m_scene.backgroundVx;
+        y = m_centerY + s * dx + c * dy + t * m_scene.backgroundVy;
+    }
+
+    // Texture point of the background seen at (x, y) in frame t
+    void BackgroundSource(double t, double x, double y, double& u, double& v) const {
+        const double angle = -t * m_scene.rotationDeg * PI / 180.0;
+        const double c = std::cos(angle);
+        const double s = std::sin(angle);
+        const double dx = x - t * m_scene.backgroundVx - m_centerX;
+        const double dy = y - t * m_scene.backgroundVy - m_centerY;
+        u = m_centerX + c * dx - s * dy;
+        v = m_centerY + s * dx + c * dy;
+    }
+
+    bool InForeground(double t, double x, double y) const {
+        if (!m_scene.foreground) {
+            return false;
+        }
+        const double left = m_foregroundX + t * m_scene.foregroundVx;
+        const double top = m_foregroundY + t * m_scene.foregroundVy;
+        return x >= left && x < left + m_foregroundSize && y >= top && y < top + m_foregroundSize;
+    }
+
+    double Luminance(double t, double x, double y) const {
+        if (InForeground(t, x, y)) {
+            return Texture(x - t * m_scene.foregroundVx, y - t * m_scene.foregroundVy, 7);
+        }
+        double u, v;
+        BackgroundSource(t, x, y, u, v);
+        return Texture(u, v, 1);
+    }
+
+    // Backward vector of the pixel at (x, y) in frame t, its layer, and
+    // whether the same surface point is visible inside frame t - 1
+    bool GroundTruth(double t, double x, double y, double& gx, double& gy, int& layer) const {
+        double px, py;
+        if (InForeground(t, x, y)) {
+            layer = 1;
+            px = x - m_scene.foregroundVx;
+            py = y - m_scene.foregroundVy;
+        } else {
+            layer = 0;
+            double u, v;
+            BackgroundSource(t, x, y, u, v);
+            BackgroundPosition(t - 1.0, u, v, px, py);
+            if (InForeground(t - 1.0, px, py)) {
+                gx = px - x;
+                gy = py - y;
+                return false;  // Uncovered this frame
+            }
+        }
+        gx = px - x;
+        gy = py - y;
+        return px >= 0.0 && py >= 0.0 && px < m_width && py < m_height;
+    }
+
+    // Largest ground-truth vector length anywhere in the frame
+    double MaxSpeed() const {
+        const double radius = std::sqrt(m_centerX * m_centerX + m_centerY * m_centerY);
+        const double rotation = 2.0 * radius * std::sin(0.5 * m_scene.rotationDeg * PI / 180.0);
+        const double background = std::hypot(m_scene.backgroundVx, m_scene.backgroundVy) + rotation;
+        const double foreground = m_scene.foreground ? std::hypot(m_scene.foregroundVx, m_scene.foregroundVy) : 0.0;
+        return (std::max)(background, foreground);
+    }
+
+private:
+    Scene m_scene;
+    uint32_t m_width;
+    uint32_t m_height;
+    double m_centerX;
+    double m_centerY;
+    double m_foregroundSize;
+    double m_foregroundX;
+    double m_foregroundY;
+};
+
+// Per-pixel ground-truth classification of one frame
+enum PixelTruth : uint8_t {
+    PIXEL_FOREGROUND = 1 << 0,
+    PIXEL_UNCOVERED = 1 << 1,     // Hidden in the previous frame
+    PIXEL_OUTSIDE = 1 << 2        // Came from outside the previous frame
+};
+
+// Run rowFunction(y) for every row, interleaved over the hardware threads
+template <typename RowFunction>
+static void ParallelRows(uint32_t height, const RowFunction& rowFunction) {
+    const uint32_t threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < threadCount; i++) {
+        threads.emplace_back([&, i]() {
+            for (uint32_t y = i; y < height; y += threadCount) {
+                rowFunction(y);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Render frame t as R8G8B8A8 grey into an upload footprint
+static void RenderFrame(const SceneModel& model, uint32_t t, uint32_t width, uint32_t height,
+                        uint8_t* dest, uint32_t destPitch) {
+    ParallelRows(height, [&](uint32_t y) {
+        uint8_t* row = dest + static_cast<size_t>(y) * destPitch;
+        for (uint32_t x = 0; x < width; x++) {
+            const double value = model.Luminance(t, x + 0.5, y + 0.5);
+            const uint8_t grey = static_cast<uint8_t>((std::min)(255.0, (std::max)(0.0, value + 0.5)));
+            row[x * 4 + 0] = grey;
+            row[x * 4 + 1] = grey;
+            row[x * 4 + 2] = grey;
+            row[x * 4 + 3] = 0xFF;
+        }
+    });
+}
+
+// Classify every pixel of frame t (PixelTruth flags)
+static void ClassifyFrame(const SceneModel& model, uint32_t t, uint32_t width, uint32_t height,
+                          std::vector<uint8_t>& truth) {
+    truth.resize(static_cast<size_t>(width) * height);
+    ParallelRows(height, [&](uint32_t y) {
+        for (uint32_t x = 0; x < width; x++) {
+            double gx, gy;
+            int layer;
+            const bool visible = model.GroundTruth(t, x + 0.5, y + 0.5, gx, gy, layer);
+            uint8_t flags = layer ? PIXEL_FOREGROUND : 0;
+            if (!visible) {
+                const double px = x + 0.5 + gx;
+                const double py = y + 0.5 + gy;
+                const bool outside = px < 0.0 || py < 0.0 || px >= width || py >= height;
+                flags |= outside ? PIXEL_OUTSIDE : PIXEL_UNCOVERED;
+            }
+            truth[static_cast<size_t>(y) * width + x] = flags;
+        }
+    });
+}
+
+// ============================================================================
+// Readback
+// ============================================================================
+
+static float HalfToFloat(uint16_t half) {
+    const uint32_t sign = (half >> 15) & 1;
+    const int32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+    float value;
+    if (exponent == 0) {
+        value = std::ldexp(static_cast<float>(mantissa), -24);
+    } else if (exponent == 31) {
+        value = mantissa ? NAN : INFINITY;
+    } else {
+        value = std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+    }
+    return sign ? -value : value;
+}
+
+// Persistently mapped readback buffer for one texture
+struct TextureReadback {
+    ComPtr<ID3D12Resource> buffer;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    const uint8_t* data = nullptr;
+
+    bool Create(ID3D12Device* device, ID3D12Resource* texture) {
+        const D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
+        UINT64 totalBytes = 0;
+        device->GetCopyableFootprints(&textureDesc, 0, 1, 0, &footprint, nullptr, nullptr, &totalBytes);
+
+        D3D12_HEAP_PROPERTIES heapProps = {};
+        heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+
+        D3D12_RESOURCE_DESC desc = {};
+        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+        desc.Width = totalBytes;
+        desc.Height = 1;
+        desc.DepthOrArraySize = 1;
+        desc.MipLevels = 1;
+        desc.SampleDesc.Count = 1;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+                D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&buffer)))) {
+            return false;
+        }
+        void* mapped = nullptr;
+        if (FAILED(buffer->Map(0, nullptr, &mapped))) {
+            return false;
+        }
+        data = static_cast<const uint8_t*>(mapped);
+        return true;
+    }
+
+    // Copy `texture` (in `state`) into the buffer and return it to `state`
+    void Record(ID3D12GraphicsCommandList* commandList, ID3D12Resource* texture, D3D12_RESOURCE_STATES state) const {
+        Transition(commandList, texture, state, D3D12_RESOURCE_STATE_COPY_SOURCE);
+
+        D3D12_TEXTURE_COPY_LOCATION dest = {};
+        dest.pResource = buffer.Get();
+        dest.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+        dest.PlacedFootprint = footprint;
+
+        D3D12_TEXTURE_COPY_LOCATION source = {};
+        source.pResource = texture;
+        source.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+        source.SubresourceIndex = 0;
+
+        commandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+        Transition(commandList, texture, D3D12_RESOURCE_STATE_COPY_SOURCE, state);
+    }
+
+    const uint8_t* Row(uint32_t y) const { return data + static_cast<size_t>(y) * footprint.Footprint.RowPitch; }
+};
+
+// ============================================================================
+// Scoring
+// ============================================================================
+
+struct ErrorAccumulator {
+    double interiorSum = 0.0;
+    double boundarySum = 0.0;
+    double fieldSum = 0.0;
+    uint64_t interior = 0;
+    uint64_t boundary = 0;
+    uint64_t outliers = 0;
+    uint64_t fieldPixels = 0;
+};
+
+// Score block vectors of frame t. A block is interior when every pixel is on
+// one layer and visible in the previous frame; blocks with a pixel from
+// outside the previous frame are not scored.
+static void ScoreBlocks(const SceneModel& model, uint32_t t, uint32_t width, uint32_t height,
+                        const std::vector<uint8_t>& truth, const TextureReadback& vectors,
+                        uint32_t blocksX, uint32_t blocksY, float vectorScale, ErrorAccumulator& errors) {
+    const uint32_t blockW = (width + blocksX - 1) / blocksX;
+    const uint32_t blockH = (height + blocksY - 1) / blocksY;
+
+    for (uint32_t by = 0; by < blocksY; by++) {
+        const int16_t* row = reinterpret_cast<const int16_t*>(vectors.Row(by));
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            const uint32_t x0 = bx * blockW;
+            const uint32_t y0 = by * blockH;
+            if (x0 + blockW > width || y0 + blockH > height) {
+                continue;  // Partial edge block
+            }
+
+            uint8_t any = 0;
+            uint8_t all = 0xFF;
+            for (uint32_t y = y0; y < y0 + blockH; y++) {
+                const uint8_t* flags = truth.data() + static_cast<size_t>(y) * width + x0;
+                for (uint32_t x = 0; x < blockW; x++) {
+                    any |= flags[x];
+                    all &= flags[x];
+                }
+            }
+            if (any & PIXEL_OUTSIDE) {
+                continue;
+            }
+            const bool mixedLayers = (any & PIXEL_FOREGROUND) != (all & PIXEL_FOREGROUND);
+            const bool interior = !mixedLayers && !(any & PIXEL_UNCOVERED);
+
+            double gx, gy;
+            int layer;
+            model.GroundTruth(t, x0 + blockW * 0.5, y0 + blockH * 0.5, gx, gy, layer);
+            const double ex = row[bx * 2 + 0] * vectorScale;
+            const double ey = row[bx * 2 + 1] * vectorScale;
+            const double epe = std::hypot(ex - gx, ey - gy);
+
+            if (interior) {
+                errors.interiorSum += epe;
+                errors.interior++;
+                if (epe > 2.0) {
+                    errors.outliers++;
+                }
+            } else {
+                errors.boundarySum += epe;
+                errors.boundary++;
+            }
+        }
+    }
+}
+
+// Score the dense half-resolution field (pixels) at interior 2x2 quads
+static void ScoreField(const SceneModel& model, uint32_t t, uint32_t width, uint32_t height,
+                       const std::vector<uint8_t>& truth, const TextureReadback& field,
+                       uint32_t fieldW, uint32_t fieldH, ErrorAccumulator& errors) {
+    for (uint32_t fy = 0; fy < fieldH; fy++) {
+        const uint16_t* row = reinterpret_cast<const uint16_t*>(field.Row(fy));
+        for (uint32_t fx = 0; fx < fieldW; fx++) {
+            const uint32_t x0 = fx * 2;
+            const uint32_t y0 = fy * 2;
+            if (x0 + 2 > width || y0 + 2 > height) {
+                continue;
+            }
+
+            const uint8_t* top = truth.data() + static_cast<size_t>(y0) * width + x0;
+            const uint8_t* bottom = top + width;
+            const uint8_t any = top[0] | top[1] | bottom[0] | bottom[1];
+            const uint8_t all = top[0] & top[1] & bottom[0] & bottom[1];
+            if ((any & (PIXEL_OUTSIDE | PIXEL_UNCOVERED)) || (any & PIXEL_FOREGROUND) != (all & PIXEL_FOREGROUND)) {
+                continue;
+            }
+
+            double gx, gy;
+            int layer;
+            model.GroundTruth(t, x0 + 1.0, y0 + 1.0, gx, gy, layer);
+            const double ex = HalfToFloat(row[fx * 2 + 0]);
+            const double ey = HalfToFloat(row[fx * 2 + 1]);
+            errors.fieldSum += std::hypot(ex - gx, ey - gy);
+            errors.fieldPixels++;
+        }
+    }
+}
+
+// ============================================================================
+// Backends
+// ============================================================================
+
+static std::unique_ptr<OSFG::MotionEstimator> CreateBackend(const Backend& backend, const Options& options,
+                                                            ID3D12Device* device, ID3D12CommandQueue* queue) {
+    if (backend.fidelityFX) {
+        std::unique_ptr<OSFG::OpticalFlow> flow(new OSFG::OpticalFlow());
+        OSFG::OpticalFlowConfig config;
+        config.width = options.width;
+        config.height = options.height;
+        config.vectorReadState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;  // Compute lists only
+        if (!flow->Initialize(device, queue, config)) {
+            std::cerr << "  " << backend.name << ": " << flow->GetLastError() << std::endl;
+            return nullptr;
+        }
+        return std::move(flow);
+    }
+
+    std::unique_ptr<OSFG::SimpleOpticalFlow> flow(new OSFG::SimpleOpticalFlow());
+    OSFG::SimpleOpticalFlowConfig config;
+    config.width = options.width;
+    config.height = options.height;
+    config.blockSize = backend.blockSize;
+    config.searchRadius = options.searchRadius;
+    config.pyramidLevels = backend.pyramidLevels;
+    config.temporalPredictors = backend.temporalPredictors;
+    config.motionField = backend.motionField;
+    config.vectorReadState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;  // Compute lists only
+    if (!flow->Initialize(device, config)) {
+        std::cerr << "  " << backend.name << ": " << flow->GetLastError() << std::endl;
+        return nullptr;
+    }
+    return std::move(flow);
+}
+
+static bool RunBackend(const Options& options, const Scene& scene, const Backend& backend,
+                       const SceneModel& model, GpuContext& gpu, ID3D12Resource* const* frames,
+                       const std::vector<std::vector<uint8_t>>& truth, std::vector<Result>& results) {
+    std::unique_ptr<OSFG::MotionEstimator> flow = CreateBackend(backend, options, gpu.device.Get(), gpu.queue.Get());
+    if (!flow) {
+        return false;
+    }
+
+    TextureReadback vectors;
+    TextureReadback field;
+    ID3D12Resource* motionField = flow->GetMotionField();
+    if (!vectors.Create(gpu.device.Get(), flow->GetMotionVectorTexture()) ||
+        (motionField && !field.Create(gpu.device.Get(), motionField))) {
+        std::cerr << "Failed to create readback buffers" << std::endl;
+        return false;
+    }
+
+    osfg::GpuProfiler profiler;
+    if (!profiler.Initialize(gpu.device.Get(), gpu.queue.Get(), 2)) {
+        std::cerr << "Failed to initialize GPU profiler: " << profiler.GetLastError() << std::endl;
+        return false;
+    }
+
+    const uint32_t fieldW = motionField ? static_cast<uint32_t>(motionField->GetDesc().Width) : 0;
+    const uint32_t fieldH = motionField ? motionField->GetDesc().Height : 0;
+    ErrorAccumulator errors;
+    std::vector<double> gpuMs;
+
+    // Frame 0 seeds backends that keep their own history; frame 1 fills
+    // temporal predictors. Both are run but not scored.
+    for (uint32_t t = 0; t < options.frames; t++) {
+        ID3D12GraphicsCommandList* commandList = gpu.Begin();
+        profiler.BeginFrame();
+        profiler.BeginScope(commandList, osfg::GpuStage::OpticalFlow);
+        // FidelityFX restarts its history on a null previous frame; SimpleOpticalFlow needs one
+        ID3D12Resource* previous = t > 0 ? frames[t - 1] : (backend.fidelityFX ? nullptr : frames[0]);
+        if (!flow->Dispatch(frames[t], previous, commandList)) {
+            std::cerr << "  " << backend.name << " dispatch failed: " << flow->GetLastError() << std::endl;
+            return false;
+        }
+        profiler.EndScope(commandList);
+        profiler.EndFrame(commandList, gpu.fence.Get(), gpu.fenceValue + 1);
+
+        const bool scored = t >= 2;
+        if (scored) {
+            vectors.Record(commandList, flow->GetMotionVectorTexture(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+            if (motionField) {
+                field.Record(commandList, motionField, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+            }
+        }
+        gpu.Finish();
+
+        if (!scored) {
+            continue;
+        }
+        if (profiler.Collect()) {
+            gpuMs.push_back(profiler.GetLastFrame().StageMs(osfg::GpuStage::OpticalFlow));
+        }
+        ScoreBlocks(model, t, options.width, options.height, truth[t], vectors, flow->GetMotionVectorWidth(),
+                    flow->GetMotionVectorHeight(), flow->GetMotionVectorScale(), errors);
+        if (motionField) {
+            ScoreField(model, t, options.width, options.height, truth[t], field, fieldW, fieldH, errors);
+        }
+    }
+
+    Result result;
+    result.scene = &scene;
+    result.backend = &backend;
+    result.interiorBlocks = errors.interior;
+    result.boundaryBlocks = errors.boundary;
+    result.epe = errors.interior ? errors.interiorSum / errors.interior : 0.0;
+    result.outlierPercent = errors.interior ? 100.0 * errors.outliers / errors.interior : 0.0;
+    result.boundaryEpe = errors.boundary ? errors.boundarySum / errors.boundary : 0.0;
+    result.fieldEpe = errors.fieldPixels ? errors.fieldSum / errors.fieldPixels : -1.0;
+    result.withinRadius = model.MaxSpeed() <= options.searchRadius;
+    result.gpuMs = ComputePercentiles(gpuMs);
+    results.push_back(result);
+    return true;
+}
+
+static bool RunScene(const Options& options, const Scene& scene, GpuContext& gpu, std::vector<Result>& results) {
+    const SceneModel model(scene, options.width, options.height);
+
+    std::vector<ComPtr<ID3D12Resource>> textures(options.frames);
+    std::vector<ID3D12Resource*> frames(options.frames);
+    for (uint32_t t = 0; t < options.frames; t++) {
+        if (!CreateTexture(gpu.device.Get(), options.width, options.height, DXGI_FORMAT_R8G8B8A8_UNORM,
+                           D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, textures[t])) {
+            std::cerr << "Failed to create frame textures" << std::endl;
+            return false;
+        }
+        frames[t] = textures[t].Get();
+    }
+
+    FrameUpload upload;
+    if (!upload.Create(gpu.device.Get(), frames[0])) {
+        std::cerr << "Failed to create upload buffer" << std::endl;
+        return false;
+    }
+
+    for (uint32_t t = 0; t < options.frames; t++) {
+        RenderFrame(model, t, options.width, options.height, upload.data, upload.footprint.Footprint.RowPitch);
+        ID3D12GraphicsCommandList* commandList = gpu.Begin();
+        Transition(commandList, frames[t], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+        upload.Record(commandList, frames[t]);
+        Transition(commandList, frames[t], D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        gpu.Finish();
+    }
+
+    // Ground truth of the scored frames, shared by every backend
+    std::vector<std::vector<uint8_t>> truth(options.frames);
+    for (uint32_t t = 2; t < options.frames; t++) {
+        ClassifyFrame(model, t, options.width, options.height, truth[t]);
+    }
+
+    bool success = true;
+    for (const Backend* backend : options.backends) {
+        success = RunBackend(options, scene, *backend, model, gpu, frames.data(), truth, results) && success;
+    }
+    return success;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void PrintResults(const Options& options, const std::vector<Result>& results) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(14) << "scene" << std::setw(12) << "backend" << std::right
+              << std::setw(8) << "EPE" << std::setw(9) << ">2px %" << std::setw(10) << "boundary"
+              << std::setw(8) << "field" << std::setw(9) << "ms p50" << std::setw(9) << "ms p99" << "\n";
+    for (const Result& result : results) {
+        std::cout << std::left << std::setw(14) << result.scene->name << std::setw(12) << result.backend->name
+                  << std::right << std::setw(8) << result.epe << std::setw(9) << result.outlierPercent
+                  << std::setw(10) << result.boundaryEpe;
+        if (result.fieldEpe >= 0.0) {
+            std::cout << std::setw(8) << result.fieldEpe;
+        } else {
+            std::cout << std::setw(8) << "-";
+        }
+        std::cout << std::setprecision(3) << std::setw(9) << result.gpuMs.p50 << std::setw(9) << result.gpuMs.p99
+                  << std::setprecision(2) << (result.withinRadius ? "" : "  (beyond radius)") << "\n";
+    }
+
+    // EPE against cost, averaged over the scenes each backend ran
+    std::cout << "\n" << std::left << std::setw(12) << "backend" << std::right
+              << std::setw(10) << "mean EPE" << std::setw(12) << "mean ms" << "\n";
+    for (const Backend* backend : options.backends) {
+        double epe = 0.0;
+        double ms = 0.0;
+        uint32_t count = 0;
+        for (const Result& result : results) {
+            if (result.backend == backend) {
+                epe += result.epe;
+                ms += result.gpuMs.mean;
+                count++;
+            }
+        }
+        if (count > 0) {
+            std::cout << std::left << std::setw(12) << backend->name << std::right << std::setw(10) << epe / count
+                      << std::setprecision(3) << std::setw(12) << ms / count << std::setprecision(2) << "\n";
+        }
+    }
+}
+
+static bool WriteJson(const Options& options, const std::string& adapter, const std::string& driverVersion,
+                      const std::vector<Result>& results) {
+    std::ofstream file(options.jsonPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create " << options.jsonPath << std::endl;
+        return false;
+    }
+
+    file << std::setprecision(6);
+    file << "{\n";
+    file << "  \"version\": 1,\n";
+    file << "  \"adapter\": { \"index\": " << options.adapterIndex << ", \"description\": " << JsonString(adapter)
+         << ", \"driverVersion\": " << JsonString(driverVersion) << " },\n";
+    file << "  \"settings\": { \"width\": " << options.width << ", \"height\": " << options.height
+         << ", \"frames\": " << options.frames << ", \"searchRadius\": " << options.searchRadius << " },\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& result = results[i];
+        file << "    { \"scene\": " << JsonString(result.scene->name)
+             << ", \"backend\": " << JsonString(result.backend->name)
+             << ", \"withinRadius\": " << (result.withinRadius ? "true" : "false")
+             << ", \"epe\": " << result.epe
+             << ", \"outlierPercent\": " << result.outlierPercent
+             << ", \"boundaryEpe\": " << result.boundaryEpe;
+        if (result.fieldEpe >= 0.0) {
+            file << ", \"fieldEpe\": " << result.fieldEpe;
+        }
+        file << ", \"interiorBlocks\": " << result.interiorBlocks
+             << ", \"boundaryBlocks\": " << result.boundaryBlocks
+             << ",\n      \"gpuMs\": { \"mean\": " << result.gpuMs.mean << ", \"p50\": " << result.gpuMs.p50
+             << ", \"p90\": " << result.gpuMs.p90 << ", \"p99\": " << result.gpuMs.p99
+             << ", \"max\": " << result.gpuMs.max << " } }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    if (!file.good()) {
+        std::cerr << "Failed to write " << options.jsonPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void PrintUsage() {
+    std::cout << "Usage: bench_opticalflow [options]\n"
+              << "  --scenes <list>         Default: all (";
+    for (const Scene& scene : g_scenes) {
+        std::cout << (&scene == g_scenes ? "" : ",") << scene.name;
+    }
+    std::cout << ")\n"
+              << "  --backends <list>       Default: all (";
+    for (const Backend& backend : g_backends) {
+        std::cout << (&backend == g_backends ? "" : ",") << backend.name;
+    }
+    std::cout << ")\n"
+              << "  --size <W>x<H>          Frame size (default: 1920x1080)\n"
+              << "  --frames <n>            Frames per sequence, the first two unscored (default: 12)\n"
+              << "  --search-radius <n>     SimpleOpticalFlow search radius (default: 16)\n"
+              << "  --adapter <n>           Adapter to run on (default: 0)\n"
+              << "  --max-epe <px>          Fail if a scene within the search radius exceeds this EPE\n"
+              << "  --json <file>           Write results as JSON\n";
+}
+
+static bool ParseOptions(int argc, char* argv[], Options& options) {
+    std::string scenes;
+    std::string backends;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--scenes" && hasValue) {
+            scenes = argv[++i];
+        } else if (arg == "--backends" && hasValue) {
+            backends = argv[++i];
+        } else if (arg == "--size" && hasValue) {
+            if (sscanf_s(argv[++i], "%ux%u", &options.width, &options.height) != 2) {
+                std::cerr << "Invalid --size" << std::endl;
+                return false;
+            }
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--search-radius" && hasValue) {
+            options.searchRadius = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--adapter" && hasValue) {
+            options.adapterIndex = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--max-epe" && hasValue) {
+            options.maxEpe = std::stod(argv[++i]);
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            PrintUsage();
+            return false;
+        }
+    }
+
+    for (const Scene& scene : g_scenes) {
+        const std::vector<std::string> names = SplitList(scenes);
+        if (names.empty() || std::find(names.begin(), names.end(), scene.name) != names.end()) {
+            options.scenes.push_back(&scene);
+        }
+    }
+
+    for (const Backend& backend : g_backends) {
+        const std::vector<std::string> names = SplitList(backends);
+        const bool requested = std::find(names.begin(), names.end(), backend.name) != names.end();
+        if (backend.fidelityFX && !OSFG::OpticalFlow::IsAvailable()) {
+            if (requested) {
+                std::cerr << "fidelityfx: this build does not link the FidelityFX optical flow" << std::endl;
+            }
+            continue;
+        }
+        if (names.empty() || requested) {
+            options.backends.push_back(&backend);
+        }
+    }
+
+    if (options.scenes.empty() || options.backends.empty() || options.frames < 3) {
+        std::cerr << "Nothing to run (check --scenes, --backends and --frames >= 3)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::cout << "=== OSFG Optical Flow Quality Benchmark ===" << std::endl;
+
+    ComPtr<ID3D12Device> device;
+    std::string adapter;
+    std::string driverVersion;
+    if (!CreateDevice(options.adapterIndex, device, adapter, driverVersion)) {
+        return 1;
+    }
+    std::cout << "Adapter " << options.adapterIndex << ": " << adapter << " (driver " << driverVersion << ")" << std::endl;
+    std::cout << options.width << "x" << options.height << ", " << options.frames << " frames per scene\n" << std::endl;
+
+    GpuContext gpu;
+    if (!gpu.Create(device.Get(), D3D12_COMMAND_LIST_TYPE_COMPUTE)) {
+        std::cerr << "Failed to create compute queue" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    bool success = true;
+    for (const Scene* scene : options.scenes) {
+        std::cout << "Running " << scene->name << "..." << std::endl;
+        success = RunScene(options, *scene, gpu, results) && success;
+    }
+    std::cout << std::endl;
+
+    PrintResults(options, results);
+
+    if (!options.jsonPath.empty()) {
+        if (!WriteJson(options, adapter, driverVersion, results)) {
+            return 1;
+        }
+        std::cout << "\nResults written to " << options.jsonPath << std::endl;
+    }
+
+    if (options.maxEpe > 0.0) {
+        for (const Result& result : results) {
+            if (result.withinRadius && result.epe > options.maxEpe) {
+                std::cout << "[FAIL] " << result.scene->name << " / " << result.backend->name << ": EPE "
+                          << result.epe << " > " << options.maxEpe << std::endl;
+                success = false;
+            }
+        }
+        if (success) {
+            std::cout << "[PASS] EPE within " << options.maxEpe << " px on every scene within the search radius" << std::endl;
+        }
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,670 @@
+// OSFG - Open Source Frame Generation
+// Offline Benchmark
+//
+// Replays a recorded frame sequence through SimpleOpticalFlow,
+// FrameInterpolation and GPUTransfer at fixed resolutions and multipliers,
+// independent of what is on screen. Frames come from a dump written by
+// `test_dxgi_capture --dump`, a raw file of BGRA frames, or a built-in
+// synthetic sequence, and are resampled (nearest) to each resolution on the
+// CPU. Every frame is waited for before the next is uploaded, so stage times
+// are GPU timestamps of one frame at a time. Results are percentiles per
+// stage, written as JSON for before/after comparisons.
+//
+// MIT License - Part of Open Source Frame Generation project
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+
+#include "capture/frame_dump.h"
+#include "common/gpu_profiler.h"
+#include "opticalflow/simple_opticalflow.h"
+#include "interpolation/frame_interpolation.h"
+#include "transfer/gpu_transfer.h"
+
+#include "bench_common.h"
+
+struct Resolution {
+    const char* name;
+    uint32_t width;
+    uint32_t height;
+};
+
+static const Resolution g_resolutions[] = {
+    { "1080p", 1920, 1080 },
+    { "1440p", 2560, 1440 },
+    { "4k", 3840, 2160 },
+};
+
+struct BenchOptions {
+    std::string inputPath;              // Empty: synthetic sequence
+    uint32_t rawWidth = 0;              // Non-zero: inputPath is raw BGRA frames
+    uint32_t rawHeight = 0;
+    std::vector<Resolution> resolutions;
+    std::vector<uint32_t> multipliers;
+    uint32_t frames = 240;              // Measured frames per configuration
+    uint32_t warmup = 30;
+    uint32_t adapterIndex = 0;          // Flow and interpolation
+    uint32_t sourceAdapter = 0;         // Transfer
+    uint32_t destAdapter = 1;
+    bool transfer = true;
+    osfg::TransferEncoding encoding = osfg::TransferEncoding::BGRA8;
+    uint32_t blockSize = 8;
+    uint32_t searchRadius = 16;
+    uint32_t pyramidLevels = 1;
+    bool motionField = false;
+    std::string jsonPath;
+};
+
+// Source frames, all the same size, 4 bytes per pixel
+struct FrameSequence {
+    osfg::FrameDumpReader dump;
+    std::vector<uint8_t> synthetic;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t rowPitch = 0;
+    uint32_t frameCount = 0;
+    DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM;
+
+    const uint8_t* Frame(uint32_t index) const {
+        if (dump.IsOpen()) {
+            return dump.GetFrame(index);
+        }
+        return synthetic.data() + static_cast<size_t>(index) * rowPitch * height;
+    }
+};
+
+struct BenchResult {
+    std::string stage;
+    std::string resolution;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t multiplier = 0;            // 0 for the transfer
+    std::string detail;                 // Transfer method and encoding
+    uint64_t bytesPerFrame = 0;
+    uint32_t frames = 0;
+    std::vector<std::pair<std::string, Percentiles>> metrics;
+};
+
+static const char* EncodingName(osfg::TransferEncoding encoding) {
+    switch (encoding) {
+    case osfg::TransferEncoding::YCbCr420: return "YCbCr420";
+    case osfg::TransferEncoding::HDR10: return "HDR10";
+    default: return "BGRA8";
+    }
+}
+
+static const char* MethodName(osfg::TransferMethod method) {
+    switch (method) {
+    case osfg::TransferMethod::PeerToPeer: return "PeerToPeer";
+    case osfg::TransferMethod::CrossAdapterHeap: return "CrossAdapterHeap";
+    case osfg::TransferMethod::StagedCPU: return "StagedCPU";
+    default: return "Unknown";
+    }
+}
+
+// ============================================================================
+// Frame sources
+// ============================================================================
+
+// Deterministic moving content: scrolling value noise (texture for block
+// matching), a horizontal gradient and a square moving faster than the rest
+static void GenerateSyntheticSequence(FrameSequence& sequence) {
+    sequence.width = 1920;
+    sequence.height = 1080;
+    sequence.rowPitch = sequence.width * 4;
+    sequence.frameCount = 120;
+    sequence.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    sequence.synthetic.resize(static_cast<size_t>(sequence.rowPitch) * sequence.height * sequence.frameCount);
+
+    auto hash = [](uint32_t x, uint32_t y) {
+        uint32_t h = x * 374761393u + y * 668265263u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return static_cast<uint8_t>(h ^ (h >> 16));
+    };
+
+    for (uint32_t f = 0; f < sequence.frameCount; f++) {
+        uint8_t* frame = sequence.synthetic.data() + static_cast<size_t>(f) * sequence.rowPitch * sequence.height;
+        const uint32_t squareX = (200 + f * 12) % (sequence.width - 256);
+        const uint32_t squareY = 300 + (f * 5) % 400;
+
+        for (uint32_t y = 0; y < sequence.height; y++) {
+            uint8_t* row = frame + static_cast<size_t>(y) * sequence.rowPitch;
+            for (uint32_t x = 0; x < sequence.width; x++) {
+                const uint32_t u = x + f * 4;
+                const uint32_t v = y + f * 2;
+                const uint8_t noise = hash(u / 4, v / 4);
+                uint8_t* pixel = row + x * 4;
+                pixel[0] = noise;
+                pixel[1] = static_cast<uint8_t>((u * 255 / sequence.width) & 0xFF);
+                pixel[2] = static_cast<uint8_t>((noise >> 1) + 64);
+                pixel[3] = 0xFF;
+
+                if (x >= squareX && x < squareX + 256 && y >= squareY && y < squareY + 256) {
+                    pixel[0] = 32;
+                    pixel[1] = 200;
+                    pixel[2] = static_cast<uint8_t>(hash(x - squareX, y - squareY) | 0x80);
+                }
+            }
+        }
+    }
+}
+
+static bool LoadSequence(const BenchOptions& options, FrameSequence& sequence) {
+    if (options.inputPath.empty()) {
+        GenerateSyntheticSequence(sequence);
+        return true;
+    }
+
+    const bool opened = options.rawWidth != 0
+        ? sequence.dump.OpenRaw(options.inputPath, options.rawWidth, options.rawHeight)
+        : sequence.dump.Open(options.inputPath);
+    if (!opened) {
+        std::cerr << "Failed to load frames: " << sequence.dump.GetLastError() << std::endl;
+        return false;
+    }
+
+    sequence.width = sequence.dump.GetWidth();
+    sequence.height = sequence.dump.GetHeight();
+    sequence.rowPitch = sequence.dump.GetRowPitch();
+    sequence.frameCount = sequence.dump.GetFrameCount();
+    sequence.format = sequence.dump.GetFormat();
+    if (sequence.frameCount < 2) {
+        std::cerr << "Need at least two frames, " << options.inputPath << " has " << sequence.frameCount << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Nearest-neighbour resample of one source frame into an upload footprint
+static void ScaleFrame(const FrameSequence& sequence, uint32_t index, uint8_t* dest, uint32_t destPitch,
+                       uint32_t width, uint32_t height, const std::vector<uint32_t>& sourceColumns) {
+    const uint8_t* source = sequence.Frame(index);
+    for (uint32_t y = 0; y < height; y++) {
+        const uint32_t sourceY = static_cast<uint32_t>(static_cast<uint64_t>(y) * sequence.height / height);
+        const uint32_t* sourceRow = reinterpret_cast<const uint32_t*>(source + static_cast<size_t>(sourceY) * sequence.rowPitch);
+        uint32_t* destRow = reinterpret_cast<uint32_t*>(dest + static_cast<size_t>(y) * destPitch);
+        if (width == sequence.width) {
+            std::memcpy(destRow, sourceRow, static_cast<size_t>(width) * 4);
+            continue;
+        }
+        for (uint32_t x = 0; x < width; x++) {
+            destRow[x] = sourceRow[sourceColumns[x]];
+        }
+    }
+}
+
+static std::vector<uint32_t> SourceColumns(const FrameSequence& sequence, uint32_t width) {
+    std::vector<uint32_t> columns(width);
+    for (uint32_t x = 0; x < width; x++) {
+        columns[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * sequence.width / width);
+    }
+    return columns;
+}
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+// Optical flow and interpolation of every phase, one base frame at a time
+static bool RunFrameGeneration(const BenchOptions& options, const FrameSequence& sequence,
+                               ID3D12Device* device, const Resolution& resolution,
+                               std::vector<BenchResult>& results) {
+    GpuContext gpu;
+    if (!gpu.Create(device, D3D12_COMMAND_LIST_TYPE_COMPUTE)) {
+        std::cerr << "Failed to create compute queue" << std::endl;
+        return false;
+    }
+
+    OSFG::SimpleOpticalFlow opticalFlow;
+    OSFG::SimpleOpticalFlowConfig ofConfig;
+    ofConfig.width = resolution.width;
+    ofConfig.height = resolution.height;
+    ofConfig.blockSize = options.blockSize;
+    ofConfig.searchRadius = options.searchRadius;
+    ofConfig.pyramidLevels = options.pyramidLevels;
+    ofConfig.motionField = options.motionField;
+    ofConfig.vectorReadState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;  // Compute lists only
+    if (!opticalFlow.Initialize(device, ofConfig)) {
+        std::cerr << "Failed to initialize optical flow: " << opticalFlow.GetLastError() << std::endl;
+        return false;
+    }
+
+    OSFG::FrameInterpolation interpolation;
+    OSFG::FrameInterpolationConfig interpConfig;
+    interpConfig.width = resolution.width;
+    interpConfig.height = resolution.height;
+    interpConfig.outputState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    interpConfig.motionVectorScale = opticalFlow.GetMotionVectorScale();
+    if (!interpolation.Initialize(device, interpConfig)) {
+        std::cerr << "Failed to initialize frame interpolation: " << interpolation.GetLastError() << std::endl;
+        return false;
+    }
+
+    ID3D12Resource* motionVectors = options.motionField
+        ? opticalFlow.GetMotionField() : opticalFlow.GetMotionVectorTexture();
+
+    ComPtr<ID3D12Resource> frames[2];
+    for (auto& frame : frames) {
+        if (!CreateTexture(device, resolution.width, resolution.height, sequence.format,
+                           D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, frame)) {
+            std::cerr << "Failed to create frame textures" << std::endl;
+            return false;
+        }
+    }
+
+    ComPtr<ID3D12Resource> outputs[OSFG::FrameInterpolation::MAX_PHASES];
+    ID3D12Resource* outputTargets[OSFG::FrameInterpolation::MAX_PHASES] = {};
+    const D3D12_RESOURCE_DESC outputDesc = interpolation.GetOutputDesc();
+    D3D12_HEAP_PROPERTIES heapProps = {};
+    heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+    for (uint32_t i = 0; i < OSFG::FrameInterpolation::MAX_PHASES; i++) {
+        if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &outputDesc,
+                interpConfig.outputState, nullptr, IID_PPV_ARGS(&outputs[i])))) {
+            std::cerr << "Failed to create interpolation targets" << std::endl;
+            return false;
+        }
+        outputTargets[i] = outputs[i].Get();
+    }
+
+    FrameUpload upload;
+    if (!upload.Create(device, frames[0].Get())) {
+        std::cerr << "Failed to create upload buffer" << std::endl;
+        return false;
+    }
+
+    osfg::GpuProfiler profiler;
+    if (!profiler.Initialize(device, gpu.queue.Get(), 2)) {
+        std::cerr << "Failed to initialize GPU profiler: " << profiler.GetLastError() << std::endl;
+        return false;
+    }
+
+    const std::vector<uint32_t> sourceColumns = SourceColumns(sequence, resolution.width);
+
+    for (uint32_t multiplier : options.multipliers) {
+        const uint32_t phaseCount = multiplier - 1;
+        float factors[OSFG::FrameInterpolation::MAX_PHASES] = {};
+        for (uint32_t i = 0; i < phaseCount; i++) {
+            factors[i] = static_cast<float>(i + 1) / static_cast<float>(multiplier);
+        }
+
+        std::vector<double> flowMs, interpolationMs, totalMs, recordMs;
+        opticalFlow.InvalidateLuminance();
+
+        // Frame 0 only fills the previous texture
+        const uint32_t total = options.warmup + options.frames + 1;
+        for (uint32_t n = 0; n < total; n++) {
+            ID3D12Resource* current = frames[n % 2].Get();
+            ID3D12Resource* previous = frames[(n + 1) % 2].Get();
+
+            ScaleFrame(sequence, n % sequence.frameCount, upload.data, upload.footprint.Footprint.RowPitch,
+                       resolution.width, resolution.height, sourceColumns);
+
+            ID3D12GraphicsCommandList* commandList = gpu.Begin();
+            Transition(commandList, current, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                       D3D12_RESOURCE_STATE_COPY_DEST);
+            upload.Record(commandList, current);
+            Transition(commandList, current, D3D12_RESOURCE_STATE_COPY_DEST,
+                       D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+
+            if (n > 0) {
+                const auto recordStart = std::chrono::high_resolution_clock::now();
+                profiler.BeginFrame();
+
+                profiler.BeginScope(commandList, osfg::GpuStage::OpticalFlow);
+                if (!opticalFlow.Dispatch(current, previous, commandList)) {
+                    std::cerr << "Optical flow failed: " << opticalFlow.GetLastError() << std::endl;
+                    return false;
+                }
+                profiler.EndScope(commandList);
+
+                profiler.BeginScope(commandList, osfg::GpuStage::Interpolation);
+                if (!interpolation.DispatchPhases(previous, current, motionVectors, outputTargets,
+                                                  factors, phaseCount, commandList)) {
+                    std::cerr << "Interpolation failed: " << interpolation.GetLastError() << std::endl;
+                    return false;
+                }
+                profiler.EndScope(commandList);
+
+                profiler.EndFrame(commandList, gpu.fence.Get(), gpu.fenceValue + 1);
+                const auto recordEnd = std::chrono::high_resolution_clock::now();
+                if (n > options.warmup) {
+                    recordMs.push_back(std::chrono::duration<double, std::milli>(recordEnd - recordStart).count());
+                }
+            }
+
+            gpu.Finish();
+
+            if (n > options.warmup && profiler.Collect()) {
+                const osfg::GpuFrameTimes& times = profiler.GetLastFrame();
+                flowMs.push_back(times.StageMs(osfg::GpuStage::OpticalFlow));
+                interpolationMs.push_back(times.StageMs(osfg::GpuStage::Interpolation));
+                totalMs.push_back(times.busyMs);
+            }
+        }
+
+        BenchResult result;
+        result.stage = "framegen";
+        result.resolution = resolution.name;
+        result.width = resolution.width;
+        result.height = resolution.height;
+        result.multiplier = multiplier;
+        result.frames = static_cast<uint32_t>(totalMs.size());
+        result.metrics.emplace_back("gpuOpticalFlowMs", ComputePercentiles(flowMs));
+        result.metrics.emplace_back("gpuInterpolationMs", ComputePercentiles(interpolationMs));
+        result.metrics.emplace_back("gpuTotalMs", ComputePercentiles(totalMs));
+        result.metrics.emplace_back("cpuRecordMs", ComputePercentiles(recordMs));
+        results.push_back(result);
+    }
+
+    return true;
+}
+
+// Full-frame transfers from the source to the destination GPU
+static bool RunTransfer(const BenchOptions& options, const FrameSequence& sequence,
+                        const Resolution& resolution, std::vector<BenchResult>& results) {
+    osfg::GPUTransfer transfer;
+    osfg::TransferConfig config;
+    config.sourceAdapterIndex = options.sourceAdapter;
+    config.destAdapterIndex = options.destAdapter;
+    config.width = resolution.width;
+    config.height = resolution.height;
+    config.format = sequence.format;
+    config.encoding = options.encoding;
+    config.gpuProfiling = true;
+    if (!transfer.Initialize(config)) {
+        std::cerr << "Failed to initialize transfer: " << transfer.GetLastError() << std::endl;
+        return false;
+    }
+
+    ID3D12Device* device = transfer.GetSourceDevice();
+    GpuContext gpu;
+    ComPtr<ID3D12Resource> source;
+    FrameUpload upload;
+    if (!gpu.Create(device, D3D12_COMMAND_LIST_TYPE_DIRECT) ||
+        !CreateTexture(device, resolution.width, resolution.height, sequence.format,
+                       D3D12_RESOURCE_STATE_COPY_SOURCE, source) ||
+        !upload.Create(device, source.Get())) {
+        std::cerr << "Failed to create transfer source resources" << std::endl;
+        return false;
+    }
+
+    const std::vector<uint32_t> sourceColumns = SourceColumns(sequence, resolution.width);
+    std::vector<double> transferMs, gpuSourceMs, gpuDestMs;
+
+    // GPU times are read back one transfer late
+    const uint32_t total = options.warmup + options.frames + 1;
+    for (uint32_t n = 0; n < total; n++) {
+        ScaleFrame(sequence, n % sequence.frameCount, upload.data, upload.footprint.Footprint.RowPitch,
+                   resolution.width, resolution.height, sourceColumns);
+
+        ID3D12GraphicsCommandList* commandList = gpu.Begin();
+        Transition(commandList, source.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST);
+        upload.Record(commandList, source.Get());
+        Transition(commandList, source.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        gpu.Finish();
+
+        if (!transfer.TransferFrame(source.Get())) {
+            std::cerr << "Transfer failed: " << transfer.GetLastError() << std::endl;
+            return false;
+        }
+        transfer.WaitForTransfer();
+        transfer.AdvanceBuffer();
+
+        if (n > options.warmup) {
+            const osfg::TransferStats& stats = transfer.GetStats();
+            transferMs.push_back(stats.lastTransferTimeMs);
+            gpuSourceMs.push_back(stats.gpuSourceTimeMs);
+            gpuDestMs.push_back(stats.gpuDestTimeMs);
+        }
+    }
+
+    BenchResult result;
+    result.stage = "transfer";
+    result.resolution = resolution.name;
+    result.width = resolution.width;
+    result.height = resolution.height;
+    result.detail = std::string(MethodName(transfer.GetTransferMethod())) + "/" + EncodingName(transfer.GetEncoding());
+    result.bytesPerFrame = transfer.GetFrameTransferBytes();
+    result.frames = static_cast<uint32_t>(transferMs.size());
+    result.metrics.emplace_back("gpuSourceMs", ComputePercentiles(gpuSourceMs));
+    result.metrics.emplace_back("gpuDestMs", ComputePercentiles(gpuDestMs));
+    result.metrics.emplace_back("cpuTransferMs", ComputePercentiles(transferMs));
+    results.push_back(result);
+    return true;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static void PrintResult(const BenchResult& result) {
+    std::cout << std::left << std::setw(9) << result.stage << std::setw(6) << result.resolution;
+    if (result.multiplier != 0) {
+        std::cout << " X" << result.multiplier;
+    } else {
+        std::cout << " " << result.detail;
+    }
+    std::cout << std::right << std::fixed << std::setprecision(3) << "\n";
+    for (const auto& metric : result.metrics) {
+        std::cout << "    " << std::left << std::setw(20) << metric.first << std::right
+                  << " p50 " << std::setw(7) << metric.second.p50
+                  << "  p90 " << std::setw(7) << metric.second.p90
+                  << "  p99 " << std::setw(7) << metric.second.p99
+                  << "  max " << std::setw(7) << metric.second.max << "\n";
+    }
+}
+
+static bool WriteJson(const std::string& path, const BenchOptions& options, const FrameSequence& sequence,
+                      const std::string& adapter, const std::string& driverVersion,
+                      const std::vector<BenchResult>& results) {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create " << path << std::endl;
+        return false;
+    }
+
+    file << std::setprecision(6);
+    file << "{\n";
+    file << "  \"version\": 1,\n";
+    file << "  \"input\": { \"path\": " << JsonString(options.inputPath.empty() ? "synthetic" : options.inputPath)
+         << ", \"width\": " << sequence.width << ", \"height\": " << sequence.height
+         << ", \"frames\": " << sequence.frameCount << " },\n";
+    file << "  \"adapter\": { \"index\": " << options.adapterIndex << ", \"description\": " << JsonString(adapter)
+         << ", \"driverVersion\": " << JsonString(driverVersion) << " },\n";
+    file << "  \"settings\": { \"frames\": " << options.frames << ", \"warmup\": " << options.warmup
+         << ", \"blockSize\": " << options.blockSize << ", \"searchRadius\": " << options.searchRadius
+         << ", \"pyramidLevels\": " << options.pyramidLevels
+         << ", \"motionField\": " << (options.motionField ? "true" : "false")
+         << ", \"transferEncoding\": " << JsonString(EncodingName(options.encoding)) << " },\n";
+    file << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        file << "    { \"stage\": " << JsonString(result.stage)
+             << ", \"resolution\": " << JsonString(result.resolution)
+             << ", \"width\": " << result.width << ", \"height\": " << result.height;
+        if (result.multiplier != 0) {
+            file << ", \"multiplier\": " << result.multiplier;
+        } else {
+            file << ", \"method\": " << JsonString(result.detail) << ", \"bytesPerFrame\": " << result.bytesPerFrame;
+        }
+        file << ", \"frames\": " << result.frames;
+        for (const auto& metric : result.metrics) {
+            const Percentiles& p = metric.second;
+            file << ",\n      " << JsonString(metric.first) << ": { \"mean\": " << p.mean << ", \"p50\": " << p.p50
+                 << ", \"p90\": " << p.p90 << ", \"p99\": " << p.p99 << ", \"max\": " << p.max << " }";
+        }
+        file << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n";
+    file << "}\n";
+
+    if (!file.good()) {
+        std::cerr << "Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void PrintUsage() {
+    std::cout << "Usage: bench_osfg [options]\n"
+              << "  --input <file>          Frame dump (test_dxgi_capture --dump); default: synthetic frames\n"
+              << "  --raw <W>x<H>           --input is raw back-to-back BGRA frames of this size\n"
+              << "  --resolutions <list>    1080p,1440p,4k (default: all)\n"
+              << "  --multipliers <list>    2,3,4 (default: all)\n"
+              << "  --frames <n>            Measured frames per configuration (default: 240)\n"
+              << "  --warmup <n>            Frames run before measuring (default: 30)\n"
+              << "  --adapter <n>           Adapter for optical flow and interpolation (default: 0)\n"
+              << "  --transfer-adapters <source>,<dest>  (default: 0,1)\n"
+              << "  --transfer-encoding <bgra8|ycbcr420>\n"
+              << "  --no-transfer           Skip the inter-GPU transfer\n"
+              << "  --block-size <8|16> --search-radius <n> --pyramid-levels <n> --motion-field\n"
+              << "  --json <file>           Write results as JSON\n";
+}
+
+static bool ParseOptions(int argc, char* argv[], BenchOptions& options) {
+    std::string resolutions = "1080p,1440p,4k";
+    std::string multipliers = "2,3,4";
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--input" && hasValue) {
+            options.inputPath = argv[++i];
+        } else if (arg == "--raw" && hasValue) {
+            if (sscanf_s(argv[++i], "%ux%u", &options.rawWidth, &options.rawHeight) != 2) {
+                std::cerr << "Invalid --raw size" << std::endl;
+                return false;
+            }
+        } else if (arg == "--resolutions" && hasValue) {
+            resolutions = argv[++i];
+        } else if (arg == "--multipliers" && hasValue) {
+            multipliers = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--adapter" && hasValue) {
+            options.adapterIndex = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--transfer-adapters" && hasValue) {
+            if (sscanf_s(argv[++i], "%u,%u", &options.sourceAdapter, &options.destAdapter) != 2) {
+                std::cerr << "Invalid --transfer-adapters" << std::endl;
+                return false;
+            }
+        } else if (arg == "--transfer-encoding" && hasValue) {
+            const std::string encoding = argv[++i];
+            options.encoding = encoding == "ycbcr420" ? osfg::TransferEncoding::YCbCr420 : osfg::TransferEncoding::BGRA8;
+        } else if (arg == "--no-transfer") {
+            options.transfer = false;
+        } else if (arg == "--block-size" && hasValue) {
+            options.blockSize = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--search-radius" && hasValue) {
+            options.searchRadius = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--pyramid-levels" && hasValue) {
+            options.pyramidLevels = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--motion-field") {
+            options.motionField = true;
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            PrintUsage();
+            return false;
+        }
+    }
+
+    for (const std::string& name : SplitList(resolutions)) {
+        bool found = false;
+        for (const Resolution& resolution : g_resolutions) {
+            if (name == resolution.name) {
+                options.resolutions.push_back(resolution);
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "Unknown resolution " << name << std::endl;
+            return false;
+        }
+    }
+
+    for (const std::string& value : SplitList(multipliers)) {
+        const uint32_t multiplier = static_cast<uint32_t>(std::stoul(value));
+        if (multiplier < 2 || multiplier > OSFG::FrameInterpolation::MAX_PHASES + 1) {
+            std::cerr << "Multipliers must be 2 to " << OSFG::FrameInterpolation::MAX_PHASES + 1 << std::endl;
+            return false;
+        }
+        options.multipliers.push_back(multiplier);
+    }
+
+    if (options.resolutions.empty() || options.multipliers.empty() || options.frames == 0) {
+        std::cerr << "Nothing to run" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::cout << "=== OSFG Offline Benchmark ===" << std::endl;
+
+    FrameSequence sequence;
+    if (!LoadSequence(options, sequence)) {
+        return 1;
+    }
+    std::cout << "Input: " << (options.inputPath.empty() ? "synthetic" : options.inputPath) << ", "
+              << sequence.frameCount << " frames at " << sequence.width << "x" << sequence.height << std::endl;
+
+    ComPtr<ID3D12Device> device;
+    std::string adapter;
+    std::string driverVersion;
+    if (!CreateDevice(options.adapterIndex, device, adapter, driverVersion)) {
+        return 1;
+    }
+    std::cout << "Adapter " << options.adapterIndex << ": " << adapter
+              << " (driver " << driverVersion << ")\n" << std::endl;
+
+    std::vector<BenchResult> results;
+    bool success = true;
+    for (const Resolution& resolution : options.resolutions) {
+        success = RunFrameGeneration(options, sequence, device.Get(), resolution, results) && success;
+    }
+
+    if (options.transfer) {
+        const std::vector<osfg::GPUInfo> gpus = osfg::GPUTransfer::EnumerateGPUs();
+        if (gpus.size() < 2) {
+            std::cout << "Transfer skipped: needs two GPUs (found " << gpus.size() << ")\n" << std::endl;
+        } else {
+            for (const Resolution& resolution : options.resolutions) {
+                success = RunTransfer(options, sequence, resolution, results) && success;
+            }
+        }
+    }
+
+    for (const BenchResult& result : results) {
+        PrintResult(result);
+    }
+
+    if (!options.jsonPath.empty()) {
+        if (!WriteJson(options.jsonPath, options, sequence, adapter, driverVersion, results)) {
+            return 1;
+        }
+        std::cout << "\nResults written to " << options.jsonPath << std::endl;
+    }
+
+    return success ? 0 : 1;
+}
@@ -11,8 +11,11 @@
 #include "transfer/gpu_transfer.h"
 #include "app/config_manager.h"
 #include "app/hotkey_handler.h"
+#include "app/stats_overlay.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <chrono>
 #include <thread>
 
@@ -21,6 +24,8 @@ using namespace osfg;
 // Global state
 bool g_running = true;
 DualGPUPipeline* g_pipeline = nullptr;
+StatsOverlay* g_overlay = nullptr;
+DualGPUConfig g_config;     // Pipeline settings the AppSettings do not cover
 
 void PrintGPUInfo() {
     printf("\n=== Available GPUs ===\n");
@@ -62,29 +67,116 @@ void PrintStats(const PipelineStats& stats) {
     fflush(stdout);
 }
 
+// Overlay values from the pipeline's statistics
+PerformanceMetrics GetOverlayMetrics(const DualGPUPipeline& pipeline) {
+    const PipelineStats stats = pipeline.GetStats();
+
+    PerformanceMetrics metrics;
+    metrics.baseFPS = stats.baseFPS;
+    metrics.outputFPS = stats.outputFPS;
+    metrics.baseFrameTimeMs = stats.baseFPS > 0.0 ? 1000.0 / stats.baseFPS : 0.0;
+    metrics.genFrameTimeMs = stats.opticalFlowTimeMs + stats.interpolationTimeMs;
+    metrics.totalLatencyMs = stats.glassLatencyRealMs;
+    metrics.genLatencyMs = stats.glassLatencyGeneratedMs;
+    metrics.captureTimeMs = stats.captureTimeMs;
+    metrics.transferTimeMs = stats.transferTimeMs;
+    metrics.opticalFlowTimeMs = stats.opticalFlowTimeMs;
+    metrics.interpolationTimeMs = stats.interpolationTimeMs;
+    metrics.presentTimeMs = stats.presentTimeMs;
+    metrics.baseFrames = stats.baseFamesCaptured;
+    metrics.generatedFrames = stats.framesGenerated;
+    metrics.droppedFrames = stats.framesDropped;
+    metrics.secondaryGPUUsage = static_cast<float>((std::min)(100.0, stats.gpuLoad * 100.0));
+    metrics.vramUsageMB = stats.vramUsageBytes / (1024 * 1024);
+    metrics.frameGenEnabled = pipeline.IsFrameGenEnabled();
+    metrics.frameGenMultiplier = static_cast<int>(pipeline.GetFrameMultiplier());
+    metrics.dualGPUMode = true;
+    return metrics;
+}
+
+// Pipeline configuration for the application settings
+DualGPUConfig ToPipelineConfig(const AppSettings& settings, DualGPUConfig config) {
+    switch (settings.frameGenMode) {
+        case FrameGenMode::FrameGen3X: config.multiplier = FrameMultiplier::X3; break;
+        case FrameGenMode::FrameGen4X: config.multiplier = FrameMultiplier::X4; break;
+        default: config.multiplier = FrameMultiplier::X2; break;
+    }
+    config.enableFrameGen = settings.enableFrameGen && settings.frameGenMode != FrameGenMode::Disabled;
+    config.captureMethod = settings.captureMethod;
+    config.captureMonitor = settings.captureMonitor;
+    config.captureCursor = settings.captureCursor;
+    config.primaryGPU = settings.primaryGPU;
+    config.secondaryGPU = settings.secondaryGPU;
+    config.opticalFlowBlockSize = settings.opticalFlowBlockSize;
+    config.opticalFlowSearchRadius = settings.opticalFlowSearchRadius;
+    config.sceneChangeThreshold = settings.sceneChangeThreshold;
+    config.vsync = settings.vsyncEnabled;
+    config.variableRefresh = settings.variableRefresh;
+    config.borderlessWindow = settings.borderlessWindow;
+    config.preferPeerToPeer = settings.usePeerToPeerTransfer;
+    config.transferBufferCount = settings.frameBufferCount;
+    return config;
+}
+
+// Applied settings reach the running pipeline through Reconfigure(), which
+// re-creates only the stages the change touches
+void OnSettingsChanged(const AppSettings& settings, SettingsChange change) {
+    if (!g_pipeline) return;
+
+    if (!Any(change & (SettingsChange::FrameGen | SettingsChange::Capture | SettingsChange::GPU |
+                       SettingsChange::OpticalFlow | SettingsChange::Presentation |
+                       SettingsChange::Advanced))) {
+        return;
+    }
+
+    g_config = ToPipelineConfig(settings, g_config);
+    if (!g_pipeline->Reconfigure(g_config)) {
+        printf("\nReconfigure failed: %s\n", g_pipeline->GetLastError().c_str());
+        return;
+    }
+    printf("\nReconfigured: frame generation %s, %dX\n",
+           g_pipeline->IsFrameGenEnabled() ? "ENABLED" : "DISABLED",
+           static_cast<int>(g_pipeline->GetFrameMultiplier()));
+}
+
+// Next frame generation mode for Alt+F12
+FrameGenMode NextFrameGenMode(FrameGenMode mode) {
+    switch (mode) {
+        case FrameGenMode::FrameGen2X: return FrameGenMode::FrameGen3X;
+        case FrameGenMode::FrameGen3X: return FrameGenMode::FrameGen4X;
+        default: return FrameGenMode::FrameGen2X;
+    }
+}
+
 void OnHotkey(HotkeyAction action) {
     if (!g_pipeline) return;
 
+    ConfigManager& configManager = ConfigManager::Instance();
+    AppSettings& settings = configManager.GetSettingsMutable();
+
     switch (action) {
         case HotkeyAction::ToggleFrameGen:
-            g_pipeline->SetFrameGenEnabled(!g_pipeline->IsFrameGenEnabled());
-            printf("\nFrame Generation: %s\n",
-                   g_pipeline->IsFrameGenEnabled() ? "ENABLED" : "DISABLED");
+            settings.enableFrameGen = !settings.enableFrameGen;
+            configManager.ApplySettings();
+            break;
+
+        case HotkeyAction::CycleMode:
+            settings.frameGenMode = NextFrameGenMode(settings.frameGenMode);
+            configManager.ApplySettings();
             break;
 
-        case HotkeyAction::CycleMode: {
-            auto current = g_pipeline->GetFrameMultiplier();
-            FrameMultiplier next;
-            switch (current) {
-                case FrameMultiplier::X2: next = FrameMultiplier::X3; break;
-                case FrameMultiplier::X3: next = FrameMultiplier::X4; break;
-                case FrameMultiplier::X4: next = FrameMultiplier::X2; break;
-                default: next = FrameMultiplier::X2; break;
+        case HotkeyAction::ToggleOverlay:
+            if (g_overlay) {
+                g_overlay->SetVisible(!g_overlay->IsVisible());
+                g_pipeline->SetOverlayVisible(g_overlay->IsVisible());
+            }
+            break;
+
+        case HotkeyAction::DumpFrameRecords:
+            if (g_pipeline->WriteFrameRecords("osfg_frames.csv")) {
+                printf("\nFrame records written to osfg_frames.csv / osfg_frames_presentmon.csv\n");
             }
-            g_pipeline->SetFrameMultiplier(next);
-            printf("\nFrame Multiplier: %dX\n", static_cast<int>(next));
             break;
-        }
 
         default:
             break;
@@ -112,17 +204,23 @@ int main(int argc, char* argv[]) {
            DualGPUPipeline::IsFidelityFXAvailable() ? "Available" : "Not available");
     printf("\n");
 
-    // Configure pipeline
-    DualGPUConfig config;
-    config.primaryGPU = 0;
-    config.secondaryGPU = 1;
-    config.multiplier = FrameMultiplier::X2;
-    config.enableFrameGen = true;
-    config.vsync = true;
-    config.captureMonitor = 0;
-    config.windowTitle = L"OSFG Dual-GPU Test";
-    config.enableDebugOutput = true;
-    config.backend = FrameGenBackend::Auto;  // Auto-select best backend
+    // --cycle: step the multiplier through the settings every 5 seconds,
+    // re-configuring the running pipeline without a keyboard
+    bool cycleSettings = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cycle") == 0) {
+            cycleSettings = true;
+        }
+    }
+
+    // Configure pipeline from the default application settings; hotkeys
+    // change the settings and the change callback re-configures it
+    ConfigManager& configManager = ConfigManager::Instance();
+    g_config.windowTitle = L"OSFG Dual-GPU Test";
+    g_config.enableDebugOutput = true;
+    g_config.backend = FrameGenBackend::Auto;  // Auto-select best backend
+    g_config = ToPipelineConfig(configManager.GetSettings(), g_config);
+    const DualGPUConfig& config = g_config;
 
     printf("Configuration:\n");
     printf("  Primary GPU (Capture):   [%d] %ls\n",
@@ -153,13 +251,29 @@ int main(int argc, char* argv[]) {
     printf("Pipeline initialized successfully!\n");
     printf("  Active Backend: %s\n\n", GetBackendName(pipeline.GetActiveBackend()));
 
+    configManager.RegisterChangeCallback(OnSettingsChanged);
+
+    // Statistics overlay: rasterized in software when its text changes and
+    // blended by the pipeline into each presented frame
+    StatsOverlay overlay;
+    OverlayConfig overlayConfig;
+    overlayConfig.showComponentTimings = true;
+    overlay.SetConfig(overlayConfig);
+    if (overlay.InitializeBitmap(config.width, config.height)) {
+        g_overlay = &overlay;
+    } else {
+        printf("WARNING: Stats overlay unavailable: %s\n", overlay.GetLastError().c_str());
+    }
+
     // Initialize hotkeys
     HotkeyHandler hotkeys;
     if (hotkeys.Initialize()) {
         hotkeys.SetCallback(OnHotkey);
-        hotkeys.RegisterDefaultHotkeys(VK_F10, VK_F11, VK_F12, true);
+        hotkeys.RegisterDefaultHotkeys(VK_F10, VK_F11, VK_F12, true, VK_F9);
         printf("Hotkeys registered:\n");
+        printf("  Alt+F9:  Write frame records (CSV, PresentMon CSV)\n");
         printf("  Alt+F10: Toggle frame generation\n");
+        printf("  Alt+F11: Toggle stats overlay\n");
         printf("  Alt+F12: Cycle multiplier (2X/3X/4X)\n");
         printf("  Escape:  Exit\n");
     }
@@ -176,6 +290,7 @@ int main(int argc, char* argv[]) {
 
     // Main loop
     auto lastStatsTime = std::chrono::high_resolution_clock::now();
+    auto lastCycleTime = lastStatsTime;
 
     while (pipeline.IsRunning() && pipeline.IsWindowOpen()) {
         // Process window messages
@@ -198,6 +313,16 @@ int main(int argc, char* argv[]) {
         // Process one frame
         pipeline.ProcessFrame();
 
+        // Hand a new overlay image over only when its text changed
+        if (g_overlay) {
+            overlay.UpdateMetrics(GetOverlayMetrics(pipeline));
+            if (overlay.Rasterize()) {
+                pipeline.SetOverlayImage(overlay.GetPixels(), overlay.GetBitmapWidth(),
+                                         overlay.GetBitmapHeight(), overlay.GetBitmapRowPitch(),
+                                         overlay.GetBitmapX(), overlay.GetBitmapY());
+            }
+        }
+
         // Print stats periodically
         auto now = std::chrono::high_resolution_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastStatsTime);
@@ -205,14 +330,25 @@ int main(int argc, char* argv[]) {
             PrintStats(pipeline.GetStats());
             lastStatsTime = now;
         }
+
+        // Same thread as ProcessFrame(), as Reconfigure() requires
+        if (cycleSettings && now - lastCycleTime >= std::chrono::seconds(5)) {
+            OnHotkey(HotkeyAction::CycleMode);
+            lastCycleTime = now;
+        }
     }
 
     printf("\n\nShutting down...\n");
 
-    // Cleanup
+    // Percentiles go away with the recorder at Shutdown()
     pipeline.Stop();
+    const FrameRecordSummary summary = pipeline.GetFrameRecorder().GetSummary();
+
+    // Cleanup
     pipeline.Shutdown();
     hotkeys.Shutdown();
+    g_overlay = nullptr;
+    overlay.Shutdown();
 
     // Print final stats
     const auto& stats = pipeline.GetStats();
@@ -225,9 +361,24 @@ int main(int argc, char* argv[]) {
     printf("    Capture:       %.2f ms\n", stats.captureTimeMs);
     printf("    Transfer:      %.2f ms (%.1f MB/s)\n",
            stats.transferTimeMs, stats.transferThroughputMBps);
-    printf("    Optical Flow:  %.2f ms\n", stats.opticalFlowTimeMs);
-    printf("    Interpolation: %.2f ms\n", stats.interpolationTimeMs);
+    printf("    Optical Flow:  %.2f ms (1/%u scale)\n", stats.opticalFlowTimeMs, stats.opticalFlowDownscale);
+    printf("    Interpolation: %.2f ms (1/%u scale)\n", stats.interpolationTimeMs, stats.interpolationDownscale);
     printf("    Total:         %.2f ms\n", stats.totalPipelineTimeMs);
+    printf("    VRAM:          %llu / %llu MB (%llu memory-saving steps, %u in effect)\n",
+           stats.vramUsageBytes / (1024 * 1024), stats.vramBudgetBytes / (1024 * 1024),
+           stats.vramDegradations, stats.vramDegradeLevel);
+    printf("    GPU Load:      %.0f%% (%u quality steps in effect, %llu changes)\n",
+           stats.gpuLoad * 100.0, stats.qualityLevel, stats.qualityChanges);
+    printf("    Glass-to-Glass: %.2f ms real, %.2f ms generated (%llu samples)\n",
+           stats.glassLatencyRealMs, stats.glassLatencyGeneratedMs, stats.glassLatencySamples);
+    printf("\n  Last %llu Frames (p50 / p99 / max):\n", summary.frames);
+    printf("    Latency:       %.2f / %.2f / %.2f ms\n",
+           summary.latencyMs.p50, summary.latencyMs.p99, summary.latencyMs.max);
+    printf("    Frame Time:    %.2f / %.2f / %.2f ms\n",
+           summary.frameTimeMs.p50, summary.frameTimeMs.p99, summary.frameTimeMs.max);
+    printf("    Present Time:  %.2f / %.2f / %.2f ms\n",
+           summary.presentTimeMs.p50, summary.presentTimeMs.p99, summary.presentTimeMs.max);
+    printf("    Dropped / Duplicated: %llu / %llu\n", summary.droppedFrames, summary.duplicatedFrames);
     printf("\n");
 
     g_pipeline = nullptr;
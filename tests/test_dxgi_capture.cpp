@@ -3,8 +3,10 @@
 //
 // This test captures frames from the desktop and measures capture latency.
 // Run this while a game or video is playing to test capture performance.
+// With --dump it also records the frames for offline replay (bench_osfg).
 
 #include "../src/capture/dxgi_capture.h"
+#include "../src/capture/frame_dump.h"
 #include <iostream>
 #include <iomanip>
 #include <thread>
@@ -21,7 +23,8 @@ void PrintUsage() {
     std::cout << "OSFG DXGI Capture Test\n";
     std::cout << "======================\n\n";
     std::cout << "This test captures desktop frames and measures latency.\n";
-    std::cout << "Press Ctrl+C to stop.\n\n";
+    std::cout << "Press Ctrl+C to stop.\n";
+    std::cout << "Use --dump <file.osfd> [--dump-frames N] to record frames for bench_osfg.\n\n";
 }
 
 void PrintStats(const osfg::CaptureStats& stats, uint32_t width, uint32_t height) {
@@ -48,6 +51,9 @@ int main(int argc, char* argv[]) {
     config.timeoutMs = 100;        // Wait up to 100ms for a frame
     config.createStagingTexture = false;  // Don't need CPU readback for this test
 
+    std::string dumpPath;
+    uint32_t dumpFrames = 300;
+
     // Parse command line
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -57,6 +63,10 @@ int main(int argc, char* argv[]) {
             config.adapterIndex = std::stoi(argv[++i]);
         } else if (arg == "--timeout" && i + 1 < argc) {
             config.timeoutMs = std::stoi(argv[++i]);
+        } else if (arg == "--dump" && i + 1 < argc) {
+            dumpPath = argv[++i];
+        } else if (arg == "--dump-frames" && i + 1 < argc) {
+            dumpFrames = static_cast<uint32_t>(std::stoul(argv[++i]));
         }
     }
 
@@ -74,6 +84,16 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Capture initialized successfully!\n";
     std::cout << "Display resolution: " << capture.GetWidth() << "x" << capture.GetHeight() << "\n\n";
+
+    // Dump mode: the readback makes capture latency higher than usual
+    osfg::FrameDumpWriter dump;
+    if (!dumpPath.empty()) {
+        if (!dump.Open(dumpPath, capture.GetWidth(), capture.GetHeight())) {
+            std::cerr << "Failed to open dump: " << dump.GetLastError() << "\n";
+            return 1;
+        }
+        std::cout << "Dumping " << dumpFrames << " frames to " << dumpPath << "\n\n";
+    }
     std::cout << "Capturing frames... (Press Ctrl+C to stop)\n\n";
 
     // Capture loop
@@ -84,6 +104,16 @@ int main(int argc, char* argv[]) {
         if (capture.CaptureFrame(frame)) {
             // Frame captured successfully
             // In a real application, we'd process the frame here
+            if (dump.IsOpen() && frame.hasImageUpdate) {
+                if (!dump.WriteFrame(capture.GetContext(), frame.texture.Get(),
+                                     frame.presentTimeQpc, frame.accumulatedFrames)) {
+                    std::cerr << "\nDump stopped: " << dump.GetLastError() << "\n";
+                    dump.Close();
+                } else if (dump.GetFrameCount() >= dumpFrames) {
+                    dump.Close();
+                    g_running = false;
+                }
+            }
 
             // Release the frame immediately to minimize latency
             capture.ReleaseFrame();
@@ -105,6 +135,10 @@ int main(int argc, char* argv[]) {
     std::cout << "Average capture latency: " << std::fixed << std::setprecision(3) << stats.avgCaptureTimeMs << " ms\n";
     std::cout << "Min capture latency: " << stats.minCaptureTimeMs << " ms\n";
     std::cout << "Max capture latency: " << stats.maxCaptureTimeMs << " ms\n";
+    if (!dumpPath.empty()) {
+        std::cout << "Frames dumped: " << dump.GetFrameCount() << " (" << dumpPath << ")\n";
+        dump.Close();
+    }
 
     // Target check
     std::cout << "\n=== Target Check ===\n";
@@ -0,0 +1,199 @@
+// OSFG - Open Source Frame Generation
+// Multi-Output Pipeline Test Application
+//
+// Runs one dual-GPU pipeline per monitor on a shared GPU context:
+// - One capture, transfer and window per monitor
+// - Every output's flow and interpolation on the shared compute scheduler
+// - Scheduler statistics (reordering by deadline, late frames) once a second
+//
+// Usage: test_multi_output_pipeline [seconds]   (default 30; 0 = until a window closes)
+
+#include "pipeline/multi_output_pipeline.h"
+#include "transfer/gpu_transfer.h"
+
+#include <dxgi1_6.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace osfg;
+
+// Outputs (monitors) attached to an adapter
+uint32_t CountOutputs(uint32_t adapterIndex) {
+    ComPtr<IDXGIFactory1> factory;
+    if (FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&factory)))) {
+        return 0;
+    }
+    ComPtr<IDXGIAdapter1> adapter;
+    if (FAILED(factory->EnumAdapters1(adapterIndex, &adapter))) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    ComPtr<IDXGIOutput> output;
+    while (SUCCEEDED(adapter->EnumOutputs(count, &output))) {
+        output.Reset();
+        count++;
+    }
+    return count;
+}
+
+void PrintSchedulerStats(const MultiOutputPipeline& pipeline) {
+    const ComputeSchedulerStats stats = pipeline.GetSchedulerStats();
+    printf("\rScheduler: %llu submitted, %llu reordered, %llu late, %u max pending",
+           stats.submissions, stats.reordered, stats.late, stats.maxPending);
+    for (uint32_t i = 0; i < pipeline.GetOutputCount(); i++) {
+        const PipelineStats output = pipeline.GetStats(i);
+        printf(" | [%u] %.1f/%.1f FPS", i, output.baseFPS, output.outputFPS);
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    printf("=== OSFG Multi-Output Pipeline Test ===\n\n");
+
+    const int durationSeconds = argc > 1 ? atoi(argv[1]) : 30;
+
+    auto gpus = GPUTransfer::EnumerateGPUs();
+    if (gpus.size() < 2) {
+        printf("ERROR: Multi-output mode requires at least 2 GPUs.\n");
+        printf("Found %zu GPU(s). Exiting.\n", gpus.size());
+        return 1;
+    }
+
+    MultiOutputConfig config;
+    config.output.primaryGPU = 0;
+    config.output.secondaryGPU = 1;
+    config.output.multiplier = FrameMultiplier::X2;
+    config.output.windowTitle = L"OSFG Multi-Output Test";
+    config.output.enableDebugOutput = true;
+    config.output.backend = FrameGenBackend::Native;
+
+    const uint32_t monitorCount = CountOutputs(config.output.primaryGPU);
+    if (monitorCount < 2) {
+        printf("ERROR: Multi-output mode requires at least 2 monitors on GPU %u.\n",
+               config.output.primaryGPU);
+        printf("Found %u monitor(s). Exiting.\n", monitorCount);
+        return 1;
+    }
+
+    config.monitors.clear();
+    for (uint32_t i = 0; i < monitorCount; i++) {
+        config.monitors.push_back(i);
+    }
+
+    printf("Configuration:\n");
+    printf("  Primary GPU (Capture):   [%u] %ls\n",
+           config.output.primaryGPU, gpus[config.output.primaryGPU].description.c_str());
+    printf("  Secondary GPU (Compute): [%u] %ls\n",
+           config.output.secondaryGPU, gpus[config.output.secondaryGPU].description.c_str());
+    printf("  Outputs: %u\n", monitorCount);
+    printf("  Max queued submissions: %u\n\n", config.scheduler.maxQueuedSubmissions);
+
+    // A serial pipeline must not be accepted on a shared context
+    {
+        SharedGPUContextConfig contextConfig;
+        contextConfig.primaryGPU = config.output.primaryGPU;
+        contextConfig.secondaryGPU = config.output.secondaryGPU;
+        contextConfig.pipelineCache = false;
+
+        SharedGPUContext context;
+        if (!context.Initialize(contextConfig)) {
+            printf("ERROR: Failed to initialize shared GPU context: %s\n", context.GetLastError().c_str());
+            return 1;
+        }
+
+        DualGPUConfig serialConfig = config.output;
+        serialConfig.pipelinedMode = false;
+        DualGPUPipeline serial;
+        const bool accepted = serial.Initialize(serialConfig, &context);
+        serial.Shutdown();
+        context.Shutdown();
+        printf("Serial pipeline on shared context: %s\n\n", accepted ? "ACCEPTED (FAIL)" : "rejected (OK)");
+        if (accepted) {
+            return 1;
+        }
+    }
+
+    printf("Initializing multi-output pipeline...\n");
+
+    MultiOutputPipeline pipeline;
+    if (!pipeline.Initialize(config)) {
+        printf("ERROR: Failed to initialize pipeline: %s\n", pipeline.GetLastError().c_str());
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < pipeline.GetOutputCount(); i++) {
+        pipeline.GetOutput(i)->SetErrorCallback([i](const std::string& error) {
+            printf("\nOutput %u Error: %s\n", i, error.c_str());
+        });
+    }
+
+    printf("Pipeline initialized with %u outputs.\n\n", pipeline.GetOutputCount());
+
+    if (!pipeline.Start()) {
+        printf("ERROR: Failed to start pipeline: %s\n", pipeline.GetLastError().c_str());
+        return 1;
+    }
+
+    // Same loop as MultiOutputPipeline::Run(), with statistics and a time limit
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    auto lastStatsTime = startTime;
+    bool quit = false;
+    while (!quit) {
+        MSG msg = {};
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) {
+                quit = true;
+                break;
+            }
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        for (uint32_t i = 0; i < pipeline.GetOutputCount(); i++) {
+            if (!pipeline.GetOutput(i)->IsWindowOpen()) {
+                quit = true;
+            }
+        }
+        if (quit || !pipeline.ProcessFrame()) {
+            break;
+        }
+
+        auto now = std::chrono::high_resolution_clock::now();
+        if (now - lastStatsTime >= std::chrono::seconds(1)) {
+            PrintSchedulerStats(pipeline);
+            lastStatsTime = now;
+        }
+        if (durationSeconds > 0 && now - startTime >= std::chrono::seconds(durationSeconds)) {
+            break;
+        }
+
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, 1, QS_ALLINPUT);
+    }
+
+    printf("\n\nShutting down...\n");
+    pipeline.Stop();
+    const ComputeSchedulerStats stats = pipeline.GetSchedulerStats();
+
+    printf("\n=== Final Statistics ===\n");
+    printf("  Submissions:  %llu\n", stats.submissions);
+    printf("  Reordered:    %llu\n", stats.reordered);
+    printf("  Late:         %llu\n", stats.late);
+    printf("  Max Pending:  %u\n", stats.maxPending);
+    for (uint32_t i = 0; i < pipeline.GetOutputCount(); i++) {
+        const PipelineStats output = pipeline.GetStats(i);
+        printf("  Output %u: %llu captured, %llu generated, %llu presented, %llu dropped\n", i,
+               output.baseFamesCaptured, output.framesGenerated, output.framesPresented, output.framesDropped);
+    }
+    printf("\n");
+
+    pipeline.Shutdown();
+
+    if (stats.submissions == 0) {
+        printf("FAIL: no compute work went through the scheduler\n");
+        return 1;
+    }
+    return 0;
+}